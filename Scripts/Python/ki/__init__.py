@@ -193,6 +193,7 @@ class xKI(ptModifier):
         self.BKCurrentContent = None
         self.BKContentList = []
         self.BKContentListTopLine = 0
+        self.BKListIconNodes = {}  # Image node each list mode icon is waiting on.
 
         self.BKInEditMode = False
         self.BKEditContent = None
@@ -4321,6 +4322,7 @@ class xKI(ptModifier):
                     PtDebugPrint("xKI.BigKIRefreshContentListDisplay(): Index error: self.BKFolderSelected = {} and list = {}.".format(self.BKFolderSelected, self.BKFolderListOrder), level=kWarningLevel)
                 return
             ID = kGUI.BKILMOffsetLine01
+            self.BKListIconNodes = {}
             if len(self.BKContentList) != 0:
                 if self.BKContentListTopLine >= len(self.BKContentList):
                     self.BKContentListTopLine = len(self.BKContentList) - 1
@@ -4365,11 +4367,11 @@ class xKI(ptModifier):
                                     contentIconAva.hide()
                                     if contentIconP.getNumMaps() > 0:
                                         dynMap = contentIconP.getMap(0)
-                                        image = element.imageGetImage()
                                         dynMap.clearToColor(ptColor(.1, .1, .1, .1))
-                                        if image is not None:
-                                            dynMap.drawImage(kGUI.BKIImageStartX, kGUI.BKIImageStartY, image, 0)
                                         dynMap.flush()
+                                        # Decode in the background; this line may show something else by then.
+                                        self.BKListIconNodes[ID] = element.getID()
+                                        element.getImageAsync(functools.partial(self.BigKIDrawListIcon, ID, element.getID(), dynMap))
                                     contentIconP.show()
                                 elif element.getType() == PtVaultNodeTypes.kPlayerInfoNode:
                                     element = element.upcastToPlayerInfoNode()
@@ -4577,6 +4579,16 @@ class xKI(ptModifier):
         except KeyError:
             PtDebugPrint("xKI.BigKICreateJournalNote(): Could not find journal for this Age: {}.".format(self.GetAgeInstanceName()), level=kErrorLevel)
 
+    ## Draw a list mode picture icon once its image has been decoded.
+    def BigKIDrawListIcon(self, ID, nodeID, dynMap, image):
+
+        # The list may have scrolled or changed folders in the meantime.
+        if self.BKListIconNodes.get(ID) != nodeID:
+            return
+        if image is not None:
+            dynMap.drawImage(kGUI.BKIImageStartX, kGUI.BKIImageStartY, image, 0)
+            dynMap.flush()
+
     ## Display a KI Picture in the KI.
     def BigKIDisplayPicture(self):
 
@@ -4621,18 +4633,26 @@ class xKI(ptModifier):
             picTitle.show()
         if picImage.getNumMaps() > 0:
             dynMap = picImage.getMap(0)
-            image = element.imageGetImage()
             dynMap.clearToColor(ptColor(.1, .1, .1, .3))
-            if image is not None:
-                dynMap.drawImage(kGUI.BKIImageStartX, kGUI.BKIImageStartY, image, 0)
-            else:
-                dynMap.fillRect(kGUI.BKIImageStartX, kGUI.BKIImageStartY, kGUI.BKIImageStartX + 800, kGUI.BKIImageStartY + 600, ptColor(.2, .2, .2, .1))
             dynMap.flush()
+            element.getImageAsync(functools.partial(self.BigKIDrawPicture, self.BKCurrentContent, dynMap))
         picImage.show()
         self.BigKISetSeen(self.BKCurrentContent)
         # If it came from someone else, add them to the SendTo field.
         self.CheckContentForSender(self.BKCurrentContent)
 
+    ## Draw a KI Picture once its image has been decoded.
+    def BigKIDrawPicture(self, content, dynMap, image):
+
+        # Another picture may have been opened in the meantime.
+        if self.BKCurrentContent is not content:
+            return
+        if image is not None:
+            dynMap.drawImage(kGUI.BKIImageStartX, kGUI.BKIImageStartY, image, 0)
+        else:
+            dynMap.fillRect(kGUI.BKIImageStartX, kGUI.BKIImageStartY, kGUI.BKIImageStartX + 800, kGUI.BKIImageStartY + 600, ptColor(.2, .2, .2, .1))
+        dynMap.flush()
+
     ## Create and display a new KI Picture in the Journal.
     def BigKICreateJournalImage(self, image, useScreenShot=False):
 
@@ -4261,6 +4261,10 @@ class ptGUIControlMultiLineEdit(ptGUIControl):
         """Returns what line is the top line."""
         pass
 
+    def getScrollbackLimit(self):
+        """Returns the current scrollback limit in lines"""
+        pass
+
     def getSelectColor(self):
         """Returns the selection color"""
         pass
@@ -4386,6 +4390,10 @@ class ptGUIControlMultiLineEdit(ptGUIControl):
         """Sets the what line is the top line."""
         pass
 
+    def setScrollbackLimit(self,numLines):
+        """Sets the most lines the editbox keeps, dropping whole lines off the top past that (-1 for no limit)"""
+        pass
+
     def setSelectColor(self,r,g,b,a):
         """Sets the selection color"""
         pass
@@ -8026,6 +8034,10 @@ class ptVaultImageNode(ptVaultNode):
         """Returns the image(ptImage) of this image node"""
         pass
 
+    def getImageAsync(self,callback):
+        """Decodes the image in the background, then calls callback with the image(ptImage), or None"""
+        pass
+
     def getModifyTime(self):
         """Returns the modified time of this node, that is useable by python's time library."""
         pass
@@ -48,6 +48,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plPipeline.h"
 #include "plProfile.h"
 #include "plQuality.h"
+#include "hsJobSystem.h"
 #include "hsStream.h"
 #include "hsTimer.h"
 #include "plTimerCallbackManager.h"
@@ -90,6 +91,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plGImage/plAVIWriter.h"
 #include "plGImage/plBitmap.h"
 #include "plGImage/plFontCache.h"
+#include "plGImage/plImageCodecService.h"
 #include "plGLight/plShadowCaster.h"
 #include "plInputCore/plInputDevice.h"
 #include "plInputCore/plInputInterfaceMgr.h"
@@ -327,6 +329,10 @@ bool plClient::Shutdown()
 
     IUnRegisterAs(fConsole, kConsoleObject_KEY);
 
+    // Image callbacks can hold Python objects, so they have to be done with
+    // before Python goes away
+    plImageCodecService::Flush();
+
     PythonInterface::finiPython();
 
     IUnRegisterAs(fNewCamera, kVirtualCamera1_KEY);
@@ -355,6 +361,8 @@ bool plClient::Shutdown()
     fPageMgr = nullptr;
     plGlobalVisMgr::DeInit();
 
+    hsJobSystem::Shutdown();
+
 #ifdef TRACK_AG_ALLOCS
     DumpAGAllocs();
 #endif // TRACK_AG_ALLOCS
@@ -1315,7 +1323,9 @@ bool plClient::StartInit()
     hsStatusMessage("Init client\n");
     fFlags.SetBit( kFlagIniting );
 
-    pfLocalizationMgr::Initialize("dat");
+    hsJobSystem::Initialize();
+
+    pfLocalizationMgr::Initialize("dat", plFileName::Join(plFileSystem::GetUserDataPath(), "localization.cache"));
 
     plQuality::SetQuality(fQuality);
     if( (GetClampCap() >= 0) && (GetClampCap() < plQuality::GetCapability()) )
@@ -1563,9 +1573,18 @@ bool plClient::IUpdate()
     if (hsTimer::GetSysSeconds()==0 && hsTimer::IsRealTime() && hsTimer::GetTimeClamp()==0)
         hsTimer::SetRealTime(true);
 
+    // If the physics step was overlapped with last frame's render, collect it
+    // before any message gets the chance to move a physical.
+    plProfile_BeginTiming(Simulation);
+    plSimulationMgr::GetInstance()->EndAdvance();
+    plProfile_EndTiming(Simulation);
+
     plProfile_BeginTiming(DispatchQueue);
     plgDispatch::Dispatch()->MsgQueueProcess();
     plProfile_EndTiming(DispatchQueue);
+
+    // Finish off anything the worker jobs handed back to the main thread
+    hsJobSystem::Instance().RunMainThreadJobs();
     
     const char *inputUpdate = "Update";
     if (fInputManager) // Is this used anymore? Seems to always be nil.
@@ -2152,6 +2171,7 @@ void plClient::FlashWindow()
 void plClient::IOnAsyncInitComplete () {
     // Init State Desc Language (files should now be downloaded and in place)
     plSDLMgr::GetInstance()->SetNetApp(plNetClientMgr::GetInstance());
+    plSDLMgr::GetInstance()->SetCacheFile(plFileName::Join(plFileSystem::GetUserDataPath(), "sdl.cache"));
     plSDLMgr::GetInstance()->Init( plSDL::kDisallowTimeStamping );
 
     PythonInterface::initPython();
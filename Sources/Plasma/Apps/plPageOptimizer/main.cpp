@@ -51,14 +51,19 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 int main(int argc, char* argv[])
 {
-    if (argc != 2)
+    if (argc < 2)
     {
         puts("plPageOptimizer: wrong number of arguments");
+        puts("usage: plPageOptimizer page.prp [page.prp ...]");
+        puts("Pass every page of an age to lay them out for loading the whole age.");
         return 1;
     }
 
-    plFileName filename = argv[1];
-    ST::printf("Optimizing {}...", filename);
+    std::vector<plFileName> pagePaths(argv + 1, argv + argc);
+    if (pagePaths.size() == 1)
+        ST::printf("Optimizing {}...\n", pagePaths[0]);
+    else
+        ST::printf("Optimizing {} pages...\n", pagePaths.size());
 
 #ifndef _DEBUG
     try {
@@ -79,7 +84,7 @@ int main(int argc, char* argv[])
     try
 #endif
     {
-        plPageOptimizer optimizer(argv[1]);
+        plPageOptimizer optimizer(pagePaths);
         optimizer.Optimize();
     }
 #ifndef _DEBUG
@@ -43,6 +43,9 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "hsStream.h"
 
+#include <algorithm>
+#include <string_theory/stdio>
+
 #include "pnFactory/plFactory.h"
 #include "pnKeyedObject/plKeyImp.h"
 #include "pnKeyedObject/plUoid.h"
@@ -55,67 +58,188 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 plPageOptimizer* plPageOptimizer::fInstance = nullptr;
 
-plPageOptimizer::plPageOptimizer(const plFileName& pagePath) :
-    fOptimized(true),
-    fPageNode(),
-    fPagePath(pagePath)
+plPageOptimizer::plPageOptimizer(const std::vector<plFileName>& pagePaths) :
+    fCurRoom()
 {
     fInstance = this;
 
-    fTempPagePath = fPagePath.StripFileExt() + "_opt.prp";
+    fPages.resize(pagePaths.size());
+    for (size_t i = 0; i < pagePaths.size(); i++)
+    {
+        fPages[i].fPath = pagePaths[i];
+        fPages[i].fTempPath = pagePaths[i].StripFileExt() + "_opt.prp";
+        fPages[i].fNode = nullptr;
+        fPages[i].fOptimized = true;
+    }
 
     fResMgr = (plResManager*)hsgResMgr::ResMgr();
 }
 
-void plPageOptimizer::IFindLoc()
+plPageOptimizer::PageData* plPageOptimizer::IFindPage(const plLocation& loc)
+{
+    for (PageData& page : fPages)
+    {
+        if (page.fNode && page.fLoc == loc)
+            return &page;
+    }
+    return nullptr;
+}
+
+void plPageOptimizer::IFindLocs()
 {
     class plPageIt : public plRegistryPageIterator 
     {
     public:
-        plLocation fLoc;
+        std::vector<PageData>& fPages;
+        plPageIt(std::vector<PageData>& pages) : fPages(pages) {}
 
         bool EatPage(plRegistryPageNode* keyNode) override
         {
-            fLoc = keyNode->GetPageInfo().GetLocation();
+            for (PageData& page : fPages)
+            {
+                if (page.fPath == keyNode->GetPagePath())
+                {
+                    page.fLoc = keyNode->GetPageInfo().GetLocation();
+                    page.fNode = keyNode;
+                }
+            }
             return true;
         }
     };
 
-    plPageIt it;
+    plPageIt it(fPages);
     fResMgr->IterateAllPages(&it);
-    fLoc = it.fLoc;
 }
 
-void plPageOptimizer::Optimize()
+//// IO Model ///////////////////////////////////////////////////////////////
+//  A model, not a measurement: counts the reads and seeks hsBufferedStream's
+//  2k blocks would take to read objects in the order the game asks for them,
+//  with whatever is big enough read straight through.  It leaves out the
+//  load order index's read-ahead, so the before and after numbers differ
+//  only by layout, and it knows nothing of the OS cache.
+
+struct plIOStats
 {
-    fResMgr->AddSinglePage(fPagePath);
+    uint32_t fReads;
+    uint32_t fSeeks;
+};
 
-    // Get the location of the page we're optimizing
-    IFindLoc();
+class plStreamModel
+{
+    static const uint32_t kBlockSize = 2 * 1024;    // hsBufferedStream's
+    static const uint32_t kNoBlock = uint32_t(-1);
 
-    bool loaded = true;
+    uint32_t fFilePos;
+    uint32_t fBlock;
 
-    // Get the key for the scene node, we'll load it to force a load on all the objects
-    plKey snKey = plKeyFinder::Instance().FindSceneNodeKey(fLoc);
-    if (snKey)
+    void ISeek(uint32_t pos, plIOStats& stats)
     {
-        // Load all the keys
-        fPageNode = fResMgr->FindPage(fLoc);
-        fResMgr->LoadPageKeys(fPageNode);
+        if (pos != fFilePos)
+            stats.fSeeks++;
+    }
+
+public:
+    plStreamModel() : fFilePos(), fBlock(kNoBlock) { }
 
-        // Put all the keys in a vector, so they won't get unreffed
-        class plVecKeyCollector : public plRegistryKeyIterator
+    void Read(uint32_t start, uint32_t len, plIOStats& stats)
+    {
+        uint32_t end = start + len;
+        uint32_t pos = start;
+        while (pos < end)
         {
-        public:
-            KeyVec& fKeys;
-            plVecKeyCollector(KeyVec& keys) : fKeys(keys) {}
-            bool EatKey(const plKey& key) override { fKeys.push_back(key); return true; }
-        };
-        plVecKeyCollector keyIt(fAllKeys);
-        fResMgr->IterateKeys(&keyIt);
+            uint32_t block = pos / kBlockSize;
+            if (block == fBlock)
+            {
+                pos = std::min(end, (block + 1) * kBlockSize);
+                continue;
+            }
 
-        // Set our load proc, which will track the order that objects are loaded
-        fResMgr->SetProgressBarProc(KeyedObjectProc);
+            ISeek(block * kBlockSize, stats);
+            stats.fReads++;
+            if (pos % kBlockSize == 0 && end - pos >= kBlockSize)
+            {
+                pos = end - (end - pos) % kBlockSize;
+                fFilePos = pos;
+                fBlock = kNoBlock;
+            }
+            else
+            {
+                fBlock = block;
+                fFilePos = (block + 1) * kBlockSize;
+                pos = std::min(end, fFilePos);
+            }
+        }
+    }
+};
+
+void plPageOptimizer::IReportIO(const char* when)
+{
+    std::vector<plStreamModel> models(fPages.size());
+    plIOStats total{};
+    std::vector<plIOStats> stats(fPages.size(), plIOStats{});
+    for (const plKey& key : fKeyLoadOrder)
+    {
+        PageData* page = IFindPage(key->GetUoid().GetLocation());
+        size_t idx = page - fPages.data();
+        plKeyImp* imp = (plKeyImp*)key;
+        models[idx].Read(imp->GetStartPos(), imp->GetDataLen(), stats[idx]);
+    }
+
+    ST::printf("Modelled I/O paging in the age {} (2k buffered blocks, no read-ahead):\n", when);
+    for (size_t i = 0; i < fPages.size(); i++)
+    {
+        if (!fPages[i].fNode)
+            continue;
+        ST::printf("  {}: {} reads, {} seeks\n", fPages[i].fPath.GetFileName(), stats[i].fReads, stats[i].fSeeks);
+        total.fReads += stats[i].fReads;
+        total.fSeeks += stats[i].fSeeks;
+    }
+    ST::printf("  total: {} reads, {} seeks\n", total.fReads, total.fSeeks);
+}
+
+void plPageOptimizer::Optimize()
+{
+    for (const PageData& page : fPages)
+        fResMgr->AddSinglePage(page.fPath);
+
+    // Get the locations of the pages we're optimizing
+    IFindLocs();
+
+    // Load all the keys, and put them in vectors so they won't get unreffed
+    class plVecKeyCollector : public plRegistryKeyIterator
+    {
+    public:
+        KeyVec& fKeys;
+        plVecKeyCollector(KeyVec& keys) : fKeys(keys) {}
+        bool EatKey(const plKey& key) override { fKeys.push_back(key); return true; }
+    };
+    for (PageData& page : fPages)
+    {
+        if (!page.fNode)
+            continue;
+        fResMgr->LoadPageKeys(page.fNode);
+        plVecKeyCollector keyIt(page.fAllKeys);
+        fResMgr->IterateKeys(&keyIt, page.fLoc);
+    }
+
+    // Set our load proc, which will track the order that objects are loaded
+    fResMgr->SetProgressBarProc(KeyedObjectProc);
+
+    // Page in each room on its own, loading its scene node to force a load on
+    // all its objects. Anything it pulls in from the other pages (like
+    // textures) is tracked too.
+    size_t numRooms = 0;
+    for (const PageData& page : fPages)
+    {
+        if (!page.fNode)
+            continue;
+
+        plKey snKey = plKeyFinder::Instance().FindSceneNodeKey(page.fLoc);
+        if (!snKey)
+            continue;
+
+        fCurRoom = numRooms++;
+        fRoomKeys.clear();
 
         // Load the page
         snKey->VerifyLoaded();
@@ -125,38 +249,52 @@ void plPageOptimizer::Optimize()
         snKey->UnRefObject();
         snKey = nullptr;
     }
-    else
-    {
-        loaded = false;
-    }
-
-    if (loaded)
-        IRewritePage();
 
-    uint64_t oldSize = plFileInfo(fPagePath).FileSize();
-    uint64_t newSize = plFileInfo(fTempPagePath).FileSize();
+    fResMgr->SetProgressBarProc(nullptr);
 
-    if (!loaded)
+    if (numRooms == 0)
     {
         puts("no scene node.");
+        return;
     }
-    else if (fOptimized)
-    {
-        plFileSystem::Unlink(fTempPagePath);
-        puts("already optimized.");
-    }
-    else if (oldSize == newSize)
-    {
-        plFileSystem::Unlink(fPagePath);
-        plFileSystem::Move(fTempPagePath, fPagePath);
 
-        puts("complete");
-    }
-    else
+    IReportIO("before");
+
+    for (PageData& page : fPages)
     {
-        plFileSystem::Unlink(fTempPagePath);
-        puts("failed.  File sizes different");
+        if (!page.fNode)
+        {
+            ST::printf("{}: not a valid page.\n", page.fPath);
+            continue;
+        }
+
+        ILayoutPage(page);
+
+        uint64_t oldSize = plFileInfo(page.fPath).FileSize();
+        bool valid = IRewritePage(page);
+        uint64_t newSize = plFileInfo(page.fTempPath).FileSize();
+
+        ST::printf("{}: ", page.fPath.GetFileName());
+        if (!valid)
+        {
+            plFileSystem::Unlink(page.fTempPath);
+            puts("failed.  Rewritten page didn't verify");
+        }
+        else if (page.fOptimized && oldSize == newSize)
+        {
+            plFileSystem::Unlink(page.fTempPath);
+            puts("already optimized.");
+        }
+        else
+        {
+            plFileSystem::Unlink(page.fPath);
+            plFileSystem::Move(page.fTempPath, page.fPath);
+
+            ST::printf("complete ({} bytes of alignment)\n", int64_t(newSize) - int64_t(oldSize));
+        }
     }
+
+    IReportIO("after");
 }
 
 void plPageOptimizer::KeyedObjectProc(plKey key)
@@ -164,26 +302,73 @@ void plPageOptimizer::KeyedObjectProc(plKey key)
     ST::string keyName = key->GetName();
     const char* className = plFactory::GetNameOfClass(key->GetUoid().GetClassType());
 
-    // For now, ignore any key that isn't in the location we're looking at.  That means stuff like textures.
-    if (fInstance->fLoc != key->GetUoid().GetLocation())
+    // Ignore anything that isn't in one of the pages we're optimizing
+    if (!fInstance->IFindPage(key->GetUoid().GetLocation()))
         return;
 
-    KeySet& loadedKeys = fInstance->fLoadedKeys;
-    KeyVec& loadOrder = fInstance->fKeyLoadOrder;
-
-    KeySet::iterator it = loadedKeys.lower_bound(key);
-    if (it != loadedKeys.end() && *it == key)
+    KeySet& roomKeys = fInstance->fRoomKeys;
+    KeySet::iterator it = roomKeys.lower_bound(key);
+    if (it != roomKeys.end() && *it == key)
     {
         printf("Keyed object %s(%s) loaded more than once\n", keyName.c_str(), className);
+        return;
+    }
+    roomKeys.insert(it, key);
+
+    auto info = fInstance->fLoadInfo.find(key);
+    if (info == fInstance->fLoadInfo.end())
+    {
+        KeyLoadInfo& newInfo = fInstance->fLoadInfo[key];
+        newInfo.fFirstLoad = fInstance->fKeyLoadOrder.size();
+        newInfo.fRooms.push_back(fInstance->fCurRoom);
+        fInstance->fKeyLoadOrder.push_back(key);
     }
     else
+        info->second.fRooms.push_back(fInstance->fCurRoom);
+}
+
+void plPageOptimizer::ILayoutPage(PageData& page)
+{
+    // Objects loaded by exactly the same rooms form a cluster, which goes
+    // where its first object was first loaded. So each room's page-in reads
+    // its own objects in one run, and the objects shared with other rooms in
+    // another, rather than picking them out from between the rest.
+    std::map<std::vector<size_t>, size_t> clusterStart;
+    KeyVec loaded;
+    for (const plKey& key : page.fAllKeys)
     {
-        loadedKeys.insert(it, key);
-        loadOrder.push_back(key);
+        auto info = fLoadInfo.find(key);
+        if (info == fLoadInfo.end())
+            continue;
+
+        loaded.push_back(key);
+        auto cluster = clusterStart.emplace(info->second.fRooms, info->second.fFirstLoad);
+        if (!cluster.second)
+            cluster.first->second = std::min(cluster.first->second, info->second.fFirstLoad);
+    }
+
+    std::sort(loaded.begin(), loaded.end(), [this, &clusterStart](const plKey& a, const plKey& b) {
+        const KeyLoadInfo& infoA = fLoadInfo[a];
+        const KeyLoadInfo& infoB = fLoadInfo[b];
+        size_t clusterA = clusterStart[infoA.fRooms];
+        size_t clusterB = clusterStart[infoB.fRooms];
+        if (clusterA != clusterB)
+            return clusterA < clusterB;
+        return infoA.fFirstLoad < infoB.fFirstLoad;
+    });
+
+    page.fLayout = loaded;
+
+    // If there are any objects that didn't load (because nothing referenced
+    // them, or for some other reason), put them at the end
+    for (const plKey& key : page.fAllKeys)
+    {
+        if (fLoadInfo.find(key) == fLoadInfo.end())
+            page.fLayout.push_back(key);
     }
 }
 
-void plPageOptimizer::IWriteKeyData(hsStream* oldPage, hsStream* newPage, plKey key)
+void plPageOptimizer::IWriteKeyData(hsStream* oldPage, hsStream* newPage, PageData& page, plKey key)
 {
     class plUpdateKeyImp : public plKeyImp
     {
@@ -200,83 +385,122 @@ void plPageOptimizer::IWriteKeyData(hsStream* oldPage, hsStream* newPage, plKey
         fBuf.resize(len);
     oldPage->Read(len, &fBuf[0]);
 
+    // Big objects start on an alignment boundary, so they can be mapped
+    // straight out of the file and don't straddle more blocks than they need
     uint32_t newStartPos = newPage->GetPosition();
+    if (len >= kAlignMinSize && (newStartPos % kAlignment) != 0)
+    {
+        uint32_t padding = kAlignment - (newStartPos % kAlignment);
+        std::vector<uint8_t> zeros(padding);
+        newPage->Write(padding, zeros.data());
+        newStartPos += padding;
+    }
 
     // If we move any buffers, this page wasn't optimized already
     if (newStartPos != startPos)
-        fOptimized = false;
+        page.fOptimized = false;
 
     keyImp->SetStartPos(newStartPos);
     newPage->Write(len, &fBuf[0]);
 }
 
-void plPageOptimizer::IRewritePage()
+bool plPageOptimizer::IRewritePage(PageData& page)
 {
     hsUNIXStream newPage;
-
-    if (newPage.Open(fTempPagePath, "wb"))
+    if (!newPage.Open(page.fTempPath, "wb"))
+        return false;
+
+    hsUNIXStream oldPage;
+    oldPage.Open(page.fPath);
+
+    // Header first, we'll come back and fill in the offsets at the end
+    plPageInfo pageInfo = page.fNode->GetPageInfo();
+    pageInfo.Write(&newPage);
+    pageInfo.SetDataStart(newPage.GetPosition());
+
+    // Write the objects, and note the stretches the loaded ones end up in.
+    // Alignment padding doesn't break up a stretch, it's cheaper to read
+    // through it than to skip it.
+    page.fLoadOrder.clear();
+    for (const plKey& key : page.fLayout)
     {
-        hsUNIXStream oldPage;
-        oldPage.Open(fPagePath);
-
-        const plPageInfo& pageInfo = fPageNode->GetPageInfo();
-
-        uint32_t dataStart = pageInfo.GetDataStart();
-
-        fBuf.resize(dataStart);
-
-        oldPage.Read(dataStart, &fBuf[0]);
-        newPage.Write(dataStart, &fBuf[0]);
-
-        int size = (int)fKeyLoadOrder.size();
-        for (int i = 0; i < size; i++)
-            IWriteKeyData(&oldPage, &newPage, fKeyLoadOrder[i]);
-
-        // If there are any objects that we didn't write (because they didn't load for
-        // some reason), put them at the end
-        for (int i = 0; i < fAllKeys.size(); i++)
+        IWriteKeyData(&oldPage, &newPage, page, key);
+        if (fLoadInfo.find(key) == fLoadInfo.end())
+            continue;
+
+        plKeyImp* imp = (plKeyImp*)key;
+        uint32_t start = imp->GetStartPos();
+        uint32_t end = start + imp->GetDataLen();
+        if (!page.fLoadOrder.empty())
         {
-            bool found = (fLoadedKeys.find(fAllKeys[i]) != fLoadedKeys.end());
-            if (!found)
-                IWriteKeyData(&oldPage, &newPage, fAllKeys[i]);
+            plRegistryPageNode::LoadExtent& last = page.fLoadOrder.back();
+            if (start >= last.fStart + last.fLength && start - (last.fStart + last.fLength) < kAlignment)
+            {
+                last.fLength = end - last.fStart;
+                continue;
+            }
         }
+        page.fLoadOrder.push_back({ start, end - start });
+    }
 
-        uint32_t oldKeyStart = pageInfo.GetIndexStart();
-        oldPage.SetPosition(oldKeyStart);
+    pageInfo.SetIndexStart(newPage.GetPosition());
 
-        uint32_t numTypes = oldPage.ReadLE32();
-        newPage.WriteLE32(numTypes);
+    uint32_t oldKeyStart = page.fNode->GetPageInfo().GetIndexStart();
+    oldPage.SetPosition(oldKeyStart);
 
-        for (uint32_t i = 0; i < numTypes; i++)
-        {
-            uint16_t classType = oldPage.ReadLE16();
-            uint32_t len = oldPage.ReadLE32();
-            uint8_t flags = oldPage.ReadByte();
-            uint32_t numKeys = oldPage.ReadLE32();
+    uint32_t numTypes = oldPage.ReadLE32();
+    newPage.WriteLE32(numTypes);
+
+    for (uint32_t i = 0; i < numTypes; i++)
+    {
+        uint16_t classType = oldPage.ReadLE16();
+        uint32_t len = oldPage.ReadLE32();
+        uint8_t flags = oldPage.ReadByte();
+        uint32_t numKeys = oldPage.ReadLE32();
 
-            newPage.WriteLE16(classType);
-            newPage.WriteLE32(len);
-            newPage.WriteByte(flags);
-            newPage.WriteLE32(numKeys);
+        newPage.WriteLE16(classType);
+        newPage.WriteLE32(len);
+        newPage.WriteByte(flags);
+        newPage.WriteLE32(numKeys);
 
-            for (uint32_t j = 0; j < numKeys; j++)
-            {
-                plUoid uoid;
-                uoid.Read(&oldPage);
-                uint32_t startPos = oldPage.ReadLE32();
-                uint32_t dataLen = oldPage.ReadLE32();
-
-                // Get the new start pos
-                plKeyImp* key = (plKeyImp*)fResMgr->FindKey(uoid);
-                startPos = key->GetStartPos();
-
-                uoid.Write(&newPage);
-                newPage.WriteLE32(startPos);
-                newPage.WriteLE32(dataLen);
-            }
+        for (uint32_t j = 0; j < numKeys; j++)
+        {
+            plUoid uoid;
+            uoid.Read(&oldPage);
+            uint32_t startPos = oldPage.ReadLE32();
+            uint32_t dataLen = oldPage.ReadLE32();
+
+            // Get the new start pos
+            plKeyImp* key = (plKeyImp*)fResMgr->FindKey(uoid);
+            startPos = key->GetStartPos();
+
+            uoid.Write(&newPage);
+            newPage.WriteLE32(startPos);
+            newPage.WriteLE32(dataLen);
         }
-
-        newPage.Close();
-        oldPage.Close();
     }
+
+    // The index the resource manager reads ahead with
+    plRegistryPageNode::WriteLoadOrder(&newPage, page.fLoadOrder);
+
+    const plRegistryPageNode::LoadOrder& oldLoadOrder = page.fNode->GetLoadOrder();
+    bool sameLoadOrder = std::equal(oldLoadOrder.begin(), oldLoadOrder.end(),
+                                    page.fLoadOrder.begin(), page.fLoadOrder.end(),
+                                    [](const plRegistryPageNode::LoadExtent& a, const plRegistryPageNode::LoadExtent& b) {
+                                        return a.fStart == b.fStart && a.fLength == b.fLength;
+                                    });
+    if (!sameLoadOrder)
+        page.fOptimized = false;
+
+    // Rewind and write the pageinfo with the correct offsets
+    pageInfo.SetChecksum(newPage.GetPosition() - pageInfo.GetDataStart());
+    newPage.Rewind();
+    pageInfo.Write(&newPage);
+
+    newPage.Close();
+    oldPage.Close();
+
+    // Make sure the new page checks out the same as the old one did
+    plRegistryPageNode check(page.fTempPath);
+    return check.GetPageCondition() == page.fNode->GetPageCondition();
 }
@@ -44,42 +44,75 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "pnKeyedObject/plUoid.h"
 #include "plFileSystem.h"
+
+#include "plResMgr/plRegistryNode.h"
+
+#include <map>
 #include <vector>
 #include <set>
 
 class plKey;
-class plRegistryPageNode;
 class plResManager;
 
+// Lays out the pages of an age for fast loading. Every room is paged in
+// once to see which objects get read and in what order. Then each page is
+// rewritten:
+//   - Objects that are loaded by the same set of rooms are grouped together,
+//     in the order they were first read.
+//   - Big objects (textures, vertex data) start on kAlignment boundaries.
+//   - A load order index goes after the key index, for the resource
+//     manager to read ahead with.
 class plPageOptimizer
 {
 protected:
     typedef std::vector<plKey> KeyVec;
     typedef std::set<plKey> KeySet;
 
-    KeyVec fKeyLoadOrder;   // The order objects were loaded in
-    KeySet fLoadedKeys;     // Keys we've loaded objects for, for quick lookup
-    KeyVec fAllKeys;        // All the keys in the page
+    struct PageData
+    {
+        plFileName fPath;               // Path to our page
+        plFileName fTempPath;           // Path to the temp output page
+        plLocation fLoc;                // Location of our page
+        plRegistryPageNode* fNode;      // PageNode for our page
+        KeyVec fAllKeys;                // All the keys in the page
+        KeyVec fLayout;                 // The order to write the keys in
+        plRegistryPageNode::LoadOrder fLoadOrder;
+        bool fOptimized;                // True after rewriting if the page was already optimized
+    };
+
+    struct KeyLoadInfo
+    {
+        size_t fFirstLoad;              // Index of the first load in fKeyLoadOrder
+        std::vector<size_t> fRooms;     // The rooms whose page-in loaded this key
+    };
+
+    std::vector<PageData> fPages;
+    KeyVec fKeyLoadOrder;               // The order objects were first loaded in
+    std::map<plKey, KeyLoadInfo> fLoadInfo;
+    KeySet fRoomKeys;                   // Keys loaded by the current room, to catch double loads
+    size_t fCurRoom;
     std::vector<uint8_t> fBuf;
 
-    bool fOptimized;        // True after optimization if the page was already optimized
-
-    plFileName fPagePath;           // Path to our page
-    plFileName fTempPagePath;       // Path to the temp output page
-    plLocation fLoc;                // Location of our page
-    plRegistryPageNode* fPageNode;  // PageNode for our page
-
     plResManager* fResMgr;
 
     static plPageOptimizer* fInstance;
     static void KeyedObjectProc(plKey key);
 
-    void IWriteKeyData(hsStream* oldPage, hsStream* newPage, plKey key);
-    void IFindLoc();
-    void IRewritePage();
+    PageData* IFindPage(const plLocation& loc);
+    void IFindLocs();
+    void ILayoutPage(PageData& page);
+    void IWriteKeyData(hsStream* oldPage, hsStream* newPage, PageData& page, plKey key);
+    bool IRewritePage(PageData& page);
+    void IReportIO(const char* when);
 
 public:
-    plPageOptimizer(const plFileName& pagePath);
+    enum
+    {
+        kAlignment      = 4 * 1024,     // Where big objects start
+        kAlignMinSize   = 32 * 1024,    // How big an object has to be to get aligned
+    };
+
+    plPageOptimizer(const std::vector<plFileName>& pagePaths);
 
     void Optimize();
 };
@@ -993,6 +993,73 @@ void hsBounds3Ext::Transform(const hsMatrix44 *m)
     fBounds3Flags &= ~kCenterValid;
 }
 
+void hsBounds3Ext::TransformBatch(const hsMatrix44& m, size_t count, const hsBounds3Ext* const src[], hsBounds3Ext* const dst[])
+{
+    constexpr size_t kChunk = 32;
+    hsPoint3 corners[kChunk];
+    hsVector3 axes[kChunk * 3];
+
+    for (size_t first = 0; first < count; first += kChunk)
+    {
+        const size_t n = std::min(count - first, kChunk);
+
+        // Stage everything the matrix touches, flagged the way Transform does
+        for (size_t i = 0; i < n; i++)
+        {
+            hsBounds3Ext& bnd = *dst[first + i];
+            bnd = *src[first + i];
+            if( bnd.fType != kBoundsNormal )
+            {
+                corners[i].Set(0, 0, 0);
+                axes[i * 3 + 0].Set(0, 0, 0);
+                axes[i * 3 + 1].Set(0, 0, 0);
+                axes[i * 3 + 2].Set(0, 0, 0);
+                continue;
+            }
+
+            if( bnd.fExtFlags & kAxisAligned )
+            {
+                bnd.fExtFlags = 0;
+                corners[i] = bnd.fMins;
+                for (int j = 0; j < 3; j++)
+                {
+                    float span = bnd.fMaxs[j] - bnd.fMins[j];
+                    if( span < kRealSmall )
+                    {
+                        bnd.fExtFlags |= kAxisZeroZero << j;
+                        span = 1.f;
+                    }
+                    axes[i * 3 + j].Set(0, 0, 0);
+                    axes[i * 3 + j][j] = span;
+                }
+            }
+            else
+            {
+                corners[i] = bnd.fCorner;
+                for (int j = 0; j < 3; j++)
+                    axes[i * 3 + j] = bnd.fAxes[j];
+                bnd.fExtFlags &= kAxisZeroZero|kAxisOneZero|kAxisTwoZero;
+            }
+        }
+
+        m.MapPoints(n, corners, corners);
+        m.MapVectors(n * 3, axes, axes);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            hsBounds3Ext& bnd = *dst[first + i];
+            if( bnd.fType != kBoundsNormal )
+                continue;
+
+            bnd.fCorner = corners[i];
+            for (int j = 0; j < 3; j++)
+                bnd.fAxes[j] = axes[i * 3 + j];
+            bnd.IMakeMinsMaxs();
+            bnd.fBounds3Flags &= ~kCenterValid;
+        }
+    }
+}
+
 void hsBounds3Ext::Translate(const hsVector3 &v)
 {
     if( fType != kBoundsNormal )
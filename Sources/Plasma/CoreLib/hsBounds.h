@@ -270,6 +270,10 @@ public:
     void Transform(const hsMatrix44 *m) override;
     virtual void Translate(const hsVector3 &v);
 
+    // Sets each dst to its src transformed by m. Same as copying and calling
+    // Transform on each, but the corners and axes go through m in batches.
+    static void TransformBatch(const hsMatrix44& m, size_t count, const hsBounds3Ext* const src[], hsBounds3Ext* const dst[]);
+
     virtual float GetRadius() const;
     virtual void GetAxes(hsVector3 *fAxis0, hsVector3 *fAxis1, hsVector3 *fAxis2) const;
     virtual hsPoint3 *GetCorner(hsPoint3 *c) const { *c = (fExtFlags & kAxisAligned ? fMins : fCorner); return c; }
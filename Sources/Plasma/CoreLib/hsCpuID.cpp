@@ -58,6 +58,9 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "hsCpuID.h"
 
+#include <algorithm>
+#include <thread>
+
 hsCpuId::hsCpuId() {
     enum : unsigned int {
         // EAX=1; EDX=:
@@ -101,13 +104,14 @@ hsCpuId::hsCpuId() {
     // check if the CPU supports the cpuid instruction.
     if (CPUInfo_Features.eax != 0) {
         __cpuid(CPUInfo_Features.array, 1);
-        __cpuid(CPUInfo_Ext.array, 7);
+        __cpuidex(CPUInfo_Ext.array, 7, 0);
     }
 #elif defined(GCC_COMPATIBLE)
     __get_cpuid(1, &CPUInfo_Features.eax, &CPUInfo_Features.ebx,
                    &CPUInfo_Features.ecx, &CPUInfo_Features.edx);
-    __get_cpuid(7, &CPUInfo_Ext.eax, &CPUInfo_Ext.ebx,
-                   &CPUInfo_Ext.ecx, &CPUInfo_Ext.edx);
+    // Leaf 7 has subleaves, and __get_cpuid() leaves ECX as it finds it
+    __get_cpuid_count(7, 0, &CPUInfo_Ext.eax, &CPUInfo_Ext.ebx,
+                      &CPUInfo_Ext.ecx, &CPUInfo_Ext.edx);
 #endif
 
 
@@ -119,6 +123,8 @@ hsCpuId::hsCpuId() {
     has_sse42   = (CPUInfo_Features.ecx & sse42_flag) || false;
     has_avx     = (CPUInfo_Features.ecx & avx_flag)   || false;
     has_avx2    = (CPUInfo_Ext.ebx      & avx2_flag)  || false;
+
+    num_threads = std::max(std::thread::hardware_concurrency(), 1U);
 }
 
 const hsCpuId& hsCpuId::Instance()
@@ -85,6 +85,8 @@ struct hsCpuId {
     bool has_avx;
     bool has_avx2;
 
+    unsigned num_threads;   // hardware threads, at least 1
+
     hsCpuId();
     static const hsCpuId& Instance();
 };
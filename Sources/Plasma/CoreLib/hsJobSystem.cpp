@@ -0,0 +1,408 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "hsJobSystem.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "hsCpuID.h"
+#include "hsThread.h"
+
+hsJobSystem* hsJobSystem::fInstance = nullptr;
+
+// Which queue the current thread owns, if it is one of our workers
+static thread_local hsJobSystem* s_workerOwner = nullptr;
+static thread_local size_t s_workerIdx = 0;
+
+/////////////////////////////////////////////////////////////////////////////
+
+// The owner pushes and pops at the back, thieves take from the front, so
+// the owner keeps working on the jobs that are still hot in its cache.
+struct hsJobSystem::JobQueue
+{
+    std::mutex              fLock;
+    std::deque<hsJobHandle> fJobs;
+
+    void Push(hsJobHandle job)
+    {
+        hsLockGuard(fLock);
+        fJobs.push_back(std::move(job));
+    }
+
+    hsJobHandle Pop()
+    {
+        hsLockGuard(fLock);
+        if (fJobs.empty())
+            return nullptr;
+        hsJobHandle job = std::move(fJobs.back());
+        fJobs.pop_back();
+        return job;
+    }
+
+    // Pulls a specific job out of the queue, if it's still there
+    bool Take(const hsJob* job)
+    {
+        hsLockGuard(fLock);
+        auto it = std::find_if(fJobs.begin(), fJobs.end(),
+                               [job](const hsJobHandle& queued) { return queued.get() == job; });
+        if (it == fJobs.end())
+            return false;
+        fJobs.erase(it);
+        return true;
+    }
+
+    hsJobHandle Steal()
+    {
+        hsLockGuard(fLock);
+        if (fJobs.empty())
+            return nullptr;
+        hsJobHandle job = std::move(fJobs.front());
+        fJobs.pop_front();
+        return job;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+class hsJobWorker : public hsThread
+{
+    hsJobSystem*    fSystem;
+    size_t          fIdx;
+
+public:
+    hsJobWorker(hsJobSystem* system, size_t idx) : fSystem(system), fIdx(idx) { }
+
+    void Run() override { fSystem->IWorkerLoop(fIdx); }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
+hsJobSystem::hsJobSystem(size_t numWorkers)
+    : fMainQueue(new JobQueue), fMainThreadId(std::this_thread::get_id()),
+      fNextQueue(0), fQueued(0), fQuitting(false)
+{
+    if (numWorkers == 0) {
+        unsigned threads = hsCpuId::Instance().num_threads;
+        numWorkers = threads > 1 ? threads - 1 : 1;
+    }
+
+    fQueues.reserve(numWorkers);
+    for (size_t i = 0; i < numWorkers; ++i)
+        fQueues.push_back(new JobQueue);
+
+    // Only start the threads once every queue exists, since they steal from each other
+    fWorkers.reserve(numWorkers);
+    for (size_t i = 0; i < numWorkers; ++i) {
+        hsJobWorker* worker = new hsJobWorker(this, i);
+        fWorkers.push_back(worker);
+        worker->Start();
+    }
+}
+
+hsJobSystem::~hsJobSystem()
+{
+    {
+        hsLockGuard(fSleepLock);
+        fQuitting = true;
+    }
+    fSleepCond.notify_all();
+
+    for (hsJobWorker* worker : fWorkers) {
+        worker->Stop();
+        delete worker;
+    }
+
+    // Anything still queued was never going to run; drop it
+    for (JobQueue* queue : fQueues)
+        delete queue;
+    delete fMainQueue;
+}
+
+void hsJobSystem::Initialize(size_t numWorkers)
+{
+    hsAssert(!fInstance, "hsJobSystem already initialized");
+    fInstance = new hsJobSystem(numWorkers);
+}
+
+void hsJobSystem::Shutdown()
+{
+    delete fInstance;
+    fInstance = nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+hsJobHandle hsJobSystem::ISubmit(hsJobHandle job, const std::vector<hsJobHandle>& deps)
+{
+    for (const hsJobHandle& dep : deps) {
+        if (!dep)
+            continue;
+
+        hsLockGuard(dep->fLock);
+        if (!dep->fDone) {
+            job->fPending++;
+            dep->fContinuations.push_back(job);
+            job->fDeps.push_back(dep);
+        }
+    }
+
+    // Drop the submission hold; whoever brings this to zero queues the job
+    if (--job->fPending == 0)
+        ISchedule(job);
+    return job;
+}
+
+hsJobHandle hsJobSystem::Submit(JobFunc func, const std::vector<hsJobHandle>& deps)
+{
+    return ISubmit(std::make_shared<hsJob>(std::move(func), false), deps);
+}
+
+hsJobHandle hsJobSystem::SubmitMainThread(JobFunc func, const std::vector<hsJobHandle>& deps)
+{
+    return ISubmit(std::make_shared<hsJob>(std::move(func), true), deps);
+}
+
+void hsJobSystem::ISchedule(const hsJobHandle& job)
+{
+    if (job->fMainThread) {
+        fMainQueue->Push(job);
+        return;
+    }
+
+    // Count it before it can be taken, so the count never drops below zero
+    // and a worker about to sleep sees it.
+    fQueued++;
+    if (s_workerOwner == this)
+        fQueues[s_workerIdx]->Push(job);
+    else
+        fQueues[fNextQueue++ % fQueues.size()]->Push(job);
+
+    {
+        hsLockGuard(fSleepLock);
+    }
+    fSleepCond.notify_one();
+}
+
+void hsJobSystem::IRun(const hsJobHandle& job)
+{
+    job->fFunc();
+    job->fFunc = nullptr;   // release anything the job captured
+
+    std::vector<hsJobHandle> continuations;
+    {
+        hsLockGuard(job->fLock);
+        job->fDone.store(true, std::memory_order_release);
+        continuations.swap(job->fContinuations);
+        job->fDeps.clear();
+    }
+    job->fDoneCond.notify_all();
+
+    for (const hsJobHandle& next : continuations) {
+        if (--next->fPending == 0)
+            ISchedule(next);
+    }
+}
+
+hsJobHandle hsJobSystem::IFindJob(size_t self)
+{
+    hsJobHandle job;
+    if (self < fQueues.size())
+        job = fQueues[self]->Pop();
+
+    for (size_t i = 0; !job && i < fQueues.size(); ++i) {
+        size_t victim = (self + 1 + i) % fQueues.size();
+        if (victim != self)
+            job = fQueues[victim]->Steal();
+    }
+
+    if (job)
+        fQueued--;
+    return job;
+}
+
+bool hsJobSystem::ITryRunOne()
+{
+    // Threads outside the pool have no queue of their own and only steal
+    size_t self = (s_workerOwner == this) ? s_workerIdx : fQueues.size();
+    hsJobHandle job = IFindJob(self);
+    if (!job)
+        return false;
+
+    IRun(job);
+    return true;
+}
+
+bool hsJobSystem::ITryRunMainThreadDep(const hsJobHandle& job)
+{
+    // Walk back from job to the main thread jobs it is still waiting on.
+    // Anything else in the main queue belongs to RunMainThreadJobs().
+    std::vector<hsJobHandle> stack { job };
+    std::vector<const hsJob*> visited;
+    while (!stack.empty()) {
+        hsJobHandle next = std::move(stack.back());
+        stack.pop_back();
+        if (next->IsDone() || std::find(visited.begin(), visited.end(), next.get()) != visited.end())
+            continue;
+        visited.push_back(next.get());
+
+        if (next->fMainThread && next->fPending == 0 && fMainQueue->Take(next.get())) {
+            IRun(next);
+            return true;
+        }
+
+        std::vector<std::weak_ptr<hsJob>> deps;
+        {
+            hsLockGuard(next->fLock);
+            deps = next->fDeps;
+        }
+        for (const std::weak_ptr<hsJob>& dep : deps) {
+            if (hsJobHandle locked = dep.lock())
+                stack.push_back(std::move(locked));
+        }
+    }
+    return false;
+}
+
+void hsJobSystem::IWorkerLoop(size_t idx)
+{
+    s_workerOwner = this;
+    s_workerIdx = idx;
+
+    for (;;) {
+        hsJobHandle job = IFindJob(idx);
+        if (job) {
+            IRun(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(fSleepLock);
+        fSleepCond.wait(lock, [this]() { return fQuitting || fQueued.load() > 0; });
+        if (fQuitting)
+            break;
+    }
+
+    s_workerOwner = nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void hsJobSystem::ParallelFor(size_t begin, size_t end, size_t grain, const RangeFunc& func)
+{
+    if (end <= begin)
+        return;
+
+    size_t count = end - begin;
+    grain = std::max<size_t>(grain, 1);
+
+    // A few chunks per thread is plenty to balance the load without
+    // drowning the queues in tiny jobs.
+    size_t maxChunks = (fWorkers.size() + 1) * 4;
+    size_t numChunks = std::min((count + grain - 1) / grain, maxChunks);
+    if (numChunks <= 1) {
+        func(begin, end);
+        return;
+    }
+
+    size_t chunkSize = (count + numChunks - 1) / numChunks;
+    std::vector<hsJobHandle> jobs;
+    jobs.reserve(numChunks);
+    for (size_t chunk = begin + chunkSize; chunk < end; chunk += chunkSize) {
+        size_t chunkEnd = std::min(chunk + chunkSize, end);
+        jobs.push_back(Submit([&func, chunk, chunkEnd]() { func(chunk, chunkEnd); }));
+    }
+
+    // Do the first chunk ourselves rather than sit idle
+    func(begin, std::min(begin + chunkSize, end));
+    Wait(jobs);
+}
+
+void hsJobSystem::Wait(const hsJobHandle& job)
+{
+    if (!job)
+        return;
+
+    hsAssert(!job->fMainThread || IsMainThread(), "Waiting on a main thread job from another thread will never finish");
+
+    bool mainThread = IsMainThread();
+    while (!job->IsDone()) {
+        if (mainThread && ITryRunMainThreadDep(job))
+            continue;
+        if (ITryRunOne())
+            continue;
+
+        // Nothing to help with, so the job is running elsewhere.  Check back
+        // now and then in case it spawns more work we could take.
+        std::unique_lock<std::mutex> lock(job->fLock);
+        job->fDoneCond.wait_for(lock, std::chrono::milliseconds(1), [&job]() { return job->IsDone(); });
+    }
+}
+
+void hsJobSystem::Wait(const std::vector<hsJobHandle>& jobs)
+{
+    for (const hsJobHandle& job : jobs)
+        Wait(job);
+}
+
+size_t hsJobSystem::RunMainThreadJobs()
+{
+    hsAssert(IsMainThread(), "RunMainThreadJobs called off the main thread");
+
+    // Jobs queued by the ones we run here wait for the next call, so a job
+    // that requeues itself can't stall the frame.  Take them one at a time
+    // rather than all at once, so a job here that Wait()s on one of the others
+    // can still find it in the main queue and run it.
+    size_t batch;
+    {
+        hsLockGuard(fMainQueue->fLock);
+        batch = fMainQueue->fJobs.size();
+    }
+
+    size_t count = 0;
+    for (; count < batch; ++count) {
+        hsJobHandle job = fMainQueue->Steal();
+        if (!job)
+            break;
+        IRun(job);
+    }
+    return count;
+}
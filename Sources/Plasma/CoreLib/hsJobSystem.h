@@ -0,0 +1,173 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#ifndef hsJobSystem_inc
+#define hsJobSystem_inc
+
+#include "HeadSpin.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////
+//
+// hsJobSystem - Shared work-stealing job scheduler
+//
+// Each worker owns a job queue.  Workers run their own jobs newest
+// first, and steal the oldest jobs from the other queues when they
+// run dry.  Jobs may depend on other jobs; a job is only queued once
+// everything it depends on has finished.  Jobs submitted with
+// SubmitMainThread() are never run by the workers, only by
+// RunMainThreadJobs(), or by a Wait() on the main thread for a job
+// that cannot finish without them.
+//
+//     == Example Usage ==
+//
+//  hsJobSystem& jobs = hsJobSystem::Instance();
+//  hsJobHandle cull = jobs.Submit([&]() { ... });
+//  hsJobHandle sort = jobs.Submit([&]() { ... }, { cull });
+//  jobs.ParallelFor(0, spans.size(), 64, [&](size_t begin, size_t end) {
+//      ...
+//  });
+//  jobs.Wait(sort);
+//
+//////////////////////////////////////////////////////////////////////
+
+class hsJob;
+class hsJobWorker;
+typedef std::shared_ptr<hsJob> hsJobHandle;
+
+class hsJob
+{
+    friend class hsJobSystem;
+
+    std::function<void()>       fFunc;
+    std::atomic<int>            fPending;   // unfinished dependencies, plus one while being submitted
+    std::atomic<bool>           fDone;
+    bool                        fMainThread;
+
+    std::mutex                  fLock;
+    std::condition_variable     fDoneCond;
+    std::vector<hsJobHandle>    fContinuations;
+    std::vector<std::weak_ptr<hsJob>> fDeps;    // what was unfinished at submit time, for Wait()
+
+public:
+    hsJob(std::function<void()> func, bool mainThread)
+        : fFunc(std::move(func)), fPending(1), fDone(false), fMainThread(mainThread)
+    { }
+
+    bool IsDone() const { return fDone.load(std::memory_order_acquire); }
+};
+
+class hsJobSystem
+{
+public:
+    typedef std::function<void()> JobFunc;
+    typedef std::function<void(size_t, size_t)> RangeFunc;
+
+protected:
+    struct JobQueue;
+
+    static hsJobSystem*         fInstance;
+
+    std::vector<JobQueue*>      fQueues;        // one per worker
+    std::vector<hsJobWorker*>   fWorkers;
+    JobQueue*                   fMainQueue;
+    std::thread::id             fMainThreadId;
+    std::atomic<size_t>         fNextQueue;     // round robin for jobs submitted from outside the pool
+
+    std::atomic<size_t>         fQueued;        // worker jobs waiting in any queue
+    std::mutex                  fSleepLock;
+    std::condition_variable     fSleepCond;
+    bool                        fQuitting;
+
+    friend class hsJobWorker;
+
+    hsJobHandle ISubmit(hsJobHandle job, const std::vector<hsJobHandle>& deps);
+    void ISchedule(const hsJobHandle& job);
+    void IRun(const hsJobHandle& job);
+    bool ITryRunOne();
+    bool ITryRunMainThreadDep(const hsJobHandle& job);
+    hsJobHandle IFindJob(size_t self);
+    void IWorkerLoop(size_t idx);
+
+public:
+    // numWorkers == 0 leaves one hardware thread free for the caller
+    hsJobSystem(size_t numWorkers = 0);
+    ~hsJobSystem();
+
+    hsJobSystem(const hsJobSystem&) = delete;
+    hsJobSystem& operator=(const hsJobSystem&) = delete;
+
+    static void Initialize(size_t numWorkers = 0);
+    static void Shutdown();
+    static hsJobSystem& Instance() { return *fInstance; }
+    static bool InstanceValid() { return fInstance != nullptr; }
+
+    size_t GetNumWorkers() const { return fWorkers.size(); }
+    bool IsMainThread() const { return std::this_thread::get_id() == fMainThreadId; }
+
+    // Queue func to run once all of deps have finished
+    hsJobHandle Submit(JobFunc func, const std::vector<hsJobHandle>& deps = {});
+    // Same as Submit, but func is only ever run on the thread that created the job system
+    hsJobHandle SubmitMainThread(JobFunc func, const std::vector<hsJobHandle>& deps = {});
+
+    // Splits [begin, end) into chunks of at least grain items and runs func on
+    // them across the pool.  The calling thread takes part, and this only
+    // returns once every chunk is done.
+    void ParallelFor(size_t begin, size_t end, size_t grain, const RangeFunc& func);
+
+    // Runs other jobs until job is done.  On the main thread, this only runs
+    // the main thread jobs that job is waiting on, never unrelated ones.
+    void Wait(const hsJobHandle& job);
+    void Wait(const std::vector<hsJobHandle>& jobs);
+
+    // Runs every main thread job that is ready.  Call this once a frame.
+    size_t RunMainThreadJobs();
+};
+
+#endif // hsJobSystem_inc
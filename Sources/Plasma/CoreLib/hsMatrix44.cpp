@@ -42,6 +42,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 *==LICENSE==*/
 
 #include "hsMatrix44.h"
+#include "hsMatrix44_Private.h"
 
 
 #include "HeadSpin.h"
@@ -142,6 +143,68 @@ hsCpuFunctionDispatcher<hsMatrix44::mat_mult_ptr> hsMatrix44::mat_mult {
     &hsMatrix44::mult_sse3
 };
 
+hsCpuFunctionDispatcher<hsMatrix44Kernels::map_xyz_ptr> hsMatrix44Kernels::map_xyz {
+    &hsMatrix44Kernels::map_xyz_fpu,
+    nullptr,            // SSE1
+    &hsMatrix44Kernels::map_xyz_sse2,
+    nullptr,            // SSE3
+    nullptr,            // SSSE3
+    nullptr,            // SSE41
+    nullptr,            // SSE42
+    &hsMatrix44Kernels::map_xyz_avx
+};
+
+// Same sums in the same order as operator*, so the results match exactly
+template <bool _Translate>
+static void IMapFPU(const hsMatrix44& m, const uint8_t* src, size_t srcStride,
+                    uint8_t* dst, size_t dstStride, size_t count)
+{
+    for (size_t i = 0; i < count; i++, src += srcStride, dst += dstStride)
+    {
+        const float* p = reinterpret_cast<const float*>(src);
+        float x = (p[0] * m.fMap[0][0]) + (p[1] * m.fMap[0][1]) + (p[2] * m.fMap[0][2]);
+        float y = (p[0] * m.fMap[1][0]) + (p[1] * m.fMap[1][1]) + (p[2] * m.fMap[1][2]);
+        float z = (p[0] * m.fMap[2][0]) + (p[1] * m.fMap[2][1]) + (p[2] * m.fMap[2][2]);
+        if (_Translate)
+        {
+            x += m.fMap[0][3];
+            y += m.fMap[1][3];
+            z += m.fMap[2][3];
+        }
+
+        float* r = reinterpret_cast<float*>(dst);
+        r[0] = x;
+        r[1] = y;
+        r[2] = z;
+    }
+}
+
+void hsMatrix44Kernels::map_xyz_fpu(const hsMatrix44& m, const void* src, size_t srcStride,
+                                    void* dst, size_t dstStride, size_t count, bool translate)
+{
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    if (translate)
+        IMapFPU<true>(m, s, srcStride, d, dstStride, count);
+    else
+        IMapFPU<false>(m, s, srcStride, d, dstStride, count);
+}
+
+void hsMatrix44::IMap(const void* src, size_t srcStride, void* dst, size_t dstStride, size_t count, bool translate) const
+{
+    if (!(fFlags & hsMatrix44::kIsIdent))
+    {
+        hsMatrix44Kernels::map_xyz.call(*this, src, srcStride, dst, dstStride, count, translate);
+    }
+    else if (src != dst)
+    {
+        const uint8_t* s = static_cast<const uint8_t*>(src);
+        uint8_t* d = static_cast<uint8_t*>(dst);
+        for (size_t i = 0; i < count; i++, s += srcStride, d += dstStride)
+            memcpy(d, s, sizeof(float) * 3);
+    }
+}
+
 hsPoint3 hsMatrix44::operator*(const hsPoint3& p) const
 {
     if (fFlags & hsMatrix44::kIsIdent)
@@ -755,14 +818,7 @@ hsVector3* hsMatrix44::GetTranslate(hsVector3 *pt) const
 
 hsPoint3*  hsMatrix44::MapPoints(long count, hsPoint3 points[]) const
 {
-    if( !(fFlags & hsMatrix44::kIsIdent) )
-    {
-        int i;
-        for(i = 0; i < count; i++)
-        {
-            points[i] = *this * points[i];  
-        }
-    }
+    MapPoints(size_t(count), points, points);
     return points;
 }
 
@@ -146,6 +146,18 @@ struct hsMatrix44 {
 
     hsPoint3*           MapPoints(long count, hsPoint3 points[]) const;
 
+    // Batch transforms. src and dst may be the same, but mustn't otherwise
+    // overlap. The strided forms take byte strides, so they can work in place
+    // on the positions or normals of an interleaved vertex buffer.
+    void MapPoints(size_t count, const hsPoint3 src[], hsPoint3 dst[]) const
+        { IMap(src, sizeof(hsPoint3), dst, sizeof(hsPoint3), count, true); }
+    void MapVectors(size_t count, const hsVector3 src[], hsVector3 dst[]) const
+        { IMap(src, sizeof(hsVector3), dst, sizeof(hsVector3), count, false); }
+    void MapPoints(size_t count, const void* src, size_t srcStride, void* dst, size_t dstStride) const
+        { IMap(src, srcStride, dst, dstStride, count, true); }
+    void MapVectors(size_t count, const void* src, size_t srcStride, void* dst, size_t dstStride) const
+        { IMap(src, srcStride, dst, dstStride, count, false); }
+
     bool  IsIdentity();
     void  NotIdentity() { fFlags &= ~kIsIdent; }
 
@@ -157,12 +169,15 @@ struct hsMatrix44 {
     void Write(hsStream *stream);
 
 private:
+    void IMap(const void* src, size_t srcStride, void* dst, size_t dstStride, size_t count, bool translate) const;
+
     //  CPU-optimized functions
     typedef hsMatrix44(*mat_mult_ptr)(const hsMatrix44&, const hsMatrix44&);
     static hsCpuFunctionDispatcher<mat_mult_ptr> mat_mult;
 
     static hsMatrix44 mult_fpu(const hsMatrix44& a, const hsMatrix44& b);
     static hsMatrix44 mult_sse3(const hsMatrix44& a, const hsMatrix44& b);
+
 };
 
 ST_DECL_FORMAT_TYPE(const hsMatrix44&);
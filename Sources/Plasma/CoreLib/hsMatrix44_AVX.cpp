@@ -0,0 +1,113 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "hsMatrix44.h"
+#include "hsMatrix44_Private.h"
+
+#ifdef HAVE_AVX
+#   include <immintrin.h>
+
+static inline void IStoreXYZ(float* d, __m128 r)
+{
+    _mm_storel_pi(reinterpret_cast<__m64*>(d), r);
+    _mm_store_ss(d + 2, _mm_movehl_ps(r, r));
+}
+
+// Two points per pass, one in each half of the register, otherwise the same
+// broadcast-and-sum over the columns as the SSE2 version. Each load takes
+// a whole 16 bytes, so the last point always goes through the single path
+// to keep from reading past the end of a packed array.
+template <bool _Translate>
+static inline void IMapAVX(const hsMatrix44& m, const uint8_t* src, size_t srcStride,
+                           uint8_t* dst, size_t dstStride, size_t count)
+{
+    const __m128 c0 = _mm_set_ps(0.f, m.fMap[2][0], m.fMap[1][0], m.fMap[0][0]);
+    const __m128 c1 = _mm_set_ps(0.f, m.fMap[2][1], m.fMap[1][1], m.fMap[0][1]);
+    const __m128 c2 = _mm_set_ps(0.f, m.fMap[2][2], m.fMap[1][2], m.fMap[0][2]);
+    const __m128 c3 = _mm_set_ps(0.f, m.fMap[2][3], m.fMap[1][3], m.fMap[0][3]);
+    const __m256 c0x2 = _mm256_set_m128(c0, c0);
+    const __m256 c1x2 = _mm256_set_m128(c1, c1);
+    const __m256 c2x2 = _mm256_set_m128(c2, c2);
+    const __m256 c3x2 = _mm256_set_m128(c3, c3);
+
+    size_t i = 0;
+    for (; i + 2 < count; i += 2, src += srcStride * 2, dst += dstStride * 2)
+    {
+        const float* p0 = reinterpret_cast<const float*>(src);
+        const float* p1 = reinterpret_cast<const float*>(src + srcStride);
+        __m256 p = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p0)), _mm_loadu_ps(p1), 1);
+
+        __m256 r = _mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(p, 0x00), c0x2),
+                                 _mm256_mul_ps(_mm256_permute_ps(p, 0x55), c1x2));
+        r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(p, 0xAA), c2x2));
+        if (_Translate)
+            r = _mm256_add_ps(r, c3x2);
+
+        IStoreXYZ(reinterpret_cast<float*>(dst), _mm256_castps256_ps128(r));
+        IStoreXYZ(reinterpret_cast<float*>(dst + dstStride), _mm256_extractf128_ps(r, 1));
+    }
+
+    for (; i < count; i++, src += srcStride, dst += dstStride)
+    {
+        const float* p = reinterpret_cast<const float*>(src);
+        __m128 r = _mm_add_ps(_mm_mul_ps(_mm_broadcast_ss(p), c0), _mm_mul_ps(_mm_broadcast_ss(p + 1), c1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_broadcast_ss(p + 2), c2));
+        if (_Translate)
+            r = _mm_add_ps(r, c3);
+        IStoreXYZ(reinterpret_cast<float*>(dst), r);
+    }
+}
+#endif // HAVE_AVX
+
+void hsMatrix44Kernels::map_xyz_avx(const hsMatrix44& m, const void* src, size_t srcStride,
+                                    void* dst, size_t dstStride, size_t count, bool translate)
+{
+#ifdef HAVE_AVX
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    if (translate)
+        IMapAVX<true>(m, s, srcStride, d, dstStride, count);
+    else
+        IMapAVX<false>(m, s, srcStride, d, dstStride, count);
+    _mm256_zeroupper();
+#endif // HAVE_AVX
+}
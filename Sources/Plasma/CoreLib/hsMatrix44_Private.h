@@ -0,0 +1,69 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#ifndef _hsMatrix44_Private_h_
+#define _hsMatrix44_Private_h_
+
+#include "HeadSpin.h"
+#include "hsCpuID.h"
+
+struct hsMatrix44;
+
+// hsMatrix44's batch point/vector transform for each instruction set. The
+// MapPoints/MapVectors family goes through the dispatcher; plMathBenchmark
+// times them one by one.
+class hsMatrix44Kernels
+{
+public:
+    typedef void(*map_xyz_ptr)(const hsMatrix44&, const void*, size_t, void*, size_t, size_t, bool);
+
+    static void map_xyz_fpu(const hsMatrix44& m, const void* src, size_t srcStride,
+                            void* dst, size_t dstStride, size_t count, bool translate);
+    static void map_xyz_sse2(const hsMatrix44& m, const void* src, size_t srcStride,
+                             void* dst, size_t dstStride, size_t count, bool translate);
+    static void map_xyz_avx(const hsMatrix44& m, const void* src, size_t srcStride,
+                            void* dst, size_t dstStride, size_t count, bool translate);
+
+    static hsCpuFunctionDispatcher<map_xyz_ptr> map_xyz;
+};
+
+#endif // _hsMatrix44_Private_h_
@@ -496,8 +496,12 @@ void  hsStream::WriteLE16(uint16_t value)
 
 void  hsStream::WriteLE16(size_t count, const uint16_t values[])
 {
+#if LITTLE_ENDIAN
+    this->Write(count * sizeof(uint16_t), values);
+#else
     for (size_t i = 0; i < count; i++)
         this->WriteLE16(values[i]);
+#endif
 }
 
 void  hsStream::WriteLE32(uint32_t value)
@@ -508,8 +512,12 @@ void  hsStream::WriteLE32(uint32_t value)
 
 void  hsStream::WriteLE32(size_t count, const uint32_t values[])
 {
+#if LITTLE_ENDIAN
+    this->Write(count * sizeof(uint32_t), values);
+#else
     for (size_t i = 0; i < count; i++)
         this->WriteLE32(values[i]);
+#endif
 }
 
 void hsStream::WriteLEDouble(double value)
@@ -520,8 +528,12 @@ void hsStream::WriteLEDouble(double value)
 
 void hsStream::WriteLEDouble(size_t count, const double values[])
 {
+#if LITTLE_ENDIAN
+    this->Write(count * sizeof(double), values);
+#else
     for (size_t i = 0; i < count; i++)
         this->WriteLEDouble(values[i]);
+#endif
 }
 
 void hsStream::WriteLEFloat(float value)
@@ -532,8 +544,12 @@ void hsStream::WriteLEFloat(float value)
 
 void hsStream::WriteLEFloat(size_t count, const float values[])
 {
+#if LITTLE_ENDIAN
+    this->Write(count * sizeof(float), values);
+#else
     for (size_t i = 0; i < count; i++)
         this->WriteLEFloat(values[i]);
+#endif
 }
 
 
@@ -1067,6 +1083,8 @@ hsBufferedStream::hsBufferedStream()
 , fFileSize()
 , fBufferLen()
 , fWriteBufferUsed()
+, fReadAheadStart()
+, fSeekPending()
 #ifdef HS_DEBUGGING
 , fBufferHits()
 , fBufferMisses()
@@ -1104,6 +1122,7 @@ bool hsBufferedStream::Close()
     if (fRef)
         rtn = fclose(fRef);
     fRef = nullptr;
+    ClearReadAhead();
 
 #ifdef LOG_BUFFERED
     hsUNIXStream s;
@@ -1149,6 +1168,32 @@ void hsBufferedStream::SetFileRef(FILE* ref)
     fBufferLen = 0;
     fPosition = 0;
     fWriteBufferUsed = false;
+    fSeekPending = false;
+    ClearReadAhead();
+}
+
+void hsBufferedStream::ReadAhead(uint32_t start, uint32_t length)
+{
+    hsAssert(fRef, "fRef uninitialized");
+    if (!fRef || start >= fFileSize)
+        return;
+    if (length > fFileSize - start)
+        length = fFileSize - start;
+
+    fReadAhead.resize(length);
+    fseek(fRef, start, SEEK_SET);
+    fReadAhead.resize(::fread(fReadAhead.data(), 1, length, fRef));
+    fReadAheadStart = start;
+
+    // We just moved the file out from under the block buffer
+    fBufferLen = 0;
+    fSeekPending = true;
+}
+
+void hsBufferedStream::ClearReadAhead()
+{
+    std::vector<uint8_t>().swap(fReadAhead);
+    fReadAheadStart = 0;
 }
 
 uint32_t hsBufferedStream::Read(uint32_t bytes, void* buffer)
@@ -1157,6 +1202,20 @@ uint32_t hsBufferedStream::Read(uint32_t bytes, void* buffer)
     if (!fRef || bytes == 0)
         return 0;
 
+    if (!fReadAhead.empty() && IsReadAhead(fPosition, bytes))
+    {
+        FastByteCopy(buffer, &fReadAhead[fPosition - fReadAheadStart], bytes);
+        fPosition += bytes;
+        fBufferLen = 0;
+        fSeekPending = true;
+        return bytes;
+    }
+    if (fSeekPending)
+    {
+        fseek(fRef, (fPosition / kBufferSize) * kBufferSize, SEEK_SET);
+        fSeekPending = false;
+    }
+
     uint32_t numReadBytes = 0;
 
     while (bytes > 0 && fPosition < fFileSize)
@@ -1263,8 +1322,6 @@ void hsBufferedStream::Skip(uint32_t delta)
     }
     else
     {
-        uint32_t blockStart = ((fPosition + delta) / kBufferSize) * kBufferSize;
-
         // We've got data in the buffer, see if we can just skip in that
         if (fBufferLen > 0)
         {
@@ -1274,11 +1331,11 @@ void hsBufferedStream::Skip(uint32_t delta)
             if (newBufferPos < 0 || uint32_t(newBufferPos) >= fBufferLen)
             {
                 fBufferLen = 0;
-                fseek(fRef, blockStart, SEEK_SET);
+                fSeekPending = true;
             }
         }
         else
-            fseek(fRef, blockStart, SEEK_SET);
+            fSeekPending = true;
     }
 
     fPosition += delta;
@@ -1293,7 +1350,10 @@ void hsBufferedStream::Rewind()
     }
     // If the currently buffered block isn't the first one, invalidate our buffer
     else if (fPosition >= kBufferSize)
+    {
         fBufferLen = 0;
+        fSeekPending = true;
+    }
 
     fPosition = 0;
 }
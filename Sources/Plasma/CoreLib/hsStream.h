@@ -46,6 +46,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "hsMemory.h"
 #include "plFileSystem.h"
 #include <string_theory/format>
+#include <vector>
 
 class hsStream {
 public:
@@ -336,6 +337,14 @@ class hsBufferedStream : public hsStream
 
     bool fWriteBufferUsed;
 
+    // A larger window of the file pulled in ahead of time by ReadAhead. Reads
+    // that fall inside it are served from memory and leave the file alone, so
+    // the file needs to be put back under the block buffer before the next
+    // read that doesn't.
+    std::vector<uint8_t> fReadAhead;
+    uint32_t fReadAheadStart;
+    bool fSeekPending;
+
 #ifdef HS_DEBUGGING
     // For doing statistics on how efficient we are
     int fBufferHits, fBufferMisses;
@@ -362,6 +371,15 @@ public:
     FILE*   GetFileRef();
     void    SetFileRef(FILE* file);
 
+    // Reads [start, start + length) of the file in one go, replacing any
+    // earlier window, so the reads that follow inside it don't touch the file.
+    void    ReadAhead(uint32_t start, uint32_t length);
+    void    ClearReadAhead();
+    bool    IsReadAhead(uint32_t start, uint32_t length) const
+    {
+        return start >= fReadAheadStart && start - fReadAheadStart + uint64_t(length) <= fReadAhead.size();
+    }
+
     // Something optional for when we're doing stats.  Will log the reason why
     // the file was closed.  Really just for plRegistryPageNode.
     void SetCloseReason(const char* reason)
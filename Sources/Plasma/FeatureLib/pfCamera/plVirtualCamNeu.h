@@ -122,6 +122,7 @@ public:
     GETINTERFACE_ANY( plVirtualCam1, hsKeyedObject );
 
     void SetPipeline(plPipeline* p); 
+    plPipeline* GetPipeline() const { return fPipe; }
     void Init();
 
     bool MsgReceive(plMessage* msg) override;
@@ -745,6 +745,24 @@ PF_CONSOLE_CMD( Avatar_LOD,  GetLODDistance, "", "Get Distance for switching Ava
     pfConsolePrintF(PrintString, "Lod Distance = {f}", plArmatureLODMod::fLODDistance);
 }
 
+PF_CONSOLE_CMD( Avatar_LOD, CrowdMode, "bool on", "Throttle animation updates of distant and offscreen avatars" )
+{
+    plArmatureModBase::fCrowdMode = params[0];
+    PrintString(plArmatureModBase::fCrowdMode ? "Crowd mode enabled" : "Crowd mode disabled");
+}
+
+PF_CONSOLE_CMD( Avatar_LOD, SetCrowdDistances, "float halfDist, float quarterDist", "Set the distances beyond which avatars animate at half and quarter rate" )
+{
+    plArmatureModBase::fCrowdHalfDistance = params[0];
+    plArmatureModBase::fCrowdQuarterDistance = params[1];
+}
+
+PF_CONSOLE_CMD( Avatar_LOD, GetCrowdDistances, "", "Get the half and quarter rate animation distances" )
+{
+    pfConsolePrintF(PrintString, "Half rate beyond {f}, quarter rate beyond {f}",
+                    plArmatureModBase::fCrowdHalfDistance, plArmatureModBase::fCrowdQuarterDistance);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // CLIMBING
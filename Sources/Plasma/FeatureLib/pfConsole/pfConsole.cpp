@@ -64,7 +64,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "pnKeyedObject/plFixedKey.h"
 #include "pnNetCommon/plNetApp.h"
 
-#include "plGImage/plPNG.h"
+#include "plGImage/plImageCodecService.h"
 #include "plInputCore/plInputDevice.h"
 #include "plInputCore/plInputInterface.h"
 #include "plInputCore/plInputInterfaceMgr.h"
@@ -283,6 +283,9 @@ bool    pfConsole::MsgReceive( plMessage *msg )
             indices.insert(idx.to_uint(10));
         }
 
+        // Screenshots still being written haven't shown up on disk yet
+        indices.insert(fPendingScreenshots.begin(), fPendingScreenshots.end());
+
         // Now that we have an ordered set of indices, save this screenshot to the first one we don't have.
         uint32_t num = 0;
         for (auto it = indices.begin(); it != indices.end(); ++it, ++num) {
@@ -290,11 +293,21 @@ bool    pfConsole::MsgReceive( plMessage *msg )
                 break;
         }
 
-        // Got our num, save the screenshot.
+        // Got our num, save the screenshot. Compressing a PNG takes long
+        // enough to hitch the frame, so a worker does that and the writing.
         plFileName fn = ST::format("{}{04}.png", prefix, num);
-        plPNG::Instance().WriteToFile(plFileName::Join(screenshots, fn), capMsg->GetMipmap());
-
-        AddLineF("Saved screenshot as '%s'", fn.AsString().c_str());
+        fPendingScreenshots.insert(num);
+        plImageCodecService::EncodeFile(plImageCodecService::kPNG, capMsg->GetMipmap(), plFileName::Join(screenshots, fn),
+            [fn, num](bool success) {
+                if (!fTheConsole)
+                    return;
+
+                fTheConsole->fPendingScreenshots.erase(num);
+                if (success)
+                    AddLineF("Saved screenshot as '%s'", fn.AsString().c_str());
+                else
+                    AddLineF("Failed to save screenshot as '%s'", fn.AsString().c_str());
+            });
         return true;
     }
 
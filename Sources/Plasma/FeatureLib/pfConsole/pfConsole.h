@@ -59,6 +59,8 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "pnKeyedObject/hsKeyedObject.h"
 
+#include <set>
+
 class pfConsoleEngine;
 class pfConsoleInputInterface;
 class plKeyEventMsg;
@@ -112,6 +114,8 @@ class pfConsole : public hsKeyedObject
 
         pfConsoleEngine     *fEngine;
 
+        std::set<uint32_t>  fPendingScreenshots;    // indices still being written
+
         void    IHandleKey( plKeyEventMsg *msg );
 
         static uint32_t       fConsoleTextColor;
@@ -49,6 +49,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #define LIMIT_CONSOLE_COMMANDS 1
 #endif
 
+#include <algorithm>
 #include <string_theory/format>
 #include <string_theory/stdio>
 
@@ -56,6 +57,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plPipeDebugFlags.h"
 #include "plPipeline.h"
 #include "plProduct.h"
+#include "hsCpuID.h"
 #include "hsResMgr.h"
 #include "hsStream.h"
 #include "hsTimer.h"
@@ -98,11 +100,16 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plDrawable/plDrawableSpans.h"
 #include "plDrawable/plDynaBulletMgr.h"
 #include "plDrawable/plFixedWaterState7.h"
+#include "plDrawable/plGBufferGroup.h"
 #include "plDrawable/plMorphSequence.h"
 #include "plDrawable/plSharedMesh.h"
+#include "plDrawable/plSpanTypes.h"
 #include "plDrawable/plVisLOSMgr.h"
 #include "plDrawable/plWaveSet7.h"
 #include "plGImage/plAVIWriter.h"
+#include "plGImage/plFont.h"
+#include "plGImage/plFont_Private.h"
+#include "plGImage/plFontCache.h"
 #include "plGImage/plMipmap.h"
 #include "plGLight/plShadowCaster.h"
 #include "plGLight/plShadowMaster.h"
@@ -111,6 +118,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plInputCore/plInputInterfaceMgr.h"
 #include "plInputCore/plInputManager.h"
 #include "plInputCore/plSceneInputInterface.h"
+#include "plMath/hsRadixSort.h"
 #include "plMessage/plAnimCmdMsg.h"
 #include "plMessage/plAvatarMsg.h"
 #include "plMessage/plBulletMsg.h"
@@ -139,6 +147,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plPipeline/plPlates.h"
 #include "plResMgr/plKeyFinder.h"
 #include "plResMgr/plLocalization.h"
+#include "plResMgr/plRegistryHelpers.h"
 #include "plResMgr/plResManager.h"
 #include "plResMgr/plResManagerHelper.h"
 #include "plResMgr/plResMgrSettings.h"
@@ -162,6 +171,9 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "pfCamera/plVirtualCamNeu.h"
 #include "pfConsoleCore/pfConsoleCmd.h"
 #include "pfConsoleCore/pfConsoleContext.h"
+#include "pfGameGUIMgr/pfGameGUIMgr.h"
+#include "pfGameGUIMgr/pfGUIDialogMod.h"
+#include "pfGameGUIMgr/pfGUIMultiLineEditCtrl.h"
 #include "pfMessage/pfBackdoorMsg.h"
 #include "pfMessage/plClothingMsg.h"
 #include "pfMessage/pfKIMsg.h"
@@ -978,6 +990,275 @@ PF_CONSOLE_CMD( Graphics,           // Group name
     pfConsolePrintF(PrintString, "{} is now {}", name, on ? "enabled" : "disabled");
 }
 
+PF_CONSOLE_CMD( Graphics,
+                BenchmarkFaceSort,
+                "...",
+                "Times the old linked list and the new array face sort on every loaded span\n\
+that has been face sorted so far. Optional param is the number of passes." )
+{
+    class SortedSpanCollector : public plRegistryKeyIterator
+    {
+    public:
+        std::vector<plIcicle*> fSpans;
+
+        bool EatKey(const plKey& key) override
+        {
+            if (key->GetUoid().GetClassType() != plDrawableSpans::Index())
+                return true;
+
+            plDrawableSpans* drawable = plDrawableSpans::ConvertNoRef(key->ObjectIsLoaded());
+            if (!drawable)
+                return true;
+
+            for (plSpan* span : drawable->GetSpanArray())
+            {
+                if (!(span->fTypeMask & plSpan::kIcicleSpan) || !(span->fProps & plSpan::kPropFacesSortable))
+                    continue;
+                plIcicle* icicle = static_cast<plIcicle*>(span);
+                if (icicle->fSortData && icicle->fILength >= 3)
+                    fSpans.push_back(icicle);
+            }
+            return true;
+        }
+    } collector;
+    ((plResManager*)hsgResMgr::ResMgr())->IterateKeys(&collector);
+
+    if (collector.fSpans.empty())
+    {
+        PrintString("No face sorted spans loaded.");
+        return;
+    }
+
+    int passes = numParams > 0 ? (int)params[0] : 20;
+    if (passes < 1)
+        passes = 1;
+
+    const hsPoint3 viewPosWorld = pfConsole::GetPipeline()->GetViewPositionWorld();
+
+    std::vector<plGBufferTriangle> tris, sortedTris;
+    std::vector<uint16_t> indices;
+    std::vector<hsRadixSort::Elem> elems;
+    std::vector<hsRadixSort::Pair> pairs, scratch;
+    size_t totTris = 0;
+
+    double oldTime = 0.0;
+    double newTime = 0.0;
+    for (int pass = 0; pass < passes; pass++)
+    {
+        for (plIcicle* span : collector.fSpans)
+        {
+            // SortSpan writes its order back into fSortData, so work on a copy
+            // taken once per pass; both sorts see the same triangles, and the
+            // span is left alone.
+            uint32_t numTris = span->fILength / 3;
+            tris.assign(span->fSortData, span->fSortData + numTris);
+            const plGBufferTriangle* list = tris.data();
+            hsPoint3 viewPos = span->fWorldToLocal * viewPosWorld;
+            if (pass == 0)
+                totTris += numTris;
+            indices.resize(numTris * 3);
+
+            double start = hsTimer::GetSeconds<double>();
+            elems.resize(numTris);
+            for (uint32_t i = 0; i < numTris; i++)
+            {
+                elems[i].fKey.fFloat = -(viewPos - list[i].fCenter).MagnitudeSquared();
+                elems[i].fBody = (intptr_t)&list[i];
+                elems[i].fNext = &elems[i] + 1;
+            }
+            elems[numTris - 1].fNext = nullptr;
+            hsRadixSort rad;
+            uint16_t* idx = indices.data();
+            for (hsRadixSort::Elem* elem = rad.Sort(elems.data(), 0); elem; elem = elem->fNext)
+            {
+                const plGBufferTriangle* tri = (const plGBufferTriangle*)elem->fBody;
+                *idx++ = tri->fIndex1;
+                *idx++ = tri->fIndex2;
+                *idx++ = tri->fIndex3;
+            }
+            oldTime += hsTimer::GetSeconds<double>() - start;
+
+            // Same as SortSpan, including the copy back (into our copy)
+            start = hsTimer::GetSeconds<double>();
+            pairs.resize(numTris);
+            scratch.resize(numTris);
+            sortedTris.resize(numTris);
+            hsRadixSort::FarToNearKeys(&list[0].fCenter, sizeof(plGBufferTriangle), numTris,
+                                       viewPos, pairs.data(), 0);
+            hsRadixSort::SortPairs(pairs.data(), scratch.data(), numTris);
+            idx = indices.data();
+            for (uint32_t i = 0; i < numTris; i++)
+            {
+                const plGBufferTriangle& tri = list[pairs[i].fIndex];
+                *idx++ = tri.fIndex1;
+                *idx++ = tri.fIndex2;
+                *idx++ = tri.fIndex3;
+                sortedTris[i] = tri;
+            }
+            memcpy(tris.data(), sortedTris.data(), numTris * sizeof(plGBufferTriangle));
+            newTime += hsTimer::GetSeconds<double>() - start;
+        }
+    }
+
+    pfConsolePrintF(PrintString, "{} spans, {} tris, {} passes", collector.fSpans.size(), totTris, passes);
+    pfConsolePrintF(PrintString, "Linked list sort: {.3f} ms per pass", oldTime * 1000.0 / passes);
+    pfConsolePrintF(PrintString, "Array sort: {.3f} ms per pass", newTime * 1000.0 / passes);
+}
+
+PF_CONSOLE_CMD( Graphics,
+                BenchmarkText,
+                "...",
+                "Times text layout and glyph blitting on a mock KI screen: chat lines wrapped\n\
+into the chat area and player names clipped to the player list. Optional params\n\
+are the font face, the point size and the number of passes." )
+{
+    ST::string face = numParams > 0 ? ST::string((const char *)params[0]) : ST_LITERAL("Arial");
+    int size = numParams > 1 ? (int)params[1] : 12;
+    int passes = numParams > 2 ? (int)params[2] : 20;
+    if (passes < 1)
+        passes = 1;
+
+    plFont* font = plFontCache::GetInstance().GetFont(face, (uint8_t)size, 0);
+    if (!font)
+    {
+        pfConsolePrintF(PrintString, "Can't find font {} {}.", face, size);
+        return;
+    }
+
+    static const char* kChatLines[] = {
+        "Welcome to Uru. To get help on the KI, type /help.",
+        "Guildmaster Kodama: The meeting in the Guild of Writers pub starts in ten minutes, everyone is welcome.",
+        "Yeesha_Fan: has anyone figured out the sequence for the Gahreesen wall yet? we keep losing on the last panel",
+        "From D'ni Explorer in Ae'gura: meet me by the great tree in the city, I have the relto pages",
+        "<<Private>> Atrus: bring the linking book, and mind the stairs in the library.",
+        "Zandi says: Go on. Take a look around.",
+        "(3:42) Buddy list update: Marten has linked to Kirel.",
+        "Cate Alexander: The DRC reminds all visitors that the restoration areas remain closed until further notice.",
+    };
+    static const char* kPlayerNames[] = {
+        "Atrus", "Yeesha_Fan", "Guildmaster Kodama", "D'ni Explorer", "Marten of the Watchers",
+        "Cate Alexander", "Zandi", "Dr. Sutherland", "Phil Henderson the Wanderer", "Engberg",
+    };
+
+    std::vector<ST::wchar_buffer> chat, names;
+    for (const char* line : kChatLines)
+        chat.push_back(ST::string(line).to_wchar());
+    for (const char* name : kPlayerNames)
+        names.push_back(ST::string(name).to_wchar());
+
+    // The KI's chat area and player list on its largest DTMap
+    const int16_t chatWidth = 400, chatHeight = 320;
+    const int16_t listX = 410, listWidth = 100;
+    plMipmap screen(512, 512, plMipmap::kARGB32Config, 1);
+    screen.SetCurrLevel(0);
+
+    uint16_t w, h, a, lastX, lastY;
+    uint32_t firstClipped;
+    auto layoutScreen = [&]() {
+        font->SetRenderWrapping(0, 0, chatWidth, chatHeight);
+        for (const ST::wchar_buffer& line : chat)
+            font->CalcStringExtents(line.c_str(), w, h, a, firstClipped, lastX, lastY);
+        font->SetRenderClipping(listX, 0, listWidth, chatHeight);
+        for (const ST::wchar_buffer& name : names)
+            font->CalcStringExtents(name.c_str(), w, h, a, firstClipped, lastX, lastY);
+    };
+    const uint16_t lineHeight = uint16_t(font->GetAscent() + font->GetDescent());
+    auto drawScreen = [&]() {
+        uint16_t y = 0;
+        font->SetRenderWrapping(0, 0, chatWidth, chatHeight);
+        for (const ST::wchar_buffer& line : chat)
+        {
+            font->RenderString(&screen, 0, y, line.c_str(), &lastX, &lastY);
+            y = lastY + lineHeight;
+        }
+        y = 0;
+        for (const ST::wchar_buffer& name : names)
+        {
+            font->SetRenderClipping(listX, y, listWidth, lineHeight);
+            font->RenderString(&screen, listX, y, name.c_str());
+            y += lineHeight;
+        }
+    };
+
+    font->SetRenderColor(0xffe0e0ff);
+    font->SetRenderFlag(plFont::kRenderShadow | plFont::kRenderIntoAlpha | plFont::kRenderAlphaPremultiplied, false);
+    font->SetRenderXJustify(plFont::kRenderJustXLeft);
+    font->SetRenderYJustify(plFont::kRenderJustYTop);
+
+    // Layout, measured from scratch every pass and then out of the extents cache
+    double coldTime = 0.0, warmTime = 0.0;
+    for (int pass = 0; pass < passes; pass++)
+    {
+        font->ClearExtentsCache();
+        double start = hsTimer::GetSeconds<double>();
+        layoutScreen();
+        coldTime += hsTimer::GetSeconds<double>() - start;
+
+        start = hsTimer::GetSeconds<double>();
+        layoutScreen();
+        warmTime += hsTimer::GetSeconds<double>() - start;
+    }
+    pfConsolePrintF(PrintString, "{} {}: {} chat lines, {} names, {} passes", face, size,
+                    chat.size(), names.size(), passes);
+    pfConsolePrintF(PrintString, "Layout: {.3f} ms uncached, {.3f} ms cached per screen",
+                    coldTime * 1000.0 / passes, warmTime * 1000.0 / passes);
+
+    // Full screen draws in each of the ways a DTMap can blend text
+    static const struct { const char* fName; uint32_t fFlags; } kModes[] = {
+        { "Blended", 0 },
+        { "Into alpha", plFont::kRenderIntoAlpha },
+        { "Premultiplied", plFont::kRenderAlphaPremultiplied },
+    };
+    for (const auto& mode : kModes)
+    {
+        font->SetRenderFlag(plFont::kRenderIntoAlpha | plFont::kRenderAlphaPremultiplied, false);
+        font->SetRenderFlag(mode.fFlags, true);
+        double start = hsTimer::GetSeconds<double>();
+        for (int pass = 0; pass < passes; pass++)
+            drawScreen();
+        pfConsolePrintF(PrintString, "{} draw: {.3f} ms per screen", mode.fName,
+                        (hsTimer::GetSeconds<double>() - start) * 1000.0 / passes);
+    }
+    font->SetRenderFlag(plFont::kRenderIntoAlpha | plFont::kRenderAlphaPremultiplied, false);
+
+    // And the row blitters on their own, over glyph-like coverage: mostly empty
+    // or solid with antialiased edges, in rows about as wide as a character
+    const int32_t rowWidth = 12, numRows = 4096;
+    std::vector<uint8_t> coverage(rowWidth * numRows);
+    std::vector<uint32_t> dest(rowWidth * numRows, 0x80402010);
+    for (size_t i = 0; i < coverage.size(); i++)
+    {
+        uint32_t noise = uint32_t(i) * 2654435761U >> 24;
+        coverage[i] = noise < 96 ? 0 : noise < 192 ? 255 : uint8_t(noise);
+    }
+
+    static const struct { const char* fName; plFontKernels::blit_row_ptr fFpu, fSSE2; } kBlitters[] = {
+        { "Blend", &plFontKernels::blend_8to32_fpu, &plFontKernels::blend_8to32_sse2 },
+        { "Full alpha", &plFontKernels::full_alpha_8to32_fpu, &plFontKernels::full_alpha_8to32_sse2 },
+        { "Alpha", &plFontKernels::alpha_8to32_fpu, &plFontKernels::alpha_8to32_sse2 },
+        { "Premultiplied", &plFontKernels::alpha_prem_8to32_fpu, &plFontKernels::alpha_prem_8to32_sse2 },
+    };
+    const bool haveSSE2 = hsCpuId::Instance().has_sse2;
+    auto timeBlitter = [&](plFontKernels::blit_row_ptr blit) {
+        double start = hsTimer::GetSeconds<double>();
+        for (int pass = 0; pass < passes; pass++)
+        {
+            for (int32_t row = 0; row < numRows; row++)
+                blit(&coverage[row * rowWidth], &dest[row * rowWidth], rowWidth, 0xc0e0e0ff);
+        }
+        return (hsTimer::GetSeconds<double>() - start) * 1000.0 / passes;
+    };
+    for (const auto& blitter : kBlitters)
+    {
+        double fpuTime = timeBlitter(blitter.fFpu);
+        if (haveSSE2)
+            pfConsolePrintF(PrintString, "{} rows: {.3f} ms FPU, {.3f} ms SSE2 per {} rows", blitter.fName,
+                            fpuTime, timeBlitter(blitter.fSSE2), numRows);
+        else
+            pfConsolePrintF(PrintString, "{} rows: {.3f} ms FPU per {} rows", blitter.fName, fpuTime, numRows);
+    }
+}
+
 
 
 PF_CONSOLE_SUBGROUP( Graphics, VisSet )     // Creates a sub-group under a given group
@@ -5059,6 +5340,12 @@ PF_CONSOLE_CMD(Physics, ExtraProfile, "", "Toggle extra simulation profiling")
     PrintString(str);
 }
 
+PF_CONSOLE_CMD(Physics, OverlapStep, "bool enable", "Step the simulation while the frame renders")
+{
+    plSimulationMgr::fOverlapStep = params[0];
+    PrintString(plSimulationMgr::fOverlapStep ? "Overlapped physics step enabled" : "Overlapped physics step disabled");
+}
+
 PF_CONSOLE_CMD(Physics, 
                ShowControllerDebugDisplay,
                "", 
@@ -5976,6 +6263,87 @@ PF_CONSOLE_CMD( KI,                             // Group name
     plgDispatch::MsgSend( msg );
 }
 
+PF_CONSOLE_CMD( KI,                             // Group name
+                BenchmarkChat,                  // Function name
+                "string dlgName, int tagID, ...", // Params
+                "Appends chat lines to the given multi-line edit control the way the KI does and times them.\n\
+Optional params are the number of lines (default 10000) and the scrollback limit in lines (default none).\n\
+The control's text is put back afterwards." ) // Help string
+{
+    pfGUIDialogMod* dlg = pfGameGUIMgr::GetInstance()->GetDialogFromString(params[0]);
+    if (dlg == nullptr)
+    {
+        pfConsolePrintF(PrintString, "Dialog {} isn't loaded", (const char*)params[0]);
+        return;
+    }
+
+    pfGUIMultiLineEditCtrl* ctrl = pfGUIMultiLineEditCtrl::ConvertNoRef(dlg->GetControlFromTag((int)params[1]));
+    if (ctrl == nullptr)
+    {
+        pfConsolePrintF(PrintString, "Tag {} isn't a multi-line edit control", (int)params[1]);
+        return;
+    }
+
+    int numLines = numParams > 2 ? (int)params[2] : 10000;
+    if (numLines < 1)
+        numLines = 1;
+    int32_t scrollback = numParams > 3 ? (int)params[3] : -1;
+
+    // Save what's there, so the benchmark doesn't cost anyone their chat log
+    size_t savedLength;
+    wchar_t* savedBuffer = ctrl->GetCodedBufferW(savedLength);
+    int32_t savedScrollPos = ctrl->GetScrollPosition();
+    int32_t savedScrollback = ctrl->GetScrollbackLimit();
+
+    ctrl->ClearBuffer();
+    ctrl->SetScrollbackLimit(scrollback);
+
+    static const wchar_t kWords[] = L"The quick brown fox jumped over the lazy dog, then sat down for a while. "
+                                    L"Meanwhile, somebody on the other side of the age linked in and said hello. ";
+    hsColorRGBA headerColor = hsColorRGBA().Set(1.f, 0.8f, 0.2f, 1.f);
+    hsColorRGBA bodyColor = hsColorRGBA().Set(0.9f, 0.9f, 0.9f, 1.f);
+
+    std::vector<double> lineTimes(numLines);
+    double start = hsTimer::GetSeconds<double>();
+    for (int i = 0; i < numLines; i++)
+    {
+        ST::wchar_buffer header = ST::format("\nPlayer {}:", i % 50).to_wchar();
+        size_t bodyLength = (i * 37) % (std::size(kWords) - 2) + 1;
+        std::wstring body(L" ");
+        body.append(kWords, bodyLength);
+
+        double lineStart = hsTimer::GetSeconds<double>();
+        ctrl->BeginUpdate();
+        ctrl->MoveCursor(pfGUIMultiLineEditCtrl::kBufferEnd);
+        ctrl->InsertColor(headerColor);
+        ctrl->InsertString(header.c_str());
+        ctrl->InsertColor(bodyColor);
+        ctrl->InsertString(body.c_str());
+        ctrl->MoveCursor(pfGUIMultiLineEditCtrl::kBufferEnd);
+        ctrl->EndUpdate();
+        lineTimes[i] = hsTimer::GetSeconds<double>() - lineStart;
+    }
+    double total = hsTimer::GetSeconds<double>() - start;
+
+    // The last lines appended tell us whether the cost grows with the log
+    auto tailStart = lineTimes.end() - std::min(numLines, 1000);
+    double tailTotal = 0.0;
+    for (auto it = tailStart; it != lineTimes.end(); ++it)
+        tailTotal += *it;
+    double tailAvg = tailTotal / std::distance(tailStart, lineTimes.end());
+
+    std::sort(lineTimes.begin(), lineTimes.end());
+    pfConsolePrintF(PrintString, "{} lines in {.1f} ms, {} chars buffered", numLines, total * 1000.0, ctrl->GetBufferSize());
+    pfConsolePrintF(PrintString, "Per line: avg {.1f} us, last 1000 avg {.1f} us, p99 {.1f} us, max {.1f} us",
+                    total * 1.e6 / numLines, tailAvg * 1.e6,
+                    lineTimes[numLines * 99 / 100] * 1.e6, lineTimes.back() * 1.e6);
+
+    ctrl->SetScrollbackLimit(savedScrollback);
+    ctrl->SetBuffer(savedBuffer, savedLength);
+    ctrl->SetScrollPosition(savedScrollPos);
+    delete [] savedBuffer;
+}
+
 #endif // LIMIT_CONSOLE_COMMANDS
 
 ////////////////////////////////////////////////////////////////////////
@@ -6076,6 +6444,21 @@ PF_CONSOLE_CMD(Demo, PlayNet, "string recName", "Plays back a network demo")
         PrintString("Playback Failed");
 }
 
+PF_CONSOLE_CMD(Demo, BenchmarkNet, "string recName, ...", "Plays back a network demo as a benchmark. Optional params: frame step in seconds (0 = real time, default 1/30), quit when done (default false)")
+{
+    float frameStep = 1.f / 30.f;
+    bool quitWhenDone = false;
+    if (numParams > 1)
+        frameStep = params[1];
+    if (numParams > 2)
+        quitWhenDone = params[2];
+
+    if (plNetClientMgr::GetInstance()->BenchmarkMsgs(params[0], frameStep, quitWhenDone))
+        PrintString("Benchmark Started");
+    else
+        PrintString("Benchmark Failed");
+}
+
 #endif // LIMIT_CONSOLE_COMMANDS
 
 
@@ -50,7 +50,9 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "HeadSpin.h"
 #include "plgDispatch.h"
 #include "hsResMgr.h"
+#include "plProfile.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "pfGameGUIMgr.h"
@@ -138,15 +140,21 @@ constexpr wchar_t kStyleCodeChar = (wchar_t)2;
 constexpr size_t kColorCodeSize = 5;
 constexpr size_t kStyleCodeSize = 3;
 
+plProfile_CreateTimer("MLEditLayout", "RenderSetup", MLEditLayout);
+plProfile_CreateTimer("MLEditDraw", "RenderSetup", MLEditDraw);
+plProfile_CreateCounter("MLEditLinesLaidOut", "RenderSetup", MLEditLinesLaidOut);
+plProfile_CreateCounter("MLEditLinesDrawn", "RenderSetup", MLEditLinesDrawn);
+
 //// Constructor/Destructor //////////////////////////////////////////////////
 
 pfGUIMultiLineEditCtrl::pfGUIMultiLineEditCtrl()
     : fBuffer({L'\0'}), fCursorPos(), fLastCursorLine(), fBufferLimit(-1),
-      fScrollControl(), fScrollProc(), fScrollPos(), fReadyToRender(),
+      fScrollbackLimit(-1), fScrollControl(), fScrollProc(), fScrollPos(), fReadyToRender(),
       fLastKeyModifiers(), fLastKeyPressed(), fLockCount(),
       fNextCtrl(), fPrevCtrl(), fEventProc(),
       fTopMargin(), fLeftMargin(), fBottomMargin(), fRightMargin(),
       fFontSize(), fFontStyle(), fFontFlagsSet(), fCanUpdate(true),
+      fDirtyStart(), fDirtyEnd(-1),
       fLineHeight(), fCurrCursorX(), fCurrCursorY(), fCalcedFontSize()
 {
     SetFlag(kWantsInterest);
@@ -245,6 +253,9 @@ void    pfGUIMultiLineEditCtrl::IUpdateScrollRange()
     if (fScrollControl == nullptr)
         return;
 
+    // Growing or shrinking the range alone doesn't move any text around. Only
+    // when it forces a new scroll position do we have to refresh the whole area
+    int32_t oldScrollPos = fScrollPos;
     if ((int32_t)fLineStarts.size() > ICalcNumVisibleLines() - 1)
     {
         // +1 here because the last visible line is only a partial, but we want to be able to view
@@ -260,9 +271,6 @@ void    pfGUIMultiLineEditCtrl::IUpdateScrollRange()
                 fScrollPos = newMax;
                 fScrollControl->SetCurrValue( fScrollControl->GetMax() - (float)fScrollPos );
             }
-
-            // All bets are off on scrolling, so refresh the whole area
-            IUpdate();
         }
     }
     else
@@ -272,9 +280,11 @@ void    pfGUIMultiLineEditCtrl::IUpdateScrollRange()
             fScrollControl->SetRange( 0, 0 );
             fScrollControl->SetEnabled( false );
             fScrollPos = 0;
-            IUpdate();
         }
     }
+
+    if (fScrollPos != oldScrollPos)
+        IUpdate();
 }
 
 void pfGUIMultiLineEditCtrl::SetScrollEnable( bool state )
@@ -348,8 +358,25 @@ int32_t   pfGUIMultiLineEditCtrl::ICalcNumVisibleLines() const
 
 void    pfGUIMultiLineEditCtrl::IUpdate( int32_t startLine, int32_t endLine )
 {
-    if (!fReadyToRender || !fCanUpdate)
+    if (!fReadyToRender)
+        return;
+
+    if (!fCanUpdate)
+    {
+        // Just remember which lines changed, EndUpdate() will redraw them all in one go.
+        // An empty range still clears everything past its start, so keep the start in it.
+        if (fDirtyEnd < fDirtyStart)
+        {
+            fDirtyStart = startLine;
+            fDirtyEnd = std::max(startLine, endLine);
+        }
+        else
+        {
+            fDirtyStart = std::min(fDirtyStart, startLine);
+            fDirtyEnd = std::max({ fDirtyEnd, startLine, endLine });
+        }
         return;
+    }
 
     // Detect whether we need to recalc all of our dimensions entirely
     if( fFontFlagsSet & (kFontFaceSet & kFontColorSet & kFontSizeSet & kFontStyleSet) )
@@ -383,6 +410,8 @@ void    pfGUIMultiLineEditCtrl::IUpdate( int32_t startLine, int32_t endLine )
     if( endLine > lastVisibleLine )
         endLine = lastVisibleLine;
 
+    plProfile_BeginTiming(MLEditDraw);
+
     bool clearEachLine = true;
     if( startLine == fScrollPos && endLine == lastVisibleLine )
     {
@@ -392,8 +421,17 @@ void    pfGUIMultiLineEditCtrl::IUpdate( int32_t startLine, int32_t endLine )
 
     // Start at our line
     uint16_t y = (uint16_t)((startLine - fScrollPos) * fLineHeight + fTopMargin);
-    // And loop!
 
+    // Only look up the codes in effect for the first line, then carry them along
+    hsColorRGBA currColor = fFontColor;
+    uint8_t currStyle = fFontStyle;
+    if (startLine <= endLine)
+    {
+        IFindLastColorCode(fLineStarts[startLine], currColor);
+        currStyle = IFindLineStyle(startLine);
+    }
+
+    // And loop!
     int32_t line;
     for (line = startLine; line <= endLine; line++)
     {
@@ -409,13 +447,14 @@ void    pfGUIMultiLineEditCtrl::IUpdate( int32_t startLine, int32_t endLine )
                       ? (int32_t)fBuffer.size() : fLineStarts[line + 1];
 
         // Render the actual text
-        IRenderLine(fLeftMargin, y, start, end);
+        IRenderLine(fLeftMargin, y, start, end, currColor, currStyle);
+        plProfile_IncCount(MLEditLinesDrawn, 1);
 
         // Render the cursor
         if( fCursorPos >= start && fCursorPos < end && IsFocused() )
         {
             uint16_t x = (fCursorPos > start)
-                         ? (uint16_t)IRenderLine(fLeftMargin, y, start, fCursorPos, true)
+                         ? (uint16_t)IRenderLine(fLeftMargin, y, start, fCursorPos, currColor, currStyle, true)
                          : (uint16_t)fLeftMargin;
 
             fDynTextMap->FrameRect(x, y, 2, fLineHeight, GetColorScheme()->fSelForeColor);
@@ -426,6 +465,7 @@ void    pfGUIMultiLineEditCtrl::IUpdate( int32_t startLine, int32_t endLine )
             fCurrCursorX = x;
             fCurrCursorY = y;
         }
+        IScanCodes(start, end, currColor, currStyle);
         y += fLineHeight;
     }
     if (clearEachLine && line >= (int32_t)fLineStarts.size() && y < fDynTextMap->GetVisibleHeight() - fBottomMargin)
@@ -435,6 +475,8 @@ void    pfGUIMultiLineEditCtrl::IUpdate( int32_t startLine, int32_t endLine )
                               GetColorScheme()->fBackColor);
     }
     fDynTextMap->FlushToHost();
+
+    plProfile_EndTiming(MLEditDraw);
 }
 
 //// IReadColorCode //////////////////////////////////////////////////////////
@@ -515,22 +557,51 @@ bool    pfGUIMultiLineEditCtrl::IFindLastStyleCode( int32_t pos, uint8_t &style,
     return false;
 }
 
+//// IFindLineStyle ////////////////////////////////////////////////////////
+//  Returns the style in effect at the start of the given line. The styles
+//  stored by the last recalc are only kept for our own line starts, so linked
+//  controls have to search back for the last style code instead.
+
+uint8_t pfGUIMultiLineEditCtrl::IFindLineStyle( int32_t line ) const
+{
+    if (!fPrevCtrl && !fNextCtrl && line < (int32_t)fLineStyles.size())
+        return fLineStyles[line];
+
+    uint8_t style;
+    IFindLastStyleCode(fLineStarts[line], style);
+    return style;
+}
+
+//// IScanCodes //////////////////////////////////////////////////////////////
+//  Walks forward over the given range and updates the color and style with
+//  every code found, leaving them as they are at the end of the range.
+
+void    pfGUIMultiLineEditCtrl::IScanCodes( int32_t start, int32_t end, hsColorRGBA &color, uint8_t &style ) const
+{
+    end = std::min(end, (int32_t)fBuffer.size());
+    for (int32_t pos = start; pos < end; )
+    {
+        if (fBuffer[pos] == kColorCodeChar)
+            IReadColorCode(pos, color);
+        else if (fBuffer[pos] == kStyleCodeChar)
+            IReadStyleCode(pos, style);
+        else
+            pos++;
+    }
+}
+
 //// IRenderLine /////////////////////////////////////////////////////////////
 //  Renders a null-terminated string to the dynamic text map at the location
 //  given. Takes into account style codes and special characters (like returns
 //  and tabs). Returns the final X value after rendering.
+//  The color and style are the ones in effect at the start position; finding
+//  them is up to the caller, since it usually knows them already.
 
-uint32_t  pfGUIMultiLineEditCtrl::IRenderLine( uint16_t x, uint16_t y, int32_t start, int32_t end, bool dontRender )
+uint32_t  pfGUIMultiLineEditCtrl::IRenderLine( uint16_t x, uint16_t y, int32_t start, int32_t end, hsColorRGBA currColor, uint8_t currStyle, bool dontRender )
 {
     int32_t       pos;
-    hsColorRGBA currColor = fFontColor;
-    uint8_t       currStyle;
     const wchar_t *buffer = fBuffer.data();
 
-    // First, gotta go back from our starting position and find a color and style code to use
-    IFindLastColorCode( start, currColor );
-    IFindLastStyleCode( start, currStyle );
-
     fDynTextMap->SetTextColor( currColor, HasFlag( kXparentBgnd ) ? true : false );
     fDynTextMap->SetFont( fFontFace, fFontSize, GetColorScheme()->fFontFlags | currStyle,
                             HasFlag( kXparentBgnd ) ? false : true );
@@ -663,10 +734,12 @@ int32_t   pfGUIMultiLineEditCtrl::IPointToPosition( int16_t ptX, int16_t ptY, bo
             int32_t end = (line == (int32_t)fLineStarts.size() - 1)
                           ? (int32_t)fBuffer.size() - 1 : fLineStarts[line + 1];
 
+            // Colors don't change any widths, so the style is all we need to measure
+            uint8_t style = IFindLineStyle(line);
             int32_t pos;
             for (pos = start; pos < end; pos++)
             {
-                int16_t x = (int16_t)IRenderLine(fLeftMargin, 0, start, pos, true);
+                int16_t x = (int16_t)IRenderLine(fLeftMargin, 0, start, pos, fFontColor, style, true);
                 if( x > ptX )
                     break;
             }
@@ -732,6 +805,7 @@ int32_t   pfGUIMultiLineEditCtrl::IRecalcLineStarts( int32_t startingLine, bool
     {
         // Can't calculate anything. Just return invalid
         fLineStarts.clear();
+        fLineStyles.clear();
         IUpdateScrollRange();
         return -1;
     }
@@ -758,15 +832,23 @@ int32_t   pfGUIMultiLineEditCtrl::IRecalcLineStarts( int32_t startingLine, bool
 
     realStartingLine = currLine;    // For the IUpdate call later
 
+    plProfile_BeginTiming(MLEditLayout);
+
     // Precalculate some helper values
     wrapWidth = fDynTextMap->GetVisibleWidth() - fRightMargin;
     wchar_t* buffer = fBuffer.data();
 
+    // The style we measure with is carried along from line to line, so we only
+    // have to look it up for the first one
+    uint8_t lineStyle = (currLine > 0) ? IFindLineStyle(currLine) : fFontStyle;
+    hsColorRGBA scanColor = fFontColor;
+
     for (; charPos < (int32_t)fBuffer.size(); currLine++)
     {
         //// Store this line start
         startPos = charPos;
-        if( IStoreLineStart( currLine, startPos ) )
+        plProfile_IncCount(MLEditLinesLaidOut, 1);
+        if( IStoreLineStart( currLine, startPos, lineStyle ) )
         {
             if( currLine > startingLine )
             {
@@ -808,7 +890,7 @@ int32_t   pfGUIMultiLineEditCtrl::IRecalcLineStarts( int32_t startingLine, bool
                 nextPos += IOffsetToNextChar( buffer[ nextPos ] );
 
             // Now see how much width this is
-            widthCounter = (uint16_t)IRenderLine( fLeftMargin, 0, startPos, nextPos, true );
+            widthCounter = (uint16_t)IRenderLine( fLeftMargin, 0, startPos, nextPos, scanColor, lineStyle, true );
             
             // Now we loop. If wrapWidth is too much, we'll break the loop with charPos pointing to the
             // end of our line. If not, charPos will advance to start the search again
@@ -822,12 +904,15 @@ int32_t   pfGUIMultiLineEditCtrl::IRecalcLineStarts( int32_t startingLine, bool
             while( widthCounter >= wrapWidth && nextPos > startPos )
             {
                 nextPos -= IOffsetToNextChar( buffer[ nextPos - 1 ] );
-                widthCounter = (uint16_t)IRenderLine( fLeftMargin, 0, startPos, nextPos, true );
+                widthCounter = (uint16_t)IRenderLine( fLeftMargin, 0, startPos, nextPos, scanColor, lineStyle, true );
             }
 
             charPos = nextPos;
         }
 
+        // Pick up any style changes on this line for the next one
+        IScanCodes( startPos, charPos, scanColor, lineStyle );
+
         // Continue on!     
     }
 
@@ -835,8 +920,11 @@ int32_t   pfGUIMultiLineEditCtrl::IRecalcLineStarts( int32_t startingLine, bool
     {
         // Make sure there are no lines stored after this one
         fLineStarts.resize(currLine);
+        fLineStyles.resize(currLine);
     }
 
+    plProfile_EndTiming(MLEditLayout);
+
     IUpdateScrollRange();
 
     if( !dontUpdate )
@@ -851,9 +939,10 @@ int32_t   pfGUIMultiLineEditCtrl::IRecalcLineStarts( int32_t startingLine, bool
 }
 
 //// IStoreLineStart /////////////////////////////////////////////////////////
-//  Stores a single line start, expanding the array if necessary.
+//  Stores a single line start and the style in effect there, expanding the
+//  arrays if necessary.
 
-bool    pfGUIMultiLineEditCtrl::IStoreLineStart(int32_t line, int32_t start)
+bool    pfGUIMultiLineEditCtrl::IStoreLineStart(int32_t line, int32_t start, uint8_t style)
 {
     if ((int32_t)fLineStarts.size() <= line)
     {
@@ -861,9 +950,12 @@ bool    pfGUIMultiLineEditCtrl::IStoreLineStart(int32_t line, int32_t start)
         fLineStarts.resize(line + 1);
         fLineStarts[ line ] = -1;
     }
+    if ((int32_t)fLineStyles.size() <= line)
+        fLineStyles.resize(line + 1);
 
     bool same = ( fLineStarts[ line ] == start ) ? true : false;
     fLineStarts[ line ] = start;
+    fLineStyles[ line ] = style;
     return same;
 }
 
@@ -872,18 +964,15 @@ bool    pfGUIMultiLineEditCtrl::IStoreLineStart(int32_t line, int32_t start)
 
 int32_t   pfGUIMultiLineEditCtrl::IFindCursorLine( int32_t cursorPos ) const
 {
-    int32_t   line;
-
-
     if( cursorPos == -1 )
         cursorPos = fCursorPos;
 
-    for (line = 0; line < (int32_t)fLineStarts.size() - 1; line++)
-    {
-        if( fLineStarts[ line + 1 ] > cursorPos )
-            break;
-    }
-    return line;
+    if (fLineStarts.size() < 2)
+        return 0;
+
+    // Line starts are always in order, so we want the last one at or before the cursor
+    auto next = std::upper_bound(fLineStarts.cbegin() + 1, fLineStarts.cend(), cursorPos);
+    return (int32_t)std::distance(fLineStarts.cbegin(), next) - 1;
 }
 
 //// IRecalcFromCursor ///////////////////////////////////////////////////////
@@ -926,8 +1015,8 @@ void    pfGUIMultiLineEditCtrl::IOffsetLineStarts( uint32_t position, int32_t of
         }
     }
 
-    // Offset all lines past our given position
-    for (line = 0; line < (int32_t)fLineStarts.size(); line++)
+    // Offset all lines past our given position. None of the lines before ours start past it
+    for (; line < (int32_t)fLineStarts.size(); line++)
     {
         if( fLineStarts[ line ] > position )
             fLineStarts[ line ] += offset;
@@ -1291,6 +1380,7 @@ void    pfGUIMultiLineEditCtrl::InsertChar( wchar_t c )
         IOffsetLineStarts( fCursorPos, 1 );
         IMoveCursor( kOneForward );
         IRecalcFromCursor();
+        ITrimScrollback();
     }
 }
 
@@ -1318,6 +1408,7 @@ void    pfGUIMultiLineEditCtrl::InsertString( const wchar_t *string )
         IOffsetLineStarts( fCursorPos, numChars );
         IMoveCursorTo( fCursorPos + numChars );
         IRecalcFromCursor();
+        ITrimScrollback();
     }
 }
 
@@ -1334,8 +1425,12 @@ void    pfGUIMultiLineEditCtrl::InsertColor( hsColorRGBA &color )
     IActuallyInsertColor( fCursorPos, color );
     IOffsetLineStarts(fCursorPos, kColorCodeSize);
     fCursorPos += kColorCodeSize;
-    IRecalcFromCursor( true );  // Force update of all following lines, since 
-                                // insertion of this code changes appearance of following characters
+
+    // Colors don't change any widths, so the line starts settle as quickly as with any other
+    // insertion. The following characters do change appearance, though, so redraw all of them
+    int32_t line = IFindCursorLine();
+    IRecalcLineStarts( line, false );
+    IUpdate( line, (int32_t)fLineStarts.size() - 1 );
 }
 
 void    pfGUIMultiLineEditCtrl::IActuallyInsertColor( int32_t pos, hsColorRGBA &color )
@@ -1813,85 +1908,112 @@ void pfGUIMultiLineEditCtrl::DeleteLinesFromTop(int numLines)
     if (fPrevCtrl || fNextCtrl)
         return; // don't do anything
 
-    size_t bufferLen = 0;
-    wchar_t* buffer = GetCodedBufferW(bufferLen);
-
+    int32_t bufferLen = (int32_t)fBuffer.size() - 1;
     if (bufferLen == 0)
-    {
-        delete [] buffer;
         return;
-    }
 
+    // Find the newline ending the last line to go. We need to skip the crappy color and style
+    // "tags" so non-character values inside them don't trigger our newline check
+    int32_t cut = 0;
     for (int curLine = 0; curLine < numLines; ++curLine)
     {
-        bool hitEnd = true; // did we hit the end of the buffer before we hit a newline?
+        while (cut < bufferLen - 1 && fBuffer[cut] != L'\n' && fBuffer[cut] != L'\r')
+            cut += IOffsetToNextChar(fBuffer[cut]);
 
-        // search for the first newline and nuke it and everything before it
-        bool skippingColor = false, skippingStyle = false;
-        int curColorPos = 0, curStylePos = 0;
-        for (uint32_t curChar = 0; curChar < bufferLen - 1; ++curChar)
+        if (cut >= bufferLen - 1)
         {
-            // we need to skip the crappy color and style "tags" so non-character values inside them
-            // don't trigger our newline check
-            if (!skippingColor && !skippingStyle)
-            {
-                if (buffer[curChar] == kColorCodeChar)
-                {
-                    curColorPos = 0;
-                    skippingColor = true;
-                    continue;
-                }
-                else if (buffer[curChar] == kStyleCodeChar)
-                {
-                    curStylePos = 0;
-                    skippingStyle = true;
-                    continue;
-                }
-            }
+            SetBuffer(L""); // we are removing too many (or all) lines, just clear it
+            return;
+        }
 
-            if (skippingColor)
-            {
-                ++curColorPos;
-                if (curColorPos == kColorCodeSize)
-                    skippingColor = false;
-                else
-                    continue;
-            }
+        cut++; // eat the newline as well
+    }
 
-            if (skippingStyle)
-            {
-                ++curStylePos;
-                if (curStylePos == kStyleCodeSize)
-                    skippingStyle = false;
-                else
-                    continue;
-            }
+    fCursorPos = 0;
+    IEraseFromTop(cut, false);
+}
 
-            // if it's a newline, erase it and everything before it
-            if ((buffer[curChar] == L'\n') || (buffer[curChar] == L'\r'))
-            {
-                hitEnd = false;
-                uint32_t newBufferStart = curChar + 1; // +1 so we eat the newline as well
-                uint32_t newBufferLen = bufferLen - newBufferStart;
-                memcpy(buffer, buffer + newBufferStart, newBufferLen * sizeof(wchar_t)); // copy all bytes after the newline to the beginning
-                memset(buffer + newBufferLen, 0, (bufferLen - newBufferLen) * sizeof(wchar_t)); // fill out the rest of the buffer with null chars
-                bufferLen = newBufferLen;
-                break;
-            }
-        }
+//// IEraseFromTop ///////////////////////////////////////////////////////////
+//  Erases the given number of characters, which must end on a line break, off
+//  the top of the buffer. Whatever is left wraps exactly the same as before,
+//  so the line starts are just moved up instead of recalculated, unless a
+//  style code went with the erased text. If keepView is set, the scroll
+//  position moves up with the text so the same lines stay visible.
 
-        if (hitEnd)
-        {
-            delete [] buffer;
-            SetBuffer(L""); // we are removing too many (or all) lines, just clear it
-            return;
-        }
+void pfGUIMultiLineEditCtrl::IEraseFromTop(int32_t numChars, bool keepView)
+{
+    bool styleGone = false;
+    for (int32_t pos = 0; pos < numChars; pos += IOffsetToNextChar(fBuffer[pos]))
+    {
+        if (fBuffer[pos] == kStyleCodeChar)
+            styleGone = true;
+    }
+
+    fBuffer.erase(fBuffer.begin(), fBuffer.begin() + numChars);
+    fCursorPos = std::max(fCursorPos - numChars, 0);
 
-        // still got lines to go, start looking for the next line
+    auto firstKept = std::lower_bound(fLineStarts.begin(), fLineStarts.end(), numChars);
+    int32_t numLinesGone = (int32_t)std::distance(fLineStarts.begin(), firstKept);
+    if (keepView)
+        fScrollPos = std::max(fScrollPos - numLinesGone, 0);
+
+    if (styleGone || firstKept == fLineStarts.end() || *firstKept != numChars ||
+        fLineStyles.size() != fLineStarts.size())
+    {
+        IRecalcLineStarts(0, true, true);
+    }
+    else
+    {
+        fLineStarts.erase(fLineStarts.begin(), firstKept);
+        fLineStyles.erase(fLineStyles.begin(), fLineStyles.begin() + numLinesGone);
+        for (int32_t &start : fLineStarts)
+            start -= numChars;
+        IUpdateScrollRange();
     }
 
-    // we got here, so buffer is now our new buffer
-    SetBuffer(buffer, bufferLen);
-    delete [] buffer;
-    return;
+    if (keepView && fScrollControl != nullptr)
+        fScrollControl->SetCurrValue( fScrollControl->GetMax() - (float)fScrollPos );
+
+    fLastCursorLine = IFindCursorLine();
+
+    // Everything visible just moved, so redraw it all
+    IUpdate();
+}
+
+//// ITrimScrollback /////////////////////////////////////////////////////////
+//  Drops whole lines off the top until we're back within our scrollback
+//  limit, keeping the view where it was.
+
+void pfGUIMultiLineEditCtrl::ITrimScrollback()
+{
+    if (fScrollbackLimit < 0 || fPrevCtrl || fNextCtrl)
+        return;
+
+    int32_t excess = (int32_t)fLineStarts.size() - fScrollbackLimit;
+    if (excess <= 0)
+        return;
+
+    // We can only cut right after a newline, so go up to the end of the
+    // paragraph the last excess line is in
+    int32_t bufferLen = (int32_t)fBuffer.size() - 1;
+    int32_t cut = fLineStarts[excess - 1];
+    while (cut < bufferLen && fBuffer[cut] != L'\n' && fBuffer[cut] != L'\r')
+        cut += IOffsetToNextChar(fBuffer[cut]);
+
+    if (cut >= bufferLen - 1)
+        return; // we'd be erasing everything, including the line we're on
+
+    IEraseFromTop(cut + 1, true);
+}
+
+//// EndUpdate ///////////////////////////////////////////////////////////////
+
+void pfGUIMultiLineEditCtrl::EndUpdate(bool redraw)
+{
+    fCanUpdate = true;
+    if (redraw && fDirtyStart <= fDirtyEnd)
+        IUpdate(fDirtyStart, fDirtyEnd);
+
+    fDirtyStart = 0;
+    fDirtyEnd = -1;
 }
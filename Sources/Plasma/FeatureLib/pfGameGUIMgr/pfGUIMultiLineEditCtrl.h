@@ -100,6 +100,7 @@ class pfGUIMultiLineEditCtrl : public pfGUIControlMod
 
         std::vector<wchar_t> fBuffer;
         std::vector<int32_t> fLineStarts;
+        std::vector<uint8_t> fLineStyles;   // Style in effect at each line start, so we don't have to search back for it
         uint16_t        fLineHeight, fCurrCursorX, fCurrCursorY;
         int32_t         fCursorPos, fLastCursorLine;
         bool            fReadyToRender;
@@ -122,7 +123,9 @@ class pfGUIMultiLineEditCtrl : public pfGUIControlMod
         pfMLScrollProc  *fScrollProc;
         int32_t           fScrollPos;
         int32_t           fBufferLimit;
+        int32_t           fScrollbackLimit;
         bool              fCanUpdate;
+        int32_t           fDirtyStart, fDirtyEnd;   // Lines to redraw once updates are allowed again
 
         pfGUIMultiLineEditCtrl *fNextCtrl; // used for linking multiple controls together to share a buffer
         pfGUIMultiLineEditCtrl *fPrevCtrl;
@@ -151,14 +154,16 @@ class pfGUIMultiLineEditCtrl : public pfGUIControlMod
         int32_t   IRecalcLineStarts( int32_t startingLine, bool force, bool dontUpdate = false );
         void    IRecalcFromCursor( bool forceUpdate = false );
         int32_t   IFindCursorLine( int32_t cursorPos = -1 ) const;
-        bool    IStoreLineStart(int32_t line, int32_t start);
+        bool    IStoreLineStart(int32_t line, int32_t start, uint8_t style);
+        uint8_t IFindLineStyle( int32_t line ) const;
         void    IOffsetLineStarts( uint32_t position, int32_t offset, bool offsetSelectionEnd = false );
         int32_t   IPointToPosition( int16_t x, int16_t y, bool searchOutsideBounds = false );
         int32_t   ICalcNumVisibleLines() const;
 
         void    IReadColorCode( int32_t &pos, hsColorRGBA &color ) const;
         void    IReadStyleCode( int32_t &pos, uint8_t &fontStyle ) const;
-        uint32_t  IRenderLine( uint16_t x, uint16_t y, int32_t start, int32_t end, bool dontRender = false );
+        uint32_t  IRenderLine( uint16_t x, uint16_t y, int32_t start, int32_t end, hsColorRGBA color, uint8_t style, bool dontRender = false );
+        void    IScanCodes( int32_t start, int32_t end, hsColorRGBA &color, uint8_t &style ) const;
         bool    IFindLastColorCode( int32_t pos, hsColorRGBA &color, bool ignoreFirstCharacter = false ) const;
         bool    IFindLastStyleCode( int32_t pos, uint8_t &style, bool ignoreFirstCharacter = false ) const;
 
@@ -171,6 +176,8 @@ class pfGUIMultiLineEditCtrl : public pfGUIControlMod
         void    IActuallyInsertStyle( int32_t pos, uint8_t style );
 
         void    IUpdateScrollRange();
+        void    IEraseFromTop( int32_t numChars, bool keepView );
+        void    ITrimScrollback();
 
         wchar_t *ICopyRange( int32_t start, int32_t end ) const;
 
@@ -246,6 +253,10 @@ class pfGUIMultiLineEditCtrl : public pfGUIControlMod
         void    SetBufferLimit(int32_t limit) { fBufferLimit = limit; }
         int32_t   GetBufferLimit() { return fBufferLimit; }
 
+        // Once there are more lines than this, whole lines are dropped off the top. -1 means no limit
+        void    SetScrollbackLimit(int32_t lines) { fScrollbackLimit = lines; ITrimScrollback(); }
+        int32_t   GetScrollbackLimit() const { return fScrollbackLimit; }
+
         void    GetThisKeyPressed( char &key, uint8_t &modifiers ) const { key = (char)fLastKeyPressed; modifiers = fLastKeyModifiers; }
 
         void    Lock();
@@ -286,13 +297,8 @@ class pfGUIMultiLineEditCtrl : public pfGUIControlMod
         /** Signifies that the control will be updated heavily starting now, so suppress all redraws. */
         void BeginUpdate() { fCanUpdate = false; }
 
-        /** Signifies that the massive updates are over. We can now redraw. */
-        void EndUpdate(bool redraw=true)
-        {
-            fCanUpdate = true;
-            if (redraw)
-                IUpdate();
-        }
+        /** Signifies that the massive updates are over. We can now redraw the lines that changed. */
+        void EndUpdate(bool redraw=true);
 };
 
 #endif // _pfGUIMultiLineEditCtrl_h
@@ -119,7 +119,11 @@ void    pfGUITextBoxMod::IUpdate()
 
     std::wstring drawStr;
     if (fUseLocalizationPath && !fLocalizationPath.empty() && pfLocalizationMgr::InstanceValid())
-        drawStr = pfLocalizationMgr::Instance().GetString(fLocalizationPath).to_wchar().data();
+    {
+        if (fLocalizationKey.GetPath() != fLocalizationPath)
+            fLocalizationKey = pfLocalizationMgr::Instance().InternKey(fLocalizationPath);
+        drawStr = pfLocalizationMgr::Instance().GetString(fLocalizationKey).to_wchar().data();
+    }
     else
     {
         if (fText != nullptr)
@@ -52,6 +52,8 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "pfGUIControlMod.h"
 
+#include "pfLocalizationMgr/pfLocalizationMgr.h"
+
 class hsGMaterial;
 class plMessage;
 class plTextGenerator;
@@ -62,6 +64,7 @@ class pfGUITextBoxMod : public pfGUIControlMod
 
         wchar_t         *fText;
         ST::string      fLocalizationPath;
+        pfLocalizationMgr::Key fLocalizationKey;
         bool            fUseLocalizationPath;
 
 
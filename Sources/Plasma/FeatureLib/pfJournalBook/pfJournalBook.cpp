@@ -50,8 +50,10 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "pfJournalBook.h"
 
-#include <memory>
+#include <algorithm>
 #include <cwchar>
+#include <iterator>
+#include <memory>
 
 #include "HeadSpin.h"
 #include "hsGDeviceRef.h"
@@ -59,6 +61,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "hsResMgr.h"
 #include "pcSmallRect.h"
 #include "hsTimer.h"
+#include "plProfile.h"
 #include "plTimerCallbackManager.h"
 
 #include "pnKeyedObject/plFixedKey.h"
@@ -95,6 +98,10 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "pfMessage/pfGUINotifyMsg.h"
 #include "pfSurface/plLayerAVI.h"
 
+plProfile_CreateTimer("BookLayout", "RenderSetup", BookLayout);
+plProfile_CreateTimer("BookRaster", "RenderSetup", BookRaster);
+plProfile_CreateCounter("BookCacheHits", "RenderSetup", BookCacheHits);
+plProfile_CreateCounter("BookPreRenders", "RenderSetup", BookPreRenders);
 
 //////////////////////////////////////////////////////////////////////////////
 //// pfEsHTMLChunk Class /////////////////////////////////////////////////////
@@ -959,6 +966,10 @@ void pfBookData::IFinishTriggeredFlip(bool wasBackwards)
 
     // Start our FX once the page is done turning
     fResetSFXFlag = true;
+
+    // And get the pages on either side ready for the next turn
+    if (fCurrBook)
+        fCurrBook->IQueuePreRender();
 }
 
 //// UpdatePageCorners //////////////////////////////////////////////////////
@@ -1144,6 +1155,7 @@ pfJournalBook::pfJournalBook(const char *esHTMLSource, plKey coverImageKey, plKe
     fTintCover = false;
     fAreEditing = false;
     fWantEditing = false;
+    fPreRenderRegistered = false;
     fDefLoc = hintLoc;
 
     wchar_t *wESHTMLSource = hsStringToWString(esHTMLSource);
@@ -1180,6 +1192,7 @@ pfJournalBook::pfJournalBook(const wchar_t *esHTMLSource, plKey coverImageKey, p
     fTintCover = false;
     fAreEditing = false;
     fWantEditing = false;
+    fPreRenderRegistered = false;
     fDefLoc = hintLoc;
     fUncompiledSource = esHTMLSource;
 
@@ -1192,6 +1205,7 @@ pfJournalBook::~pfJournalBook()
         if( fBookGUIs[fCurBookGUI] && fBookGUIs[fCurBookGUI]->CurBook() == this )
             Hide();
 
+    IStopPreRender();
     IFreeSource();
 }
 
@@ -1199,6 +1213,30 @@ pfJournalBook::~pfJournalBook()
 
 bool    pfJournalBook::MsgReceive( plMessage *pMsg )
 {
+    plTimeMsg *time = plTimeMsg::ConvertNoRef( pMsg );
+    if (time != nullptr)
+    {
+        // Only one page a frame, and never while a page is turning, or we'd
+        // hitch the very thing we're trying to smooth out
+        pfBookData *bookData = fBookGUIs[fCurBookGUI];
+        if (!bookData || bookData->CurBook() != this || !fAreWeShowing || fAreEditing)
+            fPreRenderQueue.clear();
+        else if (!bookData->CurrentlyTurning())
+        {
+            while (!fPreRenderQueue.empty())
+            {
+                uint32_t page = fPreRenderQueue.front();
+                fPreRenderQueue.pop_front();
+                if (IPreRenderPage(page))
+                    break;
+            }
+        }
+
+        if (fPreRenderQueue.empty())
+            IStopPreRender();
+        return true;
+    }
+
     return hsKeyedObject::MsgReceive( pMsg );
 }
 
@@ -1284,6 +1322,7 @@ void    pfJournalBook::IFinishShow( bool startOpened )
         fVisibleLinks.clear();
         IRenderPage( 0, pfJournalDlgProc::kTagLeftDTMap );
         IRenderPage( 1, pfJournalDlgProc::kTagRightDTMap );
+        IQueuePreRender();
 
         fBookGUIs[fCurBookGUI]->UpdatePageCorners( pfBookData::kBothSides );
     }
@@ -1307,6 +1346,8 @@ void    pfJournalBook::Hide()
             ILoadAllImages( true );
             // purge the dynaTextMaps, we're done with them for now
             IPurgeDynaTextMaps();
+            IStopPreRender();
+            IClearPageCache();
             // nuke the movies so they don't stay in memory (they're big!)
             for (loadedMovie* lm : fLoadedMovies)
             {
@@ -1334,6 +1375,7 @@ void    pfJournalBook::Open( uint32_t startingPage /*= 0 */)
         fVisibleLinks.clear();
         IRenderPage( startingPage, pfJournalDlgProc::kTagLeftDTMap );
         IRenderPage( startingPage + 1, pfJournalDlgProc::kTagRightDTMap );
+        IQueuePreRender();
 
         fBookGUIs[fCurBookGUI]->UpdatePageCorners( pfBookData::kBothSides );
     }
@@ -1657,6 +1699,7 @@ void    pfJournalBook::GoToPage( uint32_t pageNumber )
     fVisibleLinks.clear();
     IRenderPage( fCurrentPage, pfJournalDlgProc::kTagLeftDTMap );
     IRenderPage( fCurrentPage + 1, pfJournalDlgProc::kTagRightDTMap );
+    IQueuePreRender();
     fBookGUIs[fCurBookGUI]->UpdatePageCorners( pfBookData::kBothSides );
 }
 
@@ -2125,6 +2168,7 @@ bool    pfJournalBook::ICompileSource(const wchar_t *source, const plLocation &h
 
     // Reset a few
     fPageStarts = {0};
+    IClearPageCache();
     if (fAreEditing)
         fLastPage = 0;
     else
@@ -2334,12 +2378,7 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
 
     // Make sure our page starts are up-to-snuff, at least to this point
     IRecalcPageStarts( page );
-
-    // Render!
-    hsColorRGBA color;
-    color.Set( 0, 0, 0, 0 );
-    if( !suppressRendering )
-        dtMap->ClearToColor( color );
+    size_t firstLink = fVisibleLinks.size();
 
     hsGMaterial *material = nullptr;
     if (whichDTMap == pfJournalDlgProc::kTagLeftDTMap)
@@ -2366,6 +2405,19 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
         }
     }
 
+    if (!suppressRendering && IRestoreCachedPage(page, dtMap, whichDTMap))
+        return;
+
+    // Render!
+    hsColorRGBA color;
+    color.Set( 0, 0, 0, 0 );
+    if( !suppressRendering )
+    {
+        plProfile_BeginTiming(BookRaster);
+        dtMap->ClearToColor( color );
+        plProfile_EndTiming(BookRaster);
+    }
+
     hsAssert(page < fPageStarts.size() || page > fLastPage, "UnInitialized page start!");
     if (page <= fLastPage
         && page < fPageStarts.size())   // Added this as a crash-prevention bandaid - MT
@@ -2416,10 +2468,16 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
                     width = (uint16_t)(512 - fPageLMargin - fPageRMargin);
                     height = (uint16_t)(512 - fPageBMargin - y);
                     uint32_t lastChar;
+                    plProfile_BeginTiming(BookLayout);
                     dtMap->CalcWrappedStringSize( chunk->fText.c_str(), &width, &height, &lastChar, &ascent, &lastX, &lastY );
+                    plProfile_EndTiming(BookLayout);
                     width = (uint16_t)(512 - fPageLMargin - fPageRMargin);
                     if( !suppressRendering )
+                    {
+                        plProfile_BeginTiming(BookRaster);
                         dtMap->DrawWrappedString( (uint16_t)fPageLMargin, y, chunk->fText.c_str(), width, (uint16_t)(512 - fPageBMargin - y), &lastX, &lastY );
+                        plProfile_EndTiming(BookRaster);
+                    }
 
                     if( lastChar == 0 )
                     {
@@ -2454,6 +2512,7 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
                         // Invalidate our cache starting with the next page
                         if (fPageStarts.size() > page + 1)
                             fPageStarts.resize(page + 1);
+                        IClearPageCache(page + 1);
 
                         y += 512;
                         break;
@@ -2600,6 +2659,9 @@ void    pfJournalBook::IRenderPage( uint32_t page, uint32_t whichDTMap, bool sup
         if (idx == fHTMLSource.size())
             fLastPage = page;
 
+        if (!suppressRendering && IIsPageCacheable(page))
+            ICachePage(page, dtMap, whichDTMap, firstLink);
+
         pfBookData::WhichSide thisWhich = ( whichDTMap == pfJournalDlgProc::kTagRightDTMap ) ? pfBookData::kRightSide : ( whichDTMap == pfJournalDlgProc::kTagLeftDTMap )  ? pfBookData::kLeftSide : pfBookData::kNoSides;
         if( needSFX )
             fBookGUIs[fCurBookGUI]->RegisterForSFX( (pfBookData::WhichSide)( fBookGUIs[fCurBookGUI]->CurSFXPages() | thisWhich ) );
@@ -2651,6 +2713,7 @@ void    pfJournalBook::IMoveMovies( hsGMaterial *source, hsGMaterial *dest )
 
 void    pfJournalBook::IDrawMipmap( pfEsHTMLChunk *chunk, uint16_t x, uint16_t y, plMipmap *mip, plDynamicTextMap *dtMap, uint32_t whichDTMap, bool dontRender )
 {
+    plProfile_BeginTiming(BookRaster);
     plMipmap *copy = new plMipmap();
     copy->CopyFrom(mip);
     if (chunk->fNoResizeImg)
@@ -2741,6 +2804,7 @@ void    pfJournalBook::IDrawMipmap( pfEsHTMLChunk *chunk, uint16_t x, uint16_t y
         fVisibleLinks.emplace_back(chunk);
     }
     delete copy;
+    plProfile_EndTiming(BookRaster);
 }
 
 pfJournalBook::loadedMovie *pfJournalBook::IMovieAlreadyLoaded(pfEsHTMLChunk *chunk)
@@ -3214,6 +3278,203 @@ void    pfJournalBook::IRecalcPageStarts( uint32_t upToPage )
     }
 }
 
+//// IIsPageCacheable ////////////////////////////////////////////////////////
+//  A page can only be kept as a bitmap if drawing it again would give the
+//  same pixels: no movies, no glowing or check box images, and every image
+//  already loaded. We also need to know where the page ends.
+
+bool    pfJournalBook::IIsPageCacheable( uint32_t page ) const
+{
+    if (fAreEditing || page + 1 >= fPageStarts.size())
+        return false;
+
+    for (uint32_t idx = fPageStarts[page]; idx < fPageStarts[page + 1] && idx < fHTMLSource.size(); idx++)
+    {
+        const pfEsHTMLChunk *chunk = fHTMLSource[ idx ];
+        if (chunk->fType == pfEsHTMLChunk::kMovie)
+            return false;
+        if (chunk->fType == pfEsHTMLChunk::kImage)
+        {
+            if (chunk->fFlags & (pfEsHTMLChunk::kGlowing | pfEsHTMLChunk::kActAsCB))
+                return false;
+            if (chunk->fImageKey != nullptr && chunk->fImageKey->ObjectIsLoaded() == nullptr)
+                return false;
+        }
+    }
+    return true;
+}
+
+//// IFindCachedPage /////////////////////////////////////////////////////////
+
+std::list<pfJournalBook::CachedPage>::iterator pfJournalBook::IFindCachedPage( uint32_t page )
+{
+    auto iter = std::find_if(fPageCache.begin(), fPageCache.end(),
+                             [page](const CachedPage& cached) { return cached.fPage == page; });
+    if (iter == fPageCache.end())
+        return iter;
+
+    // If the layout moved underneath us, the bitmap is no good anymore
+    if (page + 1 >= fPageStarts.size() || fPageStarts[page] != iter->fStart || fPageStarts[page + 1] != iter->fEnd)
+    {
+        fPageCache.erase(iter);
+        return fPageCache.end();
+    }
+    return iter;
+}
+
+//// IRestoreCachedPage //////////////////////////////////////////////////////
+//  Copies a cached page into the given DTMap and puts its links back, just
+//  as IRenderPage would have left them.
+
+bool    pfJournalBook::IRestoreCachedPage( uint32_t page, plDynamicTextMap *dtMap, uint32_t whichDTMap )
+{
+    auto iter = IFindCachedPage(page);
+    if (iter == fPageCache.end() || !dtMap->IsValid() || dtMap->GetLevelSize(0) != iter->fImage.size())
+        return false;
+
+    // Most recently used goes to the front
+    fPageCache.splice(fPageCache.begin(), fPageCache, iter);
+
+    memcpy(dtMap->GetImage(), iter->fImage.data(), iter->fImage.size());
+
+    // Right page rects are offsetted to differentiate
+    int16_t xOffset = 0;
+    if (whichDTMap == pfJournalDlgProc::kTagRightDTMap || whichDTMap == pfJournalDlgProc::kTagTurnFrontDTMap)
+        xOffset = (int16_t)dtMap->GetWidth();
+    for (const auto& link : iter->fLinks)
+    {
+        pfEsHTMLChunk *chunk = link.first;
+        chunk->fLinkRect = link.second;
+        if (chunk->fLinkRect.fWidth != 0 || chunk->fLinkRect.fHeight != 0)
+            chunk->fLinkRect.fX += xOffset;
+        fVisibleLinks.emplace_back(chunk);
+    }
+
+    // Cached pages never have any FX running
+    pfBookData::WhichSide thisWhich = ( whichDTMap == pfJournalDlgProc::kTagRightDTMap ) ? pfBookData::kRightSide : ( whichDTMap == pfJournalDlgProc::kTagLeftDTMap )  ? pfBookData::kLeftSide : pfBookData::kNoSides;
+    fBookGUIs[fCurBookGUI]->RegisterForSFX( (pfBookData::WhichSide)( fBookGUIs[fCurBookGUI]->CurSFXPages() & ~thisWhich ) );
+
+    dtMap->FlushToHost();
+    plProfile_IncCount(BookCacheHits, 1);
+    return true;
+}
+
+//// ICachePage //////////////////////////////////////////////////////////////
+//  Keeps a copy of the page just rendered into dtMap, along with the links
+//  it added from firstLink on.
+
+void    pfJournalBook::ICachePage( uint32_t page, plDynamicTextMap *dtMap, uint32_t whichDTMap, size_t firstLink )
+{
+    if (!dtMap->IsValid())
+        return;
+
+    auto iter = IFindCachedPage(page);
+    if (iter == fPageCache.end())
+    {
+        if (fPageCache.size() >= kMaxCachedPages)
+        {
+            // Reuse the least recently used page's buffer
+            fPageCache.splice(fPageCache.begin(), fPageCache, std::prev(fPageCache.end()));
+        }
+        else
+            fPageCache.emplace_front();
+    }
+    else
+        fPageCache.splice(fPageCache.begin(), fPageCache, iter);
+
+    CachedPage &cached = fPageCache.front();
+    cached.fPage = page;
+    cached.fStart = fPageStarts[page];
+    cached.fEnd = fPageStarts[page + 1];
+    cached.fImage.assign((const uint8_t *)dtMap->GetImage(), (const uint8_t *)dtMap->GetImage() + dtMap->GetLevelSize(0));
+
+    int16_t xOffset = 0;
+    if (whichDTMap == pfJournalDlgProc::kTagRightDTMap || whichDTMap == pfJournalDlgProc::kTagTurnFrontDTMap)
+        xOffset = (int16_t)dtMap->GetWidth();
+    cached.fLinks.clear();
+    for (size_t i = firstLink; i < fVisibleLinks.size(); i++)
+    {
+        pcSmallRect rect = fVisibleLinks[ i ]->fLinkRect;
+        if (rect.fWidth != 0 || rect.fHeight != 0)
+            rect.fX -= xOffset;
+        cached.fLinks.emplace_back(fVisibleLinks[ i ], rect);
+    }
+}
+
+//// IClearPageCache /////////////////////////////////////////////////////////
+// Forgets the cached bitmaps of the given page and everything after it
+
+void    pfJournalBook::IClearPageCache( uint32_t fromPage )
+{
+    fPageCache.remove_if([fromPage](const CachedPage& cached) { return cached.fPage >= fromPage; });
+}
+
+//// IQueuePreRender /////////////////////////////////////////////////////////
+//  Lines up the spreads on either side of the current one for rendering into
+//  the cache, a page per frame, while the reader is busy with this one.
+
+void    pfJournalBook::IQueuePreRender()
+{
+    fPreRenderQueue.clear();
+    if (fAreEditing)
+        return;
+
+    // Forward first, since that's usually where the reader is headed
+    fPreRenderQueue.emplace_back(fCurrentPage + 2);
+    fPreRenderQueue.emplace_back(fCurrentPage + 3);
+    if (fCurrentPage >= 2)
+    {
+        fPreRenderQueue.emplace_back(fCurrentPage - 2);
+        fPreRenderQueue.emplace_back(fCurrentPage - 1);
+    }
+
+    if (!fPreRenderRegistered)
+    {
+        plgDispatch::Dispatch()->RegisterForExactType(plTimeMsg::Index(), GetKey());
+        fPreRenderRegistered = true;
+    }
+}
+
+void    pfJournalBook::IStopPreRender()
+{
+    fPreRenderQueue.clear();
+    if (fPreRenderRegistered)
+    {
+        plgDispatch::Dispatch()->UnRegisterForExactType(plTimeMsg::Index(), GetKey());
+        fPreRenderRegistered = false;
+    }
+}
+
+//// IPreRenderPage //////////////////////////////////////////////////////////
+//  Renders the given page into the cache, using the turn page's back as
+//  scratch space, like IRecalcPageStarts does. Returns false if there was
+//  nothing to do.
+
+bool    pfJournalBook::IPreRenderPage( uint32_t page )
+{
+    if (page > fLastPage || IFindCachedPage(page) != fPageCache.end())
+        return false;
+
+    // Already laid out, but not something we can keep
+    bool laidOut = page + 1 < fPageStarts.size();
+    if (laidOut && !IIsPageCacheable(page))
+        return false;
+
+    // None of this is on screen, so keep it out of the visible links
+    std::vector<pfEsHTMLChunk *> visibleLinks;
+    visibleLinks.swap(fVisibleLinks);
+    if (laidOut)
+        IRenderPage(page, pfJournalDlgProc::kTagTurnBackDTMap);
+    else
+        IRecalcPageStarts(page + 1);    // Laying it out renders (and caches) it
+    for (pfEsHTMLChunk* linkChunk : fVisibleLinks)
+        linkChunk->fLinkRect.Set(0, 0, 0, 0);
+    fVisibleLinks.swap(visibleLinks);
+
+    plProfile_IncCount(BookPreRenders, 1);
+    return true;
+}
+
 //// ISendNotify /////////////////////////////////////////////////////////////
 // Just sends out a notify to our currently set receiver key
 
@@ -3238,6 +3499,9 @@ void    pfJournalBook::SetBookSize( float width, float height )
     fWidthScale = 1.f - width;
     fHeightScale = 1.f - height;
 
+    // Unresized images depend on the book size
+    IClearPageCache();
+
     if( fBookGUIs[fCurBookGUI]->CurBook() == this )
         fBookGUIs[fCurBookGUI]->SetCurrSize( fWidthScale, fHeightScale );
 }
@@ -166,11 +166,16 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "HeadSpin.h"
 
+#include <deque>
+#include <list>
 #include <map>
 #include <string>
 #include <string_theory/string>
+#include <utility>
+#include <vector>
 
 #include "hsColorRGBA.h"
+#include "pcSmallRect.h"
 
 #include "pnKeyedObject/hsKeyedObject.h"
 #include "pnKeyedObject/plUoid.h"
@@ -442,7 +447,7 @@ class pfJournalBook : public hsKeyedObject
         uint32_t  GetCurrentPage() const { return fCurrentPage; }
 
         // Set the margin (defaults to 16 pixels)
-        void    SetPageMargin( uint32_t margin ) { fPageTMargin = fPageLMargin = fPageBMargin = fPageRMargin = margin; }
+        void    SetPageMargin( uint32_t margin ) { fPageTMargin = fPageLMargin = fPageBMargin = fPageRMargin = margin; IClearPageCache(); }
 
         // Turns on or off page turning
         void    AllowPageTurning( bool allow ) { fAllowTurning = allow; }
@@ -520,6 +525,20 @@ class pfJournalBook : public hsKeyedObject
         static std::map<ST::string,pfBookData*> fBookGUIs;
         ST::string fCurBookGUI;
 
+        // Pages we've already rendered, most recently used first. Turning to one of
+        // these (the neighbors get pre-rendered while the book sits idle) is just a
+        // copy into the DTMap. Pages with movies or special FX are never cached.
+        struct CachedPage
+        {
+            uint32_t    fPage, fStart, fEnd;
+            std::vector<uint8_t> fImage;
+            std::vector<std::pair<pfEsHTMLChunk *, pcSmallRect>> fLinks;
+        };
+        enum { kMaxCachedPages = 8 };
+        std::list<CachedPage>   fPageCache;
+        std::deque<uint32_t>    fPreRenderQueue;
+        bool                    fPreRenderRegistered;
+
         enum Refs
         {
             kRefImage = 0
@@ -540,6 +559,18 @@ class pfJournalBook : public hsKeyedObject
         // Renders one (1) page into the given DTMap
         void    IRenderPage( uint32_t page, uint32_t whichDTMap, bool suppressRendering = false );
 
+        // Page bitmap cache helpers
+        bool    IIsPageCacheable( uint32_t page ) const;
+        std::list<CachedPage>::iterator IFindCachedPage( uint32_t page );
+        bool    IRestoreCachedPage( uint32_t page, plDynamicTextMap *dtMap, uint32_t whichDTMap );
+        void    ICachePage( uint32_t page, plDynamicTextMap *dtMap, uint32_t whichDTMap, size_t firstLink );
+        void    IClearPageCache( uint32_t fromPage = 0 );
+
+        // Queues up the pages around the current spread, then renders one per frame
+        void    IQueuePreRender();
+        void    IStopPreRender();
+        bool    IPreRenderPage( uint32_t page );
+
         // moves the movie layers from one material onto another
         void    IMoveMovies( hsGMaterial *source, hsGMaterial *dest);
 
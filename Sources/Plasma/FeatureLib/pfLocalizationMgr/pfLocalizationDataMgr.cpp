@@ -47,6 +47,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 //////////////////////////////////////////////////////////////////////
 
 #include "HeadSpin.h"
+#include "hsJobSystem.h"
 
 #include "plFile/plEncryptedStream.h"
 #include "plResMgr/plLocalization.h"
@@ -110,6 +111,10 @@ protected:
 
     ageMap fData;
 
+    // Files are parsed on worker threads, so log lines are held here until the
+    // database writes them out
+    std::vector<ST::string> fLogLines;
+
     void IHandleLocalizationsTag(const tagInfo & parentTag, const tagInfo & thisTag);
 
     void IHandleAgeTag(const tagInfo & parentTag, const tagInfo & thisTag);
@@ -126,7 +131,7 @@ public:
           fCurrentAge(std::move(move.fCurrentAge)), fCurrentSet(std::move(move.fCurrentSet)),
           fCurrentElement(std::move(move.fCurrentElement)),
           fCurrentTranslation(std::move(move.fCurrentTranslation)),
-          fData(std::move(move.fData))
+          fData(std::move(move.fData)), fLogLines(std::move(move.fLogLines))
     {
         move.fParser = nullptr;
     }
@@ -135,24 +140,6 @@ public:
     void AddError(const ST::string & errorText);
 };
 
-// A few small helper structs
-// I am setting these up so the header file can use this data without having to put
-// the LocalizationXMLFile class into the header file
-struct LocElementInfo
-{
-    LocalizationXMLFile::element fElement;
-};
-
-struct LocSetInfo
-{
-    LocalizationXMLFile::set fSet;
-};
-
-struct LocAgeInfo
-{
-    LocalizationXMLFile::age fAge;
-};
-
 //////////////////////////////////////////////////////////////////////
 // Memory functions
 //////////////////////////////////////////////////////////////////////
@@ -387,7 +374,7 @@ bool LocalizationXMLFile::Parse(const plFileName& fileName)
     hsStream *xmlStream = plEncryptedStream::OpenEncryptedFile(fileName);
     if (!xmlStream)
     {
-        pfLocalizationDataMgr::GetLog()->AddLineF("ERROR: Can't open file stream for {}", fileName);
+        fLogLines.emplace_back(ST::format("ERROR: Can't open file stream for {}", fileName));
         return false;
     }
 
@@ -401,8 +388,8 @@ bool LocalizationXMLFile::Parse(const plFileName& fileName)
 
         if (XML_Parse(fParser, Buff, (int)len, done) == XML_STATUS_ERROR)
         {
-            pfLocalizationDataMgr::GetLog()->AddLineF("ERROR: Parse error at line {}: {}",
-                XML_GetCurrentLineNumber(fParser), XML_ErrorString(XML_GetErrorCode(fParser)));
+            fLogLines.emplace_back(ST::format("ERROR: Parse error at line {}: {}",
+                XML_GetCurrentLineNumber(fParser), XML_ErrorString(XML_GetErrorCode(fParser))));
             done = true;
         }
 
@@ -421,8 +408,8 @@ bool LocalizationXMLFile::Parse(const plFileName& fileName)
 
 void LocalizationXMLFile::AddError(const ST::string& errorText)
 {
-    pfLocalizationDataMgr::GetLog()->AddLineF("ERROR (line {}): {}",
-        XML_GetCurrentLineNumber(fParser), errorText);
+    fLogLines.emplace_back(ST::format("ERROR (line {}): {}",
+        XML_GetCurrentLineNumber(fParser), errorText));
     fSkipDepth = fTagStack.size(); // skip this block
     fWeExploded = true;
     return;
@@ -439,8 +426,6 @@ void LocalizationXMLFile::AddError(const ST::string& errorText)
 class LocalizationDatabase
 {
 protected:
-    plFileName fDirectory; // the directory we're supposed to parse
-
     std::vector<LocalizationXMLFile> fFiles; // the various XML files in that directory
 
     LocalizationXMLFile::ageMap fData;
@@ -458,7 +443,7 @@ protected:
 public:
     LocalizationDatabase() {}
 
-    void Parse(const plFileName & directory);
+    void Parse(const std::vector<plFileName> & locFiles);
     const LocalizationXMLFile::ageMap& GetData() const { return fData; }
 };
 
@@ -625,21 +610,33 @@ void LocalizationDatabase::IVerifyData()
 
 //// Parse() /////////////////////////////////////////////////////////
 
-void LocalizationDatabase::Parse(const plFileName & directory)
+void LocalizationDatabase::Parse(const std::vector<plFileName> & locFiles)
 {
-    fDirectory = directory;
     fFiles.clear();
+    fFiles.resize(locFiles.size());
+
+    // Each file gets its own expat parser, so they can all be read at once. The
+    // merge below still walks them in directory order.
+    std::vector<uint8_t> parsed(locFiles.size());
+    auto parseRange = [this, &locFiles, &parsed](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            parsed[i] = fFiles[i].Parse(locFiles[i]);
+    };
 
-    std::vector<plFileName> locFiles = plFileSystem::ListDir(directory, "*.loc");
-    for (const auto& file : locFiles)
+    if (locFiles.size() > 1 && hsJobSystem::InstanceValid())
+        hsJobSystem::Instance().ParallelFor(0, locFiles.size(), 1, parseRange);
+    else
+        parseRange(0, locFiles.size());
+
+    for (size_t i = 0; i < locFiles.size(); ++i)
     {
-        LocalizationXMLFile newFile;
-        bool retVal = newFile.Parse(file);
-        if (!retVal)
-            pfLocalizationDataMgr::GetLog()->AddLineF("WARNING: Errors in file {}", file.GetFileName());
+        for (const ST::string& line : fFiles[i].fLogLines)
+            pfLocalizationDataMgr::GetLog()->AddLine(line);
+        fFiles[i].fLogLines.clear();
 
-        fFiles.emplace_back(std::move(newFile));
-        pfLocalizationDataMgr::GetLog()->AddLineF("File {} parsed and added to database", file.GetFileName());
+        if (!parsed[i])
+            pfLocalizationDataMgr::GetLog()->AddLineF("WARNING: Errors in file {}", locFiles[i].GetFileName());
+        pfLocalizationDataMgr::GetLog()->AddLineF("File {} parsed and added to database", locFiles[i].GetFileName());
     }
 
     IMergeData();
@@ -809,15 +806,18 @@ std::vector<ST::string> pfLocalizationDataMgr::pf3PartMap<mapT>::getNameList(con
 
 pfLocalizationDataMgr   *pfLocalizationDataMgr::fInstance = nullptr;
 plStatusLog             *pfLocalizationDataMgr::fLog = nullptr; // output logfile
+uint32_t                pfLocalizationDataMgr::fGeneration = 1; // a Key that has never been looked up has generation 0
 
 //// Constructor/Destructor //////////////////////////////////////////
 
-pfLocalizationDataMgr::pfLocalizationDataMgr(const plFileName & path)
+pfLocalizationDataMgr::pfLocalizationDataMgr(const plFileName & path, const plFileName & cacheFile)
+    : fTableValid(false), fElementsBuilt(false), fCurrentLanguage(-1)
 {
     hsAssert(!fInstance, "Tried to create the localization data manager more than once!");
     fInstance = this;
 
     fDataPath = path;
+    fCacheFile = cacheFile;
 
     fDatabase = nullptr;
 }
@@ -871,50 +871,92 @@ std::vector<ST::string> pfLocalizationDataMgr::IGetAllLanguageNames()
     return retVal;
 }
 
-//// IConvertSubtitle ////////////////////////////////////////////////
+//// IParseData //////////////////////////////////////////////////////
 
-void pfLocalizationDataMgr::IConvertElement(LocElementInfo *elementInfo, const ST::string & curPath)
+void pfLocalizationDataMgr::IParseData(const std::vector<plFileName> & locFiles)
 {
-    pfLocalizationDataMgr::localizedElement newElement;
-    int16_t numArgs = -1;
+    if (fDatabase)
+        delete fDatabase;
+
+    fDatabase = new LocalizationDatabase();
+    fDatabase->Parse(locFiles);
+
+    fLog->AddLine("File reading complete, converting to native data format");
 
-    for (const auto& curTranslation : elementInfo->fElement)
+    // and now we read all the data out of the database and flatten it into the table
+    fTable.Clear();
+    for (const auto& curAge : fDatabase->GetData())
     {
-        newElement[curTranslation.first].FromXML(curTranslation.second);
-        uint16_t argCount = newElement[curTranslation.first].GetArgumentCount();
-        if (numArgs == -1) // just started
-            numArgs = argCount;
-        else if (argCount != numArgs)
-            fLog->AddLineF("WARNING: Argument number mismatch in element {} for {}", curPath, curTranslation.first);
+        for (const auto& curSet : curAge.second)
+        {
+            for (const auto& curElement : curSet.second)
+                fTable.AddEntry(ST::format("{}.{}.{}", curAge.first, curSet.first, curElement.first), curElement.second);
+        }
     }
 
-    fLocalizedElements[curPath] = newElement;
+    if (!fTable.BuildIndex())
+        fLog->AddLine("ERROR: Couldn't build the localization index, lookups will be slow");
 }
 
-//// IConvertSet /////////////////////////////////////////////////////
+//// IBuildElements //////////////////////////////////////////////////
 
-void pfLocalizationDataMgr::IConvertSet(LocSetInfo *setInfo, const ST::string & curPath)
+void pfLocalizationDataMgr::IBuildElements()
 {
-    for (const auto& curElement : setInfo->fSet)
+    if (fElementsBuilt)
+        return;
+    fElementsBuilt = true;
+
+    for (uint32_t curEntry = 0; curEntry < fTable.GetNumEntries(); curEntry++)
     {
-        LocElementInfo elementInfo{ curElement.second };
+        ST::string curPath = fTable.GetKey(curEntry);
+        localizedElement& newElement = fLocalizedElements[curPath];
+        int16_t numArgs = -1;
 
-        IConvertElement(&elementInfo, ST::format("{}.{}", curPath, curElement.first));
+        for (uint32_t curTranslation = 0; curTranslation < fTable.GetNumTranslations(curEntry); curTranslation++)
+        {
+            ST::string languageName = fTable.GetLanguage(curEntry, curTranslation);
+            newElement[languageName].FromXML(fTable.GetText(curEntry, curTranslation));
+            uint16_t argCount = newElement[languageName].GetArgumentCount();
+            if (numArgs == -1) // just started
+                numArgs = argCount;
+            else if (argCount != numArgs)
+                fLog->AddLineF("WARNING: Argument number mismatch in element {} for {}", curPath, languageName);
+        }
     }
 }
 
-//// IConvertAge /////////////////////////////////////////////////////
+//// IBuildCurrentElements ///////////////////////////////////////////
 
-void pfLocalizationDataMgr::IConvertAge(LocAgeInfo *ageInfo, const ST::string & curPath)
+void pfLocalizationDataMgr::IBuildCurrentElements()
 {
-    for (const auto& curSet : ageInfo->fAge)
-    {
-        LocSetInfo setInfo{ curSet.second };
+    fCurrentLanguage = plLocalization::GetLanguage();
+    ++fGeneration;
 
-        IConvertSet(&setInfo, ST::format("{}.{}", curPath, curSet.first));
+    ST::string languageName = IGetCurrentLanguageName();
+    fCurrentElements.clear();
+    fCurrentElements.resize(fTable.GetNumEntries());
+    for (uint32_t curEntry = 0; curEntry < fTable.GetNumEntries(); curEntry++)
+    {
+        uint32_t translation = fTable.FindTranslation(curEntry, languageName);
+        if (translation == pfLocalizationTable::kInvalidIndex) // current language isn't specified
+            translation = fTable.FindTranslation(curEntry, "English"); // force to english
+        if (translation != pfLocalizationTable::kInvalidIndex)
+            fCurrentElements[curEntry].FromXML(fTable.GetText(curEntry, translation));
     }
 }
 
+//// IInvalidateTable ////////////////////////////////////////////////
+
+void pfLocalizationDataMgr::IInvalidateTable()
+{
+    if (!fTableValid)
+        return;
+
+    fTableValid = false;
+    fCurrentElements.clear();
+    ++fGeneration;
+}
+
 //// IWriteText //////////////////////////////////////////////////////
 
 void pfLocalizationDataMgr::IWriteText(const plFileName & filename, const ST::string & ageName, const ST::string & languageName)
@@ -974,12 +1016,12 @@ void pfLocalizationDataMgr::IWriteText(const plFileName & filename, const ST::st
 
 //// Initialize //////////////////////////////////////////////////////
 
-void pfLocalizationDataMgr::Initialize(const plFileName & path)
+void pfLocalizationDataMgr::Initialize(const plFileName & path, const plFileName & cacheFile)
 {
     if (fInstance)
         return;
 
-    fInstance = new pfLocalizationDataMgr(path);
+    fInstance = new pfLocalizationDataMgr(path, cacheFile);
     fLog = plStatusLogMgr::GetInstance().CreateStatusLog(30, "LocalizationDataMgr.log",
         plStatusLog::kFilledBackground | plStatusLog::kAlignToTop | plStatusLog::kTimestamp);
     fInstance->SetupData();
@@ -1006,25 +1048,34 @@ void pfLocalizationDataMgr::Shutdown()
 
 void pfLocalizationDataMgr::SetupData()
 {
-    if (fDatabase)
-        delete fDatabase;
+    fLocalizedElements = pf3PartMap<localizedElement>();
+    fElementsBuilt = false;
 
-    fDatabase = new LocalizationDatabase();
-    fDatabase->Parse(fDataPath);
-
-    fLog->AddLine("File reading complete, converting to native data format");
+    std::vector<plFileName> locFiles = plFileSystem::ListDir(fDataPath, "*.loc");
+    std::vector<pfLocalizationTable::SourceFile> sources = pfLocalizationTable::ScanSources(locFiles);
 
-    // and now we read all the data out of the database and convert it to our native formats
-
-    // transfer localization data
-    for (const auto& curAge : fDatabase->GetData())
+    // Skip the XML parse entirely if the compiled cache matches every source file
+    if (fCacheFile.IsValid() && fTable.Read(fCacheFile, sources))
+    {
+        fLog->AddLineF("Loaded {} elements from cache {}", fTable.GetNumEntries(), fCacheFile);
+        delete fDatabase;
+        fDatabase = nullptr;
+    }
+    else
     {
-        LocAgeInfo ageInfo;
-        ageInfo.fAge = curAge.second;
+        IParseData(locFiles);
+        IBuildElements(); // reports argument mismatches, and the editor will want these anyway
 
-        IConvertAge(&ageInfo, curAge.first);
+        if (fCacheFile.IsValid() && !fTable.Write(fCacheFile, sources))
+            fLog->AddLineF("WARNING: Can't write localization cache {}", fCacheFile);
     }
 
+    fTableValid = fTable.IsIndexed();
+    if (fTableValid)
+        IBuildCurrentElements();
+    else
+        IBuildElements();
+
     OutputTreeToLog();
 }
 
@@ -1034,6 +1085,13 @@ pfLocalizedString pfLocalizationDataMgr::GetElement(const ST::string & name)
 {
     pfLocalizedString retVal; // if this returns before we initialize it, it will be empty, indicating failure
 
+    uint32_t index = FindElement(name);
+    if (index != pfLocalizationTable::kInvalidIndex)
+        return fCurrentElements[index];
+    if (fTableValid) // the table has everything, so it really doesn't exist
+        return retVal;
+
+    IBuildElements();
     if (!fLocalizedElements.exists(name)) // does the requested element exist?
         return retVal; // nope, so return failure
 
@@ -1048,12 +1106,34 @@ pfLocalizedString pfLocalizationDataMgr::GetElement(const ST::string & name)
     return retVal;
 }
 
+//// GetGeneration ///////////////////////////////////////////////////
+
+uint32_t pfLocalizationDataMgr::GetGeneration()
+{
+    if (fTableValid && fCurrentLanguage != plLocalization::GetLanguage())
+        IBuildCurrentElements();
+    return fGeneration;
+}
+
+//// FindElement /////////////////////////////////////////////////////
+
+uint32_t pfLocalizationDataMgr::FindElement(const ST::string & name)
+{
+    if (!fTableValid)
+        return pfLocalizationTable::kInvalidIndex;
+
+    if (fCurrentLanguage != plLocalization::GetLanguage())
+        IBuildCurrentElements();
+    return fTable.Find(name);
+}
+
 //// GetSpecificElement //////////////////////////////////////////////
 
 pfLocalizedString pfLocalizationDataMgr::GetSpecificElement(const ST::string & name, const ST::string & language)
 {
     pfLocalizedString retVal; // if this returns before we initialize it, it will have an ID of 0, indicating failure
 
+    IBuildElements();
     if (!fLocalizedElements.exists(name)) // does the requested subtitle exist?
         return retVal; // nope, so return failure
 
@@ -1070,6 +1150,7 @@ std::vector<ST::string> pfLocalizationDataMgr::GetLanguages(const ST::string & a
 {
     std::vector<ST::string> retVal;
     ST::string key = ST::format("{}.{}.{}", ageName, setName, elementName);
+    IBuildElements();
     if (fLocalizedElements.exists(key))
     {
         // age, set, and element exists
@@ -1087,6 +1168,7 @@ std::vector<ST::string> pfLocalizationDataMgr::GetLanguages(const ST::string & a
 
 ST::string pfLocalizationDataMgr::GetElementXMLData(const ST::string & name, const ST::string & languageName)
 {
+    IBuildElements();
     if (fLocalizedElements.exists(name) && (fLocalizedElements[name].find(languageName) != fLocalizedElements[name].end()))
         return fLocalizedElements[name][languageName].ToXML();
     return "";
@@ -1096,6 +1178,7 @@ ST::string pfLocalizationDataMgr::GetElementXMLData(const ST::string & name, con
 
 ST::string pfLocalizationDataMgr::GetElementPlainTextData(const ST::string & name, const ST::string & languageName)
 {
+    IBuildElements();
     if (fLocalizedElements.exists(name) && (fLocalizedElements[name].find(languageName) != fLocalizedElements[name].end()))
         return fLocalizedElements[name][languageName];
     return "";
@@ -1105,9 +1188,11 @@ ST::string pfLocalizationDataMgr::GetElementPlainTextData(const ST::string & nam
 
 bool pfLocalizationDataMgr::SetElementXMLData(const ST::string & name, const ST::string & languageName, const ST::string & xmlData)
 {
+    IBuildElements();
     if (!fLocalizedElements.exists(name))
         return false; // doesn't exist
 
+    IInvalidateTable();
     fLocalizedElements[name][languageName].FromXML(xmlData);
     return true;
 }
@@ -1116,9 +1201,11 @@ bool pfLocalizationDataMgr::SetElementXMLData(const ST::string & name, const ST:
 
 bool pfLocalizationDataMgr::SetElementPlainTextData(const ST::string & name, const ST::string & languageName, const ST::string & plainText)
 {
+    IBuildElements();
     if (!fLocalizedElements.exists(name))
         return false; // doesn't exist
 
+    IInvalidateTable();
     fLocalizedElements[name][languageName] = plainText;
     return true;
 }
@@ -1127,10 +1214,12 @@ bool pfLocalizationDataMgr::SetElementPlainTextData(const ST::string & name, con
 
 bool pfLocalizationDataMgr::AddLocalization(const ST::string & name, const ST::string & newLanguage)
 {
+    IBuildElements();
     if (!fLocalizedElements.exists(name))
         return false; // doesn't exist
 
     // copy the english over so it can be localized
+    IInvalidateTable();
     fLocalizedElements[name][newLanguage] = fLocalizedElements[name]["English"];
     return true;
 }
@@ -1139,9 +1228,11 @@ bool pfLocalizationDataMgr::AddLocalization(const ST::string & name, const ST::s
 
 bool pfLocalizationDataMgr::AddElement(const ST::string & name)
 {
+    IBuildElements();
     if (fLocalizedElements.exists(name))
         return false; // already exists
 
+    IInvalidateTable();
     pfLocalizedString newElement;
     fLocalizedElements[name]["English"] = newElement;
     return true;
@@ -1151,12 +1242,14 @@ bool pfLocalizationDataMgr::AddElement(const ST::string & name)
 
 bool pfLocalizationDataMgr::DeleteLocalization(const ST::string & name, const ST::string & languageName)
 {
+    IBuildElements();
     if (!fLocalizedElements.exists(name))
         return false; // doesn't exist
 
     if (fLocalizedElements[name].find(languageName) == fLocalizedElements[name].end())
         return false; // doesn't exist
 
+    IInvalidateTable();
     fLocalizedElements[name].erase(languageName);
     return true;
 }
@@ -1165,10 +1258,12 @@ bool pfLocalizationDataMgr::DeleteLocalization(const ST::string & name, const ST
 
 bool pfLocalizationDataMgr::DeleteElement(const ST::string & name)
 {
+    IBuildElements();
     if (!fLocalizedElements.exists(name))
         return false; // doesn't exist
 
     // delete it!
+    IInvalidateTable();
     fLocalizedElements.erase(name);
     return true;
 }
@@ -1194,11 +1289,37 @@ void pfLocalizationDataMgr::WriteDatabaseToDisk(const plFileName & path)
 
 void pfLocalizationDataMgr::OutputTreeToLog()
 {
-    std::vector<ST::string> ages = GetAgeList();
-
     fLog->AddLine("\n");
     fLog->AddLine("Localization tree:\n");
 
+    if (fTableValid)
+    {
+        // the table is in tree order already, so don't build the whole tree just to print it
+        ST::string lastAge, lastSet;
+        for (uint32_t curEntry = 0; curEntry < fTable.GetNumEntries(); curEntry++)
+        {
+            std::vector<ST::string> tokens = fTable.GetKey(curEntry).tokenize(".");
+            if (tokens.size() != 3)
+                continue;
+
+            if (tokens[0] != lastAge)
+            {
+                fLog->AddLineF("\t{}", tokens[0]);
+                lastAge = tokens[0];
+                lastSet = "";
+            }
+            if (tokens[1] != lastSet)
+            {
+                fLog->AddLineF("\t\t{}", tokens[1]);
+                lastSet = tokens[1];
+            }
+            fLog->AddLineF("\t\t\t{}", tokens[2]);
+        }
+        return;
+    }
+
+    std::vector<ST::string> ages = GetAgeList();
+
     for (const auto& age : ages)
     {
         fLog->AddLineF("\t{}", age);
@@ -56,21 +56,20 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include <vector>
 
 #include "pfLocalizedString.h"
+#include "pfLocalizationTable.h"
 
 
 class plStatusLog;
 
 // Helper classes/structs that are only used in this main class
 class LocalizationDatabase;
-struct LocElementInfo;
-struct LocSetInfo;
-struct LocAgeInfo;
 
 class pfLocalizationDataMgr
 {
 private:
     static pfLocalizationDataMgr*   fInstance;
     static plStatusLog*             fLog;
+    static uint32_t                 fGeneration;
 
 protected:
     // This is a special case map class that will deconstruct the "Age.Set.Name" key into component parts
@@ -107,23 +106,37 @@ protected:
     pf3PartMap<localizedElement> fLocalizedElements;
 
     plFileName fDataPath;
+    plFileName fCacheFile;
+
+    // The compiled table is what GetElement() reads. fLocalizedElements is only filled in from it
+    // when something needs the full tree (the editor functions), and once edited, the table is stale.
+    pfLocalizationTable fTable;
+    bool fTableValid;
+    bool fElementsBuilt;
+
+    // The translation of each table entry in fCurrentLanguage (falling back to English)
+    std::vector<pfLocalizedString> fCurrentElements;
+    int fCurrentLanguage; // plLocalization::Language
 
     localizedElement ICreateLocalizedElement(); // ease of use function that creates a basic localized element object
 
     ST::string IGetCurrentLanguageName(); // get the name of the current language
     std::vector<ST::string> IGetAllLanguageNames();
 
-    void IConvertElement(LocElementInfo *elementInfo, const ST::string & curPath);
-    void IConvertSet(LocSetInfo *setInfo, const ST::string & curPath);
-    void IConvertAge(LocAgeInfo *ageInfo, const ST::string & curPath);
+    void IParseData(const std::vector<plFileName> & locFiles); // parse the XML files into fTable
+    void IBuildElements(); // fill in fLocalizedElements from fTable
+    void IBuildCurrentElements(); // fill in fCurrentElements for the current language
+    void IInvalidateTable(); // the editor changed fLocalizedElements, so the table no longer matches it
 
     void IWriteText(const plFileName & filename, const ST::string & ageName, const ST::string & languageName); // Write localization text to the specified file
 
-    pfLocalizationDataMgr(const plFileName & path);
+    pfLocalizationDataMgr(const plFileName & path, const plFileName & cacheFile);
 public:
     virtual ~pfLocalizationDataMgr();
 
-    static void Initialize(const plFileName & path);
+    // If cacheFile is valid, the compiled table is loaded from it when it is newer than the XML,
+    // and written back to it when it isn't
+    static void Initialize(const plFileName & path, const plFileName & cacheFile = {});
     static void Shutdown();
     static pfLocalizationDataMgr &Instance() {return *fInstance;}
     static bool InstanceValid() { return fInstance != nullptr; }
@@ -132,18 +145,28 @@ public:
     void SetupData();
 
     pfLocalizedString GetElement(const ST::string & name);
+
+    // Indexed lookups for the current language. An index from FindElement() stays good for as long
+    // as GetGeneration() returns the same value; it changes whenever the data or language changes.
+    uint32_t GetGeneration();
+    uint32_t FindElement(const ST::string & name);
+    pfLocalizedString & GetElement(uint32_t index) { return fCurrentElements[index]; }
+
     pfLocalizedString GetSpecificElement(const ST::string & name, const ST::string & languageName);
 
     std::vector<ST::string> GetAgeList()
     {
+        IBuildElements();
         return fLocalizedElements.getAgeList();
     }
     std::vector<ST::string> GetSetList(const ST::string & ageName)
     {
+        IBuildElements();
         return fLocalizedElements.getSetList(ageName);
     }
     std::vector<ST::string> GetElementList(const ST::string & ageName, const ST::string & setName)
     {
+        IBuildElements();
         return fLocalizedElements.getNameList(ageName, setName);
     }
     std::vector<ST::string> GetLanguages(const ST::string & ageName, const ST::string & setName, const ST::string & elementName);
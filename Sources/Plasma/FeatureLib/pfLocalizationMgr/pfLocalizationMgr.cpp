@@ -73,13 +73,18 @@ pfLocalizationMgr::~pfLocalizationMgr()
 
 //// Initialize //////////////////////////////////////////////////////
 
-void pfLocalizationMgr::Initialize(const plFileName & dataPath)
+void pfLocalizationMgr::Initialize(const plFileName & dataPath, const plFileName & cacheFile)
 {
     if (fInstance)
         return;
 
     fInstance = new pfLocalizationMgr();
-    pfLocalizationDataMgr::Initialize(dataPath); // set up the data manager
+    pfLocalizationDataMgr::Initialize(dataPath, cacheFile); // set up the data manager
+}
+
+void pfLocalizationMgr::Initialize(const plFileName & dataPath)
+{
+    Initialize(dataPath, plFileName());
 }
 
 //// Shutdown ////////////////////////////////////////////////////////
@@ -105,3 +110,39 @@ ST::string pfLocalizationMgr::GetString(const ST::string & path)
     std::vector<ST::string> args; // blank args so that % signs are still handled correctly
     return pfLocalizationDataMgr::Instance().GetElement(path) % args;
 }
+
+//// InternKey ///////////////////////////////////////////////////////
+
+pfLocalizationMgr::Key pfLocalizationMgr::InternKey(const ST::string & path)
+{
+    pfLocalizationDataMgr& data = pfLocalizationDataMgr::Instance();
+
+    Key key(path);
+    key.fIndex = data.FindElement(path);
+    key.fGeneration = data.GetGeneration();
+    return key;
+}
+
+ST::string pfLocalizationMgr::GetString(const Key & key, const std::vector<ST::string> & args)
+{
+    pfLocalizationDataMgr& data = pfLocalizationDataMgr::Instance();
+
+    uint32_t generation = data.GetGeneration();
+    if (key.fGeneration != generation)
+    {
+        key.fIndex = data.FindElement(key.fPath);
+        key.fGeneration = generation;
+    }
+
+    // Anything the table doesn't have (or everything, while the editor has it out of date)
+    // goes the long way around
+    if (key.fIndex == pfLocalizationTable::kInvalidIndex)
+        return data.GetElement(key.fPath) % args;
+    return data.GetElement(key.fIndex) % args;
+}
+
+ST::string pfLocalizationMgr::GetString(const Key & key)
+{
+    std::vector<ST::string> args; // blank args so that % signs are still handled correctly
+    return GetString(key, args);
+}
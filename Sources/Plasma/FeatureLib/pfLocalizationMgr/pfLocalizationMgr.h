@@ -51,8 +51,10 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "HeadSpin.h"
 
+#include <string_theory/string>
+#include <vector>
+
 class plFileName;
-namespace ST { class string; }
 
 class pfLocalizationMgr
 {
@@ -61,8 +63,29 @@ private:
 protected:
     pfLocalizationMgr();
 public:
+    // A path that remembers where it was found, so looking it up again doesn't need to hash it.
+    // It is looked up afresh whenever the localization data or the current language changes.
+    class Key
+    {
+        friend class pfLocalizationMgr;
+
+        ST::string          fPath;
+        mutable uint32_t    fIndex;
+        mutable uint32_t    fGeneration;
+
+    public:
+        Key() : fIndex(), fGeneration() { }
+        explicit Key(ST::string path) : fPath(std::move(path)), fIndex(), fGeneration() { }
+
+        const ST::string& GetPath() const { return fPath; }
+        bool empty() const { return fPath.empty(); }
+    };
+
     virtual ~pfLocalizationMgr();
 
+    // cacheFile, if given, holds a compiled copy of the data that is used instead of parsing the XML
+    // when it is up to date
+    static void Initialize(const plFileName & dataPath, const plFileName & cacheFile);
     static void Initialize(const plFileName & dataPath);
     static void Shutdown();
     static pfLocalizationMgr &Instance() {return *fInstance;}
@@ -75,6 +98,10 @@ public:
     // the results you expect if you do mix them. Path is specified by Age.Set.Name
     ST::string GetString(const ST::string & path, const std::vector<ST::string> & args);
     ST::string GetString(const ST::string & path);
+
+    Key InternKey(const ST::string & path);
+    ST::string GetString(const Key & key, const std::vector<ST::string> & args);
+    ST::string GetString(const Key & key);
 };
 
 #endif
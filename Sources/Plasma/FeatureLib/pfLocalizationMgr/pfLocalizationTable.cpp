@@ -0,0 +1,448 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+//////////////////////////////////////////////////////////////////////
+//
+// pfLocalizationTable - the compiled form of the localization data
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "HeadSpin.h"
+#include "hsStream.h"
+
+#include "pfLocalizationTable.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+static const uint32_t kCacheMagic   = 0x434C4C50;   // 'PLLC'
+static const uint32_t kCacheVersion = 1;
+
+// Average number of keys sharing a hash bucket.  Bigger buckets make the
+// index smaller but take longer to place.
+static const size_t kKeysPerBucket = 4;
+static const uint32_t kMaxSeed = 0x100000;
+
+//////////////////////////////////////////////////////////////////////
+//// Hashing /////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////
+
+// FNV-1a over the key.  This is the only pass over the key's characters;
+// the bucket and the slot are both mixed out of this one value.
+static inline uint64_t IHashKey(const char * str, size_t len)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash ^= (uint8_t)str[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static inline uint64_t IMixHash(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static inline size_t IBucket(uint64_t hash, size_t numBuckets)
+{
+    return (size_t)(IMixHash(hash) >> 32) % numBuckets;
+}
+
+static inline size_t ISlot(uint64_t hash, uint32_t seed, size_t numSlots)
+{
+    return (size_t)(uint32_t)IMixHash(hash ^ (seed * 0x9E3779B97F4A7C15ULL)) % numSlots;
+}
+
+//////////////////////////////////////////////////////////////////////
+//// Building ////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////
+
+void pfLocalizationTable::Clear()
+{
+    fPool.clear();
+    fEntries.clear();
+    fTranslations.clear();
+    fDisplacements.clear();
+    fSlots.clear();
+    fLanguages.clear();
+}
+
+pfLocalizationTable::StringRef pfLocalizationTable::IAddString(const ST::string & str)
+{
+    StringRef ref;
+    ref.fOffset = (uint32_t)fPool.size();
+    ref.fLength = (uint32_t)str.size();
+    fPool.insert(fPool.end(), str.c_str(), str.c_str() + str.size());
+    return ref;
+}
+
+pfLocalizationTable::StringRef pfLocalizationTable::IAddLanguage(const ST::string & language)
+{
+    // There are only a handful of languages, so share one copy of each name
+    for (const StringRef & ref : fLanguages)
+    {
+        if (IStringEquals(ref, language.c_str(), language.size()))
+            return ref;
+    }
+
+    fLanguages.emplace_back(IAddString(language));
+    return fLanguages.back();
+}
+
+bool pfLocalizationTable::IStringEquals(const StringRef & ref, const char * str, size_t len) const
+{
+    return ref.fLength == len && memcmp(fPool.data() + ref.fOffset, str, len) == 0;
+}
+
+void pfLocalizationTable::AddEntry(const ST::string & key, const std::map<ST::string, ST::string> & translations)
+{
+    Entry entry;
+    entry.fKey = IAddString(key);
+    entry.fFirstTranslation = (uint32_t)fTranslations.size();
+    entry.fNumTranslations = (uint32_t)translations.size();
+
+    for (const auto& curTranslation : translations)
+    {
+        Translation trans;
+        trans.fLanguage = IAddLanguage(curTranslation.first);
+        trans.fText = IAddString(curTranslation.second);
+        fTranslations.push_back(trans);
+    }
+
+    fEntries.push_back(entry);
+}
+
+//// BuildIndex //////////////////////////////////////////////////////
+// Hash and displace: keys are split into small buckets, then, biggest
+// bucket first, each bucket searches for a seed that lands all of its
+// keys in free slots.  Every slot ends up holding exactly one key.
+
+bool pfLocalizationTable::BuildIndex()
+{
+    fLanguages.clear();
+    fDisplacements.clear();
+    fSlots.clear();
+
+    size_t numKeys = fEntries.size();
+    if (numKeys == 0)
+        return true;
+
+    size_t numBuckets = (numKeys + kKeysPerBucket - 1) / kKeysPerBucket;
+    std::vector<uint64_t> hashes(numKeys);
+    std::vector<std::vector<uint32_t>> buckets(numBuckets);
+    for (size_t i = 0; i < numKeys; ++i)
+    {
+        const StringRef& key = fEntries[i].fKey;
+        hashes[i] = IHashKey(fPool.data() + key.fOffset, key.fLength);
+        buckets[IBucket(hashes[i], numBuckets)].push_back((uint32_t)i);
+    }
+
+    std::vector<uint32_t> order(numBuckets);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    fDisplacements.assign(numBuckets, 0);
+    fSlots.assign(numKeys, kInvalidIndex);
+
+    std::vector<size_t> bucketSlots;
+    for (uint32_t bucket : order)
+    {
+        const std::vector<uint32_t>& keys = buckets[bucket];
+        if (keys.empty())
+            break;
+
+        uint32_t seed = 1;
+        for (; seed < kMaxSeed; ++seed)
+        {
+            bucketSlots.clear();
+            for (uint32_t key : keys)
+            {
+                size_t slot = ISlot(hashes[key], seed, numKeys);
+                if (fSlots[slot] != kInvalidIndex ||
+                    std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end())
+                    break;
+                bucketSlots.push_back(slot);
+            }
+            if (bucketSlots.size() == keys.size())
+                break;
+        }
+
+        if (seed == kMaxSeed)
+        {
+            // Only happens with duplicate keys; leave the table unindexed
+            fDisplacements.clear();
+            fSlots.clear();
+            return false;
+        }
+
+        fDisplacements[bucket] = seed;
+        for (size_t i = 0; i < keys.size(); ++i)
+            fSlots[bucketSlots[i]] = keys[i];
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+//// Lookups /////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////
+
+uint32_t pfLocalizationTable::Find(const ST::string & key) const
+{
+    if (fSlots.empty())
+        return kInvalidIndex;
+
+    uint64_t hash = IHashKey(key.c_str(), key.size());
+    uint32_t seed = fDisplacements[IBucket(hash, fDisplacements.size())];
+    uint32_t index = fSlots[ISlot(hash, seed, fSlots.size())];
+
+    // Keys that aren't in the table still land on some slot
+    if (IStringEquals(fEntries[index].fKey, key.c_str(), key.size()))
+        return index;
+    return kInvalidIndex;
+}
+
+ST::string pfLocalizationTable::GetLanguage(uint32_t index, uint32_t trans) const
+{
+    return IGetString(fTranslations[fEntries[index].fFirstTranslation + trans].fLanguage);
+}
+
+ST::string pfLocalizationTable::GetText(uint32_t index, uint32_t trans) const
+{
+    return IGetString(fTranslations[fEntries[index].fFirstTranslation + trans].fText);
+}
+
+uint32_t pfLocalizationTable::FindTranslation(uint32_t index, const ST::string & language) const
+{
+    const Entry& entry = fEntries[index];
+    for (uint32_t i = 0; i < entry.fNumTranslations; ++i)
+    {
+        if (IStringEquals(fTranslations[entry.fFirstTranslation + i].fLanguage, language.c_str(), language.size()))
+            return i;
+    }
+    return kInvalidIndex;
+}
+
+//////////////////////////////////////////////////////////////////////
+//// Cache File //////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////
+//
+// Cache layout: magic, version, the name, size and modify time of every
+// source file, the string pool, then the entry, translation, bucket and
+// slot arrays exactly as they are held in memory.
+//
+
+std::vector<pfLocalizationTable::SourceFile> pfLocalizationTable::ScanSources(const std::vector<plFileName> & files)
+{
+    std::vector<SourceFile> sources;
+    sources.reserve(files.size());
+    for (const plFileName& file : files)
+    {
+        plFileInfo info(file);
+        sources.push_back({ file, (uint64_t)info.FileSize(), info.ModifyTime() });
+    }
+    return sources;
+}
+
+static inline uint64_t IReadLE64(hsStream & s)
+{
+    uint64_t lo = s.ReadLE32();
+    uint64_t hi = s.ReadLE32();
+    return lo | (hi << 32);
+}
+
+static inline void IWriteLE64(hsStream & s, uint64_t value)
+{
+    s.WriteLE32((uint32_t)value);
+    s.WriteLE32((uint32_t)(value >> 32));
+}
+
+template <typename T>
+static void IReadArray(hsStream & s, std::vector<T> & values)
+{
+    static_assert(sizeof(T) % sizeof(uint32_t) == 0, "cache arrays are made of uint32_t");
+
+    uint32_t count = s.ReadLE32();
+    if (count > s.GetSizeLeft() / sizeof(T))
+        throw std::runtime_error("array runs past the end of the cache");
+    values.resize(count);
+    s.ReadLE32(count * (sizeof(T) / sizeof(uint32_t)), reinterpret_cast<uint32_t*>(values.data()));
+}
+
+template <typename T>
+static void IWriteArray(hsStream & s, const std::vector<T> & values)
+{
+    s.WriteLE32((uint32_t)values.size());
+    s.WriteLE32(values.size() * (sizeof(T) / sizeof(uint32_t)), reinterpret_cast<const uint32_t*>(values.data()));
+}
+
+bool pfLocalizationTable::IValidate() const
+{
+    auto refValid = [this](const StringRef& ref) {
+        return ref.fOffset <= fPool.size() && ref.fLength <= fPool.size() - ref.fOffset;
+    };
+
+    for (const Entry& entry : fEntries)
+    {
+        if (!refValid(entry.fKey) || entry.fFirstTranslation > fTranslations.size() ||
+            entry.fNumTranslations > fTranslations.size() - entry.fFirstTranslation)
+            return false;
+    }
+    for (const Translation& trans : fTranslations)
+    {
+        if (!refValid(trans.fLanguage) || !refValid(trans.fText))
+            return false;
+    }
+
+    if (fSlots.size() != fEntries.size() || fDisplacements.empty() != fEntries.empty())
+        return false;
+    for (uint32_t slot : fSlots)
+    {
+        if (slot >= fEntries.size())
+            return false;
+    }
+    return true;
+}
+
+bool pfLocalizationTable::Read(const plFileName & cacheFile, const std::vector<SourceFile> & sources)
+{
+    Clear();
+
+    hsUNIXStream file;
+    if (!file.Open(cacheFile, "rb"))
+        return false;
+
+    // pull the whole thing in at once and parse it from memory
+    std::vector<uint8_t> buf(file.GetEOF());
+    bool ok = file.Read(buf.size(), buf.data()) == buf.size();
+    file.Close();
+    if (!ok)
+        return false;
+
+    hsReadOnlyStream s(buf.size(), buf.data());
+    try
+    {
+        if (s.ReadLE32() != kCacheMagic || s.ReadLE32() != kCacheVersion)
+            return false;
+
+        uint32_t numFiles = s.ReadLE32();
+        if (numFiles != sources.size())
+            return false;
+
+        for (const SourceFile& src : sources)
+        {
+            ST::string name = s.ReadSafeString();
+            uint64_t size = IReadLE64(s);
+            uint64_t modifyTime = IReadLE64(s);
+            if (name.compare_i(src.fName.AsString()) != 0 || size != src.fSize || modifyTime != src.fModifyTime)
+                return false;
+        }
+
+        uint32_t poolSize = s.ReadLE32();
+        if (poolSize > s.GetSizeLeft())
+            return false;
+        fPool.resize(poolSize);
+        s.Read(poolSize, fPool.data());
+
+        IReadArray(s, fEntries);
+        IReadArray(s, fTranslations);
+        IReadArray(s, fDisplacements);
+        IReadArray(s, fSlots);
+    }
+    catch (const std::exception&)
+    {
+        Clear();
+        return false;
+    }
+
+    if (!IValidate())
+    {
+        Clear();
+        return false;
+    }
+    return true;
+}
+
+bool pfLocalizationTable::Write(const plFileName & cacheFile, const std::vector<SourceFile> & sources) const
+{
+    if (!IsIndexed())
+        return false;
+
+    hsRAMStream s;
+    s.WriteLE32(kCacheMagic);
+    s.WriteLE32(kCacheVersion);
+
+    s.WriteLE32((uint32_t)sources.size());
+    for (const SourceFile& src : sources)
+    {
+        s.WriteSafeString(src.fName.AsString());
+        IWriteLE64(s, src.fSize);
+        IWriteLE64(s, src.fModifyTime);
+    }
+
+    s.WriteLE32((uint32_t)fPool.size());
+    s.Write(fPool.size(), fPool.data());
+
+    IWriteArray(s, fEntries);
+    IWriteArray(s, fTranslations);
+    IWriteArray(s, fDisplacements);
+    IWriteArray(s, fSlots);
+
+    hsUNIXStream file;
+    if (!file.Open(cacheFile, "wb"))
+        return false;
+
+    std::vector<uint8_t> buf(s.GetEOF());
+    s.CopyToMem(buf.data());
+    file.Write(buf.size(), buf.data());
+    file.Close();
+    return true;
+}
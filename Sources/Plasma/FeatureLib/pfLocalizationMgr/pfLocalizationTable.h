@@ -0,0 +1,137 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+//////////////////////////////////////////////////////////////////////
+//
+// pfLocalizationTable - the compiled form of the localization data.
+//                       Every key and translation lives in a single
+//                       string pool, and keys are found through a
+//                       minimal perfect hash of the full "Age.Set.Name"
+//                       path, so a lookup is two hashes and one compare.
+//
+//////////////////////////////////////////////////////////////////////
+
+#ifndef _pfLocalizationTable_h
+#define _pfLocalizationTable_h
+
+#include "HeadSpin.h"
+#include "plFileSystem.h"
+
+#include <map>
+#include <vector>
+
+class pfLocalizationTable
+{
+public:
+    enum { kInvalidIndex = 0xFFFFFFFF };
+
+    // What the cache was built from; it is stale if any of these change
+    struct SourceFile
+    {
+        plFileName  fName;
+        uint64_t    fSize;
+        uint64_t    fModifyTime;
+    };
+
+protected:
+    struct StringRef
+    {
+        uint32_t fOffset;
+        uint32_t fLength;
+    };
+
+    struct Entry
+    {
+        StringRef   fKey;
+        uint32_t    fFirstTranslation;
+        uint32_t    fNumTranslations;
+    };
+
+    struct Translation
+    {
+        StringRef   fLanguage;
+        StringRef   fText;      // XML form, as pfLocalizedString::FromXML expects
+    };
+
+    std::vector<char>           fPool;
+    std::vector<Entry>          fEntries;       // in the order they were added
+    std::vector<Translation>    fTranslations;
+    std::vector<uint32_t>       fDisplacements; // hash seed for each bucket
+    std::vector<uint32_t>       fSlots;         // entry index for each hash slot
+
+    std::vector<StringRef>      fLanguages;     // only used while adding entries
+
+    StringRef IAddString(const ST::string & str);
+    StringRef IAddLanguage(const ST::string & language);
+    ST::string IGetString(const StringRef & ref) const { return ST::string::from_utf8(fPool.data() + ref.fOffset, ref.fLength, ST::substitute_invalid); }
+    bool IStringEquals(const StringRef & ref, const char * str, size_t len) const;
+    bool IValidate() const;
+
+public:
+    void Clear();
+
+    // Entries must all be added before calling BuildIndex(). The key is the full Age.Set.Name path,
+    // translations map language names to the XML text of the string.
+    void AddEntry(const ST::string & key, const std::map<ST::string, ST::string> & translations);
+    bool BuildIndex();
+
+    bool IsIndexed() const { return !fSlots.empty() || fEntries.empty(); }
+    uint32_t GetNumEntries() const { return (uint32_t)fEntries.size(); }
+
+    // Returns the entry index for key, or kInvalidIndex if it isn't in the table
+    uint32_t Find(const ST::string & key) const;
+
+    ST::string GetKey(uint32_t index) const { return IGetString(fEntries[index].fKey); }
+    uint32_t GetNumTranslations(uint32_t index) const { return fEntries[index].fNumTranslations; }
+    ST::string GetLanguage(uint32_t index, uint32_t trans) const;
+    ST::string GetText(uint32_t index, uint32_t trans) const;
+
+    // Returns the translation index for language in the entry, or kInvalidIndex
+    uint32_t FindTranslation(uint32_t index, const ST::string & language) const;
+
+    static std::vector<SourceFile> ScanSources(const std::vector<plFileName> & files);
+
+    // The cache is only read if it was built from exactly these sources
+    bool Read(const plFileName & cacheFile, const std::vector<SourceFile> & sources);
+    bool Write(const plFileName & cacheFile, const std::vector<SourceFile> & sources) const;
+};
+
+#endif
@@ -120,7 +120,7 @@ public:
 
         vpx_codec_iter_t  iter = nullptr;
         // ASSUMPTION: only one image per frame
-        // if this proves false, move decoder function into IProcessVideoFrame
+        // if this proves false, move decoder function into IDecodeAhead
         return vpx_codec_get_frame(&codec, &iter);
     }
 #else
@@ -155,13 +155,7 @@ public:
             int64_t time = block->GetTime(fCurrentBlock->GetCluster()) - fTrack->GetCodecDelay();
             if (time <= movieTimeNs) {
                 // We want to play this block, add it to the frames buffer
-                frames.reserve(frames.size() + block->GetFrameCount());
-                for (int32_t i = 0; i < block->GetFrameCount(); i++) {
-                    const mkvparser::Block::Frame data = block->GetFrame(i);
-                    uint8_t* buf = new uint8_t[data.len];
-                    data.Read(reader, buf);
-                    frames.push_back(std::make_tuple(std::unique_ptr<uint8_t>(buf), static_cast<int32_t>(data.len)));
-                }
+                IReadBlock(reader, block, frames);
                 fStatus = fTrack->GetNext(fCurrentBlock, fCurrentBlock);
             } else {
                 // We've got all frames that have to play... come back for more later!
@@ -172,16 +166,74 @@ public:
 
         return false; // No more blocks... We're done!
     }
+
+    /** Reads the next block, whatever its time, for decoding ahead of the movie. */
+    bool GetNextFrames(mkvparser::MkvReader* reader, std::vector<blkbuf_t>& frames, int64_t& timeNs)
+    {
+#ifdef USE_WEBM
+        if (!fCurrentBlock)
+            fStatus = fTrack->GetFirst(fCurrentBlock);
+
+        if (fCurrentBlock && fStatus == 0) {
+            const mkvparser::Block* block = fCurrentBlock->GetBlock();
+            timeNs = block->GetTime(fCurrentBlock->GetCluster()) - fTrack->GetCodecDelay();
+            IReadBlock(reader, block, frames);
+            fStatus = fTrack->GetNext(fCurrentBlock, fCurrentBlock);
+            return true;
+        }
+#endif
+
+        return false;
+    }
+
+protected:
+#ifdef USE_WEBM
+    void IReadBlock(mkvparser::MkvReader* reader, const mkvparser::Block* block, std::vector<blkbuf_t>& frames)
+    {
+        frames.reserve(frames.size() + block->GetFrameCount());
+        for (int32_t i = 0; i < block->GetFrameCount(); i++) {
+            const mkvparser::Block::Frame data = block->GetFrame(i);
+            uint8_t* buf = new uint8_t[data.len];
+            data.Read(reader, buf);
+            frames.push_back(std::make_tuple(std::unique_ptr<uint8_t>(buf), static_cast<int32_t>(data.len)));
+        }
+    }
+#endif
 };
 
 // =====================================================
 
+#ifdef USE_WEBM
+static bool IConvertVideoFrame(vpx_image_t* img, std::vector<uint8_t>& image)
+{
+    // According to VideoLAN[1], I420 is the most common image format in videos. I am inclined to believe this as our
+    // attemps to convert the common Uru videos use I420 image data. So, as a shortcut, we will only implement that format.
+    // If for some reason we need other formats, please, be my guest!
+    // [1] = http://wiki.videolan.org/YUV#YUV_4:2:0_.28I420.2FJ420.2FYV12.29
+    switch (img->fmt) {
+    case VPX_IMG_FMT_I420:
+        image.resize(size_t(img->d_w) * img->d_h * 4);
+        plPlanarImage::Yuv420ToRgba(img->d_w, img->d_h, img->stride, img->planes, image.data());
+        return true;
+
+    DEFAULT_FATAL("image format");
+    }
+    return false;
+}
+#endif
+
+// =====================================================
+
 plMoviePlayer::plMoviePlayer()
     : fPlate(),
       fTexture(),
 #ifdef USE_WEBM
       fReader(),
 #endif
+      fOpus(),
+      fDecodeDone(),
+      fStopDecode(),
+      fAudioDone(),
       fMovieTime(),
       fLastFrameTime(),
       fPosition(),
@@ -193,10 +245,15 @@ plMoviePlayer::plMoviePlayer()
 
 plMoviePlayer::~plMoviePlayer()
 {
+    // The decoder thread is still using the reader and the codec
+    IStopDecode();
+
     if (fPlate)
         // The plPlate owns the Mipmap Texture, so it destroys it for us
         plPlateManager::Instance().DestroyPlate(fPlate);
 #ifdef USE_WEBM
+    if (fOpus)
+        opus_decoder_destroy(fOpus);
     if (fReader) {
         fReader->Close();
         delete fReader;
@@ -264,7 +321,7 @@ bool plMoviePlayer::ILoadAudio()
     header.fNumSamplesPerSec = 48000; // OPUS specs say we shall always decode at 48kHz
     header.fBlockAlign = header.fNumChannels * header.fBitsPerSample / 8;
     header.fAvgBytesPerSec = header.fNumSamplesPerSec * header.fBlockAlign;
-    fAudioSound.reset(new plWin32VideoSound(header));
+    fAudioSound.reset(new plWin32VideoSound(header, true));
 
     // Initialize Opus
     if (strncmp(audio->GetCodecId(), WEBM_CODECID_OPUS, std::size(WEBM_CODECID_OPUS)) != 0) {
@@ -272,38 +329,55 @@ bool plMoviePlayer::ILoadAudio()
         return false;
     }
     int error;
-    OpusDecoder* opus = opus_decoder_create(48000, (int)audio->GetChannels(), &error);
-    if (error != OPUS_OK)
+    fOpus = opus_decoder_create(48000, (int)audio->GetChannels(), &error);
+    if (error != OPUS_OK) {
         hsAssert(false, "Error occured initalizing opus");
-
-    // Decode audio track
-    std::vector<blkbuf_t> frames;
-    fAudioTrack->GetFrames(fReader, fSegment->GetDuration(), frames);
-    static const int maxFrameSize = 5760; // for max packet duration at 48kHz
-    std::vector<int16_t> decoded;
-    decoded.reserve(frames.size() * (size_t)audio->GetChannels() * maxFrameSize);
-
-    int16_t* frameData = new int16_t[maxFrameSize * (size_t)audio->GetChannels()];
-    for (const auto& frame : frames) {
-        const std::unique_ptr<uint8_t>& buf = std::get<0>(frame);
-        int32_t size = std::get<1>(frame);
-
-        int samples = opus_decode(opus, buf.get(), size, frameData, maxFrameSize, 0);
-        if (samples < 0)
-            hsAssert(false, "opus error");
-        for (size_t i = 0; i < samples * audio->GetChannels(); i++)
-            decoded.push_back(frameData[i]);
+        fOpus = nullptr;
+        return false;
     }
-    delete[] frameData;
 
-    fAudioSound->FillSoundBuffer(reinterpret_cast<uint8_t*>(decoded.data()), decoded.size() * sizeof(int16_t));
-    opus_decoder_destroy(opus);
+    // The track is decoded as the movie plays, so only prime the sound here
+    IStreamAudio();
     return true;
 #else
     return false;
 #endif
 }
 
+void plMoviePlayer::IStreamAudio()
+{
+#ifdef USE_WEBM
+    if (!fAudioDone) {
+        // Decode up to a little ahead of the picture
+        std::vector<blkbuf_t> frames;
+        {
+            std::lock_guard<std::mutex> lock(fReaderLock);
+            fAudioDone = !fAudioTrack->GetFrames(fReader, fMovieTime * 1000000 + kAudioAheadNs, frames);
+        }
+
+        static const int maxFrameSize = 5760; // for max packet duration at 48kHz
+        const int channels = static_cast<int>(static_cast<const mkvparser::AudioTrack*>(fAudioTrack->GetTrack())->GetChannels());
+        for (const auto& frame : frames) {
+            const std::unique_ptr<uint8_t>& buf = std::get<0>(frame);
+            int32_t size = std::get<1>(frame);
+
+            size_t offset = fAudioPcm.size();
+            fAudioPcm.resize(offset + maxFrameSize * channels);
+            int samples = opus_decode(fOpus, buf.get(), size, fAudioPcm.data() + offset, maxFrameSize, 0);
+            if (samples < 0) {
+                hsAssert(false, "opus error");
+                samples = 0;
+            }
+            fAudioPcm.resize(offset + samples * channels);
+        }
+    }
+
+    // Whatever doesn't fit in the sound's buffers yet waits for the next frame
+    size_t queued = fAudioSound->QueueSoundData(fAudioPcm.data(), fAudioPcm.size() * sizeof(int16_t), fAudioDone);
+    fAudioPcm.erase(fAudioPcm.begin(), fAudioPcm.begin() + queued / sizeof(int16_t));
+#endif
+}
+
 bool plMoviePlayer::ICheckLanguage(const mkvparser::Track* track)
 {
 #ifdef USE_WEBM
@@ -314,39 +388,76 @@ bool plMoviePlayer::ICheckLanguage(const mkvparser::Track* track)
     return false;
 }
 
-void plMoviePlayer::IProcessVideoFrame(const std::vector<blkbuf_t>& frames)
+void plMoviePlayer::IDecodeAhead()
 {
 #ifdef USE_WEBM
-    vpx_image_t* img = nullptr;
-
-    // We have to decode all the frames, but we only want to display the most recent one to the user.
-    for (const auto& frame : frames) {
-        const std::unique_ptr<uint8_t>& buf = std::get<0>(frame);
-        uint32_t size = static_cast<uint32_t>(std::get<1>(frame));
-        img = fVpx->Decode(buf.get(), size);
-    }
+    for (;;) {
+        std::vector<uint8_t> image;
+        {
+            std::unique_lock<std::mutex> lock(fFrameLock);
+            fFrameCond.wait(lock, [this] { return fStopDecode || fFrames.size() < kMaxFramesAhead; });
+            if (fStopDecode)
+                return;
+            if (!fFreeImages.empty()) {
+                image = std::move(fFreeImages.back());
+                fFreeImages.pop_back();
+            }
+        }
 
-    if (img) {
-        // According to VideoLAN[1], I420 is the most common image format in videos. I am inclined to believe this as our
-        // attemps to convert the common Uru videos use I420 image data. So, as a shortcut, we will only implement that format.
-        // If for some reason we need other formats, please, be my guest!
-        // [1] = http://wiki.videolan.org/YUV#YUV_4:2:0_.28I420.2FJ420.2FYV12.29
-        switch (img->fmt) {
-        case VPX_IMG_FMT_I420:
-            plPlanarImage::Yuv420ToRgba(img->d_w, img->d_h, img->stride, img->planes, reinterpret_cast<uint8_t*>(fTexture->GetImage()));
+        std::vector<blkbuf_t> frames;
+        int64_t frameTime;
+        bool haveBlock;
+        {
+            std::lock_guard<std::mutex> lock(fReaderLock);
+            haveBlock = fVideoTrack->GetNextFrames(fReader, frames, frameTime);
+        }
+        if (!haveBlock)
             break;
 
-        DEFAULT_FATAL("image format");
+        // We have to decode all the frames, but only the last one makes it to the screen.
+        vpx_image_t* img = nullptr;
+        for (const auto& frame : frames) {
+            const std::unique_ptr<uint8_t>& buf = std::get<0>(frame);
+            uint32_t size = static_cast<uint32_t>(std::get<1>(frame));
+            img = fVpx->Decode(buf.get(), size);
         }
 
-        // Flush new data to the device
-        if (fTexture->GetDeviceRef())
-            fTexture->GetDeviceRef()->SetDirty(true);
-        fPlate->SetVisible(true);
+        std::lock_guard<std::mutex> lock(fFrameLock);
+        if (img && IConvertVideoFrame(img, image))
+            fFrames.push_back({ frameTime, std::move(image) });
+        else
+            fFreeImages.push_back(std::move(image));
     }
+
+    std::lock_guard<std::mutex> lock(fFrameLock);
+    fDecodeDone = true;
 #endif
 }
 
+void plMoviePlayer::IStopDecode()
+{
+    if (!fDecodeThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(fFrameLock);
+        fStopDecode = true;
+    }
+    fFrameCond.notify_one();
+    fDecodeThread.join();
+}
+
+void plMoviePlayer::IProcessVideoFrame(const std::vector<uint8_t>& image)
+{
+    size_t size = std::min(image.size(), size_t(fTexture->GetWidth()) * fTexture->GetHeight() * 4);
+    memcpy(fTexture->GetImage(), image.data(), size);
+
+    // Flush new data to the device
+    if (fTexture->GetDeviceRef())
+        fTexture->GetDeviceRef()->SetDirty(true);
+    fPlate->SetVisible(true);
+}
+
 bool plMoviePlayer::Start()
 {
     if (fPlaying)
@@ -368,10 +479,12 @@ bool plMoviePlayer::Start()
     else
         return false;
 
-    // Decode the audio track and load it into a sound buffer
+    // Set up the audio decoder and queue the first second or so of sound
     if (!ILoadAudio())
         return false;
 
+    fDecodeThread = std::thread(&plMoviePlayer::IDecodeAhead, this);
+
     fLastFrameTime = static_cast<int64_t>(hsTimer::GetMilliSeconds());
     fAudioSound->Play();
     fPlaying = true;
@@ -414,8 +527,22 @@ bool plMoviePlayer::NextFrame()
     // Get our current timecode
     fMovieTime += frameTimeDelta;
 
-    std::vector<blkbuf_t> video;
-    if (!fVideoTrack || !fVideoTrack->GetFrames(fReader, fMovieTime * 1000000, video)) {
+    // Take the most recent picture that's due, and hand any we skipped back to the decoder
+    std::vector<uint8_t> image;
+    bool finished;
+    {
+        std::lock_guard<std::mutex> lock(fFrameLock);
+        while (!fFrames.empty() && fFrames.front().fTime <= fMovieTime * 1000000) {
+            if (!image.empty())
+                fFreeImages.push_back(std::move(image));
+            image = std::move(fFrames.front().fImage);
+            fFrames.pop_front();
+        }
+        finished = fDecodeDone && fFrames.empty();
+    }
+    fFrameCond.notify_one();
+
+    if (image.empty() && finished) {
         Stop();
         return false;
     }
@@ -428,7 +555,13 @@ bool plMoviePlayer::NextFrame()
     }
 
     // Show our mess
-    IProcessVideoFrame(video);
+    if (!image.empty()) {
+        IProcessVideoFrame(image);
+
+        std::lock_guard<std::mutex> lock(fFrameLock);
+        fFreeImages.push_back(std::move(image));
+    }
+    IStreamAudio();
     fAudioSound->RefreshVolume();
 
     return true;
@@ -455,6 +588,8 @@ bool plMoviePlayer::Pause(bool on)
 
 bool plMoviePlayer::Stop()
 {
+    IStopDecode();
+
     fPlaying = false;
     if (fAudioSound)
         fAudioSound->Stop();
@@ -49,11 +49,16 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "hsPoint2.h"
 #include "hsRefCnt.h"
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <tuple>
 #include <vector>
 
 class plMessage;
+struct OpusDecoder;
 
 namespace mkvparser
 {
@@ -78,6 +83,27 @@ protected:
     std::unique_ptr<class TrackMgr> fAudioTrack, fVideoTrack; // TODO: vector of tracks?
     std::unique_ptr<class plWin32VideoSound> fAudioSound;
     std::unique_ptr<class VPX> fVpx;
+    OpusDecoder* fOpus;
+
+    // Video is decoded and converted on a worker thread, a few frames ahead of
+    // the picture. Audio is decoded as it's needed and streamed to the sound.
+    struct VideoFrame
+    {
+        int64_t fTime; // in ns
+        std::vector<uint8_t> fImage;
+    };
+    enum { kMaxFramesAhead = 8 };
+    static constexpr int64_t kAudioAheadNs = 1000000000;
+
+    std::thread fDecodeThread;
+    std::mutex fReaderLock; // the reader and segment aren't thread safe
+    std::mutex fFrameLock;
+    std::condition_variable fFrameCond;
+    std::deque<VideoFrame> fFrames;
+    std::vector<std::vector<uint8_t>> fFreeImages;
+    bool fDecodeDone, fStopDecode;
+    std::vector<int16_t> fAudioPcm;
+    bool fAudioDone;
 
     int64_t fMovieTime, fLastFrameTime; // in ms
     hsPoint2 fPosition, fScale;
@@ -90,8 +116,11 @@ protected:
 
     bool IOpenMovie();
     bool ILoadAudio();
+    void IStreamAudio();
     bool ICheckLanguage(const mkvparser::Track* track);
-    void IProcessVideoFrame(const std::vector<blkbuf_t>& frames);
+    void IDecodeAhead();
+    void IStopDecode();
+    void IProcessVideoFrame(const std::vector<uint8_t>& image);
 
 public:
     plMoviePlayer();
@@ -41,6 +41,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 *==LICENSE==*/
 
 #include "plPlanarImage.h"
+#include "plPlanarImage_Private.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -68,6 +69,22 @@ static uint8_t Clip(int32_t val) {
 #define BG UG * 128 + VG * 128
 #define BR UR * 128 + VR * 128
 
+void plPlanarImageKernels::yuv420_row_fpu(const uint8_t* y_src, const uint8_t* u_src, const uint8_t* v_src, uint8_t* dest, uint32_t w)
+{
+    for (uint32_t j = 0; j < w; ++j)
+    {
+        int32_t y = static_cast<int32_t>(y_src[j]);
+        int32_t u = static_cast<int32_t>(u_src[j/2]);
+        int32_t v = static_cast<int32_t>(v_src[j/2]);
+        int32_t y1 = (y - 16) * YG;
+
+        dest[j*4+0] = Clip(((u * UB + v * VB) - (BB) + y1) >> 6);
+        dest[j*4+1] = Clip(((u * UG + v * VG) - (BG) + y1) >> 6);
+        dest[j*4+2] = Clip(((u * UR + v * VR) - (BR) + y1) >> 6);
+        dest[j*4+3] = 0xff;
+    }
+}
+
 void plPlanarImage::Yuv420ToRgba(uint32_t w, uint32_t h, const int32_t* stride, uint8_t** planes, uint8_t* const dest)
 {
     const uint8_t* y_src = planes[0];
@@ -76,22 +93,22 @@ void plPlanarImage::Yuv420ToRgba(uint32_t w, uint32_t h, const int32_t* stride,
 
     for (uint32_t i = 0; i < h; ++i)
     {
-        for (uint32_t j = 0; j < w; ++j)
-        {
-            size_t y_idx = stride[0] * i + j;
-            size_t u_idx = stride[1] * (i/2) + (j/2);
-            size_t v_idx = stride[2] * (i/2) + (j/2);
-            size_t dest_idx = w * i + j;
-
-            int32_t y = static_cast<int32_t>(y_src[y_idx]);
-            int32_t u = static_cast<int32_t>(u_src[u_idx]);
-            int32_t v = static_cast<int32_t>(v_src[v_idx]);
-            int32_t y1 = (y - 16) * YG;
-
-            dest[dest_idx*4+0] = Clip(((u * UB + v * VB) - (BB) + y1) >> 6);
-            dest[dest_idx*4+1] = Clip(((u * UG + v * VG) - (BG) + y1) >> 6);
-            dest[dest_idx*4+2] = Clip(((u * UR + v * VR) - (BR) + y1) >> 6);
-            dest[dest_idx*4+3] = 0xff;
-        }
+        plPlanarImageKernels::yuv420_row.call(y_src + stride[0] * i,
+                                              u_src + stride[1] * (i/2),
+                                              v_src + stride[2] * (i/2),
+                                              dest + w * i * 4, w);
     }
 }
+
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<plPlanarImageKernels::yuv420_row_ptr> plPlanarImageKernels::yuv420_row {
+    &plPlanarImageKernels::yuv420_row_fpu,
+    nullptr,                                // SSE1
+    &plPlanarImageKernels::yuv420_row_sse2,
+    nullptr,                                // SSE3
+    nullptr,                                // SSSE3
+    nullptr,                                // SSE41
+    nullptr,                                // SSE42
+    nullptr,                                // AVX
+    &plPlanarImageKernels::yuv420_row_avx2
+};
@@ -0,0 +1,115 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plPlanarImage_Private.h"
+
+#ifdef HAVE_AVX2
+#   include <immintrin.h>
+
+// See plPlanarImage_SSE2.cpp for how the biases are folded in.
+static inline void IConvert(__m256i y, __m256i u, __m256i v, __m256i& b, __m256i& g, __m256i& r)
+{
+    __m256i y1 = _mm256_mullo_epi16(y, _mm256_set1_epi16(74));
+    b = _mm256_add_epi16(y1, _mm256_mullo_epi16(u, _mm256_set1_epi16(127)));
+    b = _mm256_srli_epi16(_mm256_add_epi16(b, _mm256_set1_epi16(32)), 6);
+    b = _mm256_sub_epi16(b, _mm256_set1_epi16(273));
+    g = _mm256_sub_epi16(y1, _mm256_mullo_epi16(u, _mm256_set1_epi16(25)));
+    g = _mm256_sub_epi16(g, _mm256_mullo_epi16(v, _mm256_set1_epi16(52)));
+    g = _mm256_srai_epi16(_mm256_add_epi16(g, _mm256_set1_epi16(8672)), 6);
+    r = _mm256_add_epi16(y1, _mm256_mullo_epi16(v, _mm256_set1_epi16(102)));
+    r = _mm256_srai_epi16(_mm256_sub_epi16(r, _mm256_set1_epi16(14240)), 6);
+}
+
+// packus works within each 128-bit half, so put the quadwords back in order
+static inline __m256i IPack(__m256i lo, __m256i hi)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+}
+#endif // HAVE_AVX2
+
+void plPlanarImageKernels::yuv420_row_avx2(const uint8_t* y_src, const uint8_t* u_src, const uint8_t* v_src, uint8_t* dest, uint32_t w)
+{
+#ifdef HAVE_AVX2
+    const __m256i alpha = _mm256_set1_epi8(-1);
+
+    // Thirty-two pixels (sixteen chroma samples) at a time
+    uint32_t j = 0;
+    for (; j + 32 <= w; j += 32)
+    {
+        __m128i y0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y_src + j));
+        __m128i y1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y_src + j + 16));
+        __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u_src + j/2));
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v_src + j/2));
+
+        __m256i b0, g0, r0, b1, g1, r1;
+        IConvert(_mm256_cvtepu8_epi16(y0),
+                 _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u, u)),
+                 _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v, v)), b0, g0, r0);
+        IConvert(_mm256_cvtepu8_epi16(y1),
+                 _mm256_cvtepu8_epi16(_mm_unpackhi_epi8(u, u)),
+                 _mm256_cvtepu8_epi16(_mm_unpackhi_epi8(v, v)), b1, g1, r1);
+        __m256i b = IPack(b0, b1);
+        __m256i g = IPack(g0, g1);
+        __m256i r = IPack(r0, r1);
+
+        // The unpacks are per half again, leaving pixels 0-15 in the low
+        // halves and 16-31 in the high ones, so stitch them back on the way out.
+        __m256i bg0 = _mm256_unpacklo_epi8(b, g);
+        __m256i bg1 = _mm256_unpackhi_epi8(b, g);
+        __m256i ra0 = _mm256_unpacklo_epi8(r, alpha);
+        __m256i ra1 = _mm256_unpackhi_epi8(r, alpha);
+        __m256i p0 = _mm256_unpacklo_epi16(bg0, ra0);
+        __m256i p1 = _mm256_unpackhi_epi16(bg0, ra0);
+        __m256i p2 = _mm256_unpacklo_epi16(bg1, ra1);
+        __m256i p3 = _mm256_unpackhi_epi16(bg1, ra1);
+        __m256i* out = reinterpret_cast<__m256i*>(dest + j * 4);
+        _mm256_storeu_si256(out + 0, _mm256_permute2x128_si256(p0, p1, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(p2, p3, 0x20));
+        _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(p0, p1, 0x31));
+        _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+    }
+    _mm256_zeroupper();
+
+    if (j < w)
+        yuv420_row_sse2(y_src + j, u_src + j/2, v_src + j/2, dest + j * 4, w - j);
+#endif // HAVE_AVX2
+}
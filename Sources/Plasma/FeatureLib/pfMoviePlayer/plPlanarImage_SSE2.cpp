@@ -0,0 +1,105 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plPlanarImage_Private.h"
+
+#ifdef HAVE_SSE2
+#   include <emmintrin.h>
+
+// The same fixed point math as yuv420_row_fpu, with the biases folded in:
+//   B = (74y + 127u - 17440) >> 6
+//   G = (74y - 25u - 52v + 8672) >> 6
+//   R = (74y + 102v - 14240) >> 6
+// G and R fit in a signed 16-bit lane. B does not, so it is summed unsigned
+// and rounded onto a multiple of 64 first: (74y + 127u + 32) / 64 - 273.
+static inline void IConvert(__m128i y, __m128i u, __m128i v, __m128i& b, __m128i& g, __m128i& r)
+{
+    __m128i y1 = _mm_mullo_epi16(y, _mm_set1_epi16(74));
+    b = _mm_add_epi16(y1, _mm_mullo_epi16(u, _mm_set1_epi16(127)));
+    b = _mm_srli_epi16(_mm_add_epi16(b, _mm_set1_epi16(32)), 6);
+    b = _mm_sub_epi16(b, _mm_set1_epi16(273));
+    g = _mm_sub_epi16(y1, _mm_mullo_epi16(u, _mm_set1_epi16(25)));
+    g = _mm_sub_epi16(g, _mm_mullo_epi16(v, _mm_set1_epi16(52)));
+    g = _mm_srai_epi16(_mm_add_epi16(g, _mm_set1_epi16(8672)), 6);
+    r = _mm_add_epi16(y1, _mm_mullo_epi16(v, _mm_set1_epi16(102)));
+    r = _mm_srai_epi16(_mm_sub_epi16(r, _mm_set1_epi16(14240)), 6);
+}
+#endif // HAVE_SSE2
+
+void plPlanarImageKernels::yuv420_row_sse2(const uint8_t* y_src, const uint8_t* u_src, const uint8_t* v_src, uint8_t* dest, uint32_t w)
+{
+#ifdef HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi8(-1);
+
+    // Sixteen pixels (eight chroma samples) at a time
+    uint32_t j = 0;
+    for (; j + 16 <= w; j += 16)
+    {
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y_src + j));
+        __m128i u = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u_src + j/2));
+        __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v_src + j/2));
+        u = _mm_unpacklo_epi8(u, u);
+        v = _mm_unpacklo_epi8(v, v);
+
+        __m128i b0, g0, r0, b1, g1, r1;
+        IConvert(_mm_unpacklo_epi8(y, zero), _mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(v, zero), b0, g0, r0);
+        IConvert(_mm_unpackhi_epi8(y, zero), _mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(v, zero), b1, g1, r1);
+        __m128i b = _mm_packus_epi16(b0, b1);
+        __m128i g = _mm_packus_epi16(g0, g1);
+        __m128i r = _mm_packus_epi16(r0, r1);
+
+        __m128i bg0 = _mm_unpacklo_epi8(b, g);
+        __m128i bg1 = _mm_unpackhi_epi8(b, g);
+        __m128i ra0 = _mm_unpacklo_epi8(r, alpha);
+        __m128i ra1 = _mm_unpackhi_epi8(r, alpha);
+        __m128i* out = reinterpret_cast<__m128i*>(dest + j * 4);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(bg0, ra0));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bg0, ra0));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(bg1, ra1));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(bg1, ra1));
+    }
+
+    if (j < w)
+        yuv420_row_fpu(y_src + j, u_src + j/2, v_src + j/2, dest + j * 4, w - j);
+#endif // HAVE_SSE2
+}
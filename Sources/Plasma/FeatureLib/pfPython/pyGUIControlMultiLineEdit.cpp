@@ -527,6 +527,29 @@ int32_t pyGUIControlMultiLineEdit::GetBufferLimit()
     return 0;
 }
 
+void pyGUIControlMultiLineEdit::SetScrollbackLimit(int32_t lines)
+{
+    if ( fGCkey )
+    {
+        // get the pointer to the modifier
+        pfGUIMultiLineEditCtrl* pbmod = pfGUIMultiLineEditCtrl::ConvertNoRef(fGCkey->ObjectIsLoaded());
+        if ( pbmod )
+            pbmod->SetScrollbackLimit(lines);
+    }
+}
+
+int32_t pyGUIControlMultiLineEdit::GetScrollbackLimit()
+{
+    if ( fGCkey )
+    {
+        // get the pointer to the modifier
+        pfGUIMultiLineEditCtrl* pbmod = pfGUIMultiLineEditCtrl::ConvertNoRef(fGCkey->ObjectIsLoaded());
+        if ( pbmod )
+            return pbmod->GetScrollbackLimit();
+    }
+    return -1;
+}
+
 void pyGUIControlMultiLineEdit::EnableScrollControl()
 {
     if ( fGCkey )
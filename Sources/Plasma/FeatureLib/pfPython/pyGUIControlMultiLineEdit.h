@@ -93,6 +93,8 @@ public:
     
     virtual void    SetBufferLimit(int32_t limit);
     virtual int32_t   GetBufferLimit();
+    virtual void    SetScrollbackLimit(int32_t lines);
+    virtual int32_t   GetScrollbackLimit();
 
     virtual void    InsertChar( char c );
     virtual void    InsertCharW( wchar_t c );
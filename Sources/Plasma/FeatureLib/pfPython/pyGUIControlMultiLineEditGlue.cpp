@@ -337,6 +337,23 @@ PYTHON_METHOD_DEFINITION_NOARGS(ptGUIControlMultiLineEdit, getBufferLimit)
     return PyLong_FromLong(self->fThis->GetBufferLimit());
 }
 
+PYTHON_METHOD_DEFINITION(ptGUIControlMultiLineEdit, setScrollbackLimit, args)
+{
+    long lines;
+    if (!PyArg_ParseTuple(args, "l", &lines))
+    {
+        PyErr_SetString(PyExc_TypeError, "setScrollbackLimit expects a long");
+        PYTHON_RETURN_ERROR;
+    }
+    self->fThis->SetScrollbackLimit(lines);
+    PYTHON_RETURN_NONE;
+}
+
+PYTHON_METHOD_DEFINITION_NOARGS(ptGUIControlMultiLineEdit, getScrollbackLimit)
+{
+    return PyLong_FromLong(self->fThis->GetScrollbackLimit());
+}
+
 PYTHON_BASIC_METHOD_DEFINITION(ptGUIControlMultiLineEdit, enableScrollControl, EnableScrollControl)
 PYTHON_BASIC_METHOD_DEFINITION(ptGUIControlMultiLineEdit, disableScrollControl, DisableScrollControl)
 
@@ -413,6 +430,8 @@ PYTHON_START_METHODS_TABLE(ptGUIControlMultiLineEdit)
     PYTHON_METHOD_NOARGS(ptGUIControlMultiLineEdit, isLocked, "Is the multi-line edit control locked? Returns 1 if true otherwise returns 0"),
     PYTHON_METHOD(ptGUIControlMultiLineEdit, setBufferLimit, "Params: bufferLimit\nSets the buffer max for the editbox"),
     PYTHON_METHOD_NOARGS(ptGUIControlMultiLineEdit, getBufferLimit, "Returns the current buffer limit"),
+    PYTHON_METHOD(ptGUIControlMultiLineEdit, setScrollbackLimit, "Params: numLines\nSets the most lines the editbox keeps, dropping whole lines off the top past that (-1 for no limit)"),
+    PYTHON_METHOD_NOARGS(ptGUIControlMultiLineEdit, getScrollbackLimit, "Returns the current scrollback limit in lines"),
     PYTHON_BASIC_METHOD(ptGUIControlMultiLineEdit, enableScrollControl, "Enables the scroll control if there is one"),
     PYTHON_BASIC_METHOD(ptGUIControlMultiLineEdit, disableScrollControl, "Disables the scroll control if there is one"),
     PYTHON_METHOD(ptGUIControlMultiLineEdit, deleteLinesFromTop, "Params: numLines\nDeletes the specified number of lines from the top of the text buffer"),
@@ -54,6 +54,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #   include "pyVault.h"
 #endif
 #include "pyImage.h"
+#include "pyObjectRef.h"
 #include "cyMisc.h"
 
 #include "plGImage/plMipmap.h"
@@ -148,6 +149,55 @@ PyObject* pyVaultImageNode::Image_GetImage()
     return pyImage::New(fMipmap);   
 }
 
+void pyVaultImageNode::Image_GetImageAsync(PyObject* pySelf, PyObject* callback)
+{
+    Py_INCREF(callback);
+    pyObjectRef callbackRef(callback);
+    auto finish = [callbackRef](pyObjectRef image) {
+        pyObjectRef retVal = PyObject_CallFunctionObjArgs(callbackRef.Get(), image.Get(), nullptr);
+        if (!retVal) {
+            PyErr_Print();
+            PyErr_Clear();
+        }
+    };
+
+    if (!fNode || fMipmap) {
+        pyObjectRef image;
+        if (fMipmap)
+            image = pyImage::New(fMipmap);
+        else
+            image.SetPyNone();
+        finish(std::move(image));
+        return;
+    }
+
+    Py_INCREF(pySelf);
+    pyObjectRef selfRef(pySelf);
+    unsigned nodeId = fNode->GetNodeId();
+    VaultImageNode access(fNode);
+    access.ExtractImageAsync([this, selfRef, nodeId, finish](plMipmap* mipmap) {
+        pyObjectRef image;
+        if (mipmap) {
+            // Someone may have set or fetched the image while we were busy
+            if (fMipmap) {
+                delete mipmap;
+            } else {
+                fMipmap = mipmap;
+                fMipmapKey = fMipmap->GetKey();
+                if (!fMipmapKey)
+                    fMipmapKey = CreateAndRefImageKey(nodeId, fMipmap);
+                else
+                    fMipmapKey->RefObject();
+            }
+        }
+        if (fMipmap)
+            image = pyImage::New(fMipmap);
+        else
+            image.SetPyNone();
+        finish(std::move(image));
+    });
+}
+
 void pyVaultImageNode::Image_SetImage(pyImage& image)
 {
     if (!fNode)
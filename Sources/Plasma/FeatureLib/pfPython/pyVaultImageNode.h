@@ -85,6 +85,10 @@ public:
     ST::string Image_GetTitle() const;
 
     PyObject* Image_GetImage(); // returns pyImage
+    // Same as Image_GetImage, but decodes on a worker thread and hands the
+    // pyImage (or None) to callback on the main thread.  pySelf is this
+    // node's Python object, which is kept alive until then.
+    void Image_GetImageAsync(PyObject* pySelf, PyObject* callback);
     void Image_SetImage(pyImage& image);
 
     void SetImageFromBuf( PyObject * buf );
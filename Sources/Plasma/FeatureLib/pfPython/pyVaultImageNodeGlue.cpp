@@ -170,6 +170,18 @@ PYTHON_METHOD_DEFINITION_NOARGS(ptVaultImageNode, getImage)
     return self->fThis->Image_GetImage();
 }
 
+PYTHON_METHOD_DEFINITION(ptVaultImageNode, getImageAsync, args)
+{
+    PyObject* callback = nullptr;
+    if (!PyArg_ParseTuple(args, "O", &callback) || !PyCallable_Check(callback))
+    {
+        PyErr_SetString(PyExc_TypeError, "getImageAsync expects a callable");
+        PYTHON_RETURN_ERROR;
+    }
+    self->fThis->Image_GetImageAsync((PyObject*)self, callback);
+    PYTHON_RETURN_NONE;
+}
+
 PYTHON_METHOD_DEFINITION(ptVaultImageNode, setImageFromBuf, args)
 {
     PyObject* buf = nullptr;
@@ -197,6 +209,7 @@ PYTHON_START_METHODS_TABLE(ptVaultImageNode)
     PYTHON_METHOD_NOARGS(ptVaultImageNode, getTitleW, "Unicode version of getTitle"),
     PYTHON_METHOD(ptVaultImageNode, setImage, "Params: image\nSets the image(ptImage) of this image node"),
     PYTHON_METHOD_NOARGS(ptVaultImageNode, getImage, "Returns the image(ptImage) of this image node"),
+    PYTHON_METHOD(ptVaultImageNode, getImageAsync, "Params: callback\nDecodes the image in the background, then calls callback with the image(ptImage), or None"),
     PYTHON_METHOD(ptVaultImageNode, setImageFromBuf, "Params: buf\nSets our image from a buffer"),
     PYTHON_BASIC_METHOD(ptVaultImageNode, setImageFromScrShot, "Grabs a screenshot and stuffs it into this node"),
 PYTHON_END_METHODS_TABLE;
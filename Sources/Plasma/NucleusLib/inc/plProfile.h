@@ -166,6 +166,10 @@ protected:
     // Number of times EndTiming was called. Can be used to combine timing and counting in one timer
     uint32_t fTimerSamples;
 
+    // Sum of every frame's value since ResetRun, for reports covering a whole run
+    uint64_t fRunTotal;
+    uint32_t fRunFrames;
+
     void IAddAvg();
 
     void IPrintValue(uint64_t value, char* buf, bool printType);
@@ -197,6 +201,11 @@ public:
     uint8_t GetDisplayFlags() const { return fDisplayFlags; }
 
     void ResetMax() { fMax = 0; }
+
+    void ResetRun() { fRunTotal = 0; fRunFrames = 0; fMax = 0; }
+    uint64_t GetRunTotal() const { return fRunTotal; }
+    uint32_t GetRunFrames() const { return fRunFrames; }
+    uint64_t GetMax() const { return fMax; }
 };
 
 class plProfileVar : public plProfileBase
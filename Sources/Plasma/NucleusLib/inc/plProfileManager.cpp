@@ -142,7 +142,9 @@ plProfileBase::plProfileBase() :
     fLastAvg(),
     fMax(),
     fActive(false),
-    fRunning(true)
+    fRunning(true),
+    fRunTotal(),
+    fRunFrames()
 {
 }
 
@@ -162,6 +164,8 @@ void plProfileBase::EndFrame()
     fAvgCount++;
     fAvgTotal += fValue;
     fMax = std::max(fMax, fValue);
+    fRunTotal += fValue;
+    fRunFrames++;
 }
 
 void plProfileBase::UpdateAvg()
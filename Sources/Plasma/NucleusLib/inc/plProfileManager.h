@@ -67,6 +67,7 @@ public:
     static plProfileManager& Instance();
 
     void AddTimer(plProfileVar* var);   // Called by plProfileVar
+    const std::vector<plProfileVar*>& GetVars() const { return fVars; }
 
     void BeginFrame();  // Call begin frame on all timers
     void EndFrame();    // Call end frame on all timers
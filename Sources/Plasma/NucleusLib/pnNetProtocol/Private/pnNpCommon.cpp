@@ -243,49 +243,126 @@ void NetGameRank::CopyFrom(const NetGameRank & fromRank) {
 ***/
 
 //============================================================================
-NetVaultNode::Blob::Blob(const Blob& rhs)
+uint8_t* NetVaultNode::IAllocVarField(VarField field, size_t size)
 {
-    buffer = new uint8_t[rhs.size];
-    size = rhs.size;
-    memcpy(buffer, rhs.buffer, rhs.size);
+    FieldRef& ref = fVarFields[field];
+    fCachedStrings &= ~(1u << field);
+
+    // Shrinking (or same-size) updates are done in place
+    if (size <= ref.size) {
+        fArenaWaste += ref.size - static_cast<uint32_t>(size);
+        ref.size = static_cast<uint32_t>(size);
+        return fArena.data() + ref.offset;
+    }
+
+    fArenaWaste += ref.size;
+    ref.size = 0;
+    if (fArenaWaste > fArena.size() / 2)
+        ICompactArena();
+
+    // Keep every field two byte aligned so UTF-16 data can be read directly
+    size_t offset = (fArena.size() + 1) & ~size_t(1);
+    fArena.resize(offset + size);
+    ref.offset = static_cast<uint32_t>(offset);
+    ref.size = static_cast<uint32_t>(size);
+    return fArena.data() + offset;
+}
+
+//============================================================================
+void NetVaultNode::ICompactArena()
+{
+    std::vector<uint8_t> arena;
+    size_t live = 0;
+    for (const FieldRef& ref : fVarFields)
+        live += (ref.size + 1) & ~uint32_t(1);
+    arena.reserve(live);
+
+    for (FieldRef& ref : fVarFields) {
+        if (!ref.size) {
+            ref.offset = 0;
+            continue;
+        }
+        size_t offset = (arena.size() + 1) & ~size_t(1);
+        arena.resize(offset + ref.size);
+        memcpy(arena.data() + offset, fArena.data() + ref.offset, ref.size);
+        ref.offset = static_cast<uint32_t>(offset);
+    }
+
+    fArena = std::move(arena);
+    fArenaWaste = 0;
+}
+
+//============================================================================
+void NetVaultNode::IClearVarFields()
+{
+    memset(fVarFields, 0, sizeof(fVarFields));
+    fArena.clear();
+    fArenaWaste = 0;
+    fCachedStrings = 0;
 }
 
 //============================================================================
-NetVaultNode::Blob::Blob(Blob&& rhs)
+bool NetVaultNode::IVarFieldEquals(VarField field, const NetVaultNode* rhs) const
 {
-    size = rhs.size;
-    buffer = rhs.buffer;
-    rhs.size = 0;
-    rhs.buffer = nullptr;
+    const FieldRef& lref = fVarFields[field];
+    const FieldRef& rref = rhs->fVarFields[field];
+    if (lref.size != rref.size)
+        return false;
+    return lref.size == 0 || memcmp(fArena.data() + lref.offset, rhs->fArena.data() + rref.offset, lref.size) == 0;
 }
 
 //============================================================================
-void NetVaultNode::Blob::operator=(const Blob& rhs)
+ST::string NetVaultNode::IGetString(VarField field) const
 {
-    if (size != rhs.size) {
-        delete[] buffer;
-        buffer = new uint8_t[rhs.size];
-        size = rhs.size;
+    const FieldRef& ref = fVarFields[field];
+    if (!ref.size)
+        return ST::string();
+
+    if (!(fCachedStrings & (1u << field))) {
+        if (!fStringCache)
+            fStringCache = std::make_unique<ST::string[]>(kNumStringFields);
+        const char16_t* utf16 = reinterpret_cast<const char16_t*>(fArena.data() + ref.offset);
+        fStringCache[field] = ST::string::from_utf16(utf16, ref.size / sizeof(char16_t));
+        fCachedStrings |= 1u << field;
     }
-    memcpy(buffer, rhs.buffer, rhs.size);
+    return fStringCache[field];
 }
 
 //============================================================================
-void NetVaultNode::Blob::operator=(Blob&& rhs)
+void NetVaultNode::ISetVaultString(uint64_t bits, VarField field, const ST::string& value)
 {
-    delete[] buffer;
-    size = rhs.size;
-    buffer = rhs.buffer;
-    rhs.size = 0;
-    rhs.buffer = nullptr;
+    ST::utf16_buffer utf16 = value.to_utf16();
+    size_t bytes = utf16.size() * sizeof(char16_t);
+    uint8_t* dest = IAllocVarField(field, bytes);
+    if (bytes)
+        memcpy(dest, utf16.data(), bytes);
+
+    // Already have the UTF-8, so save the next Get converting it back
+    if (fStringCache) {
+        fStringCache[field] = value;
+        fCachedStrings |= 1u << field;
+    }
+
+    fUsedFields |= bits;
+    fDirtyFields |= bits;
 }
 
 //============================================================================
-bool NetVaultNode::Blob::operator==(const Blob& rhs) const
+void NetVaultNode::ISetVaultBlob(uint64_t bits, VarField field, const uint8_t* buf, size_t size)
 {
-    if (size == rhs.size)
-        return memcmp(buffer, rhs.buffer, size) == 0;
-    return false;
+    // The source may be one of our own fields, which making room can move
+    std::vector<uint8_t> copy;
+    if (size && buf >= fArena.data() && buf < fArena.data() + fArena.size()) {
+        copy.assign(buf, buf + size);
+        buf = copy.data();
+    }
+
+    uint8_t* dest = IAllocVarField(field, size);
+    if (size)
+        memcpy(dest, buf, size);
+
+    fUsedFields |= bits;
+    fDirtyFields |= bits;
 }
 
 //============================================================================
@@ -296,6 +373,7 @@ void NetVaultNode::Clear()
     fUsedFields = 0;
     fDirtyFields = 0;
     fRevision = kNilUuid;
+    IClearVarFields();
 }
 
 //============================================================================
@@ -305,28 +383,18 @@ inline void IZero(T& dest)
     dest = 0;
 }
 
-template<>
-inline void IZero<ST::string>(ST::string& dest)
-{
-    dest = ST::string();
-}
-
 template<>
 inline void IZero<plUUID>(plUUID& dest)
 {
     dest = kNilUuid;
 }
 
-template<>
-inline void IZero<NetVaultNode::Blob>(NetVaultNode::Blob& blob)
-{
-    delete[] blob.buffer;
-    blob.buffer = nullptr;
-    blob.size = 0;
-}
-
 void NetVaultNode::CopyFrom(const NetVaultNode* node)
 {
+    // Clearing our fields below would take the source's with them
+    if (node == this)
+        return;
+
     fUsedFields = node->fUsedFields;
     fDirtyFields = node->fDirtyFields;
     fRevision = node->fRevision;
@@ -340,7 +408,6 @@ void NetVaultNode::CopyFrom(const NetVaultNode* node)
     COPYORZERO(NodeId);
     COPYORZERO(CreateTime);
     COPYORZERO(ModifyTime);
-    COPYORZERO(CreateAgeName);
     COPYORZERO(CreateAgeUuid);
     COPYORZERO(CreatorAcct);
     COPYORZERO(CreatorId);
@@ -357,20 +424,39 @@ void NetVaultNode::CopyFrom(const NetVaultNode* node)
     COPYORZERO(Uuid_2);
     COPYORZERO(Uuid_3);
     COPYORZERO(Uuid_4);
-    COPYORZERO(String64_1);
-    COPYORZERO(String64_2);
-    COPYORZERO(String64_3);
-    COPYORZERO(String64_4);
-    COPYORZERO(String64_5);
-    COPYORZERO(String64_6);
-    COPYORZERO(IString64_1);
-    COPYORZERO(IString64_2);
-    COPYORZERO(Text_1);
-    COPYORZERO(Text_2);
-    COPYORZERO(Blob_1);
-    COPYORZERO(Blob_2);
 
 #undef COPYORZERO
+
+    // The variable length fields are copied as one block, dropping any
+    // unused fields and dead space left behind by earlier updates.
+    IClearVarFields();
+    size_t live = 0;
+    for (const FieldRef& ref : node->fVarFields)
+        live += (ref.size + 1) & ~uint32_t(1);
+    fArena.reserve(live);
+
+#define COPYVAR(field) \
+    if (fUsedFields & k##field) { \
+        const FieldRef& ref = node->fVarFields[kVar##field]; \
+        if (ref.size) \
+            memcpy(IAllocVarField(kVar##field, ref.size), node->fArena.data() + ref.offset, ref.size); \
+    }
+
+    COPYVAR(CreateAgeName);
+    COPYVAR(String64_1);
+    COPYVAR(String64_2);
+    COPYVAR(String64_3);
+    COPYVAR(String64_4);
+    COPYVAR(String64_5);
+    COPYVAR(String64_6);
+    COPYVAR(IString64_1);
+    COPYVAR(IString64_2);
+    COPYVAR(Text_1);
+    COPYVAR(Text_2);
+    COPYVAR(Blob_1);
+    COPYVAR(Blob_2);
+
+#undef COPYVAR
 }
 
 //============================================================================
@@ -390,7 +476,12 @@ bool NetVaultNode::Matches(const NetVaultNode* rhs) const
             return false;
 
 #define COMPARE(field) if (k##field == bit && f##field != rhs->f##field) return false;
-#define COMPARE_ISTRING(field) if (k##field == bit && f##field.compare_i(rhs->f##field) != 0) return false;
+#define COMPARE_VAR(field) if (k##field == bit && !IVarFieldEquals(kVar##field, rhs)) return false;
+// Identical UTF-16 data always matches; only convert when we need to fold case.
+#define COMPARE_ISTRING(field) \
+    if (k##field == bit && !IVarFieldEquals(kVar##field, rhs) && \
+        IGetString(kVar##field).compare_i(rhs->IGetString(kVar##field)) != 0) \
+        return false;
     COMPARE(NodeId);
     COMPARE(CreateTime);
     COMPARE(ModifyTime);
@@ -411,19 +502,20 @@ bool NetVaultNode::Matches(const NetVaultNode* rhs) const
     COMPARE(Uuid_2);
     COMPARE(Uuid_3);
     COMPARE(Uuid_4);
-    COMPARE(String64_1);
-    COMPARE(String64_2);
-    COMPARE(String64_3);
-    COMPARE(String64_4);
-    COMPARE(String64_5);
-    COMPARE(String64_6);
+    COMPARE_VAR(String64_1);
+    COMPARE_VAR(String64_2);
+    COMPARE_VAR(String64_3);
+    COMPARE_VAR(String64_4);
+    COMPARE_VAR(String64_5);
+    COMPARE_VAR(String64_6);
     COMPARE_ISTRING(IString64_1);
     COMPARE_ISTRING(IString64_2);
-    COMPARE(Text_1);
-    COMPARE(Text_2);
-    COMPARE(Blob_1);
-    COMPARE(Blob_2);
+    COMPARE_VAR(Text_1);
+    COMPARE_VAR(Text_2);
+    COMPARE_VAR(Blob_1);
+    COMPARE_VAR(Blob_2);
 #undef COMPARE
+#undef COMPARE_VAR
 #undef COMPARE_ISTRING
     }
 
@@ -435,47 +527,40 @@ bool NetVaultNode::Matches(const NetVaultNode* rhs) const
 template<typename T>
 inline void IRead(const uint8_t*& buf, T& dest)
 {
-    const T* ptr = reinterpret_cast<const T*>(buf);
-    dest = *ptr;
+    memcpy(&dest, buf, sizeof(T));
     buf += sizeof(T);
 }
 
-template<>
-inline void IRead<ST::string>(const uint8_t*& buf, ST::string& dest)
-{
-    uint32_t size = *(reinterpret_cast<const uint32_t*>(buf));
-    uint32_t nChars = (size / sizeof(char16_t)) - 1;
-    buf += sizeof(uint32_t);
-
-    ST::utf16_buffer str;
-    str.allocate(nChars);
-    memcpy(str.data(), buf, nChars * sizeof(char16_t));
-    dest = ST::string::from_utf16(str);
-    buf += size;
-}
-
-template<>
-inline void IRead<NetVaultNode::Blob>(const uint8_t*& buf, NetVaultNode::Blob& blob)
-{
-    blob.size = *(reinterpret_cast<const uint32_t*>(buf));
-    buf += sizeof(uint32_t);
-
-    delete[] blob.buffer;
-    blob.buffer = new uint8_t[blob.size];
-    memcpy(blob.buffer, buf, blob.size);
-    buf += blob.size;
-}
-
 void NetVaultNode::Read(const uint8_t* buf, size_t size)
 {
-    fUsedFields= *(reinterpret_cast<const uint64_t*>(buf));
-    buf += sizeof(uint64_t);
+    IRead(buf, fUsedFields);
+
+    // Find the variable length fields on the first pass, then size the arena
+    // to just what they need (dropping a much larger one left from an earlier
+    // Read) and copy them in.
+    const uint8_t* start = buf;
+    FieldRef wire[kNumVarFields] = {};
+    size_t live = 0;
 
 #define READ(field) if (fUsedFields & k##field) IRead(buf, f##field);
+#define READ_VAR(field, length) \
+    if (fUsedFields & k##field) { \
+        uint32_t bytes; \
+        IRead(buf, bytes); \
+        wire[kVar##field].offset = static_cast<uint32_t>(buf - start); \
+        wire[kVar##field].size = (length); \
+        live += (wire[kVar##field].size + 1) & ~uint32_t(1); \
+        buf += bytes; \
+    }
+// Strings are stored without their terminator; a zero length wire string is
+// treated as empty rather than underflowing the character count.
+#define READ_STRING(field) \
+    READ_VAR(field, bytes / sizeof(char16_t) > 1 ? (bytes / sizeof(char16_t) - 1) * sizeof(char16_t) : 0)
+#define READ_BLOB(field) READ_VAR(field, bytes)
     READ(NodeId);
     READ(CreateTime);
     READ(ModifyTime);
-    READ(CreateAgeName);
+    READ_STRING(CreateAgeName);
     READ(CreateAgeUuid);
     READ(CreatorAcct);
     READ(CreatorId);
@@ -492,19 +577,31 @@ void NetVaultNode::Read(const uint8_t* buf, size_t size)
     READ(Uuid_2);
     READ(Uuid_3);
     READ(Uuid_4);
-    READ(String64_1);
-    READ(String64_2);
-    READ(String64_3);
-    READ(String64_4);
-    READ(String64_5);
-    READ(String64_6);
-    READ(IString64_1);
-    READ(IString64_2);
-    READ(Text_1);
-    READ(Text_2);
-    READ(Blob_1);
-    READ(Blob_2);
+    READ_STRING(String64_1);
+    READ_STRING(String64_2);
+    READ_STRING(String64_3);
+    READ_STRING(String64_4);
+    READ_STRING(String64_5);
+    READ_STRING(String64_6);
+    READ_STRING(IString64_1);
+    READ_STRING(IString64_2);
+    READ_STRING(Text_1);
+    READ_STRING(Text_2);
+    READ_BLOB(Blob_1);
+    READ_BLOB(Blob_2);
 #undef READ
+#undef READ_VAR
+#undef READ_STRING
+#undef READ_BLOB
+
+    IClearVarFields();
+    if (fArena.capacity() > live * 2)
+        std::vector<uint8_t>().swap(fArena);
+    fArena.reserve(live);
+    for (size_t i = 0; i < kNumVarFields; ++i) {
+        if (wire[i].size)
+            memcpy(IAllocVarField(VarField(i), wire[i].size), start + wire[i].offset, wire[i].size);
+    }
 
     fDirtyFields = 0;
 }
@@ -520,30 +617,6 @@ inline void IWrite(std::vector<uint8_t>* buffer, const T& value)
     memcpy(buffer->data() + oldSize, &value, sizeof(T));
 }
 
-template<>
-inline void IWrite<ST::string>(std::vector<uint8_t>* buffer, const ST::string& value)
-{
-    ST::utf16_buffer utf16 = value.to_utf16();
-    uint32_t strsz = (utf16.size() + 1) * sizeof(char16_t);
-    IWrite(buffer, strsz);
-
-    const size_t oldSize = buffer->size();
-    buffer->resize(oldSize + strsz);
-    memcpy(buffer->data() + oldSize, utf16.data(), strsz);
-}
-
-template<>
-inline void IWrite<NetVaultNode::Blob>(std::vector<uint8_t>* buffer, const NetVaultNode::Blob& blob)
-{
-    IWrite(buffer, static_cast<uint32_t>(blob.size));
-
-    if (blob.size > 0) {
-        const size_t oldSize = buffer->size();
-        buffer->resize(oldSize + blob.size);
-        memcpy(buffer->data() + oldSize, blob.buffer, blob.size);
-    }
-}
-
 void NetVaultNode::Write(std::vector<uint8_t>* buf, uint32_t ioFlags)
 {
     uint64_t flags = fUsedFields;
@@ -556,10 +629,24 @@ void NetVaultNode::Write(std::vector<uint8_t>* buf, uint32_t ioFlags)
     IWrite(buf, flags);
 
 #define WRITE(field) if (flags & k##field) IWrite(buf, f##field);
+// Wire strings are null terminated UTF-16, and the size includes the terminator.
+#define WRITE_VAR(field, terminator) \
+    if (flags & k##field) { \
+        const FieldRef& ref = fVarFields[kVar##field]; \
+        IWrite(buf, ref.size + terminator); \
+        const size_t oldSize = buf->size(); \
+        buf->resize(oldSize + ref.size + terminator); \
+        if (ref.size) \
+            memcpy(buf->data() + oldSize, fArena.data() + ref.offset, ref.size); \
+        if (terminator) \
+            memset(buf->data() + oldSize + ref.size, 0, terminator); \
+    }
+#define WRITE_STRING(field) WRITE_VAR(field, uint32_t(sizeof(char16_t)))
+#define WRITE_BLOB(field) WRITE_VAR(field, uint32_t(0))
     WRITE(NodeId);
     WRITE(CreateTime);
     WRITE(ModifyTime);
-    WRITE(CreateAgeName);
+    WRITE_STRING(CreateAgeName);
     WRITE(CreateAgeUuid);
     WRITE(CreatorAcct);
     WRITE(CreatorId);
@@ -576,32 +663,23 @@ void NetVaultNode::Write(std::vector<uint8_t>* buf, uint32_t ioFlags)
     WRITE(Uuid_2);
     WRITE(Uuid_3);
     WRITE(Uuid_4);
-    WRITE(String64_1);
-    WRITE(String64_2);
-    WRITE(String64_3);
-    WRITE(String64_4);
-    WRITE(String64_5);
-    WRITE(String64_6);
-    WRITE(IString64_1);
-    WRITE(IString64_2);
-    WRITE(Text_1);
-    WRITE(Text_2);
-    WRITE(Blob_1);
-    WRITE(Blob_2);
+    WRITE_STRING(String64_1);
+    WRITE_STRING(String64_2);
+    WRITE_STRING(String64_3);
+    WRITE_STRING(String64_4);
+    WRITE_STRING(String64_5);
+    WRITE_STRING(String64_6);
+    WRITE_STRING(IString64_1);
+    WRITE_STRING(IString64_2);
+    WRITE_STRING(Text_1);
+    WRITE_STRING(Text_2);
+    WRITE_BLOB(Blob_1);
+    WRITE_BLOB(Blob_2);
 #undef WRITE
+#undef WRITE_VAR
+#undef WRITE_STRING
+#undef WRITE_BLOB
 
     if (ioFlags & kClearDirty)
         fDirtyFields = 0;
 }
-
-//============================================================================
-void NetVaultNode::ISetVaultBlob(uint64_t bits, NetVaultNode::Blob& blob, const uint8_t* buf, size_t size)
-{
-    delete[] blob.buffer;
-    blob.buffer = new uint8_t[size];
-    blob.size = size;
-    memcpy(blob.buffer, buf, size);
-
-    fUsedFields |= bits;
-    fDirtyFields |= bits;
-}
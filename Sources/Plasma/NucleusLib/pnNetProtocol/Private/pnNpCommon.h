@@ -55,6 +55,8 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "hsRefCnt.h"
 
+#include <memory>
+
 
 /*****************************************************************************
 *
@@ -201,29 +203,36 @@ protected:
                         kIString64_2 | kText_1 | kText_2 | kBlob_1 | kBlob_2)
     };
 
-public:
+private:
     /**
-     * This is public only so that it may be referenced by anonymous functions.
-     * Should not be used outside NetVaultNode.
+     * Variable length fields are packed into a single arena buffer rather than
+     * stored as separate heap objects. Strings are kept in their UTF-16 wire
+     * form (without the terminator) and only converted to UTF-8 when fetched.
      */
-    struct Blob
+    enum VarField : uint8_t
     {
-        size_t size;
-        uint8_t* buffer;
-
-        Blob() : size(0), buffer(nullptr) { }
-        Blob(const Blob &rhs);
-        Blob(Blob &&rhs);
-        ~Blob() { delete[] buffer; }
-
-        void operator =(const Blob& rhs);
-        void operator =(Blob&& rhs);
-
-        bool operator ==(const Blob& rhs) const;
-        bool operator !=(const Blob& rhs) const { return !operator==(rhs); }
+        kVarCreateAgeName,
+        kVarString64_1,
+        kVarString64_2,
+        kVarString64_3,
+        kVarString64_4,
+        kVarString64_5,
+        kVarString64_6,
+        kVarIString64_1,
+        kVarIString64_2,
+        kVarText_1,
+        kVarText_2,
+        kVarBlob_1,
+        kVarBlob_2,
+
+        kNumVarFields
     };
 
-private:
+    struct FieldRef
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
 
     uint64_t fUsedFields;
     uint64_t fDirtyFields;
@@ -232,7 +241,6 @@ private:
     uint32_t fNodeId;
     uint32_t fCreateTime;
     uint32_t fModifyTime;
-    ST::string fCreateAgeName;
     plUUID   fCreateAgeUuid;
     plUUID   fCreatorAcct;
     uint32_t fCreatorId;
@@ -249,18 +257,15 @@ private:
     plUUID   fUuid_2;
     plUUID   fUuid_3;
     plUUID   fUuid_4;
-    ST::string fString64_1;
-    ST::string fString64_2;
-    ST::string fString64_3;
-    ST::string fString64_4;
-    ST::string fString64_5;
-    ST::string fString64_6;
-    ST::string fIString64_1;
-    ST::string fIString64_2;
-    ST::string fText_1;
-    ST::string fText_2;
-    Blob     fBlob_1;
-    Blob     fBlob_2;
+
+    FieldRef fVarFields[kNumVarFields];
+    std::vector<uint8_t> fArena;
+    uint32_t fArenaWaste;
+
+    // UTF-8 copies of the string fields fetched so far, allocated on first use
+    static constexpr size_t kNumStringFields = kVarBlob_1;
+    mutable std::unique_ptr<ST::string[]> fStringCache;
+    mutable uint32_t fCachedStrings;
 
     template<typename T>
     inline void ISetVaultField(uint64_t bits, T& field, T value)
@@ -277,7 +282,19 @@ private:
         fUsedFields |= bits;
     }
 
-    void ISetVaultBlob(uint64_t bits, Blob& blob, const uint8_t* buf, size_t size);
+    uint8_t* IAllocVarField(VarField field, size_t size);
+    void ICompactArena();
+    void IClearVarFields();
+    bool IVarFieldEquals(VarField field, const NetVaultNode* rhs) const;
+
+    ST::string IGetString(VarField field) const;
+    const uint8_t* IGetBlob(VarField field) const
+    {
+        return fVarFields[field].size ? fArena.data() + fVarFields[field].offset : nullptr;
+    }
+
+    void ISetVaultString(uint64_t bits, VarField field, const ST::string& value);
+    void ISetVaultBlob(uint64_t bits, VarField field, const uint8_t* buf, size_t size);
 
 public:
     enum IOFlags
@@ -297,9 +314,10 @@ public:
 
 public:
     NetVaultNode()
-        : fNodeId(0), fCreateTime(0), fModifyTime(0), fCreatorId(0), fNodeType(0), fInt32_1(0),
-          fInt32_2(0), fInt32_3(0), fInt32_4(0), fUInt32_1(0), fUInt32_2(0), fUInt32_3(0),
-          fUInt32_4(0), fUsedFields(0), fDirtyFields(0)
+        : fUsedFields(0), fDirtyFields(0), fNodeId(0), fCreateTime(0), fModifyTime(0),
+          fCreatorId(0), fNodeType(0), fInt32_1(0), fInt32_2(0), fInt32_3(0), fInt32_4(0),
+          fUInt32_1(0), fUInt32_2(0), fUInt32_3(0), fUInt32_4(0), fVarFields(), fArenaWaste(0),
+          fCachedStrings(0)
     { }
 
     /** Clears this NetVaultNode for subsequent usage */
@@ -320,13 +338,16 @@ public:
     bool IsDirty() const { return fDirtyFields != 0; }
     bool IsUsed() const { return fUsedFields != 0; }
 
+    /** Bytes reserved for the variable length (string and blob) field storage */
+    size_t GetArenaCapacity() const { return fArena.capacity(); }
+
     plUUID GetRevision() const { return fRevision; }
     void GenerateRevision() { fRevision = plUUID::Generate(); }
 
     uint32_t GetNodeId() const { return fNodeId; }
     uint32_t GetCreateTime() const { return fCreateTime; }
     uint32_t GetModifyTime() const { return fModifyTime; }
-    ST::string GetCreateAgeName() const { return fCreateAgeName; }
+    ST::string GetCreateAgeName() const { return IGetString(kVarCreateAgeName); }
     plUUID GetCreateAgeUuid() const { return fCreateAgeUuid; }
     plUUID GetCreatorAcct() const { return fCreatorAcct; }
     uint32_t GetCreatorId() const { return fCreatorId; }
@@ -343,29 +364,29 @@ public:
     plUUID GetUuid_2() const { return fUuid_2; }
     plUUID GetUuid_3() const { return fUuid_3; }
     plUUID GetUuid_4() const { return fUuid_4; }
-    ST::string GetString64_1() const { return fString64_1; }
-    ST::string GetString64_2() const { return fString64_2; }
-    ST::string GetString64_3() const { return fString64_3; }
-    ST::string GetString64_4() const { return fString64_4; }
-    ST::string GetString64_5() const { return fString64_5; }
-    ST::string GetString64_6() const { return fString64_6; }
-    ST::string GetIString64_1() const { return fIString64_1; }
-    ST::string GetIString64_2() const { return fIString64_2; }
-    ST::string GetText_1() const { return fText_1; }
-    ST::string GetText_2() const { return fText_2; }
-
-    const uint8_t* GetBlob_1() const { return fBlob_1.buffer; }
-    size_t GetBlob_1Length() const { return fBlob_1.size; }
-
-    const uint8_t* GetBlob_2() const { return fBlob_2.buffer; }
-    size_t GetBlob_2Length() const { return fBlob_2.size; }
+    ST::string GetString64_1() const { return IGetString(kVarString64_1); }
+    ST::string GetString64_2() const { return IGetString(kVarString64_2); }
+    ST::string GetString64_3() const { return IGetString(kVarString64_3); }
+    ST::string GetString64_4() const { return IGetString(kVarString64_4); }
+    ST::string GetString64_5() const { return IGetString(kVarString64_5); }
+    ST::string GetString64_6() const { return IGetString(kVarString64_6); }
+    ST::string GetIString64_1() const { return IGetString(kVarIString64_1); }
+    ST::string GetIString64_2() const { return IGetString(kVarIString64_2); }
+    ST::string GetText_1() const { return IGetString(kVarText_1); }
+    ST::string GetText_2() const { return IGetString(kVarText_2); }
+
+    const uint8_t* GetBlob_1() const { return IGetBlob(kVarBlob_1); }
+    size_t GetBlob_1Length() const { return fVarFields[kVarBlob_1].size; }
+
+    const uint8_t* GetBlob_2() const { return IGetBlob(kVarBlob_2); }
+    size_t GetBlob_2Length() const { return fVarFields[kVarBlob_2].size; }
 
 public:
     void SetNodeId(uint32_t value) { ISetVaultField(kNodeId, fNodeId, value); }
     void SetNodeId_NoDirty(uint32_t value) { ISetVaultField_NoDirty(kNodeId, fNodeId, value); }
     void SetCreateTime(uint32_t value) { ISetVaultField(kCreateTime, fCreateTime, value); }
     void SetModifyTime(uint32_t value) { ISetVaultField(kModifyTime, fModifyTime, value); }
-    void SetCreateAgeName(const ST::string& value) { ISetVaultField(kCreateAgeName, fCreateAgeName, value); }
+    void SetCreateAgeName(const ST::string& value) { ISetVaultString(kCreateAgeName, kVarCreateAgeName, value); }
     void SetCreateAgeUuid(const plUUID& value) { ISetVaultField(kCreateAgeUuid, fCreateAgeUuid, value); }
     void SetCreatorAcct(const plUUID& value) { ISetVaultField(kCreatorAcct, fCreatorAcct, value); }
     void SetCreatorId(uint32_t value) { ISetVaultField(kCreatorId, fCreatorId, value); }
@@ -382,19 +403,19 @@ public:
     void SetUuid_2(const plUUID& value) { ISetVaultField(kUuid_2, fUuid_2, value); }
     void SetUuid_3(const plUUID& value) { ISetVaultField(kUuid_3, fUuid_3, value); }
     void SetUuid_4(const plUUID& value) { ISetVaultField(kUuid_4, fUuid_4, value); }
-    void SetString64_1(const ST::string& value) { ISetVaultField(kString64_1, fString64_1, value); }
-    void SetString64_2(const ST::string& value) { ISetVaultField(kString64_2, fString64_2, value); }
-    void SetString64_3(const ST::string& value) { ISetVaultField(kString64_3, fString64_3, value); }
-    void SetString64_4(const ST::string& value) { ISetVaultField(kString64_4, fString64_4, value); }
-    void SetString64_5(const ST::string& value) { ISetVaultField(kString64_5, fString64_5, value); }
-    void SetString64_6(const ST::string& value) { ISetVaultField(kString64_6, fString64_6, value); }
-    void SetIString64_1(const ST::string& value) { ISetVaultField(kIString64_1, fIString64_1, value); }
-    void SetIString64_2(const ST::string& value) { ISetVaultField(kIString64_2, fIString64_2, value); }
-    void SetText_1(const ST::string& value) { ISetVaultField(kText_1, fText_1, value); }
-    void SetText_2(const ST::string& value) { ISetVaultField(kText_2, fText_2, value); }
-
-    void SetBlob_1(const uint8_t* buf, size_t size) { ISetVaultBlob(kBlob_1, fBlob_1, buf, size); }
-    void SetBlob_2(const uint8_t* buf, size_t size) { ISetVaultBlob(kBlob_2, fBlob_2, buf, size); }
+    void SetString64_1(const ST::string& value) { ISetVaultString(kString64_1, kVarString64_1, value); }
+    void SetString64_2(const ST::string& value) { ISetVaultString(kString64_2, kVarString64_2, value); }
+    void SetString64_3(const ST::string& value) { ISetVaultString(kString64_3, kVarString64_3, value); }
+    void SetString64_4(const ST::string& value) { ISetVaultString(kString64_4, kVarString64_4, value); }
+    void SetString64_5(const ST::string& value) { ISetVaultString(kString64_5, kVarString64_5, value); }
+    void SetString64_6(const ST::string& value) { ISetVaultString(kString64_6, kVarString64_6, value); }
+    void SetIString64_1(const ST::string& value) { ISetVaultString(kIString64_1, kVarIString64_1, value); }
+    void SetIString64_2(const ST::string& value) { ISetVaultString(kIString64_2, kVarIString64_2, value); }
+    void SetText_1(const ST::string& value) { ISetVaultString(kText_1, kVarText_1, value); }
+    void SetText_2(const ST::string& value) { ISetVaultString(kText_2, kVarText_2, value); }
+
+    void SetBlob_1(const uint8_t* buf, size_t size) { ISetVaultBlob(kBlob_1, kVarBlob_1, buf, size); }
+    void SetBlob_2(const uint8_t* buf, size_t size) { ISetVaultBlob(kBlob_2, kVarBlob_2, buf, size); }
 };
 
 //============================================================================
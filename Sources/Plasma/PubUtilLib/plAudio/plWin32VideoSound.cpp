@@ -42,13 +42,14 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "plWin32VideoSound.h"
 
+#include <algorithm>
 #include <string_theory/format>
 
 #include "hsResMgr.h"
 #include "plDSoundBuffer.h"
 
 static int uniqueID = 0;
-plWin32VideoSound::plWin32VideoSound(const plWAVHeader& header) : plWin32Sound()
+plWin32VideoSound::plWin32VideoSound(const plWAVHeader& header, bool streaming) : plWin32Sound()
 {
     fCurrVolume = 1.0f;
     fDesiredVol = 1.0f;
@@ -56,7 +57,11 @@ plWin32VideoSound::plWin32VideoSound(const plWAVHeader& header) : plWin32Sound()
     fType = kGUISound;
 
     fWAVHeader = header;
-    fDSoundBuffer = new plDSoundBuffer(0, fWAVHeader, false, false);
+    fDSoundBuffer = new plDSoundBuffer(0, fWAVHeader, false, false, false, streaming);
+    if (streaming) {
+        fDSoundBuffer->SetupVoiceSource();
+        fDSoundBuffer->SetScalarVolume(1.0f);
+    }
 
     uniqueID++;
     hsgResMgr::ResMgr()->NewKey(ST::format("videosound#{}", uniqueID), this, plLocation::kGlobalFixedLoc);
@@ -88,6 +93,26 @@ void plWin32VideoSound::FillSoundBuffer(void* buffer, size_t size)
     fDSoundBuffer->SetScalarVolume(1.0f);
 }
 
+size_t plWin32VideoSound::QueueSoundData(const void* buffer, size_t size, bool flush)
+{
+    const uint8_t* data = static_cast<const uint8_t*>(buffer);
+    size_t queued = 0;
+    unsigned bufferId;
+
+    fDSoundBuffer->UnQueueVoiceBuffers();
+    while (queued < size) {
+        size_t chunk = std::min<size_t>(size - queued, STREAM_BUFFER_SIZE);
+        if (chunk < STREAM_BUFFER_SIZE && !flush)
+            break;
+        if (!fDSoundBuffer->GetAvailableBufferId(&bufferId))
+            break;
+
+        fDSoundBuffer->VoiceFillBuffer(data + queued, chunk, bufferId);
+        queued += chunk;
+    }
+    return queued;
+}
+
 void plWin32VideoSound::IDerivedActuallyPlay()
 {
     if (!fReallyPlaying) {
@@ -49,13 +49,21 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 class plWin32VideoSound : public plWin32Sound
 {
 public:
-    plWin32VideoSound(const plWAVHeader& header);
+    plWin32VideoSound(const plWAVHeader& header, bool streaming = false);
     virtual ~plWin32VideoSound();
 
     void Play() override;
     virtual void Pause(bool on);
     void FillSoundBuffer(void* buffer, size_t size);
 
+    /**
+     * Queues PCM data onto a streaming sound, starting playback if it ran dry.
+     * Only whole STREAM_BUFFER_SIZE chunks are taken unless flush is set, so
+     * a handful of small packets don't use up all of the streaming buffers.
+     * \returns the number of bytes queued; the caller keeps the rest.
+     */
+    size_t QueueSoundData(const void* buffer, size_t size, bool flush = false);
+
 protected:
     void IDerivedActuallyPlay() override;
     bool LoadSound(bool is3D) override;
@@ -58,6 +58,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "hsQuat.h"
 #include "hsTimer.h"
 #include "plPipeline.h"
+#include "plProfile.h"
 #include "plTweak.h"
 
 // other
@@ -117,6 +118,15 @@ static const ST::string kPersonalLinkAnimName = ST_LITERAL("PersonalLink");
 
 int plArmatureModBase::fMinLOD = 0;     // standard is 3 levels of LOD
 double plArmatureModBase::fLODDistance = 50.0;
+bool plArmatureModBase::fCrowdMode = false;
+float plArmatureModBase::fCrowdHalfDistance = 30.f;
+float plArmatureModBase::fCrowdQuarterDistance = 60.f;
+
+plProfile_CreateCounter("AvUpdateFull", "Avatar", AvUpdateFull);
+plProfile_CreateCounter("AvUpdateHalf", "Avatar", AvUpdateHalf);
+plProfile_CreateCounter("AvUpdateQuarter", "Avatar", AvUpdateQuarter);
+plProfile_CreateCounter("AvUpdateOffscreen", "Avatar", AvUpdateOffscreen);
+plProfile_CreateCounter("AvUpdateSkipped", "Avatar", AvUpdateSkipped);
 
 
 plArmatureModBase::plArmatureModBase() :
@@ -125,7 +135,11 @@ plArmatureModBase::plArmatureModBase() :
     fCurLOD(-1),
     fRootAnimator(),
     fDisabledPhysics(),
-    fDisabledDraw()
+    fDisabledDraw(),
+    fUpdateRate(kUpdateFull),
+    fCrowdFrame(),
+    fCrowdElapsed(),
+    fCrowdSkipped()
 {
 }
 
@@ -184,11 +198,50 @@ bool plArmatureModBase::IEval(double time, float elapsed, uint32_t dirty)
             plArmatureBrain *curBrain = fBrains.back();
             if (curBrain)
             {
-                bool result = curBrain->Apply(time, elapsed);
-                if (!result)
+                UpdateRate rate = IPickUpdateRate();
+                uint32_t interval = 1 << rate;
+                if (rate != fUpdateRate)
+                {
+                    // Stagger throttled avatars so they don't all evaluate on the same frame
+                    fUpdateRate = rate;
+                    fCrowdFrame = (uint32_t)(reinterpret_cast<uintptr_t>(this) >> 6) % interval;
+                    fCrowdBones.clear();
+                }
+                else
+                    fCrowdFrame++;
+
+                fCrowdElapsed += elapsed;
+                fCrowdSkipped = fCrowdFrame % interval != 0;
+
+                switch (rate)
                 {
-                    PopBrain();
-                    delete curBrain;
+                case kUpdateFull:       plProfile_Inc(AvUpdateFull);        break;
+                case kUpdateHalf:       plProfile_Inc(AvUpdateHalf);        break;
+                case kUpdateQuarter:    plProfile_Inc(AvUpdateQuarter);     break;
+                default:                plProfile_Inc(AvUpdateOffscreen);   break;
+                }
+
+                if (fCrowdSkipped)
+                {
+                    IBlendCrowdPose(float(fCrowdFrame % interval) / float(interval));
+                    plProfile_Inc(AvUpdateSkipped);
+                }
+                else
+                {
+                    if (rate != kUpdateFull)
+                        ICaptureCrowdFrom();
+
+                    bool result = curBrain->Apply(time, fCrowdElapsed);
+                    fCrowdElapsed = 0.f;
+                    fCrowdFrame = 0;
+                    if (!result)
+                    {
+                        PopBrain();
+                        delete curBrain;
+                        fCrowdBones.clear();
+                    }
+                    else if (rate != kUpdateFull)
+                        ICaptureCrowdTo();
                 }
             }
         }
@@ -437,6 +490,98 @@ void plArmatureModBase::AdjustLOD()
     }
 }
 
+plArmatureModBase::UpdateRate plArmatureModBase::IPickUpdateRate() const
+{
+    if (!fCrowdMode || fBrains.size() != 1)
+        return kUpdateFull;
+
+    // The local avatar drives the camera, input and physics feedback; never throttle it.
+    if (plAvatarMgr::GetInstance()->GetLocalAvatar() == this)
+        return kUpdateFull;
+
+    const plSceneObject* SO = GetTarget(0);
+    if (!SO || !plVirtualCam1::Instance())
+        return kUpdateFull;
+
+    hsPoint3 ourPos = SO->GetLocalToWorld().GetTranslate();
+
+    plPipeline* pipe = plVirtualCam1::Instance()->GetPipeline();
+    if (pipe)
+    {
+        // A loose box around a standing avatar is plenty for a visibility guess.
+        hsPoint3 corners[2] = { ourPos + hsVector3(-3.f, -3.f, 0.f), ourPos + hsVector3(3.f, 3.f, 7.f) };
+        hsBounds3Ext bnd;
+        bnd.Reset(2, corners);
+        if (!pipe->TestVisibleWorld(bnd))
+            return kUpdateOffscreen;
+    }
+
+    float distSq = hsVector3(ourPos - plVirtualCam1::Instance()->GetCameraPos()).MagnitudeSquared();
+    if (distSq > fCrowdQuarterDistance * fCrowdQuarterDistance)
+        return kUpdateQuarter;
+    if (distSq > fCrowdHalfDistance * fCrowdHalfDistance)
+        return kUpdateHalf;
+    return kUpdateFull;
+}
+
+// Record the pose we're showing now, just before a throttled evaluation.
+// If the previous update is still around, interpolate from its pose instead.
+void plArmatureModBase::ICaptureCrowdFrom()
+{
+    const plSceneObject* SO = GetTarget(0);
+    const plCoordinateInterface* rootCI = SO ? SO->GetCoordinateInterface() : nullptr;
+
+    std::vector<CrowdBone> bones;
+    bones.reserve(fChannelMods.size());
+    for (plChannelModMap::const_iterator i = fChannelMods.begin(); i != fChannelMods.end(); i++)
+    {
+        // The root transform belongs to the physical controller, leave it alone
+        plSceneObject* boneSO = i->second->GetTarget(0);
+        plCoordinateInterface* CI = boneSO ? (plCoordinateInterface*)boneSO->GetCoordinateInterface() : nullptr;
+        if (!CI || CI == rootCI)
+            continue;
+
+        CrowdBone bone;
+        bone.fCI = CI;
+        if (bones.size() < fCrowdBones.size() && fCrowdBones[bones.size()].fCI == CI)
+            bone.fFrom = fCrowdBones[bones.size()].fTo;
+        else
+            bone.fFrom = CI->GetLocalToParent();
+        bones.push_back(bone);
+    }
+    fCrowdBones.swap(bones);
+}
+
+// Grab the freshly evaluated pose, then put the bones back where they were.
+// The display lags one update interval so that the skipped frames can
+// interpolate toward a known pose instead of guessing ahead.
+void plArmatureModBase::ICaptureCrowdTo()
+{
+    for (CrowdBone& bone : fCrowdBones)
+        bone.fTo = bone.fCI->GetLocalToParent();
+    IBlendCrowdPose(0.f);
+}
+
+void plArmatureModBase::IBlendCrowdPose(float t)
+{
+    for (const CrowdBone& bone : fCrowdBones)
+    {
+        // Poses a few frames apart are close enough that a straight
+        // component lerp doesn't visibly shear the rotation.
+        hsMatrix44 l2p;
+        for (int i = 0; i < 4; i++)
+        {
+            for (int j = 0; j < 4; j++)
+                l2p.fMap[i][j] = bone.fFrom.fMap[i][j] + (bone.fTo.fMap[i][j] - bone.fFrom.fMap[i][j]) * t;
+        }
+        l2p.NotIdentity();
+
+        hsMatrix44 p2l;
+        l2p.GetInverse(&p2l);
+        bone.fCI->SetLocalToParent(l2p, p2l);
+    }
+}
+
 // Should always be called from AdjustLOD
 bool plArmatureModBase::SetLOD(int iNewLOD)
 {
@@ -1572,6 +1717,9 @@ bool plArmatureMod::IEval(double time, float elapsed, uint32_t dirty)
         if (!fMidLink)
             plArmatureModBase::IEval(time, elapsed, dirty);
         
+        // Sent every frame, even when the crowd throttle skipped the pose
+        // evaluation: the avatar is still moving, and listeners like ripples,
+        // wakes and footprints track its position through this.
         fUpdateMsg->Ref();
         fUpdateMsg->Send();
 
@@ -58,6 +58,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "HeadSpin.h"
 #include "hsBitVector.h"
+#include "hsMatrix44.h"
 
 #include <vector>
 
@@ -133,6 +134,18 @@ public:
     int     AppendMeshKey(plKey meshKey);
     int     AppendBoneVec(plKeyVector *boneVec);
     uint8_t   GetNumLOD() const;
+
+    // Crowd mode: remote avatars that are far away or offscreen evaluate their
+    // animation every few frames and interpolate their bones in between.
+    enum UpdateRate
+    {
+        kUpdateFull,            // every frame
+        kUpdateHalf,            // every 2nd frame
+        kUpdateQuarter,         // every 4th frame
+        kUpdateOffscreen,       // every 8th frame
+        kNumUpdateRates
+    };
+    UpdateRate GetUpdateRate() const { return fUpdateRate; }
     
     // A collection of reasons (flags) that things might be disabled. When all flags are gone
     // The object is re-enabled.
@@ -158,11 +171,18 @@ public:
 
     static int fMinLOD;                     // throttle for lowest-indexed LOD
     static double fLODDistance;             // Distance for first LOD switch 2nd is 2x this distance (for now)
+    static bool fCrowdMode;                 // throttle animation updates of distant/offscreen avatars
+    static float fCrowdHalfDistance;        // beyond this, animate at half rate
+    static float fCrowdQuarterDistance;     // beyond this, animate at quarter rate
     
 protected:
     virtual void IFinalize();
     virtual void ICustomizeApplicator();
     void IEnableBones(int lod, bool enable);
+    UpdateRate IPickUpdateRate() const;
+    void ICaptureCrowdFrom();
+    void ICaptureCrowdTo();
+    void IBlendCrowdPose(float t);
         
     // Some of these flags are only needed by derived classes, but I just want
     // the one waitFlags variable.
@@ -186,6 +206,18 @@ protected:
     std::vector<plKeyVector*> fUnusedBones;
     uint16_t fDisabledPhysics;
     uint16_t fDisabledDraw;
+
+    struct CrowdBone
+    {
+        plCoordinateInterface* fCI;
+        hsMatrix44 fFrom;
+        hsMatrix44 fTo;
+    };
+    std::vector<CrowdBone> fCrowdBones;
+    UpdateRate fUpdateRate;
+    uint32_t fCrowdFrame;       // frames since the last evaluated update
+    float fCrowdElapsed;        // time accumulated over skipped frames
+    bool fCrowdSkipped;
 };
 
 class plArmatureMod : public plArmatureModBase
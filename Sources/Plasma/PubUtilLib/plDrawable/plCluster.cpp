@@ -186,16 +186,15 @@ void plCluster::UnPack(uint8_t* vDst, uint16_t* iDst, int idxOffset, hsBounds3Ex
             GetInst(i).WorldToLocal().GetTranspose(&w2l);
             
             const int numVerts = templ.NumVerts();
+            l2w.MapPoints(numVerts, vDst + posOff, stride, vDst + posOff, stride);
+            w2l.MapVectors(numVerts, vDst + normOff, stride, vDst + normOff, stride);
+
             int iVert;
             for( iVert = 0; iVert < numVerts; iVert++ )
             {
-                hsPoint3* pos = (hsPoint3*)(vDst + posOff);
-                *pos = l2w * *pos;
+                const hsPoint3* pos = (const hsPoint3*)(vDst + posOff);
                 inlTESTPOINT(*pos, minX, minY, minZ, maxX, maxY, maxZ);
 
-                hsVector3* norm = (hsVector3*)(vDst + normOff);
-                *norm = w2l * *norm;
-
                 vDst += stride;
             }
         }
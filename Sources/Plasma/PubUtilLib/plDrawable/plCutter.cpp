@@ -42,6 +42,10 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "HeadSpin.h"
 #include "plCutter.h"
+
+#include <algorithm>
+#include <cfloat>
+
 #include "plAccessSpan.h"
 #include "hsFastMath.h"
 #include "plAccessGeometry.h"
@@ -886,6 +890,30 @@ void plCutter::Cutout(const plAccessSpan& src, std::vector<plCutoutPoly>& dst) c
     }
 }
 
+// Same as above, but the triangles have already been pulled into world space,
+// and only the ones near our bounds are looked at.
+void plCutter::Cutout(const plCutoutCache& src, std::vector<plCutoutPoly>& dst) const
+{
+    static std::vector<uint32_t> tris;
+    src.GatherTris(fWorldBounds, tris);
+
+    for (uint32_t iTri : tris)
+    {
+        const plCutoutCache::Tri& tri = src.GetTri(iTri);
+
+        // Do a polygon clip of tri to box
+        static std::vector<plCutoutVtx> poly;
+        poly.assign(tri.fVerts, tri.fVerts + 3);
+
+        // If we got a polygon
+        if( IPolyClip(poly, tri.fClipPos) )
+        {
+            // tessalate the polygon into dst
+            IConstruct(dst, poly, src.BaseHasAlpha());
+        }
+    }
+}
+
 void plCutter::IConstruct(std::vector<plCutoutPoly>& dst, std::vector<plCutoutVtx>& poly, bool baseHasAlpha) const
 {
     plCutoutPoly& dstPoly = dst.emplace_back();
@@ -895,6 +923,201 @@ void plCutter::IConstruct(std::vector<plCutoutPoly>& dst, std::vector<plCutoutVt
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
+static const float kCutoutCellSize = 4.f;
+static const int kMaxCutoutCells = 64;
+
+plCutoutCache::plCutoutCache()
+:   fNumCellsX(),
+    fNumCellsY(),
+    fMinX(),
+    fMinY(),
+    fCellSize(kCutoutCellSize),
+    fNumSrcTris(),
+    fWaterHeight(),
+    fHasWaterHeight(),
+    fBaseHasAlpha(),
+    fStamp()
+{
+}
+
+void plCutoutCache::Reset()
+{
+    fTris.clear();
+    fCellStart.clear();
+    fCellTris.clear();
+    fStamps.clear();
+    fNumCellsX = fNumCellsY = 0;
+    fNumSrcTris = 0;
+}
+
+bool plCutoutCache::IsValid(const plAccessSpan& src) const
+{
+    if( !src.HasAccessTri() || src.AccessTri().TriCount() != fNumSrcTris )
+        return false;
+    if( src.HasWaterHeight() != fHasWaterHeight )
+        return false;
+    if( fHasWaterHeight && src.GetWaterHeight() != fWaterHeight )
+        return false;
+    if( src.GetLocalToWorld() != fLocalToWorld )
+        return false;
+
+    const hsBounds3Ext& bnd = src.GetWorldBounds();
+    return bnd.GetMins() == fWorldBounds.GetMins() && bnd.GetMaxs() == fWorldBounds.GetMaxs();
+}
+
+// Bakes out exactly what plCutter::Cutout() would feed IPolyClip for each
+// triangle, for each of its transformed/water height flavors.
+void plCutoutCache::Build(const plAccessSpan& src)
+{
+    Reset();
+    if( !src.HasAccessTri() )
+        return;
+
+    fLocalToWorld = src.GetLocalToWorld();
+    fWorldBounds = src.GetWorldBounds();
+    fNumSrcTris = src.AccessTri().TriCount();
+    fHasWaterHeight = src.HasWaterHeight();
+    fWaterHeight = fHasWaterHeight ? src.GetWaterHeight() : 0.f;
+    fBaseHasAlpha = 0 != (src.GetMaterial()->GetLayer(0)->GetBlendFlags() & hsGMatState::kBlendAlpha);
+
+    const bool xform = !(fLocalToWorld.fFlags & hsMatrix44::kIsIdent);
+    hsMatrix44 l2wNorm;
+    src.GetWorldToLocal().GetTranspose(&l2wNorm);
+    const hsVector3 up(0.f, 0.f, 1.f);
+
+    fTris.reserve(fNumSrcTris);
+
+    float minX = FLT_MAX, minY = FLT_MAX;
+    float maxX = -FLT_MAX, maxY = -FLT_MAX;
+
+    plAccTriIterator tri(&src.AccessTri());
+    for( tri.Begin(); tri.More(); tri.Advance() )
+    {
+        Tri& dst = fTris.emplace_back();
+        for (int i = 0; i < 3; i++)
+        {
+            hsPoint3 pos = tri.Position(i);
+            hsPoint3 clip = fHasWaterHeight ? hsPoint3(pos.fX, pos.fY, fWaterHeight) : pos;
+            hsVector3 norm = fHasWaterHeight ? up : tri.Normal(i);
+            if( xform )
+            {
+                pos = fLocalToWorld * pos;
+                clip = fLocalToWorld * clip;
+                norm = l2wNorm * norm;
+            }
+            dst.fVerts[i].Init(pos, norm, tri.DiffuseRGBA(i));
+            dst.fClipPos[i] = clip;
+
+            minX = std::min(minX, clip.fX);
+            minY = std::min(minY, clip.fY);
+            maxX = std::max(maxX, clip.fX);
+            maxY = std::max(maxY, clip.fY);
+        }
+    }
+    if( fTris.empty() )
+        return;
+
+    // Grow the cells on really big spans rather than make a huge grid.
+    fMinX = minX;
+    fMinY = minY;
+    float extent = std::max(maxX - minX, maxY - minY);
+    fCellSize = std::max(kCutoutCellSize, extent / float(kMaxCutoutCells));
+    fNumCellsX = std::min(kMaxCutoutCells, int((maxX - minX) / fCellSize) + 1);
+    fNumCellsY = std::min(kMaxCutoutCells, int((maxY - minY) / fCellSize) + 1);
+
+    // Count, then fill, each triangle into every cell its footprint touches.
+    fCellStart.assign(fNumCellsX * fNumCellsY + 1, 0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (uint32_t iTri = 0; iTri < fTris.size(); iTri++)
+        {
+            const hsPoint3* p = fTris[iTri].fClipPos;
+            int x0, x1, y0, y1;
+            ICellRange(std::min({ p[0].fX, p[1].fX, p[2].fX }), std::max({ p[0].fX, p[1].fX, p[2].fX }), fMinX, fNumCellsX, x0, x1);
+            ICellRange(std::min({ p[0].fY, p[1].fY, p[2].fY }), std::max({ p[0].fY, p[1].fY, p[2].fY }), fMinY, fNumCellsY, y0, y1);
+            for (int y = y0; y <= y1; y++)
+            {
+                for (int x = x0; x <= x1; x++)
+                {
+                    int cell = y * fNumCellsX + x;
+                    if( pass == 0 )
+                        fCellStart[cell + 1]++;
+                    else
+                        fCellTris[fCellStart[cell]++] = iTri;
+                }
+            }
+        }
+
+        if( pass == 0 )
+        {
+            for (size_t c = 1; c < fCellStart.size(); c++)
+                fCellStart[c] += fCellStart[c - 1];
+            fCellTris.resize(fCellStart.back());
+        }
+        else
+        {
+            // The fill advanced each start to the next cell's start, shift back.
+            for (size_t c = fCellStart.size() - 1; c > 0; c--)
+                fCellStart[c] = fCellStart[c - 1];
+            fCellStart[0] = 0;
+        }
+    }
+
+    fStamps.assign(fTris.size(), 0);
+    fStamp = 0;
+}
+
+void plCutoutCache::ICellRange(float lo, float hi, float base, int numCells, int& first, int& last) const
+{
+    first = std::clamp(int((lo - base) / fCellSize), 0, numCells - 1);
+    last = std::clamp(int((hi - base) / fCellSize), 0, numCells - 1);
+}
+
+void plCutoutCache::GatherTris(const hsBounds3Ext& bnd, std::vector<uint32_t>& tris) const
+{
+    tris.clear();
+    if( fTris.empty() )
+        return;
+
+    const hsPoint3& lo = bnd.GetMins();
+    const hsPoint3& hi = bnd.GetMaxs();
+    if( hi.fX < fMinX || hi.fY < fMinY
+        || lo.fX > fMinX + fNumCellsX * fCellSize || lo.fY > fMinY + fNumCellsY * fCellSize )
+        return;
+
+    // Stamp the triangles as we go, so ones spanning several cells only go in once.
+    if( ++fStamp == 0 )
+    {
+        std::fill(fStamps.begin(), fStamps.end(), 0);
+        fStamp = 1;
+    }
+
+    int x0, x1, y0, y1;
+    ICellRange(lo.fX, hi.fX, fMinX, fNumCellsX, x0, x1);
+    ICellRange(lo.fY, hi.fY, fMinY, fNumCellsY, y0, y1);
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            int cell = y * fNumCellsX + x;
+            for (uint32_t i = fCellStart[cell]; i < fCellStart[cell + 1]; i++)
+            {
+                uint32_t iTri = fCellTris[i];
+                if( fStamps[iTri] != fStamp )
+                {
+                    fStamps[iTri] = fStamp;
+                    tris.push_back(iTri);
+                }
+            }
+        }
+    }
+
+    // Keep the same order a full cutout would produce.
+    std::sort(tris.begin(), tris.end());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
 bool plCutter::CutoutGrid(int nWid, int nLen, plFlatGridMesh& grid) const
 {
     hsVector3 halfU = fDirU * (fLengthU * fLengthU * 0.5f);
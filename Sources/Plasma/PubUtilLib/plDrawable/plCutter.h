@@ -49,6 +49,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "hsGeometry3.h"
 #include "hsBounds.h"
+#include "hsMatrix44.h"
 #include "plIntersect/plVolumeIsect.h"
 #include "hsColorRGBA.h"
 
@@ -95,6 +96,59 @@ struct plFlatGridMesh
     void Reset() { fVerts.clear(); fIdx.clear(); }
 };
 
+// plCutoutCache - a world space copy of one target span's triangles, binned
+// into a coarse grid over X and Y. Footprints and ripples keep landing in the
+// same few places, so cutting against the cache only visits the triangles
+// near the cutter instead of transforming and clipping the whole span again.
+class plCutoutCache
+{
+public:
+    struct Tri
+    {
+        plCutoutVtx fVerts[3];
+        hsPoint3    fClipPos[3];    // What IPolyClip tests against (flattened for water)
+    };
+
+protected:
+    std::vector<Tri>        fTris;
+
+    // Cell c holds fCellTris[fCellStart[c]..fCellStart[c+1]).
+    std::vector<uint32_t>   fCellStart;
+    std::vector<uint32_t>   fCellTris;
+    int                     fNumCellsX;
+    int                     fNumCellsY;
+    float                   fMinX;
+    float                   fMinY;
+    float                   fCellSize;
+
+    // Source state we were built from, to catch the span changing under us.
+    hsMatrix44              fLocalToWorld;
+    hsBounds3Ext            fWorldBounds;
+    uint32_t                fNumSrcTris;
+    float                   fWaterHeight;
+    bool                    fHasWaterHeight;
+    bool                    fBaseHasAlpha;
+
+    mutable std::vector<uint32_t>   fStamps;
+    mutable uint32_t                fStamp;
+
+    void    ICellRange(float lo, float hi, float base, int numCells, int& first, int& last) const;
+
+public:
+    plCutoutCache();
+
+    void    Build(const plAccessSpan& src);
+    bool    IsValid(const plAccessSpan& src) const;
+    void    Reset();
+
+    // Indices of all triangles in cells overlapping bnd, in ascending order.
+    void    GatherTris(const hsBounds3Ext& bnd, std::vector<uint32_t>& tris) const;
+
+    const Tri&  GetTri(uint32_t i) const { return fTris[i]; }
+    size_t      GetNumTris() const { return fTris.size(); }
+    bool        BaseHasAlpha() const { return fBaseHasAlpha; }
+};
+
 class plCutter : public plCreatable
 {
 protected:
@@ -155,6 +209,7 @@ public:
     void        Set(const hsPoint3& pos, const hsVector3& dir, const hsVector3& out, bool flip=false);
 
     void        Cutout(const plAccessSpan& src, std::vector<plCutoutPoly>& dst) const;
+    void        Cutout(const plCutoutCache& src, std::vector<plCutoutPoly>& dst) const;
     bool        CutoutGrid(int nWid, int nLen, plFlatGridMesh& dst) const;
 
     void        SetLength(const hsVector3& s) { fLengthU = s.fX; fLengthV = s.fY; fLengthW = s.fZ; }
@@ -61,6 +61,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plPipeline.h"
 #include "plProfile.h"
 #include "hsResMgr.h"
+#include "hsJobSystem.h"
 #include "hsStream.h"
 
 
@@ -521,6 +522,22 @@ plDrawable& plDrawableSpans::SetTransform( uint32_t index, const hsMatrix44& l2w
 #ifdef MF_TEST_UPDATE
             plProfile_IncCount(DSRegSpans, spans->GetCount());
 #endif // MF_TEST_UPDATE
+            // All these spans share l2w, so their bounds go through it in batches
+            constexpr size_t kBoundsBatch = 32;
+            const hsBounds3Ext* localBnds[kBoundsBatch];
+            hsBounds3Ext* worldBnds[kBoundsBatch];
+            for (size_t first = 0; first < spans->GetCount(); first += kBoundsBatch)
+            {
+                const size_t n = std::min(spans->GetCount() - first, kBoundsBatch);
+                for (size_t i = 0; i < n; i++)
+                {
+                    plSpan* mSpan = fSpans[(*spans)[first + i]];
+                    localBnds[i] = &mSpan->fLocalBounds;
+                    worldBnds[i] = &mSpan->fWorldBounds;
+                }
+                hsBounds3Ext::TransformBatch(l2w, n, localBnds, worldBnds);
+            }
+
             for (size_t i = 0; i < spans->GetCount(); i++)
             {           
 #ifdef MF_TEST_UPDATE
@@ -532,9 +549,6 @@ plDrawable& plDrawableSpans::SetTransform( uint32_t index, const hsMatrix44& l2w
                 mSpan->fLocalToWorld = l2w;
                 mSpan->fWorldToLocal = w2l;
 
-                mSpan->fWorldBounds = mSpan->fLocalBounds;
-                mSpan->fWorldBounds.Transform( &l2w );
-
                 if (fSourceSpans.size() > idx)
                 {
                     /// If we have a geoSpan for this, update its transform as well,
@@ -1495,17 +1509,18 @@ void    plDrawableSpans::SortSpan( uint32_t index, plPipeline *pipe )
     plProfile_BeginLap(FaceSort, "0");
 
     plIcicle            *span = (plIcicle *)fSpans[ index ];
-    plGBufferTriangle   *list, temp;
+    plGBufferTriangle   *list;
     uint32_t              numTris;
-    int                 i;
+    uint32_t              i;
     hsMatrix44          w2cMatrix = pipe->GetWorldToCamera() * pipe->GetLocalToWorld();
-    float            dist;
 
     ICheckSpanForSortable(index);
 
-    static std::vector<hsRadixSort::Elem>  sortList;
-    static std::vector<uint16_t>           tempTriList;
-    hsRadixSort::Elem                   *elem;
+    // Per thread rather than shared, so this stays reentrant
+    static thread_local std::vector<hsRadixSort::Pair>  sortList;
+    static thread_local std::vector<hsRadixSort::Pair>  sortScratch;
+    static thread_local std::vector<plGBufferTriangle>  sortedTris;
+    static thread_local std::vector<uint16_t>           tempTriList;
 
 
     /// Get some stuff
@@ -1518,8 +1533,9 @@ void    plDrawableSpans::SortSpan( uint32_t index, plPipeline *pipe )
 
     /// Sort the triangles in "list"
     sortList.resize(numTris);
+    sortScratch.resize(numTris);
+    sortedTris.resize(numTris);
     tempTriList.resize(numTris * 3);
-    elem = sortList.data();
 
     plProfile_EndLap(FaceSort, "0");
     plProfile_BeginLap(FaceSort, "1");
@@ -1527,36 +1543,35 @@ void    plDrawableSpans::SortSpan( uint32_t index, plPipeline *pipe )
     hsVector3 vec(w2cMatrix.fMap[2][0], w2cMatrix.fMap[2][1], w2cMatrix.fMap[2][2]);
     float trans = w2cMatrix.fMap[2][3];
 
-    // Fill out the radix sort elements with our data
-    for( i = 0; i < numTris; i++ )
-    {
-        dist = vec.InnerProduct(list[ i ].fCenter) + trans;
-        elem[ i ].fKey.fFloat = dist;
-        elem[ i ].fBody = (intptr_t)&list[ i ];
-        elem[ i ].fNext = elem + i + 1;
-    }
-    elem[i - 1].fNext = nullptr;
+    // Camera depth of every triangle center
+    hsRadixSort::DepthKeys(&list[0].fCenter, sizeof(plGBufferTriangle), numTris,
+                           vec, trans, sortList.data(), 0);
 
     plProfile_EndLap(FaceSort, "1");
     plProfile_BeginLap(FaceSort, "2");
 
     // Do da sort thingy
-    hsRadixSort         rad;
-    hsRadixSort::Elem   *sortedList = rad.Sort( elem, 0 );
+    hsRadixSort::SortPairs(sortList.data(), sortScratch.data(), numTris);
 
     plProfile_EndLap(FaceSort, "2");
     plProfile_BeginLap(FaceSort, "3");
 
     uint16_t* indices = tempTriList.data();
     // Stuff into the temp array
-    for( i = 0, elem = sortedList; i < numTris; i++ )
+    for( i = 0; i < numTris; i++ )
     {
-        *indices++ = ((plGBufferTriangle *)elem->fBody)->fIndex1;
-        *indices++ = ((plGBufferTriangle *)elem->fBody)->fIndex2;
-        *indices++ = ((plGBufferTriangle *)elem->fBody)->fIndex3;
-        elem = elem->fNext;
+        const plGBufferTriangle& tri = list[ sortList[ i ].fIndex ];
+        *indices++ = tri.fIndex1;
+        *indices++ = tri.fIndex2;
+        *indices++ = tri.fIndex3;
+        sortedTris[ i ] = tri;
     }
 
+    /// Copy back our new, sorted list to our original array. The order
+    /// rarely changes much from one call to the next, and when it doesn't
+    /// change at all SortPairs can skip the sort entirely.
+    memcpy( list, sortedTris.data(), numTris * sizeof( plGBufferTriangle ) );
+
     plProfile_EndLap(FaceSort, "3");
     plProfile_BeginLap(FaceSort, "4");
 
@@ -1564,13 +1579,6 @@ void    plDrawableSpans::SortSpan( uint32_t index, plPipeline *pipe )
     fGroups[ span->fGroupIdx ]->StuffFromTriList( span->fIBufferIdx, span->fIStartIdx, 
                                                   numTris, tempTriList.data());
 
-    /// Optional step in a way: copy back our new, sorted list to our original
-    /// array. This lets us do less sorting next call, since the order should
-    /// remain largely unchanged from the last call. If this turns out NOT to
-    /// be the case, or if the sorting step takes less time than this copy,
-    /// take this out!
-//  memcpy( list, tempTriList.AcquireArray(), numTris * sizeof( plGBufferTriangle ) );
-
     /// All done! (force buffer groups to refresh during next render call)
     fReadyToRender = false;
 
@@ -1781,9 +1789,7 @@ void plDrawableSpans::SortVisibleSpans(const std::vector<int16_t>& visList, plPi
 
     plProfile_BeginTiming(FaceSort);
 
-    static std::vector<hsRadixSort::Elem> sortScratch;
     static std::vector<uint16_t> triList;
-    static std::vector<int32_t> counters;
     static std::vector<uint32_t> startIndex;
     
     if( pipe->IsDebugFlagSet( plPipeDbg::kFlagDontSortFaces ) )
@@ -1820,10 +1826,19 @@ void plDrawableSpans::SortVisibleSpans(const std::vector<int16_t>& visList, plPi
 
     startIndex.resize(fSpans.size());
 
-    // First figure out the total number of tris to deal with.
+    // First figure out the total number of tris to deal with, and split the
+    // spans up into chunks of roughly kTriCutoff triangles. Each span lands in
+    // exactly one chunk, so chunks write to their own parts of triList and
+    // can be sorted independently.
+    const int kTriCutoff = 4000;
+    struct SortChunk { size_t fVisBegin, fVisEnd; };
+    std::vector<SortChunk> chunks;
+
     int totTris = 0;
-    for (int16_t idx : visList)
+    int chunkTris = 0;
+    for (size_t iVis = 0; iVis < visList.size(); iVis++)
     {
+        int16_t idx = visList[iVis];
         plIcicle* span = (plIcicle*)fSpans[idx];
         ICheckSpanForSortable(idx);
         
@@ -1831,6 +1846,13 @@ void plDrawableSpans::SortVisibleSpans(const std::vector<int16_t>& visList, plPi
         if( span->fProps & plSpan::kPropReverseSort )
             startIndex[idx] += span->fILength - 3;
 
+        if (chunks.empty() || chunkTris >= kTriCutoff)
+        {
+            chunks.push_back({ iVis, iVis });
+            chunkTris = 0;
+        }
+        chunks.back().fVisEnd = iVis + 1;
+        chunkTris += span->fILength / 3;
 
         totTris += span->fILength / 3;
     }
@@ -1842,78 +1864,78 @@ void plDrawableSpans::SortVisibleSpans(const std::vector<int16_t>& visList, plPi
 
     plProfile_IncCount(FacesSorted, totTris);
 
-    sortScratch.resize(totTris);
     triList.resize(3 * totTris);
 
-    hsRadixSort::Elem* elem = sortScratch.data();
+    const hsPoint3 viewPosWorld = pipe->GetViewPositionWorld();
 
     plProfile_EndLap(FaceSort, "0");
+    plProfile_BeginLap(FaceSort, "1");
 
-    size_t iVis = 0;
-    while (iVis < visList.size())
+    auto sortChunks = [&](size_t chunkBegin, size_t chunkEnd)
     {
-        plProfile_BeginLap(FaceSort, "1");
+        static thread_local std::vector<hsRadixSort::Pair>     sortList;
+        static thread_local std::vector<hsRadixSort::Pair>     sortScratch;
+        static thread_local std::vector<plGBufferTriangle*>    sortTris;
+        static thread_local std::vector<int32_t>               counters;
 
-        // Pack them into the sort structure. We probably want to make the 
-        // plGBufferTriangle look like plTriSortData (just add span index) 
-        // which would get rid of this copy and help the data alignment.
-        // Oops, I already did.
-        const int kTriCutoff = 4000;
-        int cnt = 0;
-        while ((iVis < visList.size()) && (cnt < kTriCutoff))
-        {
-            plIcicle* span = (plIcicle*)fSpans[visList[iVis]];
-            
-            int nTris = span->fILength / 3;
+        counters.resize(fSpans.size());
 
-            hsPoint3 viewPos = span->fWorldToLocal * pipe->GetViewPositionWorld();
+        for (size_t iChunk = chunkBegin; iChunk < chunkEnd; iChunk++)
+        {
+            const SortChunk& chunk = chunks[iChunk];
 
-            plGBufferTriangle*      list = span->fSortData;
-            int j;
-            for( j = 0; j < nTris; j++ )
+            // Pack them into the sort structure.
+            uint32_t cnt = 0;
+            for (size_t iVis = chunk.fVisBegin; iVis < chunk.fVisEnd; iVis++)
             {
-                float dist = -(viewPos - list[j].fCenter).MagnitudeSquared();
-                elem[cnt].fKey.fFloat = dist;
-                elem[cnt].fBody = (intptr_t)&list[j];
-                elem[cnt].fNext = elem + cnt + 1;
+                int16_t idx = visList[iVis];
+                plIcicle* span = (plIcicle*)fSpans[idx];
+                uint32_t nTris = span->fILength / 3;
+                counters[idx] = 0;
+                if (!nTris)
+                    continue;
 
-                cnt++;
-            }
-            iVis++;
-        }
-        elem[cnt-1].fNext = nullptr;
+                sortList.resize(cnt + nTris);
+                sortTris.resize(cnt + nTris);
 
-        plProfile_EndLap(FaceSort, "1");
-        plProfile_BeginLap(FaceSort, "2");
+                hsPoint3 viewPos = span->fWorldToLocal * viewPosWorld;
 
-        // Actual sort
-        hsRadixSort         rad;
-        hsRadixSort::Elem* sortedList = rad.Sort( elem, 0 );
+                plGBufferTriangle*      list = span->fSortData;
+                hsRadixSort::FarToNearKeys(&list[0].fCenter, sizeof(plGBufferTriangle), nTris,
+                                           viewPos, sortList.data() + cnt, cnt);
+                for (uint32_t j = 0; j < nTris; j++)
+                    sortTris[cnt + j] = &list[j];
 
-        plProfile_EndLap(FaceSort, "2");
-        plProfile_BeginLap(FaceSort, "3");
+                cnt += nTris;
+            }
 
-        counters.assign(fSpans.size(), 0);
+            // Actual sort
+            sortScratch.resize(cnt);
+            hsRadixSort::SortPairs(sortList.data(), sortScratch.data(), cnt);
 
-        while( sortedList )
-        {
-            plGBufferTriangle* data = (plGBufferTriangle*)sortedList->fBody;
-            plIcicle* span = (plIcicle*)fSpans[data->fSpanIndex];
-
-            uint16_t* idx = &triList[startIndex[data->fSpanIndex] + counters[data->fSpanIndex]];
-            *idx++ = data->fIndex1;
-            *idx++ = data->fIndex2;
-            *idx++ = data->fIndex3;
-            if( span->fProps & plSpan::kPropReverseSort )
-                counters[data->fSpanIndex] -= 3;
-            else
-                counters[data->fSpanIndex] += 3;
-            
-            sortedList = sortedList->fNext;
+            for (uint32_t i = 0; i < cnt; i++)
+            {
+                plGBufferTriangle* data = sortTris[sortList[i].fIndex];
+                plIcicle* span = (plIcicle*)fSpans[data->fSpanIndex];
+
+                uint16_t* idx = &triList[startIndex[data->fSpanIndex] + counters[data->fSpanIndex]];
+                *idx++ = data->fIndex1;
+                *idx++ = data->fIndex2;
+                *idx++ = data->fIndex3;
+                if( span->fProps & plSpan::kPropReverseSort )
+                    counters[data->fSpanIndex] -= 3;
+                else
+                    counters[data->fSpanIndex] += 3;
+            }
         }
+    };
 
-        plProfile_EndLap(FaceSort, "3");
-    }
+    if (chunks.size() > 1 && hsJobSystem::InstanceValid())
+        hsJobSystem::Instance().ParallelFor(0, chunks.size(), 1, sortChunks);
+    else
+        sortChunks(0, chunks.size());
+
+    plProfile_EndLap(FaceSort, "1");
 
     plProfile_BeginLap(FaceSort, "4");
 
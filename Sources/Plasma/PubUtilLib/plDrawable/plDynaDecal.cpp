@@ -74,6 +74,7 @@ bool plDynaSplot::Age(double t, float ramp, float decay, float life)
     {
         return false;
     }
+    fFlags |= kDirty;
 
     hsPoint3* origUVW = &fAuxSpan->fOrigUVW[fStartVtx];
 
@@ -207,6 +208,7 @@ bool plDynaRipple::Age(double t, float ramp, float decay, float life)
         }
     }
     fFlags &= ~kFresh;
+    fFlags |= kDirty;
     return false;
 }
 
@@ -287,6 +289,7 @@ bool plDynaWake::Age(double t, float ramp, float decay, float life)
         }
     }
     fFlags &= ~kFresh;
+    fFlags |= kDirty;
     return false;
 }
 
@@ -367,6 +370,7 @@ bool plDynaWave::Age(double t, float ramp, float decay, float life)
         }
     }
     fFlags &= ~kFresh;
+    fFlags |= kDirty;
     return false;
 }
 
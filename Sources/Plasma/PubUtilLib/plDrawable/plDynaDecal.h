@@ -71,7 +71,8 @@ public:
     {
         kFresh          = 0x1,
         kAttenColor     = 0x2,
-        kVertexShader   = 0x4
+        kVertexShader   = 0x4,
+        kDirty          = 0x8   // Age() rewrote our verts, the buffer needs refreshing
     };
 protected:
 
@@ -104,6 +104,8 @@ plProfile_CreateTimerNoReset("Total", "DynaDecal", Total);
 plProfile_CreateTimerNoReset("Cutter", "DynaDecal", Cutter);
 plProfile_CreateTimerNoReset("Process", "DynaDecal", Process);
 plProfile_CreateTimerNoReset("Callback", "DynaDecal", Callback);
+plProfile_CreateCounter("CutCacheHits", "DynaDecal", CutCacheHits);
+plProfile_CreateCounter("CutCacheBuilds", "DynaDecal", CutCacheBuilds);
 
 static const int    kBinBlockSize = 20;
 static const uint16_t kDefMaxNumVerts = 1000;
@@ -115,6 +117,9 @@ static const float kDefRampEnd = kDefLifeSpan * 0.1f;
 
 static const float kInitAuxSpans = 5;
 
+// Roughly 200 bytes a triangle, so this caps the cutout caches around 12MB.
+static const size_t kMaxCutoutCacheTris = 64 * 1024;
+
 #define MF_NO_INIT_ALLOC
 #define MF_NEVER_RUN_OUT
 
@@ -150,7 +155,8 @@ plDynaDecalMgr::plDynaDecalMgr()
     fGridSizeU(2.5f),
     fGridSizeV(2.5f),
     fScale(1.f, 1.f, 1.f),
-    fPartyTime(1.f)
+    fPartyTime(1.f),
+    fCutoutCacheTris()
 {
     fCutter = new plCutter;
 }
@@ -174,6 +180,7 @@ plDynaDecalMgr::~plDynaDecalMgr()
         delete aux;
     }
 
+    IClearCutoutCaches();
     delete fCutter;
 }
 
@@ -416,10 +423,15 @@ bool plDynaDecalMgr::MsgReceive(plMessage* msg)
     }
 
     plAgeLoadedMsg* ageLoadMsg = plAgeLoadedMsg::ConvertNoRef(msg);
-    if( ageLoadMsg && ageLoadMsg->fLoaded ) 
+    if( ageLoadMsg )
     {
-        IGetParticles();
-        return true;
+        // Whatever geometry we had cached is on its way out (or already gone).
+        IClearCutoutCaches();
+        if( ageLoadMsg->fLoaded )
+        {
+            IGetParticles();
+            return true;
+        }
     }
 
     plGenRefMsg* refMsg = plGenRefMsg::ConvertNoRef(msg);
@@ -449,6 +461,7 @@ bool plDynaDecalMgr::MsgReceive(plMessage* msg)
                 auto iter = std::find(fTargets.cbegin(), fTargets.cend(), (plSceneObject*)refMsg->GetRef());
                 if (iter != fTargets.cend())
                     fTargets.erase(iter);
+                IClearCutoutCaches();
             }
             return true;
         case kRefPartyObject:
@@ -843,20 +856,21 @@ plDynaDecal* plDynaDecalMgr::IInitDecal(plAuxSpan* aux, double t, uint16_t numVe
     return fDecals[idx];
 }
 
-void plDynaDecalMgr::IKillDecal(size_t i)
+// Caller is responsible for taking the decal out of fDecals.
+void plDynaDecalMgr::IKillDecal(plDynaDecal* decal)
 {
     // Update this decal's span.
     // Since decals die off in the same order they are created, and we always 
     // append a decal to a span, we only need to advance the span's start indices,
     // and decrement the lengths.
-    plAuxSpan* aux = fDecals[i]->fAuxSpan;
-    aux->fVStartIdx += fDecals[i]->fNumVerts;
+    plAuxSpan* aux = decal->fAuxSpan;
+    aux->fVStartIdx += decal->fNumVerts;
     aux->fGroup->SetVertBufferStart(aux->fVBufferIdx, aux->fVStartIdx);
-    aux->fVLength -= fDecals[i]->fNumVerts;
+    aux->fVLength -= decal->fNumVerts;
 
-    aux->fIStartIdx += fDecals[i]->fNumIdx;
+    aux->fIStartIdx += decal->fNumIdx;
     aux->fGroup->SetIndexBufferStart(aux->fIBufferIdx, aux->fIStartIdx);
-    aux->fILength -= fDecals[i]->fNumIdx;
+    aux->fILength -= decal->fNumIdx;
 
     hsAssert(aux->fGroup->GetVertBufferEnd(aux->fVBufferIdx) >= aux->fGroup->GetVertBufferStart(aux->fVBufferIdx), "Going out of range on verts");
     hsAssert(aux->fGroup->GetIndexBufferEnd(aux->fIBufferIdx) >= aux->fGroup->GetIndexBufferStart(aux->fIBufferIdx), "Going out of range on verts");
@@ -882,8 +896,16 @@ void plDynaDecalMgr::IKillDecal(size_t i)
         aux->fBaseSpanIdx = 0;
     }
 
-    delete fDecals[i];
-    fDecals.erase(fDecals.begin() + i);
+    delete decal;
+}
+
+static void IMarkAuxDirty(std::vector<plAuxSpan*>& dirtyAux, plAuxSpan* aux)
+{
+    // Decals on the same aux span are mostly neighbors, check the last one first.
+    if (!dirtyAux.empty() && dirtyAux.back() == aux)
+        return;
+    if (std::find(dirtyAux.cbegin(), dirtyAux.cend(), aux) == dirtyAux.cend())
+        dirtyAux.emplace_back(aux);
 }
 
 void plDynaDecalMgr::IUpdateDecals(double t)
@@ -891,15 +913,34 @@ void plDynaDecalMgr::IUpdateDecals(double t)
     if( fDisableUpdate )
         return;
 
-    for (size_t i = 0; i < fDecals.size(); )
+    // Age everything in one pass, then drop all the expired decals in a
+    // single sweep instead of erasing them off the front one at a time.
+    // Only the aux spans whose verts actually changed (or lost a decal) get
+    // re-uploaded; splots sitting at full strength between ramp and decay
+    // cost nothing.
+    static std::vector<plAuxSpan*> dirtyAux;
+    dirtyAux.clear();
+
+    bool anyDead = false;
+    for (plDynaDecal*& decal : fDecals)
     {
-        if (fDecals[i]->Age(t, fRampEnd, fDecayStart, fLifeSpan))
-            IKillDecal(i);
-        else
-            ++i;
+        if (decal->Age(t, fRampEnd, fDecayStart, fLifeSpan))
+        {
+            IMarkAuxDirty(dirtyAux, decal->fAuxSpan);
+            IKillDecal(decal);
+            decal = nullptr;
+            anyDead = true;
+        }
+        else if (decal->fFlags & plDynaDecal::kDirty)
+        {
+            decal->fFlags &= ~plDynaDecal::kDirty;
+            IMarkAuxDirty(dirtyAux, decal->fAuxSpan);
+        }
     }
+    if (anyDead)
+        fDecals.erase(std::remove(fDecals.begin(), fDecals.end(), nullptr), fDecals.end());
 
-    for (plAuxSpan* aux : fAuxSpans)
+    for (plAuxSpan* aux : dirtyAux)
     {
         if (aux->fVLength)
             aux->fGroup->DirtyVertexBuffer(aux->fVBufferIdx);
@@ -1401,6 +1442,60 @@ bool plDynaDecalMgr::ICutoutGrid(plDrawableSpans* drawable, int iSpan, hsGMateri
     return IProcessGrid(drawable, iSpan, mat, secs, grid);
 }
 
+const plCutoutCache* plDynaDecalMgr::IGetCutoutCache(const plDrawableSpans* dr, uint32_t spanIdx, const plAccessSpan& src)
+{
+    const plCutoutCacheMap::key_type key(dr, spanIdx);
+    plCutoutCacheMap::iterator iter = fCutoutCaches.find(key);
+    if (iter != fCutoutCaches.end())
+    {
+        if (iter->second->IsValid(src))
+        {
+            plProfile_Inc(CutCacheHits);
+            return iter->second;
+        }
+
+        // Moved, or it's not the span we think it is anymore.
+        fCutoutCacheTris -= iter->second->GetNumTris();
+        delete iter->second;
+        fCutoutCaches.erase(iter);
+    }
+
+    uint32_t numTris = src.AccessTri().TriCount();
+    if (numTris > kMaxCutoutCacheTris)
+        return nullptr;
+
+    if (fCutoutCacheTris + numTris > kMaxCutoutCacheTris)
+        IClearCutoutCaches();
+
+    plCutoutCache* cache = new plCutoutCache;
+    cache->Build(src);
+    fCutoutCacheTris += cache->GetNumTris();
+    fCutoutCaches[key] = cache;
+    plProfile_Inc(CutCacheBuilds);
+
+    return cache;
+}
+
+void plDynaDecalMgr::IClearCutoutCaches()
+{
+    for (const auto& iter : fCutoutCaches)
+        delete iter.second;
+    fCutoutCaches.clear();
+    fCutoutCacheTris = 0;
+}
+
+void plDynaDecalMgr::ICutout(const plDrawableSpans* dr, uint32_t spanIdx, const plAccessSpan& src, std::vector<plCutoutPoly>& dst)
+{
+    if( !src.HasAccessTri() )
+        return;
+
+    const plCutoutCache* cache = IGetCutoutCache(dr, spanIdx, src);
+    if( cache )
+        fCutter->Cutout(*cache, dst);
+    else
+        fCutter->Cutout(src, dst);
+}
+
 bool plDynaDecalMgr::ICutoutObject(plSceneObject* so, double secs)
 {
     if( fDisableAccumulate )
@@ -1437,7 +1532,7 @@ bool plDynaDecalMgr::ICutoutObject(plSceneObject* so, double secs)
                         dst.clear();
 
                         plProfile_BeginTiming(Cutter);
-                        fCutter->Cutout(src, dst);
+                        ICutout(dr, diIndex[k], src, dst);
                         plProfile_EndTiming(Cutter);
 
                         plProfile_BeginTiming(Process);
@@ -1491,7 +1586,7 @@ bool plDynaDecalMgr::ICutoutList(std::vector<plDrawVisList>& drawVis, double sec
 
         plAccessGeometry::Instance()->OpenRO(drawVis[iDraw].fDrawable, drawVis[iDraw].fVisList[iSpan], src[i]);
 
-        fCutter->Cutout(src[i], dst);
+        ICutout((plDrawableSpans*)drawVis[iDraw].fDrawable, drawVis[iDraw].fVisList[iSpan], src[i], dst);
 
         if( IProcessPolys((plDrawableSpans*)drawVis[iDraw].fDrawable, drawVis[iDraw].fVisList[iSpan], secs, dst) )
             retVal = true;
@@ -70,6 +70,7 @@ class hsResMgr;
 class plMessage;
 
 class plCutter;
+class plCutoutCache;
 struct plCutoutPoly;
 struct plFlatGridMesh;
 
@@ -141,6 +142,12 @@ protected:
 
     plCutter*                   fCutter;
 
+    // World space triangles of the spans we've cut before, so repeated
+    // prints in the same area don't walk and transform the whole span.
+    typedef std::map<std::pair<const plDrawableSpans*, uint32_t>, plCutoutCache*> plCutoutCacheMap;
+    plCutoutCacheMap            fCutoutCaches;
+    size_t                      fCutoutCacheTris;
+
     std::vector<plAuxSpan*>     fAuxSpans;
 
     hsGMaterial*                fMatPreShade;
@@ -204,7 +211,7 @@ protected:
 
     virtual size_t      INewDecal() = 0;
     plDynaDecal*        IInitDecal(plAuxSpan* aux, double t, uint16_t numVerts, uint16_t numIdx);
-    void                IKillDecal(size_t i);
+    void                IKillDecal(plDynaDecal* decal);
     void                IUpdateDecals(double t);
 
     void                ICountIncoming(std::vector<plCutoutPoly>& src, uint16_t& numVerts, uint16_t& numIdx) const;
@@ -220,6 +227,10 @@ protected:
     bool                ICutoutGrid(plDrawableSpans* drawable, int iSpan, hsGMaterial* mat, double secs);
     bool                IHitTestFlatGrid(const plFlatGridMesh& grid) const;
 
+    const plCutoutCache* IGetCutoutCache(const plDrawableSpans* dr, uint32_t spanIdx, const plAccessSpan& src);
+    void                IClearCutoutCaches();
+    void                ICutout(const plDrawableSpans* dr, uint32_t spanIdx, const plAccessSpan& src, std::vector<plCutoutPoly>& dst);
+
     bool                ICutoutList(std::vector<plDrawVisList>& drawVis, double secs);
     bool                ICutoutObject(plSceneObject* so, double secs);
     bool                ICutoutTargets(double secs);
@@ -42,6 +42,9 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "HeadSpin.h"
 #include "plMorphDelta.h"
+#include "plMorphDelta_Private.h"
+
+#include <algorithm>
 
 #include "hsStream.h"
 #include "hsMemory.h"
@@ -55,6 +58,56 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 static const float kMinWeight = 1.e-2f;
 
+float plMorphDelta::ActiveWeight(float w)
+{
+    return w > kMinWeight ? w : 0.f;
+}
+
+void plMorphAccum::Reset(uint32_t numVerts, uint16_t numUVWChans)
+{
+    fNumVerts = numVerts;
+    fNumUVWChans = numUVWChans;
+    fPosNorm.assign(size_t(numVerts) * 8, 0.f);
+    fUVWs.assign(size_t(numVerts) * numUVWChans * 4, 0.f);
+    fVerts.clear();
+}
+
+void plMorphAccum::SortVerts()
+{
+    std::sort(fVerts.begin(), fVerts.end());
+    fVerts.erase(std::unique(fVerts.begin(), fVerts.end()), fVerts.end());
+}
+
+void plMorphAccum::Write(const plAccessSpan* base, plAccessSpan& dst) const
+{
+    hsAssert(dst.HasAccessVtx(), "Come on, everyone has vertices");
+    plAccessVtxSpan& vtxDst = dst.AccessVtx();
+    const plAccessVtxSpan& vtxSrc = base ? base->AccessVtx() : vtxDst;
+
+    const uint16_t numUVWs = std::min(fNumUVWChans, vtxDst.NumUVWs());
+    const size_t uvwWidth = size_t(fNumUVWChans) * 4;
+
+    for (uint16_t idx : fVerts)
+    {
+        const float* posNorm = &fPosNorm[size_t(idx) * 8];
+
+        const hsPoint3& pos = vtxSrc.Position(idx);
+        vtxDst.Position(idx).Set(pos.fX + posNorm[0], pos.fY + posNorm[1], pos.fZ + posNorm[2]);
+
+        const hsVector3& norm = vtxSrc.Normal(idx);
+        hsVector3 newNorm(norm.fX + posNorm[3], norm.fY + posNorm[4], norm.fZ + posNorm[5]);
+        newNorm.Normalize();
+        vtxDst.Normal(idx) = newNorm;
+
+        const float* uvwSum = fUVWs.data() + size_t(idx) * uvwWidth;
+        for (uint16_t j = 0; j < numUVWs; j++, uvwSum += 4)
+        {
+            const hsPoint3& uvw = vtxSrc.UVW(idx, j);
+            vtxDst.UVW(idx, j).Set(uvw.fX + uvwSum[0], uvw.fY + uvwSum[1], uvw.fZ + uvwSum[2]);
+        }
+    }
+}
+
 
 plMorphDelta& plMorphDelta::operator=(const plMorphDelta& src)
 {
@@ -112,6 +165,40 @@ void plMorphDelta::Apply(std::vector<plAccessSpan>& dst, float weight /* = -1.f
     }
 }
 
+void plMorphDelta::Accumulate(std::vector<plMorphAccum>& accum, float weight) const
+{
+    if( weight == 0.f )
+        return;
+
+    for (size_t iSpan = 0; iSpan < fSpans.size(); iSpan++)
+    {
+        const plMorphSpan& span = fSpans[iSpan];
+        if (span.fPackIdx.empty())
+            continue;
+
+        plMorphAccum& sums = accum[iSpan];
+        plMorphDeltaKernels::accum_deltas.call(span.fPackIdx.data(), span.fPackPosNorm.data(),
+                                               span.fPackIdx.size(), 8, weight, sums.fPosNorm.data());
+
+        hsAssert(!span.fNumUVWChans || span.fNumUVWChans == sums.fNumUVWChans, "UVW channel mismatch between delta and target");
+        if (span.fNumUVWChans && span.fNumUVWChans == sums.fNumUVWChans)
+        {
+            plMorphDeltaKernels::accum_deltas.call(span.fPackIdx.data(), span.fPackUVWs.data(),
+                                                   span.fPackIdx.size(), size_t(span.fNumUVWChans) * 4,
+                                                   weight, sums.fUVWs.data());
+        }
+    }
+}
+
+void plMorphDelta::CollectVerts(std::vector<plMorphAccum>& accum) const
+{
+    for (size_t iSpan = 0; iSpan < fSpans.size(); iSpan++)
+    {
+        const std::vector<uint16_t>& idx = fSpans[iSpan].fPackIdx;
+        accum[iSpan].fVerts.insert(accum[iSpan].fVerts.end(), idx.cbegin(), idx.cend());
+    }
+}
+
 // MorphDelta - ComputeDeltas
 void plMorphDelta::ComputeDeltas(const std::vector<plAccessSpan>& base, const std::vector<plAccessSpan>& moved)
 {
@@ -257,8 +344,66 @@ void plMorphDelta::SetDeltas(size_t iSpan, const std::vector<plVertDelta>& delta
         if (numUVWChans)
             std::copy(uvws, uvws + (deltas.size() * numUVWChans), fSpans[iSpan].fUVWs);
     }
+    IPackSpan(iSpan);
+}
+
+void plMorphDelta::IPackSpan(size_t iSpan)
+{
+    plMorphSpan& span = fSpans[iSpan];
+    const size_t nDel = span.fDeltas.size();
+    const size_t uvwWidth = size_t(span.fNumUVWChans) * 4;
+
+    span.fPackIdx.resize(nDel);
+    span.fPackPosNorm.assign(nDel * 8, 0.f);
+    span.fPackUVWs.assign(nDel * uvwWidth, 0.f);
+
+    for (size_t i = 0; i < nDel; i++)
+    {
+        const plVertDelta& delta = span.fDeltas[i];
+        span.fPackIdx[i] = delta.fIdx;
+
+        float* posNorm = &span.fPackPosNorm[i * 8];
+        posNorm[0] = delta.fPos.fX;
+        posNorm[1] = delta.fPos.fY;
+        posNorm[2] = delta.fPos.fZ;
+        posNorm[3] = delta.fNorm.fX;
+        posNorm[4] = delta.fNorm.fY;
+        posNorm[5] = delta.fNorm.fZ;
+
+        for (uint16_t j = 0; j < span.fNumUVWChans; j++)
+        {
+            const hsPoint3& uvw = span.fUVWs[i * span.fNumUVWChans + j];
+            float* dst = &span.fPackUVWs[i * uvwWidth + j * 4];
+            dst[0] = uvw.fX;
+            dst[1] = uvw.fY;
+            dst[2] = uvw.fZ;
+        }
+    }
 }
 
+void plMorphDeltaKernels::accum_deltas_fpu(const uint16_t* idx, const float* deltas, size_t count,
+                                           size_t width, float weight, float* sums)
+{
+    for (size_t i = 0; i < count; i++, deltas += width)
+    {
+        float* dst = sums + size_t(idx[i]) * width;
+        for (size_t j = 0; j < width; j++)
+            dst[j] += deltas[j] * weight;
+    }
+}
+
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<plMorphDeltaKernels::accum_deltas_ptr> plMorphDeltaKernels::accum_deltas {
+    &plMorphDeltaKernels::accum_deltas_fpu,
+    nullptr,                                // SSE1
+    &plMorphDeltaKernels::accum_deltas_sse2,
+    nullptr,                                // SSE3
+    nullptr,                                // SSSE3
+    nullptr,                                // SSE41
+    nullptr,                                // SSE42
+    &plMorphDeltaKernels::accum_deltas_avx
+};
+
 void plMorphDelta::Read(hsStream* s, hsResMgr* mgr)
 {
     fWeight = s->ReadLEFloat();
@@ -276,6 +421,7 @@ void plMorphDelta::Read(hsStream* s, hsResMgr* mgr)
             if( nUVW )
                 s->Read(nDel * nUVW * sizeof(hsPoint3), fSpans[iSpan].fUVWs);
         }
+        IPackSpan(iSpan);
     }
 
 }
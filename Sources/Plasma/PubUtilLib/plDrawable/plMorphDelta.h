@@ -71,6 +71,34 @@ struct plMorphSpan
 
     uint16_t                  fNumUVWChans;
     hsPoint3*               fUVWs; // Length is fUVWChans*fDeltas.GetCount() (*sizeof(hsPoint3) in bytes).
+
+    // Runtime copies of the above, split into streams for the accumulate
+    // kernels. Each delta gets an index, then position and normal as
+    // 8 floats (the last two zero), then 4 floats per UVW channel.
+    std::vector<uint16_t>   fPackIdx;
+    std::vector<float>      fPackPosNorm;
+    std::vector<float>      fPackUVWs;
+};
+
+// Running sums of weighted deltas over one span's vertices, laid out
+// like the packed delta streams so the kernels can add record to record.
+struct plMorphAccum
+{
+    plMorphAccum() : fNumVerts(), fNumUVWChans() { }
+
+    std::vector<float>      fPosNorm;   // 8 per vertex
+    std::vector<float>      fUVWs;      // 4 per vertex per channel
+    std::vector<uint16_t>   fVerts;     // Vertices any delta can move, ascending
+
+    uint32_t                fNumVerts;
+    uint16_t                fNumUVWChans;
+
+    void Reset(uint32_t numVerts, uint16_t numUVWChans);
+    void SortVerts(); // and drops duplicates
+
+    // Writes base plus the sums into dst for each of fVerts, renormalizing
+    // their normals. With no base, the sums go on top of what dst holds.
+    void Write(const plAccessSpan* base, plAccessSpan& dst) const;
 };
 
 class plMorphDelta : public plCreatable
@@ -93,6 +121,15 @@ public:
 
     void        Apply(std::vector<plAccessSpan>& dst, float weight = -1.f) const;
 
+    // Adds weight times our deltas into the sums. Unlike Apply, this doesn't
+    // skip small weights, so taking back a weight previously added is exact.
+    void        Accumulate(std::vector<plMorphAccum>& accum, float weight) const;
+    // Appends the vertices we move to each span's fVerts, unsorted.
+    void        CollectVerts(std::vector<plMorphAccum>& accum) const;
+
+    // The weight Apply would actually use, zero for anything too small to show.
+    static float ActiveWeight(float w);
+
     void        ComputeDeltas(const std::vector<plAccessSpan>& base, const std::vector<plAccessSpan>& moved);
     void        ComputeDeltas(const std::vector<plGeometrySpan*>& base, const std::vector<plGeometrySpan*>& moved, const hsMatrix44& d2b, const hsMatrix44& d2bTInv);
 
@@ -105,6 +142,8 @@ public:
     void Read(hsStream* s, hsResMgr* mgr) override;
     void Write(hsStream* s, hsResMgr* mgr) override;
 
+protected:
+    void        IPackSpan(size_t iSpan);
 };
 
 #endif // plMorphDelta_inc
@@ -52,6 +52,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "pnSceneObject/plCoordinateInterface.h"
 
 #include "plDrawableSpans.h"
+#include "plGeometrySpan.h"
 #include "plInstanceDrawInterface.h"
 
 #include "hsResMgr.h"
@@ -63,7 +64,6 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "plTweak.h"
 #include "hsTimer.h"
-#include "hsFastMath.h"
 
 ///////////////////////////////////////////////////////////////////////////
 
@@ -99,6 +99,10 @@ const uint32_t kChanMask = plAccessVtxSpan::kPositionMask
 
 plConst(float)   kMorphTime(0.5);
 
+// Incremental updates to a shared mesh's sums pick up a little float error
+// each time, so every so often we start again from the pristine mesh.
+static const uint16_t kMaxSumUpdates = 256;
+
 struct plMorphTarget
 {
     plMorphTarget(uint16_t layer, uint16_t delta, float weight)
@@ -374,19 +378,6 @@ void plMorphSequence::DeInit()
     }
 }
 
-void plMorphSequence::IRenormalize(std::vector<plAccessSpan>& dst) const
-{
-    for (plAccessSpan& span : dst)
-    {
-        hsAssert(span.HasAccessVtx(), "Come on, everyone has vertices");
-        plAccessVtxSpan& accVtx = span.AccessVtx();
-        for (uint32_t j = 0; j < accVtx.VertCount(); j++)
-        {
-            hsFastMath::Normalize(accVtx.Normal(j));
-        }
-    }
-}
-
 // MorphSequence - Apply
 void plMorphSequence::Apply() const
 {
@@ -401,14 +392,29 @@ void plMorphSequence::Apply() const
     std::vector<plAccessSpan> dst;
     plAccessGeometry::Instance()->OpenRW(di, dst);
 
-    // For each MorphArray
+    // Sum every active delta first, then touch each moved vertex once
+    std::vector<plMorphAccum> sums(dst.size());
+    for (size_t i = 0; i < dst.size(); i++)
+        sums[i].Reset(dst[i].AccessVtx().VertCount(), dst[i].AccessVtx().NumUVWs());
+
     for (const plMorphArray& morph : fMorphs)
     {
-        // Apply Delta
-        morph.Apply(dst);
+        for (size_t i = 0; i < morph.GetNumDeltas(); i++)
+        {
+            const plMorphDelta& delta = morph.GetDelta(i);
+            float weight = plMorphDelta::ActiveWeight(delta.GetWeight());
+            if (weight > 0.f)
+            {
+                delta.Accumulate(sums, weight);
+                delta.CollectVerts(sums);
+            }
+        }
     }
+    for (plMorphAccum& span : sums)
+        span.SortVerts();
 
-    IRenormalize(dst);
+    for (size_t i = 0; i < dst.size(); i++)
+        sums[i].Write(nullptr, dst[i]);
 
     // Close up the access spans
     plAccessGeometry::Instance()->Close(dst);
@@ -492,18 +498,16 @@ void plMorphSequence::Write(hsStream* s, hsResMgr* mgr)
 
 // Normal sequence of calls:
 // 1) on notification that meshes have changed (or activate)
-//      IFindIndices() - Sets up indices 
-//      IApplyShared() - Find which mesh is active and
-//          IResetShared(iActive);
-//          IApplyShared(iActive);
+//      IFindIndices() - Sets up indices, and forgets what's baked into the drawable
+//      IApplyShared() - For each mesh
+//          IApplyShared(iMesh) - IResetShared(iMesh) and apply from scratch
 //      go dormant
 // 2) on weight change
 //      SetWeight() - Register for render message and set the new weight
 // 3) on render msg:
 //      if dirty
-//          IApplyShared() - Find which mesh is active and
-//              IResetShared(iActive);
-//              IApplyShared(iActive);
+//          IApplyShared() - For each mesh
+//              IApplyShared(iMesh) - Add in just the weights that changed
 //      else
 //          Unregister for render message.
 // 4) on deinit
@@ -519,10 +523,7 @@ void plMorphSequence::IResetShared()
 void plMorphSequence::IApplyShared()
 {
     for (size_t i = 0; i < fSharedMeshes.size(); i++)
-    {
-        IResetShared(i);
         IApplyShared(i);
-    }
 }
 
 void plMorphSequence::IFindIndices()
@@ -545,32 +546,80 @@ void plMorphSequence::IApplyShared(size_t iShare)
         return;
 
     plSharedMeshInfo& mInfo = fSharedMeshes[iShare];
+    const std::vector<plMorphArray>& morphs = mInfo.fMesh->fMorphSet->fMorphs;
 
-    std::vector<plAccessSpan> dst;
-    // Now copy each shared mesh geometryspan into the drawable
-    // to get it back to it's pristine condition.
-    for (size_t i = 0; i < mInfo.fMesh->fSpans.size(); i++)
+    if (!(mInfo.fFlags & plSharedMeshInfo::kInfoHaveSums) || ++mInfo.fNumSumUpdates > kMaxSumUpdates)
     {
-        plAccessSpan dstAcc;
-        plAccessGeometry::Instance()->OpenRW(mInfo.fCurrDraw, mInfo.fCurrIdx[i], dstAcc);
-
-        dst.emplace_back(dstAcc);
+        // Back to pristine, with nothing summed in yet
+        if (!IResetShared(iShare))
+            return;
+        IInitSums(iShare);
     }
 
-    // For each MorphArray
-    for (size_t i = 0; i < mInfo.fMesh->fMorphSet->fMorphs.size(); i++)
+    // Only deltas whose weight moved since the last apply go into the sums,
+    // and then only by the difference.
+    bool changed = false;
+    for (size_t i = 0; i < morphs.size(); i++)
     {
-        // Apply Delta
-        mInfo.fMesh->fMorphSet->fMorphs[i].Apply(dst, &mInfo.fArrayWeights[i].fDeltaWeights);
+        for (size_t j = 0; j < morphs[i].GetNumDeltas(); j++)
+        {
+            float weight = plMorphDelta::ActiveWeight(mInfo.fArrayWeights[i].fDeltaWeights[j]);
+            float& summed = mInfo.fSumWeights[i].fDeltaWeights[j];
+            if (weight != summed)
+            {
+                morphs[i].GetDelta(j).Accumulate(mInfo.fSums, weight - summed);
+                summed = weight;
+                changed = true;
+            }
+        }
     }
 
-    IRenormalize(dst);
+    if (changed)
+    {
+        for (size_t i = 0; i < mInfo.fMesh->fSpans.size(); i++)
+        {
+            plAccessSpan srcAcc;
+            plAccessGeometry::Instance()->AccessSpanFromGeometrySpan(srcAcc, mInfo.fMesh->fSpans[i]);
+            plAccessSpan dstAcc;
+            plAccessGeometry::Instance()->OpenRW(mInfo.fCurrDraw, mInfo.fCurrIdx[i], dstAcc);
+
+            mInfo.fSums[i].Write(&srcAcc, dstAcc);
+
+            plAccessGeometry::Instance()->Close(dstAcc);
+        }
+    }
 
-    // Close up the access spans
-    plAccessGeometry::Instance()->Close(dst);
     mInfo.fFlags &= ~plSharedMeshInfo::kInfoDirtyMesh;
 }
 
+void plMorphSequence::IInitSums(size_t iShare)
+{
+    plSharedMeshInfo& mInfo = fSharedMeshes[iShare];
+    const std::vector<plMorphArray>& morphs = mInfo.fMesh->fMorphSet->fMorphs;
+
+    mInfo.fSums.resize(mInfo.fMesh->fSpans.size());
+    for (size_t i = 0; i < mInfo.fSums.size(); i++)
+    {
+        const plGeometrySpan* span = mInfo.fMesh->fSpans[i];
+        mInfo.fSums[i].Reset(span->fNumVerts, span->GetNumUVs());
+    }
+
+    // Every vertex any delta could move gets rewritten on each apply, so
+    // one that drops back to zero weight is restored too.
+    mInfo.fSumWeights.resize(morphs.size());
+    for (size_t i = 0; i < morphs.size(); i++)
+    {
+        mInfo.fSumWeights[i].fDeltaWeights.assign(morphs[i].GetNumDeltas(), 0.f);
+        for (size_t j = 0; j < morphs[i].GetNumDeltas(); j++)
+            morphs[i].GetDelta(j).CollectVerts(mInfo.fSums);
+    }
+    for (plMorphAccum& span : mInfo.fSums)
+        span.SortVerts();
+
+    mInfo.fNumSumUpdates = 0;
+    mInfo.fFlags |= plSharedMeshInfo::kInfoHaveSums;
+}
+
 bool plMorphSequence::IResetShared(size_t iShare)
 {
     if (iShare >= fSharedMeshes.size() || fSharedMeshes[iShare].fCurrDraw == nullptr)
@@ -609,6 +658,7 @@ bool plMorphSequence::IFindIndices(size_t iShare)
 {
     plSharedMeshInfo& mInfo = fSharedMeshes[iShare];
     mInfo.fCurrDraw = nullptr; // In case we fail.
+    mInfo.fFlags &= ~plSharedMeshInfo::kInfoHaveSums;
 
     const plInstanceDrawInterface* di = plInstanceDrawInterface::ConvertNoRef(IGetDrawInterface());
     if( !di )
@@ -640,6 +690,7 @@ void plMorphSequence::IReleaseIndices(size_t iShare)
 {
     plSharedMeshInfo& mInfo = fSharedMeshes[iShare];
     mInfo.fCurrDraw = nullptr;
+    mInfo.fFlags &= ~plSharedMeshInfo::kInfoHaveSums;
 }
 
 hsSsize_t plMorphSequence::IFindSharedMeshIndex(plKey meshKey) const
@@ -63,7 +63,8 @@ class plSharedMeshInfo
 public:
     enum
     {
-        kInfoDirtyMesh = 0x1
+        kInfoDirtyMesh = 0x1,
+        kInfoHaveSums  = 0x2
     };
 
     plSharedMesh*       fMesh;
@@ -72,7 +73,13 @@ public:
     std::vector<plMorphArrayWeights> fArrayWeights;
     uint8_t               fFlags;
 
-    plSharedMeshInfo() : fMesh(), fCurrDraw(), fFlags() { }
+    // What's currently baked into the drawable, so a weight change only
+    // costs the deltas it touches.
+    std::vector<plMorphAccum> fSums;
+    std::vector<plMorphArrayWeights> fSumWeights;
+    uint16_t            fNumSumUpdates;
+
+    plSharedMeshInfo() : fMesh(), fCurrDraw(), fFlags(), fNumSumUpdates() { }
 };
 
 // Keyed storage class for morph arrays/deltas
@@ -129,7 +136,7 @@ protected:
     bool        IFindIndices(size_t iShare);
     void        IReleaseIndices(size_t iShare);
 
-    void        IRenormalize(std::vector<plAccessSpan>& dst) const;
+    void        IInitSums(size_t iShare);
 
     void        IResetShared();
     void        IReleaseIndices(); // Puts everyone inactive
@@ -40,12 +40,14 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 *==LICENSE==*/
 #include "plEncryptedStream.h"
+#include "plTeaCipher.h"
 
 #include "hsSTLStream.h"
 
 #include <ctime>
 #include <wchar.h>
 #include <algorithm>
+#include <vector>
 
 static const uint32_t kDefaultKey[4] = { 0x6c0a5452, 0x3827d0f, 0x3a170b92, 0x16db7fc2 };
 static const int kEncryptChunkSize = 8;
@@ -214,15 +216,29 @@ uint32_t plEncryptedStream::IRead(uint32_t bytes, void* buffer)
     return numItems;
 }
 
+// How much of the open file is left past the current position
+static uint64_t IFileBytesLeft(FILE* ref)
+{
+    long pos = ftell(ref);
+    if (pos < 0 || fseek(ref, 0, SEEK_END) != 0)
+        return 0;
+    long size = ftell(ref);
+    fseek(ref, pos, SEEK_SET);
+    return size > pos ? uint64_t(size - pos) : 0;
+}
+
 void plEncryptedStream::IBufferFile()
 {
-    fRAMStream = new hsVectorStream;
-    char buf[1024];
-    while (!AtEnd())
-    {
-        uint32_t numRead = Read(1024, buf);
-        fRAMStream->Write(numRead, buf);
-    }
+    // Read the whole file and decipher it in one go. The size comes from the
+    // header, so don't trust it to fit in the file.
+    uint64_t numBlocks = (uint64_t(fActualFileSize) + kEncryptChunkSize - 1) / kEncryptChunkSize;
+    std::vector<uint8_t> buf(std::min<uint64_t>(numBlocks * kEncryptChunkSize, IFileBytesLeft(fRef)));
+    uint32_t numRead = IRead(uint32_t(buf.size()), buf.data());
+    plTeaCipher::DecipherTEA(fKey, buf.data(), numRead / kEncryptChunkSize);
+
+    fActualFileSize = std::min(numRead, fActualFileSize);
+    fRAMStream = new hsVectorStream(fActualFileSize);
+    fRAMStream->Write(fActualFileSize, buf.data());
     fRAMStream->Rewind();
 
     fBufferedStream = true;
@@ -328,15 +344,7 @@ uint32_t plEncryptedStream::Read(uint32_t bytes, void* buffer)
     }
 
     if (numMidChunks != 0)
-    {
-        uint32_t* bufferPos = (uint32_t*)(((char*)buffer)+startAmt);
-        for (int i = 0; i < numMidChunks; i++)
-        {
-            // Decrypt chunk
-            IDecipher(bufferPos);
-            bufferPos += (kEncryptChunkSize / sizeof(uint32_t));
-        }
-    }
+        plTeaCipher::DecipherTEA(fKey, ((char*)buffer)+startAmt, numMidChunks);
 
     if (endAmt != 0)
     {
@@ -43,10 +43,13 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include <ctime>
 
 #include "plSecureStream.h"
+#include "plTeaCipher.h"
 #include "hsWindows.h"
 
 #include "hsSTLStream.h"
 
+#include <vector>
+
 #if !HS_BUILD_FOR_WIN32
 #include <errno.h>
 #define INVALID_HANDLE_VALUE nullptr
@@ -191,7 +194,12 @@ bool plSecureStream::Open(const plFileName& name, const char* mode)
         }
 
         DWORD numBytesRead;
-        ReadFile(fRef, &fActualFileSize, sizeof(uint32_t), &numBytesRead, nullptr);
+        if (!ReadFile(fRef, &fActualFileSize, sizeof(uint32_t), &numBytesRead, nullptr) || numBytesRead != sizeof(uint32_t))
+        {
+            CloseHandle(fRef);
+            fRef = INVALID_HANDLE_VALUE;
+            return false;
+        }
 #elif HS_BUILD_FOR_UNIX
         fRef = plFileSystem::Open(name, "rb");
         fPosition = 0;
@@ -205,6 +213,13 @@ bool plSecureStream::Open(const plFileName& name, const char* mode)
             fRef = INVALID_HANDLE_VALUE;
             return false;
         }
+
+        if (fread(&fActualFileSize, sizeof(uint32_t), 1, fRef) != 1)
+        {
+            fclose(fRef);
+            fRef = INVALID_HANDLE_VALUE;
+            return false;
+        }
 #endif
 
         // The encrypted stream is inefficient if you do reads smaller than
@@ -243,24 +258,26 @@ bool plSecureStream::Open(hsStream* stream)
     if (!ICheckMagicString(stream))
         return false;
 
+    // The size comes from the header, so don't trust it to fit in the stream
     fActualFileSize = stream->ReadLE32();
-    uint32_t trimSize = kMagicStringLen + sizeof(uint32_t) + fActualFileSize;
-    fRAMStream = new hsRAMStream;
-    while (!stream->AtEnd())
+    if (fActualFileSize > stream->GetSizeLeft())
     {
-        // Don't write out any garbage
-        uint32_t size;
-        if ((trimSize - stream->GetPosition()) < kEncryptChunkSize)
-            size = (trimSize - stream->GetPosition());
-        else
-            size = kEncryptChunkSize;
-
-        uint8_t buf[kEncryptChunkSize];
-        stream->Read(kEncryptChunkSize, &buf);
-        IDecipher((uint32_t*)&buf, kEncryptChunkSize / sizeof(uint32_t));
-        fRAMStream->Write(size, &buf);
+        fActualFileSize = 0;
+        stream->SetPosition(pos);
+        return false;
     }
 
+    // Pull in every block at once and decipher them all in one go, rather
+    // than going back and forth through the streams a block at a time
+    uint64_t numBlocks = (uint64_t(fActualFileSize) + kEncryptChunkSize - 1) / kEncryptChunkSize;
+    std::vector<uint8_t> buf(std::min<uint64_t>(numBlocks * kEncryptChunkSize, stream->GetSizeLeft()));
+    uint32_t numRead = stream->Read(uint32_t(buf.size()), buf.data());
+    plTeaCipher::DecipherXXTEA(fKey, buf.data(), numRead / kEncryptChunkSize);
+
+    // Don't write out any garbage
+    fRAMStream = new hsVectorStream(fActualFileSize);
+    fRAMStream->Write(std::min(numRead, fActualFileSize), buf.data());
+
     stream->SetPosition(pos);
     fRAMStream->Rewind();
     fPosition = 0;
@@ -310,8 +327,8 @@ uint32_t plSecureStream::IRead(uint32_t bytes, void* buffer)
 #if HS_BUILD_FOR_WIN32
     bool success = (ReadFile(fRef, buffer, bytes, (LPDWORD)&numItems, nullptr) != 0);
 #elif HS_BUILD_FOR_UNIX
-    numItems = fread(buffer, bytes, 1, fRef);
-    bool success = numItems != 0;
+    numItems = (uint32_t)fread(buffer, 1, bytes, fRef);
+    bool success = !ferror(fRef);
 #endif
     fBytesRead += numItems;
     fPosition += numItems;
@@ -336,15 +353,36 @@ uint32_t plSecureStream::IRead(uint32_t bytes, void* buffer)
     return numItems;
 }
 
+// How much of the open file is left past the current position
+static uint64_t IFileBytesLeft(hsFD ref)
+{
+#if HS_BUILD_FOR_WIN32
+    LARGE_INTEGER zero{}, pos, size;
+    if (!SetFilePointerEx(ref, zero, &pos, FILE_CURRENT) || !GetFileSizeEx(ref, &size))
+        return 0;
+    return size.QuadPart > pos.QuadPart ? uint64_t(size.QuadPart - pos.QuadPart) : 0;
+#elif HS_BUILD_FOR_UNIX
+    long pos = ftell(ref);
+    if (pos < 0 || fseek(ref, 0, SEEK_END) != 0)
+        return 0;
+    long size = ftell(ref);
+    fseek(ref, pos, SEEK_SET);
+    return size > pos ? uint64_t(size - pos) : 0;
+#endif
+}
+
 void plSecureStream::IBufferFile()
 {
-    fRAMStream = new hsVectorStream;
-    char buf[1024];
-    while (!AtEnd())
-    {
-        uint32_t numRead = Read(1024, buf);
-        fRAMStream->Write(numRead, buf);
-    }
+    // Read the whole file and decipher it in one go. The size comes from the
+    // header, so don't trust it to fit in the file.
+    uint64_t numBlocks = (uint64_t(fActualFileSize) + kEncryptChunkSize - 1) / kEncryptChunkSize;
+    std::vector<uint8_t> buf(std::min<uint64_t>(numBlocks * kEncryptChunkSize, IFileBytesLeft(fRef)));
+    uint32_t numRead = IRead(uint32_t(buf.size()), buf.data());
+    plTeaCipher::DecipherXXTEA(fKey, buf.data(), numRead / kEncryptChunkSize);
+
+    fActualFileSize = std::min(numRead, fActualFileSize);
+    fRAMStream = new hsVectorStream(fActualFileSize);
+    fRAMStream->Write(fActualFileSize, buf.data());
     fRAMStream->Rewind();
 
     fBufferedStream = true;
@@ -465,15 +503,7 @@ uint32_t plSecureStream::Read(uint32_t bytes, void* buffer)
     }
 
     if (numMidChunks != 0)
-    {
-        uint32_t* bufferPos = (uint32_t*)(((char*)buffer)+startAmt);
-        for (int i = 0; i < numMidChunks; i++)
-        {
-            // Decrypt chunk
-            IDecipher(bufferPos, kEncryptChunkSize / sizeof(uint32_t));
-            bufferPos += (kEncryptChunkSize / sizeof(uint32_t));
-        }
-    }
+        plTeaCipher::DecipherXXTEA(fKey, ((char*)buffer)+startAmt, numMidChunks);
 
     if (endAmt != 0)
     {
@@ -0,0 +1,122 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plTeaCipher.h"
+#include "plTeaCipher_Private.h"
+
+static const uint32_t kDelta = 0x9E3779B9;
+
+// Both ciphers run 32 rounds on an 8 byte block; for XXTEA that's 6 + 52/n
+// with n == 2 words.
+static const uint32_t kRounds = 32;
+
+void plTeaCipherKernels::decipher_tea_fpu(const uint32_t* key, uint32_t* v, size_t numBlocks)
+{
+    for (size_t i = 0; i < numBlocks; ++i, v += 2)
+    {
+        uint32_t y = v[0], z = v[1], sum = kDelta * kRounds;
+
+        for (uint32_t n = 0; n < kRounds; ++n)
+        {
+            z -= ((y << 4 ^ y >> 5) + y) ^ (sum + key[sum >> 11 & 3]);
+            sum -= kDelta;
+            y -= ((z << 4 ^ z >> 5) + z) ^ (sum + key[sum & 3]);
+        }
+
+        v[0] = y; v[1] = z;
+    }
+}
+
+void plTeaCipherKernels::decipher_xxtea_fpu(const uint32_t* key, uint32_t* v, size_t numBlocks)
+{
+    for (size_t i = 0; i < numBlocks; ++i, v += 2)
+    {
+        uint32_t v0 = v[0], v1 = v[1], sum = kDelta * kRounds;
+
+        // With only two words, y and z are always the same word: the one
+        // that isn't being updated.
+        while (sum != 0)
+        {
+            uint32_t e = (sum >> 2) & 3;
+            v1 -= ((v0 >> 5 ^ v0 << 2) + (v0 >> 3 ^ v0 << 4)) ^ ((sum ^ v0) + (key[1 ^ e] ^ v0));
+            v0 -= ((v1 >> 5 ^ v1 << 2) + (v1 >> 3 ^ v1 << 4)) ^ ((sum ^ v1) + (key[e] ^ v1));
+            sum -= kDelta;
+        }
+
+        v[0] = v0; v[1] = v1;
+    }
+}
+
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<plTeaCipherKernels::decipher_ptr> plTeaCipherKernels::decipher_tea {
+    &plTeaCipherKernels::decipher_tea_fpu,
+    nullptr,                                // SSE1
+    &plTeaCipherKernels::decipher_tea_sse2,
+    nullptr,                                // SSE3
+    nullptr,                                // SSSE3
+    nullptr,                                // SSE41
+    nullptr,                                // SSE42
+    nullptr,                                // AVX
+    &plTeaCipherKernels::decipher_tea_avx2
+};
+
+hsCpuFunctionDispatcher<plTeaCipherKernels::decipher_ptr> plTeaCipherKernels::decipher_xxtea {
+    &plTeaCipherKernels::decipher_xxtea_fpu,
+    nullptr,                                // SSE1
+    &plTeaCipherKernels::decipher_xxtea_sse2,
+    nullptr,                                // SSE3
+    nullptr,                                // SSSE3
+    nullptr,                                // SSE41
+    nullptr,                                // SSE42
+    nullptr,                                // AVX
+    &plTeaCipherKernels::decipher_xxtea_avx2
+};
+
+void plTeaCipher::DecipherTEA(const uint32_t* key, void* blocks, size_t numBlocks)
+{
+    plTeaCipherKernels::decipher_tea.call(key, reinterpret_cast<uint32_t*>(blocks), numBlocks);
+}
+
+void plTeaCipher::DecipherXXTEA(const uint32_t* key, void* blocks, size_t numBlocks)
+{
+    plTeaCipherKernels::decipher_xxtea.call(key, reinterpret_cast<uint32_t*>(blocks), numBlocks);
+}
@@ -0,0 +1,124 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plTeaCipher_Private.h"
+
+#ifdef HAVE_AVX2
+#   include <immintrin.h>
+
+// Eight blocks at a time, split into first and second words like the SSE2
+// version. The shuffles work within each 128-bit half, so the lanes end up
+// out of order, but the unpacks on the way out put them straight back.
+#   define LOADBLOCKS(v, v0, v1) \
+        __m256 lo = _mm256_loadu_ps(reinterpret_cast<const float*>(v)); \
+        __m256 hi = _mm256_loadu_ps(reinterpret_cast<const float*>(v + 8)); \
+        __m256i v0 = _mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))); \
+        __m256i v1 = _mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+#   define STOREBLOCKS(v, v0, v1) \
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v), _mm256_unpacklo_epi32(v0, v1)); \
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v + 8), _mm256_unpackhi_epi32(v0, v1));
+
+static const uint32_t kDelta = 0x9E3779B9;
+static const uint32_t kRounds = 32;
+#endif // HAVE_AVX2
+
+void plTeaCipherKernels::decipher_tea_avx2(const uint32_t* key, uint32_t* v, size_t numBlocks)
+{
+#ifdef HAVE_AVX2
+    for (; numBlocks >= 8; numBlocks -= 8, v += 16)
+    {
+        LOADBLOCKS(v, y, z);
+        uint32_t sum = kDelta * kRounds;
+
+        for (uint32_t n = 0; n < kRounds; ++n)
+        {
+            __m256i k = _mm256_set1_epi32(sum + key[sum >> 11 & 3]);
+            __m256i t = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(y, 4), _mm256_srli_epi32(y, 5)), y);
+            z = _mm256_sub_epi32(z, _mm256_xor_si256(t, k));
+            sum -= kDelta;
+
+            k = _mm256_set1_epi32(sum + key[sum & 3]);
+            t = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(z, 4), _mm256_srli_epi32(z, 5)), z);
+            y = _mm256_sub_epi32(y, _mm256_xor_si256(t, k));
+        }
+
+        STOREBLOCKS(v, y, z);
+    }
+    _mm256_zeroupper();
+#endif // HAVE_AVX2
+
+    decipher_tea_fpu(key, v, numBlocks);
+}
+
+#ifdef HAVE_AVX2
+// ((y>>5 ^ y<<2) + (y>>3 ^ y<<4)) ^ ((sum ^ y) + (k ^ y)), with y == z
+static inline __m256i IXXTEAMix(__m256i y, __m256i sum, __m256i k)
+{
+    __m256i a = _mm256_xor_si256(_mm256_srli_epi32(y, 5), _mm256_slli_epi32(y, 2));
+    __m256i b = _mm256_xor_si256(_mm256_srli_epi32(y, 3), _mm256_slli_epi32(y, 4));
+    __m256i c = _mm256_add_epi32(_mm256_xor_si256(sum, y), _mm256_xor_si256(k, y));
+    return _mm256_xor_si256(_mm256_add_epi32(a, b), c);
+}
+#endif // HAVE_AVX2
+
+void plTeaCipherKernels::decipher_xxtea_avx2(const uint32_t* key, uint32_t* v, size_t numBlocks)
+{
+#ifdef HAVE_AVX2
+    for (; numBlocks >= 8; numBlocks -= 8, v += 16)
+    {
+        LOADBLOCKS(v, v0, v1);
+
+        for (uint32_t sum = kDelta * kRounds; sum != 0; sum -= kDelta)
+        {
+            uint32_t e = (sum >> 2) & 3;
+            __m256i s = _mm256_set1_epi32(sum);
+            v1 = _mm256_sub_epi32(v1, IXXTEAMix(v0, s, _mm256_set1_epi32(key[1 ^ e])));
+            v0 = _mm256_sub_epi32(v0, IXXTEAMix(v1, s, _mm256_set1_epi32(key[e])));
+        }
+
+        STOREBLOCKS(v, v0, v1);
+    }
+    _mm256_zeroupper();
+#endif // HAVE_AVX2
+
+    decipher_xxtea_fpu(key, v, numBlocks);
+}
@@ -0,0 +1,121 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plTeaCipher_Private.h"
+
+#ifdef HAVE_SSE2
+#   include <emmintrin.h>
+
+// Four blocks at a time: the first words of each block in one register and
+// the second words in another, so every lane runs the scalar rounds as-is.
+#   define LOADBLOCKS(v, v0, v1) \
+        __m128 lo = _mm_loadu_ps(reinterpret_cast<const float*>(v)); \
+        __m128 hi = _mm_loadu_ps(reinterpret_cast<const float*>(v + 4)); \
+        __m128i v0 = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))); \
+        __m128i v1 = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+#   define STOREBLOCKS(v, v0, v1) \
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v), _mm_unpacklo_epi32(v0, v1)); \
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v + 4), _mm_unpackhi_epi32(v0, v1));
+
+static const uint32_t kDelta = 0x9E3779B9;
+static const uint32_t kRounds = 32;
+#endif // HAVE_SSE2
+
+void plTeaCipherKernels::decipher_tea_sse2(const uint32_t* key, uint32_t* v, size_t numBlocks)
+{
+#ifdef HAVE_SSE2
+    for (; numBlocks >= 4; numBlocks -= 4, v += 8)
+    {
+        LOADBLOCKS(v, y, z);
+        uint32_t sum = kDelta * kRounds;
+
+        for (uint32_t n = 0; n < kRounds; ++n)
+        {
+            __m128i k = _mm_set1_epi32(sum + key[sum >> 11 & 3]);
+            __m128i t = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(y, 4), _mm_srli_epi32(y, 5)), y);
+            z = _mm_sub_epi32(z, _mm_xor_si128(t, k));
+            sum -= kDelta;
+
+            k = _mm_set1_epi32(sum + key[sum & 3]);
+            t = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(z, 4), _mm_srli_epi32(z, 5)), z);
+            y = _mm_sub_epi32(y, _mm_xor_si128(t, k));
+        }
+
+        STOREBLOCKS(v, y, z);
+    }
+#endif // HAVE_SSE2
+
+    decipher_tea_fpu(key, v, numBlocks);
+}
+
+#ifdef HAVE_SSE2
+// ((y>>5 ^ y<<2) + (y>>3 ^ y<<4)) ^ ((sum ^ y) + (k ^ y)), with y == z
+static inline __m128i IXXTEAMix(__m128i y, __m128i sum, __m128i k)
+{
+    __m128i a = _mm_xor_si128(_mm_srli_epi32(y, 5), _mm_slli_epi32(y, 2));
+    __m128i b = _mm_xor_si128(_mm_srli_epi32(y, 3), _mm_slli_epi32(y, 4));
+    __m128i c = _mm_add_epi32(_mm_xor_si128(sum, y), _mm_xor_si128(k, y));
+    return _mm_xor_si128(_mm_add_epi32(a, b), c);
+}
+#endif // HAVE_SSE2
+
+void plTeaCipherKernels::decipher_xxtea_sse2(const uint32_t* key, uint32_t* v, size_t numBlocks)
+{
+#ifdef HAVE_SSE2
+    for (; numBlocks >= 4; numBlocks -= 4, v += 8)
+    {
+        LOADBLOCKS(v, v0, v1);
+
+        for (uint32_t sum = kDelta * kRounds; sum != 0; sum -= kDelta)
+        {
+            uint32_t e = (sum >> 2) & 3;
+            __m128i s = _mm_set1_epi32(sum);
+            v1 = _mm_sub_epi32(v1, IXXTEAMix(v0, s, _mm_set1_epi32(key[1 ^ e])));
+            v0 = _mm_sub_epi32(v0, IXXTEAMix(v1, s, _mm_set1_epi32(key[e])));
+        }
+
+        STOREBLOCKS(v, v0, v1);
+    }
+#endif // HAVE_SSE2
+
+    decipher_xxtea_fpu(key, v, numBlocks);
+}
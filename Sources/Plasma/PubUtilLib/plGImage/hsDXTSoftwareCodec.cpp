@@ -43,14 +43,43 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "HeadSpin.h"
 #include "hsColorRGBA.h"
 #include "hsDXTSoftwareCodec.h"
+#include "hsDXTSoftwareCodec_Private.h"
 #include "plMipmap.h"
 #include "hsCodecManager.h"
+#include "hsJobSystem.h"
+
+#include <algorithm>
 
 #define SWAPVARS( x, y, t ) { t = x; x = y; y = t; }
 
 // This is the color depth that we decompress to by default if we're not told otherwise
 #define kDefaultDepth   32
 
+// Levels with fewer blocks than this are coded on the calling thread, and
+// bigger ones are handed out in chunks of about this many blocks
+static const uint32_t kMinParallelBlocks = 1024;
+
+//// IDecodeBlockRows /////////////////////////////////////////////////////////
+//  Block rows never share pixels, so they can be decoded in any order on any
+//  thread.
+
+static void IDecodeBlockRows( hsDXTSoftwareCodecKernels::decode_blocks_ptr decode, const uint8_t *src, uint32_t blockSize,
+                              uint32_t *dest, uint32_t blocksWide, uint32_t blocksHigh, uint32_t destStride )
+{
+    auto decodeRows = [=](size_t begin, size_t end) {
+        for( size_t row = begin; row < end; row++ )
+            decode( src + row * blocksWide * blockSize, dest + row * 4 * destStride, blocksWide, destStride );
+    };
+
+    if( blocksWide * blocksHigh >= kMinParallelBlocks && hsJobSystem::InstanceValid() )
+    {
+        size_t grain = std::max<size_t>( 1, kMinParallelBlocks / blocksWide );
+        hsJobSystem::Instance().ParallelFor( 0, blocksHigh, grain, decodeRows );
+    }
+    else
+        decodeRows( 0, blocksHigh );
+}
+
 
 bool hsDXTSoftwareCodec::fRegistered = false;
 
@@ -879,118 +908,53 @@ void    hsDXTSoftwareCodec::IUncompressMipmapDXT5To16Weird( plMipmap *destBMap,
 //  interpolated alpha channel compression. Output is a 32-bit ARGB 8888 bitmap.
 //
 //  7.31.2000 - M.Burrack - Created, based on old code (uncredited)
-//
-//  8.14.2000 - M.Burrack - Optimized on the alpha blending. Now we precalc
-//                          the divided values and run a for loop. This gets
-//                          us only about 10% :(
 
 void    hsDXTSoftwareCodec::IUncompressMipmapDXT5To32( plMipmap *destBMap, plMipmap *srcBMap )
 {
-    uint16_t      *srcData;
-    uint32_t      *destData, destBlock[ 16 ];
-    uint32_t      blockSize;
-    uint32_t      x, y, bMapStride;
-    uint32_t      colors[ 4 ];
-    int32_t       numBlocks, i, j;
-    uint8_t       *bytePtr;
-    uint32_t      alphas[ 8 ], aTemp, a0, a1;
-
-    uint32_t      aBitSrc1, aBitSrc2;
-    uint16_t      cBitSrc1, cBitSrc2;
-
-
     /// Setup some nifty stuff
     hsAssert( ( srcBMap->GetCurrWidth() & 3 ) == 0, "Bitmap width must be multiple of 4" );
     hsAssert( ( srcBMap->GetCurrHeight() & 3 ) == 0, "Bitmap height must be multiple of 4" );
-    numBlocks = ( srcBMap->GetCurrWidth() * srcBMap->GetCurrHeight() ) >> 4;
+    hsAssert( srcBMap->fDirectXInfo.fBlockSize == 16, "Unexpected DXT5 block size" );
 
-    blockSize = srcBMap->fDirectXInfo.fBlockSize >> 1; // In 16-bit words
-    srcData = (uint16_t *)srcBMap->GetCurrLevelPtr();
     // Note our trick here to make sure nothing breaks if GetAddr32's 
     // formula changes
-    bMapStride = (uint32_t)( destBMap->GetAddr32( 0, 1 ) - destBMap->GetAddr32( 0, 0 ) );
-    x = y = 0;
+    uint32_t bMapStride = (uint32_t)( destBMap->GetAddr32( 0, 1 ) - destBMap->GetAddr32( 0, 0 ) );
 
+    IDecodeBlockRows( hsDXTSoftwareCodecKernels::decode_dxt5_to32.call, (const uint8_t *)srcBMap->GetCurrLevelPtr(), srcBMap->fDirectXInfo.fBlockSize,
+                      destBMap->GetAddr32( 0, 0 ), srcBMap->GetCurrWidth() >> 2, srcBMap->GetCurrHeight() >> 2, bMapStride );
+}
 
-    /// Loop through the # of blocks (width*height / 16-pixel-blocks)
-    for( i = 0; i < numBlocks; i++ )
-    {
-        /// Per block--determine alpha compression type first
-        bytePtr = (uint8_t *)srcData;
-        alphas[ 0 ] = bytePtr[ 0 ];
-        alphas[ 1 ] = bytePtr[ 1 ];
+//// decode_dxt5_to32_fpu /////////////////////////////////////////////////////
+//  One row of blocks worth of IUncompressMipmapDXT5To32.
 
-        /// Note that we use the preshifted alphas really as fixed point.
-        /// The result: more accuracy, and no need to shift the alphas afterwards
-        if( alphas[ 0 ] > alphas[ 1 ] )
-        {
-            /// 8-alpha block: interpolate 6 others
-/*          //// Here's the old code, for reference ////
-            alphas[ 2 ] = ( 6 * alphas[ 0 ] +     alphas[ 1 ] ) / 7;
-            alphas[ 3 ] = ( 5 * alphas[ 0 ] + 2 * alphas[ 1 ] ) / 7;
-            alphas[ 4 ] = ( 4 * alphas[ 0 ] + 3 * alphas[ 1 ] ) / 7;
-            alphas[ 5 ] = ( 3 * alphas[ 0 ] + 4 * alphas[ 1 ] ) / 7;
-            alphas[ 6 ] = ( 2 * alphas[ 0 ] + 5 * alphas[ 1 ] ) / 7;
-            alphas[ 7 ] = (     alphas[ 0 ] + 6 * alphas[ 1 ] ) / 7;
-*/
-            alphas[ 0 ] <<= 24;
-            alphas[ 1 ] <<= 24;
+void    hsDXTSoftwareCodecKernels::decode_dxt5_to32_fpu( const uint8_t *src, uint32_t *dest, uint32_t numBlocks, uint32_t destStride )
+{
+    uint32_t      *destData, destBlock[ 16 ];
+    uint32_t      colors[ 4 ];
+    uint32_t      alphas[ 8 ];
+    uint32_t      i, j;
 
-            /// Note that, unlike below, we can't combine a0 and a1 into
-            /// one value, because that would give us a negative value,
-            /// and we're using unsigned values here. (i.e. we need all the bits)
-            aTemp = alphas[ 0 ];
-            a0 = ( aTemp / 7 ) & 0xff000000;
-            a1 = ( alphas[ 1 ] / 7 ) & 0xff000000;          
-            for( j = 2; j < 8; j++ )
-            {
-                aTemp += a1 - a0;
-                alphas[ j ] = aTemp;
-            }
-        }
-        else
-        {
-            /// 6-alpha block: interpolate 4 others, then assume last 2 are 0 and 255
-/*          //// Here's the old code, for reference ////
-            alphas[ 2 ] = ( 4 * alphas[ 0 ] +     alphas[ 1 ] ) / 5;
-            alphas[ 3 ] = ( 3 * alphas[ 0 ] + 2 * alphas[ 1 ] ) / 5;
-            alphas[ 4 ] = ( 2 * alphas[ 0 ] + 3 * alphas[ 1 ] ) / 5;
-            alphas[ 5 ] = (     alphas[ 0 ] + 4 * alphas[ 1 ] ) / 5;
-*/
-            alphas[ 0 ] <<= 24;
-            alphas[ 1 ] <<= 24;
+    uint32_t      aBitSrc1, aBitSrc2;
+    uint16_t      cBitSrc1, cBitSrc2;
 
-            aTemp = alphas[ 0 ];
-            a0 = ( alphas[ 1 ] - aTemp ) / 5;
-            for( j = 2; j < 6; j++ )
-            {
-                aTemp += a0;
-                alphas[ j ] = aTemp & 0xff000000;
-            }
 
-            alphas[ 6 ] = 0;
-            alphas[ 7 ] = 255 << 24;
-        }
+    for( i = 0; i < numBlocks; i++ )
+    {
+        const uint16_t *colorData = (const uint16_t *)( src + 8 );
 
-        /// Now do the 16 pixels in 2 blocks, decompressing 3-bit lookups
-        aBitSrc1 = ( (uint32_t)bytePtr[ 4 ] << 16 ) + 
-                    ( (uint32_t)bytePtr[ 3 ] << 8 ) + 
-                    ( (uint32_t)bytePtr[ 2 ] );
-        aBitSrc2 = ( (uint32_t)bytePtr[ 7 ] << 16 ) + 
-                    ( (uint32_t)bytePtr[ 6 ] << 8 ) + 
-                    ( (uint32_t)bytePtr[ 5 ] );
+        DXT5AlphaPalette( src, alphas );
+        DXT5ColorPalette( colorData, colors );
 
-        /// Now decompress color data
-        srcData += 4;       // Alpha was 4 16-bit words worth
-        //hsAssert( srcData[ 0 ] > srcData[ 1 ], "Invalid block compression for DX5 method" );  /// If not, then it's one-bit
-                                                /// alpha, but this is DX5!
-        colors[ 0 ] = IRGB16To32Bit( srcData[ 0 ] );
-        colors[ 1 ] = IRGB16To32Bit( srcData[ 1 ] );
-        colors[ 2 ] = IMixTwoThirdsRGB32( colors[ 0 ], colors[ 1 ] );
-        colors[ 3 ] = IMixTwoThirdsRGB32( colors[ 1 ], colors[ 0 ] );
-        
-        cBitSrc1 = hsToLE16( srcData[ 2 ] );
-        cBitSrc2 = hsToLE16( srcData[ 3 ] );
+        /// Now do the 16 pixels in 2 blocks, decompressing 3-bit lookups
+        aBitSrc1 = ( (uint32_t)src[ 4 ] << 16 ) + 
+                    ( (uint32_t)src[ 3 ] << 8 ) + 
+                    ( (uint32_t)src[ 2 ] );
+        aBitSrc2 = ( (uint32_t)src[ 7 ] << 16 ) + 
+                    ( (uint32_t)src[ 6 ] << 8 ) + 
+                    ( (uint32_t)src[ 5 ] );
+
+        cBitSrc1 = hsToLE16( colorData[ 2 ] );
+        cBitSrc2 = hsToLE16( colorData[ 3 ] );
         
         for( j = 0; j < 8; j++ )
         {
@@ -1006,36 +970,121 @@ void    hsDXTSoftwareCodec::IUncompressMipmapDXT5To32( plMipmap *destBMap, plMip
         }
         
         /// Now copy the block to the destination bitmap
-        /// (Trust me, this is actually *faster* than memcpy for some reason
-        destData = destBMap->GetAddr32( x, y );
-        destData[ 0 ] = destBlock[ 0 ];
-        destData[ 1 ] = destBlock[ 1 ];
-        destData[ 2 ] = destBlock[ 2 ];
-        destData[ 3 ] = destBlock[ 3 ];
-        destData += bMapStride;
-        destData[ 0 ] = destBlock[ 4 ];
-        destData[ 1 ] = destBlock[ 5 ];
-        destData[ 2 ] = destBlock[ 6 ];
-        destData[ 3 ] = destBlock[ 7 ];
-        destData += bMapStride;
-        destData[ 0 ] = destBlock[ 8 ];
-        destData[ 1 ] = destBlock[ 9 ];
-        destData[ 2 ] = destBlock[ 10 ];
-        destData[ 3 ] = destBlock[ 11 ];
-        destData += bMapStride;
-        destData[ 0 ] = destBlock[ 12 ];
-        destData[ 1 ] = destBlock[ 13 ];
-        destData[ 2 ] = destBlock[ 14 ];
-        destData[ 3 ] = destBlock[ 15 ];
+        destData = dest + i * 4;
+        for( j = 0; j < 16; j += 4, destData += destStride )
+        {
+            destData[ 0 ] = destBlock[ j ];
+            destData[ 1 ] = destBlock[ j + 1 ];
+            destData[ 2 ] = destBlock[ j + 2 ];
+            destData[ 3 ] = destBlock[ j + 3 ];
+        }
 
-        /// Increment and loop!
-        srcData += blockSize - 4;       /// JUUUST in case our block size is diff
-        x += 4;
-        if( x == srcBMap->GetCurrWidth() )
+        src += 16;
+    }
+}
+
+//// DXT5AlphaPalette /////////////////////////////////////////////////////////
+//  Expands the two alpha endpoints of a DXT5 block into its 8 alphas, already
+//  shifted up into the alpha byte of an ARGB pixel.
+//
+//  8.14.2000 - M.Burrack - Optimized on the alpha blending. Now we precalc
+//                          the divided values and run a for loop. This gets
+//                          us only about 10% :(
+
+void    hsDXTSoftwareCodecKernels::DXT5AlphaPalette( const uint8_t *block, uint32_t *alphas )
+{
+    uint32_t      aTemp, a0, a1;
+    int32_t       j;
+
+
+    alphas[ 0 ] = block[ 0 ];
+    alphas[ 1 ] = block[ 1 ];
+
+    /// Note that we use the preshifted alphas really as fixed point.
+    /// The result: more accuracy, and no need to shift the alphas afterwards
+    if( alphas[ 0 ] > alphas[ 1 ] )
+    {
+        /// 8-alpha block: interpolate 6 others
+/*      //// Here's the old code, for reference ////
+        alphas[ 2 ] = ( 6 * alphas[ 0 ] +     alphas[ 1 ] ) / 7;
+        alphas[ 3 ] = ( 5 * alphas[ 0 ] + 2 * alphas[ 1 ] ) / 7;
+        alphas[ 4 ] = ( 4 * alphas[ 0 ] + 3 * alphas[ 1 ] ) / 7;
+        alphas[ 5 ] = ( 3 * alphas[ 0 ] + 4 * alphas[ 1 ] ) / 7;
+        alphas[ 6 ] = ( 2 * alphas[ 0 ] + 5 * alphas[ 1 ] ) / 7;
+        alphas[ 7 ] = (     alphas[ 0 ] + 6 * alphas[ 1 ] ) / 7;
+*/
+        alphas[ 0 ] <<= 24;
+        alphas[ 1 ] <<= 24;
+
+        /// Note that, unlike below, we can't combine a0 and a1 into
+        /// one value, because that would give us a negative value,
+        /// and we're using unsigned values here. (i.e. we need all the bits)
+        aTemp = alphas[ 0 ];
+        a0 = ( aTemp / 7 ) & 0xff000000;
+        a1 = ( alphas[ 1 ] / 7 ) & 0xff000000;          
+        for( j = 2; j < 8; j++ )
         {
-            x = 0;
-            y += 4;
+            aTemp += a1 - a0;
+            alphas[ j ] = aTemp;
+        }
+    }
+    else
+    {
+        /// 6-alpha block: interpolate 4 others, then assume last 2 are 0 and 255
+/*      //// Here's the old code, for reference ////
+        alphas[ 2 ] = ( 4 * alphas[ 0 ] +     alphas[ 1 ] ) / 5;
+        alphas[ 3 ] = ( 3 * alphas[ 0 ] + 2 * alphas[ 1 ] ) / 5;
+        alphas[ 4 ] = ( 2 * alphas[ 0 ] + 3 * alphas[ 1 ] ) / 5;
+        alphas[ 5 ] = (     alphas[ 0 ] + 4 * alphas[ 1 ] ) / 5;
+*/
+        alphas[ 0 ] <<= 24;
+        alphas[ 1 ] <<= 24;
+
+        aTemp = alphas[ 0 ];
+        a0 = ( alphas[ 1 ] - aTemp ) / 5;
+        for( j = 2; j < 6; j++ )
+        {
+            aTemp += a0;
+            alphas[ j ] = aTemp & 0xff000000;
         }
+
+        alphas[ 6 ] = 0;
+        alphas[ 7 ] = 255 << 24;
+    }
+}
+
+//// DXT5ColorPalette /////////////////////////////////////////////////////////
+//  The 4 colors of a DXT5 color block, with alpha=0. DXT5 blocks are always
+//  four-color blocks.
+
+void    hsDXTSoftwareCodecKernels::DXT5ColorPalette( const uint16_t *block, uint32_t *colors )
+{
+    colors[ 0 ] = hsDXTSoftwareCodec::IRGB16To32Bit( block[ 0 ] );
+    colors[ 1 ] = hsDXTSoftwareCodec::IRGB16To32Bit( block[ 1 ] );
+    colors[ 2 ] = hsDXTSoftwareCodec::IMixTwoThirdsRGB32( colors[ 0 ], colors[ 1 ] );
+    colors[ 3 ] = hsDXTSoftwareCodec::IMixTwoThirdsRGB32( colors[ 1 ], colors[ 0 ] );
+}
+
+//// DXT1ColorPalette /////////////////////////////////////////////////////////
+//  The 4 colors of a DXT1 block, fully opaque except for the transparent
+//  entry of a three-color block.
+
+void    hsDXTSoftwareCodecKernels::DXT1ColorPalette( const uint16_t *block, uint32_t *colors )
+{
+    colors[ 0 ] = hsDXTSoftwareCodec::IRGB16To32Bit( block[ 0 ] ) | 0xff000000;
+    colors[ 1 ] = hsDXTSoftwareCodec::IRGB16To32Bit( block[ 1 ] ) | 0xff000000;
+
+    if( hsToLE16( block[ 0 ] ) > hsToLE16( block[ 1 ] ) )
+    {
+        /// Four-color block--mix the other two
+        colors[ 2 ] = hsDXTSoftwareCodec::IMixTwoThirdsRGB32( colors[ 0 ], colors[ 1 ] ) | 0xff000000;
+        colors[ 3 ] = hsDXTSoftwareCodec::IMixTwoThirdsRGB32( colors[ 1 ], colors[ 0 ] ) | 0xff000000;
+    }
+    else
+    {
+        /// Three-color block and transparent
+        colors[ 2 ] = hsDXTSoftwareCodec::IMixEqualRGB32( colors[ 0 ], colors[ 1 ] ) | 0xff000000;
+        colors[ 3 ] = 0;
     }
 }
 
@@ -1399,49 +1448,36 @@ void    hsDXTSoftwareCodec::IUncompressMipmapDXT1To16Weird( plMipmap *destBMap,
 void    hsDXTSoftwareCodec::IUncompressMipmapDXT1To32( plMipmap *destBMap, 
                                                    plMipmap *srcBMap )
 {
-    uint16_t      *srcData, tempW1, tempW2;
-    uint32_t      *destData, destBlock[ 16 ];
-    uint32_t      blockSize;
-    uint32_t      bitSource, bitSource2, x, y, bMapStride;
-    uint32_t      colors[ 4 ];
-    int32_t       numBlocks, i, j;
-
-
     /// Setup some nifty stuff
     hsAssert( ( srcBMap->GetCurrWidth() & 3 ) == 0, "Bitmap width must be multiple of 4" );
     hsAssert( ( srcBMap->GetCurrHeight() & 3 ) == 0, "Bitmap height must be multiple of 4" );
-    numBlocks = ( srcBMap->GetCurrWidth() * srcBMap->GetCurrHeight() ) >> 4;
+    hsAssert( srcBMap->fDirectXInfo.fBlockSize == 8, "Unexpected DXT1 block size" );
 
-    blockSize = srcBMap->fDirectXInfo.fBlockSize >> 1; // In 16-bit words
-    srcData = (uint16_t *)srcBMap->GetCurrLevelPtr();
     // Note our trick here to make sure nothing breaks if GetAddr32's 
     // formula changes
-    bMapStride = (uint32_t)( destBMap->GetAddr32( 0, 1 ) - destBMap->GetAddr32( 0, 0 ) );
-    x = y = 0;
+    uint32_t bMapStride = (uint32_t)( destBMap->GetAddr32( 0, 1 ) - destBMap->GetAddr32( 0, 0 ) );
+
+    IDecodeBlockRows( hsDXTSoftwareCodecKernels::decode_dxt1_to32.call, (const uint8_t *)srcBMap->GetCurrLevelPtr(), srcBMap->fDirectXInfo.fBlockSize,
+                      destBMap->GetAddr32( 0, 0 ), srcBMap->GetCurrWidth() >> 2, srcBMap->GetCurrHeight() >> 2, bMapStride );
+}
+
+//// decode_dxt1_to32_fpu /////////////////////////////////////////////////////
+//  One row of blocks worth of IUncompressMipmapDXT1To32.
+
+void    hsDXTSoftwareCodecKernels::decode_dxt1_to32_fpu( const uint8_t *src, uint32_t *dest, uint32_t numBlocks, uint32_t destStride )
+{
+    uint32_t      *destData, destBlock[ 16 ];
+    uint32_t      bitSource, bitSource2;
+    uint32_t      colors[ 4 ];
+    uint32_t      i, j;
 
 
-    /// Loop through the # of blocks (width*height / 16-pixel-blocks)
     for( i = 0; i < numBlocks; i++ )
     {
-        /// Decompress color data block
-        colors[ 0 ] = IRGB16To32Bit( srcData[ 0 ] ) | 0xff000000;
-        colors[ 1 ] = IRGB16To32Bit( srcData[ 1 ] ) | 0xff000000;
-
-        tempW1 = hsToLE16( srcData[ 0 ] );
-        tempW2 = hsToLE16( srcData[ 1 ] );
+        const uint16_t *srcData = (const uint16_t *)src;
 
-        if( tempW1 > tempW2 )
-        {
-            /// Four-color block--mix the other two
-            colors[ 2 ] = IMixTwoThirdsRGB32( colors[ 0 ], colors[ 1 ] ) | 0xff000000;
-            colors[ 3 ] = IMixTwoThirdsRGB32( colors[ 1 ], colors[ 0 ] ) | 0xff000000;
-        }
-        else
-        {
-            /// Three-color block and transparent
-            colors[ 2 ] = IMixEqualRGB32( colors[ 0 ], colors[ 1 ] ) | 0xff000000;
-            colors[ 3 ] = 0;
-        }
+        /// Decompress color data block
+        DXT1ColorPalette( srcData, colors );
 
         bitSource = hsToLE16( srcData[ 2 ] );
         bitSource2 = hsToLE16( srcData[ 3 ] );
@@ -1458,36 +1494,16 @@ void    hsDXTSoftwareCodec::IUncompressMipmapDXT1To32( plMipmap *destBMap,
         }
         
         /// Now copy the block to the destination bitmap
-        /// (Trust me, this is actually *faster* than memcpy for some reason
-        destData = destBMap->GetAddr32( x, y );
-        destData[ 0 ] = destBlock[ 0 ];
-        destData[ 1 ] = destBlock[ 1 ];
-        destData[ 2 ] = destBlock[ 2 ];
-        destData[ 3 ] = destBlock[ 3 ];
-        destData += bMapStride;
-        destData[ 0 ] = destBlock[ 4 ];
-        destData[ 1 ] = destBlock[ 5 ];
-        destData[ 2 ] = destBlock[ 6 ];
-        destData[ 3 ] = destBlock[ 7 ];
-        destData += bMapStride;
-        destData[ 0 ] = destBlock[ 8 ];
-        destData[ 1 ] = destBlock[ 9 ];
-        destData[ 2 ] = destBlock[ 10 ];
-        destData[ 3 ] = destBlock[ 11 ];
-        destData += bMapStride;
-        destData[ 0 ] = destBlock[ 12 ];
-        destData[ 1 ] = destBlock[ 13 ];
-        destData[ 2 ] = destBlock[ 14 ];
-        destData[ 3 ] = destBlock[ 15 ];
-
-        /// Increment and loop!
-        srcData += blockSize;
-        x += 4;
-        if( x == srcBMap->GetCurrWidth() )
+        destData = dest + i * 4;
+        for( j = 0; j < 16; j += 4, destData += destStride )
         {
-            x = 0;
-            y += 4;
+            destData[ 0 ] = destBlock[ j ];
+            destData[ 1 ] = destBlock[ j + 1 ];
+            destData[ 2 ] = destBlock[ j + 2 ];
+            destData[ 3 ] = destBlock[ j + 3 ];
         }
+
+        src += 8;
     }
 }
 
@@ -1926,30 +1942,55 @@ uint8_t   hsDXTSoftwareCodec::IMixEqualInten( uint8_t color1, uint8_t color2 )
 
 
 void hsDXTSoftwareCodec::CompressMipmapLevel( plMipmap *uncompressed, plMipmap *compressed )
+{
+    uint32_t yMax = uncompressed->GetCurrHeight() >> 2;
+    uint32_t numBlocks = (uncompressed->GetCurrWidth() >> 2) * yMax;
+
+    // Every block is coded on its own, so rows of them can go to any thread
+    auto compressRows = [=](size_t begin, size_t end) {
+        ICompressBlockRows(uncompressed, compressed, uint32_t(begin), uint32_t(end));
+    };
+
+    if (numBlocks >= kMinParallelBlocks && hsJobSystem::InstanceValid())
+    {
+        size_t grain = std::max<size_t>(1, kMinParallelBlocks / (uncompressed->GetCurrWidth() >> 2));
+        hsJobSystem::Instance().ParallelFor(0, yMax, grain, compressRows);
+    }
+    else
+        compressRows(0, yMax);
+}
+
+void hsDXTSoftwareCodec::ICompressBlockRows( plMipmap *uncompressed, plMipmap *compressed, uint32_t begin, uint32_t end )
 {
     uint32_t *compressedImage = (uint32_t *)compressed->GetCurrLevelPtr();
     int32_t x, y;
     int32_t xMax = uncompressed->GetCurrWidth() >> 2;
-    int32_t yMax = uncompressed->GetCurrHeight() >> 2;
-    for (x = 0; x < xMax; ++x)
+    for (y = begin; y < (int32_t)end; ++y)
     {
-        for (y = 0; y < yMax; ++y)
+        for (x = 0; x < xMax; ++x)
         {
             uint8_t maxAlpha = 0;
             uint8_t minAlpha = 255;
             uint8_t oldMaxAlpha = 0;
             uint8_t oldMinAlpha = 255;
             uint8_t alpha[8];
-            int32_t maxDistance = 0;
             hsRGBAColor32 color[4];
             bool hasTransparency = false;
 
+            // The block's pixels, column by column
+            hsRGBAColor32 pixels[16];
             int32_t xx, yy;
+            for (xx = 0; xx < 4; ++xx)
+            {
+                for (yy = 0; yy < 4; ++yy)
+                    pixels[4 * xx + yy] = *(hsRGBAColor32*)uncompressed->GetAddr32(4 * x + xx, 4 * y + yy);
+            }
+
             for (xx = 0; xx < 4; ++xx)
             {
                 for (yy = 0; yy < 4; ++yy)
                 {
-                    hsRGBAColor32* pixel = (hsRGBAColor32*)uncompressed->GetAddr32(4 * x + xx, 4 * y + yy);
+                    hsRGBAColor32* pixel = &pixels[4 * xx + yy];
                     uint8_t pixelAlpha = pixel->a;
                     if (pixelAlpha != 255)
                     {
@@ -1978,26 +2019,10 @@ void hsDXTSoftwareCodec::CompressMipmapLevel( plMipmap *uncompressed, plMipmap *
                             oldMinAlpha = minAlpha;
                         }
                     }
-                    
-                    int32_t xx2, yy2;
-                    for (xx2 = 0; xx2 < 4; ++xx2)
-                    {
-                        for (yy2 = 0; yy2 < 4; ++yy2)
-                        {
-                            hsRGBAColor32* pixel1 = (hsRGBAColor32*)uncompressed->GetAddr32(4 * x + xx, 4 * y + yy);
-                            hsRGBAColor32* pixel2 = (hsRGBAColor32*)uncompressed->GetAddr32(4 * x + xx2, 4 * y + yy2);
-                            
-                            int32_t distance = ColorDistanceARGBSquared(*pixel1, *pixel2);
-                            if (distance >= maxDistance)
-                            {
-                                maxDistance = distance;
-                                color[0] = *pixel1;
-                                color[1] = *pixel2;
-                            }
-                        } // for yy2
-                    } // for xx2
                 } // for yy
             } // for xx
+
+            hsDXTSoftwareCodecKernels::find_endpoints.call(pixels, color[0], color[1]);
             
             if (oldMinAlpha == 255)
             {
@@ -2129,7 +2154,7 @@ void hsDXTSoftwareCodec::CompressMipmapLevel( plMipmap *uncompressed, plMipmap *
             {
                 for (yy = 0; yy < 4; ++yy)
                 {
-                    hsRGBAColor32* pixel = (hsRGBAColor32*)uncompressed->GetAddr32(4 * x + xx, 4 * y + yy);
+                    hsRGBAColor32* pixel = &pixels[4 * xx + yy];
                     uint8_t pixelAlpha = pixel->a;
                     if (alphaBlock)
                     {
@@ -2211,8 +2236,30 @@ void hsDXTSoftwareCodec::CompressMipmapLevel( plMipmap *uncompressed, plMipmap *
             
             colorBlock[0] = shortColor[0];
             colorBlock[1] = shortColor[1];
-        } // for y
-    } // for x
+        } // for x
+    } // for y
+}
+
+//// find_endpoints_fpu ///////////////////////////////////////////////////////
+//  Tries every pair of pixels. Ties go to the last pair tried, which is what
+//  the SIMD versions have to match.
+
+void hsDXTSoftwareCodecKernels::find_endpoints_fpu(const hsRGBAColor32* pixels, hsRGBAColor32& color0, hsRGBAColor32& color1)
+{
+    int32_t maxDistance = 0;
+    for (int32_t i = 0; i < 16; ++i)
+    {
+        for (int32_t j = 0; j < 16; ++j)
+        {
+            int32_t distance = hsDXTSoftwareCodec::ColorDistanceARGBSquared(pixels[i], pixels[j]);
+            if (distance >= maxDistance)
+            {
+                maxDistance = distance;
+                color0 = pixels[i];
+                color1 = pixels[j];
+            }
+        }
+    }
 }
 
 uint16_t hsDXTSoftwareCodec::BlendColors16(uint16_t weight1, uint16_t color1, uint16_t weight2, uint16_t color2)
@@ -2278,6 +2325,33 @@ bool hsDXTSoftwareCodec::Register()
     return hsCodecManager::Instance().Register(&(Instance()), plMipmap::kDirectXCompression, 100);
 }
 
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<hsDXTSoftwareCodecKernels::decode_blocks_ptr> hsDXTSoftwareCodecKernels::decode_dxt1_to32 {
+    &hsDXTSoftwareCodecKernels::decode_dxt1_to32_fpu,
+    nullptr,                                // SSE1
+    nullptr,                                // SSE2
+    nullptr,                                // SSE3
+    nullptr,                                // SSSE3
+    nullptr,                                // SSE41
+    nullptr,                                // SSE42
+    nullptr,                                // AVX
+    &hsDXTSoftwareCodecKernels::decode_dxt1_to32_avx2
+};
+hsCpuFunctionDispatcher<hsDXTSoftwareCodecKernels::decode_blocks_ptr> hsDXTSoftwareCodecKernels::decode_dxt5_to32 {
+    &hsDXTSoftwareCodecKernels::decode_dxt5_to32_fpu,
+    nullptr,                                // SSE1
+    nullptr,                                // SSE2
+    nullptr,                                // SSE3
+    nullptr,                                // SSSE3
+    nullptr,                                // SSE41
+    nullptr,                                // SSE42
+    nullptr,                                // AVX
+    &hsDXTSoftwareCodecKernels::decode_dxt5_to32_avx2
+};
+hsCpuFunctionDispatcher<hsDXTSoftwareCodecKernels::find_endpoints_ptr> hsDXTSoftwareCodecKernels::find_endpoints {
+    &hsDXTSoftwareCodecKernels::find_endpoints_fpu, nullptr, &hsDXTSoftwareCodecKernels::find_endpoints_sse2
+};
+
 //// ICalcCompressedFormat ////////////////////////////////////////////////////
 //  Determine the DXT compression format based on a bitmap.
 
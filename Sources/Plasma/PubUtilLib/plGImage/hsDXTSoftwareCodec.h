@@ -67,16 +67,21 @@ public:
     bool    ColorizeCompMipmap(plMipmap *bMap, const uint8_t *colorMask) override;
 
 private:
+    // The block kernels share the color helpers below
+    friend class hsDXTSoftwareCodecKernels;
+
     enum {
         kFourColorEncoding,
         kThreeColorEncoding
     };
 
     void    CompressMipmapLevel( plMipmap *uncompressed, plMipmap *compressed );
+    // Compresses block rows [begin, end) of the current level
+    void    ICompressBlockRows( plMipmap *uncompressed, plMipmap *compressed, uint32_t begin, uint32_t end );
 
     uint16_t BlendColors16(uint16_t weight1, uint16_t color1, uint16_t weight2, uint16_t color2);
     hsRGBAColor32 BlendColors32(uint32_t weight1, hsRGBAColor32 color1, uint32_t weight2, hsRGBAColor32 color2);
-    int32_t ColorDistanceARGBSquared(hsRGBAColor32 color1, hsRGBAColor32 color2);
+    static int32_t ColorDistanceARGBSquared(hsRGBAColor32 color1, hsRGBAColor32 color2);
     uint16_t Color32To16(hsRGBAColor32 color);
 
     // Calculates the DXT format based on a mipmap
@@ -112,9 +117,9 @@ private:
     void    IUncompressMipmapDXT5ToAInten( plMipmap *destBMap, plMipmap *srcBMap );
 
     // Mixes two RGB8888 colors equally
-    uint32_t inline IMixEqualRGB32( uint32_t color1, uint32_t color2 );
+    static uint32_t inline IMixEqualRGB32( uint32_t color1, uint32_t color2 );
     // Mixes two-thirds of the first RGB8888 color and one-third of the second
-    uint32_t inline IMixTwoThirdsRGB32( uint32_t twoThirds, uint32_t oneThird );
+    static uint32_t inline IMixTwoThirdsRGB32( uint32_t twoThirds, uint32_t oneThird );
 
     // Mixes two RGB1555 colors equally
     uint16_t inline IMixEqualRGB1555( uint16_t color1, uint16_t color2 );
@@ -137,7 +142,7 @@ private:
     uint8_t  inline IMixTwoThirdsInten( uint8_t twoThirds, uint8_t oneThird );
 
     // Converts a color from RGB565 to RGB8888 format, with alpha=0
-    uint32_t inline IRGB16To32Bit( uint16_t color );
+    static uint32_t inline IRGB16To32Bit( uint16_t color );
     // Converts a color from RGB565 to RGB4444 format, with alpha=0
     uint16_t inline IRGB565To4444( uint16_t color );
     // Converts a color from RGB565 to RGB1555 format, with alpha=0
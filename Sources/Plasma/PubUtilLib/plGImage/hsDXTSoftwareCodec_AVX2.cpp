@@ -0,0 +1,121 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "HeadSpin.h"
+#include "hsDXTSoftwareCodec_Private.h"
+
+#ifdef HAVE_AVX2
+#   include <cstring>
+#   include <immintrin.h>
+
+// Eight pixels, two rows of a block, per lookup: each lane shifts its own
+// index out of the packed bits and fetches its palette entry with a permute.
+// Pixel n of the pair of rows sits at bit 3n of the alpha indices and bit 2n
+// of the color indices.
+static inline __m256i IColorIndices(uint32_t bits)
+{
+    const __m256i shifts = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+    return _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(int(bits)), shifts), _mm256_set1_epi32(3));
+}
+
+static inline __m256i IAlphaIndices(uint32_t bits)
+{
+    const __m256i shifts = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    return _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(int(bits)), shifts), _mm256_set1_epi32(7));
+}
+
+static inline void IStoreRows(uint32_t* dest, uint32_t destStride, __m256i pixels)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm256_castsi256_si128(pixels));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + destStride), _mm256_extracti128_si256(pixels, 1));
+}
+
+static inline uint16_t IColorBits(const uint8_t* bits)
+{
+    uint16_t value;
+    memcpy(&value, bits, sizeof(value));
+    return value;
+}
+#endif // HAVE_AVX2
+
+void hsDXTSoftwareCodecKernels::decode_dxt1_to32_avx2(const uint8_t* src, uint32_t* dest, uint32_t numBlocks, uint32_t destStride)
+{
+#ifdef HAVE_AVX2
+    uint32_t colors[4];
+
+    for (uint32_t i = 0; i < numBlocks; i++, src += 8)
+    {
+        DXT1ColorPalette(reinterpret_cast<const uint16_t*>(src), colors);
+        __m256i colorPal = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(colors)));
+
+        uint32_t* out = dest + i * 4;
+        IStoreRows(out, destStride, _mm256_permutevar8x32_epi32(colorPal, IColorIndices(IColorBits(src + 4))));
+        IStoreRows(out + 2 * destStride, destStride, _mm256_permutevar8x32_epi32(colorPal, IColorIndices(IColorBits(src + 6))));
+    }
+#endif // HAVE_AVX2
+}
+
+void hsDXTSoftwareCodecKernels::decode_dxt5_to32_avx2(const uint8_t* src, uint32_t* dest, uint32_t numBlocks, uint32_t destStride)
+{
+#ifdef HAVE_AVX2
+    uint32_t alphas[8], colors[4];
+
+    for (uint32_t i = 0; i < numBlocks; i++, src += 16)
+    {
+        DXT5AlphaPalette(src, alphas);
+        DXT5ColorPalette(reinterpret_cast<const uint16_t*>(src + 8), colors);
+        __m256i alphaPal = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(alphas));
+        __m256i colorPal = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(colors)));
+
+        uint32_t aBits1 = src[2] | (src[3] << 8) | (src[4] << 16);
+        uint32_t aBits2 = src[5] | (src[6] << 8) | (src[7] << 16);
+
+        uint32_t* out = dest + i * 4;
+        IStoreRows(out, destStride,
+                   _mm256_or_si256(_mm256_permutevar8x32_epi32(alphaPal, IAlphaIndices(aBits1)),
+                                   _mm256_permutevar8x32_epi32(colorPal, IColorIndices(IColorBits(src + 12)))));
+        IStoreRows(out + 2 * destStride, destStride,
+                   _mm256_or_si256(_mm256_permutevar8x32_epi32(alphaPal, IAlphaIndices(aBits2)),
+                                   _mm256_permutevar8x32_epi32(colorPal, IColorIndices(IColorBits(src + 14)))));
+    }
+#endif // HAVE_AVX2
+}
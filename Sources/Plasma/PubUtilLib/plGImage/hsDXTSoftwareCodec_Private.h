@@ -0,0 +1,79 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#ifndef __HSDXTSOFTWARECODEC_PRIVATE_H
+#define __HSDXTSOFTWARECODEC_PRIVATE_H
+
+#include "HeadSpin.h"
+#include "hsCpuID.h"
+#include "hsDXTSoftwareCodec.h"
+
+// The block kernels behind hsDXTSoftwareCodec, one per instruction set, and
+// the palettes they share. Kept out of the codec's header so that only
+// plGImage and plDXTBenchmark see them.
+class hsDXTSoftwareCodecKernels
+{
+public:
+    // Decodes a row of numBlocks 4x4 blocks into 32-bit ARGB pixels. dest is
+    // the top left pixel of the row and destStride is in pixels.
+    typedef void(*decode_blocks_ptr)(const uint8_t* src, uint32_t* dest, uint32_t numBlocks, uint32_t destStride);
+    // Picks the two colors of a 4x4 block that are farthest apart
+    typedef void(*find_endpoints_ptr)(const hsRGBAColor32* pixels, hsRGBAColor32& color0, hsRGBAColor32& color1);
+
+    static void decode_dxt1_to32_fpu(const uint8_t* src, uint32_t* dest, uint32_t numBlocks, uint32_t destStride);
+    static void decode_dxt1_to32_avx2(const uint8_t* src, uint32_t* dest, uint32_t numBlocks, uint32_t destStride);
+    static void decode_dxt5_to32_fpu(const uint8_t* src, uint32_t* dest, uint32_t numBlocks, uint32_t destStride);
+    static void decode_dxt5_to32_avx2(const uint8_t* src, uint32_t* dest, uint32_t numBlocks, uint32_t destStride);
+    static void find_endpoints_fpu(const hsRGBAColor32* pixels, hsRGBAColor32& color0, hsRGBAColor32& color1);
+    static void find_endpoints_sse2(const hsRGBAColor32* pixels, hsRGBAColor32& color0, hsRGBAColor32& color1);
+
+    static hsCpuFunctionDispatcher<decode_blocks_ptr> decode_dxt1_to32;
+    static hsCpuFunctionDispatcher<decode_blocks_ptr> decode_dxt5_to32;
+    static hsCpuFunctionDispatcher<find_endpoints_ptr> find_endpoints;
+
+    // Block palettes, shared by every implementation of the decoders above
+    static void DXT1ColorPalette( const uint16_t *block, uint32_t *colors );
+    static void DXT5ColorPalette( const uint16_t *block, uint32_t *colors );
+    static void DXT5AlphaPalette( const uint8_t *block, uint32_t *alphas );
+};
+
+#endif // __HSDXTSOFTWARECODEC_PRIVATE_H
@@ -0,0 +1,114 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "HeadSpin.h"
+#include "hsColorRGBA.h"
+#include "hsDXTSoftwareCodec_Private.h"
+
+#ifdef HAVE_SSE2
+#   include <emmintrin.h>
+
+// SSE2 has no signed 32-bit max
+static inline __m128i IMax(__m128i a, __m128i b)
+{
+    __m128i greater = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+}
+#endif // HAVE_SSE2
+
+void hsDXTSoftwareCodecKernels::find_endpoints_sse2(const hsRGBAColor32* pixels, hsRGBAColor32& color0, hsRGBAColor32& color1)
+{
+#ifdef HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgbMask = _mm_set1_epi32(0x00ffffff);
+
+    // Widen the pixels to 16 bits a channel, two to a register, and drop their
+    // alpha so it doesn't count towards the distance
+    __m128i wide[8];
+    for (int k = 0; k < 4; ++k)
+    {
+        __m128i p = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 4 * k)), rgbMask);
+        wide[2 * k] = _mm_unpacklo_epi8(p, zero);
+        wide[2 * k + 1] = _mm_unpackhi_epi8(p, zero);
+    }
+
+    // All 256 distances, in the same order find_endpoints_fpu tries them
+    alignas(16) int32_t distances[256];
+    __m128i maxDistance = zero;
+    for (int i = 0; i < 16; ++i)
+    {
+        __m128i pi = (i & 1) ? _mm_unpackhi_epi64(wide[i >> 1], wide[i >> 1])
+                             : _mm_unpacklo_epi64(wide[i >> 1], wide[i >> 1]);
+        for (int k = 0; k < 4; ++k)
+        {
+            __m128i d0 = _mm_sub_epi16(pi, wide[2 * k]);
+            __m128i d1 = _mm_sub_epi16(pi, wide[2 * k + 1]);
+            // Each pixel comes out as b*b + g*g and r*r, which get summed here
+            __m128 s0 = _mm_castsi128_ps(_mm_madd_epi16(d0, d0));
+            __m128 s1 = _mm_castsi128_ps(_mm_madd_epi16(d1, d1));
+            __m128i d = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(s0, s1, _MM_SHUFFLE(2, 0, 2, 0))),
+                                      _mm_castps_si128(_mm_shuffle_ps(s0, s1, _MM_SHUFFLE(3, 1, 3, 1))));
+            _mm_store_si128(reinterpret_cast<__m128i*>(distances + i * 16 + k * 4), d);
+            maxDistance = IMax(maxDistance, d);
+        }
+    }
+
+    // Spread the biggest distance to every lane
+    maxDistance = IMax(maxDistance, _mm_shuffle_epi32(maxDistance, _MM_SHUFFLE(2, 3, 0, 1)));
+    maxDistance = IMax(maxDistance, _mm_shuffle_epi32(maxDistance, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    // Ties go to the last pair, so search from the back
+    for (int v = 63; v >= 0; --v)
+    {
+        __m128i d = _mm_load_si128(reinterpret_cast<const __m128i*>(distances + v * 4));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(d, maxDistance)));
+        if (mask)
+        {
+            int lane = (mask & 8) ? 3 : (mask & 4) ? 2 : (mask & 2) ? 1 : 0;
+            int pair = v * 4 + lane;
+            color0 = pixels[pair >> 4];
+            color1 = pixels[pair & 15];
+            return;
+        }
+    }
+#endif // HAVE_SSE2
+}
@@ -66,9 +66,17 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include <string>
 
 #include "plFont.h"
+#include "plFont_Private.h"
 
 #include "plMipmap.h"
 #include "hsResMgr.h"
+#include "plProfile.h"
+
+plProfile_CreateCounter("FontExtentsHits", "PipeC", FontExtentsHits);
+plProfile_CreateCounter("FontExtentsMisses", "PipeC", FontExtentsMisses);
+
+// How many CalcStringExtents() results each font remembers
+static const size_t kMaxCachedExtents = 1024;
 
 
 //// plCharacter Stuff ////////////////////////////////////////////////////////
@@ -128,6 +136,7 @@ void    plFont::IClear( bool onConstruct )
     fFirstChar = 0;
     fMaxCharHeight = 0;
     fCharacters.clear();
+    fExtentsCache.clear();
 
     fRenderInfo.fFlags = 0;
     fRenderInfo.fX = fRenderInfo.fY = fRenderInfo.fNumCols = 0;
@@ -188,6 +197,8 @@ void    plFont::ICalcFontAscent()
     fFontAscent = 0;
     fFontDescent = 0;
     fMaxCharHeight = 0;
+    // Any extents measured with the old glyphs are stale now
+    fExtentsCache.clear();
     for (size_t i = 0; i < fCharacters.size(); i++)
     {
         if( i + fFirstChar < 128 && fFontAscent < fCharacters[ i ].fBaseline )
@@ -845,9 +856,7 @@ void    plFont::IRenderChar8To32( const plFont::plCharacter &c )
 {
     uint8_t   *src = fBMapData + c.fBitmapOff;
     uint32_t  *destPtr, *destBasePtr = (uint32_t *)(fRenderInfo.fDestPtr - c.fBaseline * int32_t(fRenderInfo.fDestStride));
-    int16_t   x, y, thisHeight, xstart, thisWidth;
-    uint32_t  srcAlpha, oneMinusAlpha, r, g, b, dR, dG, dB, destAlpha;
-    uint8_t   srcR, srcG, srcB;
+    int16_t   y, thisHeight, xstart, thisWidth;
 
 
     // Unfortunately for some fonts, their right kern value actually is
@@ -865,10 +874,6 @@ void    plFont::IRenderChar8To32( const plFont::plCharacter &c )
     if( xstart < 0 )
         xstart = 0;
 
-    srcR = (uint8_t)(( fRenderInfo.fColor >> 16 ) & 0x000000ff);
-    srcG = (uint8_t)(( fRenderInfo.fColor >> 8  ) & 0x000000ff);
-    srcB = (uint8_t)(( fRenderInfo.fColor       ) & 0x000000ff);
-
     y = fRenderInfo.fClipRect.fY - fRenderInfo.fY + (int16_t)c.fBaseline;
     if( y < 0 )
         y = 0;
@@ -882,35 +887,13 @@ void    plFont::IRenderChar8To32( const plFont::plCharacter &c )
     if( thisHeight > (int16_t)c.fHeight )
         thisHeight = (int16_t)c.fHeight;
 
+    if( xstart >= thisWidth )
+        return;
+
     for( ; y < thisHeight; y++ )
     {
         destPtr = destBasePtr;
-        for( x = xstart; x < thisWidth; x++ )
-        {
-            if( src[ x ] == 255 )
-                destPtr[ x ] = fRenderInfo.fColor;
-            else if( src[ x ] == 0 )
-                ;   // Empty
-            else
-            {
-                srcAlpha = ( src[ x ] * ( fRenderInfo.fColor >> 24 ) ) / 255;
-                oneMinusAlpha = 255 - srcAlpha;
-
-                destAlpha = destPtr[ x ] & 0xff000000;
-
-                dR = ( destPtr[ x ] >> 16 ) & 0x000000ff;
-                dG = ( destPtr[ x ] >> 8  ) & 0x000000ff;
-                dB = ( destPtr[ x ]       ) & 0x000000ff;
-                r = ( srcR * srcAlpha ) >> 8;
-                g = ( srcG * srcAlpha ) >> 8;
-                b = ( srcB * srcAlpha ) >> 8;
-                dR = ( dR * oneMinusAlpha ) >> 8;
-                dG = ( dG * oneMinusAlpha ) >> 8;
-                dB = ( dB * oneMinusAlpha ) >> 8;
-
-                destPtr[ x ] = ( ( r + dR ) << 16 ) | ( ( g + dG ) << 8 ) | ( b + dB ) | destAlpha;
-            }
-        }
+        plFontKernels::blend_8to32.call( src + xstart, destPtr + xstart, thisWidth - xstart, fRenderInfo.fColor );
         destBasePtr = (uint32_t *)( (uint8_t *)destBasePtr + fRenderInfo.fDestStride );
         src += fWidth;
     }
@@ -920,8 +903,7 @@ void    plFont::IRenderChar8To32FullAlpha( const plFont::plCharacter &c )
 {
     uint8_t   *src = fBMapData + c.fBitmapOff;
     uint32_t  *destPtr, *destBasePtr = (uint32_t *)(fRenderInfo.fDestPtr - c.fBaseline * int32_t(fRenderInfo.fDestStride));
-    int16_t   x, y, thisHeight, xstart, thisWidth;
-    uint32_t  destColorOnly;
+    int16_t   y, thisHeight, xstart, thisWidth;
 
 
     // Unfortunately for some fonts, their right kern value actually is
@@ -939,8 +921,6 @@ void    plFont::IRenderChar8To32FullAlpha( const plFont::plCharacter &c )
     if( xstart < 0 )
         xstart = 0;
 
-    destColorOnly = fRenderInfo.fColor & 0x00ffffff;
-
     y = fRenderInfo.fClipRect.fY - fRenderInfo.fY + (int16_t)c.fBaseline;
     if( y < 0 )
         y = 0;
@@ -954,14 +934,13 @@ void    plFont::IRenderChar8To32FullAlpha( const plFont::plCharacter &c )
     if( thisHeight > (int16_t)c.fHeight )
         thisHeight = (int16_t)c.fHeight;
 
+    if( xstart >= thisWidth )
+        return;
+
     for( ; y < thisHeight; y++ )
     {
         destPtr = destBasePtr;
-        for( x = xstart; x < thisWidth; x++ )
-        {
-            if( src[ x ] != 0 )
-                destPtr[ x ] = ( src[ x ] << 24 ) | destColorOnly;
-        }
+        plFontKernels::full_alpha_8to32.call( src + xstart, destPtr + xstart, thisWidth - xstart, fRenderInfo.fColor );
         destBasePtr = (uint32_t *)( (uint8_t *)destBasePtr + fRenderInfo.fDestStride );
         src += fWidth;
     }
@@ -969,10 +948,9 @@ void    plFont::IRenderChar8To32FullAlpha( const plFont::plCharacter &c )
 
 void    plFont::IRenderChar8To32Alpha( const plFont::plCharacter &c )
 {
-    uint8_t   val, *src = fBMapData + c.fBitmapOff;
+    uint8_t   *src = fBMapData + c.fBitmapOff;
     uint32_t  *destPtr, *destBasePtr = (uint32_t *)(fRenderInfo.fDestPtr - c.fBaseline * int32_t(fRenderInfo.fDestStride));
-    int16_t   x, y, thisHeight, xstart, thisWidth;
-    uint32_t  destColorOnly, alphaMult, fullAlpha;
+    int16_t   y, thisHeight, xstart, thisWidth;
 
 
     // Unfortunately for some fonts, their right kern value actually is
@@ -990,12 +968,6 @@ void    plFont::IRenderChar8To32Alpha( const plFont::plCharacter &c )
     if( xstart < 0 )
         xstart = 0;
 
-    destColorOnly = fRenderInfo.fColor & 0x00ffffff;
-    // alphaMult should come out to be a value to satisfy (fontAlpha * alphaMult >> 8) as the right alpha,
-    // but then we want it so (fontAlpha * alphaMult) will be in the upper 8 bits
-    fullAlpha = fRenderInfo.fColor & 0xff000000;
-    alphaMult = fullAlpha / 255;
-
     y = fRenderInfo.fClipRect.fY - fRenderInfo.fY + (int16_t)c.fBaseline;
     if( y < 0 )
         y = 0;
@@ -1009,19 +981,13 @@ void    plFont::IRenderChar8To32Alpha( const plFont::plCharacter &c )
     if( thisHeight > (int16_t)c.fHeight )
         thisHeight = (int16_t)c.fHeight;
 
+    if( xstart >= thisWidth )
+        return;
+
     for( ; y < thisHeight; y++ )
     {
         destPtr = destBasePtr;
-        for( x = xstart; x < thisWidth; x++ )
-        {
-            val = src[ x ];
-            if( val == 0xff )
-                destPtr[ x ] = fullAlpha | destColorOnly;
-            else if( val != 0 )
-            {
-                destPtr[ x ] = ( ( alphaMult * val ) & 0xff000000 ) | destColorOnly;
-            }
-        }
+        plFontKernels::alpha_8to32.call( src + xstart, destPtr + xstart, thisWidth - xstart, fRenderInfo.fColor );
         destBasePtr = (uint32_t *)( (uint8_t *)destBasePtr + fRenderInfo.fDestStride );
         src += fWidth;
     }
@@ -1031,8 +997,7 @@ void    plFont::IRenderChar8To32AlphaPremultiplied( const plFont::plCharacter &c
 {
     uint8_t   *src = fBMapData + c.fBitmapOff;
     uint32_t  *destPtr, *destBasePtr = (uint32_t *)(fRenderInfo.fDestPtr - c.fBaseline * int32_t(fRenderInfo.fDestStride));
-    int16_t   x, y, thisHeight, xstart, thisWidth;
-    uint8_t   srcA, srcR, srcG, srcB;
+    int16_t   y, thisHeight, xstart, thisWidth;
 
 
     // Unfortunately for some fonts, their right kern value actually is
@@ -1050,11 +1015,6 @@ void    plFont::IRenderChar8To32AlphaPremultiplied( const plFont::plCharacter &c
     if( xstart < 0 )
         xstart = 0;
 
-    srcA = (uint8_t)(( fRenderInfo.fColor >> 24 ) & 0x000000ff);
-    srcR = (uint8_t)(( fRenderInfo.fColor >> 16 ) & 0x000000ff);
-    srcG = (uint8_t)(( fRenderInfo.fColor >> 8  ) & 0x000000ff);
-    srcB = (uint8_t)(( fRenderInfo.fColor       ) & 0x000000ff);
-
     y = fRenderInfo.fClipRect.fY - fRenderInfo.fY + (int16_t)c.fBaseline;
     if( y < 0 )
         y = 0;
@@ -1068,19 +1028,13 @@ void    plFont::IRenderChar8To32AlphaPremultiplied( const plFont::plCharacter &c
     if( thisHeight > (int16_t)c.fHeight )
         thisHeight = (int16_t)c.fHeight;
 
+    if( xstart >= thisWidth )
+        return;
+
     for( ; y < thisHeight; y++ )
     {
         destPtr = destBasePtr;
-        for( x = xstart; x < thisWidth; x++ )
-        {
-            uint32_t a = src[ x ];
-            if (a != 0)
-            {
-                if (srcA != 0xff)
-                    a = (srcA*a + 127)/255;
-                destPtr[ x ] = ( a << 24 ) | (((srcR*a + 127)/255) << 16) | (((srcG*a + 127)/255) << 8) | ((srcB*a + 127)/255);
-            }
-        }
+        plFontKernels::alpha_prem_8to32.call( src + xstart, destPtr + xstart, thisWidth - xstart, fRenderInfo.fColor );
         destBasePtr = (uint32_t *)( (uint8_t *)destBasePtr + fRenderInfo.fDestStride );
         src += fWidth;
     }
@@ -1171,6 +1125,112 @@ void    plFont::IRenderCharNull( const plCharacter &c )
 {
 }
 
+//// 8-bit Glyph Row Blitters /////////////////////////////////////////////////
+//  The per-pixel math of the IRenderChar8To32* functions, one glyph row at a
+//  time. The SSE2 versions live in plFont_SSE2.cpp and must match these bit
+//  for bit.
+
+void    plFontKernels::blend_8to32_fpu( const uint8_t *src, uint32_t *dest, int32_t count, uint32_t color )
+{
+    uint32_t  srcAlpha, oneMinusAlpha, r, g, b, dR, dG, dB, destAlpha;
+    uint8_t   srcR, srcG, srcB;
+
+    srcR = (uint8_t)(( color >> 16 ) & 0x000000ff);
+    srcG = (uint8_t)(( color >> 8  ) & 0x000000ff);
+    srcB = (uint8_t)(( color       ) & 0x000000ff);
+
+    for( int32_t x = 0; x < count; x++ )
+    {
+        if( src[ x ] == 255 )
+            dest[ x ] = color;
+        else if( src[ x ] == 0 )
+            ;   // Empty
+        else
+        {
+            srcAlpha = ( src[ x ] * ( color >> 24 ) ) / 255;
+            oneMinusAlpha = 255 - srcAlpha;
+
+            destAlpha = dest[ x ] & 0xff000000;
+
+            dR = ( dest[ x ] >> 16 ) & 0x000000ff;
+            dG = ( dest[ x ] >> 8  ) & 0x000000ff;
+            dB = ( dest[ x ]       ) & 0x000000ff;
+            r = ( srcR * srcAlpha ) >> 8;
+            g = ( srcG * srcAlpha ) >> 8;
+            b = ( srcB * srcAlpha ) >> 8;
+            dR = ( dR * oneMinusAlpha ) >> 8;
+            dG = ( dG * oneMinusAlpha ) >> 8;
+            dB = ( dB * oneMinusAlpha ) >> 8;
+
+            dest[ x ] = ( ( r + dR ) << 16 ) | ( ( g + dG ) << 8 ) | ( b + dB ) | destAlpha;
+        }
+    }
+}
+
+void    plFontKernels::full_alpha_8to32_fpu( const uint8_t *src, uint32_t *dest, int32_t count, uint32_t color )
+{
+    uint32_t destColorOnly = color & 0x00ffffff;
+
+    for( int32_t x = 0; x < count; x++ )
+    {
+        if( src[ x ] != 0 )
+            dest[ x ] = ( src[ x ] << 24 ) | destColorOnly;
+    }
+}
+
+void    plFontKernels::alpha_8to32_fpu( const uint8_t *src, uint32_t *dest, int32_t count, uint32_t color )
+{
+    uint32_t destColorOnly = color & 0x00ffffff;
+    // alphaMult should come out to be a value to satisfy (fontAlpha * alphaMult >> 8) as the right alpha,
+    // but then we want it so (fontAlpha * alphaMult) will be in the upper 8 bits
+    uint32_t fullAlpha = color & 0xff000000;
+    uint32_t alphaMult = fullAlpha / 255;
+
+    for( int32_t x = 0; x < count; x++ )
+    {
+        uint8_t val = src[ x ];
+        if( val == 0xff )
+            dest[ x ] = fullAlpha | destColorOnly;
+        else if( val != 0 )
+        {
+            dest[ x ] = ( ( alphaMult * val ) & 0xff000000 ) | destColorOnly;
+        }
+    }
+}
+
+void    plFontKernels::alpha_prem_8to32_fpu( const uint8_t *src, uint32_t *dest, int32_t count, uint32_t color )
+{
+    uint8_t srcA = (uint8_t)(( color >> 24 ) & 0x000000ff);
+    uint8_t srcR = (uint8_t)(( color >> 16 ) & 0x000000ff);
+    uint8_t srcG = (uint8_t)(( color >> 8  ) & 0x000000ff);
+    uint8_t srcB = (uint8_t)(( color       ) & 0x000000ff);
+
+    for( int32_t x = 0; x < count; x++ )
+    {
+        uint32_t a = src[ x ];
+        if (a != 0)
+        {
+            if (srcA != 0xff)
+                a = (srcA*a + 127)/255;
+            dest[ x ] = ( a << 24 ) | (((srcR*a + 127)/255) << 16) | (((srcG*a + 127)/255) << 8) | ((srcB*a + 127)/255);
+        }
+    }
+}
+
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<plFontKernels::blit_row_ptr> plFontKernels::blend_8to32 {
+    &plFontKernels::blend_8to32_fpu, nullptr, &plFontKernels::blend_8to32_sse2
+};
+hsCpuFunctionDispatcher<plFontKernels::blit_row_ptr> plFontKernels::full_alpha_8to32 {
+    &plFontKernels::full_alpha_8to32_fpu, nullptr, &plFontKernels::full_alpha_8to32_sse2
+};
+hsCpuFunctionDispatcher<plFontKernels::blit_row_ptr> plFontKernels::alpha_8to32 {
+    &plFontKernels::alpha_8to32_fpu, nullptr, &plFontKernels::alpha_8to32_sse2
+};
+hsCpuFunctionDispatcher<plFontKernels::blit_row_ptr> plFontKernels::alpha_prem_8to32 {
+    &plFontKernels::alpha_prem_8to32_fpu, nullptr, &plFontKernels::alpha_prem_8to32_sse2
+};
+
 //// CalcString Variations ////////////////////////////////////////////////////
 
 uint16_t  plFont::CalcStringWidth( const ST::string &string )
@@ -1197,6 +1257,29 @@ void    plFont::CalcStringExtents( const ST::string &string, uint16_t &width, ui
 
 void    plFont::CalcStringExtents( const wchar_t *string, uint16_t &width, uint16_t &height, uint16_t &ascent, uint32_t &firstClippedChar, uint16_t &lastX, uint16_t &lastY )
 {
+    // Text that gets redrawn (the KI, GUI labels, books) measures the same strings
+    // with the same settings over and over, so remember what we came up with
+    ExtentsKey key;
+    key.fString = string;
+    key.fFlags = fRenderInfo.fFlags & kRenderLayoutMask;
+    key.fClipRect = fRenderInfo.fClipRect;
+    key.fFirstLineIndent = fRenderInfo.fFirstLineIndent;
+    key.fLineSpacing = fRenderInfo.fLineSpacing;
+
+    auto cached = fExtentsCache.find(key);
+    if (cached != fExtentsCache.end())
+    {
+        plProfile_Inc(FontExtentsHits);
+        width = cached->second.fWidth;
+        height = cached->second.fHeight;
+        ascent = cached->second.fAscent;
+        lastX = cached->second.fLastX;
+        lastY = cached->second.fLastY;
+        firstClippedChar = cached->second.fFirstClippedChar;
+        return;
+    }
+
+    plProfile_Inc(FontExtentsMisses);
     IRenderString(nullptr, 0, 0, string, true);
     width = fRenderInfo.fFarthestX;
     height = (uint16_t)(fRenderInfo.fY + fFontDescent);//fRenderInfo.fMaxDescent;
@@ -1208,6 +1291,32 @@ void    plFont::CalcStringExtents( const wchar_t *string, uint16_t &width, uint1
     // that got clipped (i.e. not rendered).
     firstClippedChar = (uintptr_t)fRenderInfo.fVolatileStringPtr - (uintptr_t)string;
     firstClippedChar /= 2; // divide by 2 because a wchar_t is two bytes wide, instead of one (like a char)
+
+    // Nothing is ever evicted one at a time; a font that measures this many
+    // different strings just starts over
+    if (fExtentsCache.size() >= kMaxCachedExtents)
+        fExtentsCache.clear();
+    fExtentsCache.emplace(std::move(key), Extents{ width, height, ascent, lastX, lastY, firstClippedChar });
+}
+
+bool    plFont::ExtentsKey::operator==( const ExtentsKey &other ) const
+{
+    return fFlags == other.fFlags &&
+           fClipRect.fX == other.fClipRect.fX && fClipRect.fY == other.fClipRect.fY &&
+           fClipRect.fWidth == other.fClipRect.fWidth && fClipRect.fHeight == other.fClipRect.fHeight &&
+           fFirstLineIndent == other.fFirstLineIndent && fLineSpacing == other.fLineSpacing &&
+           fString == other.fString;
+}
+
+size_t  plFont::ExtentsKeyHash::operator()( const ExtentsKey &key ) const
+{
+    size_t hash = std::hash<std::wstring>()(key.fString);
+    auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+    combine(key.fFlags);
+    combine(((uint32_t)(uint16_t)key.fClipRect.fX << 16) | (uint16_t)key.fClipRect.fY);
+    combine(((uint32_t)(uint16_t)key.fClipRect.fWidth << 16) | (uint16_t)key.fClipRect.fHeight);
+    combine(((uint32_t)(uint16_t)key.fFirstLineIndent << 16) | (uint16_t)key.fLineSpacing);
+    return hash;
 }
 
 //// IGetFreeCharData /////////////////////////////////////////////////////////
@@ -66,6 +66,8 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "hsColorRGBA.h"
 #include "pcSmallRect.h"
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "pnKeyedObject/hsKeyedObject.h"
@@ -117,6 +119,9 @@ class plFont : public hsKeyedObject
                                                 // This flag has no effect on monochrome fonts
             kRenderAlphaPremultiplied = 0x00001000, // Destination has color values premultiplied by alpha
             kRenderShadow             = 0x00002000, // Render text shadows
+
+            // Flags that change where characters land, as opposed to how they're drawn
+            kRenderLayoutMask   = kRenderScaleAA | kRenderClip | kRenderWrap | kRenderJustXMask | kRenderJustYMask,
         };
 
         enum Flags
@@ -207,6 +212,28 @@ class plFont : public hsKeyedObject
 
         plRenderInfo    fRenderInfo;
 
+        // CalcStringExtents() results, keyed by the string and every render
+        // setting that affects layout. Dropped whenever the font data changes.
+        struct ExtentsKey
+        {
+            std::wstring    fString;
+            uint32_t        fFlags;
+            pcSmallRect     fClipRect;
+            int16_t         fFirstLineIndent, fLineSpacing;
+
+            bool operator==(const ExtentsKey &other) const;
+        };
+        struct ExtentsKeyHash
+        {
+            size_t operator()(const ExtentsKey &key) const;
+        };
+        struct Extents
+        {
+            uint16_t    fWidth, fHeight, fAscent, fLastX, fLastY;
+            uint32_t    fFirstClippedChar;
+        };
+        std::unordered_map<ExtentsKey, Extents, ExtentsKeyHash> fExtentsCache;
+
         void    IClear( bool onConstruct = false );
         void    ICalcFontAscent();
 
@@ -281,6 +308,9 @@ class plFont : public hsKeyedObject
         void    CalcStringExtents( const ST::string &string, uint16_t &width, uint16_t &height, uint16_t &ascent, uint32_t &firstClippedChar, uint16_t &lastX, uint16_t &lastY );
         void    CalcStringExtents( const wchar_t *string, uint16_t &width, uint16_t &height, uint16_t &ascent, uint32_t &firstClippedChar, uint16_t &lastX, uint16_t &lastY );
 
+        size_t  GetExtentsCacheSize() const { return fExtentsCache.size(); }
+        void    ClearExtentsCache() { fExtentsCache.clear(); }
+
         bool    LoadFromFNT( const plFileName &path );
         bool    LoadFromFNTStream( hsStream *stream );
 
@@ -0,0 +1,209 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plFont_Private.h"
+#include "plGImageSSE2_Private.h"
+
+#ifdef HAVE_SSE2
+#   include <cstring>
+
+// Four glyph pixels go through each loop iteration. Their coverage bytes are
+// widened to 16-bit lanes, one copy per color channel, so px0/px1 and px2/px3
+// line up with the destination pixels unpacked into two registers.
+static inline void IExpandCoverage(uint32_t cov, __m128i& cov32, __m128i& lo, __m128i& hi)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i c16 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(int(cov)), zero);
+    cov32 = _mm_unpacklo_epi16(c16, zero);
+    __m128i c = _mm_unpacklo_epi16(c16, c16);
+    lo = _mm_unpacklo_epi32(c, c);
+    hi = _mm_unpackhi_epi32(c, c);
+}
+
+static inline uint32_t ILoadCoverage(const uint8_t* src)
+{
+    uint32_t cov;
+    memcpy(&cov, src, sizeof(cov));
+    return cov;
+}
+#endif // HAVE_SSE2
+
+void plFontKernels::blend_8to32_sse2(const uint8_t* src, uint32_t* dest, int32_t count, uint32_t color)
+{
+#ifdef HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i colorVec = _mm_set1_epi32(int(color));
+    const __m128i colorLanes = _mm_unpacklo_epi8(colorVec, zero);
+    const __m128i colorAlpha = _mm_set1_epi16(int16_t(color >> 24));
+    const __m128i max = _mm_set1_epi16(255);
+    const __m128i alphaMask = _mm_set1_epi32(int(0xff000000));
+
+    int32_t x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        uint32_t cov = ILoadCoverage(src + x);
+        if (cov == 0)
+            continue;
+
+        __m128i cov32, covLo, covHi;
+        IExpandCoverage(cov, cov32, covLo, covHi);
+
+        __m128i* out = reinterpret_cast<__m128i*>(dest + x);
+        __m128i d = _mm_loadu_si128(out);
+
+        // srcAlpha = cov * colorAlpha / 255, then each channel is
+        // (c * srcAlpha >> 8) + (d * (255 - srcAlpha) >> 8)
+        __m128i saLo = IDiv255(_mm_mullo_epi16(covLo, colorAlpha));
+        __m128i saHi = IDiv255(_mm_mullo_epi16(covHi, colorAlpha));
+        __m128i dLo = _mm_unpacklo_epi8(d, zero);
+        __m128i dHi = _mm_unpackhi_epi8(d, zero);
+        __m128i rLo = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(colorLanes, saLo), 8),
+                                    _mm_srli_epi16(_mm_mullo_epi16(dLo, _mm_sub_epi16(max, saLo)), 8));
+        __m128i rHi = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(colorLanes, saHi), 8),
+                                    _mm_srli_epi16(_mm_mullo_epi16(dHi, _mm_sub_epi16(max, saHi)), 8));
+        __m128i blended = ISelect(alphaMask, d, _mm_packus_epi16(rLo, rHi));
+
+        // Fully covered pixels take the color as is, uncovered ones are untouched
+        blended = ISelect(_mm_cmpeq_epi32(cov32, _mm_set1_epi32(255)), colorVec, blended);
+        _mm_storeu_si128(out, ISelect(_mm_cmpeq_epi32(cov32, zero), d, blended));
+    }
+
+    if (x < count)
+        blend_8to32_fpu(src + x, dest + x, count - x, color);
+#endif // HAVE_SSE2
+}
+
+void plFontKernels::full_alpha_8to32_sse2(const uint8_t* src, uint32_t* dest, int32_t count, uint32_t color)
+{
+#ifdef HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i colorOnly = _mm_set1_epi32(int(color & 0x00ffffff));
+
+    int32_t x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        uint32_t cov = ILoadCoverage(src + x);
+        if (cov == 0)
+            continue;
+
+        __m128i cov32 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(int(cov)), zero), zero);
+        __m128i* out = reinterpret_cast<__m128i*>(dest + x);
+        __m128i d = _mm_loadu_si128(out);
+        __m128i result = _mm_or_si128(_mm_slli_epi32(cov32, 24), colorOnly);
+        _mm_storeu_si128(out, ISelect(_mm_cmpeq_epi32(cov32, zero), d, result));
+    }
+
+    if (x < count)
+        full_alpha_8to32_fpu(src + x, dest + x, count - x, color);
+#endif // HAVE_SSE2
+}
+
+void plFontKernels::alpha_8to32_sse2(const uint8_t* src, uint32_t* dest, int32_t count, uint32_t color)
+{
+#ifdef HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i colorOnly = _mm_set1_epi32(int(color & 0x00ffffff));
+    const __m128i fullAlpha = _mm_set1_epi32(int(color & 0xff000000));
+    const __m128i alphaMult = _mm_set1_epi32(int((color & 0xff000000) / 255));
+    const __m128i alphaMask = _mm_set1_epi32(int(0xff000000));
+
+    int32_t x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        uint32_t cov = ILoadCoverage(src + x);
+        if (cov == 0)
+            continue;
+
+        __m128i cov32 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(int(cov)), zero), zero);
+        __m128i* out = reinterpret_cast<__m128i*>(dest + x);
+        __m128i d = _mm_loadu_si128(out);
+
+        // alphaMult * cov needs the low half of a full 32-bit multiply,
+        // which SSE2 only has for the even lanes
+        __m128i even = _mm_mul_epu32(cov32, alphaMult);
+        __m128i odd = _mm_mul_epu32(_mm_srli_si128(cov32, 4), alphaMult);
+        __m128i alpha = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                           _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+        alpha = ISelect(_mm_cmpeq_epi32(cov32, _mm_set1_epi32(255)), fullAlpha, _mm_and_si128(alpha, alphaMask));
+        _mm_storeu_si128(out, ISelect(_mm_cmpeq_epi32(cov32, zero), d, _mm_or_si128(alpha, colorOnly)));
+    }
+
+    if (x < count)
+        alpha_8to32_fpu(src + x, dest + x, count - x, color);
+#endif // HAVE_SSE2
+}
+
+void plFontKernels::alpha_prem_8to32_sse2(const uint8_t* src, uint32_t* dest, int32_t count, uint32_t color)
+{
+#ifdef HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i colorAlpha = _mm_set1_epi16(int16_t(color >> 24));
+    const __m128i round = _mm_set1_epi16(127);
+    // The alpha lane is scaled by 255 so it comes out as the glyph alpha itself
+    const __m128i colorLanes = _mm_unpacklo_epi8(_mm_set1_epi32(int(color | 0xff000000)), zero);
+
+    int32_t x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        uint32_t cov = ILoadCoverage(src + x);
+        if (cov == 0)
+            continue;
+
+        __m128i cov32, covLo, covHi;
+        IExpandCoverage(cov, cov32, covLo, covHi);
+
+        __m128i* out = reinterpret_cast<__m128i*>(dest + x);
+        __m128i d = _mm_loadu_si128(out);
+
+        // a = (colorAlpha * cov + 127) / 255, which is just cov for an opaque
+        // color, and each channel is then (c * a + 127) / 255
+        __m128i aLo = IDiv255(_mm_add_epi16(_mm_mullo_epi16(covLo, colorAlpha), round));
+        __m128i aHi = IDiv255(_mm_add_epi16(_mm_mullo_epi16(covHi, colorAlpha), round));
+        __m128i rLo = IDiv255(_mm_add_epi16(_mm_mullo_epi16(colorLanes, aLo), round));
+        __m128i rHi = IDiv255(_mm_add_epi16(_mm_mullo_epi16(colorLanes, aHi), round));
+        _mm_storeu_si128(out, ISelect(_mm_cmpeq_epi32(cov32, zero), d, _mm_packus_epi16(rLo, rHi)));
+    }
+
+    if (x < count)
+        alpha_prem_8to32_fpu(src + x, dest + x, count - x, color);
+#endif // HAVE_SSE2
+}
@@ -0,0 +1,236 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plImageCodecService.h"
+
+#include "hsLockGuard.h"
+#include "hsRefCnt.h"
+#include "hsStream.h"
+#include "plFileSystem.h"
+
+#include "plJPEG.h"
+#include "plMipmap.h"
+#include "plPNG.h"
+
+#include <algorithm>
+#include <mutex>
+
+// The callback jobs that haven't run yet, for Flush()
+static std::mutex s_pendingLock;
+static std::vector<std::weak_ptr<hsJob>> s_pending;
+
+// Runs work on a worker, then finish on the main thread.  Only the main
+// thread job keeps state past the work, so whatever it holds (the source
+// mipmap in particular) is always released on the main thread.
+template <class _State>
+static hsJobHandle IDispatch(std::shared_ptr<_State> state, void (*work)(_State&),
+                             std::function<void(_State&)> finish)
+{
+    if (!hsJobSystem::InstanceValid()) {
+        work(*state);
+        finish(*state);
+        return nullptr;
+    }
+
+    hsJobSystem& jobs = hsJobSystem::Instance();
+    hsJobHandle job = jobs.Submit([state, work]() { work(*state); });
+    hsJobHandle callback = jobs.SubmitMainThread([state, finish]() { finish(*state); }, { job });
+
+    hsLockGuard(s_pendingLock);
+    s_pending.erase(std::remove_if(s_pending.begin(), s_pending.end(),
+                                   [](const std::weak_ptr<hsJob>& pending) { return pending.expired(); }),
+                    s_pending.end());
+    s_pending.emplace_back(callback);
+    return callback;
+}
+
+void plImageCodecService::Flush()
+{
+    if (!hsJobSystem::InstanceValid())
+        return;
+
+    // Callbacks may ask for more images, so keep at it until nothing's left
+    for (;;) {
+        std::vector<hsJobHandle> pending;
+        {
+            hsLockGuard(s_pendingLock);
+            for (const std::weak_ptr<hsJob>& job : s_pending) {
+                if (hsJobHandle locked = job.lock())
+                    pending.push_back(std::move(locked));
+            }
+            s_pending.clear();
+        }
+        if (pending.empty())
+            break;
+        hsJobSystem::Instance().Wait(pending);
+    }
+}
+
+//// Decoding /////////////////////////////////////////////////////////////////
+
+struct plImageCodecService::DecodeRequest
+{
+    Format                      fFormat;
+    uint8_t                     fScaleDenom;
+    plFileName                  fFileName;
+    std::vector<uint8_t>        fData;
+    std::unique_ptr<plMipmap>   fResult;
+};
+
+void plImageCodecService::IDecode(DecodeRequest& request)
+{
+    if (request.fFileName.IsValid()) {
+        hsUNIXStream in;
+        if (!in.Open(request.fFileName, "rb"))
+            return;
+        request.fData.resize(in.GetEOF());
+        in.Read((uint32_t)request.fData.size(), request.fData.data());
+        in.Close();
+    }
+
+    const uint8_t* data = request.fData.data();
+    size_t size = request.fData.size();
+    switch (request.fFormat) {
+    case kJPEG:
+        request.fResult.reset(plJPEG::IDecode(data, size, request.fScaleDenom));
+        break;
+    case kPNG:
+        request.fResult.reset(plPNG::IDecode(data, size));
+        break;
+    }
+
+    // Done with the encoded data; no sense holding it until the main thread
+    // gets around to us
+    request.fData = std::vector<uint8_t>();
+}
+
+hsJobHandle plImageCodecService::IQueueDecode(std::shared_ptr<DecodeRequest> request, DecodeCallback callback)
+{
+    return IDispatch<DecodeRequest>(std::move(request), IDecode,
+        [callback](DecodeRequest& request) {
+            callback(request.fResult.release());
+        });
+}
+
+hsJobHandle plImageCodecService::Decode(Format format, std::vector<uint8_t> data, DecodeCallback callback, uint8_t scaleDenom)
+{
+    auto request = std::make_shared<DecodeRequest>();
+    request->fFormat = format;
+    request->fScaleDenom = scaleDenom;
+    request->fData = std::move(data);
+    return IQueueDecode(std::move(request), std::move(callback));
+}
+
+hsJobHandle plImageCodecService::DecodeFile(Format format, const plFileName& fileName, DecodeCallback callback, uint8_t scaleDenom)
+{
+    auto request = std::make_shared<DecodeRequest>();
+    request->fFormat = format;
+    request->fScaleDenom = scaleDenom;
+    request->fFileName = fileName;
+    return IQueueDecode(std::move(request), std::move(callback));
+}
+
+//// Encoding /////////////////////////////////////////////////////////////////
+
+struct plImageCodecService::EncodeRequest
+{
+    Format                      fFormat;
+    uint8_t                     fQuality;
+    hsRef<plMipmap>             fSource;
+    plFileName                  fFileName;
+    std::vector<uint8_t>        fData;
+    bool                        fSuccess;
+};
+
+void plImageCodecService::IEncode(EncodeRequest& request)
+{
+    switch (request.fFormat) {
+    case kJPEG:
+        request.fSuccess = plJPEG::IEncode(request.fSource.Get(), request.fQuality, request.fData);
+        break;
+    case kPNG:
+        request.fSuccess = plPNG::IEncode(request.fSource.Get(), request.fData, {});
+        break;
+    }
+
+    if (request.fSuccess && request.fFileName.IsValid()) {
+        hsUNIXStream out;
+        request.fSuccess = out.Open(request.fFileName, "wb");
+        if (request.fSuccess) {
+            request.fSuccess = out.Write((uint32_t)request.fData.size(), request.fData.data()) == request.fData.size();
+            out.Close();
+        }
+        request.fData = std::vector<uint8_t>();
+    }
+}
+
+std::shared_ptr<plImageCodecService::EncodeRequest> plImageCodecService::IMakeEncodeRequest(Format format, plMipmap* source, uint8_t quality)
+{
+    auto request = std::make_shared<EncodeRequest>();
+    request->fFormat = format;
+    request->fQuality = quality;
+    request->fSource = hsWeakRef<plMipmap>(source);
+    request->fSuccess = false;
+    return request;
+}
+
+hsJobHandle plImageCodecService::Encode(Format format, plMipmap* source, EncodeCallback callback, uint8_t jpegQuality)
+{
+    return IDispatch<EncodeRequest>(IMakeEncodeRequest(format, source, jpegQuality), IEncode,
+        [callback](EncodeRequest& request) {
+            request.fSource = nullptr;
+            callback(std::move(request.fData));
+        });
+}
+
+hsJobHandle plImageCodecService::EncodeFile(Format format, plMipmap* source, const plFileName& fileName,
+                                            WriteCallback callback, uint8_t jpegQuality)
+{
+    auto request = IMakeEncodeRequest(format, source, jpegQuality);
+    request->fFileName = fileName;
+    return IDispatch<EncodeRequest>(std::move(request), IEncode,
+        [callback](EncodeRequest& request) {
+            request.fSource = nullptr;
+            if (callback)
+                callback(request.fSuccess);
+        });
+}
@@ -0,0 +1,122 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#ifndef _plImageCodecService_h
+#define _plImageCodecService_h
+
+#include "HeadSpin.h"
+#include "hsJobSystem.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class plFileName;
+class plMipmap;
+
+//////////////////////////////////////////////////////////////////////
+//
+// plImageCodecService - JPEG and PNG coding off the main thread
+//
+// Each request runs plJPEG or plPNG on a job system worker, then
+// hands the result to its callback on the main thread, from
+// hsJobSystem::RunMainThreadJobs().  Callbacks are free to touch the
+// scene, the vault and Python like any other main thread code.
+// Without a job system (tools, tests), the work happens on the spot
+// and the callback runs before the request returns.
+//
+// Requests still pending when the job system shuts down are dropped
+// without calling back.  Flush() finishes them first, for callbacks
+// that hold on to something (Python, say) which goes away sooner.
+//
+//     == Example Usage ==
+//
+//  plImageCodecService::Decode(plImageCodecService::kJPEG, std::move(data),
+//      [this](plMipmap* mipmap) { ... }, 4);
+//
+//////////////////////////////////////////////////////////////////////
+
+class plImageCodecService
+{
+public:
+    enum Format
+    {
+        kJPEG,
+        kPNG
+    };
+
+    // Takes ownership of the new mipmap, which is nullptr if decoding failed
+    typedef std::function<void(plMipmap*)> DecodeCallback;
+    // Receives the bare encoded image, which is empty if encoding failed
+    typedef std::function<void(std::vector<uint8_t>)> EncodeCallback;
+    typedef std::function<void(bool)> WriteCallback;
+
+    // Decodes bare JPEG or PNG data.  A JPEG may be shrunk by a scaleDenom
+    // of 2, 4 or 8 while decoding; see plJPEG::ReadFromMemory().
+    static hsJobHandle Decode(Format format, std::vector<uint8_t> data, DecodeCallback callback, uint8_t scaleDenom = 1);
+    static hsJobHandle DecodeFile(Format format, const plFileName& fileName, DecodeCallback callback, uint8_t scaleDenom = 1);
+
+    // Encodes source, holding a ref on it until the callback has run.  The
+    // image must not change in the meantime.  PNGs ignore jpegQuality.
+    static hsJobHandle Encode(Format format, plMipmap* source, EncodeCallback callback, uint8_t jpegQuality = 70);
+    static hsJobHandle EncodeFile(Format format, plMipmap* source, const plFileName& fileName,
+                                  WriteCallback callback = nullptr, uint8_t jpegQuality = 70);
+
+    // All of the above return the job that calls back, so a caller on the
+    // main thread can hsJobSystem::Wait() for it; nullptr if that already
+    // happened.
+
+    // Runs every outstanding request and its callback, including any the
+    // callbacks queue up.  Main thread only.
+    static void Flush();
+
+protected:
+    struct DecodeRequest;
+    struct EncodeRequest;
+
+    static void IDecode(DecodeRequest& request);
+    static void IEncode(EncodeRequest& request);
+    static hsJobHandle IQueueDecode(std::shared_ptr<DecodeRequest> request, DecodeCallback callback);
+    static std::shared_ptr<EncodeRequest> IMakeEncodeRequest(Format format, plMipmap* source, uint8_t quality);
+};
+
+#endif // _plImageCodecService_h
@@ -57,6 +57,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "plMipmap.h"
 
+#include <algorithm>
 #include <jpeglib.h>
 #include <jerror.h>
 
@@ -64,10 +65,9 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 //  Done this way so we don't have to declare them in the .h file and pull in
 //  the platform-specific library
 
-// It is not thread-safe to use a static char buffer, but it wasn't really
-// thread-safe to use a static int either. The char buffer is slightly
-// worse since you could get mangled strings instead of just a stale error.
-static char jpegmsg[JMSG_LENGTH_MAX];
+// Each thread keeps its own message, so a decode on a worker thread can't
+// mangle the error the main thread is about to read (or vice versa).
+static thread_local char jpegmsg[JMSG_LENGTH_MAX];
 
 // jpeglib error handlers
 static void plJPEG_error_exit( j_common_ptr cinfo )
@@ -85,6 +85,46 @@ static void clear_jpegmsg()
     strcpy( jpegmsg, "Success" );
 }
 
+// Most scanlines jpeglib will take or hand back in one call
+static const JDIMENSION kMaxScanlines = 16;
+
+//// Vector Destination ///////////////////////////////////////////////////////
+//  Compresses straight onto the end of a std::vector, growing it as we go,
+//  so the encoded data never has to be copied out of a buffer jpeglib owns.
+
+struct plJPEGVectorDest
+{
+    struct jpeg_destination_mgr fPub;
+    std::vector<uint8_t>        *fData;
+};
+
+static void plJPEG_init_destination( j_compress_ptr cinfo )
+{
+    plJPEGVectorDest *dest = (plJPEGVectorDest *)cinfo->dest;
+
+    // Half a byte per pixel covers all but the highest qualities
+    size_t start = dest->fData->size();
+    dest->fData->resize( start + std::max<size_t>( 4096, size_t( cinfo->image_width ) * cinfo->image_height / 2 ) );
+    dest->fPub.next_output_byte = dest->fData->data() + start;
+    dest->fPub.free_in_buffer = dest->fData->size() - start;
+}
+static boolean plJPEG_empty_output_buffer( j_compress_ptr cinfo )
+{
+    plJPEGVectorDest *dest = (plJPEGVectorDest *)cinfo->dest;
+
+    // jpeglib only calls this once the whole buffer is full
+    size_t used = dest->fData->size();
+    dest->fData->resize( used * 2 );
+    dest->fPub.next_output_byte = dest->fData->data() + used;
+    dest->fPub.free_in_buffer = dest->fData->size() - used;
+    return TRUE;
+}
+static void plJPEG_term_destination( j_compress_ptr cinfo )
+{
+    plJPEGVectorDest *dest = (plJPEGVectorDest *)cinfo->dest;
+    dest->fData->resize( dest->fData->size() - dest->fPub.free_in_buffer );
+}
+
 
 //// Instance /////////////////////////////////////////////////////////////////
 
@@ -105,20 +145,41 @@ const char  *plJPEG::GetLastError()
 
 //// IRead ////////////////////////////////////////////////////////////////////
 //  Given an open hsStream (or a filename), reads the JPEG data off of the 
-//  stream and decodes it into a new plMipmap. The mipmap's buffer ends up 
-//  being a packed RGBx buffer, where x is 8 bits of unused alpha (go figure 
-//  that JPEG images can't store alpha, or even if they can, IJL certainly 
-//  doesn't know about it).
+//  stream and decodes it into a new plMipmap.
 //  Returns a pointer to the new mipmap if successful, nullptr otherwise.
+
+plMipmap    *plJPEG::IRead( hsStream *inStream )
+{
+    clear_jpegmsg();
+
+    /// Read in the JPEG header
+    if ( inStream->GetEOF() == 0 )
+        return nullptr;
+
+    /// Wonderful limitation of mixing our streams with IJL--it wants either a filename
+    /// or a memory buffer. Since we can't give it the former, we have to read the entire
+    /// JPEG stream into a separate buffer before we can decode it. Which means we ALSO
+    /// have to write/read a length of said buffer. Such is life, I guess...
+    uint32_t jpegSourceSize = inStream->ReadLE32();
+    std::vector<uint8_t> jpegSourceBuffer( jpegSourceSize );
+    inStream->Read( jpegSourceSize, jpegSourceBuffer.data() );
+
+    return IDecode( jpegSourceBuffer.data(), jpegSourceBuffer.size(), 1 );
+}
+
+//// IDecode //////////////////////////////////////////////////////////////////
+//  Decodes a bare JPEG in memory into a new plMipmap. The mipmap's buffer
+//  ends up being a packed RGBx buffer, where x is 8 bits of unused alpha (go
+//  figure that JPEG images can't store alpha, or even if they can, IJL 
+//  certainly doesn't know about it).
 //  Note: more or less lifted straight out of the IJL documentation, with
 //  some changes to fit Plasma coding style and formats.
 
-plMipmap    *plJPEG::IRead( hsStream *inStream )
+plMipmap    *plJPEG::IDecode( const uint8_t *data, size_t size, uint8_t scaleDenom )
 {
     plMipmap    *newMipmap = nullptr;
-    uint8_t       *jpegSourceBuffer = nullptr;
-    uint32_t      jpegSourceSize;
-    
+    bool        direct = false;
+
     struct jpeg_decompress_struct   cinfo;
     struct jpeg_error_mgr       jerr;
 
@@ -132,19 +193,10 @@ plMipmap    *plJPEG::IRead( hsStream *inStream )
     {
         jpeg_create_decompress( &cinfo );
 
-        /// Read in the JPEG header
-        if ( inStream->GetEOF() == 0 )
+        if( size == 0 )
             throw false;
 
-        /// Wonderful limitation of mixing our streams with IJL--it wants either a filename
-        /// or a memory buffer. Since we can't give it the former, we have to read the entire
-        /// JPEG stream into a separate buffer before we can decode it. Which means we ALSO
-        /// have to write/read a length of said buffer. Such is life, I guess...
-        jpegSourceSize = inStream->ReadLE32();
-        jpegSourceBuffer = new uint8_t[ jpegSourceSize ];
-
-        inStream->Read( jpegSourceSize, jpegSourceBuffer );
-        jpeg_mem_src( &cinfo, jpegSourceBuffer, jpegSourceSize );
+        jpeg_mem_src( &cinfo, (unsigned char *)data, (unsigned long)size );
         (void) jpeg_read_header( &cinfo, TRUE );
 
         /// So we got lots of data to play with now. First, set the JPEG color
@@ -163,7 +215,15 @@ plMipmap    *plJPEG::IRead( hsStream *inStream )
         {
             case JCS_GRAYSCALE:
             case JCS_YCbCr:
+#ifdef JCS_ALPHA_EXTENSIONS
+                // libjpeg-turbo can write our BGRA layout itself.  Only the
+                // alpha variants promise an opaque 0xFF in the fourth byte;
+                // with BGRX it is left undefined.
+                cinfo.out_color_space = JCS_EXT_BGRA;
+                direct = true;
+#else
                 cinfo.out_color_space = JCS_RGB;
+#endif
                 break;
 
             default:
@@ -173,38 +233,62 @@ plMipmap    *plJPEG::IRead( hsStream *inStream )
                 break;
         }
 
+        // Thumbnails: let the IDCT throw away the detail we don't want
+        // instead of decoding every pixel, and skip the smooth chroma
+        // upsampling nobody will see at that size
+        if( scaleDenom > 1 )
+        {
+            cinfo.scale_num = 1;
+            cinfo.scale_denom = ( scaleDenom >= 8 ) ? 8 : ( scaleDenom >= 4 ) ? 4 : 2;
+            cinfo.dct_method = JDCT_IFAST;
+            cinfo.do_fancy_upsampling = FALSE;
+        }
+
         (void) jpeg_start_decompress( &cinfo );
 
         /// Construct a new mipmap to hold everything
         newMipmap = new plMipmap( cinfo.output_width, cinfo.output_height, plMipmap::kRGB32Config, 1, plMipmap::kJPEGCompression );
 
-        /// Set up to read in to that buffer we now have
-        JSAMPROW jbuffer;
-        int row_stride = cinfo.output_width * cinfo.output_components;
-        int out_stride = cinfo.output_width * 4;  // Decompress to RGBA
-        jbuffer = new JSAMPLE[row_stride];
-
         uint8_t *destp = (uint8_t *)newMipmap->GetImage();
-        while( cinfo.output_scanline < cinfo.output_height )
+        size_t out_stride = cinfo.output_width * 4;  // Decompress to RGBA
+        if( direct )
+        {
+            /// Decode straight into the mipmap, as many rows at once as jpeglib likes
+            JSAMPROW rows[ kMaxScanlines ];
+            while( cinfo.output_scanline < cinfo.output_height )
+            {
+                JDIMENSION numRows = std::min( kMaxScanlines, cinfo.output_height - cinfo.output_scanline );
+                for( JDIMENSION i = 0; i < numRows; i++ )
+                    rows[ i ] = destp + ( cinfo.output_scanline + i ) * out_stride;
+                (void) jpeg_read_scanlines( &cinfo, rows, numRows );
+            }
+        }
+        else
         {
-            (void) jpeg_read_scanlines( &cinfo, &jbuffer, 1 );
-            (void) memset( destp, 0xFF, out_stride );
-            
-            for( size_t pixel = 0; pixel < cinfo.output_width; ++pixel )
+            /// Set up to read in to that buffer we now have
+            std::vector<JSAMPLE> jbuffer( cinfo.output_width * cinfo.output_components );
+            JSAMPROW jrow = jbuffer.data();
+
+            while( cinfo.output_scanline < cinfo.output_height )
             {
-                (void) memcpy( destp + (pixel * 4),
-                               jbuffer + (pixel * cinfo.output_components),
-                               cinfo.out_color_components );
+                (void) jpeg_read_scanlines( &cinfo, &jrow, 1 );
+                (void) memset( destp, 0xFF, out_stride );
+
+                for( size_t pixel = 0; pixel < cinfo.output_width; ++pixel )
+                {
+                    (void) memcpy( destp + (pixel * 4),
+                                   jrow + (pixel * cinfo.output_components),
+                                   cinfo.out_color_components );
+                }
+
+                destp += out_stride;
             }
 
-            destp += out_stride;
+            // Sometimes life just sucks
+            ISwapRGBAComponents( (uint32_t *)newMipmap->GetImage(), newMipmap->GetWidth() * newMipmap->GetHeight() );
         }
 
         (void) jpeg_finish_decompress(&cinfo);
-        delete [] jbuffer;
-
-        // Sometimes life just sucks
-        ISwapRGBAComponents( (uint32_t *)newMipmap->GetImage(), newMipmap->GetWidth() * newMipmap->GetHeight() );
     }
     catch (...)
     {
@@ -212,9 +296,6 @@ plMipmap    *plJPEG::IRead( hsStream *inStream )
         newMipmap = nullptr;
     }
 
-    // Cleanup
-    delete [] jpegSourceBuffer;
-
     // Clean up the JPEG Library
     jpeg_destroy_decompress( &cinfo );
 
@@ -224,27 +305,17 @@ plMipmap    *plJPEG::IRead( hsStream *inStream )
 
 plMipmap*   plJPEG::ReadFromFile( const plFileName &fileName )
 {
-    // we use a stream because the IJL can't handle unicode
-    hsRAMStream tempstream;
     hsUNIXStream in;
     if (!in.Open(fileName, "rb"))
         return nullptr;
 
-    // The stream reader for JPEGs expects a 32-bit size at the start,
-    // so insert that into the stream before passing it on
-    in.FastFwd();
-    uint32_t fsize = in.GetPosition();
-    uint8_t *tempbuffer = new uint8_t[fsize];
-    in.Rewind();
-    in.Read(fsize, tempbuffer);
-    tempstream.WriteLE32(fsize);
-    tempstream.Write(fsize, tempbuffer);
-    delete [] tempbuffer;
-    tempstream.Rewind();
-
-    plMipmap* ret = IRead(&tempstream);
+    // Files hold a bare JPEG, without the 32-bit size our streams expect,
+    // so hand the contents straight to the decoder
+    std::vector<uint8_t> data(in.GetEOF());
+    in.Read((uint32_t)data.size(), data.data());
     in.Close();
-    return ret;
+
+    return IDecode(data.data(), data.size(), 1);
 }
 
 //// IWrite ///////////////////////////////////////////////////////////////////
@@ -252,12 +323,27 @@ plMipmap*   plJPEG::ReadFromFile( const plFileName &fileName )
 
 bool    plJPEG::IWrite( plMipmap *source, hsStream *outStream )
 {
-    bool    result = true, swapped = false;
-    uint8_t   *jpgBuffer = nullptr;
-    uint32_t  jpgBufferSize = 0;
+    std::vector<uint8_t> jpgBuffer;
+    if( !IEncode( source, fWriteQuality, jpgBuffer ) )
+        return false;
+
+    outStream->WriteLE32( (uint32_t)jpgBuffer.size() );
+    outStream->Write( (uint32_t)jpgBuffer.size(), jpgBuffer.data() );
+    return true;
+}
+
+//// IEncode //////////////////////////////////////////////////////////////////
+//  Encodes source as a bare JPEG onto the end of outData. source is only
+//  read, so it is safe to encode the same mipmap from several threads at once.
+
+bool    plJPEG::IEncode( const plMipmap *source, uint8_t quality, std::vector<uint8_t> &outData )
+{
+    bool    result = true;
+    size_t  start = outData.size();
 
     struct jpeg_compress_struct cinfo;
     struct jpeg_error_mgr       jerr;
+    plJPEGVectorDest            dest;
 
 
     clear_jpegmsg();
@@ -269,18 +355,22 @@ bool    plJPEG::IWrite( plMipmap *source, hsStream *outStream )
     {
         jpeg_create_compress( &cinfo );
 
-        // Create a buffer to hold the data
-        jpgBufferSize = source->GetWidth() * source->GetHeight() * 3;
-        jpgBuffer = new uint8_t[ jpgBufferSize ];
-
-        uint8_t *bufferAddr = jpgBuffer;
-        unsigned long bufferSize = jpgBufferSize;
-        jpeg_mem_dest( &cinfo, &bufferAddr, &bufferSize );
+        dest.fPub.init_destination = plJPEG_init_destination;
+        dest.fPub.empty_output_buffer = plJPEG_empty_output_buffer;
+        dest.fPub.term_destination = plJPEG_term_destination;
+        dest.fData = &outData;
+        cinfo.dest = &dest.fPub;
 
         cinfo.image_width = source->GetWidth();
         cinfo.image_height = source->GetHeight();
+#ifdef JCS_EXTENSIONS
+        // libjpeg-turbo reads our BGRx rows as they are
+        cinfo.input_components = 4;
+        cinfo.in_color_space = JCS_EXT_BGRX;
+#else
         cinfo.input_components = 3;
         cinfo.in_color_space = JCS_RGB;
+#endif
 
         jpeg_set_defaults( &cinfo );
 
@@ -290,76 +380,66 @@ bool    plJPEG::IWrite( plMipmap *source, hsStream *outStream )
 #endif
         cinfo.jpeg_color_space = JCS_YCbCr; // default
         // not sure how to set 4:1:1 but supposedly it's the default
-        jpeg_set_quality( &cinfo, fWriteQuality, TRUE );
+        jpeg_set_quality( &cinfo, quality, TRUE );
 
         jpeg_start_compress( &cinfo, TRUE );
 
-        // Sometimes life just sucks
-        ISwapRGBAComponents( (uint32_t *)source->GetImage(), source->GetWidth() * source->GetHeight() );
-        swapped = true;
-
         // Write it!
-        JSAMPROW jbuffer;
-        int in_stride = cinfo.image_width * 4;  // Input is always RGBA
-        int row_stride = cinfo.image_width * cinfo.input_components;
-        jbuffer = new JSAMPLE[row_stride];
-
-        uint8_t *srcp = (uint8_t *)source->GetImage();
+        const uint8_t *srcp = (const uint8_t *)source->GetImage();
+        size_t in_stride = cinfo.image_width * 4;  // Input is always RGBA
+#ifdef JCS_EXTENSIONS
+        JSAMPROW rows[ kMaxScanlines ];
+        while( cinfo.next_scanline < cinfo.image_height )
+        {
+            JDIMENSION numRows = std::min( kMaxScanlines, cinfo.image_height - cinfo.next_scanline );
+            for( JDIMENSION i = 0; i < numRows; i++ )
+                rows[ i ] = (JSAMPROW)( srcp + ( cinfo.next_scanline + i ) * in_stride );
+            (void) jpeg_write_scanlines( &cinfo, rows, numRows );
+        }
+#else
+        // Repack each row as RGB, rather than swapping the whole source in
+        // place and back again
+        std::vector<JSAMPLE> jbuffer( cinfo.image_width * cinfo.input_components );
+        JSAMPROW jrow = jbuffer.data();
         while( cinfo.next_scanline < cinfo.image_height )
         {
             for( size_t pixel = 0; pixel < cinfo.image_width; ++pixel )
             {
-                (void) memcpy( jbuffer + (pixel * cinfo.input_components),
-                               srcp + (pixel * 4), cinfo.input_components );
+                jrow[ pixel * 3 + 0 ] = srcp[ pixel * 4 + 2 ];
+                jrow[ pixel * 3 + 1 ] = srcp[ pixel * 4 + 1 ];
+                jrow[ pixel * 3 + 2 ] = srcp[ pixel * 4 + 0 ];
             }
 
-            (void) jpeg_write_scanlines( &cinfo, &jbuffer, 1 );
+            (void) jpeg_write_scanlines( &cinfo, &jrow, 1 );
             srcp += in_stride;
         }
+#endif
 
         jpeg_finish_compress( &cinfo );
-        delete [] jbuffer;
-
-        // jpeglib changes bufferSize and bufferAddr
-        outStream->WriteLE32((uint32_t)bufferSize);
-        outStream->Write( bufferSize, bufferAddr );
     }
     catch (...)
     {
+        outData.resize( start );
         result = false;
     }
 
     // Cleanup
-    if ( jpgBuffer )
-        delete [] jpgBuffer;
     jpeg_destroy_compress( &cinfo );
 
-    if( swapped )
-        ISwapRGBAComponents( (uint32_t *)source->GetImage(), source->GetWidth() * source->GetHeight() );
-
     return result;
 }
 
 bool    plJPEG::WriteToFile( const plFileName &fileName, plMipmap *sourceData )
 {
-    // we use a stream because the IJL can't handle unicode
-    hsRAMStream tempstream;
     hsUNIXStream out;
     if (!out.Open(fileName, "wb"))
         return false;
-    bool ret = IWrite(sourceData, &tempstream);
+
+    // Files get the bare JPEG, without the 32-bit size our streams prepend
+    std::vector<uint8_t> data;
+    bool ret = IEncode(sourceData, fWriteQuality, data);
     if (ret)
-    {
-        // The stream writer for JPEGs prepends a 32-bit size,
-        // so remove that from the stream before saving to a file
-        tempstream.Rewind();
-        uint32_t fsize = tempstream.ReadLE32();
-        uint8_t *tempbuffer = new uint8_t[fsize];
-        tempstream.Read(fsize, tempbuffer);
-        out.Write(fsize, tempbuffer);
-
-        delete [] tempbuffer;
-    }
+        out.Write((uint32_t)data.size(), data.data());
     out.Close();
     return ret;
 }
@@ -377,4 +457,3 @@ void    plJPEG::ISwapRGBAComponents( uint32_t *data, uint32_t count )
         data++;
     }
 }
-
@@ -53,6 +53,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #ifndef _plJPEG_h
 #define _plJPEG_h
 
+#include <vector>
 
 //// Class Definition /////////////////////////////////////////////////////////
 
@@ -62,6 +63,8 @@ class plFileName;
 
 class plJPEG
 {
+    friend class plImageCodecService;
+
     protected:
 
         uint8_t       fWriteQuality;
@@ -70,7 +73,12 @@ class plJPEG
         plMipmap    *IRead( hsStream *inStream );
         bool        IWrite( plMipmap *source, hsStream *outStream );
 
-        void        ISwapRGBAComponents( uint32_t *data, uint32_t count );
+        // The actual codec. These touch no instance state, so any thread may
+        // run them at once.
+        static plMipmap *IDecode( const uint8_t *data, size_t size, uint8_t scaleDenom );
+        static bool     IEncode( const plMipmap *source, uint8_t quality, std::vector<uint8_t> &outData );
+
+        static void ISwapRGBAComponents( uint32_t *data, uint32_t count );
 
     public:
 
@@ -80,6 +88,13 @@ class plJPEG
         bool    WriteToStream( hsStream *outStream, plMipmap *sourceData ) { return IWrite( sourceData, outStream ); }
         bool    WriteToFile( const plFileName &fileName, plMipmap *sourceData );
 
+        // Bare JPEG data, without the 32-bit size our streams put in front.
+        // A scaleDenom of 2, 4 or 8 shrinks the image by that much inside the
+        // IDCT, which is far cheaper than decoding it all and scaling down.
+        // Writing appends to whatever outData already holds.
+        plMipmap    *ReadFromMemory( const void *data, size_t size, uint8_t scaleDenom = 1 ) { return IDecode( (const uint8_t *)data, size, scaleDenom ); }
+        bool    WriteToMemory( std::vector<uint8_t> &outData, const plMipmap *sourceData ) { return IEncode( sourceData, fWriteQuality, outData ); }
+
         // Range is 0 (worst) to 100 (best)
         void    SetWriteQuality( uint8_t q ) { fWriteQuality = q; }
 
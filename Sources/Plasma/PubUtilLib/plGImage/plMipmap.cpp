@@ -53,20 +53,27 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "HeadSpin.h"
 #include "plMipmap.h"
+#include "plMipmap_Private.h"
 #include "hsStream.h"
 #include "hsExceptions.h"
 
 #include "hsColorRGBA.h"
 #include "hsCodecManager.h"
 #include "hsGDeviceRef.h"
+#include "hsJobSystem.h"
 #include "plProfile.h"
 #include "plJPEG.h"
 #include "plPNG.h"
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 plProfile_CreateMemCounter("Mipmaps", "Memory", MemMipmaps);
 
+// Filtering, scaling and compositing work on bands of rows across the job
+// system once a level has at least this many pixels
+static const uint32_t kMinParallelPixels = 16384;
+
 //// Constructor & Destructor /////////////////////////////////////////////////
 
 plMipmap::plMipmap()
@@ -880,6 +887,9 @@ class plFilterMask
         int     End() const { return fExt; }
 
         float    Mask( int i, int j ) const { return fMask[ i ][ j ]; }
+
+        // Indexed [ Begin() .. End() ][ Begin() .. End() ], like Mask()
+        const float* const* Rows() const { return fMask; }
 };
 
 plFilterMask::plFilterMask( float sig )
@@ -913,6 +923,199 @@ plFilterMask::~plFilterMask()
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+//// Row Kernels //////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+//// ForEachRowBand ///////////////////////////////////////////////////////////
+//  Every row kernel below writes only its own row, so big images are split
+//  into bands of rows across the job system.
+
+template <typename _RowsFn>
+static void ForEachRowBand( uint32_t numRows, uint32_t rowPixels, const _RowsFn& rows )
+{
+    if( size_t( numRows ) * rowPixels >= kMinParallelPixels && hsJobSystem::InstanceValid() )
+    {
+        size_t grain = std::max<size_t>( 1, kMinParallelPixels / std::max<uint32_t>( 1, rowPixels ) );
+        hsJobSystem::Instance().ParallelFor( 0, numRows, grain, rows );
+    }
+    else
+        rows( 0, numRows );
+}
+
+//// filter_row ///////////////////////////////////////////////////////////////
+//  The mask is clipped to the source once per row and pixel instead of once
+//  per tap; the taps that are left still sum in the same order.
+
+void plMipmapKernels::filter_row_fpu(uint8_t* dst, uint32_t dstWidth, const uint8_t* src, uint32_t srcRowBytes,
+                              uint32_t srcWidth, uint32_t srcHeight, uint32_t srcY, uint32_t step,
+                              const float* const* mask, int ext)
+{
+    int iiBegin = std::max(-ext, -int(srcY));
+    int iiEnd = std::min(ext, int(srcHeight) - 1 - int(srcY));
+
+    for (uint32_t j = 0; j < dstWidth; j++) {
+        uint32_t srcX = j * step;
+        int jjBegin = std::max(-ext, -int(srcX));
+        int jjEnd = std::min(ext, int(srcWidth) - 1 - int(srcX));
+        const uint8_t* center = src + size_t(srcY) * srcRowBytes + (srcX << 2);
+
+        for (uint32_t chan = 0; chan < 4; chan++) {
+            float w = 0;
+            float a = 0;
+
+            for (int ii = iiBegin; ii <= iiEnd; ii++) {
+                const uint8_t* row = center + ptrdiff_t(ii) * srcRowBytes + chan;
+                for (int jj = jjBegin; jj <= jjEnd; jj++) {
+                    w += mask[ii][jj];
+                    a += (float(row[jj << 2]) + 0.5f) * mask[ii][jj];
+                }
+            }
+            a /= w;
+
+            dst[(j << 2) + chan] = (uint8_t)a;
+        }
+    }
+}
+
+//// detail_row ///////////////////////////////////////////////////////////////
+
+void plMipmapKernels::detail_row_fpu(uint8_t* pixels, uint32_t count, float scale, float bias, uint32_t chanMask)
+{
+    for (uint32_t i = 0; i < count; i++, pixels += 4) {
+        for (uint32_t chan = 0; chan < 4; chan++) {
+            if (chanMask & (1 << chan))
+                pixels[chan] = (uint8_t)(bias + (float)pixels[chan] * scale);
+        }
+    }
+}
+
+//// scale_row ////////////////////////////////////////////////////////////////
+
+void plMipmapKernels::scale_row_fpu(uint32_t* dest, uint32_t destWidth, const uint32_t* src, uint32_t srcStride,
+                             const ScaleSpan* xSpans, const ScaleSpan& ySpan)
+{
+    hsColorRGBA color, accumColor;
+
+    for (uint32_t destX = 0; destX < destWidth; destX++) {
+        const ScaleSpan& xSpan = xSpans[destX];
+
+        // Sum up all the weighted colors in the filter area
+        accumColor.Set(0.f, 0.f, 0.f, 0.f);
+        float totalWeight = 0.f;
+        for (uint32_t srcY = ySpan.fStart; srcY <= ySpan.fEnd; srcY++) {
+            float whyWait = ySpan.fWeights[srcY - ySpan.fStart];
+            if (whyWait <= 0.f)
+                continue;
+
+            const uint32_t* srcPtr = src + size_t(srcY) * srcStride + xSpan.fStart;
+            for (uint32_t srcX = xSpan.fStart; srcX <= xSpan.fEnd; srcX++, srcPtr++) {
+                float weight = xSpan.fWeights[srcX - xSpan.fStart] * whyWait;
+                if (weight > 0.f) {
+                    color.FromARGB32(*srcPtr);
+                    color *= weight;
+                    accumColor += color;
+                    totalWeight += weight;
+                }
+            }
+        }
+        accumColor *= 1.f / totalWeight;
+
+        dest[destX] = accumColor.ToARGB32();
+    }
+}
+
+//// blend_row ////////////////////////////////////////////////////////////////
+//  Wacko trick here. Alphas are 0-255, which means scaling by alpha would
+//  be a v' = v * alpha / 255 operation sequence. However, since we hate
+//  dividing by 255 all the time, we actually scale the alpha just ever so
+//  slightly so it's 0-256, which makes the divide a simple shift. Note
+//  that this will result in some tiny bit of aliasing, but it shouldn't be
+//  enough to notice
+
+void plMipmapKernels::blend_row_fpu(uint32_t* dst, const uint32_t* src, uint32_t count, uint8_t opacity,
+                             const float* tints, bool writeAlpha)
+{
+    for (uint32_t pX = 0; pX < count; pX++) {
+        if (!(src[pX] >> 24)) // Zero alpha. Skip this pixel
+            continue;
+
+        uint32_t srcAlpha = opacity * ((src[pX] >> 16) & 0x0000ff00) / 255 / 256;
+        uint32_t oneMinusAlpha = 256 - srcAlpha;
+        uint32_t destAlpha = dst[pX] & 0xff000000;
+
+        uint32_t r = (uint32_t)(((src[pX] >> 16) & 0x000000ff) * tints[0]);
+        uint32_t g = (uint32_t)(((src[pX] >> 8 ) & 0x000000ff) * tints[1]);
+        uint32_t b = (uint32_t)(((src[pX]      ) & 0x000000ff) * tints[2]);
+        uint32_t dR = (dst[pX] >> 16) & 0x000000ff;
+        uint32_t dG = (dst[pX] >> 8 ) & 0x000000ff;
+        uint32_t dB = (dst[pX]      ) & 0x000000ff;
+        r = (r * srcAlpha) >> 8;
+        g = (g * srcAlpha) >> 8;
+        b = (b * srcAlpha) >> 8;
+        dR = (dR * oneMinusAlpha) >> 8;
+        dG = (dG * oneMinusAlpha) >> 8;
+        dB = (dB * oneMinusAlpha) >> 8;
+
+        // Dest alpha for now is just our original dest alpha
+        dst[pX] = ((r + dR) << 16) | ((g + dG) << 8) | (b + dB) | destAlpha;
+
+        // Unless our blend option is set of course
+        if (writeAlpha)
+            dst[pX] = (dst[pX] & 0x00ffffff) | (srcAlpha << 24);
+    }
+}
+
+//// mask_row /////////////////////////////////////////////////////////////////
+
+void plMipmapKernels::mask_row_fpu(uint32_t* dst, const uint32_t* src, uint32_t count, uint8_t opacity, bool premultiplied)
+{
+    for (uint32_t pX = 0; pX < count; pX++) {
+        uint32_t srcAlpha = opacity * ((src[pX] >> 16) & 0x0000ff00) / 255 / 256;
+        if (srcAlpha != 0) {
+            if (premultiplied)
+                dst[pX] = (srcAlpha << 24)
+                    | (((((src[pX] >> 16) & 0xff)*srcAlpha + 127)/255) << 16)
+                    | (((((src[pX] >>  8) & 0xff)*srcAlpha + 127)/255) <<  8)
+                    | (((((src[pX]      ) & 0xff)*srcAlpha + 127)/255)      );
+            else
+                dst[pX] = (src[pX] & 0x00ffffff) | (srcAlpha << 24);
+        }
+    }
+}
+
+//// premultiply_row //////////////////////////////////////////////////////////
+
+void plMipmapKernels::premultiply_row_fpu(uint32_t* pixels, uint32_t count)
+{
+    for (uint32_t pX = 0; pX < count; pX++) {
+        uint32_t srcAlpha = ((pixels[pX] >> 24) & 0x000000ff);
+        pixels[pX] = (srcAlpha << 24)
+            | (((((pixels[pX] >> 16) & 0xff)*srcAlpha + 127)/255) << 16)
+            | (((((pixels[pX] >>  8) & 0xff)*srcAlpha + 127)/255) <<  8)
+            | (((((pixels[pX]      ) & 0xff)*srcAlpha + 127)/255)      );
+    }
+}
+
+hsCpuFunctionDispatcher<plMipmapKernels::filter_row_ptr> plMipmapKernels::filter_row {
+    &plMipmapKernels::filter_row_fpu, nullptr, &plMipmapKernels::filter_row_sse2
+};
+hsCpuFunctionDispatcher<plMipmapKernels::detail_row_ptr> plMipmapKernels::detail_row {
+    &plMipmapKernels::detail_row_fpu, nullptr, &plMipmapKernels::detail_row_sse2
+};
+hsCpuFunctionDispatcher<plMipmapKernels::scale_row_ptr> plMipmapKernels::scale_row {
+    &plMipmapKernels::scale_row_fpu, nullptr, &plMipmapKernels::scale_row_sse2
+};
+hsCpuFunctionDispatcher<plMipmapKernels::blend_row_ptr> plMipmapKernels::blend_row {
+    &plMipmapKernels::blend_row_fpu, nullptr, &plMipmapKernels::blend_row_sse2
+};
+hsCpuFunctionDispatcher<plMipmapKernels::mask_row_ptr> plMipmapKernels::mask_row {
+    &plMipmapKernels::mask_row_fpu, nullptr, &plMipmapKernels::mask_row_sse2
+};
+hsCpuFunctionDispatcher<plMipmapKernels::premultiply_row_ptr> plMipmapKernels::premultiply_row {
+    &plMipmapKernels::premultiply_row_fpu, nullptr, &plMipmapKernels::premultiply_row_sse2
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 //// Some More Functions //////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -1085,8 +1288,6 @@ void    plMipmap::ICreateLevelNoDetail( uint8_t iDst, const plFilterMask& mask )
     hsAssert(fPixelSize == 32, "Only 32 bit implemented");
     ASSERT_UNCOMPRESSED();
 
-    int i, j, ii, jj;
-
     if( 32 == fPixelSize )
     {
         SetCurrLevel(iDst);
@@ -1094,41 +1295,25 @@ void    plMipmap::ICreateLevelNoDetail( uint8_t iDst, const plFilterMask& mask )
         uint8_t *src = (uint8_t *)GetLevelPtr( iDst-1 );
         uint8_t *dst = (uint8_t *)GetLevelPtr(iDst);
 
-        uint32_t srcRowBytes = fCurrLevelRowBytes << 1;
-        uint32_t srcHeight = fCurrLevelHeight << 1;
-        uint32_t srcWidth = fCurrLevelWidth << 1;
+        IFilterLevel( dst, fCurrLevelWidth, fCurrLevelHeight, fCurrLevelRowBytes,
+                      src, fCurrLevelWidth << 1, fCurrLevelHeight << 1, fCurrLevelRowBytes << 1, 2, mask );
+    }
+}
 
-        for( i = 0; i < fCurrLevelHeight; i++ )
-        {
-            for( j = 0; j < fCurrLevelWidth; j++ )
-            {
-                uint8_t *center = src + (i << 1) * srcRowBytes + (j << 3);
+//// IFilterLevel /////////////////////////////////////////////////////////////
+//  Runs the mask over a 32-bit source, centered on every step'th pixel of
+//  every step'th row, into dst.
 
-                uint32_t chan;
-                for( chan = 0; chan < 4; chan++ )
-                {
-                    float w = 0;
-                    float a = 0;
-
-                    for( ii = mask.Begin(); ii <= mask.End(); ii++ )
-                    {
-                        for( jj = mask.Begin(); jj <= mask.End(); jj++ )
-                        {
-                            if( (ii + (i << 1) >= 0)&&(ii + (i << 1) < srcHeight)
-                              &&(jj + (j << 1) >= 0)&&(jj + (j << 1) < srcWidth) )
-                            {
-                                w += mask.Mask(ii, jj);
-                                a += (float(center[ii*srcRowBytes + (jj<<2) + chan]) + 0.5f) * mask.Mask(ii, jj);
-                            }
-                        }
-                    }
-                    a /= w;
-
-                    dst[i * fCurrLevelRowBytes + (j << 2) + chan] = (uint8_t)a;
-                }
-            }
-        }
-    }
+void    plMipmap::IFilterLevel( uint8_t *dst, uint32_t dstWidth, uint32_t dstHeight, uint32_t dstRowBytes,
+                                const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight, uint32_t srcRowBytes,
+                                uint32_t step, const plFilterMask& mask )
+{
+    ForEachRowBand( dstHeight, dstWidth, [=, &mask]( size_t begin, size_t end )
+    {
+        for( size_t i = begin; i < end; i++ )
+            plMipmapKernels::filter_row.call( dst + i * dstRowBytes, dstWidth, src, srcRowBytes, srcWidth, srcHeight,
+                             uint32_t( i * step ), step, mask.Rows(), mask.End() );
+    } );
 }
 
 void plMipmap::ICarryZeroAlpha(uint8_t iDst)
@@ -1202,6 +1387,24 @@ void plMipmap::ICarryColor(uint8_t iDst, uint32_t col)
     }
 }
 
+//// IBlendLevelDetail ////////////////////////////////////////////////////////
+//  Sets each byte of the given channels of a level to bias + byte * scale.
+
+void    plMipmap::IBlendLevelDetail( uint8_t iDst, float scale, float bias, uint32_t chanMask )
+{
+    SetCurrLevel(iDst);
+
+    uint8_t *dst = (uint8_t *)GetLevelPtr(iDst);
+    uint32_t width = fCurrLevelWidth;
+    uint32_t rowBytes = fCurrLevelRowBytes;
+
+    ForEachRowBand( fCurrLevelHeight, width, [=]( size_t begin, size_t end )
+    {
+        for( size_t i = begin; i < end; i++ )
+            plMipmapKernels::detail_row.call( dst + i * rowBytes, width, scale, bias, chanMask );
+    } );
+}
+
 //// IBlendLevelDetailAlpha ///////////////////////////////////////////////////
 //  Blends in the detail alpha for a given level. This version assumes 
 //  standard detail map blending.
@@ -1213,27 +1416,10 @@ void    plMipmap::IBlendLevelDetailAlpha( uint8_t iDst, const plFilterMask& mask
     hsAssert(fPixelSize == 32, "Only 32 bit implemented");
     ASSERT_UNCOMPRESSED();
 
-    int     i, j;
-    uint32_t  offset;
-
-
-    SetCurrLevel(iDst);
-
-    uint8_t *dst = (uint8_t *)GetLevelPtr(iDst);
-
     float detailAlpha = IGetDetailLevelAlpha( iDst, detailDropoffStart, detailDropoffStop, detailMin, detailMax );
 
-    for( i = 0; i < fCurrLevelHeight; i++ )
-    {
-        for( j = 0; j < fCurrLevelWidth; j++ )
-        {
-            uint32_t chan = 3;    // Alpha channel only
-            offset = i * fCurrLevelRowBytes + (j << 2) + chan;
-
-            float a = (float)dst[ offset ] * detailAlpha;
-            dst[ offset ] = (uint8_t)a;
-        }
-    }
+    // Alpha channel only
+    IBlendLevelDetail( iDst, detailAlpha, 0.f, 1 << 3 );
 }
 
 //// IBlendLevelDetailAdd /////////////////////////////////////////////////////
@@ -1247,32 +1433,10 @@ void    plMipmap::IBlendLevelDetailAdd( uint8_t iDst, const plFilterMask& mask,
     hsAssert(fPixelSize == 32, "Only 32 bit implemented");
     ASSERT_UNCOMPRESSED();
 
-    int     i, j;
-    uint32_t  offset;
-
-
-    SetCurrLevel(iDst);
-
-    uint8_t *dst = (uint8_t *)GetLevelPtr(iDst);
-
     float detailAlpha = IGetDetailLevelAlpha( iDst, detailDropoffStart, detailDropoffStop, detailMin, detailMax );
 
-    for( i = 0; i < fCurrLevelHeight; i++ )
-    {
-        for( j = 0; j < fCurrLevelWidth; j++ )
-        {
-            uint32_t chan;
-
-            /// Blend all but the alpha channel, since we're doing additive blending
-            for( chan = 0; chan < 3; chan++ )
-            {
-                offset = i * fCurrLevelRowBytes + (j << 2) + chan;
-
-                float a = (float)dst[ offset ] * detailAlpha;
-                dst[ offset ] = (uint8_t)a;
-            }
-        }
-    }
+    /// Blend all but the alpha channel, since we're doing additive blending
+    IBlendLevelDetail( iDst, detailAlpha, 0.f, 0x7 );
 }
 
 //// IBlendLevelDetailMult ////////////////////////////////////////////////////
@@ -1286,36 +1450,11 @@ void    plMipmap::IBlendLevelDetailMult( uint8_t iDst, const plFilterMask& mask,
     hsAssert(fPixelSize == 32, "Only 32 bit implemented");
     ASSERT_UNCOMPRESSED();
 
-    int     i, j;
-    uint32_t  offset;
-
-
-    SetCurrLevel(iDst);
-
-    uint8_t *dst = (uint8_t *)GetLevelPtr(iDst);
-
     float    detailAlpha = IGetDetailLevelAlpha( iDst, detailDropoffStart, detailDropoffStop, detailMin, detailMax );
     float    invDetailAlpha = ( 1.f - detailAlpha ) * 255.f;
 
-    for( i = 0; i < fCurrLevelHeight; i++ )
-    {
-        for( j = 0; j < fCurrLevelWidth; j++ )
-        {
-            uint32_t chan;
-
-            for( chan = 0; chan < 4; chan++ )
-            {
-                offset = i * fCurrLevelRowBytes + (j << 2) + chan;
-
-                float a = (float)dst[ offset ];
-
-                // Mult should fade to white, not black like with additive blending
-                a = invDetailAlpha + a * detailAlpha;
-
-                dst[ offset ] = (uint8_t)a;
-            }
-        }
-    }
+    // Mult should fade to white, not black like with additive blending
+    IBlendLevelDetail( iDst, detailAlpha, invDetailAlpha, 0xf );
 }
 
 //// EnsureKonstantBorder /////////////////////////////////////////////////////
@@ -1442,8 +1581,6 @@ void plMipmap::Filter(float sig)
     hsAssert(fPixelSize == 32, "Only 32 bit implemented");
     ASSERT_UNCOMPRESSED();
 
-    int i, j, ii, jj;
-
     if( 32 == fPixelSize )
     {
         uint8_t *dst = (uint8_t *)(fImage);
@@ -1456,40 +1593,7 @@ void plMipmap::Filter(float sig)
 
         plFilterMask mask(sig);
 
-        uint32_t srcRowBytes = fRowBytes;
-        uint32_t srcHeight = fHeight;
-        uint32_t srcWidth = fWidth;
-
-        for( i = 0; i < fHeight; i++ )
-        {
-            for( j = 0; j < fWidth; j++ )
-            {
-                uint8_t *center = src + i * srcRowBytes + (j << 2);
-
-                uint32_t chan;
-                for( chan = 0; chan < 4; chan++ )
-                {
-                    float w = 0;
-                    float a = 0;
-
-                    for( ii = mask.Begin(); ii <= mask.End(); ii++ )
-                    {
-                        for( jj = mask.Begin(); jj <= mask.End(); jj++ )
-                        {
-                            if( (ii + i >= 0)&&(ii + i < srcHeight)
-                              &&(jj + j >= 0)&&(jj + j < srcWidth) )
-                            {
-                                w += mask.Mask(ii, jj);
-                                a += (float(center[ii*srcRowBytes + (jj<<2) + chan]) + 0.5f) * mask.Mask(ii, jj);
-                            }
-                        }
-                    }
-                    a /= w;
-
-                    dst[i * fRowBytes + (j << 2) + chan] = (uint8_t)(a);
-                }
-            }
-        }
+        IFilterLevel( dst, fWidth, fHeight, fRowBytes, src, fWidth, fHeight, fRowBytes, 1, mask );
 
         HSMemory::Delete(src);
     }
@@ -1643,8 +1747,7 @@ void    plMipmap::Composite( plMipmap *source, uint16_t x, uint16_t y, plMipmap:
     uint8_t   level, numLevels, srcNumLevels, srcLevelOffset, levelsToSkip;
     uint16_t  pX, pY;
     uint32_t  *srcLevelPtr, *dstLevelPtr, *srcPtr, *dstPtr;
-    uint32_t  srcRowBytes, dstRowBytes, srcRowBytesToCopy, r, g, b, dR, dG, dB, srcWidth, srcHeight;
-    uint32_t  srcAlpha, oneMinusAlpha, destAlpha;
+    uint32_t  srcRowBytes, dstRowBytes, srcRowBytesToCopy, srcWidth, srcHeight;
     uint16_t  srcClipX, srcClipY;
 
 
@@ -1748,6 +1851,8 @@ void    plMipmap::Composite( plMipmap *source, uint16_t x, uint16_t y, plMipmap:
             srcRowBytes >>= 1;
             dstRowBytes >>= 1;
             srcRowBytesToCopy >>= 1;
+            if( srcWidth > 1 )
+                srcWidth >>= 1;
             if( srcHeight > 1 )
                 srcHeight >>= 1;
             srcClipX >>= 1;
@@ -1764,30 +1869,27 @@ void    plMipmap::Composite( plMipmap *source, uint16_t x, uint16_t y, plMipmap:
             // Clipping
             srcPtr += srcClipY * ( srcRowBytes >> 2 ) + srcClipX;
 
-            for( pY = (uint16_t)srcHeight; pY > 0; pY-- )
+            bool premultiply = ( options->fFlags & kDestPremultiplied ) != 0;
+            auto copyRows = [=]( size_t begin, size_t end )
             {
-                memcpy( dstPtr, srcPtr, srcRowBytesToCopy );
-                if( options->fFlags & kDestPremultiplied )
+                for( size_t row = begin; row < end; row++ )
                 {
+                    uint32_t *dstRow = dstPtr + row * ( dstRowBytes >> 2 );
+                    memcpy( dstRow, srcPtr + row * ( srcRowBytes >> 2 ), srcRowBytesToCopy );
                     // multiply color values by alpha
-                    for( pX = 0; pX < srcWidth; pX++ )
-                    {
-                        srcAlpha = ((dstPtr[ pX ] >> 24) & 0x000000ff);
-                        dstPtr[ pX ] = ( srcAlpha << 24 )
-                            | (((((dstPtr[ pX ] >> 16) & 0xff)*srcAlpha + 127)/255) << 16)
-                            | (((((dstPtr[ pX ] >>  8) & 0xff)*srcAlpha + 127)/255) <<  8)
-                            | (((((dstPtr[ pX ]      ) & 0xff)*srcAlpha + 127)/255)      );
-                    }
+                    if( premultiply )
+                        plMipmapKernels::premultiply_row.call( dstRow, srcWidth );
                 }
-                dstPtr += dstRowBytes >> 2;
-                srcPtr += srcRowBytes >> 2;
-            }
+            };
+            ForEachRowBand( (uint16_t)srcHeight, srcWidth, copyRows );
         
             srcLevelPtr += source->fLevelSizes[ level + srcLevelOffset ] >> 2;
             dstLevelPtr += fLevelSizes[ level ] >> 2;
             srcRowBytes >>= 1;
             dstRowBytes >>= 1;
             srcRowBytesToCopy >>= 1;
+            if( srcWidth > 1 )
+                srcWidth >>= 1;
             if( srcHeight > 1 )
                 srcHeight >>= 1;
             srcClipX >>= 1;
@@ -1804,31 +1906,23 @@ void    plMipmap::Composite( plMipmap *source, uint16_t x, uint16_t y, plMipmap:
             // Clipping
             srcPtr += srcClipY * ( srcRowBytes >> 2 ) + srcClipX;
 
-            for( pY = (uint16_t)srcHeight; pY > 0; pY-- )
+            uint8_t opacity = options->fOpacity;
+            bool premultiplied = ( options->fFlags & kDestPremultiplied ) != 0;
+            auto maskRows = [=]( size_t begin, size_t end )
             {
-                for( pX = 0; pX < srcWidth; pX++ )
-                {
-                    srcAlpha = options->fOpacity * ( ( srcPtr[ pX ] >> 16 ) & 0x0000ff00 ) / 255 / 256;
-                    if( srcAlpha != 0 )
-                    {
-                        if( options->fFlags & kDestPremultiplied )
-                            dstPtr[ pX ] = ( srcAlpha << 24 )
-                                | (((((srcPtr[ pX ] >> 16) & 0xff)*srcAlpha + 127)/255) << 16)
-                                | (((((srcPtr[ pX ] >>  8) & 0xff)*srcAlpha + 127)/255) <<  8)
-                                | (((((srcPtr[ pX ]      ) & 0xff)*srcAlpha + 127)/255)      );
-                        else
-                            dstPtr[ pX ] = ( srcPtr[ pX ] & 0x00ffffff ) | ( srcAlpha << 24 );
-                    }
-                }
-                dstPtr += dstRowBytes >> 2;
-                srcPtr += srcRowBytes >> 2;
-            }
+                for( size_t row = begin; row < end; row++ )
+                    plMipmapKernels::mask_row.call( dstPtr + row * ( dstRowBytes >> 2 ), srcPtr + row * ( srcRowBytes >> 2 ),
+                                   srcWidth, opacity, premultiplied );
+            };
+            ForEachRowBand( (uint16_t)srcHeight, srcWidth, maskRows );
         
             srcLevelPtr += source->fLevelSizes[ level + srcLevelOffset ] >> 2;
             dstLevelPtr += fLevelSizes[ level ] >> 2;
             srcRowBytes >>= 1;
             dstRowBytes >>= 1;
             srcRowBytesToCopy >>= 1;
+            if( srcWidth > 1 )
+                srcWidth >>= 1;
             if( srcHeight > 1 )
                 srcHeight >>= 1;
             srcClipX >>= 1;
@@ -1845,55 +1939,16 @@ void    plMipmap::Composite( plMipmap *source, uint16_t x, uint16_t y, plMipmap:
             // Clipping
             srcPtr += srcClipY * ( srcRowBytes >> 2 ) + srcClipX;
 
-            for( pY = (uint16_t)srcHeight; pY > 0; pY-- )         
+            uint8_t opacity = options->fOpacity;
+            const float tints[] = { options->fRedTint, options->fGreenTint, options->fBlueTint };
+            bool writeAlpha = ( options->fFlags & kBlendWriteAlpha ) != 0;
+            auto blendRows = [=, &tints]( size_t begin, size_t end )
             {
-                // Reverse the loop so we can count downwards--slightly faster
-                pX = (uint16_t)srcWidth;
-                do
-                {
-                    pX--;
-
-                    // Wacko trick here. Alphas are 0-255, which means scaling by alpha would
-                    // be a v' = v * alpha / 255 operation sequence. However, since we hate
-                    // dividing by 255 all the time, we actually scale the alpha just ever so
-                    // slightly so it's 0-256, which makes the divide a simple shift. Note
-                    // that this will result in some tiny bit of aliasing, but it shouldn't be
-                    // enough to notice
-                    
-                    if (!(srcPtr[pX] >> 24)) // Zero alpha. Skip this pixel
-                        continue;
-
-                    srcAlpha = options->fOpacity * ( ( srcPtr[ pX ] >> 16 ) & 0x0000ff00 ) / 255 / 256;
-                    oneMinusAlpha = 256 - srcAlpha;
-                    destAlpha = dstPtr[ pX ] & 0xff000000;
-
-                    r = (uint32_t)((( srcPtr[ pX ] >> 16 ) & 0x000000ff) * options->fRedTint);
-                    g = (uint32_t)((( srcPtr[ pX ] >> 8  ) & 0x000000ff) * options->fGreenTint);
-                    b = (uint32_t)((( srcPtr[ pX ]       ) & 0x000000ff) * options->fBlueTint);
-                    dR = ( dstPtr[ pX ] >> 16 ) & 0x000000ff;
-                    dG = ( dstPtr[ pX ] >> 8  ) & 0x000000ff;
-                    dB = ( dstPtr[ pX ]       ) & 0x000000ff;
-                    r = ( r * srcAlpha ) >> 8;
-                    g = ( g * srcAlpha ) >> 8;
-                    b = ( b * srcAlpha ) >> 8;
-                    dR = ( dR * oneMinusAlpha ) >> 8;
-                    dG = ( dG * oneMinusAlpha ) >> 8;
-                    dB = ( dB * oneMinusAlpha ) >> 8;
-
-                    // Dest alpha for now is just our original dest alpha
-                    dstPtr[ pX ] = ( ( r + dR ) << 16 ) | ( ( g + dG ) << 8 ) | ( b + dB ) | destAlpha;
-
-                    if( !( options->fFlags & kBlendWriteAlpha ) )
-                        continue;
-
-                    // Unless our blend option is set of course
-                    dstPtr[ pX ] = ( dstPtr[ pX ] & 0x00ffffff ) | ( srcAlpha << 24 );
-
-                } while( pX > 0 );
-
-                dstPtr += dstRowBytes >> 2;
-                srcPtr += srcRowBytes >> 2;
-            }
+                for( size_t row = begin; row < end; row++ )
+                    plMipmapKernels::blend_row.call( dstPtr + row * ( dstRowBytes >> 2 ), srcPtr + row * ( srcRowBytes >> 2 ),
+                                    srcWidth, opacity, tints, writeAlpha );
+            };
+            ForEachRowBand( (uint16_t)srcHeight, srcWidth, blendRows );
         
             srcLevelPtr += source->fLevelSizes[ level + srcLevelOffset ] >> 2;
             dstLevelPtr += fLevelSizes[ level ] >> 2;
@@ -2011,6 +2066,45 @@ void    plMipmap::IColorLevel( uint8_t level, const uint8_t *colorMask )
 //// Scaling //////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+//// BuildScaleSpans //////////////////////////////////////////////////////////
+//  Works out which source pixels each destination column (or row) of
+//  ScaleNicely covers, and the filter weight of each one.
+
+static void BuildScaleSpans( uint16_t destSize, uint32_t srcSize, float destToSrcScale, float filterSize,
+                             std::vector<plMipmapKernels::ScaleSpan>& spans, std::vector<float>& weights )
+{
+    spans.resize( destSize );
+    weights.clear();
+
+    for( uint16_t dest = 0; dest < destSize; dest++ )
+    {
+        // For this pixel in the destination, figure out where in the source image we virtually are
+        float srcPos = dest * destToSrcScale;
+
+        // Range of pixels that the filter covers
+        int16_t srcStart = (int16_t)( srcPos - filterSize );
+        if( srcStart < 0 )
+            srcStart = 0;
+
+        int16_t srcEnd = (int16_t)( srcPos + filterSize );
+        if( srcEnd >= srcSize )
+            srcEnd = (int16_t)( srcSize - 1 );
+
+        spans[ dest ].fStart = srcStart;
+        spans[ dest ].fEnd = srcEnd;
+        for( uint16_t src = srcStart; src <= srcEnd; src++ )
+            weights.push_back( 1.f - ( fabs( (float)src - srcPos ) / filterSize ) );
+    }
+
+    // Point the spans at their weights now that the array is done growing
+    size_t offset = 0;
+    for( plMipmapKernels::ScaleSpan& span : spans )
+    {
+        span.fWeights = weights.data() + offset;
+        offset += span.fEnd - span.fStart + 1;
+    }
+}
+
 //// ScaleNicely //////////////////////////////////////////////////////////////
 //  Does a nice (smoothed) scaling of a 1-level mipmap onto another 1-level 
 //  mipmap. Works only for 32-bit mipmaps.
@@ -2018,13 +2112,7 @@ void    plMipmap::IColorLevel( uint8_t level, const uint8_t *colorMask )
 void    plMipmap::ScaleNicely( uint32_t *destPtr, uint16_t destWidth, uint16_t destHeight,
                                 uint16_t destStride, plMipmap::ScaleFilter filter ) const
 {
-    uint16_t      destX, destY, srcX, srcY;
-    int16_t       srcStartX, srcEndX, srcStartY, srcEndY;
-    float       srcPosX, srcPosY, destToSrcXScale, destToSrcYScale, filterWidth, filterHeight, weight;
-    float       totalWeight;
-    hsColorRGBA color, accumColor;
-    float       whyWaits[ 16 ], whyWait, xWeights[ 16 ];
-    uint32_t      *srcPtr;
+    float       destToSrcXScale, destToSrcYScale, filterWidth, filterHeight;
 
 
     // Init
@@ -2045,81 +2133,20 @@ void    plMipmap::ScaleNicely( uint32_t *destPtr, uint16_t destWidth, uint16_t d
     if( filterHeight < 1.f )
         filterHeight = 1.f;
 
+    // Precalc the spans and weights once for every column and row
+    std::vector<plMipmapKernels::ScaleSpan> xSpans, ySpans;
+    std::vector<float> xWeights, yWeights;
+    BuildScaleSpans( destWidth, fWidth, destToSrcXScale, filterWidth, xSpans, xWeights );
+    BuildScaleSpans( destHeight, fHeight, destToSrcYScale, filterHeight, ySpans, yWeights );
+
     // Process
-    for( destY = 0; destY < destHeight; destY++ )
+    const uint32_t *srcPtr = GetAddr32( 0, 0 );
+    uint32_t srcStride = fCurrLevelRowBytes >> 2;
+    ForEachRowBand( destHeight, destWidth, [&]( size_t begin, size_t end )
     {
-        // Calculate the span across this row
-        srcPosY = destY * destToSrcYScale;
-
-        srcStartY = (int16_t)( srcPosY - filterHeight );
-        if( srcStartY < 0 ) 
-            srcStartY = 0;
-
-        srcEndY = (int16_t)( srcPosY + filterHeight );
-        if( srcEndY >= fHeight ) 
-            srcEndY = (int16_t)(fHeight - 1);
-
-        // Precalc the y weights
-        for( srcY = srcStartY; srcY <= srcEndY && ( srcY - srcStartY ) < 16; srcY++ )
-            whyWaits[ srcY - srcStartY ] = 1.f - ( fabs( (float)srcY - srcPosY ) / filterHeight );
-
-        for( destX = 0; destX < destWidth; destX++ )
-        {
-            // For this pixel in the destination, figure out where in the source image we virtually are
-            srcPosX = destX * destToSrcXScale;
-
-            // Range of pixels that the filter covers
-            srcStartX = (int16_t)( srcPosX - filterWidth );
-            if( srcStartX < 0 ) 
-                srcStartX = 0;
-            
-            srcEndX = (int16_t)( srcPosX + filterWidth );
-            if( srcEndX >= fWidth ) 
-                srcEndX = (int16_t)(fWidth - 1);
-
-            // Precalc the x weights
-            for( srcX = srcStartX; srcX <= srcEndX && ( srcX - srcStartX ) < 16; srcX++ )
-                xWeights[ srcX - srcStartX ] = 1.f - ( fabs( (float)srcX - srcPosX ) / filterWidth );
-
-            // Sum up all the weighted colors in the filter area
-            accumColor.Set( 0.f, 0.f, 0.f, 0.f );
-            totalWeight = 0.f;
-            for( srcY = srcStartY; srcY <= srcEndY; srcY++ )
-            {
-                if( srcY - srcStartY < 16 )
-                    whyWait = whyWaits[ srcY - srcStartY ];
-                else
-                    whyWait = 1.f - ( fabs( (float)srcY - srcPosY ) / filterHeight );
-
-                if( whyWait <= 0.f )
-                    continue;
-
-                srcPtr = GetAddr32( srcStartX, srcY );
-                for( srcX = srcStartX; srcX <= srcEndX; srcX++, srcPtr++ )
-                {
-                    // Our weight...
-                    weight = ( srcX - srcStartX < 16 ) ? xWeights[ srcX - srcStartX ] : 
-                                ( 1.f - ( fabs( (float)srcX - srcPosX ) / filterWidth ) );
-                    weight *= whyWait;
-
-                    if( weight > 0.f )
-                    {
-                        // Grab pixel values from us...
-                        color.FromARGB32( *srcPtr );
-                        color *= weight;
-                        accumColor += color;
-                        totalWeight += weight;
-                    }
-                }
-            }
-            accumColor *= 1.f / totalWeight;
-
-            // Set the final value
-            *destPtr = accumColor.ToARGB32();
-            destPtr++;
-        }
-        destPtr += destStride - destWidth;
-    }
+        for( size_t destY = begin; destY < end; destY++ )
+            plMipmapKernels::scale_row.call( destPtr + destY * destStride, destWidth, srcPtr, srcStride, xSpans.data(), ySpans[ destY ] );
+    } );
 }
 
 //// ResizeNicely /////////////////////////////////////////////////////////////
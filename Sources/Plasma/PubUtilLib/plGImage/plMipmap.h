@@ -321,6 +321,11 @@ class plMipmap : public plBitmap
         void        ICarryZeroAlpha(uint8_t iDst);
         void        ICarryColor(uint8_t iDst, uint32_t col);
 
+        static void IFilterLevel( uint8_t *dst, uint32_t dstWidth, uint32_t dstHeight, uint32_t dstRowBytes,
+                                  const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight, uint32_t srcRowBytes,
+                                  uint32_t step, const plFilterMask& mask );
+        void        IBlendLevelDetail( uint8_t iDst, float scale, float bias, uint32_t chanMask );
+
         bool        IGrabBorderColor( bool grabVNotU, uint32_t *color );
         void        ISetCurrLevelUBorder( uint32_t color );
         void        ISetCurrLevelVBorder( uint32_t color );
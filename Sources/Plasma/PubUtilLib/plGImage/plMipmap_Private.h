@@ -0,0 +1,109 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#ifndef _plMipmap_Private_h
+#define _plMipmap_Private_h
+
+#include "HeadSpin.h"
+#include "hsCpuID.h"
+
+// Every instruction set's version of plMipmap's row kernels. Nothing outside
+// plGImage should need this but test_plGImage and plMipmapBenchmark.
+class plMipmapKernels
+{
+public:
+    // The source pixels ScaleNicely averages for one destination column or
+    // row, with a filter weight for each pixel in [fStart, fEnd]
+    struct ScaleSpan
+    {
+        uint32_t    fStart, fEnd;
+        const float *fWeights;
+    };
+
+    // Row kernels for the 32-bit filtering, scaling and compositing paths.
+    // filter_row runs the Gaussian mask centered on every step'th pixel of
+    // source row srcY; detail_row sets each byte in the channels of chanMask
+    // to bias + byte * scale; scale_row averages xSpans[x] x ySpan for each
+    // destination pixel; blend_row, mask_row and premultiply_row are the
+    // per-pixel work of Composite's blend, kMaskSrcAlpha and
+    // kDestPremultiplied paths.
+    typedef void(*filter_row_ptr)(uint8_t* dst, uint32_t dstWidth, const uint8_t* src, uint32_t srcRowBytes,
+                                  uint32_t srcWidth, uint32_t srcHeight, uint32_t srcY, uint32_t step,
+                                  const float* const* mask, int ext);
+    typedef void(*detail_row_ptr)(uint8_t* pixels, uint32_t count, float scale, float bias, uint32_t chanMask);
+    typedef void(*scale_row_ptr)(uint32_t* dest, uint32_t destWidth, const uint32_t* src, uint32_t srcStride,
+                                 const ScaleSpan* xSpans, const ScaleSpan& ySpan);
+    typedef void(*blend_row_ptr)(uint32_t* dst, const uint32_t* src, uint32_t count, uint8_t opacity,
+                                 const float* tints, bool writeAlpha);
+    typedef void(*mask_row_ptr)(uint32_t* dst, const uint32_t* src, uint32_t count, uint8_t opacity, bool premultiplied);
+    typedef void(*premultiply_row_ptr)(uint32_t* pixels, uint32_t count);
+
+    static void filter_row_fpu(uint8_t* dst, uint32_t dstWidth, const uint8_t* src, uint32_t srcRowBytes,
+                               uint32_t srcWidth, uint32_t srcHeight, uint32_t srcY, uint32_t step,
+                               const float* const* mask, int ext);
+    static void filter_row_sse2(uint8_t* dst, uint32_t dstWidth, const uint8_t* src, uint32_t srcRowBytes,
+                                uint32_t srcWidth, uint32_t srcHeight, uint32_t srcY, uint32_t step,
+                                const float* const* mask, int ext);
+    static void detail_row_fpu(uint8_t* pixels, uint32_t count, float scale, float bias, uint32_t chanMask);
+    static void detail_row_sse2(uint8_t* pixels, uint32_t count, float scale, float bias, uint32_t chanMask);
+    static void scale_row_fpu(uint32_t* dest, uint32_t destWidth, const uint32_t* src, uint32_t srcStride,
+                              const ScaleSpan* xSpans, const ScaleSpan& ySpan);
+    static void scale_row_sse2(uint32_t* dest, uint32_t destWidth, const uint32_t* src, uint32_t srcStride,
+                               const ScaleSpan* xSpans, const ScaleSpan& ySpan);
+    static void blend_row_fpu(uint32_t* dst, const uint32_t* src, uint32_t count, uint8_t opacity,
+                              const float* tints, bool writeAlpha);
+    static void blend_row_sse2(uint32_t* dst, const uint32_t* src, uint32_t count, uint8_t opacity,
+                               const float* tints, bool writeAlpha);
+    static void mask_row_fpu(uint32_t* dst, const uint32_t* src, uint32_t count, uint8_t opacity, bool premultiplied);
+    static void mask_row_sse2(uint32_t* dst, const uint32_t* src, uint32_t count, uint8_t opacity, bool premultiplied);
+    static void premultiply_row_fpu(uint32_t* pixels, uint32_t count);
+    static void premultiply_row_sse2(uint32_t* pixels, uint32_t count);
+
+    static hsCpuFunctionDispatcher<filter_row_ptr> filter_row;
+    static hsCpuFunctionDispatcher<detail_row_ptr> detail_row;
+    static hsCpuFunctionDispatcher<scale_row_ptr> scale_row;
+    static hsCpuFunctionDispatcher<blend_row_ptr> blend_row;
+    static hsCpuFunctionDispatcher<mask_row_ptr> mask_row;
+    static hsCpuFunctionDispatcher<premultiply_row_ptr> premultiply_row;
+};
+
+#endif // _plMipmap_Private_h
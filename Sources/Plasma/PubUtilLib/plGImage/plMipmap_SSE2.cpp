@@ -0,0 +1,315 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "HeadSpin.h"
+#include "plMipmap_Private.h"
+#include "plGImageSSE2_Private.h"
+
+#ifdef HAVE_SSE2
+#   include <algorithm>
+#   include <cstddef>
+#   include <cstring>
+#   include <emmintrin.h>
+
+// The float kernels keep one pixel's four channels in the lanes of a register,
+// so each lane does exactly the arithmetic the scalar code does per channel.
+static inline __m128 ILoadPixel(const void* src)
+{
+    int32_t px;
+    memcpy(&px, src, sizeof(px));
+    const __m128i zero = _mm_setzero_si128();
+    __m128i x = _mm_unpacklo_epi8(_mm_cvtsi32_si128(px), zero);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(x, zero));
+}
+
+// Truncates the four lanes to bytes, like a (uint8_t) cast of each
+static inline uint32_t IPackPixel(__m128 v)
+{
+    __m128i x = _mm_cvttps_epi32(v);
+    x = _mm_packs_epi32(x, x);
+    return uint32_t(_mm_cvtsi128_si32(_mm_packus_epi16(x, x)));
+}
+
+// The integer kernels do four pixels at a time, widened to 16-bit lanes in
+// two registers: px0/px1 in lo and px2/px3 in hi. This spreads a value held
+// in each pixel's 32-bit lane over all four of that pixel's channel lanes.
+static inline void IExpandLanes(__m128i v32, __m128i& lo, __m128i& hi)
+{
+    __m128i v = _mm_or_si128(v32, _mm_slli_epi32(v32, 16));
+    lo = _mm_unpacklo_epi32(v, v);
+    hi = _mm_unpackhi_epi32(v, v);
+}
+
+// opacity * alpha / 255 / 256 in the scalar code, which is the same as
+// opacity * alpha / 255 for every pair of bytes
+static inline __m128i ISrcAlpha(__m128i src, __m128i opacity)
+{
+    return IDiv255(_mm_mullo_epi16(_mm_srli_epi32(src, 24), opacity));
+}
+
+// (c * alpha + 127) / 255 for each color channel
+static inline __m128i IPremultiply(__m128i src, __m128i alpha32)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(127);
+    __m128i aLo, aHi;
+    IExpandLanes(alpha32, aLo, aHi);
+    __m128i lo = IDiv255(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), aLo), round));
+    __m128i hi = IDiv255(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), aHi), round));
+    return _mm_packus_epi16(lo, hi);
+}
+#endif // HAVE_SSE2
+
+void plMipmapKernels::filter_row_sse2(uint8_t* dst, uint32_t dstWidth, const uint8_t* src, uint32_t srcRowBytes,
+                               uint32_t srcWidth, uint32_t srcHeight, uint32_t srcY, uint32_t step,
+                               const float* const* mask, int ext)
+{
+#ifdef HAVE_SSE2
+    const __m128 half = _mm_set1_ps(0.5f);
+    int iiBegin = std::max(-ext, -int(srcY));
+    int iiEnd = std::min(ext, int(srcHeight) - 1 - int(srcY));
+
+    for (uint32_t j = 0; j < dstWidth; j++) {
+        uint32_t srcX = j * step;
+        int jjBegin = std::max(-ext, -int(srcX));
+        int jjEnd = std::min(ext, int(srcWidth) - 1 - int(srcX));
+        const uint8_t* center = src + size_t(srcY) * srcRowBytes + (srcX << 2);
+
+        __m128 w = _mm_setzero_ps();
+        __m128 a = _mm_setzero_ps();
+        for (int ii = iiBegin; ii <= iiEnd; ii++) {
+            const uint8_t* row = center + ptrdiff_t(ii) * srcRowBytes;
+            for (int jj = jjBegin; jj <= jjEnd; jj++) {
+                __m128 m = _mm_set1_ps(mask[ii][jj]);
+                w = _mm_add_ps(w, m);
+                a = _mm_add_ps(a, _mm_mul_ps(_mm_add_ps(ILoadPixel(row + (jj << 2)), half), m));
+            }
+        }
+
+        uint32_t px = IPackPixel(_mm_div_ps(a, w));
+        memcpy(dst + (j << 2), &px, sizeof(px));
+    }
+#endif // HAVE_SSE2
+}
+
+void plMipmapKernels::detail_row_sse2(uint8_t* pixels, uint32_t count, float scale, float bias, uint32_t chanMask)
+{
+#ifdef HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 vScale = _mm_set1_ps(scale);
+    const __m128 vBias = _mm_set1_ps(bias);
+
+    // Bytes of the channels we leave alone
+    uint32_t keep = 0;
+    for (uint32_t chan = 0; chan < 4; chan++) {
+        if (!(chanMask & (1 << chan)))
+            keep |= 0xff << (chan << 3);
+    }
+    const __m128i vKeep = _mm_set1_epi32(int(keep));
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i* out = reinterpret_cast<__m128i*>(pixels + (i << 2));
+        __m128i px = _mm_loadu_si128(out);
+        __m128i lo = _mm_unpacklo_epi8(px, zero);
+        __m128i hi = _mm_unpackhi_epi8(px, zero);
+
+        __m128i c[4] = {
+            _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+            _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero)
+        };
+        for (__m128i& x : c)
+            x = _mm_cvttps_epi32(_mm_add_ps(vBias, _mm_mul_ps(_mm_cvtepi32_ps(x), vScale)));
+
+        __m128i res = _mm_packus_epi16(_mm_packs_epi32(c[0], c[1]), _mm_packs_epi32(c[2], c[3]));
+        _mm_storeu_si128(out, ISelect(vKeep, px, res));
+    }
+
+    if (i < count)
+        detail_row_fpu(pixels + (i << 2), count - i, scale, bias, chanMask);
+#endif // HAVE_SSE2
+}
+
+void plMipmapKernels::scale_row_sse2(uint32_t* dest, uint32_t destWidth, const uint32_t* src, uint32_t srcStride,
+                              const ScaleSpan* xSpans, const ScaleSpan& ySpan)
+{
+#ifdef HAVE_SSE2
+    // Same steps as hsColorRGBA::FromARGB32() and ToARGB32()
+    const __m128 oo255 = _mm_set1_ps(1.f / 255.f);
+    const __m128 to255 = _mm_set1_ps(255.99f);
+
+    for (uint32_t destX = 0; destX < destWidth; destX++) {
+        const ScaleSpan& xSpan = xSpans[destX];
+
+        __m128 accumColor = _mm_setzero_ps();
+        float totalWeight = 0.f;
+        for (uint32_t srcY = ySpan.fStart; srcY <= ySpan.fEnd; srcY++) {
+            float whyWait = ySpan.fWeights[srcY - ySpan.fStart];
+            if (whyWait <= 0.f)
+                continue;
+
+            const uint32_t* srcPtr = src + size_t(srcY) * srcStride + xSpan.fStart;
+            for (uint32_t srcX = xSpan.fStart; srcX <= xSpan.fEnd; srcX++, srcPtr++) {
+                float weight = xSpan.fWeights[srcX - xSpan.fStart] * whyWait;
+                if (weight > 0.f) {
+                    __m128 color = _mm_mul_ps(ILoadPixel(srcPtr), oo255);
+                    accumColor = _mm_add_ps(accumColor, _mm_mul_ps(color, _mm_set1_ps(weight)));
+                    totalWeight += weight;
+                }
+            }
+        }
+        accumColor = _mm_mul_ps(accumColor, _mm_set1_ps(1.f / totalWeight));
+
+        dest[destX] = IPackPixel(_mm_mul_ps(accumColor, to255));
+    }
+#endif // HAVE_SSE2
+}
+
+void plMipmapKernels::blend_row_sse2(uint32_t* dst, const uint32_t* src, uint32_t count, uint8_t opacity,
+                              const float* tints, bool writeAlpha)
+{
+#ifdef HAVE_SSE2
+    // A tint outside [0, 1] lets a channel run over into its neighbor, which
+    // only the scalar code reproduces
+    for (int i = 0; i < 3; i++) {
+        if (!(tints[i] >= 0.f && tints[i] <= 1.f)) {
+            blend_row_fpu(dst, src, count, opacity, tints, writeAlpha);
+            return;
+        }
+    }
+    bool tinted = tints[0] != 1.f || tints[1] != 1.f || tints[2] != 1.f;
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vOpacity = _mm_set1_epi16(opacity);
+    const __m128i k256 = _mm_set1_epi16(256);
+    const __m128i colorMask = _mm_set1_epi32(0x00ffffff);
+    const __m128i alphaMask = _mm_set1_epi32(int(0xff000000));
+    const __m128 vTints = _mm_setr_ps(tints[2], tints[1], tints[0], 1.f);
+
+    uint32_t pX = 0;
+    for (; pX + 4 <= count; pX += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pX));
+        __m128i skip = _mm_cmpeq_epi32(_mm_srli_epi32(s, 24), zero);
+        if (_mm_movemask_epi8(skip) == 0xffff)
+            continue;
+
+        __m128i* out = reinterpret_cast<__m128i*>(dst + pX);
+        __m128i d = _mm_loadu_si128(out);
+
+        __m128i srcAlpha = ISrcAlpha(s, vOpacity);
+        __m128i aLo, aHi;
+        IExpandLanes(srcAlpha, aLo, aHi);
+
+        __m128i sLo = _mm_unpacklo_epi8(s, zero);
+        __m128i sHi = _mm_unpackhi_epi8(s, zero);
+        if (tinted) {
+            __m128i c[4] = {
+                _mm_unpacklo_epi16(sLo, zero), _mm_unpackhi_epi16(sLo, zero),
+                _mm_unpacklo_epi16(sHi, zero), _mm_unpackhi_epi16(sHi, zero)
+            };
+            for (__m128i& x : c)
+                x = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(x), vTints));
+            sLo = _mm_packs_epi32(c[0], c[1]);
+            sHi = _mm_packs_epi32(c[2], c[3]);
+        }
+
+        // (c * srcAlpha >> 8) + (d * (256 - srcAlpha) >> 8), which never
+        // passes 255
+        __m128i lo = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(sLo, aLo), 8),
+                                   _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(k256, aLo)), 8));
+        __m128i hi = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(sHi, aHi), 8),
+                                   _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(k256, aHi)), 8));
+
+        __m128i alpha = writeAlpha ? _mm_slli_epi32(srcAlpha, 24) : _mm_and_si128(d, alphaMask);
+        __m128i res = _mm_or_si128(_mm_and_si128(_mm_packus_epi16(lo, hi), colorMask), alpha);
+        _mm_storeu_si128(out, ISelect(skip, d, res));
+    }
+
+    if (pX < count)
+        blend_row_fpu(dst + pX, src + pX, count - pX, opacity, tints, writeAlpha);
+#endif // HAVE_SSE2
+}
+
+void plMipmapKernels::mask_row_sse2(uint32_t* dst, const uint32_t* src, uint32_t count, uint8_t opacity, bool premultiplied)
+{
+#ifdef HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vOpacity = _mm_set1_epi16(opacity);
+    const __m128i colorMask = _mm_set1_epi32(0x00ffffff);
+
+    uint32_t pX = 0;
+    for (; pX + 4 <= count; pX += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pX));
+        __m128i srcAlpha = ISrcAlpha(s, vOpacity);
+        __m128i skip = _mm_cmpeq_epi32(srcAlpha, zero);
+        if (_mm_movemask_epi8(skip) == 0xffff)
+            continue;
+
+        __m128i* out = reinterpret_cast<__m128i*>(dst + pX);
+        __m128i color = premultiplied ? IPremultiply(s, srcAlpha) : s;
+        __m128i res = _mm_or_si128(_mm_and_si128(color, colorMask), _mm_slli_epi32(srcAlpha, 24));
+        _mm_storeu_si128(out, ISelect(skip, _mm_loadu_si128(out), res));
+    }
+
+    if (pX < count)
+        mask_row_fpu(dst + pX, src + pX, count - pX, opacity, premultiplied);
+#endif // HAVE_SSE2
+}
+
+void plMipmapKernels::premultiply_row_sse2(uint32_t* pixels, uint32_t count)
+{
+#ifdef HAVE_SSE2
+    const __m128i colorMask = _mm_set1_epi32(0x00ffffff);
+    const __m128i alphaMask = _mm_set1_epi32(int(0xff000000));
+
+    uint32_t pX = 0;
+    for (; pX + 4 <= count; pX += 4) {
+        __m128i* out = reinterpret_cast<__m128i*>(pixels + pX);
+        __m128i px = _mm_loadu_si128(out);
+        __m128i color = IPremultiply(px, _mm_srli_epi32(px, 24));
+        _mm_storeu_si128(out, _mm_or_si128(_mm_and_si128(color, colorMask), _mm_and_si128(px, alphaMask)));
+    }
+
+    if (pX < count)
+        premultiply_row_fpu(pixels + pX, count - pX);
+#endif // HAVE_SSE2
+}
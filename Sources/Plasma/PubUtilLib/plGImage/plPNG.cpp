@@ -50,6 +50,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plPNG.h"
 #include "plMipmap.h"
 
+#include <algorithm>
 #include <png.h>
 #define PNGSIGSIZE 8
 
@@ -67,6 +68,32 @@ void pngWriteDelegate(png_structp png_ptr, png_bytep png_data, png_size_t length
     outStream->Write(length, (uint8_t*)png_data);
 }
 
+//  And the same for PNG data held in memory, which saves copying it into an
+//  hsRAMStream first
+struct plPNGMemSource
+{
+    const uint8_t* fData;
+    size_t fSizeLeft;
+};
+
+void pngReadMemDelegate(png_structp png_ptr, png_bytep png_data, png_size_t length)
+{
+    plPNGMemSource* source = (plPNGMemSource*)png_get_io_ptr(png_ptr);
+
+    // Short reads come back zeroed, same as off the end of an hsRAMStream
+    size_t avail = std::min(length, source->fSizeLeft);
+    memcpy(png_data, source->fData, avail);
+    memset(png_data + avail, 0, length - avail);
+    source->fData += avail;
+    source->fSizeLeft -= avail;
+}
+
+void pngWriteMemDelegate(png_structp png_ptr, png_bytep png_data, png_size_t length)
+{
+    std::vector<uint8_t>* outData = (std::vector<uint8_t>*)png_get_io_ptr(png_ptr);
+    outData->insert(outData->end(), png_data, png_data + length);
+}
+
 //// Singleton Instance ///////////////////////////////////////////////////////
 
 plPNG& plPNG::Instance()
@@ -75,13 +102,13 @@ plPNG& plPNG::Instance()
     return theInstance;
 }
 
-//// IRead ////////////////////////////////////////////////////////////////////
-//  Given an open hsStream, reads the PNG data off of the
-//  stream and decodes it into a new plMipmap. The mipmap's buffer ends up
-//  being a packed RGBA buffer.
+//// pngDecode ////////////////////////////////////////////////////////////////
+//  Given the PNGSIGSIZE signature bytes the caller already read off of its
+//  source, reads the rest of the PNG data through readFn and decodes it into
+//  a new plMipmap. The mipmap's buffer ends up being a packed RGBA buffer.
 //  Returns a pointer to the new mipmap if successful, NULL otherwise.
 
-plMipmap* plPNG::IRead(hsStream* inStream)
+static plMipmap* pngDecode(const png_byte* sig, png_rw_ptr readFn, png_voidp io)
 {
     plMipmap* newMipmap = nullptr;
     png_structp png_ptr;
@@ -90,9 +117,6 @@ plMipmap* plPNG::IRead(hsStream* inStream)
 
     try {
         //  Check PNG Signature
-        png_byte sig[PNGSIGSIZE];
-        inStream->Read(PNGSIGSIZE, sig);
-
         if (!png_sig_cmp(sig, 0, PNGSIGSIZE)) {
             //  Allocate required structs
             png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
@@ -115,8 +139,8 @@ plMipmap* plPNG::IRead(hsStream* inStream)
                 throw false;
             }
 
-            //  Assign delegate function for reading from hsStream
-            png_set_read_fn(png_ptr, (png_voidp)inStream, pngReadDelegate);
+            //  Assign delegate function for reading our source
+            png_set_read_fn(png_ptr, io, readFn);
             //  Get PNG Header information
             png_set_sig_bytes(png_ptr, PNGSIGSIZE);
             png_read_info(png_ptr, info_ptr);
@@ -179,6 +203,31 @@ plMipmap* plPNG::IRead(hsStream* inStream)
     return newMipmap;
 }
 
+//// IRead ////////////////////////////////////////////////////////////////////
+//  Given an open hsStream, reads the PNG data off of the stream and decodes
+//  it into a new plMipmap.
+
+plMipmap* plPNG::IRead(hsStream* inStream)
+{
+    png_byte sig[PNGSIGSIZE];
+    inStream->Read(PNGSIGSIZE, sig);
+
+    return pngDecode(sig, pngReadDelegate, (png_voidp)inStream);
+}
+
+//// IDecode //////////////////////////////////////////////////////////////////
+//  Decodes PNG data already in memory, reading it in place.
+
+plMipmap* plPNG::IDecode(const uint8_t* data, size_t size)
+{
+    if (size < PNGSIGSIZE) {
+        return nullptr;
+    }
+
+    plPNGMemSource source { data + PNGSIGSIZE, size - PNGSIGSIZE };
+    return pngDecode(data, pngReadMemDelegate, (png_voidp)&source);
+}
+
 plMipmap* plPNG::ReadFromFile(const plFileName& fileName)
 {
     hsUNIXStream in;
@@ -192,7 +241,11 @@ plMipmap* plPNG::ReadFromFile(const plFileName& fileName)
     return ret;
 }
 
-bool plPNG::IWrite(plMipmap* source, hsStream* outStream, const std::multimap<ST::string, ST::string>& textFields)
+//// pngEncode ////////////////////////////////////////////////////////////////
+//  Encodes source as a PNG, handing the data to writeFn as it goes.
+
+static bool pngEncode(const plMipmap* source, png_rw_ptr writeFn, png_voidp io,
+                       const std::multimap<ST::string, ST::string>& textFields)
 {
     bool result = true;
 
@@ -211,8 +264,8 @@ bool plPNG::IWrite(plMipmap* source, hsStream* outStream, const std::multimap<ST
             throw false;
         }
 
-        //  Assign delegate function for writing to hsStream
-        png_set_write_fn(png_ptr, (png_voidp)outStream, pngWriteDelegate, nullptr);
+        //  Assign delegate function for writing to our destination
+        png_set_write_fn(png_ptr, io, writeFn, nullptr);
         png_set_IHDR(png_ptr, info_ptr, source->GetWidth(), source->GetHeight(), 8, PNG_COLOR_TYPE_RGB_ALPHA,
                      PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
         // Invert color byte-order as used by plMipmap for DirectX
@@ -285,6 +338,21 @@ bool plPNG::IWrite(plMipmap* source, hsStream* outStream, const std::multimap<ST
     return result;
 }
 
+bool plPNG::IWrite(plMipmap* source, hsStream* outStream, const std::multimap<ST::string, ST::string>& textFields)
+{
+    return pngEncode(source, pngWriteDelegate, (png_voidp)outStream, textFields);
+}
+
+bool plPNG::IEncode(const plMipmap* source, std::vector<uint8_t>& outData, const std::multimap<ST::string, ST::string>& textFields)
+{
+    size_t start = outData.size();
+    if (!pngEncode(source, pngWriteMemDelegate, (png_voidp)&outData, textFields)) {
+        outData.resize(start);
+        return false;
+    }
+    return true;
+}
+
 bool plPNG::WriteToFile(const plFileName& fileName, plMipmap* sourceData, const std::multimap<ST::string, ST::string>& textFields)
 {
     hsUNIXStream out;
@@ -44,6 +44,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #define _plPNG_h
 
 #include <map>
+#include <vector>
 
 //// Class Definition /////////////////////////////////////////////////////////
 
@@ -51,11 +52,18 @@ class plMipmap;
 class hsStream;
 
 class plPNG {
+    friend class plImageCodecService;
+
 protected:
 
     plMipmap* IRead(hsStream* inStream);
     bool IWrite(plMipmap* source, hsStream* outStream, const std::multimap<ST::string, ST::string>& textFields = std::multimap<ST::string, ST::string>());
 
+    // Same as above, but straight from and to memory; encoding appends to
+    // outData. These touch no instance state, so any thread may run them.
+    static plMipmap* IDecode(const uint8_t* data, size_t size);
+    static bool IEncode(const plMipmap* source, std::vector<uint8_t>& outData, const std::multimap<ST::string, ST::string>& textFields);
+
 public:
 
     plMipmap* ReadFromStream(hsStream* inStream) { return IRead(inStream); }
@@ -65,6 +73,10 @@ public:
         const std::multimap<ST::string, ST::string>& textFields = std::multimap<ST::string, ST::string>()) { return IWrite(sourceData, outStream, textFields); }
     bool WriteToFile(const plFileName& fileName, plMipmap* sourceData, const std::multimap<ST::string, ST::string>& textFields = std::multimap<ST::string, ST::string>());
 
+    plMipmap* ReadFromMemory(const void* data, size_t size) { return IDecode((const uint8_t*)data, size); }
+    bool WriteToMemory(std::vector<uint8_t>& outData, const plMipmap* sourceData,
+        const std::multimap<ST::string, ST::string>& textFields = std::multimap<ST::string, ST::string>()) { return IEncode(sourceData, outData, textFields); }
+
     static plPNG& Instance();
 };
 
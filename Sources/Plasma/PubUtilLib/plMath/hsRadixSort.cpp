@@ -41,9 +41,12 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 *==LICENSE==*/
 
 #include "HeadSpin.h"
+#include "hsGeometry3.h"
 #include "hsMemory.h"
 #include "hsRadixSort.h"
 
+#include <utility>
+
 hsRadixSort::hsRadixSort() : fList()
 {
     HSMemory::Clear(fHeads, 256*sizeof(Elem*));
@@ -179,3 +182,97 @@ hsRadixSort::Elem* hsRadixSort::Sort(Elem* inList, uint32_t flags)
 
     return fList;
 }
+
+/////////////////////////////////////////////////////////////////////////////
+
+void hsRadixSort::SortPairs(Pair* pairs, Pair* scratch, size_t count)
+{
+    if (count < 2)
+        return;
+
+    // One read to build all four byte histograms and see if there's anything to do
+    uint32_t hist[4][256];
+    memset(hist, 0, sizeof(hist));
+
+    bool sorted = true;
+    uint32_t prev = pairs[0].fKey;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t key = pairs[i].fKey;
+        sorted &= (prev <= key);
+        prev = key;
+
+        hist[0][key & 0xff]++;
+        hist[1][(key >> 8) & 0xff]++;
+        hist[2][(key >> 16) & 0xff]++;
+        hist[3][key >> 24]++;
+    }
+    if (sorted)
+        return;
+
+    Pair* src = pairs;
+    Pair* dst = scratch;
+    for (int pass = 0; pass < 4; pass++)
+    {
+        uint32_t* h = hist[pass];
+        int shift = pass * 8;
+
+        // Every key has the same byte here, so this pass wouldn't move anything
+        if (h[(src[0].fKey >> shift) & 0xff] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (int b = 0; b < 256; b++)
+        {
+            uint32_t n = h[b];
+            h[b] = offset;
+            offset += n;
+        }
+
+        for (size_t i = 0; i < count; i++)
+            dst[h[(src[i].fKey >> shift) & 0xff]++] = src[i];
+
+        std::swap(src, dst);
+    }
+
+    if (src != pairs)
+        memcpy(pairs, src, count * sizeof(Pair));
+}
+
+static inline const hsPoint3& IPointAt(const hsPoint3* pts, size_t stride, size_t i)
+{
+    return *reinterpret_cast<const hsPoint3*>(reinterpret_cast<const uint8_t*>(pts) + i * stride);
+}
+
+void hsRadixSort::depth_keys_fpu(const hsPoint3* pts, size_t stride, size_t count,
+                                 const hsVector3& dir, float offset, Pair* out, uint32_t firstIdx)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i].fKey = FloatKey(dir.InnerProduct(IPointAt(pts, stride, i)) + offset);
+        out[i].fIndex = firstIdx + uint32_t(i);
+    }
+}
+
+void hsRadixSort::far_to_near_keys_fpu(const hsPoint3* pts, size_t stride, size_t count,
+                                       const hsPoint3& from, Pair* out, uint32_t firstIdx)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i].fKey = FloatKey(-(from - IPointAt(pts, stride, i)).MagnitudeSquared());
+        out[i].fIndex = firstIdx + uint32_t(i);
+    }
+}
+
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<hsRadixSort::depth_keys_ptr> hsRadixSort::depth_keys {
+    &hsRadixSort::depth_keys_fpu,
+    nullptr,            // SSE1
+    &hsRadixSort::depth_keys_sse2
+};
+
+hsCpuFunctionDispatcher<hsRadixSort::far_to_near_keys_ptr> hsRadixSort::far_to_near_keys {
+    &hsRadixSort::far_to_near_keys_fpu,
+    nullptr,            // SSE1
+    &hsRadixSort::far_to_near_keys_sse2
+};
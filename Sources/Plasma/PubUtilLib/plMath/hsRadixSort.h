@@ -43,6 +43,11 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #ifndef hsRadixSort_inc
 #define hsRadixSort_inc
 
+#include "hsCpuID.h"
+
+struct hsPoint3;
+struct hsVector3;
+
 class hsRadixSortElem 
 {
 public:
@@ -57,6 +62,14 @@ public:
     hsRadixSortElem*            fNext;
 };
 
+// Flat alternative to the linked Elem list, for SortPairs. fIndex is
+// whatever the caller needs to find its data again afterwards.
+struct hsRadixSortPair
+{
+    uint32_t                    fKey;
+    uint32_t                    fIndex;
+};
+
 class hsRadixSort {
 public:
     enum {
@@ -66,6 +79,7 @@ public:
         kReverse    = 0x4
     };
     typedef hsRadixSortElem Elem;
+    typedef hsRadixSortPair Pair;
 
 protected:
     Elem*           fList;
@@ -86,6 +100,50 @@ public:
 
     Elem*   Sort(Elem* inList, uint32_t flags = 0);
 
+    // Maps a float to an unsigned key that sorts the same way the float does
+    static uint32_t FloatKey(float f)
+    {
+        uint32_t u;
+        memcpy(&u, &f, sizeof(u));
+        return u ^ (uint32_t(int32_t(u) >> 31) | 0x80000000);
+    }
+
+    // Stable ascending sort of pairs by fKey. scratch must have room for count
+    // pairs; the result always ends up back in pairs. Byte passes where every
+    // key agrees are skipped, and input that is already in order (as it
+    // usually is when the caller keeps last frame's order) costs one read.
+    static void SortPairs(Pair* pairs, Pair* scratch, size_t count);
+
+    // Fill out[i] with the key for the point at (pts + i * stride bytes) and
+    // index firstIdx + i.  Points sort by (dir . pt + offset), ascending.
+    static void DepthKeys(const hsPoint3* pts, size_t stride, size_t count,
+                          const hsVector3& dir, float offset, Pair* out, uint32_t firstIdx)
+    {
+        depth_keys.call(pts, stride, count, dir, offset, out, firstIdx);
+    }
+
+    // As DepthKeys, but points sort farthest from 'from' first.
+    static void FarToNearKeys(const hsPoint3* pts, size_t stride, size_t count,
+                              const hsPoint3& from, Pair* out, uint32_t firstIdx)
+    {
+        far_to_near_keys.call(pts, stride, count, from, out, firstIdx);
+    }
+
+private:
+    //  CPU-optimized functions
+    typedef void(*depth_keys_ptr)(const hsPoint3*, size_t, size_t, const hsVector3&, float, Pair*, uint32_t);
+    typedef void(*far_to_near_keys_ptr)(const hsPoint3*, size_t, size_t, const hsPoint3&, Pair*, uint32_t);
+    static hsCpuFunctionDispatcher<depth_keys_ptr> depth_keys;
+    static hsCpuFunctionDispatcher<far_to_near_keys_ptr> far_to_near_keys;
+
+    static void depth_keys_fpu(const hsPoint3* pts, size_t stride, size_t count,
+                               const hsVector3& dir, float offset, Pair* out, uint32_t firstIdx);
+    static void depth_keys_sse2(const hsPoint3* pts, size_t stride, size_t count,
+                                const hsVector3& dir, float offset, Pair* out, uint32_t firstIdx);
+    static void far_to_near_keys_fpu(const hsPoint3* pts, size_t stride, size_t count,
+                                     const hsPoint3& from, Pair* out, uint32_t firstIdx);
+    static void far_to_near_keys_sse2(const hsPoint3* pts, size_t stride, size_t count,
+                                      const hsPoint3& from, Pair* out, uint32_t firstIdx);
 };
 
 #endif // hsRadixSort_inc
@@ -0,0 +1,135 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "HeadSpin.h"
+#include "hsGeometry3.h"
+#include "hsRadixSort.h"
+
+#ifdef HAVE_SSE2
+#   include <emmintrin.h>
+
+// Four points at a time, read straight out of the caller's structs
+#   define LOADPOINTS(pts, stride, i) \
+        const hsPoint3& p0 = IPointAt(pts, stride, i); \
+        const hsPoint3& p1 = IPointAt(pts, stride, i + 1); \
+        const hsPoint3& p2 = IPointAt(pts, stride, i + 2); \
+        const hsPoint3& p3 = IPointAt(pts, stride, i + 3); \
+        __m128 x = _mm_set_ps(p3.fX, p2.fX, p1.fX, p0.fX); \
+        __m128 y = _mm_set_ps(p3.fY, p2.fY, p1.fY, p0.fY); \
+        __m128 z = _mm_set_ps(p3.fZ, p2.fZ, p1.fZ, p0.fZ);
+
+// Same bit twiddle as hsRadixSort::FloatKey, then interleave with the indices
+#   define STOREKEYS(val, out, idx) \
+        __m128i bits = _mm_castps_si128(val); \
+        __m128i mask = _mm_or_si128(_mm_srai_epi32(bits, 31), signBit); \
+        __m128i keys = _mm_xor_si128(bits, mask); \
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi32(keys, idx)); \
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2), _mm_unpackhi_epi32(keys, idx));
+
+static inline const hsPoint3& IPointAt(const hsPoint3* pts, size_t stride, size_t i)
+{
+    return *reinterpret_cast<const hsPoint3*>(reinterpret_cast<const uint8_t*>(pts) + i * stride);
+}
+#endif // HAVE_SSE2
+
+void hsRadixSort::depth_keys_sse2(const hsPoint3* pts, size_t stride, size_t count,
+                                  const hsVector3& dir, float offset, Pair* out, uint32_t firstIdx)
+{
+#ifdef HAVE_SSE2
+    const __m128 dx = _mm_set1_ps(dir.fX);
+    const __m128 dy = _mm_set1_ps(dir.fY);
+    const __m128 dz = _mm_set1_ps(dir.fZ);
+    const __m128 off = _mm_set1_ps(offset);
+    const __m128i signBit = _mm_set1_epi32(int32_t(0x80000000));
+    const __m128i four = _mm_set1_epi32(4);
+    __m128i idx = _mm_setr_epi32(firstIdx, firstIdx + 1, firstIdx + 2, firstIdx + 3);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        LOADPOINTS(pts, stride, i);
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, dx), _mm_mul_ps(y, dy)),
+                              _mm_add_ps(_mm_mul_ps(z, dz), off));
+        STOREKEYS(d, out + i, idx);
+        idx = _mm_add_epi32(idx, four);
+    }
+
+    for (; i < count; i++)
+    {
+        out[i].fKey = FloatKey(dir.InnerProduct(IPointAt(pts, stride, i)) + offset);
+        out[i].fIndex = firstIdx + uint32_t(i);
+    }
+#endif // HAVE_SSE2
+}
+
+void hsRadixSort::far_to_near_keys_sse2(const hsPoint3* pts, size_t stride, size_t count,
+                                        const hsPoint3& from, Pair* out, uint32_t firstIdx)
+{
+#ifdef HAVE_SSE2
+    const __m128 fx = _mm_set1_ps(from.fX);
+    const __m128 fy = _mm_set1_ps(from.fY);
+    const __m128 fz = _mm_set1_ps(from.fZ);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128i signBit = _mm_set1_epi32(int32_t(0x80000000));
+    const __m128i four = _mm_set1_epi32(4);
+    __m128i idx = _mm_setr_epi32(firstIdx, firstIdx + 1, firstIdx + 2, firstIdx + 3);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        LOADPOINTS(pts, stride, i);
+        x = _mm_sub_ps(fx, x);
+        y = _mm_sub_ps(fy, y);
+        z = _mm_sub_ps(fz, z);
+        __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        __m128 d = _mm_sub_ps(zero, distSq);
+        STOREKEYS(d, out + i, idx);
+        idx = _mm_add_epi32(idx, four);
+    }
+
+    for (; i < count; i++)
+    {
+        out[i].fKey = FloatKey(-(from - IPointAt(pts, stride, i)).MagnitudeSquared());
+        out[i].fIndex = firstIdx + uint32_t(i);
+    }
+#endif // HAVE_SSE2
+}
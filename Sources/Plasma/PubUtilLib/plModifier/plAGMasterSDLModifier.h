@@ -78,7 +78,7 @@ public:
     CLASSNAME_REGISTER( plAGMasterSDLModifier);
     GETINTERFACE_ANY( plAGMasterSDLModifier, plAnimTimeConvertSDLModifier);
 
-    plAGMasterSDLModifier() {}
+    plAGMasterSDLModifier() { fNestedDeltas = true; }
     ~plAGMasterSDLModifier() {}
 
     const char* GetSDLName() const override { return kSDLAGMaster; }
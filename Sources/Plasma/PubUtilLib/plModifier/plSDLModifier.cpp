@@ -49,7 +49,9 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plNetMessage/plNetMessage.h"
 #include "plSDL/plSDL.h"
 
-plSDLModifier::plSDLModifier() : fStateCache(), fSentOrRecvdState()
+#include <memory>
+
+plSDLModifier::plSDLModifier() : fStateCache(), fSentOrRecvdState(), fNestedDeltas()
 {
 }
 
@@ -187,7 +189,10 @@ void plSDLModifier::SendState(uint32_t sendFlags)
     IPutCurrentStateIn(curState);   // return sdl record which reflects current state of sceneObj, dirties curState
     if (!force)
     {
-        curState->FlagDifferentState(*fStateCache); // flag items which are different from localCopy as dirty
+        // Servers and older clients take a nested var's missing records to be defaults,
+        // so only send nested deltas once the whole shard knows how to fill them in.
+        bool nestedDeltas = fNestedDeltas && plSDLMgr::GetInstance()->AllowNestedDeltas();
+        curState->FlagDifferentState(*fStateCache, nestedDeltas);   // flag items which are different from localCopy as dirty
     }
 
     if (curState->IsDirty())
@@ -234,8 +239,17 @@ void plSDLModifier::ReceiveState(const plStateDataRecord* srcState)
     {
         plSynchEnabler ps(false);   // disable dirty tracking while we are receiving/applying state
 
+        // a nested delta only carries the records which changed, complete it from our cache
+        std::unique_ptr<plStateDataRecord> fullState;
+        if (fNestedDeltas && fSentOrRecvdState && srcState->HasUsedSDVars() &&
+            srcState->GetDescriptor() == fStateCache->GetDescriptor())
+        {
+            fullState = std::make_unique<plStateDataRecord>(*srcState, plSDL::kKeepDirty | plSDL::kWriteTimeStamps);
+            fullState->FillUnusedRecordsFrom(*fStateCache);
+        }
+
         // apply incoming state
-        ISetCurrentStateFrom(srcState);         // apply incoming state to sceneObj
+        ISetCurrentStateFrom(fullState ? fullState.get() : srcState);   // apply incoming state to sceneObj
 
         // cache state, send notifications if necessary 
         fStateCache->UpdateFrom(*srcState, false);  // update local copy of state
@@ -54,6 +54,7 @@ class plSDLModifier : public plSingleModifier
 protected:
     plStateDataRecord* fStateCache;
     bool    fSentOrRecvdState;
+    bool    fNestedDeltas;      // only send the nested records which changed, if plSDLMgr allows it
     
     void ISendNetMsg(plStateDataRecord*& state, plKey senderKey, uint32_t sendFlags);     // transmit net msg 
     virtual void IPutCurrentStateIn(plStateDataRecord* dstState) = 0;
@@ -101,7 +101,8 @@ plNetClientMgr::PendingLoad::~PendingLoad()
 //
 plNetClientMgr::plNetClientMgr()
     : fLocalPlayerKey(), fMsgHandler(this), fJoinOrder(), fTaskProgBar(),
-      fMsgRecorder(), fServerTimeOffset(), fTimeSamples(), fLastTimeUpdate(),
+      fMsgRecorder(), fBenchmarkPlayer(), fReplayBenchmark(), fQuitAfterBenchmark(),
+      fServerTimeOffset(), fTimeSamples(), fLastTimeUpdate(),
       fListenListMode(kListenList_Distance), fAgeSDLObjectKey(), fExperimentalLevel(),
       fOverrideAgeTimeOfDayPercent(-1.f), fNumInitialSDLStates(), fRequiredNumInitialSDLStates(),
       fDisableMsg(), fIsOwner(true), fIniPlayerID(), fPingServerType()
@@ -155,6 +156,10 @@ void plNetClientMgr::Shutdown()
     for (int i = 0; i < fMsgPlayers.size(); i++)
         delete fMsgPlayers[i];
     fMsgPlayers.clear();
+    delete fBenchmarkPlayer;
+    fBenchmarkPlayer = nullptr;
+    delete fReplayBenchmark;
+    fReplayBenchmark = nullptr;
 
     IRemoveCloneRoom();
 
@@ -821,6 +826,11 @@ bool plNetClientMgr::MsgReceive( plMessage* msg )
     if (plNetLinkingMgr::GetInstance()->MsgReceive( msg ))
         return true;
 
+    // A benchmark replay holds its messages back while we're between ages
+    plAgeLoadedMsg* ageLoadedMsg = plAgeLoadedMsg::ConvertNoRef(msg);
+    if (ageLoadedMsg && fBenchmarkPlayer)
+        fBenchmarkPlayer->RecordAgeLoadedMsg(ageLoadedMsg);
+
     plEvalMsg* evalMsg = plEvalMsg::ConvertNoRef(msg);
     if (evalMsg)
     {
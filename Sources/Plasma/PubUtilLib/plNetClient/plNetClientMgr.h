@@ -75,6 +75,7 @@ class plPlate;
 class plLoadCloneMsg;
 class plPlayerPageMsg;
 class plNetClientRecorder;
+class plNetClientReplayBenchmark;
 class plVaultPlayerNode;
 class plVaultAgeNode;
 class plNetVoiceListMsg;
@@ -180,6 +181,10 @@ private:
     // recorder support
     plNetClientRecorder* fMsgRecorder;
     std::vector<plNetClientRecorder*> fMsgPlayers;
+    plNetClientRecorder* fBenchmarkPlayer;
+    plNetClientReplayBenchmark* fReplayBenchmark;
+    ST::string fBenchmarkName;
+    bool fQuitAfterBenchmark;
 
     plKey   fAgeSDLObjectKey;
     uint8_t fExperimentalLevel;
@@ -230,6 +235,8 @@ private:
     // recorder
     bool IIsRecordableMsg(plNetMessage* msg);
     void IPlaybackMsgs();
+    void IPlaybackBenchmark();
+    void IEndBenchmark();
 
     void IRequestAgeState();
 
@@ -351,6 +358,8 @@ public:
 
     bool RecordMsgs(const char* recType, const char* recName);
     bool PlaybackMsgs(const char* recName);
+    bool BenchmarkMsgs(const char* recName, float frameStep, bool quitWhenDone);
+    bool IsBenchmarking() const { return fReplayBenchmark != nullptr; }
 
     void MakeCCRInvisible(plKey avKey, int level);
     bool CCRVaultConnected() const { return GetFlagsBit(kCCRVaultConnected); }
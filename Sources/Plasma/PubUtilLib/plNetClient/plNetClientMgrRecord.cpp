@@ -43,11 +43,15 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plNetClientMgr.h"
 
 #include "plgDispatch.h"
+#include "hsResMgr.h"
+#include "hsTimer.h"
 
+#include "pnMessage/plClientMsg.h"
 #include "pnMessage/plTimeMsg.h"
 #include "pnNetCommon/pnNetCommon.h"
 
 #include "plNetClientRecorder/plNetClientRecorder.h"
+#include "plNetClientRecorder/plNetClientReplayBenchmark.h"
 
 //
 // make a recording of current play
@@ -102,11 +106,78 @@ bool plNetClientMgr::PlaybackMsgs(const char* recName)
     }
 }
 
+//
+// play a recording as a benchmark, with outgoing net traffic stubbed out.
+// frameStep is the recorded time per frame, or 0 to play back in real time.
+//
+bool plNetClientMgr::BenchmarkMsgs(const char* recName, float frameStep, bool quitWhenDone)
+{
+    if (fReplayBenchmark)
+        return false;
+
+    hsLogEntry(DebugMsg("DEMO: Beginning Benchmark"));
+
+    fReplayBenchmark = new plNetClientReplayBenchmark(frameStep);
+    fBenchmarkPlayer = new plNetClientStreamRecorder(fReplayBenchmark);
+
+    if (!fBenchmarkPlayer->BeginPlayback(recName))
+    {
+        delete fBenchmarkPlayer;
+        fBenchmarkPlayer = nullptr;
+        delete fReplayBenchmark;
+        fReplayBenchmark = nullptr;
+        return false;
+    }
+
+    fBenchmarkName = recName;
+    fQuitAfterBenchmark = quitWhenDone;
+    return true;
+}
+
+void plNetClientMgr::IPlaybackBenchmark()
+{
+    if (fBenchmarkPlayer->IsQueueEmpty())
+    {
+        IEndBenchmark();
+        return;
+    }
+
+    fReplayBenchmark->BeginFrame();
+
+    while (plNetMessage* msg = fBenchmarkPlayer->GetNextMessage())
+    {
+        fReplayBenchmark->BeginMsg(msg);
+        fMsgHandler.ReceiveMsg(msg);
+        fReplayBenchmark->EndMsg();
+    }
+}
+
+void plNetClientMgr::IEndBenchmark()
+{
+    fReplayBenchmark->Report(fBenchmarkName.c_str());
+
+    delete fBenchmarkPlayer;
+    fBenchmarkPlayer = nullptr;
+    delete fReplayBenchmark;
+    fReplayBenchmark = nullptr;
+
+    hsLogEntry(DebugMsg("DEMO: Benchmark Complete"));
+
+    if (fQuitAfterBenchmark)
+    {
+        plClientMsg* quitMsg = new plClientMsg(plClientMsg::kQuit);
+        quitMsg->Send(hsgResMgr::ResMgr()->FindKey(kClient_KEY));
+    }
+}
+
 //
 //
 //
 void plNetClientMgr::IPlaybackMsgs()
 {
+    if (fReplayBenchmark)
+        IPlaybackBenchmark();
+
     for (int i = 0; i < fMsgPlayers.size(); i++)
     {
         plNetClientRecorder* recorder = fMsgPlayers[i];
@@ -410,6 +410,10 @@ int plNetClientMgr::SendMsg(plNetMessage* msg)
     if (GetFlagsBit(kDisabled))
         return hsOK;
 
+    // Replay benchmarks run against the recording, not the server
+    if (fReplayBenchmark)
+        return hsOK;
+
     if (!CanSendMsg(msg))
         return hsOK;
 
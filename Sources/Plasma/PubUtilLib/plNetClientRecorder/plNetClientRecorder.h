@@ -113,6 +113,13 @@ public:
 //
 class plNetClientStreamRecorder : public plNetClientLoggingRecorder
 {
+public:
+    // What the recording holds ahead of the messages
+    enum NetClientRecFlags
+    {
+        kNetClientRecSDLDesc,
+    };
+
 protected:
     hsStream* fRecordStream;
 
@@ -0,0 +1,215 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plNetClientReplayBenchmark.h"
+
+#include "hsTimer.h"
+#include "plProfile.h"
+#include "plProfileManager.h"
+
+#include <algorithm>
+
+#include "pnFactory/plFactory.h"
+
+#include "plNetMessage/plNetMessage.h"
+#include "plStatusLog/plStatusLog.h"
+
+plNetClientReplayBenchmark::plNetClientReplayBenchmark(float frameStep) :
+    fFrameStep(frameStep),
+    fWasRealTime(hsTimer::IsRealTime()),
+    fReplayTime(),
+    fRunStart(),
+    fFrameStart(),
+    fFrameDispatch(),
+    fMsgStart(),
+    fCurrMsg()
+{
+    fLog = plStatusLogMgr::GetInstance().CreateStatusLog(60, "ReplayBenchmark.log", plStatusLog::kAlignToTop);
+
+    if (fFrameStep > 0.f)
+    {
+        hsTimer::SetFrameTimeInc(fFrameStep);
+        hsTimer::SetRealTime(false);
+    }
+
+    // Time every subsystem for the whole run
+    for (plProfileVar* var : plProfileManager::Instance().GetVars())
+    {
+        var->SetActive(true);
+        var->Start();
+        var->ResetRun();
+    }
+}
+
+plNetClientReplayBenchmark::~plNetClientReplayBenchmark()
+{
+    if (fFrameStep > 0.f)
+        hsTimer::SetRealTime(fWasRealTime);
+
+    delete fLog;
+}
+
+void plNetClientReplayBenchmark::BeginFrame()
+{
+    double now = hsTimer::GetSeconds();
+
+    if (fFrameStart == 0.0)
+        fRunStart = now;
+    else
+    {
+        fFrameTimes.push_back(float((now - fFrameStart) * 1000.0));
+        fDispatchTimes.push_back(float(fFrameDispatch * 1000.0));
+    }
+
+    fFrameStart = now;
+    fFrameDispatch = 0.0;
+
+    if (fFrameStep > 0.f)
+        fReplayTime += fFrameStep;
+    else
+        fReplayTime = now - fRunStart;
+}
+
+void plNetClientReplayBenchmark::BeginMsg(plNetMessage* msg)
+{
+    // Look the type up now, the handler is free to consume the message
+    fCurrMsg = &fMsgStats[IGetMsgName(msg)];
+    fMsgStart = hsTimer::GetSeconds();
+}
+
+void plNetClientReplayBenchmark::EndMsg()
+{
+    double secs = hsTimer::GetSeconds() - fMsgStart;
+    fFrameDispatch += secs;
+
+    if (fCurrMsg)
+    {
+        fCurrMsg->fCount++;
+        fCurrMsg->fTotal += secs;
+        fCurrMsg->fMax = std::max(fCurrMsg->fMax, secs);
+        fCurrMsg = nullptr;
+    }
+}
+
+ST::string plNetClientReplayBenchmark::IGetMsgName(plNetMessage* msg)
+{
+    // Game messages all look alike, so break them down by what they carry
+    if (plNetMsgGameMessage* gameMsg = plNetMsgGameMessage::ConvertNoRef(msg))
+    {
+        const char* contained = plFactory::GetNameOfClass(gameMsg->StreamInfo()->GetStreamType());
+        if (contained)
+            return ST::format("{}:{}", msg->ClassName(), contained);
+    }
+
+    return msg->ClassName();
+}
+
+float plNetClientReplayBenchmark::IPercentile(const std::vector<float>& sorted, float pct)
+{
+    if (sorted.empty())
+        return 0.f;
+
+    size_t idx = size_t(pct * (sorted.size() - 1) + 0.5f);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+void plNetClientReplayBenchmark::Report(const char* recName)
+{
+    double runTime = fFrameStart - fRunStart;
+
+    fLog->AddLineF("Replay of {} ({})", recName,
+                   fFrameStep > 0.f ? ST::format("fixed step {.4f}s", fFrameStep) : ST_LITERAL("real time"));
+    fLog->AddLineF("{} frames in {.2f}s ({.1f} fps)", fFrameTimes.size(), runTime,
+                   runTime > 0.0 ? fFrameTimes.size() / runTime : 0.0);
+
+    IReportFrames();
+    IReportMsgs();
+    IReportProfile();
+}
+
+void plNetClientReplayBenchmark::IReportFrames()
+{
+    std::vector<float> frames = fFrameTimes;
+    std::vector<float> dispatch = fDispatchTimes;
+    std::sort(frames.begin(), frames.end());
+    std::sort(dispatch.begin(), dispatch.end());
+
+    fLog->AddLine("");
+    fLog->AddLine("            p50      p90      p99      max (ms)");
+    fLog->AddLineF("Frame    {>7.2f}  {>7.2f}  {>7.2f}  {>7.2f}",
+                   IPercentile(frames, 0.5f), IPercentile(frames, 0.9f),
+                   IPercentile(frames, 0.99f), IPercentile(frames, 1.f));
+    fLog->AddLineF("Dispatch {>7.2f}  {>7.2f}  {>7.2f}  {>7.2f}",
+                   IPercentile(dispatch, 0.5f), IPercentile(dispatch, 0.9f),
+                   IPercentile(dispatch, 0.99f), IPercentile(dispatch, 1.f));
+}
+
+void plNetClientReplayBenchmark::IReportMsgs()
+{
+    fLog->AddLine("");
+    fLog->AddLine("Message                                          count   total ms     max ms");
+    for (const auto& it : fMsgStats)
+    {
+        fLog->AddLineF("{<46} {>7}  {>9.2f}  {>9.3f}", it.first, it.second.fCount,
+                       it.second.fTotal * 1000.0, it.second.fMax * 1000.0);
+    }
+}
+
+void plNetClientReplayBenchmark::IReportProfile()
+{
+    fLog->AddLine("");
+    fLog->AddLine("Timer                                             avg ms     max ms");
+    for (plProfileVar* var : plProfileManager::Instance().GetVars())
+    {
+        if (!(var->GetDisplayFlags() & plProfileBase::kDisplayTime) || var->GetRunFrames() == 0)
+            continue;
+
+        uint64_t avg = var->GetRunTotal() / var->GetRunFrames();
+        if (avg == 0 && var->GetMax() == 0)
+            continue;
+
+        fLog->AddLineF("{<46} {>9.3f}  {>9.3f}",
+                       ST::format("{}:{}", var->GetGroup(), var->GetName()),
+                       hsTimer::GetMilliSeconds<double>(avg),
+                       hsTimer::GetMilliSeconds<double>(var->GetMax()));
+    }
+}
@@ -0,0 +1,117 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+#ifndef plNetClientReplayBenchmark_h_inc
+#define plNetClientReplayBenchmark_h_inc
+
+#include "HeadSpin.h"
+
+#include <map>
+#include <vector>
+
+#include <string_theory/string>
+
+#include "plNetClientRecorder.h"
+
+class plNetMessage;
+class plStatusLog;
+
+//
+// Drives a plNetClientStreamRecorder playback as a repeatable benchmark.
+//
+// With a non-zero frame step, both the recording and the game clock advance by
+// exactly that much per frame, so every run dispatches the same messages on the
+// same frames no matter how long each frame really takes.  With a zero step the
+// recording plays back in real time.  Wall-clock frame times, per message type
+// dispatch costs and the profile timers are written to ReplayBenchmark.log.
+//
+class plNetClientReplayBenchmark : public plNetClientRecorder::TimeWrapper
+{
+protected:
+    struct MsgStats
+    {
+        uint32_t fCount;
+        double fTotal;
+        double fMax;
+
+        MsgStats() : fCount(), fTotal(), fMax() { }
+    };
+
+    float fFrameStep;           // Seconds of recorded time per frame, 0 for real time
+    bool fWasRealTime;
+    double fReplayTime;
+
+    double fRunStart;
+    double fFrameStart;
+    double fFrameDispatch;      // Time spent dispatching recorded messages this frame
+    double fMsgStart;
+
+    std::vector<float> fFrameTimes;     // Wall-clock milliseconds
+    std::vector<float> fDispatchTimes;
+    std::map<ST::string, MsgStats> fMsgStats;
+    MsgStats* fCurrMsg;
+
+    plStatusLog* fLog;
+
+    static ST::string IGetMsgName(plNetMessage* msg);
+    static float IPercentile(const std::vector<float>& sorted, float pct);
+
+    void IReportFrames();
+    void IReportMsgs();
+    void IReportProfile();
+
+public:
+    plNetClientReplayBenchmark(float frameStep);
+    ~plNetClientReplayBenchmark();
+
+    double GetWrappedTime() override { return fReplayTime; }
+
+    // Call once per frame, before the recording is asked for messages
+    void BeginFrame();
+
+    // Bracket the dispatch of each recorded message
+    void BeginMsg(plNetMessage* msg);
+    void EndMsg();
+
+    void Report(const char* recName);
+};
+
+#endif // plNetClientReplayBenchmark_h_inc
@@ -90,11 +90,6 @@ double plNetClientStreamRecorder::GetNextMessageTimeDelta()
     return fNextPlaybackTime - (GetTime() - fPlaybackTimeOffset);
 }
 
-enum NetClientRecFlags
-{
-    kNetClientRecSDLDesc,
-};
-
 bool plNetClientStreamRecorder::BeginRecording(const char* recName)
 {
     if (!fRecordStream)
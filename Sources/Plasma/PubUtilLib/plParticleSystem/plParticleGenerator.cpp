@@ -51,6 +51,8 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "hsResMgr.h"
 #include "hsStream.h"
 
+#include <vector>
+
 #include "pnEncryption/plRandom.h"
 
 #include "plInterp/plController.h"
@@ -385,11 +387,16 @@ bool plOneTimeParticleGenerator::AddAutoParticles(plParticleEmitter *emitter, fl
     hsVector3 zeroVel;
     float radsPerSec = 0;
 
-    int i;
-    for (i = 0; i < fCount; i++)
+    const size_t count = (size_t)fCount;
+    std::vector<hsPoint3> worldPos(count);
+    std::vector<hsVector3> worldDir(count);
+    emitter->GetLocalToWorld().MapPoints(count, fPosition, worldPos.data());
+    emitter->GetLocalToWorld().MapVectors(count, fDirection, worldDir.data());
+
+    for (size_t i = 0; i < count; i++)
     {
-        currStart = emitter->GetLocalToWorld() * fPosition[i];
-        initDirection = emitter->GetLocalToWorld() * fDirection[i];
+        currStart = worldPos[i];
+        initDirection = worldDir[i];
 
         if (emitter->fMiscFlags & emitter->kOrientationUp)
             orientation.Set(0.0f, -1.0f, 0.0f);
@@ -43,6 +43,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plLOSDispatch.h"
 
 #include "plgDispatch.h"
+#include "hsJobSystem.h"
 #include "plProfile.h"
 
 #include "pnKeyedObject/plFixedKey.h"
@@ -58,6 +59,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plStatusLog/plStatusLog.h"
 
 plProfile_CreateTimer("LineOfSight", "Simulation", LineOfSight);
+plProfile_CreateCounter("LOS Queries", "Simulation", LOSQueries);
 
 plLOSDispatch::plLOSDispatch()
     : fDebugDisplay()
@@ -71,45 +73,18 @@ plLOSDispatch::~plLOSDispatch()
 {
     plgDispatch::Dispatch()->UnRegisterForExactType(plLOSRequestMsg::Index(), GetKey());
     plgDispatch::Dispatch()->UnRegisterForExactType(plRenderMsg::Index(), GetKey());
+
+    for (plLOSRequestMsg* request : fPending)
+        hsRefCnt_SafeUnRef(request);
 }
 
 bool plLOSDispatch::MsgReceive(plMessage* msg)
 {
     plLOSRequestMsg* requestMsg = plLOSRequestMsg::ConvertNoRef(msg);
     if (requestMsg) {
-        plProfile_BeginTiming(LineOfSight);
-
-        plKey worldKey = requestMsg->fWorldKey;
-        if (!worldKey) {
-            plArmatureMod* av = plAvatarMgr::GetInstance()->GetLocalAvatar();
-            if (av && av->GetController())
-                worldKey = av->GetController()->GetSubworld();
-        }
-
-        auto result = IRaycast(requestMsg->fFrom, requestMsg->fTo, worldKey, requestMsg->fRequestType,
-                               requestMsg->GetTestType() == plLOSRequestMsg::kTestClosest,
-                               requestMsg->GetCullDB());
-        if (result.fResult == LOSResult::kHit &&
-            (requestMsg->GetReportType() == plLOSRequestMsg::kReportHit ||
-             requestMsg->GetReportType() == plLOSRequestMsg::kReportHitOrMiss)) {
-            plLOSHitMsg* hitMsg = new plLOSHitMsg(GetKey(), requestMsg->GetSender(), requestMsg->fRequestID);
-            hitMsg->fObj = result.fHitObj;
-            hitMsg->fHitPoint = result.fPoint;
-            hitMsg->fNormal = result.fNormal;
-            hitMsg->fDistance = result.fDistance;
-            hitMsg->Send();
-        } else if (result.fResult != LOSResult::kHit &&
-                   (requestMsg->GetReportType() == plLOSRequestMsg::kReportMiss ||
-                    requestMsg->GetReportType() == plLOSRequestMsg::kReportHitOrMiss)) {
-            plLOSHitMsg* missMsg = new plLOSHitMsg(GetKey(), requestMsg->GetSender(), requestMsg->fRequestID);
-            missMsg->fNoHit = true;
-            // Don't leak out any internal state, just report a miss.
-            missMsg->Send();
-        }
-
-        fRequests.emplace_back(requestMsg->GetRequestName(), requestMsg->GetRequestID(), result.fResult);
-
-        plProfile_EndTiming(LineOfSight);
+        // Cast with the rest of this frame's requests in ProcessRequests()
+        hsRefCnt_SafeRef(requestMsg);
+        fPending.push_back(requestMsg);
         return true;
     }
 
@@ -160,6 +135,77 @@ bool plLOSDispatch::MsgReceive(plMessage* msg)
     return hsKeyedObject::MsgReceive(msg);
 }
 
+void plLOSDispatch::ProcessRequests()
+{
+    if (fPending.empty())
+        return;
+
+    // Hit messages are delivered synchronously, and their receivers may ask
+    // for another LOS test.  Those go into fPending and wait for the next step.
+    std::vector<plLOSRequestMsg*> pending;
+    pending.swap(fPending);
+
+    plProfile_BeginTiming(LineOfSight);
+    plProfile_IncCount(LOSQueries, pending.size());
+
+    // Requests without a world go to whichever subworld the local avatar is in
+    plKey avatarWorld;
+    plArmatureMod* av = plAvatarMgr::GetInstance()->GetLocalAvatar();
+    if (av && av->GetController())
+        avatarWorld = av->GetController()->GetSubworld();
+
+    std::vector<RaycastQuery> queries(pending.size());
+    std::vector<RaycastResult> results(pending.size());
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const plKey& world = pending[i]->fWorldKey ? pending[i]->fWorldKey : avatarWorld;
+        if (!IPrepareRaycast(pending[i], world, queries[i]))
+            queries[i].fScene = nullptr;
+    }
+
+    auto castRange = [this, &queries, &results](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (queries[i].fScene)
+                IRaycast(queries[i], results[i]);
+        }
+    };
+    if (pending.size() >= kMinParallelRequests && hsJobSystem::InstanceValid())
+        hsJobSystem::Instance().ParallelFor(0, pending.size(), kRequestsPerJob, castRange);
+    else
+        castRange(0, pending.size());
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (queries[i].fScene)
+            IFinishRaycast(queries[i], results[i]);
+        ISendResult(pending[i], results[i]);
+        hsRefCnt_SafeUnRef(pending[i]);
+    }
+
+    plProfile_EndTiming(LineOfSight);
+}
+
+void plLOSDispatch::ISendResult(const plLOSRequestMsg* request, const RaycastResult& result)
+{
+    if (result.fResult == LOSResult::kHit &&
+        (request->fReportType == plLOSRequestMsg::kReportHit ||
+         request->fReportType == plLOSRequestMsg::kReportHitOrMiss)) {
+        plLOSHitMsg* hitMsg = new plLOSHitMsg(GetKey(), request->GetSender(), request->fRequestID);
+        hitMsg->fObj = result.fHitObj;
+        hitMsg->fHitPoint = result.fPoint;
+        hitMsg->fNormal = result.fNormal;
+        hitMsg->fDistance = result.fDistance;
+        hitMsg->Send();
+    } else if (result.fResult != LOSResult::kHit &&
+               (request->fReportType == plLOSRequestMsg::kReportMiss ||
+                request->fReportType == plLOSRequestMsg::kReportHitOrMiss)) {
+        plLOSHitMsg* missMsg = new plLOSHitMsg(GetKey(), request->GetSender(), request->fRequestID);
+        missMsg->fNoHit = true;
+        // Don't leak out any internal state, just report a miss.
+        missMsg->Send();
+    }
+
+    fRequests.emplace_back(request->fRequestName, request->fRequestID, result.fResult);
+}
+
 bool plLOSDispatch::ITestHit(const plSceneObject* so) const
 {
     for (size_t i = 0; i < so->GetNumModifiers(); ++i) {
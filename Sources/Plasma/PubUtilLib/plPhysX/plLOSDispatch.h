@@ -45,22 +45,32 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include <vector>
 
 #include "hsGeometry3.h"
+#include "hsMatrix44.h"
 
 #include "pnKeyedObject/hsKeyedObject.h"
 
 #include "plPhysical/plSimDefs.h"
 
 class plLOSRequestMsg;
-struct hsMatrix44;
+class plPXActorData;
 class plSceneObject;
 class plStatusLog;
 
+namespace physx
+{
+    class PxScene;
+};
+
 /** \class plLOSDispatch
     Line-of-sight requests are sent to this guy, who then hands them
     to the appropriate solvers, which can vary depending on such
     criteria as which subworld the player is currently in.
     Eventually we will have more variants of requests, such as 
-    "search all subworlds," etc.  */
+    "search all subworlds," etc.
+
+    Requests are queued as they arrive and cast together once a frame,
+    after the simulation has stepped, so the raycasts can be spread over
+    the job system.  Results still go out in the order requested.  */
 class plLOSDispatch : public hsKeyedObject
 {
 protected:
@@ -89,6 +99,7 @@ private:
 
     plStatusLog* fDebugDisplay;
     std::vector<LOSRequest> fRequests;
+    std::vector<plLOSRequestMsg*> fPending;
 
 public:
     plLOSDispatch();
@@ -99,26 +110,55 @@ public:
 
     bool MsgReceive(plMessage* msg) override;
 
+    /** Casts every request queued since the last call and sends out the
+        results.  Called by the simulation manager once per frame. */
+    void ProcessRequests();
+
 protected:
+    enum
+    {
+        kMinParallelRequests = 16,  // Below this, farming out the casts costs more than it saves
+        kRequestsPerJob = 8,
+    };
+
     bool ITestHit(const plSceneObject* obj) const;
 
+    /** A request converted into the space of the scene it is cast against */
+    struct RaycastQuery
+    {
+        physx::PxScene* fScene;
+        hsPoint3 fOrigin;
+        hsVector3 fDirection;
+        float fMagnitude;
+        hsMatrix44 fL2W;
+        plSimDefs::plLOSDB fDB;
+        plSimDefs::plLOSDB fCullDB;
+        bool fClosest;
+    };
+
     struct RaycastResult
     {
         LOSResult fResult;
+        const plPXActorData* fHitData;  // Filled by the cast, resolved to fHitObj afterwards
         plKey fHitObj;
         hsPoint3 fPoint;
         hsVector3 fNormal;
         float fDistance;
 
-        RaycastResult(LOSResult result, plKey hit = {}, hsPoint3 point = { 0.f, 0.f, 0.f },
-                      hsVector3 normal = { 0.f, 0.f, 0.f }, float dist = 0.f)
-            : fResult(result), fHitObj(std::move(hit)), fPoint(std::move(point)),
-              fNormal(std::move(normal)), fDistance(dist)
+        RaycastResult()
+            : fResult(LOSResult::kMiss), fHitData(), fPoint(0.f, 0.f, 0.f),
+              fNormal(0.f, 0.f, 0.f), fDistance(FLT_MAX)
         { }
     };
 
-    RaycastResult IRaycast(hsPoint3 origin, hsPoint3 destination, const plKey& world, plSimDefs::plLOSDB db,
-                           bool closest, plSimDefs::plLOSDB cullDB = plSimDefs::kLOSDBNone);
+    // Main thread: look up the scene and move the request into its space
+    bool IPrepareRaycast(const plLOSRequestMsg* request, const plKey& world, RaycastQuery& query) const;
+    // Any thread: touches nothing but the PhysX scene and read-only object state
+    void IRaycast(const RaycastQuery& query, RaycastResult& result) const;
+    // Main thread: resolve the hit object and move the hit back into worldspace
+    void IFinishRaycast(const RaycastQuery& query, RaycastResult& result) const;
+
+    void ISendResult(const plLOSRequestMsg* request, const RaycastResult& result);
 };
 
 #endif
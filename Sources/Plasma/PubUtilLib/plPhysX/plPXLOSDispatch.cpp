@@ -54,36 +54,49 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "pnSceneObject/plSceneObject.h"
 #include "pnSceneObject/plSimulationInterface.h"
 
+#include "plMessage/plLOSRequestMsg.h"
+
 // ==========================================================================
 
-plLOSDispatch::RaycastResult plLOSDispatch::IRaycast(hsPoint3 origin, hsPoint3 destination,
-                                                     const plKey& world, plSimDefs::plLOSDB db,
-                                                     bool closest, plSimDefs::plLOSDB cullDB)
+bool plLOSDispatch::IPrepareRaycast(const plLOSRequestMsg* request, const plKey& world,
+                                    RaycastQuery& query) const
 {
-    RaycastResult result(LOSResult::kMiss, nullptr, { 0.f, 0.f, 0.f }, { 0.f, 0.f, 0.f }, FLT_MAX);
-
     plPXSimulation* sim = plSimulationMgr::GetInstance()->GetPhysX();
-    physx::PxScene* scene = sim->FindScene(world);
-    if (!scene)
-        return result;
+    query.fScene = sim->FindScene(world);
+    if (!query.fScene)
+        return false;
+
+    hsPoint3 origin = request->fFrom;
+    hsPoint3 destination = request->fTo;
 
     // The raycast comes in as worldspace, but if the player is in a subworld, we'll need
     // to convert it to subworld space.
-    hsMatrix44 l2w;
-    l2w.Reset();
+    query.fL2W.Reset();
     if (world) {
         if (plSceneObject* so = plSceneObject::ConvertNoRef(world->ObjectIsLoaded())) {
-            l2w = so->GetLocalToWorld();
+            query.fL2W = so->GetLocalToWorld();
             origin = so->GetWorldToLocal() * origin;
             destination = so->GetWorldToLocal() * destination;
         }
     }
 
-    hsVector3 direction = hsVector3(destination - origin);
-    float magnitude = direction.Magnitude();
-    if (magnitude <= 0.f)
-        return result;
-    direction.Normalize();
+    query.fDirection = hsVector3(destination - origin);
+    query.fMagnitude = query.fDirection.Magnitude();
+    if (query.fMagnitude <= 0.f)
+        return false;
+    query.fDirection.Normalize();
+
+    query.fOrigin = origin;
+    query.fDB = request->fRequestType;
+    query.fCullDB = request->fCullDB;
+    query.fClosest = request->fTestType == plLOSRequestMsg::kTestClosest;
+    return true;
+}
+
+void plLOSDispatch::IRaycast(const RaycastQuery& query, RaycastResult& result) const
+{
+    plSimDefs::plLOSDB db = query.fDB;
+    plSimDefs::plLOSDB cullDB = query.fCullDB;
 
     plPXFilterData data;
     data.SetLOSDBs((plSimDefs::plLOSDB)((physx::PxU32)db | (physx::PxU32)cullDB));
@@ -91,16 +104,16 @@ plLOSDispatch::RaycastResult plLOSDispatch::IRaycast(hsPoint3 origin, hsPoint3 d
                                           physx::PxQueryFlag::eDYNAMIC |
                                           physx::PxQueryFlag::ePREFILTER |
                                           physx::PxQueryFlag::ePOSTFILTER);
-    if (!closest)
+    if (!query.fClosest)
         filter.flags |= physx::PxQueryFlag::eANY_HIT;
 
     class plPXRaycastQueryFilter : public physx::PxQueryFilterCallback
     {
-        plLOSDispatch* fDispatch;
+        const plLOSDispatch* fDispatch;
         plSimDefs::plLOSDB fCullDB;
 
     public:
-        plPXRaycastQueryFilter(plLOSDispatch* self, plSimDefs::plLOSDB cullDB)
+        plPXRaycastQueryFilter(const plLOSDispatch* self, plSimDefs::plLOSDB cullDB)
             : fDispatch(self), fCullDB(cullDB)
         { }
 
@@ -159,9 +172,8 @@ plLOSDispatch::RaycastResult plLOSDispatch::IRaycast(hsPoint3 origin, hsPoint3 d
             for (physx::PxU32 i = 0; i < nbHits; ++i) {
                 const physx::PxRaycastHit& hit = hits[i];
                 if (hit.distance < fResult.fDistance && hit.distance != 0.f) {
-                    auto data = static_cast<plPXActorData*>(hit.actor->userData);
                     fResult.fResult = LOSResult::kHit;
-                    fResult.fHitObj = data->GetKey();
+                    fResult.fHitData = static_cast<const plPXActorData*>(hit.actor->userData);
                     fResult.fPoint = plPXConvert::Point(hit.position);
                     fResult.fNormal = plPXConvert::Vector(hit.normal);
                     fResult.fDistance = hit.distance;
@@ -187,9 +199,8 @@ plLOSDispatch::RaycastResult plLOSDispatch::IRaycast(hsPoint3 origin, hsPoint3 d
             }
 
             if (block.distance < fResult.fDistance && block.distance != 0.f) {
-                auto data = static_cast<plPXActorData*>(block.actor->userData);
                 fResult.fResult = LOSResult::kHit;
-                fResult.fHitObj = data->GetKey();
+                fResult.fHitData = static_cast<const plPXActorData*>(block.actor->userData);
                 fResult.fPoint = plPXConvert::Point(block.position);
                 fResult.fNormal = plPXConvert::Vector(block.normal);
                 fResult.fDistance = block.distance;
@@ -197,16 +208,21 @@ plLOSDispatch::RaycastResult plLOSDispatch::IRaycast(hsPoint3 origin, hsPoint3 d
         }
     } raycast(result, cullDB);
 
-    bool hit = scene->raycast(plPXConvert::Point(origin),
-                              plPXConvert::Vector(direction),
-                              magnitude, raycast,
-                              (physx::PxHitFlag::ePOSITION | physx::PxHitFlag::eNORMAL),
-                              filter, &filterCallback);
+    query.fScene->raycast(plPXConvert::Point(query.fOrigin),
+                          plPXConvert::Vector(query.fDirection),
+                          query.fMagnitude, raycast,
+                          (physx::PxHitFlag::ePOSITION | physx::PxHitFlag::eNORMAL),
+                          filter, &filterCallback);
+}
+
+void plLOSDispatch::IFinishRaycast(const RaycastQuery& query, RaycastResult& result) const
+{
+    if (result.fResult != LOSResult::kHit)
+        return;
+
+    result.fHitObj = result.fHitData->GetKey();
 
     // Convert back to worldspace
-    if (hit) {
-        result.fPoint = l2w * result.fPoint;
-        result.fNormal = l2w * result.fNormal;
-    }
-    return result;
+    result.fPoint = query.fL2W * result.fPoint;
+    result.fNormal = query.fL2W * result.fNormal;
 }
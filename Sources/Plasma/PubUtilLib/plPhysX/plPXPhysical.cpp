@@ -70,6 +70,8 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
  *          be simulating when they are used. While this does make sense from some perspectives,
  *          (why are you changing the velocity of a disabled actor, moron?), in our event-driven
  *          architecture, we would like to handle these kinds of things immediately.
+ *          For the same reason, this waits for an overlapped step to finish, so the change
+ *          goes into the next step instead of being held back until the one after.
  */
 class plPXActorSimulationLock
 {
@@ -85,6 +87,7 @@ public:
         : fActor(actor),
           fDisabled(actor->getActorFlags().isSet(physx::PxActorFlag::eDISABLE_SIMULATION))
     {
+        plSimulationMgr::GetInstance()->GetPhysX()->WaitForStep();
         if (fDisabled)
             actor->setActorFlag(physx::PxActorFlag::eDISABLE_SIMULATION, false);
     }
@@ -257,6 +257,7 @@ void plPXPhysicalControllerCore::SetGlobalLoc(const hsMatrix44& l2w)
 
     physx::PxTransform globalPose(plPXConvert::Point(IGetCapsulePos(fLocalPosition)),
                                   physx::PxIdentity);
+    plSimulationMgr::GetInstance()->GetPhysX()->WaitForStep();
     fActor->setGlobalPose(globalPose);
 }
 
@@ -269,6 +270,7 @@ void plPXPhysicalControllerCore::SetPositionSim(const hsPoint3& pos)
 {
     physx::PxTransform globalPose(plPXConvert::Point(IGetCapsulePos(pos)),
                                   physx::PxIdentity);
+    plSimulationMgr::GetInstance()->GetPhysX()->WaitForStep();
     fActor->setGlobalPose(globalPose);
 }
 
@@ -48,6 +48,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plPXSubWorld.h"
 #include "plSimulationMgr.h"
 
+#include "hsJobSystem.h"
 #include "plProfile.h"
 
 #include "pnNetCommon/plNetApp.h"
@@ -145,6 +146,48 @@ public:
 
 // ==========================================================================
 
+/**
+ * Hands PhysX tasks to the shared job system.
+ * Until a step asks for the job system, tasks run inline on the submitting thread, the same
+ * as a PxDefaultCpuDispatcher with no workers. Uru scenes are mostly static geometry, so
+ * farming out a single blocking step costs more in synchronization than it gains. It only
+ * pays off when the main thread has other work to do while the scenes step.
+ */
+class plPXJobDispatcher : public physx::PxCpuDispatcher
+{
+    bool fUseJobs;
+
+public:
+    plPXJobDispatcher() : fUseJobs() { }
+
+    void SetUseJobs(bool useJobs)
+    {
+        // Nobody would pick up the tasks while the main thread waits in fetchResults()
+        fUseJobs = useJobs && hsJobSystem::InstanceValid() && hsJobSystem::Instance().GetNumWorkers() > 0;
+    }
+
+    void submitTask(physx::PxBaseTask& task) override
+    {
+        if (fUseJobs) {
+            physx::PxBaseTask* pTask = &task;
+            hsJobSystem::Instance().Submit([pTask]() {
+                pTask->run();
+                pTask->release();
+            });
+        } else {
+            task.run();
+            task.release();
+        }
+    }
+
+    uint32_t getWorkerCount() const override
+    {
+        return fUseJobs ? (uint32_t)hsJobSystem::Instance().GetNumWorkers() : 0;
+    }
+};
+
+// ==========================================================================
+
 class plPXSimulationEventHandler : public physx::PxSimulationEventCallback
 {
     void IHandleControllerContacts(const physx::PxContactPair& pair) const
@@ -330,12 +373,14 @@ static physx::PxFilterFlags ISimulationFilterShader(physx::PxFilterObjectAttribu
 
 plPXSimulation::plPXSimulation()
     : fPxFoundation(), fDebugger(), fTransport(), fPxPhysics(), fPxCooking(),
-      fPxCpuDispatcher(), fAccumulator()
+      fPxCpuDispatcher(), fAccumulator(), fStepping(), fPendingSubSteps()
 {
 }
 
 plPXSimulation::~plPXSimulation()
 {
+    IFetchResults();
+
     // This should only run for the empty main world.
     for (const auto& world : fWorlds)
         world.second->release();
@@ -343,8 +388,7 @@ plPXSimulation::~plPXSimulation()
 
     if (fPxCooking)
         fPxCooking->release();
-    if (fPxCpuDispatcher)
-        fPxCpuDispatcher->release();
+    delete fPxCpuDispatcher;
     if (fPxPhysics)
         fPxPhysics->release();
     PxCloseExtensions();
@@ -401,14 +445,8 @@ bool plPXSimulation::Init()
         return false;
     }
 
-    // Worker threads actually slow down our simulation - probably because Uru scenes are mostly
-    // composed of static geometry, so the thread synchronization adds more overhead than the
-    // threads help.
-    fPxCpuDispatcher = physx::PxDefaultCpuDispatcherCreate(0);
-    if (!fPxCpuDispatcher) {
-        plStatusLog::AddLineS("Simulation.log", plStatusLog::kRed, "PhysX CPU Dispatcher failed to initialize!");
-        return false;
-    }
+    // Runs inline unless the step is overlapped with the rest of the frame, see plPXJobDispatcher
+    fPxCpuDispatcher = new plPXJobDispatcher();
 
     physx::PxCookingParams params(scale);
     // disable mesh cleaning - perform mesh validation on development configurations
@@ -649,6 +687,8 @@ physx::PxMaterial* plPXSimulation::InitMaterial(float uStatic, float uDynamic, f
 
 void plPXSimulation::AddToWorld(physx::PxActor* actor, const plKey& world)
 {
+    IFetchResults();
+
     actor->setName(static_cast<plPXActorData*>(actor->userData)->c_str());
     if (physx::PxScene* scene = actor->getScene()) {
         scene->removeActor(*actor);
@@ -676,6 +716,8 @@ physx::PxScene* plPXSimulation::FindScene(const plKey& world)
 
 void plPXSimulation::RemoveFromWorld(physx::PxRigidActor* actor)
 {
+    IFetchResults();
+
     physx::PxScene* scene = actor->getScene();
     hsAssert(scene, "actor not in a scene");
 
@@ -690,6 +732,14 @@ void plPXSimulation::RemoveFromWorld(physx::PxRigidActor* actor)
 
 bool plPXSimulation::Advance(float delta)
 {
+    BeginAdvance(delta, false);
+    return EndAdvance();
+}
+
+void plPXSimulation::BeginAdvance(float delta, bool async)
+{
+    hsAssert(!fStepping && fPendingSubSteps == 0, "Previous step was never finished");
+
     fAccumulator += delta;
     if (fAccumulator < kDefaultStepSize) {
         // Not enough time has passed to perform a physics substep, but we need to propagate
@@ -697,7 +747,7 @@ bool plPXSimulation::Advance(float delta)
         plProfile_BeginTiming(CorrectController);
         plPXPhysicalControllerCore::UpdateNonPhysical(fAccumulator / kDefaultStepSize);
         plProfile_EndTiming(CorrectController);
-        return false;
+        return;
     } else if (fAccumulator > kDefaultMaxDelta) {
         fAccumulator = kDefaultMaxDelta;
     }
@@ -711,14 +761,30 @@ bool plPXSimulation::Advance(float delta)
     // motion of the avatar needs to take into account things like friction from the ground
     // and gravity. So, avatars have to be handled in three stages. We first apply the animation.
     // Then, we run the simulation with the velocities determined from the animations. Finally,
-    // the results of the simulation are sent out as corrections.
+    // the results of the simulation are sent out as corrections in EndAdvance().
     plProfile_BeginTiming(ApplyController);
     plPXPhysicalControllerCore::Apply(delta);
     plProfile_EndTiming(ApplyController);
 
+    // Start every scene before waiting on any, so subworlds step side by side.
     plProfile_BeginTiming(Step);
-    for (auto& it : fWorlds) {
+    fPxCpuDispatcher->SetUseJobs(async);
+    for (auto& it : fWorlds)
         it.second->simulate(delta);
+    plProfile_EndTiming(Step);
+
+    fStepping = true;
+    fPendingSubSteps = numSubSteps;
+}
+
+void plPXSimulation::IFetchResults()
+{
+    if (!fStepping)
+        return;
+    fStepping = false;
+
+    plProfile_BeginTiming(Step);
+    for (auto& it : fWorlds) {
         it.second->fetchResults(true);
 
         physx::PxSimulationStatistics stats;
@@ -731,12 +797,21 @@ bool plPXSimulation::Advance(float delta)
         plProfile_IncCount(Kinematics, stats.nbKinematicBodies);
         plProfile_IncCount(Statics, stats.nbStaticBodies);
     }
+    fPxCpuDispatcher->SetUseJobs(false);
     plProfile_EndTiming(Step);
+}
+
+bool plPXSimulation::EndAdvance()
+{
+    IFetchResults();
+    if (fPendingSubSteps == 0)
+        return false;
 
     // Propagate the simulated controller movement to the SceneObjects for rendering purposes.
     plProfile_BeginTiming(CorrectController);
-    plPXPhysicalControllerCore::Update(numSubSteps, fAccumulator / kDefaultStepSize);
+    plPXPhysicalControllerCore::Update(fPendingSubSteps, fAccumulator / kDefaultStepSize);
     plProfile_EndTiming(CorrectController);
 
+    fPendingSubSteps = 0;
     return true;
 }
@@ -53,6 +53,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 class hsKeyedObject;
 struct hsPoint3;
 class plPXFilterData;
+class plPXJobDispatcher;
 class plPXPhysical;
 class plPXPhysicalControllerCore;
 class hsQuat;
@@ -65,7 +66,6 @@ namespace physx
     class PxController;
     class PxControllerDesc;
     class PxControllerManager;
-    class PxDefaultCpuDispatcher;
     class PxFoundation;
     class PxGeometry;
     class PxMaterial;
@@ -109,9 +109,10 @@ public:
     plPXActorData(plPXPhysical* physical);
     plPXActorData(plPXPhysicalControllerCore* controller);
 
-    /** Gets the key of the owner object. */
+    /** Gets the key of the owner object.
+        Returned by reference so scene queries on worker threads don't touch the ref count. */
     [[nodiscard]]
-    plKey GetKey() const { return fKey; }
+    const plKey& GetKey() const { return fKey; }
 
     [[nodiscard]]
     plPXPhysical* GetPhysical() const { return fPhysical; }
@@ -133,13 +134,19 @@ protected:
     physx::PxPvdTransport* fTransport;
     physx::PxPhysics* fPxPhysics;
     physx::PxCooking* fPxCooking;
-    physx::PxDefaultCpuDispatcher* fPxCpuDispatcher;
+    plPXJobDispatcher* fPxCpuDispatcher;
     std::map<plKey, physx::PxScene*> fWorlds;
     float fAccumulator;
 
+    bool fStepping;         // simulate() has been called, but not fetchResults()
+    int fPendingSubSteps;   // substeps whose results haven't been handed to the controllers
+
 protected:
     bool IConnectDebugger(physx::PxPvdTransport* transport);
 
+    /** Waits for any step in flight, so the scenes may be modified or queried. */
+    void IFetchResults();
+
 public:
     plPXSimulation();
     plPXSimulation(const plPXSimulation&) = delete;
@@ -226,6 +233,25 @@ public:
 
     /** Advances the simulation. */
     bool Advance(float delta);
+
+    /**
+     * Starts advancing the simulation.
+     * The controllers are applied and every scene starts stepping. With \a async, the scenes
+     * step concurrently on the job system and this returns immediately; the step must then
+     * be finished with \sa EndAdvance() before the next one. Anything that adds, removes or
+     * moves actors in the meantime must \sa WaitForStep() first, or PhysX would hold the
+     * change back until the step after.
+     */
+    void BeginAdvance(float delta, bool async);
+
+    /**
+     * Finishes a step started by \sa BeginAdvance() and corrects the controllers.
+     * \returns whether the simulation actually advanced.
+     */
+    bool EndAdvance();
+
+    /** Waits for any step in flight, so the scenes may be modified. */
+    void WaitForStep() { IFetchResults(); }
 };
 
 #endif
@@ -82,6 +82,7 @@ plProfile_CreateCounter("SetTransforms Accepted", "Simulation", SetTransforms);
 // declared at file scope so that both GetInstance and the destructor can access it.
 static plSimulationMgr* gTheInstance;
 bool plSimulationMgr::fExtraProfile = false;
+bool plSimulationMgr::fOverlapStep = false;
 
 void plSimulationMgr::Init()
 {
@@ -111,6 +112,7 @@ plSimulationMgr* plSimulationMgr::GetInstance()
 plSimulationMgr::plSimulationMgr()
     : fSimulation(std::make_unique<plPXSimulation>()),
       fSuspended(true),
+      fStepBegun(false),
       fLOSDispatch(new plLOSDispatch()),
       fSoundMgr(new plPhysicsSoundMgr),
       fLog()
@@ -211,12 +213,44 @@ void plSimulationMgr::ResetKickables()
 
 void plSimulationMgr::Advance(float delSecs)
 {
-    if (fSuspended)
+    // In case overlapping was just turned off, or nobody called EndAdvance()
+    EndAdvance();
+
+    if (fSuspended) {
+        fLOSDispatch->ProcessRequests();
+        return;
+    }
+
+    if (fOverlapStep) {
+        // This frame's animation has been applied, so the step sees every kinematic
+        // and SetTransform change made so far.  Cast the line of sight requests first,
+        // while the scene is still settled.
+        fLOSDispatch->ProcessRequests();
+        fSimulation->BeginAdvance(delSecs, true);
+        fStepBegun = true;
+        return;
+    }
+
+    IStepFinished(fSimulation->Advance(delSecs));
+
+    // Cast this frame's line of sight requests against the settled scene
+    fLOSDispatch->ProcessRequests();
+}
+
+void plSimulationMgr::EndAdvance()
+{
+    if (!fStepBegun)
         return;
+    fStepBegun = false;
 
+    IStepFinished(fSimulation->EndAdvance());
+}
+
+void plSimulationMgr::IStepFinished(bool advanced)
+{
     // Only pump the sounds if the simulation actually advanced. Otherwise we get fascinating
     // (read: bad) sounds stopping/starting when the fps is greater than the simulation frequency.
-    if (fSimulation->Advance(delSecs))
+    if (advanced)
         fSoundMgr->Update();
 
     plProfile_BeginTiming(ProcessSyncs);
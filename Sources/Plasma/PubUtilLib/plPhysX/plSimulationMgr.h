@@ -79,11 +79,19 @@ public:
 
     static bool fExtraProfile;
 
+    // Let the physics step run alongside rendering, from Advance() to the next frame's EndAdvance()
+    static bool fOverlapStep;
+
     bool MsgReceive(plMessage* msg) override;
 
-    // Advance the simulation by the given number of seconds
+    // Advance the simulation by the given number of seconds. With fOverlapStep, this
+    // only starts the step, and EndAdvance() picks up the results.
     void Advance(float delSecs);
 
+    // Finish a step that Advance() left running and send out its results. Call this
+    // before anything gets a chance to move the physicals again.
+    void EndAdvance();
+
     // The simulation won't run at all if it is suspended
     void Suspend() { fSuspended = true; }
     void Resume() { fSuspended = false; }
@@ -107,6 +115,9 @@ public:
     void ResetKickables();
 
 protected:
+    // Sounds, syncs and location updates for a finished step
+    void IStepFinished(bool advanced);
+
     void ISendUpdates();
 
     // Walk through the synchronization requests and send them as appropriate.
@@ -128,6 +139,9 @@ protected:
     // but nothing will move.
     bool fSuspended;
 
+    // Has Advance started a step that EndAdvance has yet to finish?
+    bool fStepBegun;
+
     // A utility class to keep track of a request for a physical synchronization.
     // These requests must pass a certain criteria (see the code for the latest)
     // before they are actually either sent over the network or rejected.
@@ -99,6 +99,9 @@ public:
     //virtual int GetMaxAnisotropicSamples() = 0;
     //virtual int GetMaxAntiAlias(int Width, int Height, int ColorDepth) = 0;
     //virtual void ResetDisplayDevice(int Width, int Height, int ColorDepth, bool Windowed, int NumAASamples, int MaxAnisotropicSamples, bool vSync = false  ) = 0;
+
+protected:
+    //virtual uint8_t* ISkinDestination(hsGDeviceRef* vRef, uint32_t& stride) = 0;
 };
 
 #endif // _plGLPipeline_inc_
@@ -42,8 +42,11 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "pl3DPipeline.h"
 
+#include <algorithm>
+
 #include "hsGDeviceRef.h"
 #include "hsGMatState.inl"
+#include "plCPUSkinning.h"
 #include "plPipeDebugFlags.h"
 #include "plProfile.h"
 #include "plTweak.h"
@@ -55,6 +58,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "pnSceneObject/plSceneObject.h"
 
 #include "plDrawable/plDrawableSpans.h"
+#include "plDrawable/plGBufferGroup.h"
 #include "plDrawable/plSpaceTree.h"
 #include "plDrawable/plSpanTypes.h"
 #include "plGLight/plLightInfo.h"
@@ -80,12 +84,15 @@ plProfile_CreateTimer("      ApplyMoving",      "PipeT", ApplyMoving);
 plProfile_CreateTimer("      ApplyToSpec",      "PipeT", ApplyToSpec);
 plProfile_CreateTimer("      ApplyToMoving",    "PipeT", ApplyToMoving);
 
+plProfile_CreateTimer("Skin",                   "PipeT", Skin);
+
 plProfile_CreateCounter("LightOn",              "PipeC", LightOn);
 plProfile_CreateCounter("LightVis",             "PipeC", LightVis);
 plProfile_CreateCounter("LightChar",            "PipeC", LightChar);
 plProfile_CreateCounter("LightActive",          "PipeC", LightActive);
 plProfile_CreateCounter("Lights Found",         "PipeC", FindLightsFound);
 plProfile_CreateCounter("Perms Found",          "PipeC", FindLightsPerm);
+plProfile_CreateCounter("NumSkin",              "PipeC", NumSkin);
 
 
 PipelineParams plPipeline::fDefaultPipeParams;
@@ -953,6 +960,112 @@ void pl3DPipeline::ICheckLighting(plDrawableSpans* drawable, std::vector<int16_t
 }
 
 
+bool pl3DPipeline::ISoftwareVertexBlend(plDrawableSpans* drawable, const std::vector<int16_t>& visList)
+{
+    if (IsDebugFlagSet(plPipeDbg::kFlagNoSkinning))
+        return true;
+
+    if (drawable->GetSkinTime() == fRenderCnt)
+        return true;
+
+    const hsBitVector& blendBits = drawable->GetBlendingSpanVector();
+
+    if (drawable->GetBlendingSpanVector().Empty()) {
+        // This sucker doesn't have any skinning spans anyway. Just return
+        drawable->SetSkinTime(fRenderCnt);
+        return true;
+    }
+
+    plProfile_BeginTiming(Skin);
+
+    // First, figure out which buffers we need to blend.
+    constexpr size_t kMaxBufferGroups = 20;
+    constexpr size_t kMaxVertexBuffers = 20;
+    static char blendBuffers[kMaxBufferGroups][kMaxVertexBuffers];
+    memset(blendBuffers, 0, kMaxBufferGroups * kMaxVertexBuffers * sizeof(**blendBuffers));
+
+    hsAssert(kMaxBufferGroups >= drawable->GetNumBufferGroups(), "Bigger than we counted on num groups skin.");
+
+    const std::vector<plSpan*>& spans = drawable->GetSpanArray();
+    for (int16_t idx : visList) {
+        if (blendBits.IsBitSet(idx)) {
+            const plVertexSpan& vSpan = *(plVertexSpan*)spans[idx];
+            hsAssert(kMaxVertexBuffers > vSpan.fVBufferIdx, "Bigger than we counted on num buffers skin.");
+
+            blendBuffers[vSpan.fGroupIdx][vSpan.fVBufferIdx] = 1;
+            drawable->SetBlendingSpanVectorBit(idx, false);
+        }
+    }
+
+    // Now go through each of the group/buffer (= a real vertex buffer) pairs we found,
+    // and queue up a blend for each span that uses it. Spans can share a matrix
+    // palette in the drawable while each wants its own local to world in slot 0,
+    // so every job gets a copy of its span's palette to blend with later.
+    static std::vector<plCPUSkinning::Job> jobs;
+    static std::vector<hsMatrix44> palettes;
+    static std::vector<size_t> paletteStarts;
+    jobs.clear();
+    palettes.clear();
+    paletteStarts.clear();
+
+    for (size_t i = 0; i < kMaxBufferGroups; i++) {
+        for (size_t j = 0; j < kMaxVertexBuffers; j++) {
+            if (!blendBuffers[i][j])
+                continue;
+
+            hsGDeviceRef* vRef = drawable->GetVertexRef(i, uint32_t(j));
+            uint32_t destStride;
+            uint8_t* destPtr = ISkinDestination(vRef, destStride);
+            hsAssert(destPtr, "Going into skinning with no place to put results!");
+            if (!destPtr)
+                continue;
+
+            plGBufferGroup* group = drawable->GetBufferGroup(i);
+            const uint8_t* srcPtr = group->GetVertBufferData(uint32_t(j));
+
+            for (int16_t idx : visList) {
+                const plIcicle& span = *(plIcicle*)spans[idx];
+                if ((span.fGroupIdx == i) && (span.fVBufferIdx == j)) {
+                    plProfile_Inc(NumSkin);
+
+                    const hsMatrix44* matrixPalette = drawable->GetMatrixPalette(span.fBaseMatrix);
+                    paletteStarts.push_back(palettes.size());
+                    palettes.push_back(span.fLocalToWorld);
+                    palettes.insert(palettes.end(), matrixPalette + 1, matrixPalette + std::max(span.fNumMatrices, 1U));
+
+                    plCPUSkinning::Job job;
+                    job.fPalette = nullptr;     // set once every palette is copied
+                    job.fSrc = srcPtr + span.fVStartIdx * group->GetVertexSize();
+                    job.fFormat = group->GetVertexFormat();
+                    job.fSrcStride = group->GetVertexSize();
+                    job.fDest = destPtr + span.fVStartIdx * destStride;
+                    job.fDestStride = destStride;
+                    job.fCount = span.fVLength;
+                    job.fLocalUVWChans = span.fLocalUVWChans;
+                    jobs.push_back(job);
+
+                    vRef->SetDirty(true);
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < jobs.size(); i++)
+        jobs[i].fPalette = &palettes[paletteStarts[i]];
+    plCPUSkinning::BlendJobs(jobs);
+
+    plProfile_EndTiming(Skin);
+
+    if (drawable->GetBlendingSpanVector().Empty()) {
+        // Only do this if we've blended ALL of the spans. Thus, this becomes a trivial
+        // rejection for all the skinning flags being cleared
+        drawable->SetSkinTime(fRenderCnt);
+    }
+
+    return true;
+}
+
+
 hsMatrix44 pl3DPipeline::IGetCameraToNDC()
 {
     hsMatrix44 cam2ndc = GetViewTransform().GetCameraToNDC();
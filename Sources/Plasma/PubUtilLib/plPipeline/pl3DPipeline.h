@@ -735,6 +735,25 @@ protected:
     void ICheckLighting(plDrawableSpans* drawable, std::vector<int16_t>& visList, plVisMgr* visMgr);
 
 
+    /**
+     * Emulate matrix palette operations in software.
+     *
+     * The big difference between the hardware and software versions is we
+     * only want to lock the vertex buffer once and blend all the verts we're
+     * going to in software, so the vertex blend happens once for an entire
+     * drawable. The blends themselves go through plCPUSkinning, spread
+     * across the job system.
+     */
+    bool ISoftwareVertexBlend(plDrawableSpans* drawable, const std::vector<int16_t>& visList);
+
+
+    /**
+     * Where ISoftwareVertexBlend should write the blended verts for this
+     * vertex buffer ref, and the stride between them.
+     */
+    virtual uint8_t* ISkinDestination(hsGDeviceRef* vRef, uint32_t& stride) = 0;
+
+
     /**
      * Get the camera to NDC transform.
      *
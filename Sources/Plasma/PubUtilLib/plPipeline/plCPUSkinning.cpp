@@ -0,0 +1,126 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plCPUSkinning.h"
+#include "plCPUSkinning_Private.h"
+#include "plCPUSkinningKernel.h"
+
+#include "hsJobSystem.h"
+
+static inline void ISkinVertexFPU(const hsMatrix44& xfm, float wgt, const float* src, float* dst)
+{
+    const float& m00 = xfm.fMap[0][0];
+    const float& m01 = xfm.fMap[0][1];
+    const float& m02 = xfm.fMap[0][2];
+    const float& m03 = xfm.fMap[0][3];
+    const float& m10 = xfm.fMap[1][0];
+    const float& m11 = xfm.fMap[1][1];
+    const float& m12 = xfm.fMap[1][2];
+    const float& m13 = xfm.fMap[1][3];
+    const float& m20 = xfm.fMap[2][0];
+    const float& m21 = xfm.fMap[2][1];
+    const float& m22 = xfm.fMap[2][2];
+    const float& m23 = xfm.fMap[2][3];
+
+    // position
+    {
+        const float& srcX = src[0];
+        const float& srcY = src[1];
+        const float& srcZ = src[2];
+
+        dst[0] += (srcX * m00 + srcY * m01 + srcZ * m02 + m03) * wgt;
+        dst[1] += (srcX * m10 + srcY * m11 + srcZ * m12 + m13) * wgt;
+        dst[2] += (srcX * m20 + srcY * m21 + srcZ * m22 + m23) * wgt;
+    }
+
+    // normal
+    {
+        const float& srcX = src[4];
+        const float& srcY = src[5];
+        const float& srcZ = src[6];
+
+        dst[4] += (srcX * m00 + srcY * m01 + srcZ * m02) * wgt;
+        dst[5] += (srcX * m10 + srcY * m11 + srcZ * m12) * wgt;
+        dst[6] += (srcX * m20 + srcY * m21 + srcZ * m22) * wgt;
+    }
+}
+
+void plCPUSkinningKernels::blend_verts_fpu(const hsMatrix44* palette, const uint8_t* src, uint8_t format,
+                                           uint32_t srcStride, uint8_t* dest, uint32_t destStride,
+                                           uint32_t count, uint16_t localUVWChans)
+{
+    IBlendVertLoop<ISkinVertexFPU>(palette, src, format, srcStride, dest, destStride, count, localUVWChans);
+}
+
+void plCPUSkinning::BlendVerts(const hsMatrix44* palette, const uint8_t* src, uint8_t format,
+                               uint32_t srcStride, uint8_t* dest, uint32_t destStride,
+                               uint32_t count, uint16_t localUVWChans)
+{
+    plCPUSkinningKernels::blend_verts.call(palette, src, format, srcStride, dest, destStride, count, localUVWChans);
+}
+
+void plCPUSkinning::BlendJobs(const std::vector<Job>& jobs)
+{
+    auto blendRange = [&jobs](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            BlendVerts(jobs[i]);
+    };
+
+    // Spans are the unit of work; they never share dest verts, so no locking
+    if (jobs.size() > 1 && hsJobSystem::InstanceValid())
+        hsJobSystem::Instance().ParallelFor(0, jobs.size(), 1, blendRange);
+    else
+        blendRange(0, jobs.size());
+}
+
+// CPU-optimized functions requiring dispatch
+hsCpuFunctionDispatcher<plCPUSkinningKernels::blend_verts_ptr> plCPUSkinningKernels::blend_verts {
+    &plCPUSkinningKernels::blend_verts_fpu,
+    nullptr,                                // SSE1
+    nullptr,                                // SSE2
+    &plCPUSkinningKernels::blend_verts_sse3,
+    nullptr,                                // SSSE3
+    &plCPUSkinningKernels::blend_verts_sse41,
+    nullptr,                                // SSE42
+    &plCPUSkinningKernels::blend_verts_avx,
+    nullptr                                 // AVX2 (the AVX kernel has no integer work to gain from it)
+};
@@ -0,0 +1,91 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#ifndef _plCPUSkinning_h_
+#define _plCPUSkinning_h_
+
+#include "HeadSpin.h"
+
+#include <vector>
+
+struct hsMatrix44;
+
+//// plCPUSkinning ////////////////////////////////////////////////////////////
+//  Software vertex blending, independent of any particular pipeline. Source
+//  verts are in the plGBufferGroup skinned format (position, weights, optional
+//  packed indices, normal, colors, UVWs); the destination gets the same verts
+//  with the blending info stripped out. The per-vertex kernel is picked at
+//  startup from the best instruction set the CPU has.
+
+class plCPUSkinning
+{
+public:
+    // One span's worth of verts to blend. The palette must stay valid until
+    // the blend is done, and no two jobs may write the same dest verts.
+    struct Job
+    {
+        const hsMatrix44*   fPalette;
+        const uint8_t*      fSrc;
+        uint8_t*            fDest;
+        uint32_t            fSrcStride;
+        uint32_t            fDestStride;
+        uint32_t            fCount;
+        uint16_t            fLocalUVWChans;
+        uint8_t             fFormat;
+    };
+
+    static void BlendVerts(const hsMatrix44* palette, const uint8_t* src, uint8_t format,
+                           uint32_t srcStride, uint8_t* dest, uint32_t destStride,
+                           uint32_t count, uint16_t localUVWChans);
+
+    static void BlendVerts(const Job& job)
+    {
+        BlendVerts(job.fPalette, job.fSrc, job.fFormat, job.fSrcStride,
+                   job.fDest, job.fDestStride, job.fCount, job.fLocalUVWChans);
+    }
+
+    // Blends every job, spread across the shared job system when it's
+    // running and there's more than one job to hand out.
+    static void BlendJobs(const std::vector<Job>& jobs);
+};
+
+#endif // _plCPUSkinning_h_
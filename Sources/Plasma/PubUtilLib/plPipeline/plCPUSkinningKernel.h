@@ -0,0 +1,115 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#ifndef _plCPUSkinningKernel_h_
+#define _plCPUSkinningKernel_h_
+
+// Shared vertex loop for the plCPUSkinning kernels. Only included by the
+// plCPUSkinning translation units, each of which instantiates it with its
+// own per-vertex kernel so the kernel gets inlined into the loop.
+
+#include "HeadSpin.h"
+#include "hsMatrix44.h"
+
+#include "plDrawable/plGBufferGroup.h"
+
+#include <cstring>
+
+// Blends one weighted bone into the accumulator. Both src and dst are eight
+// floats: the position (x, y, z, 1) followed by the normal (x, y, z, 0).
+typedef void(*skin_vert_ptr)(const hsMatrix44& xfm, float wgt, const float* src, float* dst);
+
+template<skin_vert_ptr T>
+static inline void IBlendVertLoop(const hsMatrix44* matrixPalette, const uint8_t* src,
+                                  uint8_t format, uint32_t srcStride, uint8_t* dest,
+                                  uint32_t destStride, uint32_t count, uint16_t localUVWChans)
+{
+    ALIGN(32) float srcBuf[8] = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f };
+    float weights[4];
+    uint32_t indices;
+
+    // Dropped support for localUVWChans at templatization of code
+    hsAssert(localUVWChans == 0, "support for skinned UVWs dropped. reimplement me?");
+    const uint8_t numWeights = (format & plGBufferGroup::kSkinWeightMask) >> 4;
+    const bool hasIndices = (format & plGBufferGroup::kSkinIndices) != 0;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint8_t* s = src;
+        memcpy(srcBuf, s, sizeof(float) * 3);
+        s += sizeof(float) * 3;
+
+        float weightSum = 0.f;
+        for (uint8_t j = 0; j < numWeights; ++j) {
+            memcpy(&weights[j], s, sizeof(float));
+            s += sizeof(float);
+            weightSum += weights[j];
+        }
+        weights[numWeights] = 1.f - weightSum;
+
+        if (hasIndices) {
+            memcpy(&indices, s, sizeof(uint32_t));
+            s += sizeof(uint32_t);
+        } else {
+            indices = 1 << 8;
+        }
+        memcpy(srcBuf + 4, s, sizeof(float) * 3);
+
+        ALIGN(32) float dstBuf[8] = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f };
+        for (uint32_t j = 0; j < numWeights + 1u; ++j) {
+            if (weights[j])
+                T(matrixPalette[indices & 0xFF], weights[j], srcBuf, dstBuf);
+            indices >>= 8;
+        }
+        // Probably don't really need to renormalize the normal. The errors
+        // are going to be subtle and "smooth".
+
+        memcpy(dest, dstBuf, sizeof(float) * 3);
+        memcpy(dest + sizeof(float) * 3, dstBuf + 4, sizeof(float) * 3);
+
+        // Colors and UVWs were filled in when the dest buffer was created,
+        // so skip straight to the next vert.
+        src += srcStride;
+        dest += destStride;
+    }
+}
+
+#endif // _plCPUSkinningKernel_h_
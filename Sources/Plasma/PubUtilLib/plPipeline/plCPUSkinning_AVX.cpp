@@ -0,0 +1,80 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include "plCPUSkinning_Private.h"
+#include "plCPUSkinningKernel.h"
+
+#ifdef HAVE_AVX
+#   include <immintrin.h>
+
+// Position and normal share one 256-bit register, one per lane. Each matrix
+// row is broadcast to both lanes, so a single dot product per row covers both;
+// the normal's w of 0 drops the translation out of its lane.
+static inline void ISkinVertexAVX(const hsMatrix44& xfm, float wgt, const float* src, float* dst)
+{
+    enum { DP_F4_X = 0xF1, DP_F4_Y = 0xF2, DP_F4_Z = 0xF4 };
+
+    __m256 mc0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(xfm.fMap[0]));
+    __m256 mc1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(xfm.fMap[1]));
+    __m256 mc2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(xfm.fMap[2]));
+    __m256 mwt = _mm256_set1_ps(wgt);
+
+    __m256 msr = _mm256_load_ps(src);
+    __m256 _r =           _mm256_dp_ps(msr, mc0, DP_F4_X);
+    _r = _mm256_or_ps(_r, _mm256_dp_ps(msr, mc1, DP_F4_Y));
+    _r = _mm256_or_ps(_r, _mm256_dp_ps(msr, mc2, DP_F4_Z));
+
+    __m256 _dst = _mm256_load_ps(dst);
+    _dst = _mm256_add_ps(_dst, _mm256_mul_ps(_r, mwt));
+    _mm256_store_ps(dst, _dst);
+}
+#endif // HAVE_AVX
+
+void plCPUSkinningKernels::blend_verts_avx(const hsMatrix44* palette, const uint8_t* src, uint8_t format,
+                                           uint32_t srcStride, uint8_t* dest, uint32_t destStride,
+                                           uint32_t count, uint16_t localUVWChans)
+{
+#ifdef HAVE_AVX
+    IBlendVertLoop<ISkinVertexAVX>(palette, src, format, srcStride, dest, destStride, count, localUVWChans);
+    _mm256_zeroupper();
+#endif // HAVE_AVX
+}
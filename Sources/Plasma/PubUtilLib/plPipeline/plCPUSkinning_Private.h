@@ -0,0 +1,75 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#ifndef _plCPUSkinning_Private_h_
+#define _plCPUSkinning_Private_h_
+
+#include "HeadSpin.h"
+#include "hsCpuID.h"
+
+struct hsMatrix44;
+
+// plCPUSkinning's vertex blend for each instruction set. plCPUSkinning picks
+// one through the dispatcher; plSkinningBenchmark times them one by one.
+class plCPUSkinningKernels
+{
+public:
+    typedef void(*blend_verts_ptr)(const hsMatrix44*, const uint8_t*, uint8_t, uint32_t,
+                                   uint8_t*, uint32_t, uint32_t, uint16_t);
+
+    static void blend_verts_fpu(const hsMatrix44* palette, const uint8_t* src, uint8_t format,
+                                uint32_t srcStride, uint8_t* dest, uint32_t destStride,
+                                uint32_t count, uint16_t localUVWChans);
+    static void blend_verts_sse3(const hsMatrix44* palette, const uint8_t* src, uint8_t format,
+                                 uint32_t srcStride, uint8_t* dest, uint32_t destStride,
+                                 uint32_t count, uint16_t localUVWChans);
+    static void blend_verts_sse41(const hsMatrix44* palette, const uint8_t* src, uint8_t format,
+                                  uint32_t srcStride, uint8_t* dest, uint32_t destStride,
+                                  uint32_t count, uint16_t localUVWChans);
+    static void blend_verts_avx(const hsMatrix44* palette, const uint8_t* src, uint8_t format,
+                                uint32_t srcStride, uint8_t* dest, uint32_t destStride,
+                                uint32_t count, uint16_t localUVWChans);
+
+    static hsCpuFunctionDispatcher<blend_verts_ptr> blend_verts;
+};
+
+#endif // _plCPUSkinning_Private_h_
@@ -49,12 +49,18 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "pnFactory/plFactory.h"
 #include "pnKeyedObject/plKeyImp.h"
 
+#include <algorithm>
+
+// Marks the load order index after the key index ("LOAD")
+static const uint32_t kLoadOrderTag = 0x44414F4C;
+
 plRegistryPageNode::plRegistryPageNode(const plFileName& path)
     : fValid(kPageCorrupt)
     , fPath(path)
     , fLoadedTypes(0)
     , fOpenRequests(0)
     , fIsNewPage(false)
+    , fReadingAhead(false)
 {
     hsStream* stream = OpenStream();
     if (stream)
@@ -72,6 +78,7 @@ plRegistryPageNode::plRegistryPageNode(const plLocation& location, const ST::str
     , fLoadedTypes(0)
     , fOpenRequests(0)
     , fIsNewPage(true)
+    , fReadingAhead(false)
 {
     fPageInfo.SetStrings(age, page);
 
@@ -138,7 +145,63 @@ void plRegistryPageNode::CloseStream()
         fOpenRequests--;
 
     if (fOpenRequests == 0)
+    {
+        fReadingAhead = false;
         fStream.Close();
+    }
+}
+
+void plRegistryPageNode::IReadLoadOrder(hsStream* s)
+{
+    fLoadOrder.clear();
+    if (s->GetSizeLeft() < sizeof(uint32_t) * 2 || s->ReadLE32() != kLoadOrderTag)
+        return;
+
+    uint32_t numExtents = s->ReadLE32();
+    if (s->GetSizeLeft() < numExtents * sizeof(uint32_t) * 2)
+        return;
+
+    fLoadOrder.resize(numExtents);
+    for (LoadExtent& extent : fLoadOrder)
+    {
+        extent.fStart = s->ReadLE32();
+        extent.fLength = s->ReadLE32();
+    }
+}
+
+void plRegistryPageNode::WriteLoadOrder(hsStream* s, const LoadOrder& loadOrder)
+{
+    s->WriteLE32(kLoadOrderTag);
+    s->WriteLE32((uint32_t)loadOrder.size());
+    for (const LoadExtent& extent : loadOrder)
+    {
+        s->WriteLE32(extent.fStart);
+        s->WriteLE32(extent.fLength);
+    }
+}
+
+void plRegistryPageNode::EndReadAhead()
+{
+    fReadingAhead = false;
+    fStream.ClearReadAhead();
+}
+
+void plRegistryPageNode::PrepareRead(uint32_t start, uint32_t length)
+{
+    if (!fReadingAhead || fStream.IsReadAhead(start, length))
+        return;
+
+    for (const LoadExtent& extent : fLoadOrder)
+    {
+        if (start < extent.fStart || start - extent.fStart >= extent.fLength)
+            continue;
+
+        // The rest of this extent, up to the read-ahead size, but always the
+        // whole object even if it's bigger than that
+        uint32_t extentLeft = extent.fLength - (start - extent.fStart);
+        fStream.ReadAhead(start, std::max(length, std::min(extentLeft, kReadAheadSize)));
+        return;
+    }
 }
 
 void plRegistryPageNode::LoadKeys()
@@ -174,6 +237,7 @@ void plRegistryPageNode::LoadKeys()
         }
         keyList->Read(stream);
     }
+    IReadLoadOrder(stream);
 
     stream->SetPosition(oldPos);
     CloseStream();
@@ -47,6 +47,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include "plPageInfo.h"
 
 #include <map>
+#include <vector>
 
 class plRegistryKeyList;
 class plKeyImp;
@@ -66,6 +67,20 @@ enum PageCond
 //
 class plRegistryPageNode 
 {
+public:
+    // A run of the page's data that gets read front to back during a page-in.
+    // plPageOptimizer lays pages out in load order and stores these after the
+    // key index, where older readers never look.
+    struct LoadExtent
+    {
+        uint32_t fStart;
+        uint32_t fLength;
+    };
+    typedef std::vector<LoadExtent> LoadOrder;
+
+    // How far past the current object a page-in reads ahead
+    static constexpr uint32_t kReadAheadSize = 1024 * 1024;
+
 protected:
     friend class plKeyFinder;
 
@@ -83,10 +98,14 @@ protected:
                                 // zero if it's closed)
     bool fIsNewPage;          // True if this page is new (not read off disk)
 
+    LoadOrder fLoadOrder;       // Load order index, if the page has one
+    bool fReadingAhead;         // True between BeginReadAhead and EndReadAhead
+
     plRegistryPageNode() {}
 
     plRegistryKeyList* IGetKeyList(uint16_t classType) const;
     PageCond IVerify();
+    void IReadLoadOrder(hsStream* s);
 
 public:
     // For reading a page off disk
@@ -137,6 +156,17 @@ public:
     hsStream*   OpenStream();
     void        CloseStream();
 
+    // While the stream is held open for a page-in, reads that land in the
+    // load order index pull in the next stretch of it with one big read,
+    // instead of going through the stream a block at a time.
+    // PrepareRead is called before reading each object.
+    void        BeginReadAhead() { fReadingAhead = !fLoadOrder.empty(); }
+    void        EndReadAhead();
+    void        PrepareRead(uint32_t start, uint32_t length);
+
+    const LoadOrder& GetLoadOrder() const { return fLoadOrder; }
+    static void WriteLoadOrder(hsStream* s, const LoadOrder& loadOrder);
+
     // Takes care of everything involved in writing this page to disk
     void Write();
     void DeleteSource();
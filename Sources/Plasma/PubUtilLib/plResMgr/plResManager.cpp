@@ -322,8 +322,12 @@ bool plResManager::ReadObject(plKeyImp* key)
         kResMgrLog(3, ILog(3, "   ...Data stream failed to open on read!"));
         return false;
     }
+    hsStream* stream = pageNode->OpenStream();
+    if (stream)
+        pageNode->PrepareRead(key->GetStartPos(), key->GetDataLen());
+
     fReadingObject = true;
-    bool ret = IReadObject(key, pageNode->OpenStream());
+    bool ret = IReadObject(key, stream);
     fReadingObject = false;
 
     if (!fQueuedReads.empty())
@@ -1196,9 +1200,12 @@ void plResManager::PageInRoom(const plLocation& page, uint16_t objClassToRef, pl
         return;
     }
 
-    // Forces a load
+    // Forces a load. If the page knows what order its objects get read in,
+    // read ahead through them in big chunks.
     kResMgrLog(2, ILog(2, "...Forcing load via sceneNode..."));
+    pageNode->BeginReadAhead();
     objKey->VerifyLoaded();
+    pageNode->EndReadAhead();
     
     // Step 4: Unref the keys. This'll make the unused ones go away again. And guess what,
     // since we just have an array of keys, all we have to do to do this is clear the array.
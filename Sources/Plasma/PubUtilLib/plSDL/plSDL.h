@@ -48,6 +48,8 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include <list>
 #include <string_theory/format>
+#include <unordered_map>
+#include <vector>
 
 #include "plSDLDescriptor.h"
 
@@ -103,6 +105,7 @@ namespace plSDL
     enum BehaviorFlags
     {
         kDisallowTimeStamping = 0x1,
+        kAllowNestedDeltas    = 0x2,    // every peer, the server included, can take partial nested record lists
     };
 
     extern const ST::string kAgeSDLObjectName;
@@ -231,6 +234,8 @@ protected:
         plVarDescriptor::String32* fS32;    // array of strings
         plClientUnifiedTime* fT;    // array of Times
     };
+    static constexpr size_t kInlineAlign = 16;
+    alignas(kInlineAlign) uint8_t fInline[32];  // storage for short numeric arrays, see IAllocArray
     mutable plUnifiedTime   fTimeStamp;     // the last time the var was changed
     plSimpleVarDescriptor fVar;
 
@@ -239,6 +244,8 @@ protected:
 
     void IDeAlloc();
     void IInit();   // initize vars
+    template <typename T> T* IAllocArray(int cnt);
+    template <typename T> void IFreeArray(T* arr) { if ((void*)arr != fInline) delete [] arr; }
     void IVarSet(bool timeStampNow=false);
     
     // converter fxns
@@ -256,6 +263,8 @@ protected:
 
     bool IReadData(hsStream* s, float timeConvert, int idx, uint32_t readOptions);    
     bool IWriteData(hsStream* s, float timeConvert, int idx, uint32_t writeOptions) const;
+    bool IReadBulk(hsStream* s);
+    bool IWriteBulk(hsStream* s) const;
 
 public:
 
@@ -267,6 +276,7 @@ public:
     plSimpleStateVariable* GetAsSimpleStateVar() override { return this; }
     plSDStateVariable* GetAsSDStateVar() override { return nullptr; }
     bool operator==(const plSimpleStateVariable &other) const;  // assumes matching var descriptors
+    bool IsEquivalent(const plSimpleStateVariable &other) const;  // like ==, but ignores float changes below the descriptor's quantum
 
     void TimeStamp(const plUnifiedTime & ut=plUnifiedTime::GetCurrent()) override;
     void CopyFrom(plVarDescriptor* v);
@@ -353,6 +363,7 @@ public:
     plSimpleStateVariable* GetAsSimpleStateVar() override { return nullptr; }
     plSDStateVariable* GetAsSDStateVar() override { return this; }
     bool operator==(const plSDStateVariable &other) const;  // assumes matching var descriptors
+    bool IsEquivalent(const plSDStateVariable &other) const;
 
     void ConvertTo(plSDStateVariable* otherSDVar, bool force=false);
     void CopyFrom(plSDStateVariable* other, uint32_t writeOptions=0);
@@ -382,8 +393,10 @@ public:
     plSDVarDescriptor* GetSDVarDescriptor() { return fVarDescriptor->GetAsSDVarDescriptor(); }
     const plVarDescriptor* GetVarDescriptor() const override { return fVarDescriptor; }
     const plSDVarDescriptor* GetSDVarDescriptor() const { return fVarDescriptor->GetAsSDVarDescriptor(); }
+    void FlagDifferentRecords(const plSDStateVariable& other);  // dirty only the records which differ from 'other'
     void FlagNewerState(const plSDStateVariable&, bool respectAlwaysNew);
     void FlagAlwaysNewState();
+    void FillUnusedRecordsFrom(const plSDStateVariable& other);
     void DumpToObjectDebugger(bool dirtyOnly, int level) const override;
     void DumpToStream(hsStream* stream, bool dirtyOnly, int level) const override;
     
@@ -443,6 +456,7 @@ public:
 
     bool ConvertTo(plStateDescriptor* other, bool force=false );
     bool operator==(const plStateDataRecord &other) const;  // assumes matching state descriptors
+    bool IsEquivalent(const plStateDataRecord &other) const;  // assumes matching state descriptors
 
     uint32_t GetFlags() const { return fFlags;    }
     void SetFlags(uint32_t f) { fFlags =f;    }
@@ -455,6 +469,7 @@ public:
     void UpdateFrom(const plStateDataRecord& other, uint32_t writeOptions=0);
     void SetFromDefaults(bool timeStampNow);
     void TimeStampDirtyVars();
+    void SetDirty(bool d);  // (un)dirty all used vars, including nested records
     
     int GetNumVars() const { return fVarsList.size();   }
     plSimpleStateVariable* GetVar(int i) const { return (plSimpleStateVariable*)fVarsList[i];   }
@@ -493,9 +508,10 @@ public:
     const plUoid* GetAssocObject() const { return &fAssocObject; }      // optional
 
     // utils
-    void FlagDifferentState(const plStateDataRecord& other);    // mark items which differ from 'other' as dirty
+    void FlagDifferentState(const plStateDataRecord& other, bool nestedDeltas=false);   // mark items which differ from 'other' as dirty
     void FlagNewerState(const plStateDataRecord& other, bool respectAlwaysNew=false);   // mark items which are newer than 'other' as dirty
     void FlagAlwaysNewState();  // mark 'alwaysNew' items as dirty
+    void FillUnusedRecordsFrom(const plStateDataRecord& other);     // complete a nested delta using the records in 'other'
     void DumpToObjectDebugger(const char* msg, bool dirtyOnly=false, int level=0) const;
     void DumpToStream(hsStream* stream, const char* msg, bool dirtyOnly=false, int level=0) const;
 
@@ -510,10 +526,13 @@ public:
 //
 // Simple SDL parser
 //
+struct plSDLSourceFile;
 class plSDLParser
 {
 private:
     bool IReadDescriptors() const;
+    bool IReadCache(const plFileName& cacheFile, const std::vector<plSDLSourceFile>& sources) const;
+    void IWriteCache(const plFileName& cacheFile, const std::vector<plSDLSourceFile>& sources) const;
     bool ILoadSDLFile(const plFileName& fileName) const;
     bool IParseVarDesc(const plFileName& fileName, hsStream* stream, char token[],
                        plStateDescriptor*& curDesc, plVarDescriptor*& curVar) const;
@@ -547,11 +566,17 @@ class plSDLMgr
     friend class plSDLParser;
 private:
     plFileName  fSDLDir;
+    plFileName  fCacheFile;
     plSDL::DescriptorList fDescriptors;
     plNetApp*   fNetApp;
     uint32_t    fBehaviorFlags;
 
+    // every version of each descriptor in fDescriptors by name, latest version first
+    typedef std::unordered_map<ST::string, std::vector<plStateDescriptor*>, ST::hash_i, ST::equal_i> DescriptorIndex;
+    DescriptorIndex fDescriptorIndex;
+
     void IDeleteDescriptors(plSDL::DescriptorList* dl);
+    void IIndexDescriptor(plStateDescriptor* sd);
 public:
     plSDLMgr();
     ~plSDLMgr();
@@ -564,6 +589,10 @@ public:
     void SetSDLDir(const plFileName& s) { fSDLDir=s; }
     plFileName GetSDLDir() const { return fSDLDir; }
 
+    // compiled copy of the parsed .sdl files, used by Init while the sources are unchanged
+    void SetCacheFile(const plFileName& s) { fCacheFile=s; }
+    plFileName GetCacheFile() const { return fCacheFile; }
+
     void SetNetApp(plNetApp* a) { fNetApp=a; }
     plNetApp* GetNetApp() const { return fNetApp; }
     
@@ -572,6 +601,7 @@ public:
     uint32_t GetBehaviorFlags() const { return fBehaviorFlags; }
     void SetBehaviorFlags(uint32_t v) { fBehaviorFlags=v; }
     bool AllowTimeStamping() const { return ! ( fBehaviorFlags&plSDL::kDisallowTimeStamping ); }
+    bool AllowNestedDeltas() const { return ( fBehaviorFlags&plSDL::kAllowNestedDeltas ) != 0; }
 
     // I/O - return # of bytes read/written
     int Write(hsStream* s, const plSDL::DescriptorList* dl=nullptr);    // write descriptors to a stream
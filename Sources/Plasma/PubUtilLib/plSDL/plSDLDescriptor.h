@@ -158,6 +158,7 @@ class plSimpleVarDescriptor : public plVarDescriptor
 protected:
     Type    fAtomicType;            // base type (it. quaternion == kFloat)
     int     fAtomicCount;           // computed from type in .sdl (ie. quaternion == 4)
+    float   fQuantum;               // set by .sdl, float changes smaller than this aren't resent. NOT WRITTEN
 public:
     plSimpleVarDescriptor();
     virtual ~plSimpleVarDescriptor() {  }
@@ -175,11 +176,13 @@ public:
     int     GetAtomicSize() const;      // size of one item in bytes (regardless of count)
     Type    GetAtomicType() const       { return fAtomicType; }
     int     GetAtomicCount() const      { return fAtomicCount; }    
+    float   GetQuantum() const          { return fQuantum; }
     
     // setters
     bool    SetType(const ST::string& type) override;
     void    SetType(Type t) { plVarDescriptor::SetType(t); }    // for lame compiler
     void    SetAtomicType(Type t) { fAtomicType=t; }    
+    void    SetQuantum(float q) { fQuantum=q; }
 
     // IO
     bool    Read(hsStream* s) override;
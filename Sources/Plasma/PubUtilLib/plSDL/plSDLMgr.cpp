@@ -44,6 +44,8 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "hsStream.h"
 
+#include <algorithm>
+
 #include "pnNetCommon/plNetApp.h"
 #include "pnNetCommon/pnNetCommon.h"
 
@@ -87,6 +89,22 @@ void plSDLMgr::IDeleteDescriptors(plSDL::DescriptorList* dl)
     for (plStateDescriptor* sd : *dl)
         delete sd;
     dl->clear();
+
+    if (dl == &fDescriptors)
+        fDescriptorIndex.clear();
+}
+
+//
+// add a descriptor from fDescriptors to the lookup index.
+// equal versions keep their list order, so lookups match the old list scan.
+//
+void plSDLMgr::IIndexDescriptor(plStateDescriptor* sd)
+{
+    std::vector<plStateDescriptor*>& versions = fDescriptorIndex[sd->GetName()];
+    auto it = std::find_if(versions.begin(), versions.end(), [sd](const plStateDescriptor* other) {
+        return other->GetVersion() < sd->GetVersion();
+    });
+    versions.insert(it, sd);
 }
 
 
@@ -108,8 +126,22 @@ plStateDescriptor* plSDLMgr::FindDescriptor(const ST::string& name, int version,
     if (name.empty())
         return nullptr;
 
-    if ( !dl )
-        dl = &fDescriptors;
+    if ( !dl || dl == &fDescriptors )
+    {
+        auto it = fDescriptorIndex.find(name);
+        if (it == fDescriptorIndex.end())
+            return nullptr;
+
+        if (version == plSDL::kLatestVersion)
+            return it->second.front();
+
+        for (plStateDescriptor* sd : it->second)
+        {
+            if (sd->GetVersion() == version)
+                return sd;
+        }
+        return nullptr;
+    }
 
     plStateDescriptor* sd = nullptr;
 
@@ -188,7 +220,11 @@ int plSDLMgr::Read(hsStream* s, plSDL::DescriptorList* dl)
         {
             plStateDescriptor* sd=new plStateDescriptor;
             if (sd->Read(s))
+            {
                 dl->push_back(sd);
+                if (dl == &fDescriptors)
+                    IIndexDescriptor(sd);
+            }
             else
                 delete sd; // well that sucked
         }
@@ -44,13 +44,28 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "HeadSpin.h"
 
+#include "hsStream.h"
+
+#include "pnEncryption/plChecksum.h"
 #include "pnNetCommon/plNetApp.h"
 #include "pnNetCommon/pnNetCommon.h"
 
 #include "plFile/plStreamSource.h"
 
+#include <exception>
+#include <vector>
+
 static const int kTokenLen=256;
 
+static const uint32_t kCacheMagic   = 0x434C4453;  // 'SDLC'
+static const uint32_t kCacheVersion = 1;
+
+struct plSDLSourceFile
+{
+    plFileName      fName;
+    plMD5Checksum   fHash;
+};
+
 void plSDLParser::DebugMsg(const ST::string& msg) const
 {
     return;
@@ -134,6 +149,7 @@ bool plSDLParser::IParseStateDesc(const plFileName& fileName, hsStream* stream,
     if ( ok )
     {
         descList->push_back(curDesc);
+        plSDLMgr::GetInstance()->IIndexDescriptor(curDesc);
     }
     else
     {
@@ -206,7 +222,7 @@ bool plSDLParser::IParseVarDesc(const plFileName& fileName, hsStream* stream, ch
     }
     
     //
-    // optional tokens: DEFAULT, INTERNAL
+    // optional tokens: DEFAULT, INTERNAL, QUANTIZE
     //
     while (stream->GetToken(token, kTokenLen))
     {
@@ -277,6 +293,24 @@ bool plSDLParser::IParseVarDesc(const plFileName& fileName, hsStream* stream, ch
                 hsAssert(false, ST::format("missing defaultOption string, fileName={}", fileName).c_str());
             }
         }
+        else
+        if (!strcmp(token, "QUANTIZE"))
+        {
+            hsAssert(curVar, ST::format("Syntax problem with .sdl file, fileName={}", fileName).c_str());
+            dbgStr += ST_LITERAL(" ") + token;
+
+            plSimpleVarDescriptor* sVar = curVar->GetAsSimpleVarDescriptor();
+            bool read=stream->GetToken(token, kTokenLen);
+            if (read && sVar)
+            {
+                dbgStr += ST_LITERAL("=") + token;
+                sVar->SetQuantum(static_cast<float>(atof(token)));
+            }
+            else
+            {
+                hsAssert(false, ST::format("missing or misplaced quantize step, fileName={}", fileName).c_str());
+            }
+        }
 
 #if 1   // delete me in May 2003
         else
@@ -376,6 +410,142 @@ bool plSDLParser::ILoadSDLFile(const plFileName& fileName) const
     return true;
 }
 
+//
+// Cache layout: magic, version, the name and hash of every source file,
+// the descriptors in plSDLMgr::Write format, then the bits of each
+// descriptor that format doesn't carry (source filename, QUANTIZE steps).
+//
+static void IHashSourceFiles(const std::vector<plFileName>& files, std::vector<plSDLSourceFile>* sources)
+{
+    sources->resize(files.size());
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        (*sources)[i].fName = files[i];
+        hsStream* stream = plStreamSource::GetInstance()->GetFile(files[i]);
+        if (stream)
+        {
+            stream->Rewind();
+            (*sources)[i].fHash.CalcFromStream(stream);
+        }
+    }
+}
+
+bool plSDLParser::IReadCache(const plFileName& cacheFile, const std::vector<plSDLSourceFile>& sources) const
+{
+    hsUNIXStream file;
+    if (!file.Open(cacheFile, "rb"))
+        return false;
+
+    // pull the whole thing in at once and parse it from memory
+    std::vector<uint8_t> buf(file.GetEOF());
+    bool ok = file.Read(buf.size(), buf.data()) == buf.size();
+    file.Close();
+    if (!ok)
+        return false;
+
+    hsReadOnlyStream s(buf.size(), buf.data());
+    try
+    {
+        if (s.ReadLE32() != kCacheMagic || s.ReadLE32() != kCacheVersion)
+            return false;
+
+        uint32_t numFiles = s.ReadLE32();
+        if (numFiles != sources.size())
+            return false;
+
+        std::vector<uint8_t> hash;
+        for (const plSDLSourceFile& src : sources)
+        {
+            ST::string name = s.ReadSafeString();
+            hash.resize(src.fHash.GetSize());
+            s.Read(hash.size(), hash.data());
+            if (!src.fHash.IsValid() || name.compare_i(src.fName.AsString()) != 0 ||
+                memcmp(hash.data(), src.fHash.GetValue(), hash.size()) != 0)
+                return false;
+        }
+
+        plSDLMgr* mgr = plSDLMgr::GetInstance();
+        uint32_t numDescs = s.ReadLE32();
+        if (!mgr->Read(&s) || mgr->GetDescriptors()->size() != numDescs)
+        {
+            mgr->DeInit();
+            return false;
+        }
+
+        for (plStateDescriptor* sd : *mgr->GetDescriptors())
+        {
+            sd->SetFilename(s.ReadSafeString());
+            int numVars = s.ReadLE16();
+            if (numVars != sd->GetNumVars())
+            {
+                mgr->DeInit();
+                return false;
+            }
+            for (int i = 0; i < numVars; i++)
+            {
+                float quantum = s.ReadLEFloat();
+                if (plSimpleVarDescriptor* var = sd->GetVar(i)->GetAsSimpleVarDescriptor())
+                    var->SetQuantum(quantum);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        DebugMsg("SDL: Bad descriptor cache {}: {}", cacheFile, e.what());
+        plSDLMgr::GetInstance()->DeInit();
+        return false;
+    }
+
+    return true;
+}
+
+void plSDLParser::IWriteCache(const plFileName& cacheFile, const std::vector<plSDLSourceFile>& sources) const
+{
+    for (const plSDLSourceFile& src : sources)
+    {
+        if (!src.fHash.IsValid())
+            return;     // couldn't hash a source, so we could never validate the cache
+    }
+
+    hsRAMStream s;
+    s.WriteLE32(kCacheMagic);
+    s.WriteLE32(kCacheVersion);
+
+    s.WriteLE32((uint32_t)sources.size());
+    for (const plSDLSourceFile& src : sources)
+    {
+        s.WriteSafeString(src.fName.AsString());
+        s.Write(src.fHash.GetSize(), src.fHash.GetValue());
+    }
+
+    const plSDL::DescriptorList* descs = plSDLMgr::GetInstance()->GetDescriptors();
+    s.WriteLE32((uint32_t)descs->size());
+    plSDLMgr::GetInstance()->Write(&s);
+
+    for (const plStateDescriptor* sd : *descs)
+    {
+        s.WriteSafeString(sd->GetFilename().AsString());
+        s.WriteLE16((uint16_t)sd->GetNumVars());
+        for (int i = 0; i < sd->GetNumVars(); i++)
+        {
+            const plSimpleVarDescriptor* var = sd->GetVar(i)->GetAsSimpleVarDescriptor();
+            s.WriteLEFloat(var ? var->GetQuantum() : 0.f);
+        }
+    }
+
+    hsUNIXStream file;
+    if (!file.Open(cacheFile, "wb"))
+    {
+        DebugMsg("SDL: Can't write descriptor cache {}", cacheFile);
+        return;
+    }
+
+    std::vector<uint8_t> buf(s.GetEOF());
+    s.CopyToMem(buf.data());
+    file.Write(buf.size(), buf.data());
+    file.Close();
+}
+
 //
 // load all .sdl files in sdl directory, and create descriptors for each.
 // return false on error
@@ -388,6 +558,20 @@ bool plSDLParser::IReadDescriptors() const
     // Get the names of all the sdl files
     std::vector<plFileName> files = plStreamSource::GetInstance()->GetListOfNames(sdlDir, "sdl");
 
+    // Skip the text parse entirely if the compiled cache matches every source file
+    plFileName cacheFile = plSDLMgr::GetInstance()->GetCacheFile();
+    std::vector<plSDLSourceFile> sources;
+    if (cacheFile.IsValid() && !files.empty())
+    {
+        IHashSourceFiles(files, &sources);
+        if (IReadCache(cacheFile, sources))
+        {
+            DebugMsg("SDL: Loaded {} descriptors from cache {}",
+                     plSDLMgr::GetInstance()->GetDescriptors()->size(), cacheFile);
+            return true;
+        }
+    }
+
     bool ret=true;
     int cnt=0;
     for (int i = 0; i < files.size(); i++)
@@ -409,6 +593,9 @@ bool plSDLParser::IReadDescriptors() const
     if (!cnt)
         ret=false;
 
+    if (ret && cacheFile.IsValid())
+        IWriteCache(cacheFile, sources);
+
     return ret;
 }
 
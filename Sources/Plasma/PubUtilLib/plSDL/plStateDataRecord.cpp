@@ -539,21 +539,31 @@ void plStateDataRecord::UpdateFrom(const plStateDataRecord& other, uint32_t writ
 // dirty my items which are different from the corresponding one in 'other'.
 // Requires that records have the same descriptor.
 //
-void plStateDataRecord::FlagDifferentState(const plStateDataRecord& other)
+// If nestedDeltas is set, only the nested records which changed are dirtied,
+// so the receiver must fill in the rest (see FillUnusedRecordsFrom).
+//
+void plStateDataRecord::FlagDifferentState(const plStateDataRecord& other, bool nestedDeltas)
 {
     if (other.GetDescriptor()==fDescriptor)
     {
         int i;
         for(i=0;i<other.GetNumVars();i++)
         {
-            bool diff = (GetVar(i)->IsUsed() && ! (*other.GetVar(i) == *GetVar(i)) );
+            bool diff = (GetVar(i)->IsUsed() && !GetVar(i)->IsEquivalent(*other.GetVar(i)));
             GetVar(i)->SetDirty(diff);
         }
 
         for(i=0;i<other.GetNumSDVars();i++)
         {
-            bool diff = (GetSDVar(i)->IsUsed() && ! (*other.GetSDVar(i) == *GetSDVar(i)) );
-            GetSDVar(i)->SetDirty(diff);
+            if (nestedDeltas && GetSDVar(i)->IsUsed())
+            {
+                GetSDVar(i)->FlagDifferentRecords(*other.GetSDVar(i));
+            }
+            else
+            {
+                bool diff = (GetSDVar(i)->IsUsed() && !GetSDVar(i)->IsEquivalent(*other.GetSDVar(i)));
+                GetSDVar(i)->SetDirty(diff);
+            }
         }
     }
     else
@@ -618,6 +628,48 @@ void plStateDataRecord::FlagNewerState(const plStateDataRecord& other, bool resp
     }
 }
 
+//
+// Copy the nested records which are missing from this (partial) record
+// from 'other', typically the last known full state of the object.
+// Requires that records have the same descriptor.
+//
+void plStateDataRecord::FillUnusedRecordsFrom(const plStateDataRecord& other)
+{
+    if (other.GetDescriptor()!=fDescriptor)
+        return;
+
+    int i;
+    for(i=0;i<GetNumSDVars();i++)
+    {
+        if (GetSDVar(i)->IsUsed())
+            GetSDVar(i)->FillUnusedRecordsFrom(*other.GetSDVar(i));
+    }
+}
+
+//
+// assumes matching state descriptors
+//
+bool plStateDataRecord::IsEquivalent(const plStateDataRecord &other) const
+{
+    if (other.GetDescriptor()!=fDescriptor)
+        return false;
+
+    int i;
+    for(i=0;i<other.GetNumVars();i++)
+    {
+        if (!GetVar(i)->IsEquivalent(*other.GetVar(i)))
+            return false;
+    }
+
+    for(i=0;i<other.GetNumSDVars();i++)
+    {
+        if (!GetSDVar(i)->IsEquivalent(*other.GetSDVar(i)))
+            return false;
+    }
+
+    return true;
+}
+
 //
 // assumes matching state descriptors
 //
@@ -855,3 +907,19 @@ void plStateDataRecord::TimeStampDirtyVars()
             fSDVarsList[i]->TimeStamp();
     }
 }
+
+void plStateDataRecord::SetDirty(bool d)
+{
+    int i;
+    for(i=0;i<GetNumVars();i++)
+        GetVar(i)->SetDirty(d && GetVar(i)->IsUsed());
+
+    for(i=0;i<GetNumSDVars();i++)
+    {
+        plSDStateVariable* sdVar = GetSDVar(i);
+        sdVar->SetDirty(d && sdVar->IsUsed());
+        int j;
+        for(j=0;j<sdVar->GetCount();j++)
+            sdVar->GetStateDataRecord(j)->SetDirty(d);
+    }
+}
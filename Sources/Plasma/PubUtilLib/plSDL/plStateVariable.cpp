@@ -174,7 +174,7 @@ void plSimpleStateVariable::IInit()
 
 #define DEALLOC(type, var)  \
     case type:  \
-        delete [] var;  \
+        IFreeArray(var);  \
         break;
 
 void plSimpleStateVariable::IDeAlloc()
@@ -220,9 +220,23 @@ void plSimpleStateVariable::IDeAlloc()
 
 #define SDLALLOC(typeName, type, var)   \
     case typeName:  \
-        var = new type[cnt];    \
+        var = IAllocArray<type>(cnt);    \
         break;
 
+//
+// Short numeric arrays (single values, points, colors, quats) go in the
+// inline buffer instead of on the heap.
+//
+template <typename T>
+T* plSimpleStateVariable::IAllocArray(int cnt)
+{
+    static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= kInlineAlign,
+                  "only plain numeric types can be stored inline");
+    if (cnt * sizeof(T) <= sizeof(fInline))
+        return reinterpret_cast<T*>(fInline);
+    return new T[cnt];
+}
+
 void plSimpleStateVariable::Alloc(int listSize)
 {
     if (listSize != -1)
@@ -244,7 +258,9 @@ void plSimpleStateVariable::Alloc(int listSize)
         SDLALLOC(plVarDescriptor::kFloat, float, fF)
         SDLALLOC(plVarDescriptor::kDouble, double, fD)
         SDLALLOC(plVarDescriptor::kBool, bool, fB)
-        SDLALLOC(plVarDescriptor::kCreatable, plCreatable*, fC)
+        case plVarDescriptor::kCreatable:
+            fC = new plCreatable*[cnt];
+            break;
         case plVarDescriptor::kTime:
             fT = new plClientUnifiedTime[cnt];
             break;
@@ -527,7 +543,7 @@ bool plSimpleStateVariable::IConvertFromRGB(plVarDescriptor::Type newType)
                     newF[j*4+i] = fF[j*fVar.GetAtomicCount()+i];
                 newF[j*4+3] = 0;
             }
-            delete [] fF;   // delete old
+            IFreeArray(fF);   // delete old
             fF = newF;      // use new
         }
         break;
@@ -543,7 +559,7 @@ bool plSimpleStateVariable::IConvertFromRGB(plVarDescriptor::Type newType)
                     newB[j*4+i] = uint8_t(fF[j*fVar.GetAtomicCount()+i]*255+.5);
                 newB[j*4+3] = 0;
             }
-            delete [] fF;   // delete old
+            IFreeArray(fF);   // delete old
             fBy = newB;     // use new
         }
         break;
@@ -558,7 +574,7 @@ bool plSimpleStateVariable::IConvertFromRGB(plVarDescriptor::Type newType)
                 for(i=0;i<3;i++)
                     newB[j*3+i] = uint8_t(fF[j*fVar.GetAtomicCount()+i]*255+.5);
             }
-            delete [] fF;   // delete old
+            IFreeArray(fF);   // delete old
             fBy = newB;     // use new
         }
         break;
@@ -584,7 +600,7 @@ bool plSimpleStateVariable::IConvertFromRGB8(plVarDescriptor::Type newType)
                     newF[j*4+i] = fBy[j*fVar.GetAtomicCount()+i]/255.f;
                 newF[j*4+3] = 0;
             }
-            delete [] fBy;  // delete old
+            IFreeArray(fBy);  // delete old
             fF = newF;      // use new
         }
         break;
@@ -599,7 +615,7 @@ bool plSimpleStateVariable::IConvertFromRGB8(plVarDescriptor::Type newType)
                 for(i=0;i<3;i++)
                     newF[j*3+i] = fBy[j*fVar.GetAtomicCount()+i]/255.f;
             }
-            delete [] fBy;  // delete old
+            IFreeArray(fBy);  // delete old
             fF = newF;      // use new
         }
         break;
@@ -615,7 +631,7 @@ bool plSimpleStateVariable::IConvertFromRGB8(plVarDescriptor::Type newType)
                     newB[j*4+i] = fBy[j*fVar.GetAtomicCount()+i];
                 newB[j*4+3] = 0;
             }
-            delete [] fBy;  // delete old
+            IFreeArray(fBy);  // delete old
             fBy = newB;     // use new
         }
         break;
@@ -643,7 +659,7 @@ bool plSimpleStateVariable::IConvertFromRGBA(plVarDescriptor::Type newType)
                 for(i=0;i<3;i++)
                     newF[j*3+i] = fF[j*fVar.GetAtomicCount()+i];
             }
-            delete [] fF;   // delete old
+            IFreeArray(fF);   // delete old
             fF = newF;      // use new
         }
         break;
@@ -658,7 +674,7 @@ bool plSimpleStateVariable::IConvertFromRGBA(plVarDescriptor::Type newType)
                 for(i=0;i<3;i++)
                     newB[j*3+i] = uint8_t(fF[j*fVar.GetAtomicCount()+i]*255+.5);
             }
-            delete [] fF;   // delete old
+            IFreeArray(fF);   // delete old
             fBy = newB;     // use new
         }
         break;
@@ -673,7 +689,7 @@ bool plSimpleStateVariable::IConvertFromRGBA(plVarDescriptor::Type newType)
                 for(i=0;i<4;i++)
                     newBy[j*4+i] = uint8_t(fF[j*fVar.GetAtomicCount()+i]*255+.5);
             }
-            delete [] fF;   // delete old
+            IFreeArray(fF);   // delete old
             fBy = newBy;        // use new
         }
         break;
@@ -701,7 +717,7 @@ bool plSimpleStateVariable::IConvertFromRGBA8(plVarDescriptor::Type newType)
                 for(i=0;i<3;i++)
                     newF[j*3+i] = fBy[j*fVar.GetAtomicCount()+i]/255.f;
             }
-            delete [] fBy;  // delete old
+            IFreeArray(fBy);  // delete old
             fF = newF;      // use new
         }
         break;
@@ -716,7 +732,7 @@ bool plSimpleStateVariable::IConvertFromRGBA8(plVarDescriptor::Type newType)
                 for(i=0;i<3;i++)
                     newB[j*3+i] = fBy[j*fVar.GetAtomicCount()+i];
             }
-            delete [] fBy;  // delete old
+            IFreeArray(fBy);  // delete old
             fBy = newB;     // use new
         }
         break;
@@ -731,7 +747,7 @@ bool plSimpleStateVariable::IConvertFromRGBA8(plVarDescriptor::Type newType)
                 for(i=0;i<4;i++)
                     newF[j*4+i] = fBy[j*fVar.GetAtomicCount()+i]/255.f;
             }
-            delete [] fBy;  // delete old
+            IFreeArray(fBy);  // delete old
             fF = newF;      // use new
         }
         break;
@@ -755,7 +771,7 @@ bool plSimpleStateVariable::IConvertFromInt(plVarDescriptor::Type newType)
             float* newF = new float[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newF[j] = (float)(fI[j]);
-            delete [] fI;
+            IFreeArray(fI);
             fF = newF;
         }
         break;
@@ -765,7 +781,7 @@ bool plSimpleStateVariable::IConvertFromInt(plVarDescriptor::Type newType)
             short* newS = new short[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newS[j] = short(fI[j]);
-            delete [] fI;
+            IFreeArray(fI);
             fS = newS;
         }
         break;
@@ -775,7 +791,7 @@ bool plSimpleStateVariable::IConvertFromInt(plVarDescriptor::Type newType)
             uint8_t* newBy = new uint8_t[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newBy[j] = uint8_t(fI[j]);
-            delete [] fI;
+            IFreeArray(fI);
             fBy = newBy;
         }
         break;
@@ -785,7 +801,7 @@ bool plSimpleStateVariable::IConvertFromInt(plVarDescriptor::Type newType)
             double * newD = new double[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newD[j] = fI[j];
-            delete [] fI;
+            IFreeArray(fI);
             fD = newD;
         }
         break;
@@ -795,7 +811,7 @@ bool plSimpleStateVariable::IConvertFromInt(plVarDescriptor::Type newType)
             bool * newB = new bool[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newB[j] = (fI[j]!=0);
-            delete [] fI;
+            IFreeArray(fI);
             fB = newB;
         }
         break;
@@ -818,7 +834,7 @@ bool plSimpleStateVariable::IConvertFromShort(plVarDescriptor::Type newType)
             float* newF = new float[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newF[j] = fS[j];
-            delete [] fS;
+            IFreeArray(fS);
             fF = newF;
         }
         break;
@@ -827,7 +843,7 @@ bool plSimpleStateVariable::IConvertFromShort(plVarDescriptor::Type newType)
             int* newI = new int[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newI[j] = short(fS[j]);
-            delete [] fS;
+            IFreeArray(fS);
             fI = newI;
         }
         break;
@@ -836,7 +852,7 @@ bool plSimpleStateVariable::IConvertFromShort(plVarDescriptor::Type newType)
             uint8_t* newBy = new uint8_t[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newBy[j] = uint8_t(fS[j]);
-            delete [] fS;
+            IFreeArray(fS);
             fBy = newBy;
         }
         break;
@@ -845,7 +861,7 @@ bool plSimpleStateVariable::IConvertFromShort(plVarDescriptor::Type newType)
             double * newD = new double[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newD[j] = fS[j];
-            delete [] fS;
+            IFreeArray(fS);
             fD = newD;
         }
         break;
@@ -854,7 +870,7 @@ bool plSimpleStateVariable::IConvertFromShort(plVarDescriptor::Type newType)
             bool * newB = new bool[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newB[j] = (fS[j]!=0);
-            delete [] fS;
+            IFreeArray(fS);
             fB = newB;
         }
         break;
@@ -877,7 +893,7 @@ bool plSimpleStateVariable::IConvertFromByte(plVarDescriptor::Type newType)
             float* newF = new float[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newF[j] = fBy[j];
-            delete [] fBy;
+            IFreeArray(fBy);
             fF = newF;
         }
         break;
@@ -886,7 +902,7 @@ bool plSimpleStateVariable::IConvertFromByte(plVarDescriptor::Type newType)
             int* newI = new int[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newI[j] = short(fBy[j]);
-            delete [] fBy;
+            IFreeArray(fBy);
             fI = newI;
         }
         break;
@@ -895,7 +911,7 @@ bool plSimpleStateVariable::IConvertFromByte(plVarDescriptor::Type newType)
             short* newS = new short[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newS[j] = fBy[j];
-            delete [] fBy;
+            IFreeArray(fBy);
             fS = newS;
         }
         break;
@@ -904,7 +920,7 @@ bool plSimpleStateVariable::IConvertFromByte(plVarDescriptor::Type newType)
             double * newD = new double[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newD[j] = fBy[j];
-            delete [] fBy;
+            IFreeArray(fBy);
             fD = newD;
         }
         break;
@@ -913,7 +929,7 @@ bool plSimpleStateVariable::IConvertFromByte(plVarDescriptor::Type newType)
             bool * newB = new bool[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newB[j] = (fBy[j]!=0);
-            delete [] fBy;
+            IFreeArray(fBy);
             fB = newB;
         }
         break;
@@ -936,7 +952,7 @@ bool plSimpleStateVariable::IConvertFromFloat(plVarDescriptor::Type newType)
             int* newI = new int[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newI[j] = (int)(fF[j]+.5f); // round to nearest int
-            delete [] fF;
+            IFreeArray(fF);
             fI = newI;
         }
         break;
@@ -945,7 +961,7 @@ bool plSimpleStateVariable::IConvertFromFloat(plVarDescriptor::Type newType)
             short* newS = new short[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newS[j] = (short)(fF[j]+.5f);   // round to nearest int
-            delete [] fF;
+            IFreeArray(fF);
             fS = newS;
         }
         break;
@@ -954,7 +970,7 @@ bool plSimpleStateVariable::IConvertFromFloat(plVarDescriptor::Type newType)
             uint8_t* newBy = new uint8_t[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newBy[j] = (uint8_t)(fF[j]+.5f);   // round to nearest int
-            delete [] fF;
+            IFreeArray(fF);
             fBy = newBy;
         }
         break;
@@ -963,7 +979,7 @@ bool plSimpleStateVariable::IConvertFromFloat(plVarDescriptor::Type newType)
             double* newD = new double[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newD[j] = fF[j];
-            delete [] fF;
+            IFreeArray(fF);
             fD = newD;
         }
         break;
@@ -972,7 +988,7 @@ bool plSimpleStateVariable::IConvertFromFloat(plVarDescriptor::Type newType)
             bool* newB = new bool[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newB[j] = (fF[j]!=0);
-            delete [] fF;
+            IFreeArray(fF);
             fB = newB;
         }
         break;
@@ -995,7 +1011,7 @@ bool plSimpleStateVariable::IConvertFromDouble(plVarDescriptor::Type newType)
             int* newI = new int[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newI[j] = (int)(fD[j]+.5f); // round to nearest int
-            delete [] fD;
+            IFreeArray(fD);
             fI = newI;
         }
         break;
@@ -1004,7 +1020,7 @@ bool plSimpleStateVariable::IConvertFromDouble(plVarDescriptor::Type newType)
             short* newS = new short[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newS[j] = (short)(fD[j]+.5f);   // round to nearest int
-            delete [] fD;
+            IFreeArray(fD);
             fS = newS;
         }
         break;
@@ -1013,7 +1029,7 @@ bool plSimpleStateVariable::IConvertFromDouble(plVarDescriptor::Type newType)
             uint8_t* newBy = new uint8_t[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newBy[j] = (uint8_t)(fD[j]+.5f);   // round to nearest int
-            delete [] fD;
+            IFreeArray(fD);
             fBy = newBy;
         }
         break;
@@ -1022,7 +1038,7 @@ bool plSimpleStateVariable::IConvertFromDouble(plVarDescriptor::Type newType)
             float* newF = new float[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newF[j] = (float)(fD[j]);
-            delete [] fD;
+            IFreeArray(fD);
             fF = newF;
         }
         break;
@@ -1031,7 +1047,7 @@ bool plSimpleStateVariable::IConvertFromDouble(plVarDescriptor::Type newType)
             bool* newB = new bool[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newB[j] = (fD[j]!=0);
-            delete [] fD;
+            IFreeArray(fD);
             fB = newB;
         }
         break;
@@ -1054,7 +1070,7 @@ bool plSimpleStateVariable::IConvertFromBool(plVarDescriptor::Type newType)
             int* newI = new int[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newI[j] = (fB[j] == true ? 1 : 0);
-            delete [] fB;
+            IFreeArray(fB);
             fI = newI;
         }
         break;
@@ -1063,7 +1079,7 @@ bool plSimpleStateVariable::IConvertFromBool(plVarDescriptor::Type newType)
             short* newS = new short[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newS[j] = (fB[j] == true ? 1 : 0);
-            delete [] fB;
+            IFreeArray(fB);
             fS = newS;
         }
         break;
@@ -1072,7 +1088,7 @@ bool plSimpleStateVariable::IConvertFromBool(plVarDescriptor::Type newType)
             uint8_t* newBy = new uint8_t[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newBy[j] = (fB[j] == true ? 1 : 0);
-            delete [] fB;
+            IFreeArray(fB);
             fBy = newBy;
         }
         break;
@@ -1081,7 +1097,7 @@ bool plSimpleStateVariable::IConvertFromBool(plVarDescriptor::Type newType)
             float* newF = new float[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newF[j] = (fB[j] == true ? 1.f : 0.f);
-            delete [] fB;
+            IFreeArray(fB);
             fF = newF;
         }
         break;
@@ -1090,7 +1106,7 @@ bool plSimpleStateVariable::IConvertFromBool(plVarDescriptor::Type newType)
             double* newD= new double[fVar.GetCount()];
             for(j=0;j<fVar.GetCount(); j++)
                 newD[j] = (fB[j] == true ? 1.f : 0.f);
-            delete [] fB;
+            IFreeArray(fB);
             fD = newD;
         }
         break;
@@ -1949,6 +1965,61 @@ bool plSimpleStateVariable::IReadData(hsStream* s, float timeConvert, int idx, u
 #   pragma optimize( "", on )  // restore optimizations to their defaults
 #endif
 
+//
+// Plain numeric lists are stored contiguously in the same order IWriteData
+// puts them on the wire, so move them in one go.
+// Returns false if the type needs the per-element path.
+//
+bool plSimpleStateVariable::IWriteBulk(hsStream* s) const
+{
+    size_t cnt = fVar.GetAtomicCount()*fVar.GetCount();
+    switch(fVar.GetAtomicType())
+    {
+    case plVarDescriptor::kInt:
+        s->WriteLE32(cnt, reinterpret_cast<const uint32_t*>(fI));
+        return true;
+    case plVarDescriptor::kShort:
+        s->WriteLE16(cnt, reinterpret_cast<const uint16_t*>(fS));
+        return true;
+    case plVarDescriptor::kByte:
+        s->Write(cnt, fBy);
+        return true;
+    case plVarDescriptor::kFloat:
+        s->WriteLEFloat(cnt, fF);
+        return true;
+    case plVarDescriptor::kDouble:
+        s->WriteLEDouble(cnt, fD);
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool plSimpleStateVariable::IReadBulk(hsStream* s)
+{
+    size_t cnt = fVar.GetAtomicCount()*fVar.GetCount();
+    switch(fVar.GetAtomicType())
+    {
+    case plVarDescriptor::kInt:
+        s->ReadLE32(cnt, reinterpret_cast<uint32_t*>(fI));
+        return true;
+    case plVarDescriptor::kShort:
+        s->ReadLE16(cnt, reinterpret_cast<uint16_t*>(fS));
+        return true;
+    case plVarDescriptor::kByte:
+        s->Read(cnt, fBy);
+        return true;
+    case plVarDescriptor::kFloat:
+        s->ReadLEFloat(cnt, fF);
+        return true;
+    case plVarDescriptor::kDouble:
+        s->ReadLEDouble(cnt, fD);
+        return true;
+    default:
+        return false;
+    }
+}
+
 bool plSimpleStateVariable::WriteData(hsStream* s, float timeConvert, uint32_t writeOptions) const
 {
 #ifdef HS_DEBUGGING
@@ -2010,10 +2081,13 @@ bool plSimpleStateVariable::WriteData(hsStream* s, float timeConvert, uint32_t w
             s->WriteLE32(GetVarDescriptor()->GetCount());     // have to write out as long since we don't know how big the list is
 
         // list
-        int i;
-        for(i=0;i<fVar.GetCount();i++)
-            if (!IWriteData(s, timeConvert, i, writeOptions))
-                return false;
+        if (!IWriteBulk(s))
+        {
+            int i;
+            for(i=0;i<fVar.GetCount();i++)
+                if (!IWriteData(s, timeConvert, i, writeOptions))
+                    return false;
+        }
     }
 
     return true;
@@ -2074,10 +2148,13 @@ bool plSimpleStateVariable::ReadData(hsStream* s, float timeConvert, uint32_t re
     // read list
     if (!(saveFlags & plSDL::kSameAsDefault))
     {
-        int i;
-        for(i=0;i<fVar.GetCount();i++)
-            if (!IReadData(s, timeConvert, i, readOptions))
-                return false;
+        if (!IReadBulk(s))
+        {
+            int i;
+            for(i=0;i<fVar.GetCount();i++)
+                if (!IReadData(s, timeConvert, i, readOptions))
+                    return false;
+        }
     }
     else
     {
@@ -2181,6 +2258,17 @@ void plSimpleStateVariable::NotifyStateChange(const plSimpleStateVariable* other
 // Checks to see if data contents are the same on two matching vars.
 //
 
+// Branch-free so the compiler can vectorize it. Floats can't just be
+// memcmp'd, since 0 == -0 and NaN != NaN.
+template <typename T>
+static bool IArraysEqual(const T* a, const T* b, int cnt)
+{
+    bool eq = true;
+    for (int i = 0; i < cnt; i++)
+        eq &= (a[i] == b[i]);
+    return eq;
+}
+
 #define EQ_CHECK(type, var)     \
 case type:  \
     for(i=0;i<cnt;i++)  \
@@ -2188,6 +2276,14 @@ case type:  \
             return false;   \
     break;  
 
+#define EQ_CHECK_MEM(type, var)     \
+case type:  \
+    return memcmp(var, other.var, cnt*sizeof(*var)) == 0;
+
+#define EQ_CHECK_VEC(type, var)     \
+case type:  \
+    return IArraysEqual(var, other.var, cnt);
+
 bool plSimpleStateVariable::operator==(const plSimpleStateVariable &other) const
 {
     hsAssert(fVar.GetType() == other.GetVarDescriptor()->GetType(), "type mismatch in equality check");
@@ -2201,16 +2297,16 @@ bool plSimpleStateVariable::operator==(const plSimpleStateVariable &other) const
     int cnt = fVar.GetAtomicCount()*fVar.GetCount();
     switch(fVar.GetAtomicType())
     {
-        EQ_CHECK(plVarDescriptor::kAgeTimeOfDay, fF)
-        EQ_CHECK(plVarDescriptor::kInt, fI)
-        EQ_CHECK(plVarDescriptor::kFloat, fF)
+        EQ_CHECK_VEC(plVarDescriptor::kAgeTimeOfDay, fF)
+        EQ_CHECK_MEM(plVarDescriptor::kInt, fI)
+        EQ_CHECK_VEC(plVarDescriptor::kFloat, fF)
         EQ_CHECK(plVarDescriptor::kTime, fT)
-        EQ_CHECK(plVarDescriptor::kDouble, fD)
-        EQ_CHECK(plVarDescriptor::kBool, fB)
+        EQ_CHECK_VEC(plVarDescriptor::kDouble, fD)
+        EQ_CHECK_VEC(plVarDescriptor::kBool, fB)
         EQ_CHECK(plVarDescriptor::kKey, fU)
         EQ_CHECK(plVarDescriptor::kCreatable, fC)
-        EQ_CHECK(plVarDescriptor::kShort, fS)
-        EQ_CHECK(plVarDescriptor::kByte, fBy)       
+        EQ_CHECK_MEM(plVarDescriptor::kShort, fS)
+        EQ_CHECK_MEM(plVarDescriptor::kByte, fBy)       
     case plVarDescriptor::kString32:
         for(i=0;i<cnt;i++)
             if (stricmp(fS32[i],other.fS32[i]))
@@ -2225,6 +2321,41 @@ bool plSimpleStateVariable::operator==(const plSimpleStateVariable &other) const
     return true;
 }
 
+//
+// Same as ==, except that float values which moved by less than the
+// descriptor's quantum (see QUANTIZE in the .sdl) are considered unchanged.
+// Compare against the last state sent so small changes still accumulate.
+//
+bool plSimpleStateVariable::IsEquivalent(const plSimpleStateVariable &other) const
+{
+    float quantum = fVar.GetQuantum();
+    if (quantum <= 0.f || GetCount() != other.GetCount())
+        return *this == other;
+
+    int i;
+    int cnt = fVar.GetAtomicCount()*fVar.GetCount();
+    switch(fVar.GetAtomicType())
+    {
+    case plVarDescriptor::kAgeTimeOfDay:
+    case plVarDescriptor::kFloat:
+        {
+            bool eq = true;
+            for(i=0;i<cnt;i++)
+                eq &= !(std::fabs(fF[i]-other.fF[i]) >= quantum);
+            return eq;
+        }
+    case plVarDescriptor::kDouble:
+        {
+            bool eq = true;
+            for(i=0;i<cnt;i++)
+                eq &= !(std::fabs(fD[i]-other.fD[i]) >= quantum);
+            return eq;
+        }
+    default:
+        return *this == other;
+    }
+}
+
 //
 // Add and coalate
 //
@@ -2746,6 +2877,21 @@ bool plSDStateVariable::operator==(const plSDStateVariable &other) const
     return true;
 }
 
+bool plSDStateVariable::IsEquivalent(const plSDStateVariable &other) const
+{
+    if (GetCount() != other.GetCount())
+        return false;
+
+    int i;
+    for(i=0;i<GetCount(); i++)
+    {
+        if (!GetStateDataRecord(i)->IsEquivalent(*other.GetStateDataRecord(i)))
+            return false;
+    }
+
+    return true;
+}
+
 void plSDStateVariable::SetFromDefaults(bool timeStampNow)
 {
     int i;
@@ -2758,6 +2904,48 @@ void plSDStateVariable::TimeStamp( const plUnifiedTime & ut/*=plUnifiedTime::Get
     hsAssert( false, "not impl" );
 }
 
+//
+// Per-element delta. Records which match 'other' are undirtied so only the
+// changed ones get written. A changed record is always sent whole, since
+// receivers expect complete elements.
+//
+void plSDStateVariable::FlagDifferentRecords(const plSDStateVariable& other)
+{
+    if (GetCount() != other.GetCount())
+    {
+        // list was resized, resend all of it
+        SetDirty(IsUsed());
+        return;
+    }
+
+    SetDirty(false);
+    int i;
+    for(i=0;i<GetCount(); i++)
+    {
+        plStateDataRecord* rec = GetStateDataRecord(i);
+        rec->SetDirty(!rec->IsEquivalent(*other.GetStateDataRecord(i)));
+    }
+}
+
+//
+// Fill the records which were not sent in a nested delta from 'other'.
+//
+void plSDStateVariable::FillUnusedRecordsFrom(const plSDStateVariable& other)
+{
+    if (GetCount() != other.GetCount())
+        return;
+
+    int i;
+    for(i=0;i<GetCount(); i++)
+    {
+        plStateDataRecord* rec = GetStateDataRecord(i);
+        if (rec->IsUsed())
+            rec->FillUnusedRecordsFrom(*other.GetStateDataRecord(i));
+        else
+            rec->CopyFrom(*other.GetStateDataRecord(i), plSDL::kWriteTimeStamps);
+    }
+}
+
 void plSDStateVariable::FlagNewerState(const plSDStateVariable& other, bool respectAlwaysNew)
 {
     int i;
@@ -192,7 +192,8 @@ void plVarDescriptor::Write(hsStream* s) const
 
 plSimpleVarDescriptor::plSimpleVarDescriptor() :
     fAtomicType(kNone),
-    fAtomicCount(1)
+    fAtomicCount(1),
+    fQuantum()
 {   
 
 }
@@ -328,6 +329,7 @@ void plSimpleVarDescriptor::CopyFrom(const plSimpleVarDescriptor* other)
 
     fAtomicCount=other->GetAtomicCount();
     fAtomicType=other->GetAtomicType();
+    fQuantum=other->GetQuantum();
 }
 
 //
@@ -108,10 +108,7 @@ plCullPoly& plCullPoly::Transform(const hsMatrix44& l2w, const hsMatrix44& w2l,
 
     dst.fVerts.resize(fVerts.size());
 
-    for (size_t i = 0; i < fVerts.size(); i++)
-    {
-        dst.fVerts[i] = l2w * fVerts[i];
-    }
+    l2w.MapPoints(fVerts.size(), fVerts.data(), dst.fVerts.data());
     dst.fCenter = l2w * fCenter;
 
     dst.fNorm = tpose * fNorm;
@@ -68,6 +68,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "pnDispatch/plDispatch.h"
 
+#include "plGImage/plImageCodecService.h"
 #include "plGImage/plJPEG.h"
 #include "plGImage/plMipmap.h"
 #include "plGImage/plPNG.h"
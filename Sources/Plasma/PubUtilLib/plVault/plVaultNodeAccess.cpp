@@ -206,30 +206,44 @@ void VaultSDLNode::InitStateDataRecord (const ST::string& sdlRecName, unsigned w
 *
 ***/
 
+// JPEG blobs start with the 32-bit size that plJPEG's stream writer puts in
+// front of the image, which the memory codec has no use for
+static bool SkipJPEGSize (const uint8_t *& data, size_t & bytes) {
+    if (!data || bytes < sizeof(uint32_t))
+        return false;
+
+    uint32_t jpegBytes;
+    memcpy(&jpegBytes, data, sizeof(uint32_t));
+    data += sizeof(uint32_t);
+    bytes = std::min<size_t>(bytes - sizeof(uint32_t), hsToLE32(jpegBytes));
+    return true;
+}
+
 //============================================================================
 void VaultImageNode::StuffImage (plMipmap * src, int dstType) {
-    hsRAMStream ramStream;
+    std::vector<uint8_t> buffer;
     bool compressSuccess = false;
 
     switch (dstType) {
-        case kJPEG:
+        case kJPEG: {
+            // Leave room for the size, and fill it in once we know it
+            buffer.resize(sizeof(uint32_t));
             plJPEG::Instance().SetWriteQuality(70/*percent*/);
-            compressSuccess = plJPEG::Instance().WriteToStream(&ramStream, src);
+            compressSuccess = plJPEG::Instance().WriteToMemory(buffer, src);
+            uint32_t jpegBytes = hsToLE32((uint32_t)(buffer.size() - sizeof(uint32_t)));
+            memcpy(buffer.data(), &jpegBytes, sizeof(uint32_t));
             break;
+        }
         case kPNG:
-            compressSuccess = plPNG::Instance().WriteToStream(&ramStream, src);
+            compressSuccess = plPNG::Instance().WriteToMemory(buffer, src);
             break;
         default:
             break;
     }
 
     if (compressSuccess) {
-        unsigned bytes = ramStream.GetEOF();
-        uint8_t * buffer = (uint8_t *)malloc(bytes);
-        ramStream.CopyToMem(buffer);
-        SetImageData(buffer, bytes);
+        SetImageData(buffer.data(), buffer.size());
         SetImageType(dstType);
-        free(buffer);
     } else {
         SetImageData(nullptr, 0);
         SetImageType(kNone);
@@ -238,17 +252,16 @@ void VaultImageNode::StuffImage (plMipmap * src, int dstType) {
 
 //============================================================================
 bool VaultImageNode::ExtractImage (plMipmap ** dst) {
-    hsRAMStream ramStream;
-    ramStream.Write(GetImageDataLength(), GetImageData());
-    ramStream.Rewind();
+    const uint8_t * data = GetImageData();
+    size_t bytes = GetImageDataLength();
 
     switch (GetImageType()) {
         case kJPEG:
-            (*dst) = plJPEG::Instance().ReadFromStream(&ramStream);
+            (*dst) = SkipJPEGSize(data, bytes) ? plJPEG::Instance().ReadFromMemory(data, bytes) : nullptr;
             break;
 
         case kPNG:
-            (*dst) = plPNG::Instance().ReadFromStream(&ramStream);
+            (*dst) = data ? plPNG::Instance().ReadFromMemory(data, bytes) : nullptr;
             break;
 
         case kNone:
@@ -259,6 +272,40 @@ bool VaultImageNode::ExtractImage (plMipmap ** dst) {
     return ((*dst) != nullptr);
 }
 
+//============================================================================
+void VaultImageNode::ExtractImageAsync (std::function<void(plMipmap *)> callback, uint8_t scaleDenom) {
+    const uint8_t * data = GetImageData();
+    size_t bytes = GetImageDataLength();
+
+    plImageCodecService::Format format;
+    switch (GetImageType()) {
+        case kJPEG:
+            if (!SkipJPEGSize(data, bytes)) {
+                callback(nullptr);
+                return;
+            }
+            format = plImageCodecService::kJPEG;
+            break;
+
+        case kPNG:
+            if (!data) {
+                callback(nullptr);
+                return;
+            }
+            format = plImageCodecService::kPNG;
+            break;
+
+        case kNone:
+        default:
+            callback(nullptr);
+            return;
+    }
+
+    // The node can change under us before a worker gets to it, so the
+    // worker gets its own copy of the image
+    plImageCodecService::Decode(format, std::vector<uint8_t>(data, data + bytes), std::move(callback), scaleDenom);
+}
+
 
 /*****************************************************************************
 *
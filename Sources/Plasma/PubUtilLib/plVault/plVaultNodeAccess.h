@@ -55,6 +55,7 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 
 #include "pnNetProtocol/pnNetProtocol.h"
 
+#include <functional>
 #include <string_theory/string>
 
 /*****************************************************************************
@@ -211,6 +212,11 @@ struct VaultImageNode : NetVaultNodeAccess {
 
     void StuffImage (class plMipmap * src, int dstType=kJPEG);
     bool ExtractImage (class plMipmap ** dst);
+
+    // Decodes on a worker thread and calls back on the main thread with the
+    // new mipmap (yours to delete), or nullptr if there's no image.  JPEGs
+    // can be shrunk by a scaleDenom of 2, 4 or 8 for thumbnails.
+    void ExtractImageAsync (std::function<void(class plMipmap *)> callback, uint8_t scaleDenom=1);
 };
 
 //============================================================================
@@ -0,0 +1,191 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsJobSystem.h"
+
+TEST(hsJobSystem, runs_every_job)
+{
+    hsJobSystem jobs(4);
+    std::atomic<int> count(0);
+
+    std::vector<hsJobHandle> handles;
+    for (int i = 0; i < 1000; ++i)
+        handles.push_back(jobs.Submit([&count]() { count++; }));
+    jobs.Wait(handles);
+
+    EXPECT_EQ(count.load(), 1000);
+    for (const hsJobHandle& job : handles)
+        EXPECT_TRUE(job->IsDone());
+}
+
+TEST(hsJobSystem, dependencies)
+{
+    hsJobSystem jobs(4);
+    std::atomic<int> order(0);
+    int first = -1, second = -1, third = -1;
+
+    hsJobHandle a = jobs.Submit([&]() { first = order++; });
+    hsJobHandle b = jobs.Submit([&]() { second = order++; }, { a });
+    hsJobHandle c = jobs.Submit([&]() { third = order++; }, { a, b });
+    jobs.Wait(c);
+
+    EXPECT_EQ(first, 0);
+    EXPECT_EQ(second, 1);
+    EXPECT_EQ(third, 2);
+}
+
+TEST(hsJobSystem, main_thread_jobs)
+{
+    hsJobSystem jobs(2);
+    std::thread::id ranOn;
+
+    hsJobHandle work = jobs.Submit([]() { });
+    hsJobHandle mainJob = jobs.SubmitMainThread([&ranOn]() { ranOn = std::this_thread::get_id(); }, { work });
+    jobs.Wait(work);
+
+    // Main thread jobs wait to be pumped
+    jobs.RunMainThreadJobs();
+    EXPECT_TRUE(mainJob->IsDone());
+    EXPECT_EQ(ranOn, std::this_thread::get_id());
+}
+
+TEST(hsJobSystem, wait_leaves_unrelated_main_thread_jobs)
+{
+    hsJobSystem jobs(2);
+    bool otherRan = false, otherRanEarly = true;
+
+    hsJobHandle outer = jobs.SubmitMainThread([&]() {
+        jobs.SubmitMainThread([&otherRan]() { otherRan = true; });
+
+        // Neither the ParallelFor's wait nor an explicit one may pick up the
+        // job queued above; that is RunMainThreadJobs()' call.  The work is
+        // slow enough that both waits have to go looking for something to do.
+        auto slow = []() { std::this_thread::sleep_for(std::chrono::milliseconds(5)); };
+        jobs.ParallelFor(0, 8, 1, [&slow](size_t, size_t) { slow(); });
+        jobs.Wait(jobs.Submit(slow));
+        otherRanEarly = otherRan;
+    });
+    jobs.RunMainThreadJobs();
+
+    EXPECT_TRUE(outer->IsDone());
+    EXPECT_FALSE(otherRanEarly);
+    EXPECT_FALSE(otherRan);
+    jobs.RunMainThreadJobs();
+    EXPECT_TRUE(otherRan);
+}
+
+TEST(hsJobSystem, wait_runs_main_thread_dependencies)
+{
+    hsJobSystem jobs(2);
+    int order = 0, mainStep = -1, afterStep = -1;
+
+    hsJobHandle mainJob = jobs.SubmitMainThread([&]() { mainStep = order++; });
+    hsJobHandle after = jobs.Submit([&]() { afterStep = order++; }, { mainJob });
+    jobs.Wait(after);
+
+    EXPECT_EQ(mainStep, 0);
+    EXPECT_EQ(afterStep, 1);
+}
+
+TEST(hsJobSystem, wait_runs_sibling_main_thread_job)
+{
+    hsJobSystem jobs(2);
+    int order = 0, firstStep = -1, secondStep = -1;
+    hsJobHandle second;
+
+    // Both are ready before RunMainThreadJobs() starts, so the first one's
+    // Wait() has to pull the second out of the same batch.
+    hsJobHandle first = jobs.SubmitMainThread([&]() {
+        jobs.Wait(second);
+        firstStep = order++;
+    });
+    second = jobs.SubmitMainThread([&]() { secondStep = order++; });
+
+    jobs.RunMainThreadJobs();
+    EXPECT_TRUE(first->IsDone());
+    EXPECT_TRUE(second->IsDone());
+    EXPECT_EQ(secondStep, 0);
+    EXPECT_EQ(firstStep, 1);
+}
+
+TEST(hsJobSystem, parallel_for)
+{
+    hsJobSystem jobs(4);
+    std::vector<int> hits(10007, 0);
+
+    jobs.ParallelFor(0, hits.size(), 64, [&hits](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            hits[i]++;
+    });
+
+    for (int hit : hits)
+        EXPECT_EQ(hit, 1);
+
+    // Empty and single-chunk ranges run inline
+    std::atomic<int> calls(0);
+    jobs.ParallelFor(5, 5, 1, [&calls](size_t, size_t) { calls++; });
+    jobs.ParallelFor(0, 10, 100, [&calls](size_t, size_t) { calls++; });
+    EXPECT_EQ(calls.load(), 1);
+}
+
+TEST(hsJobSystem, nested_parallel_for)
+{
+    hsJobSystem jobs(4);
+    std::atomic<int> count(0);
+
+    jobs.ParallelFor(0, 32, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            jobs.ParallelFor(0, 100, 10, [&count](size_t b, size_t e) {
+                count += int(e - b);
+            });
+        }
+    });
+
+    EXPECT_EQ(count.load(), 3200);
+}
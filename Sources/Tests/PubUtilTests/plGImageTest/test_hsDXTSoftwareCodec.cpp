@@ -0,0 +1,146 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011 Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <cstring>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsColorRGBA.h"
+#include "hsCpuID.h"
+
+#include "plGImage/hsDXTSoftwareCodec_Private.h"
+
+//// Each SIMD kernel against its scalar version //////////////////////////////
+
+#if defined(HAVE_SSE2) || defined(HAVE_AVX2)
+static std::vector<uint8_t> IRandomBytes(size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> bytes(count);
+    for (uint8_t& byte : bytes)
+        byte = uint8_t(rng());
+    return bytes;
+}
+#endif
+
+#ifdef HAVE_AVX2
+static void ICheckDecode(const char* name, uint32_t blockSize,
+                         hsDXTSoftwareCodecKernels::decode_blocks_ptr fpu,
+                         hsDXTSoftwareCodecKernels::decode_blocks_ptr avx2)
+{
+    for (uint32_t numBlocks = 0; numBlocks < 12; numBlocks++) {
+        std::vector<uint8_t> blocks = IRandomBytes(numBlocks * blockSize, numBlocks);
+
+        // Equal color endpoints pick the other palette, so make sure some
+        // blocks have them
+        for (uint32_t i = 0; i < numBlocks; i += 3) {
+            uint8_t* colors = blocks.data() + i * blockSize + blockSize - 8;
+            memcpy(colors + 2, colors, 2);
+        }
+
+        // Leave a gap after each row, which neither version may touch
+        uint32_t destStride = numBlocks * 4 + 3;
+        std::vector<uint32_t> fpuOut(destStride * 4, 0xdeadbeef), avx2Out(destStride * 4, 0xdeadbeef);
+        fpu(blocks.data(), fpuOut.data(), numBlocks, destStride);
+        avx2(blocks.data(), avx2Out.data(), numBlocks, destStride);
+        EXPECT_EQ(fpuOut, avx2Out) << name << ", " << numBlocks << " blocks";
+    }
+}
+
+TEST(hsDXTSoftwareCodec, avx2_decoders)
+{
+    if (!hsCpuId::Instance().has_avx2)
+        GTEST_SKIP();
+
+    ICheckDecode("decode_dxt1_to32", 8, hsDXTSoftwareCodecKernels::decode_dxt1_to32_fpu,
+                 hsDXTSoftwareCodecKernels::decode_dxt1_to32_avx2);
+    ICheckDecode("decode_dxt5_to32", 16, hsDXTSoftwareCodecKernels::decode_dxt5_to32_fpu,
+                 hsDXTSoftwareCodecKernels::decode_dxt5_to32_avx2);
+}
+#endif // HAVE_AVX2
+
+#ifdef HAVE_SSE2
+static uint32_t IPacked(const hsRGBAColor32& color)
+{
+    uint32_t packed;
+    memcpy(&packed, &color, sizeof(packed));
+    return packed;
+}
+
+TEST(hsDXTSoftwareCodec, sse2_find_endpoints)
+{
+    if (!hsCpuId::Instance().has_sse2)
+        GTEST_SKIP();
+
+    for (uint32_t seed = 0; seed < 200; seed++) {
+        std::vector<uint8_t> bytes = IRandomBytes(16 * sizeof(hsRGBAColor32), seed);
+        hsRGBAColor32 pixels[16];
+        memcpy(pixels, bytes.data(), sizeof(pixels));
+
+        // Repeat pixels and squeeze the colors together in some blocks, so
+        // there are ties for the farthest pair
+        if (seed % 2) {
+            for (int i = 0; i < 16; i += 4)
+                pixels[i + 1] = pixels[i];
+        }
+        if (seed % 3 == 0) {
+            for (hsRGBAColor32& px : pixels) {
+                px.r &= 0x3;
+                px.g &= 0x3;
+                px.b &= 0x3;
+            }
+        }
+        if (seed % 50 == 0) {
+            for (hsRGBAColor32& px : pixels)
+                px = pixels[0];
+        }
+
+        hsRGBAColor32 fpu0{}, fpu1{}, sse20{}, sse21{};
+        hsDXTSoftwareCodecKernels::find_endpoints_fpu(pixels, fpu0, fpu1);
+        hsDXTSoftwareCodecKernels::find_endpoints_sse2(pixels, sse20, sse21);
+        EXPECT_EQ(IPacked(fpu0), IPacked(sse20)) << "color0, seed " << seed;
+        EXPECT_EQ(IPacked(fpu1), IPacked(sse21)) << "color1, seed " << seed;
+    }
+}
+#endif // HAVE_SSE2
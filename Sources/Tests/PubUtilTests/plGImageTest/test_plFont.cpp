@@ -0,0 +1,128 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011 Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsCpuID.h"
+
+#include "plGImage/plFont_Private.h"
+
+//// Each SIMD blitter against its scalar version /////////////////////////////
+
+#ifdef HAVE_SSE2
+static std::vector<uint8_t> IRandomCoverage(size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> coverage(count);
+    for (uint8_t& cov : coverage) {
+        // Glyphs are mostly empty or solid, with antialiased edges between
+        switch (rng() % 3) {
+            case 0: cov = 0; break;
+            case 1: cov = 255; break;
+            default: cov = uint8_t(rng()); break;
+        }
+    }
+    return coverage;
+}
+
+static std::vector<uint32_t> IRandomPixels(size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint32_t> pixels(count);
+    for (uint32_t& px : pixels)
+        px = rng();
+    return pixels;
+}
+
+TEST(plFont, sse2_blitters)
+{
+    if (!hsCpuId::Instance().has_sse2)
+        GTEST_SKIP();
+
+    struct Blitter
+    {
+        const char* fName;
+        plFontKernels::blit_row_ptr fFpu;
+        plFontKernels::blit_row_ptr fSSE2;
+    };
+    const Blitter blitters[] = {
+        { "blend_8to32", plFontKernels::blend_8to32_fpu, plFontKernels::blend_8to32_sse2 },
+        { "full_alpha_8to32", plFontKernels::full_alpha_8to32_fpu, plFontKernels::full_alpha_8to32_sse2 },
+        { "alpha_8to32", plFontKernels::alpha_8to32_fpu, plFontKernels::alpha_8to32_sse2 },
+        { "alpha_prem_8to32", plFontKernels::alpha_prem_8to32_fpu, plFontKernels::alpha_prem_8to32_sse2 },
+    };
+    const uint32_t colors[] = { 0xffffffff, 0xff20c040, 0x80ff8000, 0x01102030, 0x00ffffff };
+
+    for (int32_t count = 0; count < 40; count++) {
+        // Start one byte in, so the coverage loads aren't aligned either
+        std::vector<uint8_t> coverage = IRandomCoverage(count + 1, count);
+        std::vector<uint32_t> dest = IRandomPixels(count, count + 100);
+
+        for (const Blitter& blitter : blitters) {
+            for (uint32_t color : colors) {
+                std::vector<uint32_t> fpu = dest, sse2 = dest;
+                blitter.fFpu(coverage.data() + 1, fpu.data(), count, color);
+                blitter.fSSE2(coverage.data() + 1, sse2.data(), count, color);
+                EXPECT_EQ(fpu, sse2) << blitter.fName << ", " << count << " pixels, color " << std::hex << color;
+            }
+        }
+    }
+
+    // Every coverage value against every color alpha, for the per-pixel math
+    std::vector<uint8_t> coverage(256);
+    for (size_t i = 0; i < coverage.size(); i++)
+        coverage[i] = uint8_t(i);
+    std::vector<uint32_t> dest = IRandomPixels(coverage.size(), 7);
+    for (const Blitter& blitter : blitters) {
+        for (uint32_t alpha = 0; alpha < 256; alpha++) {
+            uint32_t color = (alpha << 24) | 0x00c08040;
+            std::vector<uint32_t> fpu = dest, sse2 = dest;
+            blitter.fFpu(coverage.data(), fpu.data(), int32_t(coverage.size()), color);
+            blitter.fSSE2(coverage.data(), sse2.data(), int32_t(coverage.size()), color);
+            EXPECT_EQ(fpu, sse2) << blitter.fName << ", color alpha " << alpha;
+        }
+    }
+}
+#endif // HAVE_SSE2
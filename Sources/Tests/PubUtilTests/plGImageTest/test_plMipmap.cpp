@@ -0,0 +1,384 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011 Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsColorRGBA.h"
+#include "hsCpuID.h"
+#include "hsJobSystem.h"
+
+#include "plGImage/plMipmap.h"
+#include "plGImage/plMipmap_Private.h"
+
+typedef std::vector<uint32_t> PixelVec;
+
+static PixelVec IRandomPixels(size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    PixelVec pixels(count);
+    for (uint32_t& px : pixels) {
+        px = rng();
+        // Plenty of clear and opaque pixels for the alpha paths
+        switch (rng() % 4) {
+            case 0: px &= 0x00ffffff; break;
+            case 1: px |= 0xff000000; break;
+        }
+    }
+    return pixels;
+}
+
+static plMipmap* IMakeMipmap(uint32_t width, uint32_t height, uint8_t numLevels, uint32_t seed)
+{
+    plMipmap* mip = new plMipmap(width, height, plMipmap::kARGB32Config, numLevels);
+    PixelVec pixels = IRandomPixels(mip->GetTotalSize() / 4, seed);
+    memcpy(mip->GetImage(), pixels.data(), mip->GetTotalSize());
+    return mip;
+}
+
+static PixelVec ILevelPixels(plMipmap* mip, uint8_t level)
+{
+    uint32_t width, height;
+    const uint32_t* ptr = reinterpret_cast<const uint32_t*>(mip->GetLevelPtr(level, &width, &height));
+    return PixelVec(ptr, ptr + width * height);
+}
+
+// The loops below are the scalar code plMipmap ran before it had row
+// kernels, so the kernels and the job system have to reproduce them exactly.
+
+static void IRefFilter(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight,
+                       uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, uint32_t step, float sig)
+{
+    int ext = std::max(1, (int)(sig * 2.f));
+    float ooSigSq = 1.f / (sig * sig);
+    uint32_t srcRowBytes = srcWidth << 2;
+
+    for (uint32_t i = 0; i < dstHeight; i++) {
+        for (uint32_t j = 0; j < dstWidth; j++) {
+            for (uint32_t chan = 0; chan < 4; chan++) {
+                float w = 0;
+                float a = 0;
+                for (int ii = -ext; ii <= ext; ii++) {
+                    for (int jj = -ext; jj <= ext; jj++) {
+                        int y = int(i * step) + ii;
+                        int x = int(j * step) + jj;
+                        if (y >= 0 && y < int(srcHeight) && x >= 0 && x < int(srcWidth)) {
+                            float m = expf(-(ii * ii + jj * jj) * ooSigSq);
+                            w += m;
+                            a += (float(src[y * srcRowBytes + (x << 2) + chan]) + 0.5f) * m;
+                        }
+                    }
+                }
+                a /= w;
+                dst[i * (dstWidth << 2) + (j << 2) + chan] = (uint8_t)a;
+            }
+        }
+    }
+}
+
+static void IRefScale(const uint32_t* src, uint32_t srcWidth, uint32_t srcHeight,
+                      uint32_t* dest, uint16_t destWidth, uint16_t destHeight)
+{
+    float destToSrcXScale = (float)srcWidth / (float)destWidth;
+    float destToSrcYScale = (float)srcHeight / (float)destHeight;
+    float filterWidth = std::max(1.f, destToSrcXScale);
+    float filterHeight = std::max(1.f, destToSrcYScale);
+
+    for (uint16_t destY = 0; destY < destHeight; destY++) {
+        float srcPosY = destY * destToSrcYScale;
+        int16_t srcStartY = std::max<int16_t>(0, (int16_t)(srcPosY - filterHeight));
+        int16_t srcEndY = std::min<int16_t>((int16_t)(srcHeight - 1), (int16_t)(srcPosY + filterHeight));
+
+        for (uint16_t destX = 0; destX < destWidth; destX++) {
+            float srcPosX = destX * destToSrcXScale;
+            int16_t srcStartX = std::max<int16_t>(0, (int16_t)(srcPosX - filterWidth));
+            int16_t srcEndX = std::min<int16_t>((int16_t)(srcWidth - 1), (int16_t)(srcPosX + filterWidth));
+
+            hsColorRGBA color, accumColor;
+            accumColor.Set(0.f, 0.f, 0.f, 0.f);
+            float totalWeight = 0.f;
+            for (int srcY = srcStartY; srcY <= srcEndY; srcY++) {
+                float whyWait = 1.f - (fabs((float)srcY - srcPosY) / filterHeight);
+                if (whyWait <= 0.f)
+                    continue;
+                for (int srcX = srcStartX; srcX <= srcEndX; srcX++) {
+                    float weight = 1.f - (fabs((float)srcX - srcPosX) / filterWidth);
+                    weight *= whyWait;
+                    if (weight > 0.f) {
+                        color.FromARGB32(src[srcY * srcWidth + srcX]);
+                        color *= weight;
+                        accumColor += color;
+                        totalWeight += weight;
+                    }
+                }
+            }
+            accumColor *= 1.f / totalWeight;
+            *dest++ = accumColor.ToARGB32();
+        }
+    }
+}
+
+static uint32_t IRefBlend(uint32_t src, uint32_t dst, uint8_t opacity, const float* tints, bool writeAlpha)
+{
+    if (!(src >> 24))
+        return dst;
+
+    uint32_t srcAlpha = opacity * ((src >> 16) & 0x0000ff00) / 255 / 256;
+    uint32_t oneMinusAlpha = 256 - srcAlpha;
+    uint32_t r = (uint32_t)(((src >> 16) & 0xff) * tints[0]);
+    uint32_t g = (uint32_t)(((src >> 8) & 0xff) * tints[1]);
+    uint32_t b = (uint32_t)((src & 0xff) * tints[2]);
+    r = ((r * srcAlpha) >> 8) + ((((dst >> 16) & 0xff) * oneMinusAlpha) >> 8);
+    g = ((g * srcAlpha) >> 8) + ((((dst >> 8) & 0xff) * oneMinusAlpha) >> 8);
+    b = ((b * srcAlpha) >> 8) + (((dst & 0xff) * oneMinusAlpha) >> 8);
+
+    uint32_t result = (r << 16) | (g << 8) | b | (dst & 0xff000000);
+    if (writeAlpha)
+        result = (result & 0x00ffffff) | (srcAlpha << 24);
+    return result;
+}
+
+static uint32_t IRefPremultiply(uint32_t px, uint32_t alpha)
+{
+    return (alpha << 24)
+        | (((((px >> 16) & 0xff) * alpha + 127) / 255) << 16)
+        | (((((px >> 8) & 0xff) * alpha + 127) / 255) << 8)
+        | ((((px & 0xff) * alpha + 127) / 255));
+}
+
+static uint32_t IRefMask(uint32_t src, uint32_t dst, uint8_t opacity, bool premultiplied)
+{
+    uint32_t srcAlpha = opacity * ((src >> 16) & 0x0000ff00) / 255 / 256;
+    if (srcAlpha == 0)
+        return dst;
+    if (premultiplied)
+        return IRefPremultiply(src, srcAlpha);
+    return (src & 0x00ffffff) | (srcAlpha << 24);
+}
+
+//// The public API against the reference /////////////////////////////////////
+
+static void ICheckFilter(uint32_t width, uint32_t height, float sig)
+{
+    plMipmap* mip = IMakeMipmap(width, height, 1, width * height);
+    PixelVec expected(width * height);
+    IRefFilter(mip->GetLevelPtr(0), width, height, reinterpret_cast<uint8_t*>(expected.data()), width, height, 1, sig);
+
+    mip->Filter(sig);
+    EXPECT_EQ(expected, ILevelPixels(mip, 0)) << width << "x" << height << " sigma " << sig;
+    delete mip;
+}
+
+static void ICheckMipLevels(uint32_t width, uint32_t height, float sig)
+{
+    plMipmap* top = IMakeMipmap(width, height, 1, width + height);
+    plMipmap* mip = new plMipmap(top, sig, 0, 0.f, 0.f, 0.f, 0.f);
+
+    PixelVec expected = ILevelPixels(top, 0);
+    for (uint8_t level = 1; level < mip->GetNumLevels(); level++) {
+        uint32_t srcWidth = width >> (level - 1), srcHeight = height >> (level - 1);
+        PixelVec next((srcWidth >> 1) * (srcHeight >> 1));
+        IRefFilter(reinterpret_cast<const uint8_t*>(expected.data()), srcWidth, srcHeight,
+                   reinterpret_cast<uint8_t*>(next.data()), srcWidth >> 1, srcHeight >> 1, 2, sig);
+        expected.swap(next);
+        EXPECT_EQ(expected, ILevelPixels(mip, level)) << width << "x" << height << " level " << int(level);
+    }
+    delete mip;
+    delete top;
+}
+
+static void ICheckScale(uint32_t width, uint32_t height, uint16_t destWidth, uint16_t destHeight)
+{
+    plMipmap* mip = IMakeMipmap(width, height, 1, destWidth * destHeight);
+    PixelVec expected(destWidth * destHeight), scaled(destWidth * destHeight);
+    IRefScale(reinterpret_cast<const uint32_t*>(mip->GetImage()), width, height, expected.data(), destWidth, destHeight);
+
+    mip->ScaleNicely(scaled.data(), destWidth, destHeight, destWidth, plMipmap::kDefaultFilter);
+    EXPECT_EQ(expected, scaled) << width << "x" << height << " to " << destWidth << "x" << destHeight;
+    delete mip;
+}
+
+static void ICheckComposite(uint16_t flags, uint8_t opacity, float red, float green, float blue)
+{
+    const uint32_t width = 96, height = 64, srcWidth = 51, srcHeight = 37;
+    const uint16_t x = 17, y = 9;
+    plMipmap* dst = IMakeMipmap(width, height, 1, flags + opacity);
+    plMipmap* src = IMakeMipmap(srcWidth, srcHeight, 1, flags * opacity);
+    const float tints[] = { red, green, blue };
+
+    PixelVec expected = ILevelPixels(dst, 0);
+    const uint32_t* srcPixels = reinterpret_cast<const uint32_t*>(src->GetImage());
+    for (uint32_t row = 0; row < srcHeight; row++) {
+        for (uint32_t col = 0; col < srcWidth; col++) {
+            uint32_t s = srcPixels[row * srcWidth + col];
+            uint32_t& d = expected[(row + y) * width + col + x];
+            if (flags & plMipmap::kCopySrcAlpha)
+                d = (flags & plMipmap::kDestPremultiplied) ? IRefPremultiply(s, s >> 24) : s;
+            else if (flags & plMipmap::kMaskSrcAlpha)
+                d = IRefMask(s, d, opacity, (flags & plMipmap::kDestPremultiplied) != 0);
+            else
+                d = IRefBlend(s, d, opacity, tints, (flags & plMipmap::kBlendWriteAlpha) != 0);
+        }
+    }
+
+    plMipmap::CompositeOptions options(flags, 0, red, green, blue, 0, 0, 0, 0, opacity);
+    dst->Composite(src, x, y, &options);
+    EXPECT_EQ(expected, ILevelPixels(dst, 0)) << "flags " << flags << " opacity " << int(opacity);
+    delete src;
+    delete dst;
+}
+
+static void ICheckAll()
+{
+    for (float sig : { 0.5f, 1.f, 2.3f }) {
+        ICheckFilter(1, 1, sig);
+        ICheckFilter(37, 5, sig);
+        ICheckFilter(64, 48, sig);
+        ICheckMipLevels(64, 32, sig);
+        ICheckMipLevels(8, 8, sig);
+    }
+
+    ICheckScale(64, 64, 64, 64);
+    ICheckScale(64, 64, 17, 29);
+    ICheckScale(37, 5, 100, 33);
+    ICheckScale(200, 120, 3, 1);
+
+    for (uint8_t opacity : { 255, 140, 0 }) {
+        ICheckComposite(0, opacity, 1.f, 1.f, 1.f);
+        ICheckComposite(0, opacity, 0.25f, 0.9f, 0.f);
+        ICheckComposite(0, opacity, 1.5f, 1.f, 1.f);
+        ICheckComposite(plMipmap::kBlendWriteAlpha, opacity, 1.f, 0.5f, 1.f);
+        ICheckComposite(plMipmap::kMaskSrcAlpha, opacity, 1.f, 1.f, 1.f);
+        ICheckComposite(plMipmap::kMaskSrcAlpha | plMipmap::kDestPremultiplied, opacity, 1.f, 1.f, 1.f);
+        ICheckComposite(plMipmap::kCopySrcAlpha | plMipmap::kDestPremultiplied, opacity, 1.f, 1.f, 1.f);
+    }
+}
+
+TEST(plMipmap, matches_reference)
+{
+    ICheckAll();
+}
+
+TEST(plMipmap, matches_reference_on_job_system)
+{
+    hsJobSystem::Initialize();
+    ICheckAll();
+
+    // Big enough to be split into bands of rows
+    ICheckFilter(512, 256, 1.f);
+    ICheckMipLevels(512, 256, 1.f);
+    ICheckScale(512, 512, 400, 300);
+    hsJobSystem::Shutdown();
+}
+
+TEST(plMipmap, detail_blend)
+{
+    // Mult fades each level toward white by the detail alpha, which runs from
+    // detailMax at the start of the dropoff to detailMin at its end
+    plMipmap* top = IMakeMipmap(32, 32, 1, 7);
+    plMipmap* mip = new plMipmap(top, 1.f, plMipmap::kCreateDetailMult, 0.f, 1.f, 1.f, 0.f);
+    plMipmap* plain = new plMipmap(top, 1.f, 0, 0.f, 0.f, 0.f, 0.f);
+
+    for (uint8_t level = 0; level < mip->GetNumLevels(); level++) {
+        float detailAlpha = level * (0.f - 1.f) / (1.f * mip->GetNumLevels()) + 1.f;
+        float invDetailAlpha = (1.f - detailAlpha) * 255.f;
+        PixelVec expected = ILevelPixels(plain, level);
+        for (uint32_t& px : expected) {
+            uint8_t* chan = reinterpret_cast<uint8_t*>(&px);
+            for (int i = 0; i < 4; i++)
+                chan[i] = (uint8_t)(invDetailAlpha + (float)chan[i] * detailAlpha);
+        }
+        EXPECT_EQ(expected, ILevelPixels(mip, level)) << "level " << int(level);
+    }
+    delete plain;
+    delete mip;
+    delete top;
+}
+
+//// Each SIMD kernel against its scalar version //////////////////////////////
+
+#ifdef HAVE_SSE2
+TEST(plMipmap, sse2_kernels)
+{
+    if (!hsCpuId::Instance().has_sse2)
+        GTEST_SKIP();
+
+    const float tintSets[][3] = { { 1.f, 1.f, 1.f }, { 0.3f, 0.7f, 1.f }, { 2.f, 1.f, 0.5f } };
+    for (uint32_t count = 0; count < 40; count++) {
+        PixelVec src = IRandomPixels(count, count), dst = IRandomPixels(count, count + 100);
+
+        for (uint8_t opacity : { 255, 90 }) {
+            for (const float* tints : tintSets) {
+                for (bool writeAlpha : { false, true }) {
+                    PixelVec fpu = dst, sse2 = dst;
+                    plMipmapKernels::blend_row_fpu(fpu.data(), src.data(), count, opacity, tints, writeAlpha);
+                    plMipmapKernels::blend_row_sse2(sse2.data(), src.data(), count, opacity, tints, writeAlpha);
+                    EXPECT_EQ(fpu, sse2) << "blend_row, " << count << " pixels";
+                }
+            }
+            for (bool premultiplied : { false, true }) {
+                PixelVec fpu = dst, sse2 = dst;
+                plMipmapKernels::mask_row_fpu(fpu.data(), src.data(), count, opacity, premultiplied);
+                plMipmapKernels::mask_row_sse2(sse2.data(), src.data(), count, opacity, premultiplied);
+                EXPECT_EQ(fpu, sse2) << "mask_row, " << count << " pixels";
+            }
+        }
+
+        PixelVec fpu = src, sse2 = src;
+        plMipmapKernels::premultiply_row_fpu(fpu.data(), count);
+        plMipmapKernels::premultiply_row_sse2(sse2.data(), count);
+        EXPECT_EQ(fpu, sse2) << "premultiply_row, " << count << " pixels";
+
+        for (uint32_t chanMask : { 0x8, 0x7, 0xf }) {
+            fpu = src;
+            sse2 = src;
+            plMipmapKernels::detail_row_fpu(reinterpret_cast<uint8_t*>(fpu.data()), count, 0.37f, 160.65f, chanMask);
+            plMipmapKernels::detail_row_sse2(reinterpret_cast<uint8_t*>(sse2.data()), count, 0.37f, 160.65f, chanMask);
+            EXPECT_EQ(fpu, sse2) << "detail_row, " << count << " pixels";
+        }
+    }
+}
+#endif // HAVE_SSE2
@@ -0,0 +1,139 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#ifndef _plBenchmark_h_
+#define _plBenchmark_h_
+
+#include "HeadSpin.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <type_traits>
+
+// Timing and reporting shared by the benchmark tools in Sources/Tools.
+namespace plBenchmark
+{
+    using Clock = std::chrono::steady_clock;
+
+    /** Run \a fn \a count times and return how long that took in all.
+     *  \a fn may take the pass number, or nothing at all.
+     */
+    template <typename _Fn>
+    Clock::duration TimeTotal(uint32_t count, _Fn&& fn)
+    {
+        auto begin = Clock::now();
+        for (uint32_t i = 0; i < count; ++i) {
+            if constexpr (std::is_invocable_v<_Fn, uint32_t>)
+                fn(i);
+            else
+                fn();
+        }
+        return Clock::now() - begin;
+    }
+
+    /** Run \a fn \a count times and return how long one pass took on average. */
+    template <typename _Fn>
+    Clock::duration Time(uint32_t count, _Fn&& fn)
+    {
+        return TimeTotal(count, std::forward<_Fn>(fn)) / std::max<uint32_t>(count, 1);
+    }
+
+    inline int64_t Microseconds(Clock::duration elapsed)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    }
+
+    inline double Milliseconds(Clock::duration elapsed)
+    {
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+
+    /** How long each of \a items took, in nanoseconds. */
+    inline double Nanoseconds(Clock::duration elapsed, size_t items)
+    {
+        return std::chrono::duration<double, std::nano>(elapsed).count() / items;
+    }
+
+    /** How many times faster \a elapsed is than \a base. */
+    inline double Speedup(Clock::duration elapsed, Clock::duration base)
+    {
+        return double(base.count()) / double(elapsed.count());
+    }
+
+    /** "name: 123 us per pass" */
+    inline void PrintResult(const char* name, Clock::duration elapsed)
+    {
+        ST::printf("{>22}: {} us per pass\n", name, Microseconds(elapsed));
+    }
+
+    /** "name: 123 us per pass (4.5 ns per item)" */
+    inline void PrintResult(const char* name, Clock::duration elapsed, size_t items, const char* item)
+    {
+        ST::printf("{>22}: {} us per pass ({.1f} ns per {})\n", name, Microseconds(elapsed),
+                   Nanoseconds(elapsed, items), item);
+    }
+
+    /** "name: 123 us per pass (1.50x)", against a \a base timing */
+    inline void PrintSpeedup(const char* name, Clock::duration elapsed, Clock::duration base)
+    {
+        ST::printf("{>22}: {} us per pass ({.2f}x)\n", name, Microseconds(elapsed), Speedup(elapsed, base));
+    }
+
+    /** "name: 123 us per pass (4.50 ns per item, 1.50x)", against a \a base timing */
+    inline void PrintSpeedup(const char* name, Clock::duration elapsed, size_t items, const char* item,
+                             Clock::duration base)
+    {
+        ST::printf("{>22}: {} us per pass ({.2f} ns per {}, {.2f}x)\n", name, Microseconds(elapsed),
+                   Nanoseconds(elapsed, items), item, Speedup(elapsed, base));
+    }
+
+    /** "name: 123 us per pass (456.7 MiB/s)" */
+    inline void PrintRate(const char* name, Clock::duration elapsed, size_t bytes)
+    {
+        double mibps = (double(bytes) / (1024.0 * 1024.0)) / std::chrono::duration<double>(elapsed).count();
+        ST::printf("{>22}: {} us per pass ({.1f} MiB/s)\n", name, Microseconds(elapsed), mibps);
+    }
+}
+
+#endif // _plBenchmark_h_
@@ -0,0 +1,287 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <cstring>
+#include <set>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsColorRGBA.h"
+#include "hsCpuID.h"
+#include "hsJobSystem.h"
+#include "hsResMgr.h"
+#include "plCmdParser.h"
+#include "plFileSystem.h"
+
+#include "pnKeyedObject/plKey.h"
+#include "plGImage/hsCodecManager.h"
+#include "plGImage/hsDXTSoftwareCodec.h"
+#include "plGImage/hsDXTSoftwareCodec_Private.h"
+#include "plGImage/plMipmap.h"
+#include "plResMgr/plRegistryHelpers.h"
+#include "plResMgr/plRegistryNode.h"
+#include "plResMgr/plResManager.h"
+#include "plResMgr/plResMgrSettings.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgPages,
+    kArgCount,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeString | kCmdArgRequired), "pages", kArgPages },
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+};
+
+//// plMipmapCollector ////////////////////////////////////////////////////////
+//  Page iterator that collects all the plMipmaps in all of our pages
+
+class plMipmapCollector : public plRegistryPageIterator, public plKeyCollector
+{
+public:
+    plMipmapCollector(std::set<plKey>& keyArray)
+                : plKeyCollector(keyArray) {}
+
+    bool EatPage(plRegistryPageNode* page) override
+    {
+        if (page->IsValid()) {
+            page->LoadKeys();
+            return page->IterateKeys(this, plMipmap::Index());
+        } else {
+            ST::printf(stderr, "INVALID PAGE: {}\n", page->GetPagePath());
+            return true;
+        }
+    }
+};
+
+struct Kernel
+{
+    const char* fName;
+    bool fSupported;
+    hsDXTSoftwareCodecKernels::decode_blocks_ptr fDXT1, fDXT5;
+    hsDXTSoftwareCodecKernels::find_endpoints_ptr fEndpoints;
+    plBenchmark::Clock::duration fDecode, fEndpointTime;
+    size_t fMismatches;
+};
+
+// Decodes the top level of mip with each kernel in turn, checking each against
+// the FPU result, then times the endpoint search over the decoded blocks
+static void IRunKernels(Kernel* kernels, plMipmap* mip, uint32_t count)
+{
+    uint32_t blocksWide = mip->GetWidth() >> 2;
+    uint32_t blocksHigh = mip->GetHeight() >> 2;
+    uint32_t blockSize = mip->fDirectXInfo.fBlockSize;
+    bool dxt5 = mip->fDirectXInfo.fCompressionType == plMipmap::DirectXInfo::kDXT5;
+    const uint8_t* src = mip->GetLevelPtr(0);
+
+    std::vector<uint32_t> ref(size_t(mip->GetWidth()) * mip->GetHeight());
+    std::vector<uint32_t> pixels(ref.size());
+    for (size_t i = 0; kernels[i].fName; ++i) {
+        if (!kernels[i].fSupported)
+            continue;
+        hsDXTSoftwareCodecKernels::decode_blocks_ptr decode = dxt5 ? kernels[i].fDXT5 : kernels[i].fDXT1;
+        if (!decode)
+            continue;
+        std::vector<uint32_t>& dest = (i == 0) ? ref : pixels;
+        kernels[i].fDecode += plBenchmark::TimeTotal(count, [&]() {
+            for (uint32_t row = 0; row < blocksHigh; ++row)
+                decode(src + row * blocksWide * blockSize, &dest[row * 4 * mip->GetWidth()], blocksWide, mip->GetWidth());
+        });
+        if (i != 0 && ref != pixels)
+            kernels[i].fMismatches++;
+    }
+
+    // The compressor's input, block by block and column by column
+    std::vector<hsRGBAColor32> blocks(ref.size());
+    for (uint32_t b = 0; b < blocksWide * blocksHigh; ++b) {
+        uint32_t x = (b % blocksWide) * 4, y = (b / blocksWide) * 4;
+        for (uint32_t xx = 0; xx < 4; ++xx)
+            for (uint32_t yy = 0; yy < 4; ++yy)
+                memcpy(&blocks[b * 16 + xx * 4 + yy], &ref[(y + yy) * mip->GetWidth() + x + xx], sizeof(uint32_t));
+    }
+
+    std::vector<hsRGBAColor32> refEnds(blocksWide * blocksHigh * 2), ends(refEnds.size());
+    for (size_t i = 0; kernels[i].fName; ++i) {
+        if (!kernels[i].fSupported || !kernels[i].fEndpoints)
+            continue;
+        std::vector<hsRGBAColor32>& dest = (i == 0) ? refEnds : ends;
+        kernels[i].fEndpointTime += plBenchmark::TimeTotal(count, [&]() {
+            for (size_t b = 0; b < blocksWide * blocksHigh; ++b)
+                kernels[i].fEndpoints(&blocks[b * 16], dest[b * 2], dest[b * 2 + 1]);
+        });
+        if (i != 0 && memcmp(refEnds.data(), ends.data(), ends.size() * sizeof(hsRGBAColor32)) != 0)
+            kernels[i].fMismatches++;
+    }
+}
+
+// The whole codec, every level, the way the client calls it
+static void IRunCodec(const std::vector<plMipmap*>& mips, uint32_t count, plBenchmark::Clock::duration& decode, plBenchmark::Clock::duration& encode)
+{
+    for (plMipmap* mip : mips) {
+        plMipmap* uncompressed = nullptr;
+        decode += plBenchmark::TimeTotal(count, [&]() {
+            delete uncompressed;
+            uncompressed = hsCodecManager::Instance().CreateUncompressedMipmap(mip, hsCodecManager::k32BitDepth);
+        });
+        encode += plBenchmark::TimeTotal(count, [&]() {
+            delete hsCodecManager::Instance().CreateCompressedMipmap(plMipmap::kDirectXCompression, uncompressed);
+        });
+        delete uncompressed;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    if (!parser.Parse(args)) {
+        ST::printf(stderr, "Usage: plDXTBenchmark <page.prp|age directory> [-Count <passes>]\n");
+        return 1;
+    }
+
+    uint32_t count = 5;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetUint(kArgCount);
+    if (count == 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    plResMgrSettings::Get().SetFilterNewerPageVersions(false);
+    plResMgrSettings::Get().SetFilterOlderPageVersions(false);
+
+    plResManager* rm = new plResManager();
+    hsgResMgr::Init(rm);
+
+    plFileName path = parser.GetString(kArgPages);
+    if (plFileInfo(path).IsDirectory()) {
+        for (const plFileName& page : plFileSystem::ListDir(path, "*.prp"))
+            rm->AddSinglePage(page);
+    } else {
+        rm->AddSinglePage(path);
+    }
+
+    std::set<plKey> keys;
+    plMipmapCollector collector(keys);
+    rm->IterateAllPages(&collector);
+
+    // Only DXT textures the software codec can do the whole of
+    std::vector<plMipmap*> mips;
+    size_t numPixels = 0;
+    for (const plKey& key : keys) {
+        plMipmap* mip = plMipmap::ConvertNoRef(key->VerifyLoaded());
+        if (!mip || !mip->IsCompressed() || ((mip->GetWidth() | mip->GetHeight()) & 3))
+            continue;
+        if (mip->fDirectXInfo.fCompressionType != plMipmap::DirectXInfo::kDXT1 &&
+            mip->fDirectXInfo.fCompressionType != plMipmap::DirectXInfo::kDXT5)
+            continue;
+        key->RefObject();
+        mips.push_back(mip);
+        numPixels += size_t(mip->GetWidth()) * mip->GetHeight();
+    }
+    if (mips.empty()) {
+        ST::printf(stderr, "No DXT textures found in {}\n", path);
+        hsgResMgr::Shutdown();
+        return 1;
+    }
+    ST::printf("{} DXT textures, {.1f} megapixels in their top levels, {} passes\n\n",
+               mips.size(), numPixels / 1000000.0, count);
+
+    const hsCpuId& cpu = hsCpuId::Instance();
+    Kernel kernels[] = {
+        { "FPU", true, &hsDXTSoftwareCodecKernels::decode_dxt1_to32_fpu, &hsDXTSoftwareCodecKernels::decode_dxt5_to32_fpu,
+          &hsDXTSoftwareCodecKernels::find_endpoints_fpu },
+#ifdef HAVE_SSE2
+        { "SSE2", cpu.has_sse2, nullptr, nullptr, &hsDXTSoftwareCodecKernels::find_endpoints_sse2 },
+#endif
+#ifdef HAVE_AVX2
+        { "AVX2", cpu.has_avx2, &hsDXTSoftwareCodecKernels::decode_dxt1_to32_avx2, &hsDXTSoftwareCodecKernels::decode_dxt5_to32_avx2,
+          nullptr },
+#endif
+        { nullptr, false, nullptr, nullptr, nullptr }
+    };
+    for (plMipmap* mip : mips)
+        IRunKernels(kernels, mip, count);
+
+    ST::printf("Kernels, top levels only, one thread:\n");
+    for (size_t i = 0; kernels[i].fName; ++i) {
+        if (!kernels[i].fSupported)
+            continue;
+        ST::printf("{>14}:", kernels[i].fName);
+        if (kernels[i].fDXT1)
+            ST::printf(" decode {.3f} ms,", plBenchmark::Milliseconds(kernels[i].fDecode) / count);
+        if (kernels[i].fEndpoints)
+            ST::printf(" endpoints {.3f} ms,", plBenchmark::Milliseconds(kernels[i].fEndpointTime) / count);
+        ST::printf(" {} mismatched\n", kernels[i].fMismatches);
+    }
+
+    plBenchmark::Clock::duration serialDecode{}, serialEncode{}, parallelDecode{}, parallelEncode{};
+    IRunCodec(mips, count, serialDecode, serialEncode);
+    hsJobSystem::Initialize();
+    IRunCodec(mips, count, parallelDecode, parallelEncode);
+    hsJobSystem::Shutdown();
+
+    ST::printf("\nhsCodecManager, every level:\n");
+    ST::printf("{>14}: decode {.3f} ms, encode {.3f} ms\n", "One thread",
+               plBenchmark::Milliseconds(serialDecode) / count, plBenchmark::Milliseconds(serialEncode) / count);
+    ST::printf("{>14}: decode {.3f} ms, encode {.3f} ms\n", "Job system",
+               plBenchmark::Milliseconds(parallelDecode) / count, plBenchmark::Milliseconds(parallelEncode) / count);
+
+    for (plMipmap* mip : mips)
+        mip->GetKey()->UnRefObject();
+    mips.clear();
+    keys.clear();
+
+    plIndirectUnloadIterator iter;
+    rm->IterateAllPages(&iter);
+    hsgResMgr::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,311 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <algorithm>
+#include <random>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsGeometry3.h"
+#include "plCmdParser.h"
+
+#include "plDrawable/plAccessGeometry.h"
+#include "plDrawable/plAccessSpan.h"
+#include "plDrawable/plAuxSpan.h"
+#include "plDrawable/plCutter.h"
+#include "plDrawable/plDynaDecal.h"
+#include "plDrawable/plGeometrySpan.h"
+#include "plSurface/hsGMaterial.h"
+#include "plSurface/plLayer.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgCount,
+    kArgGrid,
+    kArgPrints,
+    kArgDecals,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+    { (kCmdTypeUint | kCmdArgFlagged), "Grid", kArgGrid },
+    { (kCmdTypeUint | kCmdArgFlagged), "Prints", kArgPrints },
+    { (kCmdTypeUint | kCmdArgFlagged), "Decals", kArgDecals },
+};
+
+// A flat, square patch of ground 1 foot per quad, like a courtyard floor.
+static void IMakeGround(plGeometrySpan& span, uint32_t gridSize)
+{
+    const uint32_t numSide = gridSize + 1;
+
+    span.fFormat = plGeometrySpan::UVCountToFormat(1);
+    span.fNumVerts = numSide * numSide;
+    span.fNumIndices = gridSize * gridSize * 6;
+
+    uint32_t stride = plGeometrySpan::GetVertexSize(span.fFormat);
+    span.fVertexData = new uint8_t[span.fNumVerts * stride];
+    span.fIndexData = new uint16_t[span.fNumIndices];
+    span.fDiffuseRGBA = new uint32_t[span.fNumVerts];
+    span.fSpecularRGBA = new uint32_t[span.fNumVerts];
+
+    uint8_t* vtx = span.fVertexData;
+    for (uint32_t y = 0; y < numSide; ++y)
+    {
+        for (uint32_t x = 0; x < numSide; ++x)
+        {
+            hsPoint3* pos = reinterpret_cast<hsPoint3*>(vtx);
+            pos->Set(float(x), float(y), 0.f);
+            hsVector3* norm = reinterpret_cast<hsVector3*>(vtx + sizeof(hsPoint3));
+            norm->Set(0.f, 0.f, 1.f);
+            hsPoint3* uvw = reinterpret_cast<hsPoint3*>(vtx + sizeof(hsPoint3) + sizeof(hsVector3));
+            uvw->Set(float(x) / gridSize, float(y) / gridSize, 0.f);
+            vtx += stride;
+
+            span.fDiffuseRGBA[y * numSide + x] = 0xffffffff;
+            span.fSpecularRGBA[y * numSide + x] = 0;
+        }
+    }
+
+    uint16_t* idx = span.fIndexData;
+    for (uint32_t y = 0; y < gridSize; ++y)
+    {
+        for (uint32_t x = 0; x < gridSize; ++x)
+        {
+            uint16_t v = uint16_t(y * numSide + x);
+            *idx++ = v;
+            *idx++ = v + 1;
+            *idx++ = v + numSide + 1;
+            *idx++ = v;
+            *idx++ = v + numSide + 1;
+            *idx++ = v + numSide;
+        }
+    }
+
+    span.fLocalToWorld.Reset();
+    span.fWorldToLocal.Reset();
+    hsPoint3 corners[2] = { hsPoint3(0.f, 0.f, -1.f), hsPoint3(float(gridSize), float(gridSize), 1.f) };
+    span.fLocalBounds.Reset(2, corners);
+    span.fWorldBounds = span.fLocalBounds;
+}
+
+// The cutter only wants to know whether layer 0 is alpha blended.
+class plBenchMaterial : public hsGMaterial
+{
+public:
+    using hsGMaterial::InsertLayer;
+};
+
+// Just enough access to age a splot without a whole decal manager behind it.
+class plBenchSplot : public plDynaSplot
+{
+public:
+    void Init(plAuxSpan* aux, plDecalVtxFormat* vtxBase, uint16_t startVtx, uint16_t numVerts, double birth)
+    {
+        fAuxSpan = aux;
+        fVtxBase = vtxBase;
+        fStartVtx = startVtx;
+        fNumVerts = numVerts;
+        fStartIdx = 0;
+        fNumIdx = 0;
+        fBirth = birth;
+        fInitAtten = 1.f;
+        fFlags = kFresh;
+    }
+
+    void Rebirth(double t) { fBirth = t; fFlags = kFresh; }
+
+    bool TestAndClearDirty()
+    {
+        bool dirty = (fFlags & kDirty) != 0;
+        fFlags &= ~kDirty;
+        return dirty;
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    int32_t count = 10;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetInt(kArgCount);
+    if (count <= 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    // Indices are 16 bit, so the patch can't get much past 255 quads a side
+    uint32_t gridSize = 128;
+    if (parser.IsSpecified(kArgGrid))
+        gridSize = std::clamp<uint32_t>(parser.GetUint(kArgGrid), 2, 255);
+
+    uint32_t numPrints = 1000;
+    if (parser.IsSpecified(kArgPrints))
+        numPrints = std::max<uint32_t>(parser.GetUint(kArgPrints), 1);
+
+    uint32_t numDecals = 2000;
+    if (parser.IsSpecified(kArgDecals))
+        numDecals = std::max<uint32_t>(parser.GetUint(kArgDecals), 1);
+
+    plLayer* layer = new plLayer;
+    plBenchMaterial* mat = new plBenchMaterial;
+    mat->InsertLayer(layer);
+
+    plGeometrySpan ground;
+    IMakeGround(ground, gridSize);
+    ground.fMaterial = mat;
+
+    plAccessGeometry accGeom;
+    plAccessSpan src;
+    accGeom.AccessSpanFromGeometrySpan(src, &ground);
+
+    // Footprint sized cutters scattered over the patch, facing every which way
+    struct Print { hsPoint3 fPos; hsVector3 fDir; };
+    std::vector<Print> prints(numPrints);
+    std::mt19937 rng(0x5eed);
+    std::uniform_real_distribution<float> posDist(1.f, float(gridSize) - 1.f);
+    std::uniform_real_distribution<float> dirDist(-1.f, 1.f);
+    for (Print& print : prints)
+    {
+        print.fPos.Set(posDist(rng), posDist(rng), 0.f);
+        print.fDir.Set(dirDist(rng), dirDist(rng), 0.f);
+        if (print.fDir.MagnitudeSquared() < 0.01f)
+            print.fDir.Set(1.f, 0.f, 0.f);
+        print.fDir.Normalize();
+    }
+
+    plCutter cutter;
+    cutter.SetLength(hsVector3(1.f, 1.5f, 1.f));
+    const hsVector3 up(0.f, 0.f, 1.f);
+
+    ST::printf("Cutting {} prints into {} triangles, aging {} decals...\n",
+               numPrints, gridSize * gridSize * 2, numDecals);
+
+    std::vector<plCutoutPoly> dst;
+    size_t directPolys = 0;
+    auto direct = plBenchmark::Time(count, [&]() {
+        directPolys = 0;
+        for (const Print& print : prints)
+        {
+            dst.clear();
+            cutter.Set(print.fPos, print.fDir, up);
+            cutter.Cutout(src, dst);
+            directPolys += dst.size();
+        }
+    });
+
+    // Building the cache is part of the price, so it's inside the timing
+    plCutoutCache cache;
+    size_t cachedPolys = 0;
+    auto cached = plBenchmark::Time(count, [&]() {
+        cache.Build(src);
+        cachedPolys = 0;
+        for (const Print& print : prints)
+        {
+            dst.clear();
+            cutter.Set(print.fPos, print.fDir, up);
+            cutter.Cutout(cache, dst);
+            cachedPolys += dst.size();
+        }
+    });
+
+    // A steady population of 8 vertex splots with births spread across the
+    // lifespan, aged at 60Hz. Dead ones are reborn right away.
+    const uint16_t kVertsPerDecal = 8;
+    const float kLife = 30.f;
+    const float kRamp = kLife * 0.1f;
+    const float kDecay = kLife * 0.5f;
+    const uint32_t kFrames = 60;
+
+    // The decals all share one set of original UVWs (fStartVtx is only 16
+    // bits), but each writes its own verts.
+    plAuxSpan aux{};
+    aux.fOrigUVW.resize(kVertsPerDecal, hsPoint3(0.5f, 0.5f, 1.f));
+    std::vector<plDecalVtxFormat> verts(size_t(numDecals) * kVertsPerDecal);
+    std::vector<plBenchSplot> decals(numDecals);
+    for (uint32_t i = 0; i < numDecals; ++i)
+    {
+        decals[i].Init(&aux, &verts[size_t(i) * kVertsPerDecal], 0, kVertsPerDecal,
+                       -kLife * float(i) / float(numDecals));
+    }
+
+    double t = 0.;
+    uint64_t decalFrames = 0;
+    uint64_t dirtyFrames = 0;
+    auto fade = plBenchmark::Time(count, [&]() {
+        for (uint32_t frame = 0; frame < kFrames; ++frame)
+        {
+            t += 1. / 60.;
+            for (plBenchSplot& decal : decals)
+            {
+                if (decal.Age(t, kRamp, kDecay, kLife))
+                    decal.Rebirth(t);
+                else if (decal.TestAndClearDirty())
+                    ++dirtyFrames;
+                ++decalFrames;
+            }
+        }
+    });
+
+    ST::printf("\nResults (average of {} passes):\n", count);
+    plBenchmark::PrintResult("Cutout", direct, numPrints, "print");
+    plBenchmark::PrintResult("Cached", cached, numPrints, "print");
+    plBenchmark::PrintResult("Fade", fade, numDecals * kFrames, "decal frame");
+    ST::printf("\n{} polys direct, {} polys cached{}\n", directPolys, cachedPolys,
+               directPolys == cachedPolys ? "" : " (MISMATCH)");
+    ST::printf("{.1f}% of decal frames touched their verts\n",
+               100. * double(dirtyFrames) / double(std::max<uint64_t>(decalFrames, 1)));
+
+    delete mat;
+    delete layer;
+
+    return directPolys == cachedPolys ? 0 : 1;
+}
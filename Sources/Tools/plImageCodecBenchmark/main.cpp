@@ -0,0 +1,270 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsJobSystem.h"
+#include "hsStream.h"
+#include "plCmdParser.h"
+
+#include "plGImage/plImageCodecService.h"
+#include "plGImage/plJPEG.h"
+#include "plGImage/plMipmap.h"
+#include "plGImage/plPNG.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgSize,
+    kArgCount,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Size", kArgSize },
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+};
+
+// Something with the smooth gradients and fine noise of a screenshot, so the
+// codecs do a realistic amount of work
+static plMipmap* IMakeImage(uint32_t width, uint32_t height, uint32_t seed)
+{
+    plMipmap* mip = new plMipmap(width, height, plMipmap::kRGB32Config, 1);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> noise(-12, 12);
+    float phase = float(seed);
+    for (uint32_t y = 0; y < height; ++y) {
+        uint32_t* row = mip->GetAddr32(0, y);
+        for (uint32_t x = 0; x < width; ++x) {
+            int r = int(128.f + 100.f * sinf(x * 0.011f + phase)) + noise(rng);
+            int g = int(128.f + 100.f * sinf(y * 0.017f + phase * 0.5f)) + noise(rng);
+            int b = int(128.f + 100.f * sinf((x + y) * 0.007f)) + noise(rng);
+            row[x] = 0xff000000 | (uint32_t(std::clamp(r, 0, 255)) << 16)
+                   | (uint32_t(std::clamp(g, 0, 255)) << 8) | uint32_t(std::clamp(b, 0, 255));
+        }
+    }
+    return mip;
+}
+
+struct Result
+{
+    const char* fName;
+    plBenchmark::Clock::duration fElapsed;
+};
+
+static void IPrint(const Result& result, uint32_t count, uint32_t width, uint32_t height)
+{
+    double ms = plBenchmark::Milliseconds(result.fElapsed);
+    double mpixels = double(width) * height * count / 1000000.0;
+    ST::printf("{>32}: {.3f} ms/image, {.1f} MPixel/s\n", result.fName, ms / count, mpixels / (ms / 1000.0));
+}
+
+// Codes every image in turn on this thread, through each of the entry points
+static void IRunSerial(const std::vector<plMipmap*>& images, const std::vector<std::vector<uint8_t>>& jpegs,
+                       const std::vector<std::vector<uint8_t>>& pngs)
+{
+    const uint32_t count = uint32_t(images.size());
+    const uint32_t width = images[0]->GetWidth(), height = images[0]->GetHeight();
+    plJPEG& jpeg = plJPEG::Instance();
+    plPNG& png = plPNG::Instance();
+    jpeg.SetWriteQuality(70);
+
+    ST::printf("\nOne thread, {} images of {}x{}:\n", count, width, height);
+
+    IPrint({ "JPEG encode, stream", plBenchmark::TimeTotal(count, [&](uint32_t i) {
+        hsRAMStream stream;
+        jpeg.WriteToStream(&stream, images[i]);
+    }) }, count, width, height);
+
+    IPrint({ "JPEG encode, memory", plBenchmark::TimeTotal(count, [&](uint32_t i) {
+        std::vector<uint8_t> data;
+        jpeg.WriteToMemory(data, images[i]);
+    }) }, count, width, height);
+
+    // What a vault image node used to do: copy the blob into a stream first
+    IPrint({ "JPEG decode, stream", plBenchmark::TimeTotal(count, [&](uint32_t i) {
+        hsRAMStream stream;
+        stream.WriteLE32(uint32_t(jpegs[i].size()));
+        stream.Write(uint32_t(jpegs[i].size()), jpegs[i].data());
+        stream.Rewind();
+        delete jpeg.ReadFromStream(&stream);
+    }) }, count, width, height);
+
+    IPrint({ "JPEG decode, memory", plBenchmark::TimeTotal(count, [&](uint32_t i) {
+        delete jpeg.ReadFromMemory(jpegs[i].data(), jpegs[i].size());
+    }) }, count, width, height);
+
+    for (uint8_t scale : { 2, 4, 8 }) {
+        ST::string name = ST::format("JPEG decode, memory, 1/{} scale", scale);
+        IPrint({ name.c_str(), plBenchmark::TimeTotal(count, [&](uint32_t i) {
+            delete jpeg.ReadFromMemory(jpegs[i].data(), jpegs[i].size(), scale);
+        }) }, count, width, height);
+    }
+
+    IPrint({ "PNG encode, stream", plBenchmark::TimeTotal(count, [&](uint32_t i) {
+        hsRAMStream stream;
+        png.WriteToStream(&stream, images[i]);
+    }) }, count, width, height);
+
+    IPrint({ "PNG encode, memory", plBenchmark::TimeTotal(count, [&](uint32_t i) {
+        std::vector<uint8_t> data;
+        png.WriteToMemory(data, images[i]);
+    }) }, count, width, height);
+
+    IPrint({ "PNG decode, stream", plBenchmark::TimeTotal(count, [&](uint32_t i) {
+        hsRAMStream stream;
+        stream.Write(uint32_t(pngs[i].size()), pngs[i].data());
+        stream.Rewind();
+        delete png.ReadFromStream(&stream);
+    }) }, count, width, height);
+
+    IPrint({ "PNG decode, memory", plBenchmark::TimeTotal(count, [&](uint32_t i) {
+        delete png.ReadFromMemory(pngs[i].data(), pngs[i].size());
+    }) }, count, width, height);
+}
+
+// Queues every image on plImageCodecService at once, then waits for all of
+// the callbacks, the way a KI folder full of images would
+static void IRunService(const std::vector<plMipmap*>& images, const std::vector<std::vector<uint8_t>>& jpegs,
+                        const std::vector<std::vector<uint8_t>>& pngs)
+{
+    const uint32_t count = uint32_t(images.size());
+    const uint32_t width = images[0]->GetWidth(), height = images[0]->GetHeight();
+    hsJobSystem& jobs = hsJobSystem::Instance();
+    uint32_t failures = 0;
+
+    ST::printf("\nplImageCodecService, {} workers:\n", jobs.GetNumWorkers());
+
+    auto runBatch = [&](const char* name, auto&& submit) {
+        std::vector<hsJobHandle> handles;
+        auto begin = plBenchmark::Clock::now();
+        for (uint32_t i = 0; i < count; ++i)
+            handles.emplace_back(submit(i));
+        jobs.Wait(handles);
+        IPrint({ name, plBenchmark::Clock::now() - begin }, count, width, height);
+    };
+    auto decoded = [&failures](plMipmap* mipmap) {
+        if (!mipmap)
+            failures++;
+        delete mipmap;
+    };
+    auto encoded = [&failures](std::vector<uint8_t> data) {
+        if (data.empty())
+            failures++;
+    };
+
+    runBatch("JPEG encode", [&](uint32_t i) {
+        return plImageCodecService::Encode(plImageCodecService::kJPEG, images[i], encoded);
+    });
+    runBatch("JPEG decode", [&](uint32_t i) {
+        return plImageCodecService::Decode(plImageCodecService::kJPEG, jpegs[i], decoded);
+    });
+    runBatch("JPEG decode, 1/4 scale", [&](uint32_t i) {
+        return plImageCodecService::Decode(plImageCodecService::kJPEG, jpegs[i], decoded, 4);
+    });
+    runBatch("PNG encode", [&](uint32_t i) {
+        return plImageCodecService::Encode(plImageCodecService::kPNG, images[i], encoded);
+    });
+    runBatch("PNG decode", [&](uint32_t i) {
+        return plImageCodecService::Decode(plImageCodecService::kPNG, pngs[i], decoded);
+    });
+
+    if (failures)
+        ST::printf("{} requests FAILED\n", failures);
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    if (!parser.Parse(args)) {
+        ST::printf(stderr, "Usage: plImageCodecBenchmark [-Size <pixels>] [-Count <images>]\n");
+        return 1;
+    }
+
+    // Default to the size of a KI picture
+    uint32_t size = 800;
+    if (parser.IsSpecified(kArgSize))
+        size = parser.GetUint(kArgSize);
+    if (size < 8 || size > 4096) {
+        ST::printf(stderr, "Size must be from 8 to 4096.\n");
+        return 1;
+    }
+
+    uint32_t count = 16;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetUint(kArgCount);
+    if (count == 0) {
+        ST::printf(stderr, "Cannot code less than 1 image.\n");
+        return 1;
+    }
+
+    std::vector<plMipmap*> images;
+    std::vector<std::vector<uint8_t>> jpegs(count), pngs(count);
+    plJPEG::Instance().SetWriteQuality(70);
+    for (uint32_t i = 0; i < count; ++i) {
+        images.push_back(IMakeImage(size, size * 3 / 4, i));
+        plJPEG::Instance().WriteToMemory(jpegs[i], images[i]);
+        plPNG::Instance().WriteToMemory(pngs[i], images[i]);
+    }
+
+    IRunSerial(images, jpegs, pngs);
+
+    hsJobSystem::Initialize();
+    IRunService(images, jpegs, pngs);
+    hsJobSystem::Shutdown();
+
+    for (plMipmap* image : images)
+        delete image;
+
+    return 0;
+}
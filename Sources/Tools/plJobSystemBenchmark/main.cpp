@@ -0,0 +1,164 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <atomic>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsJobSystem.h"
+#include "plCmdParser.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgCount,
+    kArgJobs,
+    kArgWorkers,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+    { (kCmdTypeUint | kCmdArgFlagged), "Jobs", kArgJobs },
+    { (kCmdTypeUint | kCmdArgFlagged), "Workers", kArgWorkers },
+};
+
+// A small, fixed amount of work, so the overhead numbers mean something
+static uint32_t IBusyWork(uint32_t seed)
+{
+    for (int i = 0; i < 64; ++i)
+        seed = seed * 1664525u + 1013904223u;
+    return seed;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    int32_t count = 10;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetInt(kArgCount);
+    if (count <= 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    uint32_t numJobs = 100000;
+    if (parser.IsSpecified(kArgJobs))
+        numJobs = parser.GetUint(kArgJobs);
+    if (numJobs == 0) {
+        ST::printf(stderr, "Need at least one job.\n");
+        return 1;
+    }
+
+    size_t numWorkers = 0;
+    if (parser.IsSpecified(kArgWorkers))
+        numWorkers = parser.GetUint(kArgWorkers);
+
+    hsJobSystem jobs(numWorkers);
+    ST::printf("Running {} jobs on {} workers...\n", numJobs, jobs.GetNumWorkers());
+
+    std::atomic<uint32_t> sink(0);
+
+    auto serial = plBenchmark::Time(count, [&]() {
+        uint32_t total = 0;
+        for (uint32_t i = 0; i < numJobs; ++i)
+            total += IBusyWork(i);
+        sink += total;
+    });
+
+    // Everything submitted from outside the pool, round robin across the queues
+    auto spawn = plBenchmark::Time(count, [&]() {
+        std::vector<hsJobHandle> handles;
+        handles.reserve(numJobs);
+        for (uint32_t i = 0; i < numJobs; ++i)
+            handles.push_back(jobs.Submit([&sink, i]() { sink += IBusyWork(i); }));
+        jobs.Wait(handles);
+    });
+
+    // One worker spawns everything into its own queue; the rest have to steal
+    auto steal = plBenchmark::Time(count, [&]() {
+        std::vector<hsJobHandle> handles;
+        hsJobHandle root = jobs.Submit([&]() {
+            handles.reserve(numJobs);
+            for (uint32_t i = 0; i < numJobs; ++i)
+                handles.push_back(jobs.Submit([&sink, i]() { sink += IBusyWork(i); }));
+        });
+        jobs.Wait(root);
+        jobs.Wait(handles);
+    });
+
+    // Every job waits on the one before it, so this is pure scheduling latency
+    uint32_t chainLength = std::min<uint32_t>(numJobs, 10000);
+    auto chain = plBenchmark::Time(count, [&]() {
+        hsJobHandle prev;
+        for (uint32_t i = 0; i < chainLength; ++i)
+            prev = jobs.Submit([&sink, i]() { sink += IBusyWork(i); }, { prev });
+        jobs.Wait(prev);
+    });
+
+    auto parallelFor = plBenchmark::Time(count, [&]() {
+        jobs.ParallelFor(0, numJobs, 256, [&sink](size_t begin, size_t end) {
+            uint32_t total = 0;
+            for (size_t i = begin; i < end; ++i)
+                total += IBusyWork(uint32_t(i));
+            sink += total;
+        });
+    });
+
+    ST::printf("\nResults (average of {} passes):\n", count);
+    plBenchmark::PrintResult("Serial", serial, numJobs, "job");
+    plBenchmark::PrintResult("Spawn", spawn, numJobs, "job");
+    plBenchmark::PrintResult("Steal", steal, numJobs, "job");
+    plBenchmark::PrintResult("Chain", chain, chainLength, "job");
+    plBenchmark::PrintResult("ParallelFor", parallelFor, numJobs, "job");
+    ST::printf("\n(checksum {})\n", sink.load());
+
+    return 0;
+}
@@ -43,24 +43,44 @@ You can contact Cyan Worlds, Inc. by email legal@cyan.com
 #include <chrono>
 #include <string_theory/stdio>
 
+#include "hsJobSystem.h"
 #include "plCmdParser.h"
 #include "plFileSystem.h"
 
+#include "pfLocalizationMgr/pfLocalizationDataMgr.h"
 #include "pfLocalizationMgr/pfLocalizationMgr.h"
 
 enum CmdLineArgs
 {
     kArgCount,
+    kArgLookups,
+    kArgCache,
     kArgDirectory,
 };
 
 static const plCmdArgDef s_cmdLineArgs[] = {
     { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+    { (kCmdTypeUint | kCmdArgFlagged), "Lookups", kArgLookups },
+    { (kCmdTypeString | kCmdArgFlagged), "Cache", kArgCache },
     { (kCmdTypeString | kCmdArgOptional), "Directory", kArgDirectory },
 };
 
 using ClockT = std::chrono::steady_clock;
 
+static void PrintTime(const char* label, ClockT::duration elapsed)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+    auto sec = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed);
+    ST::printf("{}: {.4f} seconds ({} us)\n", label, sec.count(), us.count());
+}
+
+static void PrintLookups(const char* label, ClockT::duration elapsed, int32_t lookups)
+{
+    auto ns = std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(elapsed);
+    double perSec = lookups / std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+    ST::printf("{}: {.1f} ns per lookup ({.0f} lookups/sec)\n", label, ns.count() / lookups, perSec);
+}
+
 int main(int argc, char* argv[])
 {
     std::vector<ST::string> args;
@@ -89,30 +109,85 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    int32_t lookups = 1000000;
+    if (parser.IsSpecified(kArgLookups))
+        lookups = parser.GetInt(kArgLookups);
+
+    // With a cache, the first iteration parses the XML and writes it, and the rest load it
+    plFileName cacheFile;
+    if (parser.IsSpecified(kArgCache)) {
+        cacheFile = parser.GetString(kArgCache);
+        plFileSystem::Unlink(cacheFile);
+    }
+
+    hsJobSystem::Initialize();
+
     ST::printf("Parsing the localization database from '{}'...\n", locDir);
 
     auto elapsed = ClockT::duration::zero();
+    auto first = ClockT::duration::zero();
     for (int32_t i = 0; i < count; ++i) {
         ST::printf("\r... Running iteration {} of {}", i + 1, count);
         auto begin = ClockT::now();
-        pfLocalizationMgr::Initialize(locDir);
+        pfLocalizationMgr::Initialize(locDir, cacheFile);
         auto end = ClockT::now();
         elapsed += end - begin;
+        if (i == 0)
+            first = end - begin;
 
         // Who cares how long this takes...
-        pfLocalizationMgr::Shutdown();
+        if (i + 1 < count)
+            pfLocalizationMgr::Shutdown();
     }
 
     ST::printf("\n... Done!\n\n");
 
-    auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
-    auto avg_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed / count);
-    auto total_sec = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed);
-    auto avg_sec = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed / count);
-
     ST::printf("Results:\n");
-    ST::printf("Total: {.4f} seconds ({} us)\n", total_sec.count(), total_us.count());
-    ST::printf("Average: {.4f} seconds ({} us)\n", avg_sec.count(), avg_us.count());
+    PrintTime("Total", elapsed);
+    PrintTime("Average", elapsed / count);
+    if (cacheFile.IsValid() && count > 1) {
+        PrintTime("First (no cache)", first);
+        PrintTime("Average (cached)", (elapsed - first) / (count - 1));
+    }
+
+    // Look up every string in the database round robin, by path and by interned key
+    pfLocalizationDataMgr& data = pfLocalizationDataMgr::Instance();
+    pfLocalizationMgr& mgr = pfLocalizationMgr::Instance();
+    std::vector<ST::string> paths;
+    for (const ST::string& age : data.GetAgeList()) {
+        for (const ST::string& set : data.GetSetList(age)) {
+            for (const ST::string& name : data.GetElementList(age, set))
+                paths.emplace_back(ST::format("{}.{}.{}", age, set, name));
+        }
+    }
+
+    if (lookups > 0 && !paths.empty()) {
+        std::vector<pfLocalizationMgr::Key> keys;
+        keys.reserve(paths.size());
+        for (const ST::string& path : paths)
+            keys.emplace_back(mgr.InternKey(path));
+
+        ST::printf("\nLooking up {} strings {} times...\n", paths.size(), lookups);
+
+        size_t totalSize = 0;
+        auto begin = ClockT::now();
+        for (int32_t i = 0; i < lookups; ++i)
+            totalSize += mgr.GetString(paths[i % paths.size()]).size();
+        auto byPath = ClockT::now() - begin;
+
+        begin = ClockT::now();
+        for (int32_t i = 0; i < lookups; ++i)
+            totalSize += mgr.GetString(keys[i % keys.size()]).size();
+        auto byKey = ClockT::now() - begin;
+
+        PrintLookups("By path", byPath, lookups);
+        PrintLookups("By key", byKey, lookups);
+        ST::printf("({} characters)\n", totalSize);
+    }
+
+    pfLocalizationMgr::Shutdown();
+    hsJobSystem::Shutdown();
+
     ST::printf("Have a nice day!\n");
     return 0;
 }
@@ -0,0 +1,271 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <cmath>
+#include <random>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsBounds.h"
+#include "hsCpuID.h"
+#include "hsGeometry3.h"
+#include "hsMatrix44.h"
+#include "hsMatrix44_Private.h"
+#include "plCmdParser.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgCount,
+    kArgPoints,
+    kArgBounds,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+    { (kCmdTypeUint | kCmdArgFlagged), "Points", kArgPoints },
+    { (kCmdTypeUint | kCmdArgFlagged), "Bounds", kArgBounds },
+};
+
+// Interleaved position, normal and one UVW, like a typical vertex buffer
+struct Vertex
+{
+    hsPoint3    fPos;
+    hsVector3   fNorm;
+    hsPoint3    fUVW;
+};
+
+// Rotated, non-uniformly scaled and moved well away from the origin
+static hsMatrix44 IMakeMatrix(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    hsMatrix44 rotX, rotZ, scale, xlate;
+    rotX.MakeRotateMat(0, unit(rng) * 3.f);
+    rotZ.MakeRotateMat(2, unit(rng) * 3.f);
+    hsVector3 scaleBy(1.5f, 0.75f, 2.f);
+    scale.MakeScaleMat(&scaleBy);
+    hsVector3 moveBy(unit(rng) * 100.f, unit(rng) * 100.f, unit(rng) * 100.f);
+    xlate.MakeTranslateMat(&moveBy);
+    return xlate * rotZ * rotX * scale;
+}
+
+static float IMaxError(const hsScalarTriple& a, const hsScalarTriple& b)
+{
+    return std::max({ std::fabs(a.fX - b.fX), std::fabs(a.fY - b.fY), std::fabs(a.fZ - b.fZ) });
+}
+
+static float IMaxError(const std::vector<hsPoint3>& pts, const std::vector<hsPoint3>& ref)
+{
+    float err = 0.f;
+    for (size_t i = 0; i < pts.size(); ++i)
+        err = std::max(err, IMaxError(pts[i], ref[i]));
+    return err;
+}
+
+static float IMaxError(const std::vector<Vertex>& verts, const std::vector<Vertex>& ref)
+{
+    float err = 0.f;
+    for (size_t i = 0; i < verts.size(); ++i) {
+        err = std::max(err, IMaxError(verts[i].fPos, ref[i].fPos));
+        err = std::max(err, IMaxError(verts[i].fNorm, ref[i].fNorm));
+        err = std::max(err, IMaxError(verts[i].fUVW, ref[i].fUVW));
+    }
+    return err;
+}
+
+static float IMaxError(const std::vector<hsBounds3Ext>& bnds, const std::vector<hsBounds3Ext>& ref)
+{
+    float err = 0.f;
+    for (size_t i = 0; i < bnds.size(); ++i) {
+        err = std::max(err, IMaxError(bnds[i].GetMins(), ref[i].GetMins()));
+        err = std::max(err, IMaxError(bnds[i].GetMaxs(), ref[i].GetMaxs()));
+    }
+    return err;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    int32_t count = 200;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetInt(kArgCount);
+    if (count <= 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    uint32_t numPoints = 20000;
+    if (parser.IsSpecified(kArgPoints))
+        numPoints = parser.GetUint(kArgPoints);
+    uint32_t numBounds = 2000;
+    if (parser.IsSpecified(kArgBounds))
+        numBounds = parser.GetUint(kArgBounds);
+    if (numPoints == 0 || numBounds == 0) {
+        ST::printf(stderr, "Need at least one point and one bounds.\n");
+        return 1;
+    }
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    const hsMatrix44 l2w = IMakeMatrix(rng);
+
+    std::vector<hsPoint3> src(numPoints);
+    for (hsPoint3& pt : src)
+        pt.Set(unit(rng) * 50.f, unit(rng) * 50.f, unit(rng) * 50.f);
+    std::vector<Vertex> srcVerts(numPoints);
+    for (Vertex& vtx : srcVerts) {
+        vtx.fPos.Set(unit(rng) * 50.f, unit(rng) * 50.f, unit(rng) * 50.f);
+        vtx.fNorm.Set(unit(rng), unit(rng), unit(rng));
+        vtx.fUVW.Set(unit(rng), unit(rng), 0.f);
+    }
+
+    // Mostly axis aligned, like the local bounds of drawable spans, with a few
+    // oriented ones mixed in
+    std::vector<hsBounds3Ext> srcBnds(numBounds);
+    for (uint32_t i = 0; i < numBounds; ++i) {
+        hsPoint3 center(unit(rng) * 50.f, unit(rng) * 50.f, unit(rng) * 50.f);
+        hsVector3 size(std::fabs(unit(rng)) + 0.1f, std::fabs(unit(rng)) + 0.1f, std::fabs(unit(rng)) + 0.1f);
+        hsBounds3Ext& bnd = srcBnds[i];
+        bnd.Reset(&center);
+        hsPoint3 corner = center + size;
+        bnd.Union(&corner);
+        if ((i % 8) == 0)
+            bnd.MakeSymmetric(&center);
+        if ((i % 4) == 0)
+            bnd.Transform(&l2w);
+    }
+
+    ST::printf("Transforming {} points and {} bounds...\n", numPoints, numBounds);
+
+    std::vector<hsPoint3> ref(numPoints), pts(numPoints);
+    std::vector<Vertex> refVerts(numPoints), verts(numPoints);
+    std::vector<hsBounds3Ext> refBnds(numBounds), bnds(numBounds);
+    std::vector<const hsBounds3Ext*> srcPtrs(numBounds);
+    std::vector<hsBounds3Ext*> dstPtrs(numBounds);
+    for (uint32_t i = 0; i < numBounds; ++i) {
+        srcPtrs[i] = &srcBnds[i];
+        dstPtrs[i] = &bnds[i];
+    }
+
+    auto perPoint = plBenchmark::Time(count, [&]() {
+        for (uint32_t i = 0; i < numPoints; ++i)
+            ref[i] = l2w * src[i];
+    });
+    auto perVertex = plBenchmark::Time(count, [&]() {
+        for (uint32_t i = 0; i < numPoints; ++i) {
+            refVerts[i] = srcVerts[i];
+            refVerts[i].fPos = l2w * srcVerts[i].fPos;
+            refVerts[i].fNorm = l2w * srcVerts[i].fNorm;
+        }
+    });
+    auto perBounds = plBenchmark::Time(count, [&]() {
+        for (uint32_t i = 0; i < numBounds; ++i) {
+            refBnds[i] = srcBnds[i];
+            refBnds[i].Transform(&l2w);
+        }
+    });
+
+    const hsCpuId& cpu = hsCpuId::Instance();
+    const hsMatrix44Kernels::map_xyz_ptr dispatched = hsMatrix44Kernels::map_xyz.call;
+    struct { const char* fName; bool fSupported; hsMatrix44Kernels::map_xyz_ptr fKernel; } kernels[] = {
+        { "Batch FPU", true, &hsMatrix44Kernels::map_xyz_fpu },
+#ifdef HAVE_SSE2
+        { "Batch SSE2", cpu.has_sse2, &hsMatrix44Kernels::map_xyz_sse2 },
+#endif
+#ifdef HAVE_AVX
+        { "Batch AVX", cpu.has_avx, &hsMatrix44Kernels::map_xyz_avx },
+#endif
+        { nullptr, false, nullptr }
+    };
+
+    ST::printf("\nPacked points (average of {} passes):\n", count);
+    plBenchmark::PrintSpeedup("Per point", perPoint, perPoint);
+    for (size_t i = 0; kernels[i].fName; ++i) {
+        if (!kernels[i].fSupported)
+            continue;
+        hsMatrix44Kernels::map_xyz.call = kernels[i].fKernel;
+        auto elapsed = plBenchmark::Time(count, [&]() { l2w.MapPoints(numPoints, src.data(), pts.data()); });
+        plBenchmark::PrintSpeedup(kernels[i].fName, elapsed, perPoint);
+        ST::printf("{>22}  max error vs per point: {.6f}\n", "", IMaxError(pts, ref));
+    }
+
+    // Position and normal of an interleaved buffer, in place, like plCluster
+    ST::printf("\nInterleaved verts, position and normal:\n");
+    plBenchmark::PrintSpeedup("Per vertex", perVertex, perVertex);
+    for (size_t i = 0; kernels[i].fName; ++i) {
+        if (!kernels[i].fSupported)
+            continue;
+        hsMatrix44Kernels::map_xyz.call = kernels[i].fKernel;
+        auto elapsed = plBenchmark::Time(count, [&]() {
+            verts = srcVerts;
+            l2w.MapPoints(numPoints, &verts[0].fPos, sizeof(Vertex), &verts[0].fPos, sizeof(Vertex));
+            l2w.MapVectors(numPoints, &verts[0].fNorm, sizeof(Vertex), &verts[0].fNorm, sizeof(Vertex));
+        });
+        plBenchmark::PrintSpeedup(kernels[i].fName, elapsed, perVertex);
+        ST::printf("{>22}  max error vs per vertex: {.6f}\n", "", IMaxError(verts, refVerts));
+    }
+
+    ST::printf("\nBounds:\n");
+    plBenchmark::PrintSpeedup("Per bounds", perBounds, perBounds);
+    for (size_t i = 0; kernels[i].fName; ++i) {
+        if (!kernels[i].fSupported)
+            continue;
+        hsMatrix44Kernels::map_xyz.call = kernels[i].fKernel;
+        auto elapsed = plBenchmark::Time(count, [&]() {
+            hsBounds3Ext::TransformBatch(l2w, numBounds, srcPtrs.data(), dstPtrs.data());
+        });
+        plBenchmark::PrintSpeedup(kernels[i].fName, elapsed, perBounds);
+        ST::printf("{>22}  max error vs per bounds: {.6f}\n", "", IMaxError(bnds, refBnds));
+    }
+    hsMatrix44Kernels::map_xyz.call = dispatched;
+
+    return 0;
+}
@@ -0,0 +1,311 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <cstring>
+#include <random>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsCpuID.h"
+#include "hsJobSystem.h"
+#include "plCmdParser.h"
+
+#include "plGImage/plMipmap.h"
+#include "plGImage/plMipmap_Private.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgSize,
+    kArgCount,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Size", kArgSize },
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+};
+
+static plMipmap* IMakeMipmap(uint32_t size, uint8_t numLevels, uint32_t seed)
+{
+    plMipmap* mip = new plMipmap(size, size, plMipmap::kARGB32Config, numLevels);
+    std::mt19937 rng(seed);
+    uint32_t* pixels = reinterpret_cast<uint32_t*>(mip->GetImage());
+    for (uint32_t i = 0; i < mip->GetTotalSize() / 4; ++i) {
+        pixels[i] = rng();
+        // A quarter clear and a quarter opaque, like most decals and UI art
+        switch (i & 3) {
+            case 0: pixels[i] &= 0x00ffffff; break;
+            case 1: pixels[i] |= 0xff000000; break;
+        }
+    }
+    return mip;
+}
+
+static plMipmap* IDuplicate(const plMipmap* mip)
+{
+    plMipmap* copy = new plMipmap(mip->GetWidth(), mip->GetHeight(), plMipmap::kARGB32Config, mip->GetNumLevels());
+    memcpy(copy->GetImage(), mip->GetImage(), mip->GetTotalSize());
+    return copy;
+}
+
+//// Kernels //////////////////////////////////////////////////////////////////
+
+struct Kernel
+{
+    const char* fName;
+    bool fSupported;
+    plMipmapKernels::filter_row_ptr fFilter;
+    plMipmapKernels::detail_row_ptr fDetail;
+    plMipmapKernels::scale_row_ptr fScale;
+    plMipmapKernels::blend_row_ptr fBlend;
+    plMipmapKernels::mask_row_ptr fMask;
+    plMipmapKernels::premultiply_row_ptr fPremultiply;
+};
+
+enum KernelOps
+{
+    kOpFilter,
+    kOpDetail,
+    kOpScale,
+    kOpBlend,
+    kOpMask,
+    kOpPremultiply,
+    kNumOps
+};
+
+static const char* s_opNames[] = { "filter", "detail", "scale", "blend", "mask", "premultiply" };
+
+// Runs every row of a size x size image through each kernel, checking each
+// implementation's output against the FPU one
+static void IRunKernels(const Kernel* kernels, uint32_t size, uint32_t count)
+{
+    plMipmap* src = IMakeMipmap(size, 1, 1);
+    plMipmap* dst = IMakeMipmap(size, 1, 2);
+    const uint8_t* srcBytes = src->GetLevelPtr(0);
+    const uint32_t* srcPixels = reinterpret_cast<const uint32_t*>(srcBytes);
+    const uint32_t rowBytes = src->GetRowBytes();
+
+    // Gaussian mask at the default sigma of 1, laid out like plFilterMask's
+    const int ext = 2;
+    std::vector<float> maskData((ext * 2 + 1) * (ext * 2 + 1));
+    std::vector<const float*> maskRows(ext * 2 + 1);
+    for (int i = -ext; i <= ext; ++i) {
+        maskRows[i + ext] = &maskData[(i + ext) * (ext * 2 + 1) + ext];
+        for (int j = -ext; j <= ext; ++j)
+            maskData[(i + ext) * (ext * 2 + 1) + j + ext] = expf(-float(i * i + j * j));
+    }
+    const float* const* mask = maskRows.data() + ext;
+
+    // A 2:1 box downsample
+    const uint32_t half = std::max<uint32_t>(1, size >> 1);
+    std::vector<plMipmapKernels::ScaleSpan> spans(half);
+    std::vector<float> weights(half * 5);
+    for (uint32_t x = 0; x < half; ++x) {
+        uint32_t center = x << 1;
+        spans[x].fStart = center >= 2 ? center - 2 : 0;
+        spans[x].fEnd = std::min(size - 1, center + 2);
+        spans[x].fWeights = &weights[x * 5];
+        for (uint32_t s = spans[x].fStart; s <= spans[x].fEnd; ++s)
+            weights[x * 5 + s - spans[x].fStart] = 1.f - fabsf(float(s) - float(center)) / 2.f;
+    }
+
+    const float tints[] = { 1.f, 1.f, 1.f };
+    std::vector<uint32_t> ref(size * size), out(size * size);
+    ST::printf("Kernels, {}x{}, one thread:\n", size, size);
+    for (uint32_t op = 0; op < kNumOps; ++op) {
+        ST::printf("{>12}:", s_opNames[op]);
+        for (size_t k = 0; kernels[k].fName; ++k) {
+            if (!kernels[k].fSupported)
+                continue;
+            const Kernel& kernel = kernels[k];
+            std::vector<uint32_t>& dest = (k == 0) ? ref : out;
+            uint8_t* destBytes = reinterpret_cast<uint8_t*>(dest.data());
+            plBenchmark::Clock::duration elapsed{};
+            for (uint32_t pass = 0; pass < count; ++pass) {
+                memcpy(dest.data(), dst->GetImage(), size * rowBytes);
+                elapsed += plBenchmark::TimeTotal(1, [&]() {
+                    for (uint32_t y = 0; y < size; ++y) {
+                        switch (op) {
+                            case kOpFilter:
+                                kernel.fFilter(destBytes + y * rowBytes, size, srcBytes, rowBytes, size, size, y, 1, mask, ext);
+                                break;
+                            case kOpDetail:
+                                kernel.fDetail(destBytes + y * rowBytes, size, 0.6f, 102.f, 0xf);
+                                break;
+                            case kOpScale:
+                                if (y < half)
+                                    kernel.fScale(&dest[y * half], half, srcPixels, size, spans.data(), spans[y]);
+                                break;
+                            case kOpBlend:
+                                kernel.fBlend(&dest[y * size], &srcPixels[y * size], size, 255, tints, false);
+                                break;
+                            case kOpMask:
+                                kernel.fMask(&dest[y * size], &srcPixels[y * size], size, 200, true);
+                                break;
+                            case kOpPremultiply:
+                                kernel.fPremultiply(&dest[y * size], size);
+                                break;
+                        }
+                    }
+                });
+            }
+            ST::printf(" {} {.3f} ms{}", kernel.fName, plBenchmark::Milliseconds(elapsed) / count,
+                       (k != 0 && ref != out) ? " (MISMATCH)" : "");
+        }
+        ST::printf("\n");
+    }
+
+    delete dst;
+    delete src;
+}
+
+//// Operations ///////////////////////////////////////////////////////////////
+
+struct Operation
+{
+    const char* fName;
+    plBenchmark::Clock::duration fSerial, fParallel;
+};
+
+// The public API the way the client and the exporter call it
+static void IRunOperations(Operation* ops, uint32_t size, uint32_t count, bool parallel)
+{
+    plMipmap* top = IMakeMipmap(size, 1, 3);
+    plMipmap* full = IMakeMipmap(size, 0, 4);
+    plMipmap* decal = IMakeMipmap(size >> 1, 0, 5);
+    std::vector<uint32_t> scaled(size * size);
+
+    auto time = [&](size_t i, auto&& fn) {
+        (parallel ? ops[i].fParallel : ops[i].fSerial) += plBenchmark::TimeTotal(count, fn);
+    };
+
+    time(0, [&]() {
+        plMipmap* copy = IDuplicate(top);
+        copy->Filter(0.f);
+        delete copy;
+    });
+    time(1, [&]() { delete new plMipmap(top, 0.f, 0, 0.f, 0.f, 0.f, 0.f); });
+    time(2, [&]() { delete new plMipmap(top, 0.f, plMipmap::kCreateDetailMult, 0.f, 1.f, 1.f, 0.f); });
+    time(3, [&]() {
+        top->ScaleNicely(scaled.data(), uint16_t(size * 2 / 3), uint16_t(size * 2 / 3), uint16_t(size * 2 / 3),
+                         plMipmap::kDefaultFilter);
+    });
+    time(4, [&]() {
+        plMipmap* copy = IDuplicate(top);
+        copy->ResizeNicely(uint16_t(size / 3), uint16_t(size / 3), plMipmap::kDefaultFilter);
+        delete copy;
+    });
+
+    const uint16_t flags[] = {
+        0, plMipmap::kMaskSrcAlpha | plMipmap::kDestPremultiplied,
+        plMipmap::kCopySrcAlpha | plMipmap::kDestPremultiplied
+    };
+    for (size_t i = 0; i < std::size(flags); ++i) {
+        plMipmap::CompositeOptions options(flags[i], 0, 1.f, 1.f, 1.f, 0, 0, 0, 0, 200);
+        time(5 + i, [&]() { full->Composite(decal, uint16_t(size >> 2), uint16_t(size >> 2), &options); });
+    }
+
+    delete decal;
+    delete full;
+    delete top;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    if (!parser.Parse(args)) {
+        ST::printf(stderr, "Usage: plMipmapBenchmark [-Size <pixels>] [-Count <passes>]\n");
+        return 1;
+    }
+
+    uint32_t size = 1024;
+    if (parser.IsSpecified(kArgSize))
+        size = parser.GetUint(kArgSize);
+    if (size < 4 || size > 4096 || (size & (size - 1))) {
+        ST::printf(stderr, "Size must be a power of two from 4 to 4096.\n");
+        return 1;
+    }
+
+    uint32_t count = 5;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetUint(kArgCount);
+    if (count == 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    const hsCpuId& cpu = hsCpuId::Instance();
+    Kernel kernels[] = {
+        { "FPU", true, &plMipmapKernels::filter_row_fpu, &plMipmapKernels::detail_row_fpu, &plMipmapKernels::scale_row_fpu,
+          &plMipmapKernels::blend_row_fpu, &plMipmapKernels::mask_row_fpu, &plMipmapKernels::premultiply_row_fpu },
+#ifdef HAVE_SSE2
+        { "SSE2", cpu.has_sse2, &plMipmapKernels::filter_row_sse2, &plMipmapKernels::detail_row_sse2, &plMipmapKernels::scale_row_sse2,
+          &plMipmapKernels::blend_row_sse2, &plMipmapKernels::mask_row_sse2, &plMipmapKernels::premultiply_row_sse2 },
+#endif
+        { nullptr, false, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr }
+    };
+    IRunKernels(kernels, size, count);
+
+    Operation ops[] = {
+        { "Filter" }, { "Mip chain" }, { "Detail mult" }, { "ScaleNicely" }, { "ResizeNicely" },
+        { "Blend" }, { "Mask" }, { "Copy" }, { nullptr }
+    };
+    IRunOperations(ops, size, count, false);
+    hsJobSystem::Initialize();
+    IRunOperations(ops, size, count, true);
+    hsJobSystem::Shutdown();
+
+    ST::printf("\nplMipmap, {}x{} source, {} passes:\n", size, size, count);
+    for (size_t i = 0; ops[i].fName; ++i) {
+        ST::printf("{>14}: one thread {.3f} ms, job system {.3f} ms\n", ops[i].fName,
+                   plBenchmark::Milliseconds(ops[i].fSerial) / count, plBenchmark::Milliseconds(ops[i].fParallel) / count);
+    }
+
+    return 0;
+}
@@ -0,0 +1,410 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <set>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsCpuID.h"
+#include "hsFastMath.h"
+#include "hsResMgr.h"
+#include "plCmdParser.h"
+#include "plFileSystem.h"
+
+#include "pnKeyedObject/plKey.h"
+#include "plDrawable/plAccessGeometry.h"
+#include "plDrawable/plAccessSpan.h"
+#include "plDrawable/plGeometrySpan.h"
+#include "plDrawable/plMorphArray.h"
+#include "plDrawable/plMorphDelta_Private.h"
+#include "plDrawable/plMorphSequence.h"
+#include "plDrawable/plSharedMesh.h"
+#include "plResMgr/plRegistryHelpers.h"
+#include "plResMgr/plRegistryNode.h"
+#include "plResMgr/plResManager.h"
+#include "plResMgr/plResMgrSettings.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgPages,
+    kArgCount,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeString | kCmdArgRequired), "pages", kArgPages },
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+};
+
+//// plSharedMeshCollector ////////////////////////////////////////////////////
+//  Page iterator that collects all the plSharedMeshes in all of our pages
+
+class plSharedMeshCollector : public plRegistryPageIterator, public plKeyCollector
+{
+public:
+    plSharedMeshCollector(std::set<plKey>& keyArray)
+                : plKeyCollector(keyArray) {}
+
+    bool EatPage(plRegistryPageNode* page) override
+    {
+        if (page->IsValid()) {
+            page->LoadKeys();
+            return page->IterateKeys(this, plSharedMesh::Index());
+        } else {
+            ST::printf(stderr, "INVALID PAGE: {}\n", page->GetPagePath());
+            return true;
+        }
+    }
+};
+
+// A scratch copy of a shared mesh's vertices, laid out the way
+// plAccessGeometry reads them off the geometry spans.
+struct MeshCopy
+{
+    std::vector<std::vector<uint8_t>>   fVerts;
+    std::vector<plAccessSpan>           fAccess;
+
+    MeshCopy(const plAccessGeometry& accGeom, const plSharedMesh* mesh)
+        : fVerts(mesh->fSpans.size()), fAccess(mesh->fSpans.size())
+    {
+        for (size_t i = 0; i < mesh->fSpans.size(); ++i) {
+            const plGeometrySpan* span = mesh->fSpans[i];
+            uint32_t stride = plGeometrySpan::GetVertexSize(span->fFormat);
+            fVerts[i].resize(size_t(stride) * span->fNumVerts);
+
+            accGeom.AccessSpanFromGeometrySpan(fAccess[i], span);
+            plAccessVtxSpan& vtx = fAccess[i].AccessVtx();
+            uint8_t* ptr = fVerts[i].data();
+            vtx.PositionStream(ptr, uint16_t(stride), 0);
+            ptr += sizeof(hsPoint3);
+            vtx.NormalStream(ptr, uint16_t(stride), 0);
+            ptr += sizeof(hsVector3);
+            vtx.UVWStream(ptr, uint16_t(stride), 0);
+        }
+    }
+
+    MeshCopy(const MeshCopy&) = delete;
+    MeshCopy(MeshCopy&&) = default;
+
+    void Reset(const plSharedMesh* mesh)
+    {
+        for (size_t i = 0; i < mesh->fSpans.size(); ++i)
+            memcpy(fVerts[i].data(), mesh->fSpans[i]->fVertexData, fVerts[i].size());
+    }
+};
+
+struct Morph
+{
+    const plSharedMesh*                 fMesh;
+    std::vector<plAccessSpan>           fBase;
+    MeshCopy                            fRef, fWork;
+    std::vector<std::vector<float>>     fWeights;
+    std::vector<std::vector<float>>     fSummed;
+    std::vector<plMorphAccum>           fSums;
+
+    Morph(const plAccessGeometry& accGeom, const plSharedMesh* mesh)
+        : fMesh(mesh), fBase(mesh->fSpans.size()), fRef(accGeom, mesh), fWork(accGeom, mesh)
+    {
+        for (size_t i = 0; i < mesh->fSpans.size(); ++i)
+            accGeom.AccessSpanFromGeometrySpan(fBase[i], mesh->fSpans[i]);
+    }
+
+    const std::vector<plMorphArray>& Layers() const { return fMesh->fMorphSet->fMorphs; }
+};
+
+// Largest difference from the reference output over everything a morph can move
+static float IMaxError(const std::vector<Morph>& morphs)
+{
+    float err = 0.f;
+    for (const Morph& morph : morphs) {
+        for (size_t i = 0; i < morph.fWork.fAccess.size(); ++i) {
+            const plAccessVtxSpan& work = morph.fWork.fAccess[i].AccessVtx();
+            const plAccessVtxSpan& ref = morph.fRef.fAccess[i].AccessVtx();
+            for (uint32_t v = 0; v < work.VertCount(); ++v) {
+                err = std::max(err, (work.Position(v) - ref.Position(v)).Magnitude());
+                err = std::max(err, (work.Normal(v) - ref.Normal(v)).Magnitude());
+                for (uint16_t c = 0; c < work.NumUVWs(); ++c)
+                    err = std::max(err, (work.UVW(v, c) - ref.UVW(v, c)).Magnitude());
+            }
+        }
+    }
+    return err;
+}
+
+// The way plMorphSequence used to do it: back to the base mesh, every
+// delta added straight into the vertex buffer, then every normal fixed up.
+static void IApplyPerDelta(Morph& morph)
+{
+    morph.fRef.Reset(morph.fMesh);
+    const std::vector<plMorphArray>& layers = morph.Layers();
+    for (size_t i = 0; i < layers.size(); ++i)
+        layers[i].Apply(morph.fRef.fAccess, &morph.fWeights[i]);
+    for (plAccessSpan& span : morph.fRef.fAccess) {
+        plAccessVtxSpan& vtx = span.AccessVtx();
+        for (uint32_t v = 0; v < vtx.VertCount(); ++v)
+            hsFastMath::Normalize(vtx.Normal(v));
+    }
+}
+
+static void IInitSums(Morph& morph)
+{
+    morph.fSums.resize(morph.fMesh->fSpans.size());
+    for (size_t i = 0; i < morph.fSums.size(); ++i) {
+        const plGeometrySpan* span = morph.fMesh->fSpans[i];
+        morph.fSums[i].Reset(span->fNumVerts, span->GetNumUVs());
+    }
+    for (const plMorphArray& layer : morph.Layers()) {
+        for (size_t d = 0; d < layer.GetNumDeltas(); ++d)
+            layer.GetDelta(d).CollectVerts(morph.fSums);
+    }
+    for (plMorphAccum& span : morph.fSums)
+        span.SortVerts();
+}
+
+// Everything summed in one go, then written over the base mesh
+static void IApplySummed(Morph& morph)
+{
+    for (plMorphAccum& span : morph.fSums)
+        std::fill(span.fPosNorm.begin(), span.fPosNorm.end(), 0.f);
+    for (plMorphAccum& span : morph.fSums)
+        std::fill(span.fUVWs.begin(), span.fUVWs.end(), 0.f);
+
+    const std::vector<plMorphArray>& layers = morph.Layers();
+    for (size_t i = 0; i < layers.size(); ++i) {
+        for (size_t d = 0; d < layers[i].GetNumDeltas(); ++d) {
+            float weight = plMorphDelta::ActiveWeight(morph.fWeights[i][d]);
+            if (weight > 0.f)
+                layers[i].GetDelta(d).Accumulate(morph.fSums, weight);
+        }
+    }
+    for (size_t i = 0; i < morph.fSums.size(); ++i)
+        morph.fSums[i].Write(&morph.fBase[i], morph.fWork.fAccess[i]);
+}
+
+struct Drag
+{
+    size_t fMorph, fLayer, fDelta;
+};
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    if (!parser.Parse(args)) {
+        ST::printf(stderr, "Usage: plMorphBenchmark <page.prp|age directory> [-Count <passes>]\n");
+        return 1;
+    }
+
+    int32_t count = 200;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetInt(kArgCount);
+    if (count <= 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    plResMgrSettings::Get().SetFilterNewerPageVersions(false);
+    plResMgrSettings::Get().SetFilterOlderPageVersions(false);
+
+    plResManager* rm = new plResManager();
+    hsgResMgr::Init(rm);
+
+    plFileName path = parser.GetString(kArgPages);
+    if (plFileInfo(path).IsDirectory()) {
+        for (const plFileName& page : plFileSystem::ListDir(path, "*.prp"))
+            rm->AddSinglePage(page);
+    } else {
+        rm->AddSinglePage(path);
+    }
+
+    std::set<plKey> keys;
+    plSharedMeshCollector collector(keys);
+    rm->IterateAllPages(&collector);
+
+    // Only meshes that actually morph, i.e. the avatar faces
+    plAccessGeometry accGeom;
+    std::vector<plSharedMesh*> meshes;
+    std::vector<Morph> morphs;
+    size_t numVerts = 0, numLayers = 0, numDeltas = 0;
+    for (const plKey& key : keys) {
+        plSharedMesh* mesh = plSharedMesh::ConvertNoRef(key->VerifyLoaded());
+        if (!mesh || !mesh->fMorphSet || mesh->fMorphSet->fMorphs.empty())
+            continue;
+        key->RefObject();
+        meshes.push_back(mesh);
+        morphs.emplace_back(accGeom, mesh);
+        for (const plGeometrySpan* span : mesh->fSpans)
+            numVerts += span->fNumVerts;
+        numLayers += mesh->fMorphSet->fMorphs.size();
+        for (const plMorphArray& layer : mesh->fMorphSet->fMorphs)
+            numDeltas += layer.GetNumDeltas();
+    }
+    if (morphs.empty()) {
+        ST::printf(stderr, "No morphing shared meshes found in {}\n", path);
+        hsgResMgr::Shutdown();
+        return 1;
+    }
+
+    // Every slider somewhere along its range, the way a customized avatar would be
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> wgt(0.f, 1.f);
+    std::vector<Drag> drags;
+    for (size_t m = 0; m < morphs.size(); ++m) {
+        const std::vector<plMorphArray>& layers = morphs[m].Layers();
+        morphs[m].fWeights.resize(layers.size());
+        for (size_t i = 0; i < layers.size(); ++i) {
+            for (size_t d = 0; d < layers[i].GetNumDeltas(); ++d) {
+                morphs[m].fWeights[i].push_back(wgt(rng));
+                drags.push_back({ m, i, d });
+            }
+        }
+    }
+
+    ST::printf("Morphing {} shared meshes, {} verts, through {} layers of {} deltas...\n",
+               morphs.size(), numVerts, numLayers, numDeltas);
+
+    auto perDelta = plBenchmark::Time(count, [&]() {
+        for (Morph& morph : morphs)
+            IApplyPerDelta(morph);
+    });
+    ST::printf("\nFull apply of every mesh (average of {} passes):\n", count);
+    plBenchmark::PrintSpeedup("Per delta", perDelta, perDelta);
+
+    for (Morph& morph : morphs) {
+        IInitSums(morph);
+        morph.fWork.Reset(morph.fMesh);
+    }
+
+    const hsCpuId& cpu = hsCpuId::Instance();
+    const plMorphDeltaKernels::accum_deltas_ptr dispatched = plMorphDeltaKernels::accum_deltas.call;
+    struct { const char* fName; bool fSupported; plMorphDeltaKernels::accum_deltas_ptr fKernel; } kernels[] = {
+        { "Summed FPU", true, &plMorphDeltaKernels::accum_deltas_fpu },
+#ifdef HAVE_SSE2
+        { "Summed SSE2", cpu.has_sse2, &plMorphDeltaKernels::accum_deltas_sse2 },
+#endif
+#ifdef HAVE_AVX
+        { "Summed AVX", cpu.has_avx, &plMorphDeltaKernels::accum_deltas_avx },
+#endif
+        { nullptr, false, nullptr }
+    };
+    for (size_t i = 0; kernels[i].fName; ++i) {
+        if (!kernels[i].fSupported)
+            continue;
+        plMorphDeltaKernels::accum_deltas.call = kernels[i].fKernel;
+        auto elapsed = plBenchmark::Time(count, [&]() {
+            for (Morph& morph : morphs)
+                IApplySummed(morph);
+        });
+        plBenchmark::PrintSpeedup(kernels[i].fName, elapsed, perDelta);
+        ST::printf("{>22}  max error vs per delta: {.6f}\n", "", IMaxError(morphs));
+    }
+    plMorphDeltaKernels::accum_deltas.call = dispatched;
+
+    // Dragging a slider: one weight moves per frame. The old path starts over
+    // on that mesh every time, the new one takes the old weight back out and
+    // puts the new one in.
+    std::uniform_int_distribution<size_t> pickDrag(0, drags.size() - 1);
+    std::vector<Drag> script;
+    for (int32_t i = 0; i < count; ++i)
+        script.push_back(drags[pickDrag(rng)]);
+
+    auto dragPerDelta = plBenchmark::Time(1, [&]() {
+        for (const Drag& drag : script) {
+            Morph& morph = morphs[drag.fMorph];
+            morph.fWeights[drag.fLayer][drag.fDelta] = wgt(rng);
+            IApplyPerDelta(morph);
+        }
+    }) / count;
+
+    for (Morph& morph : morphs) {
+        morph.fSummed = morph.fWeights;
+        for (std::vector<float>& layer : morph.fSummed) {
+            for (float& w : layer)
+                w = plMorphDelta::ActiveWeight(w);
+        }
+        IApplySummed(morph);
+    }
+
+    auto dragSummed = plBenchmark::Time(1, [&]() {
+        for (const Drag& drag : script) {
+            Morph& morph = morphs[drag.fMorph];
+            float& target = morph.fWeights[drag.fLayer][drag.fDelta];
+            target = wgt(rng);
+            float weight = plMorphDelta::ActiveWeight(target);
+            float& was = morph.fSummed[drag.fLayer][drag.fDelta];
+            morph.Layers()[drag.fLayer].GetDelta(drag.fDelta).Accumulate(morph.fSums, weight - was);
+            was = weight;
+            for (size_t i = 0; i < morph.fSums.size(); ++i)
+                morph.fSums[i].Write(&morph.fBase[i], morph.fWork.fAccess[i]);
+        }
+    }) / count;
+
+    // Same weights on both sides now, so bring the reference up to date
+    for (Morph& morph : morphs)
+        IApplyPerDelta(morph);
+
+    ST::printf("\nOne weight changed per apply:\n");
+    plBenchmark::PrintSpeedup("Per delta", dragPerDelta, dragPerDelta);
+    plBenchmark::PrintSpeedup("Incremental", dragSummed, dragPerDelta);
+    ST::printf("{>22}  max error vs per delta: {.6f}\n", "", IMaxError(morphs));
+
+    morphs.clear();
+    for (plSharedMesh* mesh : meshes)
+        mesh->GetKey()->UnRefObject();
+    meshes.clear();
+    keys.clear();
+
+    plIndirectUnloadIterator iter;
+    rm->IterateAllPages(&iter);
+    hsgResMgr::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,264 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsCpuID.h"
+#include "plCmdParser.h"
+
+#include "pfMoviePlayer/plPlanarImage.h"
+#include "pfMoviePlayer/plPlanarImage_Private.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+#ifdef USE_WEBM
+#   include <libwebm/mkvreader.hpp>
+#   include <libwebm/mkvparser.hpp>
+
+#   define VPX_CODEC_DISABLE_COMPAT 1
+#   include <vpx/vpx_decoder.h>
+#   include <vpx/vp8dx.h>
+#endif
+
+enum CmdLineArgs
+{
+    kArgMovie,
+    kArgCount,
+    kArgWidth,
+    kArgHeight,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeString | kCmdArgOptional), "movie", kArgMovie },
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+    { (kCmdTypeUint | kCmdArgFlagged), "Width", kArgWidth },
+    { (kCmdTypeUint | kCmdArgFlagged), "Height", kArgHeight },
+};
+
+struct Kernel
+{
+    const char* fName;
+    bool fSupported;
+    plPlanarImageKernels::yuv420_row_ptr fRow;
+    plBenchmark::Clock::duration fElapsed;
+    size_t fMismatches;
+};
+
+// Converts one picture with every kernel, checking each against the FPU result
+static void IConvert(Kernel* kernels, uint32_t w, uint32_t h, const int32_t* stride, uint8_t** planes,
+                     std::vector<uint8_t>& ref, std::vector<uint8_t>& rgba)
+{
+    ref.resize(size_t(w) * h * 4);
+    rgba.resize(ref.size());
+    for (size_t i = 0; kernels[i].fName; ++i) {
+        if (!kernels[i].fSupported)
+            continue;
+        plPlanarImageKernels::yuv420_row.call = kernels[i].fRow;
+        std::vector<uint8_t>& dest = (i == 0) ? ref : rgba;
+        auto begin = plBenchmark::Clock::now();
+        plPlanarImage::Yuv420ToRgba(w, h, stride, planes, dest.data());
+        kernels[i].fElapsed += plBenchmark::Clock::now() - begin;
+        if (i != 0 && memcmp(ref.data(), rgba.data(), ref.size()) != 0)
+            kernels[i].fMismatches++;
+    }
+}
+
+#ifdef USE_WEBM
+// Decodes every picture of the first VP9 track, like plMoviePlayer's decode
+// thread, but without a pipeline or sound to hand them to.
+static bool IDecodeMovie(const ST::string& path, Kernel* kernels, size_t& numFrames, plBenchmark::Clock::duration& decodeTime)
+{
+    mkvparser::MkvReader reader;
+    if (reader.Open(path.c_str()) < 0) {
+        ST::printf(stderr, "Could not open {}\n", path);
+        return false;
+    }
+
+    long long pos = 0;
+    mkvparser::EBMLHeader ebmlHeader;
+    mkvparser::Segment* seg;
+    if (ebmlHeader.Parse(&reader, pos) < 0 || mkvparser::Segment::CreateInstance(&reader, pos, seg) < 0) {
+        ST::printf(stderr, "{} is not a WebM file\n", path);
+        return false;
+    }
+    std::unique_ptr<mkvparser::Segment> segment(seg);
+    if (segment->Load() < 0) {
+        ST::printf(stderr, "Failed to load the segment of {}\n", path);
+        return false;
+    }
+
+    const mkvparser::Track* video = nullptr;
+    const mkvparser::Tracks* tracks = segment->GetTracks();
+    for (unsigned long i = 0; i < tracks->GetTracksCount() && !video; ++i) {
+        const mkvparser::Track* track = tracks->GetTrackByIndex(i);
+        if (track && track->GetType() == mkvparser::Track::kVideo && strcmp(track->GetCodecId(), "V_VP9") == 0)
+            video = track;
+    }
+    if (!video) {
+        ST::printf(stderr, "{} has no VP9 video track\n", path);
+        return false;
+    }
+
+    vpx_codec_ctx_t codec{};
+    if (vpx_codec_dec_init(&codec, vpx_codec_vp9_dx(), nullptr, 0)) {
+        ST::printf(stderr, "Failed to initialize the VP9 decoder\n");
+        return false;
+    }
+
+    std::vector<uint8_t> buf, ref, rgba;
+    const mkvparser::BlockEntry* entry = nullptr;
+    long status = video->GetFirst(entry);
+    while (entry && status == 0) {
+        const mkvparser::Block* block = entry->GetBlock();
+        vpx_image_t* img = nullptr;
+        for (int i = 0; i < block->GetFrameCount(); ++i) {
+            const mkvparser::Block::Frame& frame = block->GetFrame(i);
+            buf.resize(frame.len);
+            frame.Read(&reader, buf.data());
+
+            auto begin = plBenchmark::Clock::now();
+            if (vpx_codec_decode(&codec, buf.data(), static_cast<unsigned int>(buf.size()), nullptr, 0) == VPX_CODEC_OK) {
+                vpx_codec_iter_t iter = nullptr;
+                img = vpx_codec_get_frame(&codec, &iter);
+            }
+            decodeTime += plBenchmark::Clock::now() - begin;
+        }
+
+        if (img && img->fmt == VPX_IMG_FMT_I420) {
+            IConvert(kernels, img->d_w, img->d_h, img->stride, img->planes, ref, rgba);
+            numFrames++;
+        }
+        status = video->GetNext(entry, entry);
+    }
+
+    vpx_codec_destroy(&codec);
+    return true;
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    const hsCpuId& cpu = hsCpuId::Instance();
+    const plPlanarImageKernels::yuv420_row_ptr dispatched = plPlanarImageKernels::yuv420_row.call;
+    Kernel kernels[] = {
+        { "FPU", true, &plPlanarImageKernels::yuv420_row_fpu },
+#ifdef HAVE_SSE2
+        { "SSE2", cpu.has_sse2, &plPlanarImageKernels::yuv420_row_sse2 },
+#endif
+#ifdef HAVE_AVX2
+        { "AVX2", cpu.has_avx2, &plPlanarImageKernels::yuv420_row_avx2 },
+#endif
+        { nullptr, false, nullptr }
+    };
+
+    size_t numFrames = 0;
+    plBenchmark::Clock::duration decodeTime{};
+    if (parser.IsSpecified(kArgMovie)) {
+#ifdef USE_WEBM
+        ST::string path = parser.GetString(kArgMovie);
+        ST::printf("Decoding {}...\n", path);
+        if (!IDecodeMovie(path, kernels, numFrames, decodeTime))
+            return 1;
+        if (numFrames == 0) {
+            ST::printf(stderr, "No I420 pictures were decoded.\n");
+            return 1;
+        }
+#else
+        ST::printf(stderr, "This build has no WebM support; only synthetic pictures can be converted.\n");
+        return 1;
+#endif
+    } else {
+        uint32_t count = 100;
+        if (parser.IsSpecified(kArgCount))
+            count = parser.GetUint(kArgCount);
+        uint32_t w = parser.IsSpecified(kArgWidth) ? parser.GetUint(kArgWidth) : 1920;
+        uint32_t h = parser.IsSpecified(kArgHeight) ? parser.GetUint(kArgHeight) : 1080;
+        if (count == 0 || w == 0 || h == 0) {
+            ST::printf(stderr, "Need at least one picture of at least one pixel.\n");
+            return 1;
+        }
+
+        // Noise, with the chroma rows padded out the way libvpx pads them
+        std::mt19937 rng(12345);
+        int32_t stride[3] = { int32_t((w + 31) & ~31), int32_t(((w + 1) / 2 + 31) & ~31), 0 };
+        stride[2] = stride[1];
+        std::vector<uint8_t> yPlane(size_t(stride[0]) * h), uPlane(size_t(stride[1]) * ((h + 1) / 2)), vPlane(uPlane.size());
+        for (auto plane : { &yPlane, &uPlane, &vPlane })
+            for (uint8_t& px : *plane)
+                px = uint8_t(rng());
+        uint8_t* planes[3] = { yPlane.data(), uPlane.data(), vPlane.data() };
+
+        ST::printf("Converting {} synthetic {}x{} pictures...\n", count, w, h);
+        std::vector<uint8_t> ref, rgba;
+        for (uint32_t i = 0; i < count; ++i)
+            IConvert(kernels, w, h, stride, planes, ref, rgba);
+        numFrames = count;
+    }
+    plPlanarImageKernels::yuv420_row.call = dispatched;
+
+    if (decodeTime.count())
+        ST::printf("\n{>14}: {.3f} ms per picture ({} pictures)\n", "VP9 decode", plBenchmark::Milliseconds(decodeTime) / numFrames, numFrames);
+
+    ST::printf("\nYUV420 to RGBA:\n");
+    for (size_t i = 0; kernels[i].fName; ++i) {
+        if (!kernels[i].fSupported)
+            continue;
+        double speedup = double(kernels[0].fElapsed.count()) / double(kernels[i].fElapsed.count());
+        ST::printf("{>14}: {.3f} ms per picture ({.2f}x), {} mismatched\n", kernels[i].fName,
+                   plBenchmark::Milliseconds(kernels[i].fElapsed) / numFrames, speedup, kernels[i].fMismatches);
+    }
+
+    return 0;
+}
@@ -0,0 +1,280 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsJobSystem.h"
+#include "plCmdParser.h"
+
+#include "plPhysX/plPhysXAPI.h"
+#include "plPhysX/plPXSimDefs.h"
+#include "plPhysX/plPXSimulation.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgFrames,
+    kArgPlatforms,
+    kArgCrates,
+    kArgWork,
+    kArgWorkers,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Frames", kArgFrames },
+    { (kCmdTypeUint | kCmdArgFlagged), "Platforms", kArgPlatforms },
+    { (kCmdTypeUint | kCmdArgFlagged), "Crates", kArgCrates },
+    { (kCmdTypeUint | kCmdArgFlagged), "Work", kArgWork },
+    { (kCmdTypeUint | kCmdArgFlagged), "Workers", kArgWorkers },
+};
+
+// Two of the simulation's substeps per frame
+static constexpr float kFrameTime = 1.f / 60.f;
+
+// How far off a platform may be from where it was told to go and still count
+static constexpr float kTargetTolerance = 0.001f;
+
+// plPXSimulation only makes scenes for actors with a physical behind them;
+// the benchmark's actors are bare, so it puts them in the main world itself.
+class plBenchSimulation : public plPXSimulation
+{
+public:
+    physx::PxScene* GetMainWorld()
+    {
+        physx::PxScene* scene = FindScene(nullptr);
+        return scene ? scene : InitSubworld(nullptr);
+    }
+};
+
+// A floor, a grid of animated (kinematic) platforms bobbing up and down, and
+// a heap of crates dropped on top of them.  This is the shape of the scenes
+// that make the step expensive: a lot of dynamics pushed around by animation.
+struct Scenario
+{
+    plBenchSimulation                   fSim;
+    std::vector<physx::PxRigidDynamic*> fPlatforms;
+    std::vector<float>                  fTargets;   // the height each platform was last told to go to
+    uint32_t                            fLate;      // platforms that weren't there after the step
+
+    Scenario() : fLate() { }
+
+    bool Init(uint32_t numPlatforms, uint32_t numCrates)
+    {
+        if (!fSim.Init())
+            return false;
+
+        physx::PxScene* scene = fSim.GetMainWorld();
+        physx::PxTransform identity(physx::PxIdentity);
+
+        physx::PxRigidActor* floor = fSim.CreateRigidActor(physx::PxBoxGeometry(200.f, 200.f, 1.f),
+                                                           physx::PxTransform(0.f, 0.f, -1.f), identity,
+                                                           0.5f, 0.5f, 0.f, plPXActorType::kStaticActor);
+        plPXFilterData::SetActorGroup(floor, plSimDefs::kGroupStatic);
+        scene->addActor(*floor);
+
+        uint32_t side = std::max(1u, (uint32_t)std::ceil(std::sqrt((float)numPlatforms)));
+        for (uint32_t i = 0; i < numPlatforms; ++i) {
+            physx::PxTransform pose(IGridPos(i, side, 8.f), 1.f);
+            physx::PxRigidActor* actor = fSim.CreateRigidActor(physx::PxBoxGeometry(3.f, 3.f, 0.5f),
+                                                               pose, identity, 0.5f, 0.5f, 0.f,
+                                                               plPXActorType::kKinematicActor);
+            plPXFilterData::SetActorGroup(actor, plSimDefs::kGroupStatic);
+            scene->addActor(*actor);
+            fPlatforms.push_back(actor->is<physx::PxRigidDynamic>());
+            fTargets.push_back(1.f);
+        }
+
+        for (uint32_t i = 0; i < numCrates; ++i) {
+            // Stack them up over the platforms, a layer of one per platform at a time
+            physx::PxVec3 pos = IGridPos(i % numPlatforms, side, 8.f);
+            pos.z = 3.f + 1.5f * (i / numPlatforms);
+            physx::PxRigidActor* actor = fSim.CreateRigidActor(physx::PxBoxGeometry(0.5f, 0.5f, 0.5f),
+                                                               physx::PxTransform(pos), identity,
+                                                               0.5f, 0.5f, 0.f,
+                                                               plPXActorType::kDynamicActor);
+            plPXFilterData::SetActorGroup(actor, plSimDefs::kGroupDynamic);
+            physx::PxRigidBodyExt::updateMassAndInertia(*actor->is<physx::PxRigidDynamic>(), 1.f);
+            scene->addActor(*actor);
+        }
+
+        return true;
+    }
+
+    // What the animation does each frame, in the eval and transform messages
+    void Animate(uint32_t frame)
+    {
+        for (size_t i = 0; i < fPlatforms.size(); ++i) {
+            physx::PxTransform pose = fPlatforms[i]->getGlobalPose();
+            pose.p.z = 1.f + 2.f * std::sin(frame * kFrameTime * 2.f + i * 0.5f);
+            fPlatforms[i]->setKinematicTarget(pose);
+            fTargets[i] = pose.p.z;
+        }
+    }
+
+    // Once a step is finished, every platform should be where this frame's
+    // animation put it.  Anything else got held back to the step after.
+    void CheckPlatforms()
+    {
+        for (size_t i = 0; i < fPlatforms.size(); ++i) {
+            if (std::fabs(fPlatforms[i]->getGlobalPose().p.z - fTargets[i]) > kTargetTolerance)
+                fLate++;
+        }
+    }
+
+private:
+    static physx::PxVec3 IGridPos(uint32_t i, uint32_t side, float spacing)
+    {
+        float offset = (side - 1) * spacing * 0.5f;
+        return physx::PxVec3((i % side) * spacing - offset, (i / side) * spacing - offset, 1.f);
+    }
+};
+
+// Stand-in for the render, which the overlapped step runs alongside
+static void IRenderWork(uint32_t micros)
+{
+    auto end = plBenchmark::Clock::now() + std::chrono::microseconds(micros);
+    while (plBenchmark::Clock::now() < end)
+        ;
+}
+
+// The frame as plClient::IUpdate and IDraw run it, with and without Physics.OverlapStep
+static bool IRunFrames(bool overlap, uint32_t numFrames, uint32_t numPlatforms, uint32_t numCrates,
+                       uint32_t work, plBenchmark::Clock::duration& elapsed, uint32_t& late)
+{
+    Scenario scenario;
+    if (!scenario.Init(numPlatforms, numCrates))
+        return false;
+
+    elapsed = plBenchmark::TimeTotal(numFrames, [&](uint32_t frame) {
+        if (overlap) {
+            // Top of IUpdate: pick up the step that ran during the last render
+            if (frame > 0) {
+                scenario.fSim.EndAdvance();
+                scenario.CheckPlatforms();
+            }
+            scenario.Animate(frame);
+            scenario.fSim.BeginAdvance(kFrameTime, true);
+        } else {
+            scenario.Animate(frame);
+            scenario.fSim.Advance(kFrameTime);
+            scenario.CheckPlatforms();
+        }
+        IRenderWork(work);
+    });
+
+    if (overlap) {
+        scenario.fSim.EndAdvance();
+        scenario.CheckPlatforms();
+    }
+
+    late = scenario.fLate;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    uint32_t numFrames = 600;
+    if (parser.IsSpecified(kArgFrames))
+        numFrames = parser.GetUint(kArgFrames);
+    if (numFrames == 0) {
+        ST::printf(stderr, "Need at least one frame.\n");
+        return 1;
+    }
+
+    uint32_t numPlatforms = 64;
+    if (parser.IsSpecified(kArgPlatforms))
+        numPlatforms = parser.GetUint(kArgPlatforms);
+    if (numPlatforms == 0) {
+        ST::printf(stderr, "Need at least one platform.\n");
+        return 1;
+    }
+
+    uint32_t numCrates = 1024;
+    if (parser.IsSpecified(kArgCrates))
+        numCrates = parser.GetUint(kArgCrates);
+
+    uint32_t work = 4000;
+    if (parser.IsSpecified(kArgWork))
+        work = parser.GetUint(kArgWork);
+
+    size_t numWorkers = 0;
+    if (parser.IsSpecified(kArgWorkers))
+        numWorkers = parser.GetUint(kArgWorkers);
+
+    hsJobSystem::Initialize(numWorkers);
+    ST::printf("Stepping {} platforms and {} crates for {} frames, with {} us of render work per frame on {} workers...\n",
+               numPlatforms, numCrates, numFrames, work, hsJobSystem::Instance().GetNumWorkers());
+
+    plBenchmark::Clock::duration blocking, overlapped;
+    uint32_t blockingLate, overlappedLate;
+    if (!IRunFrames(false, numFrames, numPlatforms, numCrates, work, blocking, blockingLate) ||
+        !IRunFrames(true, numFrames, numPlatforms, numCrates, work, overlapped, overlappedLate)) {
+        ST::printf(stderr, "PhysX failed to initialize.\n");
+        hsJobSystem::Shutdown();
+        return 1;
+    }
+
+    ST::printf("\nResults (per frame, average of {} frames):\n", numFrames);
+    plBenchmark::PrintResult("Blocking", blocking / numFrames);
+    plBenchmark::PrintSpeedup("Overlapped", overlapped / numFrames, blocking / numFrames);
+
+    // Every platform has to be where the frame's animation put it once its step is done
+    ST::printf("\nPlatforms off target after their step: {} blocking, {} overlapped\n",
+               blockingLate, overlappedLate);
+
+    hsJobSystem::Shutdown();
+    return (blockingLate || overlappedLate) ? 1 : 0;
+}
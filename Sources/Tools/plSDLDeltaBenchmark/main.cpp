@@ -0,0 +1,312 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <map>
+#include <memory>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <utility>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "plCmdParser.h"
+#include "hsBitVector.h"
+#include "hsResMgr.h"
+#include "hsStream.h"
+
+#include "pnKeyedObject/plUoid.h"
+
+#include "plNetClientRecorder/plNetClientRecorder.h"
+#include "plNetMessage/plNetMessage.h"
+#include "plResMgr/plResManager.h"
+#include "plSDL/plSDL.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgRecording,
+    kArgSDLDir,
+    kArgQuantum,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeString | kCmdArgRequired), "recording", kArgRecording },
+    { (kCmdTypeString | kCmdArgFlagged), "SDL", kArgSDLDir },
+    { (kCmdTypeFloat | kCmdArgFlagged), "Quantum", kArgQuantum },
+};
+
+struct RecordedState
+{
+    double fTime;
+    ST::string fObject;             // uoid and descriptor, one delta chain per pair
+    std::vector<uint8_t> fStream;   // the state as it was recorded, header included
+};
+
+struct EncodeResult
+{
+    size_t fRawBytes;
+    size_t fWireBytes;
+    uint32_t fMsgs;
+    plBenchmark::Clock::duration fElapsed;
+};
+
+static size_t IWireSize(hsStream* stream)
+{
+    // plNetMsgStreamHelper::Poke zlibs anything past the threshold, so do the same
+    plNetMsgStreamHelper helper;
+    helper.CopyStream(stream);
+    helper.Compress();
+    return helper.GetStreamLen();
+}
+
+static bool IReadRecording(const plFileName& path, bool haveSDL, std::vector<RecordedState>& states,
+                           double& duration, size_t& recordedWireBytes)
+{
+    hsUNIXStream s;
+    if (!s.Open(path, "rb")) {
+        ST::printf(stderr, "Could not open {}\n", path);
+        return false;
+    }
+
+    hsBitVector contentFlags;
+    contentFlags.Read(&s);
+    if (contentFlags.IsBitSet(plNetClientStreamRecorder::kNetClientRecSDLDesc)) {
+        if (haveSDL) {
+            // Skip the recorded descriptors, the parsed ones carry the QUANTIZE steps
+            plSDL::DescriptorList recorded;
+            plSDLMgr::GetInstance()->Read(&s, &recorded);
+            for (plStateDescriptor* sd : recorded)
+                delete sd;
+        } else {
+            plSDLMgr::GetInstance()->Read(&s);
+        }
+    }
+
+    double first = -1.0, last = 0.0;
+    recordedWireBytes = 0;
+    while (!s.AtEnd()) {
+        double time = s.ReadLEDouble();
+        plCreatable* cre = hsgResMgr::ResMgr()->ReadCreatableVersion(&s);
+        plNetMessage* msg = plNetMessage::ConvertNoRef(cre);
+        if (!msg) {
+            ST::printf(stderr, "Unreadable message at {.3f}s, stopping here\n", time);
+            hsRefCnt_SafeUnRef(cre);
+            break;
+        }
+
+        if (first < 0.0)
+            first = time;
+        last = time;
+
+        plNetMsgSDLState* sdlMsg = plNetMsgSDLState::ConvertNoRef(msg);
+        if (sdlMsg && sdlMsg->StreamInfo()->GetStreamLen()) {
+            plNetMsgStreamHelper* info = sdlMsg->StreamInfo();
+            info->Uncompress();
+
+            hsReadOnlyStream stream(info->GetStreamLen(), info->GetStreamBuf());
+            ST::string descName;
+            int ver;
+            if (plStateDataRecord::ReadStreamHeader(&stream, &descName, &ver)) {
+                RecordedState& state = states.emplace_back();
+                state.fTime = time;
+                state.fObject = ST::format("{}|{}", sdlMsg->ObjectInfo()->GetUoid(), descName);
+                state.fStream.assign(info->GetStreamBuf(), info->GetStreamBuf() + info->GetStreamLen());
+
+                hsReadOnlyStream raw(state.fStream.size(), state.fStream.data());
+                recordedWireBytes += IWireSize(&raw);
+            }
+        }
+        hsRefCnt_SafeUnRef(msg);
+    }
+
+    duration = (first < 0.0) ? 0.0 : last - first;
+    return true;
+}
+
+//
+// Replay every state change the way plSDLModifier::SendState would, diffing
+// each object against the last state sent for it.
+//
+static EncodeResult IReencode(const std::vector<RecordedState>& states, bool nestedDeltas)
+{
+    EncodeResult result{};
+    std::map<ST::string, std::pair<std::unique_ptr<plStateDataRecord>, std::unique_ptr<plStateDataRecord>>> objects;
+
+    auto begin = plBenchmark::Clock::now();
+    for (const RecordedState& state : states) {
+        hsReadOnlyStream in(state.fStream.size(), state.fStream.data());
+        ST::string descName;
+        int ver;
+        if (!plStateDataRecord::ReadStreamHeader(&in, &descName, &ver))
+            continue;
+        plStateDescriptor* sd = plSDLMgr::GetInstance()->FindDescriptor(descName, ver);
+        if (!sd)
+            continue;
+
+        plStateDataRecord update(sd);
+        if (!update.Read(&in, 0))
+            continue;
+
+        // first: the sender's full view of the object, second: what it last sent
+        auto& [current, sent] = objects[state.fObject];
+        if (!current || current->GetDescriptor() != sd) {
+            current = std::make_unique<plStateDataRecord>(sd);
+            sent = std::make_unique<plStateDataRecord>(sd);
+        }
+        current->UpdateFrom(update);
+
+        plStateDataRecord next(*current);
+        next.FlagDifferentState(*sent, nestedDeltas);
+        if (!next.IsDirty())
+            continue;
+
+        hsRAMStream out;
+        next.WriteStreamHeader(&out);
+        next.Write(&out, 0, plSDL::kDirtyOnly);
+        result.fRawBytes += out.GetEOF();
+        result.fWireBytes += IWireSize(&out);
+        result.fMsgs++;
+
+        sent->UpdateFrom(next, plSDL::kDirtyOnly);
+    }
+    result.fElapsed = plBenchmark::Clock::now() - begin;
+
+    return result;
+}
+
+static void IPrintResult(const char* name, size_t rawBytes, size_t wireBytes, uint32_t msgs, double duration)
+{
+    double seconds = duration > 0.0 ? duration : 1.0;
+    ST::printf("{>10}: {} msgs, {} bytes raw, {} bytes on the wire ({.1f} B/s)\n",
+               name, msgs, rawBytes, wireBytes, wireBytes / seconds);
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    if (!parser.Parse(args)) {
+        ST::printf(stderr, "Usage: plSDLDeltaBenchmark <recording> [-SDL <dir>] [-Quantum <step>]\n");
+        return 1;
+    }
+
+    float blanketQuantum = 0.f;
+    if (parser.IsSpecified(kArgQuantum))
+        blanketQuantum = parser.GetFloat(kArgQuantum);
+    if (blanketQuantum < 0.f) {
+        ST::printf(stderr, "Quantum cannot be negative.\n");
+        return 1;
+    }
+
+    plResManager* resMgr = new plResManager;
+    hsgResMgr::Init(resMgr);
+
+    bool haveSDL = parser.IsSpecified(kArgSDLDir);
+    if (haveSDL) {
+        plSDLMgr::GetInstance()->SetSDLDir(parser.GetString(kArgSDLDir));
+        if (!plSDLMgr::GetInstance()->Init()) {
+            ST::printf(stderr, "Failed to parse the SDL files in {}\n", parser.GetString(kArgSDLDir));
+            hsgResMgr::Shutdown();
+            return 1;
+        }
+    }
+
+    std::vector<RecordedState> states;
+    double duration;
+    size_t recordedWireBytes;
+    if (!IReadRecording(parser.GetString(kArgRecording), haveSDL, states, duration, recordedWireBytes)) {
+        hsgResMgr::Shutdown();
+        return 1;
+    }
+
+    size_t recordedBytes = 0;
+    for (const RecordedState& state : states)
+        recordedBytes += state.fStream.size();
+    ST::printf("Replaying {} SDL states over {.1f} seconds...\n", states.size(), duration);
+
+    // The baseline is the stock encoding, so pull the .sdl quanta out of the way first
+    std::vector<std::pair<plSimpleVarDescriptor*, float>> quanta;
+    for (plStateDescriptor* sd : *plSDLMgr::GetInstance()->GetDescriptors()) {
+        for (int i = 0; i < sd->GetNumVars(); ++i) {
+            plSimpleVarDescriptor* var = sd->GetVar(i)->GetAsSimpleVarDescriptor();
+            if (!var)
+                continue;
+            switch (var->GetAtomicType()) {
+            case plVarDescriptor::kFloat:
+            case plVarDescriptor::kDouble:
+            case plVarDescriptor::kAgeTimeOfDay:
+                quanta.emplace_back(var, var->GetQuantum());
+                var->SetQuantum(0.f);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    EncodeResult baseline = IReencode(states, false);
+
+    for (auto& [var, quantum] : quanta)
+        var->SetQuantum(quantum > 0.f ? quantum : blanketQuantum);
+    EncodeResult delta = IReencode(states, true);
+
+    ST::printf("\nResults:\n");
+    IPrintResult("Recorded", recordedBytes, recordedWireBytes, uint32_t(states.size()), duration);
+    IPrintResult("Full", baseline.fRawBytes, baseline.fWireBytes, baseline.fMsgs, duration);
+    IPrintResult("Delta", delta.fRawBytes, delta.fWireBytes, delta.fMsgs, duration);
+
+    if (baseline.fWireBytes)
+        ST::printf("\nDelta encoding saves {.1f}% on the wire\n",
+                   100.0 - (100.0 * delta.fWireBytes / baseline.fWireBytes));
+    ST::printf("Encode time: {} us full, {} us delta\n",
+               plBenchmark::Microseconds(baseline.fElapsed),
+               plBenchmark::Microseconds(delta.fElapsed));
+
+    states.clear();
+    plSDLMgr::GetInstance()->DeInit();
+    hsgResMgr::Shutdown();
+    return 0;
+}
@@ -0,0 +1,218 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "plCmdParser.h"
+#include "hsResMgr.h"
+#include "hsStream.h"
+
+#include "plResMgr/plResManager.h"
+#include "plSDL/plSDL.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgCount,
+    kArgDescriptors,
+    kArgMessages,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+    { (kCmdTypeUint | kCmdArgFlagged), "Descriptors", kArgDescriptors },
+    { (kCmdTypeUint | kCmdArgFlagged), "Messages", kArgMessages },
+};
+
+// Each synthetic descriptor comes in this many versions, like the legacy
+// versions kept around in the shipped .sdl files.
+static constexpr int kNumVersions = 3;
+
+static ST::string IDescriptorName(uint32_t idx)
+{
+    // Share long prefixes, the way real descriptor names do (e.g. "avatar", "avatarPhysical")
+    return ST::format("SyntheticAgeState{}", idx);
+}
+
+static plStateDescriptor* IMakeDescriptor(uint32_t idx, int version)
+{
+    plStateDescriptor* sd = new plStateDescriptor;
+    sd->SetName(IDescriptorName(idx));
+    sd->SetVersion(version);
+
+    static const char* types[] = { "INT", "FLOAT", "BOOL", "POINT3", "BYTE" };
+    for (int i = 0; i < 4 + version; ++i) {
+        plSimpleVarDescriptor* var = new plSimpleVarDescriptor;
+        var->SetType(types[(idx + i) % std::size(types)]);
+        var->SetName(ST::format("var{}", i));
+        var->SetCount(1);
+        sd->AddVar(var);
+    }
+    return sd;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    int32_t count = 10;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetInt(kArgCount);
+    if (count <= 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    uint32_t numDescs = 400;
+    if (parser.IsSpecified(kArgDescriptors))
+        numDescs = parser.GetUint(kArgDescriptors);
+    uint32_t numMsgs = 100000;
+    if (parser.IsSpecified(kArgMessages))
+        numMsgs = parser.GetUint(kArgMessages);
+    if (numDescs == 0 || numMsgs == 0) {
+        ST::printf(stderr, "Need at least one descriptor and one message.\n");
+        return 1;
+    }
+
+    plResManager* resMgr = new plResManager;
+    hsgResMgr::Init(resMgr);
+
+    // Load the descriptors through the same path as a descriptor stream from the server
+    ST::printf("Generating {} descriptors ({} versions each)...\n", numDescs, kNumVersions);
+    {
+        plSDL::DescriptorList descs;
+        for (uint32_t i = 0; i < numDescs; ++i) {
+            for (int ver = 1; ver <= kNumVersions; ++ver)
+                descs.push_back(IMakeDescriptor(i, ver));
+        }
+
+        hsRAMStream stream;
+        plSDLMgr::GetInstance()->Write(&stream, &descs);
+        stream.Rewind();
+        plSDLMgr::GetInstance()->Read(&stream);
+
+        for (plStateDescriptor* sd : descs)
+            delete sd;
+    }
+
+    // Mostly latest-version traffic, with some old clients' states mixed in
+    ST::printf("Generating {} SDL state messages...\n", numMsgs);
+    std::vector<std::vector<uint8_t>> msgs(numMsgs);
+    std::vector<ST::string> names(numMsgs);
+    std::vector<int> versions(numMsgs);
+    for (uint32_t i = 0; i < numMsgs; ++i) {
+        uint32_t idx = (i * 2654435761u) % numDescs;
+        int ver = (i % 8 == 0) ? 1 + (i / 8) % (kNumVersions - 1) : kNumVersions;
+        names[i] = IDescriptorName(idx);
+        versions[i] = (i % 2) ? ver : plSDL::kLatestVersion;
+
+        plStateDataRecord rec(names[i], ver);
+        rec.SetFromDefaults(false);
+        for (int v = 0; v < rec.GetNumVars(); ++v)
+            rec.GetVar(v)->SetDirty(true);
+
+        hsRAMStream stream;
+        rec.WriteStreamHeader(&stream);
+        rec.Write(&stream, 0, plSDL::kDirtyOnly);
+        msgs[i].resize(stream.GetEOF());
+        stream.CopyToMem(msgs[i].data());
+    }
+
+    // A private copy of the list takes FindDescriptor down the old linear scan
+    const plSDL::DescriptorList* mgrDescs = plSDLMgr::GetInstance()->GetDescriptors();
+    plSDL::DescriptorList scanList(mgrDescs->begin(), mgrDescs->end());
+
+    uint32_t found = 0;
+    auto scan = plBenchmark::Time(count, [&]() {
+        found = 0;
+        for (uint32_t i = 0; i < numMsgs; ++i) {
+            if (plSDLMgr::GetInstance()->FindDescriptor(names[i], versions[i], &scanList))
+                found++;
+        }
+    });
+
+    auto indexed = plBenchmark::Time(count, [&]() {
+        found = 0;
+        for (uint32_t i = 0; i < numMsgs; ++i) {
+            if (plSDLMgr::GetInstance()->FindDescriptor(names[i], versions[i]))
+                found++;
+        }
+    });
+
+    // What plNetClientMsgHandler does with every incoming plNetMsgSDLState
+    uint32_t ingested = 0;
+    auto ingest = plBenchmark::Time(count, [&]() {
+        ingested = 0;
+        for (uint32_t i = 0; i < numMsgs; ++i) {
+            hsReadOnlyStream stream(msgs[i].size(), msgs[i].data());
+            ST::string descName;
+            int ver;
+            if (!plStateDataRecord::ReadStreamHeader(&stream, &descName, &ver))
+                continue;
+            plStateDescriptor* sd = plSDLMgr::GetInstance()->FindDescriptor(descName, ver);
+            if (!sd)
+                continue;
+            plStateDataRecord rec(sd);
+            if (rec.Read(&stream, 0))
+                ingested++;
+        }
+    });
+
+    ST::printf("\nResults (average of {} passes):\n", count);
+    plBenchmark::PrintResult("List scan", scan, numMsgs, "msg");
+    plBenchmark::PrintResult("Index", indexed, numMsgs, "msg");
+    plBenchmark::PrintResult("Ingest", ingest, numMsgs, "msg");
+    ST::printf("\nFound {} descriptors, ingested {} states\n", found, ingested);
+
+    plSDLMgr::GetInstance()->DeInit();
+    hsgResMgr::Shutdown();
+    return 0;
+}
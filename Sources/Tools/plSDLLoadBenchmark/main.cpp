@@ -0,0 +1,141 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "plCmdParser.h"
+#include "plFileSystem.h"
+#include "hsResMgr.h"
+
+#include "plResMgr/plResManager.h"
+#include "plSDL/plSDL.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgSDLDir,
+    kArgCount,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeString | kCmdArgRequired), "sdldir", kArgSDLDir },
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+};
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    if (!parser.Parse(args)) {
+        ST::printf(stderr, "Usage: plSDLLoadBenchmark <sdldir> [-Count <passes>]\n");
+        return 1;
+    }
+
+    int32_t count = 10;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetInt(kArgCount);
+    if (count <= 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    plResManager* resMgr = new plResManager;
+    hsgResMgr::Init(resMgr);
+
+    plSDLMgr* mgr = plSDLMgr::GetInstance();
+    mgr->SetSDLDir(parser.GetString(kArgSDLDir));
+
+    plFileName cacheFile = plFileName::Join(plFileSystem::GetCWD(), "plSDLLoadBenchmark.cache");
+    plFileSystem::Unlink(cacheFile);
+
+    // Text parse, cache disabled
+    bool ok = true;
+    auto parse = plBenchmark::Time(count, [&]() {
+        mgr->DeInit();
+        ok &= mgr->Init();
+    });
+    size_t numDescs = mgr->GetDescriptors()->size();
+    if (!ok || !numDescs) {
+        ST::printf(stderr, "Failed to parse the SDL files in {}\n", parser.GetString(kArgSDLDir));
+        hsgResMgr::Shutdown();
+        return 1;
+    }
+
+    // Text parse plus writing a fresh cache, what the first launch after a patch pays
+    mgr->SetCacheFile(cacheFile);
+    auto rebuild = plBenchmark::Time(count, [&]() {
+        plFileSystem::Unlink(cacheFile);
+        mgr->DeInit();
+        mgr->Init();
+    });
+
+    // Hash the sources and load the cache
+    auto load = plBenchmark::Time(count, [&]() {
+        mgr->DeInit();
+        ok &= mgr->Init();
+    });
+    if (!ok || mgr->GetDescriptors()->size() != numDescs) {
+        ST::printf(stderr, "Cache load produced {} descriptors, expected {}\n",
+                   mgr->GetDescriptors()->size(), numDescs);
+        hsgResMgr::Shutdown();
+        return 1;
+    }
+
+    ST::printf("Loaded {} descriptors from {}\n", numDescs, parser.GetString(kArgSDLDir));
+    ST::printf("\nResults (average of {} passes):\n", count);
+    plBenchmark::PrintResult("Parse", parse);
+    plBenchmark::PrintResult("Parse+write", rebuild);
+    plBenchmark::PrintResult("Cache load", load);
+    ST::printf("\nCache file: {} bytes\n", plFileInfo(cacheFile).FileSize());
+
+    plFileSystem::Unlink(cacheFile);
+    mgr->DeInit();
+    hsgResMgr::Shutdown();
+    return 0;
+}
@@ -0,0 +1,238 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "plCmdParser.h"
+#include "hsResMgr.h"
+#include "hsStream.h"
+
+#include "plResMgr/plResManager.h"
+#include "plSDL/plSDL.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgCount,
+    kArgRecords,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+    { (kCmdTypeUint | kCmdArgFlagged), "Records", kArgRecords },
+};
+
+// Roughly what the shipped age and physical state descriptors are made of:
+// mostly short numeric arrays, with a few flags and counters.
+static plStateDescriptor* IMakeDescriptor()
+{
+    static const struct { const char* type; int count; } vars[] = {
+        { "POINT3", 1 }, { "QUATERNION", 1 }, { "VECTOR3", 1 }, { "VECTOR3", 1 },
+        { "INT", 1 }, { "INT", 4 }, { "SHORT", 2 }, { "BYTE", 8 },
+        { "BOOL", 1 }, { "BOOL", 1 }, { "FLOAT", 1 }, { "FLOAT", 16 },
+        { "DOUBLE", 1 },
+    };
+
+    plStateDescriptor* sd = new plStateDescriptor;
+    sd->SetName("SyntheticVarState");
+    sd->SetVersion(1);
+    for (size_t i = 0; i < std::size(vars); ++i) {
+        plSimpleVarDescriptor* var = new plSimpleVarDescriptor;
+        var->SetType(vars[i].type);
+        var->SetName(ST::format("var{}", i));
+        var->SetCount(vars[i].count);
+        sd->AddVar(var);
+    }
+    return sd;
+}
+
+static void IRandomize(plStateDataRecord* rec, uint32_t seed)
+{
+    for (int v = 0; v < rec->GetNumVars(); ++v) {
+        plSimpleStateVariable* var = rec->GetVar(v);
+        int cnt = var->GetCount();
+        for (int i = 0; i < cnt; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            switch (var->GetVarDescriptor()->GetType()) {
+            case plVarDescriptor::kPoint3:
+            case plVarDescriptor::kVector3:
+                {
+                    float v[] = { float(seed & 0xFF), float((seed >> 8) & 0xFF), float(seed >> 16) };
+                    var->Set(v, i);
+                }
+                break;
+            case plVarDescriptor::kQuaternion:
+                {
+                    float v[] = { 0.f, 0.f, 0.f, float(seed & 0xFF) };
+                    var->Set(v, i);
+                }
+                break;
+            case plVarDescriptor::kInt:
+                var->Set(int(seed), i);
+                break;
+            case plVarDescriptor::kShort:
+                var->Set(short(seed), i);
+                break;
+            case plVarDescriptor::kByte:
+                var->Set(uint8_t(seed), i);
+                break;
+            case plVarDescriptor::kBool:
+                var->Set((seed & 1) != 0, i);
+                break;
+            case plVarDescriptor::kFloat:
+                var->Set(float(seed & 0xFFFF) / 256.f, i);
+                break;
+            case plVarDescriptor::kDouble:
+                var->Set(double(seed) / 65536.0, i);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    int32_t count = 10;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetInt(kArgCount);
+    if (count <= 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    uint32_t numRecs = 20000;
+    if (parser.IsSpecified(kArgRecords))
+        numRecs = parser.GetUint(kArgRecords);
+    if (numRecs == 0) {
+        ST::printf(stderr, "Need at least one record.\n");
+        return 1;
+    }
+
+    plResManager* resMgr = new plResManager;
+    hsgResMgr::Init(resMgr);
+
+    plStateDescriptor* sd = IMakeDescriptor();
+
+    ST::printf("Generating {} state records...\n", numRecs);
+    std::vector<plStateDataRecord*> recs(numRecs);
+    std::vector<plStateDataRecord*> copies(numRecs);
+    for (uint32_t i = 0; i < numRecs; ++i) {
+        recs[i] = new plStateDataRecord(sd);
+        IRandomize(recs[i], i);
+        copies[i] = new plStateDataRecord(*recs[i]);
+        // Touch one var in every fourth copy, so the compare sees some changes
+        if (i % 4 == 0) {
+            float pos[] = { -1.f, -1.f, -1.f };
+            copies[i]->GetVar(0)->Set(pos);
+        }
+    }
+
+    auto alloc = plBenchmark::Time(count, [&]() {
+        for (uint32_t i = 0; i < numRecs; ++i) {
+            plStateDataRecord rec(sd);
+            rec.SetFromDefaults(false);
+        }
+    });
+
+    hsRAMStream stream;
+    auto write = plBenchmark::Time(count, [&]() {
+        stream.Reset();
+        for (uint32_t i = 0; i < numRecs; ++i)
+            recs[i]->Write(&stream, 0);
+    });
+
+    std::vector<plStateDataRecord*> readRecs(numRecs);
+    for (uint32_t i = 0; i < numRecs; ++i)
+        readRecs[i] = new plStateDataRecord(sd);
+    uint32_t numRead = 0;
+    auto read = plBenchmark::Time(count, [&]() {
+        numRead = 0;
+        stream.Rewind();
+        for (uint32_t i = 0; i < numRecs; ++i) {
+            if (readRecs[i]->Read(&stream, 0))
+                numRead++;
+        }
+    });
+
+    // What plSDLModifier::SendState does to find the dirty vars
+    uint32_t numDirty = 0;
+    auto compare = plBenchmark::Time(count, [&]() {
+        numDirty = 0;
+        for (uint32_t i = 0; i < numRecs; ++i) {
+            copies[i]->SetDirty(false);
+            copies[i]->FlagDifferentState(*recs[i]);
+            if (copies[i]->IsDirty())
+                numDirty++;
+        }
+    });
+
+    ST::printf("\nResults (average of {} passes):\n", count);
+    plBenchmark::PrintResult("Alloc", alloc, numRecs, "record");
+    plBenchmark::PrintResult("Write", write, numRecs, "record");
+    plBenchmark::PrintResult("Read", read, numRecs, "record");
+    plBenchmark::PrintResult("Compare", compare, numRecs, "record");
+    ST::printf("\nWrote {} bytes, read {} records, {} dirty\n", stream.GetEOF(), numRead, numDirty);
+
+    for (uint32_t i = 0; i < numRecs; ++i) {
+        delete recs[i];
+        delete copies[i];
+        delete readRecs[i];
+    }
+    delete sd;
+
+    plSDLMgr::GetInstance()->DeInit();
+    hsgResMgr::Shutdown();
+    return 0;
+}
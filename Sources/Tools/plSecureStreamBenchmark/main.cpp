@@ -0,0 +1,232 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsCpuID.h"
+#include "hsStream.h"
+#include "plCmdParser.h"
+#include "plFileSystem.h"
+
+#include "plFile/plEncryptedStream.h"
+#include "plFile/plSecureStream.h"
+#include "plFile/plTeaCipher.h"
+#include "plFile/plTeaCipher_Private.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgCount,
+    kArgSize,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+    { (kCmdTypeUint | kCmdArgFlagged), "Size", kArgSize },
+};
+
+// Same layout plSecureStream writes: magic string, plaintext size, blocks
+static const uint32_t kSecureHeaderSize = 12 + sizeof(uint32_t);
+
+static std::vector<uint8_t> IReadAll(const plFileName& fileName)
+{
+    hsUNIXStream s;
+    s.Open(fileName, "rb");
+    std::vector<uint8_t> data(s.GetEOF());
+    s.Read(uint32_t(data.size()), data.data());
+    s.Close();
+    return data;
+}
+
+static bool IReadStream(hsStream* s, const std::vector<uint8_t>& plain)
+{
+    std::vector<uint8_t> out(plain.size());
+    uint32_t numRead = s->Read(uint32_t(out.size()), out.data());
+    return numRead == plain.size() && out == plain;
+}
+
+// Decrypted output that doesn't match the plaintext gets flagged under its timing
+static void IReportMismatch(bool ok)
+{
+    if (!ok)
+        ST::printf("{>22}  MISMATCH\n", "");
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    int32_t count = 10;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetInt(kArgCount);
+    if (count <= 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    // Roughly the size of a python.pak
+    uint32_t size = 4096;
+    if (parser.IsSpecified(kArgSize))
+        size = parser.GetUint(kArgSize);
+    size *= 1024;
+    if (size == 0) {
+        ST::printf(stderr, "Need at least one KiB to decrypt.\n");
+        return 1;
+    }
+
+    std::vector<uint8_t> plain(size);
+    std::mt19937 rng(12345);
+    for (uint8_t& b : plain)
+        b = uint8_t(rng());
+
+    // Encrypt a copy of the data both ways, through the streams themselves
+    plFileName secureFile = "plSecureStreamBenchmark.sec";
+    plFileName encryptedFile = "plSecureStreamBenchmark.enc";
+    for (const plFileName& fileName : { secureFile, encryptedFile }) {
+        hsUNIXStream s;
+        s.Open(fileName, "wb");
+        s.Write(size, plain.data());
+        s.Close();
+    }
+    plSecureStream::FileEncrypt(secureFile);
+    plEncryptedStream::FileEncrypt(encryptedFile);
+
+    std::vector<uint8_t> secure = IReadAll(secureFile);
+    std::vector<uint8_t> encrypted = IReadAll(encryptedFile);
+    const size_t numBlocks = (secure.size() - kSecureHeaderSize) / plTeaCipher::kBlockSize;
+
+    ST::printf("Decrypting {} KiB ({} blocks)...\n", size / 1024, numBlocks);
+    ST::printf("\nResults (average of {} passes):\n", count);
+
+    // What plSecureStream::Open(hsStream*) used to do: one block per virtual
+    // read, decipher and chunked RAM stream write
+    bool ok = true;
+    auto perBlock = plBenchmark::Time(count, [&]() {
+        hsReadOnlyStream src(int(secure.size()), secure.data());
+        src.Skip(kSecureHeaderSize);
+        hsRAMStream dst;
+        uint32_t remaining = size;
+        while (!src.AtEnd()) {
+            uint8_t buf[plTeaCipher::kBlockSize];
+            src.Read(sizeof(buf), buf);
+            plTeaCipherKernels::decipher_xxtea_fpu(plSecureStream::kDefaultKey, reinterpret_cast<uint32_t*>(buf), 1);
+            uint32_t amt = std::min<uint32_t>(remaining, sizeof(buf));
+            dst.Write(amt, buf);
+            remaining -= amt;
+        }
+        dst.Rewind();
+        ok = IReadStream(&dst, plain);
+    });
+    plBenchmark::PrintRate("Per-block (old)", perBlock, size);
+    IReportMismatch(ok);
+
+    auto bulk = plBenchmark::Time(count, [&]() {
+        hsReadOnlyStream src(int(secure.size()), secure.data());
+        plSecureStream ss(&src);
+        ok = IReadStream(&ss, plain);
+    });
+    plBenchmark::PrintRate("Bulk Open(hsStream)", bulk, size);
+    IReportMismatch(ok);
+
+    auto secureOpen = plBenchmark::Time(count, [&]() {
+        std::unique_ptr<hsStream> ss(plSecureStream::OpenSecureFile(secureFile));
+        ok = ss && IReadStream(ss.get(), plain);
+    });
+    plBenchmark::PrintRate("plSecureStream file", secureOpen, size);
+    IReportMismatch(ok);
+
+    auto encryptedOpen = plBenchmark::Time(count, [&]() {
+        std::unique_ptr<hsStream> es(plEncryptedStream::OpenEncryptedFile(encryptedFile));
+        ok = es && IReadStream(es.get(), plain);
+    });
+    plBenchmark::PrintRate("plEncryptedStream file", encryptedOpen, size);
+    IReportMismatch(ok);
+
+    // Raw kernel throughput, without any of the stream overhead
+    const hsCpuId& cpu = hsCpuId::Instance();
+    struct {
+        const char* fName;
+        bool fSupported;
+        plTeaCipherKernels::decipher_ptr fKernel;
+        const std::vector<uint8_t>& fSrc;
+    } kernels[] = {
+        { "XXTEA FPU", true, &plTeaCipherKernels::decipher_xxtea_fpu, secure },
+        { "XXTEA SSE2", cpu.has_sse2, &plTeaCipherKernels::decipher_xxtea_sse2, secure },
+        { "XXTEA AVX2", cpu.has_avx2, &plTeaCipherKernels::decipher_xxtea_avx2, secure },
+        { "TEA FPU", true, &plTeaCipherKernels::decipher_tea_fpu, encrypted },
+        { "TEA SSE2", cpu.has_sse2, &plTeaCipherKernels::decipher_tea_sse2, encrypted },
+        { "TEA AVX2", cpu.has_avx2, &plTeaCipherKernels::decipher_tea_avx2, encrypted },
+    };
+
+    ST::printf("\n");
+    std::vector<uint8_t> work(secure.size());
+    for (const auto& kernel : kernels) {
+        if (!kernel.fSupported)
+            continue;
+        auto elapsed = plBenchmark::Time(count, [&]() {
+            work.assign(kernel.fSrc.begin(), kernel.fSrc.end());
+            kernel.fKernel(plSecureStream::kDefaultKey,
+                           reinterpret_cast<uint32_t*>(work.data() + kSecureHeaderSize),
+                           numBlocks);
+        });
+        ok = memcmp(work.data() + kSecureHeaderSize, plain.data(), size) == 0;
+        plBenchmark::PrintRate(kernel.fName, elapsed, size);
+        IReportMismatch(ok);
+    }
+
+    plFileSystem::Unlink(secureFile);
+    plFileSystem::Unlink(encryptedFile);
+
+    return 0;
+}
@@ -0,0 +1,350 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <set>
+#include <string_theory/format>
+#include <string_theory/stdio>
+#include <vector>
+
+#include "HeadSpin.h"
+#include "hsCpuID.h"
+#include "hsJobSystem.h"
+#include "hsMatrix44.h"
+#include "hsResMgr.h"
+#include "plCmdParser.h"
+#include "plFileSystem.h"
+
+#include "pnKeyedObject/plKey.h"
+#include "plDrawable/plGBufferGroup.h"
+#include "plDrawable/plGeometrySpan.h"
+#include "plDrawable/plSharedMesh.h"
+#include "plPipeline/plCPUSkinning.h"
+#include "plPipeline/plCPUSkinning_Private.h"
+#include "plResMgr/plRegistryHelpers.h"
+#include "plResMgr/plRegistryNode.h"
+#include "plResMgr/plResManager.h"
+#include "plResMgr/plResMgrSettings.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgPages,
+    kArgCount,
+    kArgAvatars,
+    kArgWorkers,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeString | kCmdArgRequired), "pages", kArgPages },
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+    { (kCmdTypeUint | kCmdArgFlagged), "Avatars", kArgAvatars },
+    { (kCmdTypeUint | kCmdArgFlagged), "Workers", kArgWorkers },
+};
+
+// Bone indices are a byte each, so no span can reach past this
+static constexpr size_t kPaletteSize = 256;
+
+//// plSharedMeshCollector ////////////////////////////////////////////////////
+//  Page iterator that collects all the plSharedMeshes in all of our pages
+
+class plSharedMeshCollector : public plRegistryPageIterator, public plKeyCollector
+{
+public:
+    plSharedMeshCollector(std::set<plKey>& keyArray)
+                : plKeyCollector(keyArray) {}
+
+    bool EatPage(plRegistryPageNode* page) override
+    {
+        if (page->IsValid()) {
+            page->LoadKeys();
+            return page->IterateKeys(this, plSharedMesh::Index());
+        } else {
+            ST::printf(stderr, "INVALID PAGE: {}\n", page->GetPagePath());
+            return true;
+        }
+    }
+};
+
+// A skinned geometry span stuffed into a buffer group of its own, the same
+// way plDrawableSpans lays out the clothing it puts on an avatar.
+struct SkinSpan
+{
+    std::unique_ptr<plGBufferGroup> fGroup;
+    const uint8_t*                  fSrc;
+    uint32_t                        fCount;
+    uint32_t                        fDestStride;
+
+    SkinSpan(plGeometrySpan* span)
+        : fGroup(new plGBufferGroup(span->fFormat, false, false)), fCount(span->fNumVerts)
+    {
+        uint32_t vbIndex, cell, offset;
+        fGroup->ReserveVertStorage(fCount, &vbIndex, &cell, &offset,
+                                   plGBufferGroup::kReserveInterleaved | plGBufferGroup::kReserveIsolate);
+        fGroup->StuffToVertStorage(span, vbIndex, cell, offset, plGBufferGroup::kReserveInterleaved);
+
+        uint32_t start = fGroup->GetVertStartFromCell(vbIndex, cell, offset);
+        fSrc = fGroup->GetVertBufferData(vbIndex) + start * fGroup->GetVertexSize();
+
+        // What the pipeline's skinned vertex buffers hold: everything but the
+        // weights and indices
+        fDestStride = sizeof(float) * (3 + 3) + sizeof(uint32_t) * 2
+                    + sizeof(float) * 3 * fGroup->GetNumUVs();
+    }
+};
+
+// One avatar wearing every skinned span, each copy in its own pose
+struct Avatar
+{
+    std::vector<hsMatrix44>             fPalette;
+    std::vector<std::vector<uint8_t>>   fDest;
+
+    Avatar(const std::vector<SkinSpan>& spans, std::mt19937& rng)
+        : fPalette(kPaletteSize), fDest(spans.size())
+    {
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        std::uniform_int_distribution<int> axis(0, 2);
+        for (hsMatrix44& xfm : fPalette) {
+            hsVector3 offset(unit(rng), unit(rng), unit(rng));
+            xfm.MakeRotateMat(axis(rng), unit(rng) * hsConstants::pi<float>);
+            xfm.SetTranslate(&offset);
+        }
+
+        for (size_t i = 0; i < spans.size(); ++i)
+            fDest[i].assign(size_t(spans[i].fCount) * spans[i].fDestStride, 0);
+    }
+};
+
+static std::vector<plCPUSkinning::Job> IMakeJobs(const std::vector<SkinSpan>& spans, std::vector<Avatar>& avatars)
+{
+    std::vector<plCPUSkinning::Job> jobs;
+    for (Avatar& av : avatars) {
+        for (size_t i = 0; i < spans.size(); ++i) {
+            plCPUSkinning::Job job;
+            job.fPalette = av.fPalette.data();
+            job.fSrc = spans[i].fSrc;
+            job.fFormat = spans[i].fGroup->GetVertexFormat();
+            job.fSrcStride = spans[i].fGroup->GetVertexSize();
+            job.fDest = av.fDest[i].data();
+            job.fDestStride = spans[i].fDestStride;
+            job.fCount = spans[i].fCount;
+            job.fLocalUVWChans = 0;
+            jobs.push_back(job);
+        }
+    }
+    return jobs;
+}
+
+// Largest difference from the reference output, over the position and normal
+// of every vert
+static float IMaxError(const std::vector<plCPUSkinning::Job>& jobs, const std::vector<plCPUSkinning::Job>& ref)
+{
+    float err = 0.f;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        for (uint32_t v = 0; v < jobs[i].fCount; ++v) {
+            const uint8_t* a = jobs[i].fDest + v * jobs[i].fDestStride;
+            const uint8_t* b = ref[i].fDest + v * ref[i].fDestStride;
+            for (size_t f = 0; f < 6; ++f) {
+                float fa, fb;
+                memcpy(&fa, a + f * sizeof(float), sizeof(float));
+                memcpy(&fb, b + f * sizeof(float), sizeof(float));
+                err = std::max(err, std::fabs(fa - fb));
+            }
+        }
+    }
+    return err;
+}
+
+static void IRunKernel(const std::vector<plCPUSkinning::Job>& jobs, plCPUSkinningKernels::blend_verts_ptr kernel)
+{
+    for (const plCPUSkinning::Job& job : jobs)
+        kernel(job.fPalette, job.fSrc, job.fFormat, job.fSrcStride,
+               job.fDest, job.fDestStride, job.fCount, job.fLocalUVWChans);
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    if (!parser.Parse(args)) {
+        ST::printf(stderr, "Usage: plSkinningBenchmark <page.prp|age directory> [-Count <passes>] [-Avatars <n>] [-Workers <n>]\n");
+        return 1;
+    }
+
+    int32_t count = 50;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetInt(kArgCount);
+    if (count <= 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    uint32_t numAvatars = 8;
+    if (parser.IsSpecified(kArgAvatars))
+        numAvatars = parser.GetUint(kArgAvatars);
+    if (numAvatars == 0) {
+        ST::printf(stderr, "Need at least one avatar.\n");
+        return 1;
+    }
+
+    size_t numWorkers = 0;
+    if (parser.IsSpecified(kArgWorkers))
+        numWorkers = parser.GetUint(kArgWorkers);
+
+    plResMgrSettings::Get().SetFilterNewerPageVersions(false);
+    plResMgrSettings::Get().SetFilterOlderPageVersions(false);
+
+    plResManager* rm = new plResManager();
+    hsgResMgr::Init(rm);
+
+    plFileName path = parser.GetString(kArgPages);
+    if (plFileInfo(path).IsDirectory()) {
+        for (const plFileName& page : plFileSystem::ListDir(path, "*.prp"))
+            rm->AddSinglePage(page);
+    } else {
+        rm->AddSinglePage(path);
+    }
+
+    std::set<plKey> keys;
+    plSharedMeshCollector collector(keys);
+    rm->IterateAllPages(&collector);
+
+    // Only the spans the pipeline would skin on the CPU, i.e. avatar bodies
+    // and clothing
+    std::vector<plSharedMesh*> meshes;
+    std::vector<SkinSpan> spans;
+    uint32_t vertsPerAvatar = 0;
+    for (const plKey& key : keys) {
+        plSharedMesh* mesh = plSharedMesh::ConvertNoRef(key->VerifyLoaded());
+        if (!mesh)
+            continue;
+        key->RefObject();
+        meshes.push_back(mesh);
+        for (plGeometrySpan* span : mesh->fSpans) {
+            if (!span->fNumMatrices || !(span->fFormat & plGeometrySpan::kSkinWeightMask))
+                continue;
+            if (span->fLocalUVWChans || !span->fNumVerts)
+                continue;
+            spans.emplace_back(span);
+            vertsPerAvatar += span->fNumVerts;
+        }
+    }
+    if (spans.empty()) {
+        ST::printf(stderr, "No skinned shared meshes found in {}\n", path);
+        hsgResMgr::Shutdown();
+        return 1;
+    }
+
+    std::mt19937 rng(12345);
+    std::vector<Avatar> avatars, refAvatars;
+    for (uint32_t i = 0; i < numAvatars; ++i) {
+        std::mt19937 pose = rng;
+        avatars.emplace_back(spans, rng);
+        refAvatars.emplace_back(spans, pose);
+    }
+    std::vector<plCPUSkinning::Job> jobs = IMakeJobs(spans, avatars);
+    std::vector<plCPUSkinning::Job> ref = IMakeJobs(spans, refAvatars);
+    IRunKernel(ref, &plCPUSkinningKernels::blend_verts_fpu);
+    const uint32_t numVerts = numAvatars * vertsPerAvatar;
+
+    ST::printf("Skinning {} avatars ({} spans, {} verts)...\n", numAvatars, jobs.size(), numVerts);
+
+    auto fpu = plBenchmark::Time(count, [&]() { IRunKernel(jobs, &plCPUSkinningKernels::blend_verts_fpu); });
+
+    ST::printf("\nResults (average of {} passes):\n", count);
+    plBenchmark::PrintSpeedup("FPU", fpu, numVerts, "vert", fpu);
+
+    const hsCpuId& cpu = hsCpuId::Instance();
+    struct { const char* fName; bool fSupported; plCPUSkinningKernels::blend_verts_ptr fKernel; } kernels[] = {
+#ifdef HAVE_SSE3
+        { "SSE3", cpu.has_sse3, &plCPUSkinningKernels::blend_verts_sse3 },
+#endif
+#ifdef HAVE_SSE41
+        { "SSE4.1", cpu.has_sse41, &plCPUSkinningKernels::blend_verts_sse41 },
+#endif
+#ifdef HAVE_AVX
+        { "AVX", cpu.has_avx, &plCPUSkinningKernels::blend_verts_avx },
+#endif
+        { nullptr, false, nullptr }
+    };
+    for (size_t i = 0; kernels[i].fName; ++i) {
+        if (!kernels[i].fSupported)
+            continue;
+        auto elapsed = plBenchmark::Time(count, [&]() { IRunKernel(jobs, kernels[i].fKernel); });
+        plBenchmark::PrintSpeedup(kernels[i].fName, elapsed, numVerts, "vert", fpu);
+        ST::printf("{>22}  max error vs FPU: {.6f}\n", "", IMaxError(jobs, ref));
+    }
+
+    // The dispatched kernel, first one span at a time and then spread over the pool
+    auto serial = plBenchmark::Time(count, [&]() {
+        for (const plCPUSkinning::Job& job : jobs)
+            plCPUSkinning::BlendVerts(job);
+    });
+    plBenchmark::PrintSpeedup("Serial", serial, numVerts, "vert", fpu);
+
+    hsJobSystem::Initialize(numWorkers);
+    auto parallel = plBenchmark::Time(count, [&]() { plCPUSkinning::BlendJobs(jobs); });
+    ST::printf("\n{} workers:\n", hsJobSystem::Instance().GetNumWorkers());
+    plBenchmark::PrintSpeedup("Parallel", parallel, numVerts, "vert", fpu);
+    ST::printf("{>22}  max error vs FPU: {.6f}\n", "", IMaxError(jobs, ref));
+    hsJobSystem::Shutdown();
+
+    spans.clear();
+    for (plSharedMesh* mesh : meshes)
+        mesh->GetKey()->UnRefObject();
+    meshes.clear();
+    keys.clear();
+
+    plIndirectUnloadIterator iter;
+    rm->IterateAllPages(&iter);
+    hsgResMgr::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,211 @@
+/*==LICENSE==*
+
+CyanWorlds.com Engine - MMOG client, server and tools
+Copyright (C) 2011  Cyan Worlds, Inc.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Additional permissions under GNU GPL version 3 section 7
+
+If you modify this Program, or any covered work, by linking or
+combining it with any of RAD Game Tools Bink SDK, Autodesk 3ds Max SDK,
+NVIDIA PhysX SDK, Microsoft DirectX SDK, OpenSSL library, Independent
+JPEG Group JPEG library, Microsoft Windows Media SDK, or Apple QuickTime SDK
+(or a modified version of those libraries),
+containing parts covered by the terms of the Bink SDK EULA, 3ds Max EULA,
+PhysX SDK EULA, DirectX SDK EULA, OpenSSL and SSLeay licenses, IJG
+JPEG Library README, Windows Media SDK EULA, or QuickTime SDK EULA, the
+licensors of this Program grant you additional
+permission to convey the resulting work. Corresponding Source for a
+non-source form of such a combination shall include the source code for
+the parts of OpenSSL and IJG JPEG Library used as well as that of the covered
+work.
+
+You can contact Cyan Worlds, Inc. by email legal@cyan.com
+ or by snail mail at:
+      Cyan Worlds, Inc.
+      14617 N Newport Hwy
+      Mead, WA   99021
+
+*==LICENSE==*/
+
+#include <string_theory/format>
+#include <string_theory/stdio>
+
+#include "HeadSpin.h"
+#include "plCmdParser.h"
+#include "hsRefCnt.h"
+
+#include "pnNetProtocol/pnNetProtocol.h"
+
+#include "plBenchmark/plBenchmark.h"
+
+enum CmdLineArgs
+{
+    kArgCount,
+    kArgNodes,
+};
+
+static const plCmdArgDef s_cmdLineArgs[] = {
+    { (kCmdTypeUint | kCmdArgFlagged), "Count", kArgCount },
+    { (kCmdTypeUint | kCmdArgFlagged), "Nodes", kArgNodes },
+};
+
+// Rough mix of what a long-lived player vault contains: mostly folders,
+// chronicles and text notes, with a smattering of SDL and image blobs.
+static void IFillSyntheticNode(NetVaultNode* node, uint32_t idx)
+{
+    node->SetNodeId(idx + 1);
+    node->SetCreateTime(1600000000 + idx);
+    node->SetModifyTime(1600000000 + idx * 2);
+    node->SetCreatorId(idx / 100);
+    node->SetCreateAgeName(ST_LITERAL("Personal"));
+
+    switch (idx % 8) {
+    case 0:
+    case 1:
+        node->SetNodeType(22); // Folder
+        node->SetInt32_1(idx % 30);
+        node->SetString64_1(ST::format("Folder{}", idx));
+        break;
+    case 2:
+    case 3:
+    case 4:
+        node->SetNodeType(29); // Chronicle
+        node->SetInt32_1(idx % 3);
+        node->SetString64_1(ST::format("Chronicle_{}", idx));
+        node->SetText_1(ST::format("{}:{}:{}", idx, idx * 7, idx * 13));
+        break;
+    case 5:
+    case 6:
+        node->SetNodeType(26); // TextNote
+        node->SetInt32_1(idx % 5);
+        node->SetString64_1(ST::format("Note {}", idx));
+        node->SetText_1(ST::format("This is the body of journal note number {}, written in the Relto library.", idx));
+        break;
+    case 7:
+    {
+        node->SetNodeType(27); // SDL
+        node->SetString64_1(ST_LITERAL("AgeSDLHook"));
+        node->SetIString64_1(ST::format("Player{}", idx));
+        uint8_t blob[512];
+        for (size_t i = 0; i < std::size(blob); ++i)
+            blob[i] = static_cast<uint8_t>(idx + i);
+        node->SetBlob_1(blob, 64 + (idx % (std::size(blob) - 64)));
+        break;
+    }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<ST::string> args;
+    for (int i = 0; i < argc; ++i)
+        args.emplace_back(argv[i]);
+
+    plCmdParser parser(s_cmdLineArgs, std::size(s_cmdLineArgs));
+    parser.Parse(args);
+
+    int32_t count = 10;
+    if (parser.IsSpecified(kArgCount))
+        count = parser.GetInt(kArgCount);
+    if (count <= 0) {
+        ST::printf(stderr, "Cannot iterate less than 1 time.\n");
+        return 1;
+    }
+
+    uint32_t numNodes = 50000;
+    if (parser.IsSpecified(kArgNodes))
+        numNodes = parser.GetUint(kArgNodes);
+    if (numNodes == 0) {
+        ST::printf(stderr, "Cannot benchmark an empty vault.\n");
+        return 1;
+    }
+
+    ST::printf("Generating a synthetic vault of {} nodes...\n", numNodes);
+
+    // Serialize the synthetic nodes into wire buffers, the same way they
+    // arrive from the auth server in a bulk fetch.
+    std::vector<std::vector<uint8_t>> wire(numNodes);
+    size_t wireBytes = 0;
+    for (uint32_t i = 0; i < numNodes; ++i) {
+        hsRef<NetVaultNode> node(new NetVaultNode, hsStealRef);
+        IFillSyntheticNode(node.Get(), i);
+        node->Write(&wire[i]);
+        wireBytes += wire[i].size();
+    }
+
+    std::vector<hsRef<NetVaultNode>> nodes(numNodes);
+    for (uint32_t i = 0; i < numNodes; ++i)
+        nodes[i].Steal(new NetVaultNode);
+
+    auto parse = plBenchmark::Time(count, [&]() {
+        for (uint32_t i = 0; i < numNodes; ++i)
+            nodes[i]->Read(wire[i].data(), wire[i].size());
+    });
+
+    std::vector<hsRef<NetVaultNode>> copies(numNodes);
+    for (uint32_t i = 0; i < numNodes; ++i)
+        copies[i].Steal(new NetVaultNode);
+    auto copy = plBenchmark::Time(count, [&]() {
+        for (uint32_t i = 0; i < numNodes; ++i)
+            copies[i]->CopyFrom(nodes[i].Get());
+    });
+
+    hsRef<NetVaultNode> templateNode(new NetVaultNode, hsStealRef);
+    templateNode->SetNodeType(26);
+    templateNode->SetString64_1(ST::format("Note {}", numNodes - 3));
+    uint32_t matched = 0;
+    auto match = plBenchmark::Time(count, [&]() {
+        matched = 0;
+        for (uint32_t i = 0; i < numNodes; ++i) {
+            if (nodes[i]->Matches(templateNode.Get()))
+                ++matched;
+        }
+    });
+
+    size_t textBytes = 0;
+    auto fetch = plBenchmark::Time(count, [&]() {
+        textBytes = 0;
+        for (uint32_t i = 0; i < numNodes; ++i)
+            textBytes += nodes[i]->GetString64_1().size() + nodes[i]->GetText_1().size();
+    });
+
+    std::vector<uint8_t> out;
+    out.reserve(wireBytes + numNodes * sizeof(uint64_t));
+    auto write = plBenchmark::Time(count, [&]() {
+        out.clear();
+        for (uint32_t i = 0; i < numNodes; ++i)
+            nodes[i]->Write(&out);
+    });
+
+    size_t arenaBytes = 0;
+    for (const hsRef<NetVaultNode>& node : nodes)
+        arenaBytes += node->GetArenaCapacity();
+
+    ST::printf("\nResults (average of {} passes):\n", count);
+    plBenchmark::PrintResult("Read", parse, numNodes, "node");
+    plBenchmark::PrintResult("CopyFrom", copy, numNodes, "node");
+    plBenchmark::PrintResult("Matches", match, numNodes, "node");
+    plBenchmark::PrintResult("Get", fetch, numNodes, "node");
+    plBenchmark::PrintResult("Write", write, numNodes, "node");
+
+    ST::printf("\nMemory:\n");
+    ST::printf("Wire data:   {} bytes\n", wireBytes);
+    ST::printf("Node object: {} bytes each, {} bytes total\n", sizeof(NetVaultNode), sizeof(NetVaultNode) * numNodes);
+    ST::printf("Field arena: {} bytes total ({} heap blocks)\n", arenaBytes, numNodes);
+    ST::printf("Matched {} nodes, fetched {} bytes of text\n", matched, textBytes);
+    ST::printf("Have a nice day!\n");
+    return 0;
+}